@@ -294,13 +294,19 @@ router.post('/dsp/import/fir', (req, res) => {
 });
 
 // POST /dsp/convolution/upload?ch=N — upload WAV IR for convolution stage
-// Accepts raw binary body (WAV file). Mock validates ch query param only.
+// Accepts a multipart WAV upload. Mock validates ch query param only; the
+// firmware answers 202 and builds the IR in the background.
 router.post('/dsp/convolution/upload', (req, res) => {
   const ch = parseInt(req.query.ch, 10);
   if (isNaN(ch) || ch < 0 || ch > 3) {
     return res.status(400).json({ success: false, message: 'Invalid channel' });
   }
-  res.json({ success: true, channel: ch, tapsLoaded: 128 });
+  res.status(202).json({ success: true, pending: true, tapsLoaded: 128, fileSampleRate: 48000, sampleRate: 48000 });
+});
+
+// GET /dsp/convolution/status — progress of the last IR upload
+router.get('/dsp/convolution/status', (req, res) => {
+  res.json({ success: true, state: 'done', ch: 0, slot: 0, irLength: 128, message: '' });
 });
 
 // GET /dsp/export/apo — export Equalizer APO format
@@ -97,6 +97,12 @@ static const AsrcRatio kRatioTable[] = {
     { 96000,  48000,   1,   2 },   // 96kHz → 48kHz
     { 176400, 48000,  40, 147 },   // 176.4kHz → 48kHz
     { 192000, 48000,   1,   4 },   // 192kHz → 48kHz
+    // 96 kHz internal processing rate (audio_rate_convert.h)
+    { 44100,  96000, 320, 147 },   // 44.1kHz → 96kHz
+    { 48000,  96000,   2,   1 },   // 48kHz → 96kHz
+    { 88200,  96000, 160, 147 },   // 88.2kHz → 96kHz
+    { 176400, 96000,  80, 147 },   // 176.4kHz → 96kHz
+    { 192000, 96000,   1,   2 },   // 192kHz → 96kHz
     // Equal-rate (passthrough): not in table — handled by srcRate==dstRate check
 };
 static const int kRatioTableCount = (int)(sizeof(kRatioTable) / sizeof(kRatioTable[0]));
@@ -8,15 +8,19 @@
 //   lives in PSRAM via psram_alloc().
 //
 // Insertion point: pipeline_resample_inputs() is called between
-//   pipeline_to_float() and pipeline_run_dsp() in audio_pipeline.cpp.
+//   pipeline_condition_inputs() and pipeline_run_dsp() in audio_pipeline.cpp.
 //
 // Passthrough: when srcRate == dstRate, resample is a zero-cost no-op.
-// DSD lanes: isDsd == true → skip entirely (DoP must not be filtered).
+// DSD lanes are decoded to PCM at the DoP frame rate (176.4kHz for DSD64)
+// before this stage and are resampled like any other lane.
 //
 // Supported input→output ratios (v1 — rational only):
 //   44100→48000 (160/147), 48000→44100 (147/160)
 //   88200→48000 (80/147),  96000→48000 (1/2)
 //   176400→48000 (40/147), 192000→48000 (1/4)
+//   and the same sources to a 96 kHz processing rate:
+//   44100→96000 (320/147), 48000→96000 (2/1), 88200→96000 (160/147)
+//   176400→96000 (80/147), 192000→96000 (1/2)
 //   Any equal-rate pair → passthrough (no computation)
 //
 // Memory budget: ~1.5 KB PSRAM per active lane
@@ -76,18 +80,21 @@ void asrc_deinit(void);
 // Unknown ratios also deactivate SRC and log a warning.
 void asrc_set_ratio(int lane, uint32_t srcRate, uint32_t dstRate);
 
-// Bypass SRC for a lane unconditionally (used for DSD lanes).
+// Bypass SRC for a lane unconditionally.
 void asrc_bypass(int lane);
 
 // Process one frame buffer in-place on a lane.
 // laneL/laneR: interleaved stereo float buffers, each 'frames' elements.
 // outFrames: output buffer length (may differ from input if ratio != 1:1).
 // Returns the number of output frames written to laneL/laneR.
-// If lane is bypassed (DSD or equal rates), returns frames unchanged.
+// If lane is bypassed (equal rates), returns frames unchanged.
 //
 // IMPORTANT: laneL and laneR must have capacity >= frames * max(L/M ratio).
 // At 44100→48000 (160/147 ≈ 1.09×), 256 input → ceil(256*160/147) = 279 output.
-// The pipeline float buffers are sized ASRC_OUTPUT_FRAMES_MAX for this.
+// The pipeline float buffers are sized ASRC_OUTPUT_FRAMES_MAX for this; the
+// output stops there, so ratios above that (48000→96000) must be fed blocks
+// of at most 140 frames (the pipeline reads 128 when processing at twice the
+// I/O rate, audio_block_plan()).
 int asrc_process_lane(int lane, float* laneL, float* laneR, int frames);
 
 // Get state for a lane (used for WS broadcast of laneSrcActive[]).
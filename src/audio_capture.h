@@ -0,0 +1,138 @@
+#pragma once
+// audio_capture.h — readiness-based multi-port input capture (header-only,
+// no RTOS or I2S dependencies).
+//
+// Sources that can report how many frames their DMA has completed
+// (AudioInputSource::available) are never read with a timeout. For every
+// block the pipeline first drains what each port has ready into a small
+// per-lane jitter FIFO (audio_capture_fill, all lanes back to back under one
+// timestamp), then takes one block from every FIFO (audio_capture_take).
+// Lanes whose DMA completes at a different phase than the clocking port
+// simply carry the remainder to the next block, so a slow or unclocked
+// slave ADC can no longer stretch the block for the other lanes.
+//
+// A lane that came up short is zero-padded and counted as an underrun and
+// from then on holds a little more in reserve (up to half a block), so a
+// port whose descriptors complete right around the snapshot settles after
+// one or two underruns while steady lanes add no latency. A lane running
+// more than a block ahead drops its oldest frames (overflow) so its
+// latency stays bounded. A port that delivers nothing for
+// AUDIO_CAPTURE_STALL_BLOCKS blocks in a row is flagged stalled.
+
+#include <stdint.h>
+#include <string.h>
+#include "audio_scheduler.h"   // AUDIO_BLOCK_FRAMES_MAX
+
+#define AUDIO_CAPTURE_FIFO_FRAMES   (2 * AUDIO_BLOCK_FRAMES_MAX)  // Per lane, power of 2
+#ifndef AUDIO_CAPTURE_STALL_BLOCKS
+#define AUDIO_CAPTURE_STALL_BLOCKS  8    // Empty blocks before a port counts as stalled
+#endif
+
+static_assert((AUDIO_CAPTURE_FIFO_FRAMES & (AUDIO_CAPTURE_FIFO_FRAMES - 1)) == 0,
+    "AUDIO_CAPTURE_FIFO_FRAMES must be a power of 2");
+
+typedef uint32_t (*AudioCaptureReadFn)(int32_t *dst, uint32_t frames);
+typedef uint32_t (*AudioCaptureAvailFn)(void);
+
+struct AudioCaptureLane {
+    int32_t *fifo;                  // AUDIO_CAPTURE_FIFO_FRAMES stereo frames (caller-owned)
+    uint32_t wr;                    // Frames written (wraps)
+    uint32_t rd;                    // Frames taken or dropped (wraps)
+    uint32_t stampUs;               // Snapshot time of the last fill
+    uint32_t margin;                // Frames held back against arrival jitter
+    bool primed;                    // A block plus margin was buffered since start/stall
+    bool stalled;
+    uint16_t emptyBlocks;           // Consecutive fills that found nothing ready
+    // Accounting
+    uint32_t underruns;             // Blocks padded with silence after priming
+    uint32_t overflows;             // Frames dropped because the lane ran ahead
+    uint32_t stalls;                // Times the port was flagged stalled
+    uint32_t lastFill;              // Frames read by the last fill
+};
+
+static inline void audio_capture_reset(AudioCaptureLane &c) {
+    int32_t *fifo = c.fifo;
+    c = AudioCaptureLane();
+    c.fifo = fifo;
+}
+
+// Frames buffered
+static inline uint32_t audio_capture_level(const AudioCaptureLane &c) {
+    return c.wr - c.rd;
+}
+
+// Read what the port has ready into the FIFO without waiting. Never asks the
+// port for more frames than it reported ready; when more is ready than the
+// FIFO has room for, the oldest buffered frames make way. Returns the frames
+// read.
+static inline uint32_t audio_capture_fill(AudioCaptureLane &c, AudioCaptureAvailFn available,
+                                          AudioCaptureReadFn read, uint32_t nowUs) {
+    c.stampUs = nowUs;
+    c.lastFill = 0;
+    if (!c.fifo || !available || !read) return 0;
+    uint32_t ready = available();
+    uint32_t want = ready;
+    uint32_t level = audio_capture_level(c);
+    if (want > AUDIO_CAPTURE_FIFO_FRAMES - level) {
+        // The port is further ahead than the FIFO holds: keep the newest
+        uint32_t drop = want - (AUDIO_CAPTURE_FIFO_FRAMES - level);
+        if (drop > level) drop = level;
+        c.rd += drop;
+        c.overflows += drop;
+    }
+    uint32_t room = AUDIO_CAPTURE_FIFO_FRAMES - audio_capture_level(c);
+    if (want > room) want = room;
+    while (want > 0) {
+        uint32_t at = c.wr & (AUDIO_CAPTURE_FIFO_FRAMES - 1);
+        uint32_t chunk = AUDIO_CAPTURE_FIFO_FRAMES - at;   // Contiguous up to the wrap
+        if (chunk > want) chunk = want;
+        uint32_t got = read(&c.fifo[at * 2], chunk);
+        if (got > chunk) got = chunk;
+        c.wr += got;
+        c.lastFill += got;
+        want -= got;
+        if (got < chunk) break;
+    }
+    if (c.lastFill > 0) {
+        c.emptyBlocks = 0;
+        c.stalled = false;
+    } else if (c.emptyBlocks < UINT16_MAX && ++c.emptyBlocks >= AUDIO_CAPTURE_STALL_BLOCKS &&
+               !c.stalled) {
+        c.stalled = true;
+        c.primed = false;
+        c.stalls++;
+    }
+    return c.lastFill;
+}
+
+// Take one block of `frames` into dst (interleaved L/R). A short FIFO is
+// zero-padded. Returns the frames of captured audio in dst.
+static inline uint32_t audio_capture_take(AudioCaptureLane &c, int32_t *dst, uint32_t frames) {
+    uint32_t level = audio_capture_level(c);
+    if (!c.primed && level >= frames + c.margin) c.primed = true;
+    uint32_t n = c.primed ? (level < frames ? level : frames) : 0;
+    for (uint32_t done = 0; done < n; ) {
+        uint32_t at = c.rd & (AUDIO_CAPTURE_FIFO_FRAMES - 1);
+        uint32_t chunk = AUDIO_CAPTURE_FIFO_FRAMES - at;
+        if (chunk > n - done) chunk = n - done;
+        memcpy(&dst[done * 2], &c.fifo[at * 2], chunk * 2 * sizeof(int32_t));
+        c.rd += chunk;
+        done += chunk;
+    }
+    if (n < frames) {
+        memset(&dst[n * 2], 0, (frames - n) * 2 * sizeof(int32_t));
+        if (c.primed) {
+            c.underruns++;
+            c.primed = false;       // Refill a whole block before resuming
+            if (c.margin < frames / 2) c.margin += frames / 4;
+        }
+    }
+    // More than one further block buffered: the lane runs ahead of the
+    // clocking port — drop the oldest frames to keep the jitter margin
+    level = audio_capture_level(c);
+    if (level > frames) {
+        c.overflows += level - frames;
+        c.rd += level - frames;
+    }
+    return n;
+}
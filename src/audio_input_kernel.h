@@ -0,0 +1,122 @@
+#pragma once
+// audio_input_kernel.h — fused input conditioning for one pipeline lane
+// (header-only, no RTOS dependencies).
+//
+// One streaming pass over the left-justified int32 block does everything the
+// input stages need from the raw words:
+//   - deinterleave to planar float, 24-bit full scale = 1.0
+//   - apply the pre-matrix trim (folded into the conversion scale, so there
+//     is no int32 -> float -> int32 round trip)
+//   - sum of squares per channel (noise gate decision and metering) and
+//     sample peaks
+//   - count samples at 24-bit full scale (clip diagnostics, before trim)
+//   - check every frame for DoP markers: the top byte of both channels
+//     alternates 0x05 / 0xFA from frame to frame
+// The noise gate itself runs after the kernel because it needs the block
+// sums to decide.
+//
+// The words are read through a stride, so the pass runs equally on the
+// pipeline's interleaved lane buffer (stride 2) and on a block a source lends
+// in place (AudioLaneView: an interleaved ring, a lane of a TDM frame buffer).
+
+#include <stdint.h>
+#include <math.h>
+
+#define AUDIO_INPUT_FULL_SCALE  8388607.0f   // 2^23 - 1
+#define AUDIO_INPUT_CLIP_LEVEL  0x7FFFF0     // |24-bit sample| at or above counts as clipped
+#define DOP_MARKER_A            0x05u
+#define DOP_MARKER_B            0xFAu
+
+struct AudioInputStats {
+    float sumSqL;               // Sum of squares after trim
+    float sumSqR;
+    float peakL;                // Largest |sample| after trim
+    float peakR;
+    uint32_t clipped;           // Samples at full scale (before trim)
+    bool dop;                   // Every frame carries alternating DoP markers
+};
+
+static inline void audio_input_condition_strided(const int32_t *rawL, const int32_t *rawR, int stride,
+                                                 float *L, float *R, int frames,
+                                                 float gain, bool scanDop, AudioInputStats &st) {
+    const float scale = gain / AUDIO_INPUT_FULL_SCALE;
+    float sumL = 0.0f, sumR = 0.0f, peakL = 0.0f, peakR = 0.0f;
+    uint32_t clipped = 0;
+
+    // DoP phase is set by frame 0; any frame off the alternation fails the block
+    uint32_t mark = frames > 0 ? (uint32_t)rawL[0] >> 24 : 0;
+    uint32_t dopMiss = (frames >= 2 && (mark == DOP_MARKER_A || mark == DOP_MARKER_B)) ? 0 : 1;
+    if (!scanDop) dopMiss = 1;
+    const uint32_t flip = dopMiss ? 0 : (DOP_MARKER_A ^ DOP_MARKER_B);
+
+    for (int f = 0; f < frames; f++) {
+        int32_t wl = rawL[f * stride];
+        int32_t wr = rawR[f * stride];
+        if (!dopMiss) {
+            dopMiss |= (((uint32_t)wl >> 24) ^ mark) | (((uint32_t)wr >> 24) ^ mark);
+            mark ^= flip;
+        }
+        int32_t a = wl >> 8;
+        int32_t b = wr >> 8;
+        clipped += (uint32_t)(a >= AUDIO_INPUT_CLIP_LEVEL) + (uint32_t)(a <= -AUDIO_INPUT_CLIP_LEVEL) +
+                   (uint32_t)(b >= AUDIO_INPUT_CLIP_LEVEL) + (uint32_t)(b <= -AUDIO_INPUT_CLIP_LEVEL);
+        float l = (float)a * scale;
+        float r = (float)b * scale;
+        L[f] = l;
+        R[f] = r;
+        sumL += l * l;
+        sumR += r * r;
+        float al = fabsf(l), ar = fabsf(r);
+        peakL = al > peakL ? al : peakL;
+        peakR = ar > peakR ? ar : peakR;
+    }
+
+    st.sumSqL = sumL;
+    st.sumSqR = sumR;
+    st.peakL = peakL;
+    st.peakR = peakR;
+    st.clipped = clipped;
+    st.dop = !dopMiss;
+}
+
+// Interleaved L/R block (the pipeline's lane buffer)
+static inline void audio_input_condition(const int32_t *raw, float *L, float *R, int frames,
+                                         float gain, bool scanDop, AudioInputStats &st) {
+    audio_input_condition_strided(raw, raw + 1, 2, L, R, frames, gain, scanDop, st);
+}
+
+// Copy a strided block into interleaved L/R words (for consumers of the raw
+// words, such as the DoP decoder, when the block was only lent)
+static inline void audio_input_gather(const int32_t *rawL, const int32_t *rawR, int stride,
+                                      int32_t *dst, int frames) {
+    for (int f = 0; f < frames; f++) {
+        dst[f * 2]     = rawL[f * stride];
+        dst[f * 2 + 1] = rawR[f * stride];
+    }
+}
+
+// Trim and measure a lane that is already planar float (decoded DSD): applies
+// gain in place and refreshes sums, peaks and the clip count (|x| >= 1.0).
+// st.dop is left as the marker scan set it.
+static inline void audio_input_measure(float *L, float *R, int frames, float gain,
+                                       AudioInputStats &st) {
+    float sumL = 0.0f, sumR = 0.0f, peakL = 0.0f, peakR = 0.0f;
+    uint32_t clipped = 0;
+    for (int f = 0; f < frames; f++) {
+        float l = L[f] * gain;
+        float r = R[f] * gain;
+        L[f] = l;
+        R[f] = r;
+        sumL += l * l;
+        sumR += r * r;
+        float al = fabsf(l), ar = fabsf(r);
+        clipped += (uint32_t)(al >= 1.0f) + (uint32_t)(ar >= 1.0f);
+        peakL = al > peakL ? al : peakL;
+        peakR = ar > peakR ? ar : peakR;
+    }
+    st.sumSqL = sumL;
+    st.sumSqR = sumR;
+    st.peakL = peakL;
+    st.peakR = peakR;
+    st.clipped = clipped;
+}
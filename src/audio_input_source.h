@@ -19,6 +19,17 @@ extern "C" {
 #define AUDIO_SRC_LANE_ADC1   0
 #define AUDIO_SRC_LANE_ADC2   1
 
+// Borrowed view of one block of a source's own buffer: left-justified int32
+// samples (the read() format), frame f of the left channel at left[f * stride],
+// of the right channel at right[f * stride]. Interleaved stereo has stride 2;
+// a lane of an N-slot TDM frame buffer has stride N.
+typedef struct AudioLaneView {
+    const int32_t *left;
+    const int32_t *right;
+    uint16_t       stride;  // int32 words from one frame to the next
+    float          gain;    // Gain read() would have applied to the words (USB host volume), else 1.0
+} AudioLaneView;
+
 // Reusable input source interface.
 // Each audio input (ADC, USB, signal generator, etc.) can register itself
 // via this struct. The audio pipeline loops over registered sources.
@@ -58,6 +69,22 @@ typedef struct AudioInputSource {
     // Format negotiation fields (Phase 1+2 hardening)
     uint8_t  bitDepth;   // Actual bit depth produced: 16, 24, or 32 (0 = unknown/auto)
     bool     isDsd;      // True when DoP DSD content detected on this lane
+
+    // Frames read() can return right now without waiting (DMA-backed ports).
+    // NULL for sources that never block (SigGen, USB): those are read one
+    // block at a time. When set, the pipeline captures the lane through a
+    // jitter FIFO and never requests more than is ready (audio_capture.h).
+    uint32_t (*available)(void);
+
+    // Optional zero-copy read (NULL = read() only). Lends the next
+    // requestedFrames frames in place: fills *view and returns requestedFrames,
+    // or returns 0 when the block is not contiguous in the source's buffer
+    // (ring wrap, underrun, packed formats) and read() must copy it instead.
+    // Every successful borrow is followed by release() in the same pipeline
+    // tick, after the pipeline has converted the view; release may be NULL
+    // for sources whose view stays valid until their next read or borrow.
+    uint32_t (*borrow)(AudioLaneView *view, uint32_t requestedFrames);
+    void     (*release)(uint32_t frames);
 } AudioInputSource;
 
 // Default initializer — all NULLs, gain=1.0, VU=-90dBFS, smoothed=0
@@ -75,7 +102,10 @@ typedef struct AudioInputSource {
     0xFF,  /* halSlot */         \
     false, /* isHardwareAdc */   \
     0,     /* bitDepth */        \
-    false  /* isDsd */           \
+    false, /* isDsd */           \
+    NULL,  /* available */       \
+    NULL,  /* borrow */          \
+    NULL   /* release */         \
 }
 
 #ifdef __cplusplus
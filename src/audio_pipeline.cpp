@@ -32,6 +32,12 @@
 
 #include "audio_pipeline.h"
 #include "i2s_audio.h"
+#include "audio_scheduler.h"
+#include "audio_capture.h"
+#include "audio_input_kernel.h"
+#include "audio_rate_switch.h"
+#include "audio_rate_convert.h"
+#include "dsd_decoder.h"
 #include "app_state.h"
 #include "config.h"
 #include "debug_serial.h"
@@ -60,6 +66,7 @@
 #ifndef NATIVE_TEST
 #include <LittleFS.h>
 #include <ArduinoJson.h>
+#include "config_snapshot.h"
 #endif
 #include "audio_input_source.h"
 #include "audio_output_sink.h"
@@ -94,14 +101,36 @@ static_assert(AUDIO_OUT_MAX_SINKS * 2 <= AUDIO_PIPELINE_MATRIX_SIZE,
     "Matrix rows must accommodate all stereo output channels");
 
 // ===== Constants =====
-static const int FRAMES      = I2S_DMA_BUF_LEN;    // 256 stereo frames per DMA buffer
-static const int RAW_SAMPLES = FRAMES * 2;          // 512 int32_t per buffer (L+R interleaved)
-static const float MAX_24BIT_F = 8388607.0f;        // 2^23 - 1
+static const int FRAMES_MAX  = AUDIO_BLOCK_FRAMES_MAX; // 256 stereo frames — every buffer is sized for this
+static const int RAW_SAMPLES = FRAMES_MAX * 2;      // 512 int32_t per buffer (L+R interleaved)
+static const float MAX_24BIT_F = AUDIO_INPUT_FULL_SCALE;  // 2^23 - 1
 
 // Lane float buffers must be large enough for ASRC maximum output (upsampling expands frames)
 static_assert(ASRC_OUTPUT_FRAMES_MAX >= I2S_DMA_BUF_LEN,
     "Lane buffers must accommodate ASRC maximum output");
 
+// ===== Block Size =====
+// Configured frames per pipeline iteration (32/64/128/256, audio_scheduler.h)
+// and its split between the I/O and processing rates (audio_block_plan()).
+// Changed only while the audio task is paused — see
+// audio_pipeline_set_block_frames() and audio_pipeline_set_rates().
+static int _blockRequest = FRAMES_MAX;
+static int _blockFrames  = FRAMES_MAX;  // Read, conditioned, DoP: at the I/O rate
+static int _procFrames   = FRAMES_MAX;  // DSP, matrix, output DSP: at the processing rate
+
+// ===== Processing Rate (audio_rate_convert.h) =====
+// Both 0 until audio_pipeline_set_rates(): everything runs at the I/O rate.
+// Lanes at the I/O rate and sinks a factor of two away from the processing
+// rate go through the half-band converters (state PSRAM on ESP32).
+static uint32_t _ioRate   = 0;
+static uint32_t _procRate = 0;
+static volatile AudioRateStep _laneStep[AUDIO_PIPELINE_MAX_INPUTS] = {};  // Set by lane routing (main loop)
+static AudioRateStep _sinkStep[AUDIO_OUT_MAX_SINKS] = {};  // Step the sink converters last ran (audio task)
+static AudioHalfbandState *_laneHb = nullptr;   // [lane * 2 + ch]
+static AudioHalfbandState *_sinkHb = nullptr;   // [slot * 2 + ch]
+static float *_sinkConvL = nullptr;             // One converted sink block, reused by every sink
+static float *_sinkConvR = nullptr;
+
 // ===== DMA Buffers — MUST be in internal SRAM (DMA cannot access PSRAM) =====
 // Lazily allocated on first audio_pipeline_set_source() / audio_pipeline_set_sink() call
 // (ESP32 path only — native test keeps static 2D arrays below).
@@ -134,6 +163,9 @@ static float _outCh_buf[AUDIO_PIPELINE_MATRIX_SIZE][I2S_DMA_BUF_LEN];
 static float _gatePrevL_buf[AUDIO_PIPELINE_MAX_INPUTS][I2S_DMA_BUF_LEN];
 static float _gatePrevR_buf[AUDIO_PIPELINE_MAX_INPUTS][I2S_DMA_BUF_LEN];
 static float _swapHoldCh_buf[AUDIO_PIPELINE_MATRIX_SIZE][I2S_DMA_BUF_LEN];
+static AudioHalfbandState _laneHb_buf[AUDIO_PIPELINE_MAX_INPUTS * 2];
+static AudioHalfbandState _sinkHb_buf[AUDIO_OUT_MAX_SINKS * 2];
+static float _sinkConv_buf[2][I2S_DMA_BUF_LEN];
 #endif
 
 // ===== Routing Matrix =====
@@ -148,6 +180,7 @@ static bool _inputBypass[AUDIO_PIPELINE_MAX_INPUTS] = {};
 static bool _dspBypass[AUDIO_PIPELINE_MAX_INPUTS]   = {false, false, true, true, false, false, false, false};
 static bool _matrixBypass = false;   // Matrix active: routes input lanes to output channels via gain matrix
 static bool _outputBypass = false;
+static bool _dsdPassthrough = false; // DSD-capable sinks get the raw DoP words of the first DSD lane
 
 // ===== Registered Input Sources =====
 static AudioInputSource _sources[AUDIO_PIPELINE_MAX_INPUTS] = {
@@ -157,6 +190,18 @@ static AudioInputSource _sources[AUDIO_PIPELINE_MAX_INPUTS] = {
     AUDIO_INPUT_SOURCE_INIT, AUDIO_INPUT_SOURCE_INIT,
 };
 
+// ===== Input Capture =====
+// Jitter FIFO per lane for sources that report readiness (FIFO allocated in
+// audio_pipeline_set_source). See audio_capture.h.
+static AudioCaptureLane _capture[AUDIO_PIPELINE_MAX_INPUTS] = {};
+
+// ===== DSD Decoding =====
+// DoP lanes are decoded to PCM at the DoP frame rate (dsd_decoder.h). The
+// decimation table is shared; per-lane state is allocated for hardware ADC
+// lanes in audio_pipeline_set_source (PSRAM).
+static DsdDecimTable *_dsdTable = nullptr;
+static DsdLaneDecoder *_dsd[AUDIO_PIPELINE_MAX_INPUTS] = {};
+
 // ===== Registered Output Sinks =====
 static AudioOutputSink _sinks[AUDIO_OUT_MAX_SINKS] = {
     AUDIO_OUTPUT_SINK_INIT, AUDIO_OUTPUT_SINK_INIT,
@@ -190,6 +235,13 @@ static inline void slot_source_store_read_fn(int lane, uint32_t (*fn)(int32_t*,
     __atomic_store_n(&_sources[lane].read, fn, __ATOMIC_RELEASE);
 }
 
+// ===== Lent Lane Blocks =====
+// Blocks a source lent in place this tick (AudioInputSource::borrow):
+// converted straight from the view in pipeline_condition_inputs(), which
+// hands them back; _rawBuf is not written for these lanes.
+static AudioLaneView _laneView[AUDIO_PIPELINE_MAX_INPUTS] = {};
+static bool _laneLent[AUDIO_PIPELINE_MAX_INPUTS] = {};
+
 // ===== No-sink warning flag (reset when first sink is registered) =====
 static bool _noSinkWarned = false;
 
@@ -199,11 +251,19 @@ static bool _noSinkWarned = false;
 static int _gateFadeCount[AUDIO_PIPELINE_MAX_INPUTS] = {};
 
 // ===== DSP Swap Hold State =====
-// Set by audio_pipeline_notify_dsp_swap() (called from Core 0 before dsp_swap_config
-// sets _swapRequested). Causes pipeline_write_output() to use _swapHoldCh[]
+// Set by audio_pipeline_notify_dsp_swap() (input DSP skipping a block during a
+// writer-side config flip, or output_dsp_swap_config()). Causes pipeline_write_output() to use _swapHoldCh[]
 // for one iteration, bridging the DSP-skipped buffer gap with the last good frame.
 static volatile bool _swapPending = false;
 
+// ===== Output Fade State (sample-rate switching) =====
+// _fadeMute is set by audio_pipeline_set_output_fade() (Core 0); the audio
+// task ramps _fadeGain toward it and sets _fadeSilent once a fully muted
+// block has been produced.
+static volatile bool _fadeMute = false;
+static volatile bool _fadeSilent = false;
+static float _fadeGain = 1.0f;
+
 // ===== Task Handle =====
 #ifndef NATIVE_TEST
 static TaskHandle_t _pipelineTaskHandle = NULL;
@@ -225,6 +285,9 @@ static volatile PipelineDiagSnapshot _adcDiag = {};
 // Written by audio_pipeline_task_fn (Core 1), read by main-loop via accessor.
 // Fields are independent aligned primitives — snap-read is safe on ESP32-P4 RISC-V.
 static PipelineTimingMetrics _timingMetrics = {};
+#ifndef NATIVE_TEST
+static AudioBlockCost _blockCost = {};   // Smoothed block time per block size (audio task)
+#endif
 
 // ===== Helpers =====
 static inline float clampf(float x) {
@@ -233,14 +296,6 @@ static inline float clampf(float x) {
     return x;
 }
 
-// Convert interleaved left-justified int32 → float32 normalized [-1, +1]
-static void to_float(const int32_t *raw, float *L, float *R, int frames) {
-    for (int f = 0; f < frames; f++) {
-        L[f] = (float)(raw[f * 2]     >> 8) / MAX_24BIT_F;
-        R[f] = (float)(raw[f * 2 + 1] >> 8) / MAX_24BIT_F;
-    }
-}
-
 // Convert float32 [-1, +1] → interleaved left-justified int32 for DAC
 static void to_int32_lj(const float *L, const float *R, int32_t *raw, int frames) {
     for (int f = 0; f < frames; f++) {
@@ -251,15 +306,20 @@ static void to_int32_lj(const float *L, const float *R, int32_t *raw, int frames
 
 // ===== DoP (DSD-over-PCM) Detection State =====
 // DoP v1.1: the top byte (bits 31..24) of each left-justified 32-bit sample alternates
-// between 0x05 and 0xFA across consecutive frames when DSD content is present.
+// between 0x05 and 0xFA across consecutive frames when DSD content is present
+// (DOP_MARKER_A/B, checked on every frame by audio_input_condition()).
 // We confirm across 3 consecutive DMA buffers before setting isDsd to avoid false positives.
 // Clears after 3 consecutive non-DoP buffers to handle stream transitions gracefully.
-#define DOP_MARKER_A    0x05u
-#define DOP_MARKER_B    0xFAu
 #define DOP_CONFIRM_THR 3    // Consecutive DoP buffers required to assert isDsd
 #define DOP_CLEAR_THR   3    // Consecutive non-DoP buffers required to de-assert isDsd
 static int8_t _dopConfirmCount[AUDIO_PIPELINE_MAX_INPUTS] = {};  // >0: confirm pending; <0: clear pending
 
+// ===== Input Conditioning Results =====
+// Per-lane block statistics from audio_input_condition() after the noise
+// gate (sums reflect what the lane passes on). Metering reads these instead
+// of walking the lane buffers again.
+static AudioInputStats _inStats[AUDIO_PIPELINE_MAX_INPUTS] = {};
+
 // ===== Pipeline Stages =====
 
 static void pipeline_sync_flags() {
@@ -271,12 +331,37 @@ static void pipeline_sync_flags() {
     }
     _matrixBypass = s.pipelineMatrixBypass;
     _outputBypass = s.pipelineOutputBypass;
+    _dsdPassthrough = s.audio.dsdPassthrough;
+}
+
+// Zero-copy read of one lane. Lanes whose raw words are used after
+// conditioning keep the copy into _rawBuf: DoP lanes (decoder, passthrough)
+// and lane 0 (waveform/FFT tap and raw diagnostics).
+static bool pipeline_borrow_lane(int lane) {
+    if (!_sources[lane].borrow || lane == 0 || _sources[lane].isDsd) return false;
+    if (!_laneL[lane] || !_laneR[lane]) return false;
+    _laneLent[lane] = _sources[lane].borrow(&_laneView[lane], (uint32_t)_blockFrames)
+                      == (uint32_t)_blockFrames;
+    return _laneLent[lane];
 }
 
 static void pipeline_read_inputs() {
-    const size_t bufBytes = FRAMES * 2 * sizeof(int32_t);
+    const size_t bufBytes = _blockFrames * 2 * sizeof(int32_t);
+
+    // Snapshot: drain whatever every readiness-capable port has completed,
+    // back to back under one timestamp, so all lanes of this block are
+    // sampled at the same point. Nothing here waits on a port.
+    uint32_t snapUs = micros();
+    for (int lane = 0; lane < AUDIO_PIPELINE_MAX_INPUTS; lane++) {
+        if (!_rawBuf[lane] || _inputBypass[lane] || !_capture[lane].fifo) continue;
+        auto readFn = slot_source_read_fn(lane);
+        if (!readFn || !_sources[lane].available) continue;
+        if (_sources[lane].isActive && !_sources[lane].isActive()) continue;
+        audio_capture_fill(_capture[lane], _sources[lane].available, readFn, snapUs);
+    }
 
     for (int lane = 0; lane < AUDIO_PIPELINE_MAX_INPUTS; lane++) {
+        _laneLent[lane] = false;
         if (!_rawBuf[lane]) continue;  // Not yet allocated (no source registered)
         if (_inputBypass[lane]) {
             memset(_rawBuf[lane], 0, bufBytes);
@@ -290,49 +375,25 @@ static void pipeline_read_inputs() {
         if (readFn) {
             bool active = !_sources[lane].isActive || _sources[lane].isActive();
             if (active) {
-                uint32_t got = readFn(_rawBuf[lane], FRAMES);
-                if (got < (uint32_t)FRAMES) {
-                    memset(&_rawBuf[lane][got * 2], 0, (FRAMES - got) * 2 * sizeof(int32_t));
+                // DMA-backed ports come from the jitter FIFO (zero-padded when
+                // short); software sources lend the block in place if they
+                // can, else are read one block directly
+                bool captured = _sources[lane].available && _capture[lane].fifo;
+                if (!captured && pipeline_borrow_lane(lane)) continue;
+                uint32_t got = captured
+                    ? audio_capture_take(_capture[lane], _rawBuf[lane], (uint32_t)_blockFrames)
+                    : readFn(_rawBuf[lane], _blockFrames);
+                if (!captured && got < (uint32_t)_blockFrames) {
+                    memset(&_rawBuf[lane][got * 2], 0, (_blockFrames - got) * 2 * sizeof(int32_t));
                 }
-                // Apply pre-matrix gain (host volume for USB, input trim for ADC)
-                if (_sources[lane].gainLinear != 1.0f) {
-                    float g = _sources[lane].gainLinear;
-                    for (int s = 0; s < FRAMES * 2; s++) {
-                        _rawBuf[lane][s] = (int32_t)((float)_rawBuf[lane][s] * g);
-                    }
-                }
-
-                // DoP (DSD-over-PCM) detection: check alternating 0x05/0xFA markers in
-                // the top byte of left-justified int32 samples. Hardware ADC lanes only —
-                // software sources (SigGen, USB) cannot carry DoP content.
-                if (_sources[lane].isHardwareAdc && FRAMES >= 2) {
-                    uint8_t b0 = (uint8_t)((uint32_t)_rawBuf[lane][0] >> 24);
-                    uint8_t b1 = (uint8_t)((uint32_t)_rawBuf[lane][2] >> 24);  // frame 1, L sample
-                    bool isDop = ((b0 == DOP_MARKER_A && b1 == DOP_MARKER_B) ||
-                                  (b0 == DOP_MARKER_B && b1 == DOP_MARKER_A));
-
-                    bool wasDsd = _sources[lane].isDsd;
-                    if (isDop) {
-                        if (_dopConfirmCount[lane] < 0) _dopConfirmCount[lane] = 0;
-                        if (_dopConfirmCount[lane] < DOP_CONFIRM_THR) _dopConfirmCount[lane]++;
-                        if (!wasDsd && _dopConfirmCount[lane] >= DOP_CONFIRM_THR) {
-                            _sources[lane].isDsd = true;
-                            appState.audio.laneDsd[lane] = true;
-                            diag_emit(DIAG_AUDIO_DSD_DETECTED, DIAG_SEV_INFO,
-                                      (uint8_t)lane, "Audio", "DoP DSD detected");
-                            LOG_I("[Audio] DoP DSD detected on lane %d", lane);
-                            app_events_signal(EVT_FORMAT_CHANGE);
-                        }
-                    } else {
-                        if (_dopConfirmCount[lane] > 0) _dopConfirmCount[lane] = 0;
-                        if (_dopConfirmCount[lane] > -DOP_CLEAR_THR) _dopConfirmCount[lane]--;
-                        if (wasDsd && _dopConfirmCount[lane] <= -DOP_CLEAR_THR) {
-                            _sources[lane].isDsd = false;
-                            appState.audio.laneDsd[lane] = false;
-                            LOG_I("[Audio] DoP DSD cleared on lane %d", lane);
-                            app_events_signal(EVT_FORMAT_CHANGE);
-                        }
+                if (captured && _sources[lane].isHardwareAdc) {
+                    const AudioCaptureLane &c = _capture[lane];
+                    if (c.stalled && c.emptyBlocks == AUDIO_CAPTURE_STALL_BLOCKS) {
+                        diag_emit(DIAG_AUDIO_CAPTURE_STALL, DIAG_SEV_WARN,
+                                  (uint8_t)lane, "Audio", "Input port stalled");
+                        LOG_W("[Audio] Lane %d port stalled — zero-filled, other lanes unaffected", lane);
                     }
+                    i2s_audio_update_capture_diag(lane, c.stalled, c.stalls, c.underruns, c.overflows);
                 }
             } else {
                 memset(_rawBuf[lane], 0, bufBytes);
@@ -347,87 +408,164 @@ static void pipeline_read_inputs() {
 
 // Noise gate for ADC lanes: prevents PCM1808 noise floor from reaching the DAC.
 // Hysteresis thresholds (5 dB window) prevent rapid toggling near threshold.
-// Fade-out over 2 buffers (~10.7 ms) using PSRAM prev-frame copy prevents click.
+// Fade-out over 2 buffers (~10.7 ms at 256 frames) using PSRAM prev-frame copy prevents click.
 //   OPEN  threshold -65 dBFS: 10^(-65/20) = 5.62e-4 → sq = 3.16e-7 × 512 ≈ 1.62e-4
 //   CLOSE threshold -70 dBFS: 10^(-70/20) = 3.16e-4 → sq = 1.00e-7 × 512 ≈ 5.12e-5
+// Thresholds are sums over a 256-frame block; smaller blocks scale them down.
 static const float GATE_OPEN_THRESH  = 1.62e-4f;  // -65 dBFS
 static const float GATE_CLOSE_THRESH = 5.12e-5f;  // -70 dBFS (5 dB hysteresis window)
 
 static bool _gateOpen[AUDIO_PIPELINE_MAX_INPUTS] = {};  // Gate state per ADC lane (for diagnostics)
 
-static void pipeline_to_float() {
+// DoP confirm / clear hysteresis for one lane, fed by the per-block marker scan
+static void pipeline_update_dop(int lane, bool isDop) {
+    bool wasDsd = _sources[lane].isDsd;
+    if (isDop) {
+        if (_dopConfirmCount[lane] < 0) _dopConfirmCount[lane] = 0;
+        if (_dopConfirmCount[lane] < DOP_CONFIRM_THR) _dopConfirmCount[lane]++;
+        if (!wasDsd && _dopConfirmCount[lane] >= DOP_CONFIRM_THR) {
+            if (_dsd[lane]) dsd_dec_reset(*_dsd[lane]);
+            _sources[lane].isDsd = true;
+            appState.audio.laneDsd[lane] = true;
+            diag_emit(DIAG_AUDIO_DSD_DETECTED, DIAG_SEV_INFO,
+                      (uint8_t)lane, "Audio", "DoP DSD detected");
+            LOG_I("[Audio] DoP DSD detected on lane %d", lane);
+            app_events_signal(EVT_FORMAT_CHANGE);
+        }
+    } else {
+        if (_dopConfirmCount[lane] > 0) _dopConfirmCount[lane] = 0;
+        if (_dopConfirmCount[lane] > -DOP_CLEAR_THR) _dopConfirmCount[lane]--;
+        if (wasDsd && _dopConfirmCount[lane] <= -DOP_CLEAR_THR) {
+            _sources[lane].isDsd = false;
+            appState.audio.laneDsd[lane] = false;
+            LOG_I("[Audio] DoP DSD cleared on lane %d", lane);
+            app_events_signal(EVT_FORMAT_CHANGE);
+        }
+    }
+}
+
+// Stage 2: one fused pass per lane over _rawBuf, or over the block the source
+// lent (audio_input_kernel.h, released right after) — planar float with the
+// pre-matrix trim applied (host volume for USB, input trim for ADC), block
+// sums and peaks for the gate and metering, clip count and DoP marker scan —
+// then the noise gate on the sums. DoP lanes are decoded to PCM from _rawBuf
+// after the scan and trimmed/measured there.
+static void pipeline_condition_inputs() {
     for (int i = 0; i < AUDIO_PIPELINE_MAX_INPUTS; i++) {
         if (!_rawBuf[i] || !_laneL[i] || !_laneR[i]) continue;
-        to_float(_rawBuf[i], _laneL[i], _laneR[i], FRAMES);
+        AudioInputStats &st = _inStats[i];
+        const bool hw = _sources[i].isHardwareAdc;
+        // Software sources (SigGen, USB) cannot carry DoP content
+        if (_laneLent[i]) {
+            const AudioLaneView &v = _laneView[i];
+            audio_input_condition_strided(v.left, v.right, v.stride, _laneL[i], _laneR[i],
+                                          _blockFrames, _sources[i].gainLinear * v.gain, hw, st);
+        } else {
+            audio_input_condition(_rawBuf[i], _laneL[i], _laneR[i], _blockFrames,
+                                  _sources[i].gainLinear, hw, st);
+        }
+        if (hw) pipeline_update_dop(i, st.dop);
+        if (_laneLent[i]) {
+            // DoP confirmed on this very block: the decoder needs the words
+            const AudioLaneView &v = _laneView[i];
+            if (_sources[i].isDsd) audio_input_gather(v.left, v.right, v.stride, _rawBuf[i], _blockFrames);
+            if (_sources[i].release) _sources[i].release((uint32_t)_blockFrames);
+            _laneLent[i] = false;
+        }
+        if (!hw) continue;
 
-        // Noise gate: hardware ADC lanes only (siggen/USB are always clean)
-        if (_sources[i].isHardwareAdc) {
-            float sumSq = 0.0f;
-            for (int f = 0; f < FRAMES; f++) {
-                sumSq += _laneL[i][f] * _laneL[i][f] + _laneR[i][f] * _laneR[i][f];
-            }
-            // Hysteresis: open at -65 dBFS, stay open until -70 dBFS
-            bool open = _gateOpen[i]
-                ? (sumSq >= GATE_CLOSE_THRESH)
-                : (sumSq >= GATE_OPEN_THRESH);
-
-            if (open) {
-                _gateOpen[i] = true;
-                _gateFadeCount[i] = 2;  // Pre-arm: 2 fade buffers ready for next close
-                // Save last clean frame into PSRAM for fade-out
-                if (_gatePrevL[i]) memcpy(_gatePrevL[i], _laneL[i], FRAMES * sizeof(float));
-                if (_gatePrevR[i]) memcpy(_gatePrevR[i], _laneR[i], FRAMES * sizeof(float));
-                // Pass through: _laneL[i] / _laneR[i] unchanged
+        if (_sources[i].isDsd) {
+            // The kernel output is DoP words read as PCM — replace it with
+            // the decoded stream (silence if no decoder could be allocated)
+            if (_dsd[i]) {
+                dsd_decode_dop(*_dsd[i], _rawBuf[i], _laneL[i], _laneR[i], _blockFrames);
             } else {
-                _gateOpen[i] = false;
-                if (_gateFadeCount[i] > 0 && _gatePrevL[i] && _gatePrevR[i]) {
-                    // Fade: count=2 → gain=1.0 (hold last frame), count=1 → gain=0.5
-                    float gain = (float)_gateFadeCount[i] / 2.0f;
-                    for (int f = 0; f < FRAMES; f++) {
-                        _laneL[i][f] = _gatePrevL[i][f] * gain;
-                        _laneR[i][f] = _gatePrevR[i][f] * gain;
-                    }
-                    _gateFadeCount[i]--;
-                } else {
-                    // Fully gated: write silence
-                    memset(_laneL[i], 0, FRAMES * sizeof(float));
-                    memset(_laneR[i], 0, FRAMES * sizeof(float));
+                memset(_laneL[i], 0, _blockFrames * sizeof(float));
+                memset(_laneR[i], 0, _blockFrames * sizeof(float));
+            }
+            audio_input_measure(_laneL[i], _laneR[i], _blockFrames, _sources[i].gainLinear, st);
+        }
+        if (slot_source_read_fn(i) && !_inputBypass[i]) {
+            i2s_audio_update_input_diag(i, st.peakL > st.peakR ? st.peakL : st.peakR,
+                                        st.clipped, (uint32_t)_blockFrames * 2);
+        }
+
+        // Noise gate: hardware ADC lanes only (siggen/USB are always clean)
+        // Hysteresis: open at -65 dBFS, stay open until -70 dBFS
+        const float sumSq = st.sumSqL + st.sumSqR;
+        const float blockScale = (float)_blockFrames / (float)FRAMES_MAX;
+        bool open = _gateOpen[i]
+            ? (sumSq >= GATE_CLOSE_THRESH * blockScale)
+            : (sumSq >= GATE_OPEN_THRESH * blockScale);
+
+        if (open) {
+            _gateOpen[i] = true;
+            _gateFadeCount[i] = 2;  // Pre-arm: 2 fade buffers ready for next close
+            // Save last clean frame into PSRAM for fade-out
+            if (_gatePrevL[i]) memcpy(_gatePrevL[i], _laneL[i], _blockFrames * sizeof(float));
+            if (_gatePrevR[i]) memcpy(_gatePrevR[i], _laneR[i], _blockFrames * sizeof(float));
+            // Pass through: _laneL[i] / _laneR[i] unchanged
+        } else {
+            _gateOpen[i] = false;
+            float sumL = 0.0f, sumR = 0.0f;
+            if (_gateFadeCount[i] > 0 && _gatePrevL[i] && _gatePrevR[i]) {
+                // Fade: count=2 → gain=1.0 (hold last frame), count=1 → gain=0.5
+                float gain = (float)_gateFadeCount[i] / 2.0f;
+                for (int f = 0; f < _blockFrames; f++) {
+                    float l = _gatePrevL[i][f] * gain;
+                    float r = _gatePrevR[i][f] * gain;
+                    _laneL[i][f] = l;
+                    _laneR[i][f] = r;
+                    sumL += l * l;
+                    sumR += r * r;
                 }
+                _gateFadeCount[i]--;
+            } else {
+                // Fully gated: write silence
+                memset(_laneL[i], 0, _blockFrames * sizeof(float));
+                memset(_laneR[i], 0, _blockFrames * sizeof(float));
             }
+            st.sumSqL = sumL;
+            st.sumSqR = sumR;
         }
     }
 }
 
-// Resample per-lane float buffers via ASRC when the source rate differs from
-// the pipeline's operating rate (48kHz). DSD lanes are skipped automatically.
-// Must be called after pipeline_to_float() and before pipeline_run_dsp()
-// so DSP biquad coefficients (computed for 48kHz) are applied to 48kHz data.
+// Bring every lane to the processing rate. Lanes at the I/O rate go through
+// the 2x half-band converter when the processing rate differs (in place,
+// _blockFrames -> _procFrames); lanes whose source runs at another rate go
+// through the ASRC. Decoded DSD lanes arrive at the DoP frame rate and are
+// converted like any other off-rate lane.
+// Must be called after pipeline_condition_inputs() and before pipeline_run_dsp()
+// so DSP coefficients (computed for the processing rate) see data at that rate.
 static void pipeline_resample_inputs() {
     for (int lane = 0; lane < AUDIO_PIPELINE_MAX_INPUTS; lane++) {
-        _laneFrames[lane] = FRAMES;  // Default for non-ASRC and passthrough lanes
+        _laneFrames[lane] = _procFrames;  // Default for converted and passthrough lanes
         if (!_laneL[lane] || !_laneR[lane]) continue;
-        // DSD lanes must not be SRC'd — polyphase filter would corrupt the DoP bitstream
-        if (_sources[lane].isDsd) {
-            asrc_bypass(lane);
+        if (!asrc_is_active(lane)) {
+            const AudioRateStep step = _laneStep[lane];
+            if (step != AUDIO_RATE_SAME && _rawBuf[lane] && _laneHb) {
+                audio_rate_convert(_laneHb[lane * 2],     step, _laneL[lane], _laneL[lane], _blockFrames);
+                audio_rate_convert(_laneHb[lane * 2 + 1], step, _laneR[lane], _laneR[lane], _blockFrames);
+            }
             continue;
         }
-        if (!asrc_is_active(lane)) continue;
 
-        // ASRC processes FRAMES input samples and writes up to ASRC_OUTPUT_FRAMES_MAX output.
+        // ASRC processes _blockFrames input samples and writes up to ASRC_OUTPUT_FRAMES_MAX output.
         // Lane buffers are sized ASRC_OUTPUT_FRAMES_MAX to accommodate upsampled expansion.
-        int outFrames = asrc_process_lane(lane, _laneL[lane], _laneR[lane], FRAMES);
+        int outFrames = asrc_process_lane(lane, _laneL[lane], _laneR[lane], _blockFrames);
         _laneFrames[lane] = outFrames;
 
         // Zero-fill buffer tail for downsampled lanes to prevent stale (unresampled)
         // input data from leaking through DSP and matrix stages. When srcRate > dstRate
-        // (e.g. 96kHz→48kHz), ASRC produces fewer frames than FRAMES; without zero-fill,
-        // positions [outFrames..FRAMES-1] retain raw input-rate floats from pipeline_to_float().
-        if (outFrames < FRAMES) {
-            memset(&_laneL[lane][outFrames], 0, (size_t)(FRAMES - outFrames) * sizeof(float));
-            memset(&_laneR[lane][outFrames], 0, (size_t)(FRAMES - outFrames) * sizeof(float));
+        // (e.g. 96kHz→48kHz), ASRC produces fewer frames than _procFrames; without zero-fill,
+        // positions [outFrames.._procFrames-1] retain raw input-rate floats from pipeline_condition_inputs().
+        if (outFrames < _procFrames) {
+            memset(&_laneL[lane][outFrames], 0, (size_t)(_procFrames - outFrames) * sizeof(float));
+            memset(&_laneR[lane][outFrames], 0, (size_t)(_procFrames - outFrames) * sizeof(float));
         }
-        // When upsampling (outFrames > FRAMES), extra samples beyond FRAMES are valid but
-        // unused by downstream stages (DSP/matrix operate on fixed FRAMES). The ASRC phase
+        // When upsampling (outFrames > _procFrames), extra samples beyond _procFrames are valid but
+        // unused by downstream stages (DSP/matrix operate on _procFrames). The ASRC phase
         // accumulator is persistent, so no audio drift occurs from this truncation.
     }
 }
@@ -436,9 +574,8 @@ static void pipeline_run_dsp() {
 #ifdef DSP_ENABLED
     // Float-native DSP — no int32 bridge needed (saves ~2KB + 4 conversion loops)
     for (int lane = 0; lane < AUDIO_PIPELINE_MAX_INPUTS; lane++) {
-        // Skip DSP for DSD lanes: applying biquad IIR to DoP data corrupts the bitstream
-        if (_dspBypass[lane] || _sources[lane].isDsd || !_laneL[lane] || !_laneR[lane]) continue;
-        dsp_process_buffer_float(_laneL[lane], _laneR[lane], FRAMES, lane);
+        if (_dspBypass[lane] || !_laneL[lane] || !_laneR[lane]) continue;
+        dsp_process_buffer_float(_laneL[lane], _laneR[lane], _procFrames, lane);
     }
 #else
     (void)_dspBypass;
@@ -452,11 +589,11 @@ static void pipeline_mix_matrix() {
     if (_matrixBypass) {
         // Identity passthrough: ADC1 L/R → output ch 0/1, rest zeroed
         if (_laneL[0] && _laneR[0]) {
-            memcpy(_outCh[0], _laneL[0], FRAMES * sizeof(float));
-            memcpy(_outCh[1], _laneR[0], FRAMES * sizeof(float));
+            memcpy(_outCh[0], _laneL[0], _procFrames * sizeof(float));
+            memcpy(_outCh[1], _laneR[0], _procFrames * sizeof(float));
         }
         for (int o = 2; o < AUDIO_PIPELINE_MATRIX_SIZE; o++) {
-            if (_outCh[o]) memset(_outCh[o], 0, FRAMES * sizeof(float));
+            if (_outCh[o]) memset(_outCh[o], 0, _procFrames * sizeof(float));
         }
         return;
     }
@@ -472,18 +609,18 @@ static void pipeline_mix_matrix() {
     // Lazy-allocate PSRAM scratch buffer for scaled copy
     static float *_matrixTemp = nullptr;
     if (!_matrixTemp) {
-        _matrixTemp = (float *)psram_alloc(FRAMES, sizeof(float), "pipe_matrix");
+        _matrixTemp = (float *)psram_alloc(FRAMES_MAX, sizeof(float), "pipe_matrix");
     }
     if (!_matrixTemp) return;
 
     for (int o = 0; o < AUDIO_PIPELINE_MATRIX_SIZE; o++) {
         if (!_outCh[o]) continue;
-        memset(_outCh[o], 0, FRAMES * sizeof(float));
+        memset(_outCh[o], 0, _procFrames * sizeof(float));
         for (int i = 0; i < AUDIO_PIPELINE_MATRIX_SIZE; i++) {
             float gain = _matrixGain[o][i];
             if (gain == 0.0f || !inCh[i]) continue;
-            dsps_mulc_f32(inCh[i], _matrixTemp, FRAMES, gain, 1, 1);
-            dsps_add_f32(_outCh[o], _matrixTemp, _outCh[o], FRAMES, 1, 1, 1);
+            dsps_mulc_f32(inCh[i], _matrixTemp, _procFrames, gain, 1, 1);
+            dsps_add_f32(_outCh[o], _matrixTemp, _outCh[o], _procFrames, 1, 1, 1);
         }
     }
 
@@ -491,23 +628,23 @@ static void pipeline_mix_matrix() {
     if (!_swapPending) {
         for (int o = 0; o < AUDIO_PIPELINE_MATRIX_SIZE; o++) {
             if (_swapHoldCh[o] && _outCh[o]) {
-                memcpy(_swapHoldCh[o], _outCh[o], FRAMES * sizeof(float));
+                memcpy(_swapHoldCh[o], _outCh[o], _procFrames * sizeof(float));
             }
         }
     }
 #else
     // No ESP-DSP available (native without lib): fall back to identity
     if (_laneL[0] && _laneR[0]) {
-        memcpy(_outCh[0], _laneL[0], FRAMES * sizeof(float));
-        memcpy(_outCh[1], _laneR[0], FRAMES * sizeof(float));
+        memcpy(_outCh[0], _laneL[0], _procFrames * sizeof(float));
+        memcpy(_outCh[1], _laneR[0], _procFrames * sizeof(float));
     }
     for (int o = 2; o < AUDIO_PIPELINE_MATRIX_SIZE; o++) {
-        if (_outCh[o]) memset(_outCh[o], 0, FRAMES * sizeof(float));
+        if (_outCh[o]) memset(_outCh[o], 0, _procFrames * sizeof(float));
     }
     if (!_swapPending) {
         for (int o = 0; o < AUDIO_PIPELINE_MATRIX_SIZE; o++) {
             if (_swapHoldCh[o] && _outCh[o]) {
-                memcpy(_swapHoldCh[o], _outCh[o], FRAMES * sizeof(float));
+                memcpy(_swapHoldCh[o], _outCh[o], _procFrames * sizeof(float));
             }
         }
     }
@@ -518,15 +655,42 @@ static void pipeline_run_output_dsp() {
 #ifdef DSP_ENABLED
     for (int ch = 0; ch < AUDIO_PIPELINE_MATRIX_SIZE; ch++) {
         if (!_outCh[ch]) continue;
-        output_dsp_process(ch, _outCh[ch], FRAMES);
+        output_dsp_process(ch, _outCh[ch], _procFrames);
     }
 #endif
 }
 
+// Rate-switch fade over every output channel — nothing to do at unity. The
+// swap hold buffer follows the same ramp so a held block cannot jump back to
+// full level. DoP passthrough words are sent unscaled (scaling would destroy
+// the markers); they stop with the pause that follows the fade.
+static void pipeline_fade_output() {
+    const bool mute = _fadeMute;
+    if (!mute && _fadeGain == 1.0f) return;
+    if (_swapPending) {
+        audio_output_fade(_swapHoldCh, AUDIO_PIPELINE_MATRIX_SIZE, _procFrames, _fadeGain, mute);
+    }
+    _fadeGain = audio_output_fade(_outCh, AUDIO_PIPELINE_MATRIX_SIZE, _procFrames, _fadeGain, mute);
+    _fadeSilent = mute && _fadeGain == 0.0f;
+}
+
 static void pipeline_write_output() {
     if (_outputBypass || !_outCh[0] || !_outCh[1]) return;
 #ifdef DAC_ENABLED
     if (_sinkCount > 0) {
+        // DSD passthrough: the first DSD lane's DoP words go to DSD-capable
+        // sinks bit-exact (no volume — scaling would destroy the markers);
+        // every other sink plays the decoded PCM from the matrix
+        int dopLane = -1;
+        if (_dsdPassthrough) {
+            for (int lane = 0; lane < AUDIO_PIPELINE_MAX_INPUTS; lane++) {
+                if (_sources[lane].isDsd && _rawBuf[lane] && _laneL[lane] && _laneR[lane]) {
+                    dopLane = lane;
+                    break;
+                }
+            }
+        }
+
         // Sink dispatch path: iterate all slots up to AUDIO_OUT_MAX_SINKS so that
         // slot-indexed sinks with gaps between them (e.g., slot 0 empty, slot 1 active)
         // are still dispatched. Empty slots are skipped by the write/isReady checks below.
@@ -544,37 +708,66 @@ static void pipeline_write_output() {
             if (chL >= AUDIO_PIPELINE_MATRIX_SIZE) continue;
             if (chR >= AUDIO_PIPELINE_MATRIX_SIZE) chR = chL;
 
+            const bool dop = dopLane >= 0 && sink->supportsDsd;
             const float *srcL = (_swapPending && _swapHoldCh[chL]) ? _swapHoldCh[chL] : _outCh[chL];
             const float *srcR = (_swapPending && _swapHoldCh[chR]) ? _swapHoldCh[chR] : _outCh[chR];
+            if (dop) {
+                srcL = _laneL[dopLane];   // Metered from the decoded lane
+                srcR = _laneR[dopLane];
+            }
             if (!srcL || !srcR) continue;
             if (!_sinkBuf[s]) continue;  // DMA buffer not yet allocated for this slot
 
-            if (sink->gainLinear != 1.0f) {
+            // A sink clocked a factor of two away from the processing rate
+            // (the I/O rate unless it reports its own) gets its own half-band
+            // conversion; DoP words stay at the I/O rate they arrived at
+            int frames = _procFrames;
+            uint32_t meterRate = _procRate ? _procRate : AppState::getInstance().audio.sampleRate;
+            if (!dop && _sinkHb && _sinkConvL && _sinkConvR) {
+                const uint32_t sinkRate = sink->sampleRate ? sink->sampleRate : _ioRate;
+                const AudioRateStep step = audio_sink_step((uint32_t)_procFrames, _procRate, sinkRate, FRAMES_MAX);
+                if (step != _sinkStep[s]) {
+                    audio_hb_reset(_sinkHb[s * 2]);
+                    audio_hb_reset(_sinkHb[s * 2 + 1]);
+                    _sinkStep[s] = step;
+                }
+                if (step != AUDIO_RATE_SAME) {
+                    frames = audio_rate_convert(_sinkHb[s * 2], step, srcL, _sinkConvL, _procFrames);
+                    audio_rate_convert(_sinkHb[s * 2 + 1], step, srcR, _sinkConvR, _procFrames);
+                    srcL = _sinkConvL;
+                    srcR = _sinkConvR;
+                    meterRate = sinkRate;
+                }
+            }
+
+            if (dop) {
+                memcpy(_sinkBuf[s], _rawBuf[dopLane], (size_t)_blockFrames * 2 * sizeof(int32_t));
+            } else if (sink->gainLinear != 1.0f) {
                 float g = sink->gainLinear;
-                for (int f = 0; f < FRAMES; f++) {
+                for (int f = 0; f < frames; f++) {
                     float l = clampf(srcL[f] * g);
                     float r = clampf(srcR[f] * g);
                     _sinkBuf[s][f * 2]     = (int32_t)(l * MAX_24BIT_F) << 8;
                     _sinkBuf[s][f * 2 + 1] = (int32_t)(r * MAX_24BIT_F) << 8;
                 }
             } else {
-                to_int32_lj(srcL, srcR, _sinkBuf[s], FRAMES);
+                to_int32_lj(srcL, srcR, _sinkBuf[s], frames);
             }
-            writeFn(_sinkBuf[s], FRAMES);
+            writeFn(_sinkBuf[s], dop ? _blockFrames : frames);
 
             // Compute output sink VU metering
             {
                 float sinkSumSqL = 0, sinkSumSqR = 0;
-                float sg = sink->gainLinear;
-                for (int f = 0; f < FRAMES; f++) {
+                float sg = dop ? 1.0f : sink->gainLinear;
+                for (int f = 0; f < frames; f++) {
                     float l = srcL[f] * sg;
                     float r = srcR[f] * sg;
                     sinkSumSqL += l * l;
                     sinkSumSqR += r * r;
                 }
-                float sinkRmsL = sqrtf(sinkSumSqL / FRAMES);
-                float sinkRmsR = sqrtf(sinkSumSqR / FRAMES);
-                float sinkDt = (float)FRAMES * 1000.0f / (float)AppState::getInstance().audio.sampleRate;
+                float sinkRmsL = sqrtf(sinkSumSqL / frames);
+                float sinkRmsR = sqrtf(sinkSumSqR / frames);
+                float sinkDt = (float)frames * 1000.0f / (float)meterRate;
                 sink->_vuSmoothedL = audio_vu_update(sink->_vuSmoothedL, sinkRmsL, sinkDt);
                 sink->_vuSmoothedR = audio_vu_update(sink->_vuSmoothedR, sinkRmsR, sinkDt);
                 sink->vuL = (sink->_vuSmoothedL > 1e-9f) ? 20.0f * log10f(sink->_vuSmoothedL) : -90.0f;
@@ -606,17 +799,24 @@ static struct {
 static void pipeline_update_metering() {
     if (!_laneL[0] || !_laneR[0]) return;
 
-    float sumSqL = 0.0f, sumSqR = 0.0f;
-    for (int f = 0; f < FRAMES; f++) {
-        sumSqL += _laneL[0][f] * _laneL[0][f];
-        sumSqR += _laneR[0][f] * _laneR[0][f];
-    }
-    float rms1 = sqrtf(sumSqL / FRAMES);
-    float rms2 = sqrtf(sumSqR / FRAMES);
-    float rmsCombined = sqrtf((sumSqL + sumSqR) / (FRAMES * 2));
+    // Under DSP load, meter every Nth block; the VU ballistics step over the
+    // whole skipped span
+    int meterDiv = 1;
+#ifdef DSP_ENABLED
+    static int skipped = 0;
+    meterDiv = dsp_gov_meter_divider(dsp_get_governor_level());
+    if (++skipped < meterDiv) return;
+    skipped = 0;
+#endif
+
+    // Block sums come from input conditioning (post-trim, post-gate)
+    float sumSqL = _inStats[0].sumSqL, sumSqR = _inStats[0].sumSqR;
+    float rms1 = sqrtf(sumSqL / _blockFrames);
+    float rms2 = sqrtf(sumSqR / _blockFrames);
+    float rmsCombined = sqrtf((sumSqL + sumSqR) / (_blockFrames * 2));
     float dbfs = (rmsCombined > 1e-9f) ? 20.0f * log10f(rmsCombined) : -96.0f;
 
-    float dt_ms = (float)FRAMES * 1000.0f / (float)AppState::getInstance().audio.sampleRate;
+    float dt_ms = (float)(_blockFrames * meterDiv) * 1000.0f / (float)AppState::getInstance().audio.sampleRate;
     _meterState.vu1        = audio_vu_update(_meterState.vu1, rms1, dt_ms);
     _meterState.vu2        = audio_vu_update(_meterState.vu2, rms2, dt_ms);
     _meterState.vuCombined = audio_vu_update(_meterState.vuCombined, rmsCombined, dt_ms);
@@ -652,14 +852,10 @@ static void pipeline_update_metering() {
         if (!_sources[lane].isActive || !_sources[lane].isActive()) continue;
         if (!_laneL[lane] || !_laneR[lane]) continue;
 
-        float srcSumSqL = 0.0f, srcSumSqR = 0.0f;
-        for (int f = 0; f < FRAMES; f++) {
-            srcSumSqL += _laneL[lane][f] * _laneL[lane][f];
-            srcSumSqR += _laneR[lane][f] * _laneR[lane][f];
-        }
-        float srcRmsL = sqrtf(srcSumSqL / FRAMES);
-        float srcRmsR = sqrtf(srcSumSqR / FRAMES);
-        float srcDt = (float)FRAMES * 1000.0f / (float)AppState::getInstance().audio.sampleRate;
+        float srcSumSqL = _inStats[lane].sumSqL, srcSumSqR = _inStats[lane].sumSqR;
+        float srcRmsL = sqrtf(srcSumSqL / _blockFrames);
+        float srcRmsR = sqrtf(srcSumSqR / _blockFrames);
+        float srcDt = (float)(_blockFrames * meterDiv) * 1000.0f / (float)AppState::getInstance().audio.sampleRate;
         _sources[lane]._vuSmoothedL = audio_vu_update(_sources[lane]._vuSmoothedL, srcRmsL, srcDt);
         _sources[lane]._vuSmoothedR = audio_vu_update(_sources[lane]._vuSmoothedR, srcRmsR, srcDt);
         _sources[lane].vuL = (_sources[lane]._vuSmoothedL > 1e-9f)
@@ -684,8 +880,8 @@ static void pipeline_update_metering() {
 
 // ===== FreeRTOS Task =====
 #ifndef NATIVE_TEST
-// ~5000ms / (DMA_BUF_LEN * 1000 / sample_rate + 2ms yield) ≈ every 2500 iterations at 48kHz/512
-static const uint32_t DUMP_INTERVAL_LOOPS = 2500;
+// ~5000ms of frames at 48kHz (the loop is clocked by RX DMA, one block per iteration)
+static const uint32_t DUMP_INTERVAL_FRAMES = 5000UL * 48UL;
 
 static void audio_pipeline_task_fn(void * /*param*/) {
     // Create I2S channels here (Core 1) so the DMA ISR is pinned to Core 1,
@@ -698,7 +894,8 @@ static void audio_pipeline_task_fn(void * /*param*/) {
     // Note: IDF5.5 esp_task_wdt_delete() has a linked-list corruption bug on
     // task termination — not a concern here since this task never exits.
     esp_task_wdt_add(NULL);
-    uint32_t loopCount = 0;
+    i2s_audio_set_block_notify(xTaskGetCurrentTaskHandle());
+    uint32_t dumpFrames = 0;
     while (true) {
         esp_task_wdt_reset();
 
@@ -712,15 +909,31 @@ static void audio_pipeline_task_fn(void * /*param*/) {
             continue;
         }
 
+        // --- Wait for the next block ---
+        // Block on the RX DMA completion notification (audio_scheduler.h); the
+        // timeout keeps the WDT fed and software sources flowing if the I2S
+        // clock stops. Stale blocks are discarded after a long stall.
+        AudioScheduler *sched = i2s_audio_scheduler();
+        bool clocked = false;
+        if (sched) {
+            while (audio_sched_pending(*sched) == 0 &&
+                   ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(AUDIO_SCHED_WAIT_MS)) > 0) {}
+            if (audio_sched_pending(*sched) > 0) {
+                uint32_t stale = audio_sched_begin(*sched);
+                if (stale) i2s_audio_discard_blocks(stale);
+                clocked = true;
+            }
+        }
+
         pipeline_sync_flags();
 
         // --- Timing: input read ---
         uint32_t _tE2eStart      = micros();
         uint32_t _tInputStart    = _tE2eStart;
         pipeline_read_inputs();
+        pipeline_condition_inputs();
         uint32_t _tInputEnd      = micros();
 
-        pipeline_to_float();
         pipeline_resample_inputs();
 
         // --- Timing: per-input DSP ---
@@ -741,14 +954,17 @@ static void audio_pipeline_task_fn(void * /*param*/) {
 
         // --- Timing: sink write ---
         uint32_t _tSinkStart     = _tOutDspEnd;
+        pipeline_fade_output();
         pipeline_write_output();
         uint32_t _tSinkEnd       = micros();
 
+        if (clocked) audio_sched_end(*sched, micros(), i2s_audio_tx_queued_frames());
+
         pipeline_update_metering();
 
-        // Commit timing snapshot — compute buffer period from DMA config constants.
-        // FRAMES is stereo frame count; at 48kHz one mono sample = 1/48000 s.
-        // Buffer period = FRAMES samples / 48000 Hz × 1e6 µs ≈ 2667 µs for FRAMES=128.
+        // Commit timing snapshot — buffer period of one block (the scheduler's
+        // period when clocked, else _blockFrames at the I/O rate, 48 kHz before
+        // the channels exist: 5333 µs at 256 frames).
         {
             uint32_t _tFrameEnd   = _tSinkEnd;
             uint32_t frameUs      = _tFrameEnd     - _tFrameStart;
@@ -757,9 +973,8 @@ static void audio_pipeline_task_fn(void * /*param*/) {
             uint32_t inputReadUs  = _tInputEnd     - _tInputStart;
             uint32_t inputDspUs   = _tInputDspEnd  - _tInputDspStart;
             uint32_t sinkWriteUs  = _tSinkEnd      - _tSinkStart;
-            // Buffer period in µs: FRAMES stereo pairs at 48 kHz (compile-time constant)
-            static const uint32_t BUF_PERIOD_US =
-                (uint32_t)((uint64_t)FRAMES * 1000000ULL / 48000ULL);
+            const uint32_t BUF_PERIOD_US = clocked ? sched->periodUs :
+                (uint32_t)((uint64_t)_blockFrames * 1000000ULL / (_ioRate ? _ioRate : 48000ULL));
             float cpuPct = (BUF_PERIOD_US > 0)
                            ? (frameUs * 100.0f / (float)BUF_PERIOD_US)
                            : 0.0f;
@@ -770,17 +985,39 @@ static void audio_pipeline_task_fn(void * /*param*/) {
             _timingMetrics.inputReadUs     = inputReadUs;
             _timingMetrics.perInputDspUs   = inputDspUs;
             _timingMetrics.sinkWriteUs     = sinkWriteUs;
-            _timingMetrics.totalE2eUs      = _tSinkEnd - _tE2eStart;
+            // Clocked: from the RX DMA completion of the block, so the wait
+            // for the read is included
+            _timingMetrics.totalE2eUs      = clocked ? sched->e2eUs : _tSinkEnd - _tE2eStart;
+            _timingMetrics.latencyProfile  = i2s_audio_get_latency_profile();
+            // Fixed cost per block, split from the per-frame cost across the
+            // block sizes this pipeline has run at
+            float overheadUs, perFrameUs;
+            audio_block_cost_add(_blockCost, _blockFrames, (float)(_tSinkEnd - _tInputStart));
+            _timingMetrics.blockFrames     = (uint16_t)_blockFrames;
+            _timingMetrics.procFrames      = (uint16_t)_procFrames;
+            _timingMetrics.procRate        = _procRate;
+            if (audio_block_cost_fit(_blockCost, overheadUs, perFrameUs)) {
+                _timingMetrics.blockOverheadUs = overheadUs;
+            }
+            if (clocked) {
+                _timingMetrics.inOutLatencyUs  = sched->latencyUs;
+                _timingMetrics.deadlineSlackUs = sched->slackUs;
+                _timingMetrics.minSlackUs      = sched->minSlackUs;
+                _timingMetrics.missedDeadlines = sched->missed;
+                _timingMetrics.droppedBlocks   = sched->dropped;
+                _timingMetrics.dmaRecoveries   = sched->recoveries;
+            }
         }
         // Feed raw ADC1 data into waveform/FFT accumulator for WebSocket graph display.
         // Uses pre-float int32 data; adcIndex 0 = ADC1.
         if (_rawBuf[0]) {
-            i2s_audio_push_waveform_fft(_rawBuf[0], FRAMES, 0);
+            i2s_audio_push_waveform_fft(_rawBuf[0], _blockFrames, 0);
         }
 
         // Schedule periodic serial dump every ~5s (via main loop dirty-flag pattern)
-        if (++loopCount >= DUMP_INTERVAL_LOOPS) {
-            loopCount = 0;
+        dumpFrames += (uint32_t)_blockFrames;
+        if (dumpFrames >= DUMP_INTERVAL_FRAMES) {
+            dumpFrames = 0;
             // Capture raw ADC1 diagnostic snapshot before requesting dump
             if (_rawBuf[0]) {
                 for (int i = 0; i < 8; i++) _adcDiag.raw[i] = _rawBuf[0][i];
@@ -809,10 +1046,10 @@ static void audio_pipeline_task_fn(void * /*param*/) {
             }
         }
 
-        // Yield 2 ticks so loopTask (also on Core 1) gets scheduling time.
-        // loopTask runs the main loop (HTTP, WebSocket, MQTT) at priority 1.
-        // DMA has I2S_DMA_BUF_COUNT buffers = ~64ms runway at 48kHz; 2ms yield is safe.
-        vTaskDelay(2);
+        // Clocked by RX DMA: loopTask (also on Core 1, priority 1) runs while
+        // this task blocks on the next block's notification. Without an RX
+        // channel to wait on, yield 2 ticks as before.
+        if (!sched) vTaskDelay(2);
     }
 }
 #endif
@@ -864,6 +1101,10 @@ void audio_pipeline_init() {
     for (int i = 0; i < AUDIO_PIPELINE_MATRIX_SIZE; i++) {
         _swapHoldCh[i] = _swapHoldCh_buf[i];
     }
+    _laneHb    = _laneHb_buf;
+    _sinkHb    = _sinkHb_buf;
+    _sinkConvL = _sinkConv_buf[0];
+    _sinkConvR = _sinkConv_buf[1];
 #else
     {
         for (int i = 0; i < AUDIO_PIPELINE_MAX_INPUTS; i++) {
@@ -873,22 +1114,31 @@ void audio_pipeline_init() {
     }
     {
         for (int i = 0; i < AUDIO_PIPELINE_MATRIX_SIZE; i++) {
-            _outCh[i] = (float *)psram_alloc(FRAMES, sizeof(float), "pipe_outCh");
+            _outCh[i] = (float *)psram_alloc(FRAMES_MAX, sizeof(float), "pipe_outCh");
         }
     }
     // Noise gate fade-out: PSRAM prev-frame buffers
     {
         for (int i = 0; i < AUDIO_PIPELINE_MAX_INPUTS; i++) {
-            _gatePrevL[i] = (float *)psram_alloc(FRAMES, sizeof(float), "pipe_gate");
-            _gatePrevR[i] = (float *)psram_alloc(FRAMES, sizeof(float), "pipe_gate");
+            _gatePrevL[i] = (float *)psram_alloc(FRAMES_MAX, sizeof(float), "pipe_gate");
+            _gatePrevR[i] = (float *)psram_alloc(FRAMES_MAX, sizeof(float), "pipe_gate");
         }
     }
     // DSP swap hold: PSRAM last-good-output buffer
     {
         for (int i = 0; i < AUDIO_PIPELINE_MATRIX_SIZE; i++) {
-            _swapHoldCh[i] = (float *)psram_alloc(FRAMES, sizeof(float), "pipe_swap");
+            _swapHoldCh[i] = (float *)psram_alloc(FRAMES_MAX, sizeof(float), "pipe_swap");
         }
     }
+    // Processing-rate converters: PSRAM half-band state + one sink block
+    {
+        _laneHb = (AudioHalfbandState *)psram_alloc(AUDIO_PIPELINE_MAX_INPUTS * 2,
+                                                    sizeof(AudioHalfbandState), "pipe_rate");
+        _sinkHb = (AudioHalfbandState *)psram_alloc(AUDIO_OUT_MAX_SINKS * 2,
+                                                    sizeof(AudioHalfbandState), "pipe_rate");
+        _sinkConvL = (float *)psram_alloc(FRAMES_MAX, sizeof(float), "pipe_rate");
+        _sinkConvR = (float *)psram_alloc(FRAMES_MAX, sizeof(float), "pipe_rate");
+    }
     // ===== DMA buffer allocation (internal SRAM) =====
     // Pre-allocate lane 0 rawBuf + slot 0 sinkBuf at init (always-on onboard devices).
     // Remaining lanes/slots are lazy-allocated in set_source()/set_sink().
@@ -975,6 +1225,39 @@ PipelineTimingMetrics audio_pipeline_get_timing() {
     return _timingMetrics;  // Struct copy — snap-read is safe (independent aligned fields)
 }
 
+// Split the configured block between the I/O and processing rates
+static void pipeline_plan_block() {
+    AudioBlockPlan p = audio_block_plan((uint32_t)_blockRequest, _ioRate, _procRate, FRAMES_MAX);
+    if (p.ioFrames != _blockFrames) {
+        for (int i = 0; i < AUDIO_PIPELINE_MAX_INPUTS; i++) audio_capture_reset(_capture[i]);
+    }
+    _blockFrames = p.ioFrames;
+    _procFrames  = p.procFrames;
+    _swapPending = false;   // Hold buffers were filled at the old size
+}
+
+bool audio_pipeline_set_block_frames(int frames) {
+    if (frames <= 0 || !audio_block_frames_valid((uint32_t)frames)) return false;
+    if (frames == _blockRequest) return true;
+    _blockRequest = frames;
+    pipeline_plan_block();
+    LOG_I("[Audio] Pipeline block size: %d frames (%d at the I/O rate, %d processed)",
+          frames, _blockFrames, _procFrames);
+    return true;
+}
+
+int audio_pipeline_get_block_frames() {
+    return _blockRequest;
+}
+
+int audio_pipeline_get_io_frames() {
+    return _blockFrames;
+}
+
+int audio_pipeline_get_proc_frames() {
+    return _procFrames;
+}
+
 void audio_pipeline_bypass_input(int lane, bool bypass) {
     if (lane < 0 || lane >= AUDIO_PIPELINE_MAX_INPUTS) return;
     _inputBypass[lane] = bypass;
@@ -1019,8 +1302,8 @@ bool audio_pipeline_is_matrix_bypass() {
 }
 
 void audio_pipeline_notify_dsp_swap() {
-    // Called from dsp_swap_config() (Core 0) before _swapRequested is set.
-    // Signals pipeline_write_output() (Core 1) to use the PSRAM hold buffer for
+    // Called by the input DSP when it skips a block (Core 1) and from
+    // output_dsp_swap_config() (Core 0). Signals pipeline_write_output() (Core 1) to use the PSRAM hold buffer for
     // one iteration, bridging the DSP-skipped buffer gap with the last good frame.
     _swapPending = true;
 }
@@ -1054,6 +1337,30 @@ bool audio_pipeline_set_source(int lane, const AudioInputSource *src) {
               (unsigned)(RAW_SAMPLES * sizeof(int32_t)));
         heap_budget_record("pipe_rawBuf_lazy", RAW_SAMPLES * sizeof(int32_t), false);
     }
+    // DSD decoder for ADC lanes that may carry DoP (PSRAM; table built once)
+    if (src->isHardwareAdc && !_dsd[lane]) {
+        if (!_dsdTable) {
+            DsdDecimTable *t = (DsdDecimTable *)psram_alloc(1, sizeof(DsdDecimTable), "pipe_dsd");
+            if (t) dsd_dec_table_init(*t);
+            _dsdTable = t;
+        }
+        DsdLaneDecoder *d = _dsdTable
+            ? (DsdLaneDecoder *)psram_alloc(1, sizeof(DsdLaneDecoder), "pipe_dsd") : nullptr;
+        if (d) {
+            dsd_dec_init(*d, _dsdTable);
+            _dsd[lane] = d;
+        } else {
+            LOG_W("[Audio] No DSD decoder for lane %d — DoP content will be muted", lane);
+        }
+    }
+    // Jitter FIFO for DMA-backed ports (PSRAM — filled and drained by memcpy)
+    if (src->available && !_capture[lane].fifo) {
+        _capture[lane].fifo = (int32_t *)psram_alloc(AUDIO_CAPTURE_FIFO_FRAMES * 2, sizeof(int32_t),
+                                                     "pipe_capture");
+        if (!_capture[lane].fifo) {
+            LOG_W("[Audio] No capture FIFO for lane %d — reading it directly", lane);
+        }
+    }
     // Atomic sentinel swap (no scheduler suspend needed):
     // 1. Null the sentinel so the audio task stops using this lane immediately.
     // 2. Copy all non-sentinel fields into the slot.
@@ -1065,7 +1372,9 @@ bool audio_pipeline_set_source(int lane, const AudioInputSource *src) {
         auto realRead = src->read;
         AudioInputSource tmp = *src;
         tmp.read = nullptr;               // Don't clobber the just-cleared sentinel yet
+        if (!_capture[lane].fifo) tmp.available = nullptr;   // Direct reads without a FIFO
         _sources[lane] = tmp;             // Step 2: copy body (task ignores lane, read==NULL)
+        audio_capture_reset(_capture[lane]);
         slot_source_store_read_fn(lane, realRead);  // Step 3: make live (RELEASE barrier)
     }
 #endif
@@ -1115,10 +1424,10 @@ void audio_pipeline_dump_raw_diag() {
     // --- What to look for ---
     // Left-justified (CORRECT): data in bits 31..8, bottom 8 bits = 0
     //   raw[0] pattern: 0xXXXXXX00  (e.g. 0x00034500 = noise floor ~+843)
-    //   raw[0] >> 8  = ±small value — confirms to_float() is reading right bits
+    //   raw[0] >> 8  = ±small value — confirms input conditioning reads the right bits
     // Right-justified (WRONG): data in bits 23..0, top 8 bits = 0
     //   raw[0] pattern: 0x00XXXXXX  (e.g. 0x00000345 = same noise, different position)
-    //   raw[0] >> 8  = near 0 — to_float() discards all useful bits (sounds silent/corrupt)
+    //   raw[0] >> 8  = near 0 — input conditioning discards all useful bits (sounds silent/corrupt)
     // DC offset: all values biased, minVal and maxVal both far from 0
     // No signal: maxAbs very small (<= 0x00010000) AND nonZero count low
 
@@ -1317,8 +1626,20 @@ void audio_pipeline_resume() {
 #endif
 
 // ===== Matrix Persistence =====
+// The matrix lives in its own A/B snapshot store (config_snapshot.h); the
+// payload is _matrixGain as-is. /pipeline_matrix.json is the pre-snapshot
+// format: still written for settings export/import and read once to migrate.
 
-void audio_pipeline_save_matrix() {
+#ifndef NATIVE_TEST
+// Schema carries the matrix dimension, so a resized build falls back to the
+// JSON path (which places a smaller matrix in the top-left corner)
+#define MATRIX_SNAPSHOT_SCHEMA (0x0100 | AUDIO_PIPELINE_MATRIX_SIZE)
+
+static ConfigSnapshotStore _matrixStore =
+    CONFIG_SNAPSHOT_STORE(CONFIG_SNAPSHOT_BASE_MATRIX, sizeof(_matrixGain));
+#endif
+
+void audio_pipeline_write_matrix_json() {
 #ifndef NATIVE_TEST
     JsonDocument doc;
     JsonArray arr = doc.to<JsonArray>();
@@ -1332,29 +1653,41 @@ void audio_pipeline_save_matrix() {
     if (f) {
         serializeJson(doc, f);
         f.close();
-        LOG_I("[Audio] Matrix saved to /pipeline_matrix.json");
+        LOG_D("[Audio] Matrix written to /pipeline_matrix.json");
     }
 #endif
 }
 
-void audio_pipeline_load_matrix() {
+void audio_pipeline_save_matrix() {
 #ifndef NATIVE_TEST
+    ConfigSnapshotResult r = config_snapshot_store_save(_matrixStore, MATRIX_SNAPSHOT_SCHEMA,
+                                                        _matrixGain, sizeof(_matrixGain));
+    if (r != CFG_SNAP_OK) {
+        LOG_E("[Audio] Matrix snapshot save failed (%d)", (int)r);
+        return;
+    }
+    LOG_I("[Audio] Matrix saved (snapshot gen %lu)", (unsigned long)_matrixStore.stats.generation);
+#endif
+}
+
+#ifndef NATIVE_TEST
+static bool loadMatrixJson() {
     File f = LittleFS.open("/pipeline_matrix.json", "r");
-    if (!f) return;  // No saved matrix — keep defaults
+    if (!f) return false;  // No saved matrix — keep defaults
 
     JsonDocument doc;
     DeserializationError err = deserializeJson(doc, f);
     f.close();
     if (err) {
         LOG_W("[Audio] Matrix load parse error: %s", err.c_str());
-        return;
+        return false;
     }
 
     JsonArray arr = doc.as<JsonArray>();
     int oldSize = (int)arr.size();
     if (oldSize == 0 || oldSize > AUDIO_PIPELINE_MATRIX_SIZE) {
         LOG_W("[Audio] Matrix load: invalid size %d (max %d)", oldSize, AUDIO_PIPELINE_MATRIX_SIZE);
-        return;
+        return false;
     }
     // Backward compat: smaller matrix (e.g. 8x8 from older firmware) placed in top-left corner
     if (oldSize < AUDIO_PIPELINE_MATRIX_SIZE) {
@@ -1375,6 +1708,21 @@ void audio_pipeline_load_matrix() {
         }
     }
     LOG_I("[Audio] Matrix loaded from /pipeline_matrix.json (%dx%d)", oldSize, oldSize);
+    return true;
+}
+#endif
+
+void audio_pipeline_load_matrix() {
+#ifndef NATIVE_TEST
+    // The store verifies a slot before copying, so a miss leaves the defaults
+    size_t len = 0;
+    ConfigSnapshotResult r = config_snapshot_store_load(_matrixStore, MATRIX_SNAPSHOT_SCHEMA,
+                                                        _matrixGain, sizeof(_matrixGain), &len);
+    if (r == CFG_SNAP_OK && len == sizeof(_matrixGain)) {
+        LOG_I("[Audio] Matrix loaded from snapshot (gen %lu)", (unsigned long)_matrixStore.stats.generation);
+        return;
+    }
+    if (loadMatrixJson()) audio_pipeline_save_matrix();  // One-time migration
 #endif
 }
 
@@ -1463,3 +1811,75 @@ void audio_pipeline_set_lane_src(int lane, uint32_t srcRate, uint32_t dstRate) {
     LOG_I("[Audio] ASRC lane %d: %luHz->%luHz active=%d",
           lane, (unsigned long)srcRate, (unsigned long)dstRate, (int)active);
 }
+
+// ---------------------------------------------------------------------------
+// Processing rate (audio_rate_convert.h)
+// ---------------------------------------------------------------------------
+
+// Route one lane to the processing rate: lanes at the I/O rate (or of
+// unknown rate) through the 2x converter, others through the ASRC
+static void pipeline_route_lane(int lane, uint32_t rate) {
+    const uint32_t ioRate = _ioRate ? _ioRate : appState.audio.sampleRate;
+    const uint32_t procRate = _procRate ? _procRate : ioRate;
+    if (rate == 0 || rate == ioRate) {
+        asrc_set_ratio(lane, ioRate, ioRate);   // Passthrough
+        _laneStep[lane] = audio_rate_step(ioRate, procRate);
+    } else {
+        _laneStep[lane] = AUDIO_RATE_SAME;
+        asrc_set_ratio(lane, rate, procRate);
+    }
+    appState.audio.laneSrcActive[lane] = asrc_is_active(lane) || _laneStep[lane] != AUDIO_RATE_SAME;
+}
+
+void audio_pipeline_route_lanes() {
+    for (int lane = 0; lane < AUDIO_PIPELINE_MAX_INPUTS; lane++) {
+        pipeline_route_lane(lane, appState.audio.laneSampleRates[lane]);
+    }
+}
+
+uint32_t audio_pipeline_set_rates(uint32_t ioRate, uint32_t procRate) {
+    uint32_t eff = audio_proc_rate_resolve(ioRate, procRate);
+    if (eff != ioRate && (!_laneHb || !_sinkHb || !_sinkConvL || !_sinkConvR)) {
+        LOG_W("[Audio] No memory for rate converters, processing at %lu Hz", (unsigned long)ioRate);
+        eff = ioRate;
+    }
+    _ioRate = ioRate;
+    _procRate = eff;
+    pipeline_plan_block();
+
+    // Converter history belongs to the old rates
+    if (_laneHb) {
+        for (int i = 0; i < AUDIO_PIPELINE_MAX_INPUTS * 2; i++) audio_hb_reset(_laneHb[i]);
+    }
+    if (_sinkHb) {
+        for (int i = 0; i < AUDIO_OUT_MAX_SINKS * 2; i++) audio_hb_reset(_sinkHb[i]);
+    }
+    memset(_sinkStep, 0, sizeof(_sinkStep));
+
+    for (int lane = 0; lane < AUDIO_PIPELINE_MAX_INPUTS; lane++) {
+        const AudioInputSource *src = audio_pipeline_get_source(lane);
+        uint32_t rate = (src && src->getSampleRate) ? src->getSampleRate() : 0;
+        appState.audio.laneSampleRates[lane] = rate;
+        pipeline_route_lane(lane, rate);
+    }
+    LOG_I("[Audio] I/O %lu Hz, processing %lu Hz: %d -> %d frames per block",
+          (unsigned long)ioRate, (unsigned long)eff, _blockFrames, _procFrames);
+    return eff;
+}
+
+uint32_t audio_pipeline_get_processing_rate() {
+    return _procRate;
+}
+
+// ---------------------------------------------------------------------------
+// Output fade (sample-rate switching)
+// ---------------------------------------------------------------------------
+
+void audio_pipeline_set_output_fade(bool mute) {
+    _fadeSilent = false;
+    _fadeMute = mute;
+}
+
+bool audio_pipeline_output_faded() {
+    return _fadeSilent;
+}
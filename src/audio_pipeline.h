@@ -35,8 +35,9 @@ void audio_pipeline_set_matrix_gain_db(int out_ch, int in_ch, float gain_db);
 float audio_pipeline_get_matrix_gain(int out_ch, int in_ch);
 bool  audio_pipeline_is_matrix_bypass();
 
-// Called from dsp_swap_config() before _swapRequested is set — arms the
-// PSRAM hold buffer so pipeline_write_output() uses last good frame during the swap gap
+// Called when the input DSP skips a block (a writer-side config flip was in
+// progress) and from output_dsp_swap_config() — arms the PSRAM hold buffer so
+// pipeline_write_output() uses last good frame during the swap gap
 #ifdef NATIVE_TEST
 inline void audio_pipeline_notify_dsp_swap() {}  // No-op in native test (single-threaded)
 #else
@@ -53,14 +54,51 @@ struct PipelineTimingMetrics {
     uint32_t outputDspUs;     // Output DSP stage time (us)
     float    totalCpuPercent; // CPU load based on totalFrameUs (0-100 %)
     // Per-stage breakdown (added in foundation hardening)
-    uint32_t inputReadUs;     // All-lane I2S read time (us)
+    uint32_t inputReadUs;     // All-lane read + input conditioning time (us)
     uint32_t perInputDspUs;   // Per-input DSP processing time (us)
     uint32_t sinkWriteUs;     // All-sink write time (us)
-    uint32_t totalE2eUs;      // Full end-to-end: input read through sink write (us)
+    uint32_t totalE2eUs;      // Full end-to-end: input read (RX DMA completion when clocked) through sink write (us)
+    // DMA-driven scheduling (audio_scheduler.h) — zero while no RX channel clocks the pipeline
+    uint32_t inOutLatencyUs;  // Input sample → output DMA: capture + processing + queued TX (us)
+    int32_t  deadlineSlackUs; // Block period - totalE2eUs, last block (< 0 = deadline missed)
+    int32_t  minSlackUs;      // Worst slack since the channels were created
+    uint32_t missedDeadlines; // Blocks written after the next block had arrived
+    uint32_t droppedBlocks;   // Blocks discarded by recovery or overwritten by RX DMA
+    uint32_t dmaRecoveries;   // Times the scheduler discarded a backlog
+    uint8_t  latencyProfile;  // AudioLatencyProfile in effect
+    uint16_t blockFrames;     // Pipeline block size in effect (frames at the I/O rate)
+    uint16_t procFrames;      // Frames processed per block at the processing rate
+    uint32_t procRate;        // Internal processing rate (Hz, 0 = not set, I/O rate)
+    float    blockOverheadUs; // Fixed cost per block, fitted across block sizes run so far (0 = one size only)
 };
 
 PipelineTimingMetrics audio_pipeline_get_timing();
 
+// Pipeline block size: 32, 64, 128 or 256 frames (audio_scheduler.h). Every
+// buffer is sized for 256; each stage processes the current block length.
+// Call only while the audio task is paused (i2s_audio_set_block_frames()
+// pauses it and re-clocks the DMA to match). Returns false if unsupported.
+// get_block_frames() is the configured size; with a processing rate twice
+// the I/O rate a 256-frame block reads 128 frames and processes 256
+// (audio_block_plan()): get_io_frames() clocks the DMA, get_proc_frames()
+// is what the DSP stages run on.
+bool audio_pipeline_set_block_frames(int frames);
+int  audio_pipeline_get_block_frames();
+int  audio_pipeline_get_io_frames();
+int  audio_pipeline_get_proc_frames();
+
+// Internal processing rate (audio_rate_convert.h). ioRate is the I2S master
+// rate; procRate 48000 / 96000 is used when it is a factor of two (or one)
+// away from it, AUDIO_PROC_RATE_FOLLOW or any other value processes at the
+// I/O rate. Replans the block, resets the converters and routes every lane:
+// lanes at the I/O rate through the 2x converter, others through the ASRC to
+// the processing rate. Sinks reporting a sampleRate (else the I/O rate) a
+// factor of two away are converted on output. Call only while the audio task
+// is paused; the DSP configs must be staged at the returned rate. Returns the
+// processing rate in effect.
+uint32_t audio_pipeline_set_rates(uint32_t ioRate, uint32_t procRate);
+uint32_t audio_pipeline_get_processing_rate();   // 0 until set_rates()
+
 // Diagnostic — call from main-loop context only (not from audio task)
 void audio_pipeline_dump_raw_diag();
 
@@ -112,9 +150,11 @@ bool audio_pipeline_is_sink_muted(uint8_t slot);
 void  audio_pipeline_set_sink_volume(uint8_t slot, float gain);
 float audio_pipeline_get_sink_volume(uint8_t slot);
 
-// Matrix persistence
+// Matrix persistence (A/B snapshot store; see config_snapshot.h)
 void audio_pipeline_save_matrix();
 void audio_pipeline_load_matrix();
+// Rewrites /pipeline_matrix.json from the live matrix (settings export/import)
+void audio_pipeline_write_matrix_json();
 
 // Format negotiation — call from main-loop context (not audio task).
 // Reads each active source's getSampleRate(), compares against registered
@@ -130,6 +170,19 @@ bool audio_pipeline_check_format();
 // Also updates appState.audio.laneSrcActive[] for WS broadcast.
 void audio_pipeline_set_lane_src(int lane, uint32_t srcRate, uint32_t dstRate);
 
+// Route every lane from appState.audio.laneSampleRates[] to the processing
+// rate (see audio_pipeline_set_rates()). Call from main-loop context when
+// format negotiation reports changed lane rates.
+void audio_pipeline_route_lanes();
+
+// Output fade for sample-rate switching (audio_rate_switch.h). mute=true
+// ramps every output channel to silence over AUDIO_RATE_SWITCH_FADE_FRAMES
+// and holds it there; mute=false ramps back up. Callable from any context —
+// the audio task applies the ramp. faded() is true once a silent block has
+// gone out.
+void audio_pipeline_set_output_fade(bool mute);
+bool audio_pipeline_output_faded();
+
 // Cross-core audio pause/resume protocol.
 // Callers that teardown/reinstall I2S drivers MUST use these instead of
 // directly setting appState.audio.paused.
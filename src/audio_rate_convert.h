@@ -0,0 +1,195 @@
+#pragma once
+// audio_rate_convert.h — Internal processing rate and 2x polyphase rate
+// converters (header-only, no RTOS dependencies).
+//
+// The pipeline processes at its own rate, which may differ from the I2S
+// master (I/O) rate that clocks the blocks: 48 or 96 kHz, at most a factor
+// of two away from the I/O rate (AUDIO_PROC_RATE_FOLLOW runs at the I/O
+// rate, as before). Per block:
+//
+//   read + condition    ioFrames at the I/O rate
+//   lane conversion     ioFrames -> procFrames (x2 / /2), or ASRC for lanes
+//                       whose source runs at yet another rate
+//   DSP, matrix, output DSP, fade     procFrames at the processing rate
+//   sink conversion     procFrames -> the sink's frames (x2 / /2 / none)
+//
+// audio_block_plan() splits the configured block so that neither side
+// exceeds the buffers: ioFrames stays the configured block unless doubling
+// it would overflow, so the block period (and the DMA scheduling) follows
+// the I/O side automatically.
+//
+// Conversion by two is a 63-tap half-band FIR (Kaiser beta 8: passband flat
+// to 0.002 dB up to 20 kHz at 48/96 kHz, stopband from 28 kHz at -80 dB)
+// run in polyphase form: every other tap of a half-band filter is zero and
+// the centre tap is 1/2, so one branch is a pure delay and the other a
+// symmetric 32-tap FIR folded to 16 multiplies per output sample. Converting
+// up and back down delays the signal by AUDIO_HB_ROUND_TRIP (31) frames at
+// the I/O rate, 0.65 ms at 48 kHz.
+
+#include <stdint.h>
+#include <string.h>
+
+#define AUDIO_PROC_RATE_FOLLOW  0       // Process at the I/O rate
+
+// Converter direction from one rate to another
+enum AudioRateStep : int8_t {
+    AUDIO_RATE_DOWN2 = -1,
+    AUDIO_RATE_SAME  = 0,
+    AUDIO_RATE_UP2   = 1,
+    AUDIO_RATE_OTHER = 2                // Not a factor of two (ASRC territory)
+};
+
+static inline bool audio_proc_rate_valid(uint32_t rate) {
+    return rate == AUDIO_PROC_RATE_FOLLOW || rate == 48000 || rate == 96000;
+}
+
+static inline AudioRateStep audio_rate_step(uint32_t from, uint32_t to) {
+    if (from == to || from == 0 || to == 0) return AUDIO_RATE_SAME;
+    if (to == from * 2) return AUDIO_RATE_UP2;
+    if (from == to * 2) return AUDIO_RATE_DOWN2;
+    return AUDIO_RATE_OTHER;
+}
+
+// Processing rate in effect for a requested one: the request if it is a
+// factor of two (or one) away from the I/O rate, else the I/O rate
+// (e.g. 48 kHz processing requested while the I2S runs at 44.1 kHz).
+static inline uint32_t audio_proc_rate_resolve(uint32_t ioRate, uint32_t requested) {
+    if (requested == AUDIO_PROC_RATE_FOLLOW || !audio_proc_rate_valid(requested)) return ioRate;
+    return audio_rate_step(ioRate, requested) == AUDIO_RATE_OTHER ? ioRate : requested;
+}
+
+struct AudioBlockPlan {
+    uint16_t ioFrames;      // Frames read / written per block at the I/O rate
+    uint16_t procFrames;    // Frames processed per block at the processing rate
+};
+
+// blockFrames is the configured block (even, <= maxFrames); procRate must
+// come from audio_proc_rate_resolve()
+static inline AudioBlockPlan audio_block_plan(uint32_t blockFrames, uint32_t ioRate,
+                                              uint32_t procRate, uint32_t maxFrames) {
+    AudioBlockPlan p;
+    switch (audio_rate_step(ioRate, procRate)) {
+        case AUDIO_RATE_UP2: {
+            uint32_t io = blockFrames * 2 <= maxFrames ? blockFrames : maxFrames / 2;
+            p.ioFrames = (uint16_t)io;
+            p.procFrames = (uint16_t)(io * 2);
+            break;
+        }
+        case AUDIO_RATE_DOWN2:
+            p.ioFrames = (uint16_t)blockFrames;
+            p.procFrames = (uint16_t)(blockFrames / 2);
+            break;
+        default:
+            p.ioFrames = p.procFrames = (uint16_t)blockFrames;
+            break;
+    }
+    return p;
+}
+
+// Converter from the processing rate to a sink at sinkRate (0 = the I/O
+// rate, as for the on-board DACs). A sink that is not a factor of two away,
+// or whose converted block would not fit maxFrames, takes the processed
+// block unconverted, as before.
+static inline AudioRateStep audio_sink_step(uint32_t procFrames, uint32_t procRate,
+                                            uint32_t sinkRate, uint32_t maxFrames) {
+    AudioRateStep step = audio_rate_step(procRate, sinkRate);
+    if (step == AUDIO_RATE_OTHER) return AUDIO_RATE_SAME;
+    if (step == AUDIO_RATE_UP2 && procFrames * 2 > maxFrames) return AUDIO_RATE_SAME;
+    return step;
+}
+
+// Frames out of a converter by step for n frames in
+static inline uint32_t audio_rate_step_frames(AudioRateStep step, uint32_t n) {
+    return step == AUDIO_RATE_UP2 ? n * 2 : step == AUDIO_RATE_DOWN2 ? n / 2 : n;
+}
+
+// ===== Half-band 2x converters =====
+
+#define AUDIO_HB_HALF  16                      // Distinct non-zero coefficients
+#define AUDIO_HB_SPAN  (AUDIO_HB_HALF * 2)     // Taps of the filtering branch
+#define AUDIO_HB_HIST  (AUDIO_HB_SPAN - 1)     // Samples carried between blocks
+#define AUDIO_HB_DELAY (AUDIO_HB_HALF - 1)     // Delay branch, in low-rate samples
+#define AUDIO_HB_ROUND_TRIP (AUDIO_HB_SPAN - 1) // Up then down: latency in low-rate frames
+#ifndef AUDIO_HB_MAX_FRAMES
+#define AUDIO_HB_MAX_FRAMES 256                // Largest block on the high-rate side
+#endif
+
+// Half-band taps next to the centre outwards: h[c ± (2m+1)] = kAudioHalfband[m],
+// h[c] = 1/2, sum = 1/4 so the DC gain is exactly one
+static const float kAudioHalfband[AUDIO_HB_HALF] = {
+    3.170728513e-01f, -1.024425021e-01f, 5.772404061e-02f, -3.748937911e-02f,
+    2.563768360e-02f, -1.780469905e-02f, 1.231558223e-02f, -8.376209881e-03f,
+    5.543646654e-03f, -3.534414071e-03f, 2.145908431e-03f, -1.222075923e-03f,
+    6.381063336e-04f, -2.935600618e-04f, 1.090362234e-04f, -2.401525086e-05f,
+};
+
+// One mono converter: the low-rate history of the filtering branch and, for
+// decimation, of the delay branch
+struct AudioHalfbandState {
+    float hist[AUDIO_HB_HIST];
+    float odd[AUDIO_HB_HALF];
+};
+
+static inline void audio_hb_reset(AudioHalfbandState &s) {
+    memset(&s, 0, sizeof(s));
+}
+
+// Folded filtering branch ending at p: taps p, p-1 ... p-31
+static inline float _audio_hb_branch(const float *p) {
+    float acc = 0.0f;
+    for (int k = 0; k < AUDIO_HB_HALF; k++) {
+        acc += kAudioHalfband[AUDIO_HB_HALF - 1 - k] * (p[-k] + p[-(AUDIO_HB_SPAN - 1) + k]);
+    }
+    return acc;
+}
+
+// n input frames -> 2n output frames, 2n <= AUDIO_HB_MAX_FRAMES. in and
+// out may be the same buffer (out must hold 2n).
+static inline void audio_hb_up2(AudioHalfbandState &s, const float *in, float *out, int n) {
+    float buf[AUDIO_HB_HIST + AUDIO_HB_MAX_FRAMES / 2];
+    if (n > AUDIO_HB_MAX_FRAMES / 2) n = AUDIO_HB_MAX_FRAMES / 2;
+    memcpy(buf, s.hist, sizeof(s.hist));
+    memcpy(buf + AUDIO_HB_HIST, in, (size_t)n * sizeof(float));
+    for (int i = 0; i < n; i++) {
+        const float *p = buf + AUDIO_HB_HIST + i;
+        out[2 * i]     = 2.0f * _audio_hb_branch(p);
+        out[2 * i + 1] = p[-AUDIO_HB_DELAY];
+    }
+    memcpy(s.hist, buf + n, sizeof(s.hist));
+}
+
+// n input frames (even, <= AUDIO_HB_MAX_FRAMES) -> n/2 output frames. in
+// and out may be the same buffer.
+static inline void audio_hb_down2(AudioHalfbandState &s, const float *in, float *out, int n) {
+    float ev[AUDIO_HB_HIST + AUDIO_HB_MAX_FRAMES / 2];
+    float od[AUDIO_HB_HALF + AUDIO_HB_MAX_FRAMES / 2];
+    int m = n / 2;
+    if (m > AUDIO_HB_MAX_FRAMES / 2) m = AUDIO_HB_MAX_FRAMES / 2;
+    memcpy(ev, s.hist, sizeof(s.hist));
+    memcpy(od, s.odd, sizeof(s.odd));
+    for (int i = 0; i < m; i++) {
+        ev[AUDIO_HB_HIST + i] = in[2 * i];
+        od[AUDIO_HB_HALF + i] = in[2 * i + 1];
+    }
+    for (int i = 0; i < m; i++) {
+        out[i] = _audio_hb_branch(ev + AUDIO_HB_HIST + i) + 0.5f * od[i];
+    }
+    memcpy(s.hist, ev + m, sizeof(s.hist));
+    memcpy(s.odd, od + m, sizeof(s.odd));
+}
+
+// Convert n frames by step (UP2 / DOWN2; anything else copies). Returns the
+// output frame count.
+static inline int audio_rate_convert(AudioHalfbandState &s, AudioRateStep step,
+                                     const float *in, float *out, int n) {
+    if (step == AUDIO_RATE_UP2) {
+        audio_hb_up2(s, in, out, n);
+        return n * 2;
+    }
+    if (step == AUDIO_RATE_DOWN2) {
+        audio_hb_down2(s, in, out, n);
+        return n / 2;
+    }
+    if (in != out) memcpy(out, in, (size_t)n * sizeof(float));
+    return n;
+}
@@ -0,0 +1,184 @@
+#pragma once
+// audio_rate_switch.h — Sample-rate switching without I2S channel teardown
+// (header-only, no RTOS dependencies).
+//
+// A rate change keeps every I2S channel and its DMA descriptors allocated and
+// only reprograms the clocks. Deleting and recreating the channels (hundreds
+// of milliseconds of silence, DMA reallocation) is left as the fallback.
+// audio_rate_switch_run() sequences one switch:
+//
+//   PREPARE   DSP configs staged at the new rate on their inactive side
+//             (coefficients computed while the old config still plays)
+//   FADE_OUT  output ramped to silence by the audio task, bounded wait
+//   COMMIT    staged DSP configs published while the output is silent; a
+//             publish that fails is staged and published again once the
+//             audio task is paused, and if that fails too the switch is
+//             refused: no reclock, the output fades back in at the old rate
+//   RECLOCK   audio task paused; pipeline rates and block plan set, channel
+//             clocks reprogrammed in place (or the channels rebuilt if one
+//             refuses the new clock or the I/O block changed length),
+//             rate bookkeeping retargeted
+//   FADE_IN   audio task resumed; the output ramps back up on its own
+//
+// The hardware and pipeline actions are supplied as an ops table so the
+// sequence itself runs natively. Durations are measured with the ops clock:
+// gapUs is the time the audio task is paused (the output DMA plays its
+// auto-cleared silence), totalUs runs from the request to the resume.
+//
+// audio_output_fade() is the ramp the audio task applies to the output
+// channels: linear, AUDIO_RATE_SWITCH_FADE_FRAMES from full scale to silence.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef AUDIO_RATE_SWITCH_FADE_FRAMES
+#define AUDIO_RATE_SWITCH_FADE_FRAMES       256    // ~5 ms at 48 kHz
+#endif
+#ifndef AUDIO_RATE_SWITCH_FADE_TIMEOUT_US
+#define AUDIO_RATE_SWITCH_FADE_TIMEOUT_US   50000  // Fade + two 256-frame blocks at 16 kHz
+#endif
+
+enum AudioRateSwitchPhase : uint8_t {
+    AUDIO_RATE_SWITCH_IDLE = 0,
+    AUDIO_RATE_SWITCH_PREPARE,
+    AUDIO_RATE_SWITCH_FADE_OUT,
+    AUDIO_RATE_SWITCH_COMMIT,
+    AUDIO_RATE_SWITCH_RECLOCK,
+    AUDIO_RATE_SWITCH_FADE_IN
+};
+
+enum AudioRateSwitchResult : uint8_t {
+    AUDIO_RATE_SWITCH_REFUSED = 0,  // DSP configs could not be published, clocks untouched
+    AUDIO_RATE_SWITCH_IN_PLACE,     // Clocks reprogrammed in place
+    AUDIO_RATE_SWITCH_REBUILT       // Channels recreated
+};
+
+struct AudioRateSwitchStats {
+    volatile uint8_t phase;     // AudioRateSwitchPhase of the switch in progress
+    uint32_t fromRate;          // Last switch
+    uint32_t toRate;
+    uint32_t prepareUs;         // DSP staging
+    uint32_t fadeUs;            // Waiting for the output to reach silence
+    uint32_t commitUs;          // Publishing the staged DSP configs
+    uint32_t gapUs;             // Audio task paused (clocks + ASRC)
+    uint32_t totalUs;           // Request to resume
+    uint32_t maxTotalUs;        // Worst totalUs since boot
+    uint32_t switches;          // Completed switches
+    uint32_t rebuilds;          // Switches that fell back to recreating the channels
+    uint32_t fadeTimeouts;      // Fades that did not finish within the timeout
+    uint32_t commitRetries;     // Publishes retried with the audio task paused
+    uint32_t commitFailures;    // Switches refused because the retry failed too
+};
+
+struct AudioRateSwitchOps {
+    void     (*prepare)(uint32_t rate);   // Stage DSP configs at rate (inactive side)
+    void     (*fade)(bool mute);          // Ramp the output to silence / back
+    bool     (*faded)();                  // Output is silent
+    bool     (*commit)();                 // Publish the staged DSP configs, false if not live
+    void     (*pause)();                  // Stop the audio task between blocks
+    void     (*resume)();
+    bool     (*reclock)(uint32_t rate);   // Set pipeline rates, reprogram channel clocks in place
+    void     (*rebuild)(uint32_t rate);   // Fallback: delete and recreate the channels
+    void     (*retarget)(uint32_t rate);  // Rate bookkeeping (audio task paused)
+    uint32_t (*nowUs)();
+    void     (*wait)();                   // Yield while the fade runs
+};
+
+// Run one switch from -> to. With audioRunning false (the caller already
+// paused the audio task) nothing is playing: no fade, and the pause/resume
+// are left to the caller. A refused switch leaves the clocks, the rate
+// bookkeeping and switches untouched; the caller restores DSP configs that
+// went live at the new rate.
+static inline AudioRateSwitchResult audio_rate_switch_run(AudioRateSwitchStats &st, const AudioRateSwitchOps &ops,
+                                         uint32_t from, uint32_t to, bool audioRunning) {
+    const uint32_t t0 = ops.nowUs();
+    st.phase = AUDIO_RATE_SWITCH_PREPARE;
+    ops.prepare(to);
+    const uint32_t tPrepared = ops.nowUs();
+
+    st.phase = AUDIO_RATE_SWITCH_FADE_OUT;
+    if (audioRunning) {
+        ops.fade(true);
+        while (!ops.faded()) {
+            if (ops.nowUs() - tPrepared >= AUDIO_RATE_SWITCH_FADE_TIMEOUT_US) {
+                st.fadeTimeouts++;
+                break;
+            }
+            ops.wait();
+        }
+    }
+    const uint32_t tFaded = ops.nowUs();
+
+    st.phase = AUDIO_RATE_SWITCH_COMMIT;
+    bool committed = ops.commit();
+    const uint32_t tCommitted = ops.nowUs();
+
+    st.phase = AUDIO_RATE_SWITCH_RECLOCK;
+    if (audioRunning) ops.pause();
+    if (!committed) {
+        // Audio task quiescent: no publish is left half adopted
+        st.commitRetries++;
+        ops.prepare(to);
+        committed = ops.commit();
+    }
+    bool inPlace = false;
+    if (committed) {
+        inPlace = ops.reclock(to);
+        if (!inPlace) {
+            ops.rebuild(to);
+            st.rebuilds++;
+        }
+        ops.retarget(to);
+    } else {
+        st.commitFailures++;
+    }
+    st.phase = AUDIO_RATE_SWITCH_FADE_IN;
+    if (audioRunning) {
+        ops.fade(false);
+        ops.resume();
+    }
+    const uint32_t tEnd = ops.nowUs();
+
+    st.fromRate  = from;
+    st.toRate    = to;
+    st.prepareUs = tPrepared - t0;
+    st.fadeUs    = tFaded - tPrepared;
+    st.commitUs  = tCommitted - tFaded;
+    st.gapUs     = tEnd - tCommitted;
+    st.totalUs   = tEnd - t0;
+    if (st.totalUs > st.maxTotalUs) st.maxTotalUs = st.totalUs;
+    st.phase = AUDIO_RATE_SWITCH_IDLE;
+    if (!committed) return AUDIO_RATE_SWITCH_REFUSED;
+    st.switches++;
+    return inPlace ? AUDIO_RATE_SWITCH_IN_PLACE : AUDIO_RATE_SWITCH_REBUILT;
+}
+
+// ===== Output fade (audio task) =====
+
+// Ramp `gain` toward 0 (mute) or 1 over AUDIO_RATE_SWITCH_FADE_FRAMES, one
+// step per frame, applied to `frames` frames of each of the nch buffers
+// (null entries skipped). At unity nothing is touched; at silence the
+// buffers are zeroed. Returns the gain reached at the end of the block.
+static inline float audio_output_fade(float *const *ch, int nch, int frames, float gain, bool mute) {
+    const float target = mute ? 0.0f : 1.0f;
+    if (gain == target) {
+        if (mute) {
+            for (int c = 0; c < nch; c++) {
+                if (!ch[c]) continue;
+                for (int f = 0; f < frames; f++) ch[c][f] = 0.0f;
+            }
+        }
+        return gain;
+    }
+    const float step = mute ? -1.0f / AUDIO_RATE_SWITCH_FADE_FRAMES : 1.0f / AUDIO_RATE_SWITCH_FADE_FRAMES;
+    for (int c = 0; c < nch; c++) {
+        if (!ch[c]) continue;
+        for (int f = 0; f < frames; f++) {
+            float g = gain + step * (float)(f + 1);
+            if (mute ? g < 0.0f : g > 1.0f) g = target;
+            ch[c][f] *= g;
+        }
+    }
+    float end = gain + step * (float)frames;
+    return (mute ? end < 0.0f : end > 1.0f) ? target : end;
+}
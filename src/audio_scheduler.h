@@ -0,0 +1,208 @@
+#pragma once
+// audio_scheduler.h — DMA-completion-driven block scheduling for the audio
+// pipeline (header-only, no RTOS dependencies).
+//
+// The I2S RX on_recv callback reports every completed DMA descriptor through
+// audio_sched_on_dma(); when a whole pipeline block has arrived it returns
+// true and the ISR notifies the audio task, which blocks on that notification
+// instead of polling with a fixed delay.
+//
+// Every block carries a deadline: it must be written out before the next
+// block completes (readyUs + periodUs). A late block is counted as missed.
+// A backlog of up to AUDIO_SCHED_MAX_BACKLOG blocks is worked off back to
+// back (the output DMA still holds audio, nothing is audible). Beyond that
+// the output has underrun and catching up would leave the extra audio
+// queued — latency would stay inflated by the DMA runway for good — so
+// audio_sched_begin() tells the task to discard all but the newest block.
+//
+// The pipeline block size is a runtime parameter (32..256 frames, powers of
+// two); buffers are sized for AUDIO_BLOCK_FRAMES_MAX. Latency profiles choose
+// the DMA descriptor count at runtime and the descriptor length follows the
+// block, so a descriptor never holds more than one block and the ring always
+// holds at least two.
+//
+// AudioBlockCost splits the measured processing time per block into a fixed
+// per-invocation overhead and a per-frame cost, so the overhead budget of
+// small blocks is visible.
+
+#include <stdint.h>
+#include "config.h"   // I2S_DMA_BUF_COUNT, I2S_DMA_BUF_LEN
+
+#define AUDIO_SCHED_STAMPS       8    // Block completion timestamps kept (power of 2)
+#define AUDIO_SCHED_MAX_BACKLOG  2    // Pending blocks worked off without discarding
+#ifndef AUDIO_SCHED_WAIT_MS
+#define AUDIO_SCHED_WAIT_MS      20   // Notification timeout — covers a stalled or missing clock
+#endif
+
+// ===== Block Sizes =====
+#define AUDIO_BLOCK_FRAMES_MIN   32
+#define AUDIO_BLOCK_FRAMES_MAX   I2S_DMA_BUF_LEN   // Every pipeline buffer is sized for this
+#define AUDIO_BLOCK_SIZES        4                 // 32, 64, 128, 256
+#define AUDIO_BLOCK_COST_ALPHA   0.02f             // Smoothing of the per-size block time
+
+static_assert((AUDIO_BLOCK_FRAMES_MIN << (AUDIO_BLOCK_SIZES - 1)) == AUDIO_BLOCK_FRAMES_MAX,
+    "Block sizes must double from AUDIO_BLOCK_FRAMES_MIN up to I2S_DMA_BUF_LEN");
+
+// Index of a supported block size (32 -> 0 ... 256 -> 3), -1 if unsupported
+static inline int audio_block_size_index(uint32_t frames) {
+    for (int i = 0; i < AUDIO_BLOCK_SIZES; i++) {
+        if (frames == ((uint32_t)AUDIO_BLOCK_FRAMES_MIN << i)) return i;
+    }
+    return -1;
+}
+
+static inline bool audio_block_frames_valid(uint32_t frames) {
+    return audio_block_size_index(frames) >= 0;
+}
+
+enum AudioLatencyProfile : uint8_t {
+    AUDIO_LATENCY_LOW = 0,          // 4 x block/2 frames (2 blocks; ~11 ms at 256, ~1.3 ms at 32)
+    AUDIO_LATENCY_BALANCED,         // 6 x block frames
+    AUDIO_LATENCY_SAFE,             // 12 x block frames (legacy 12 x 256 at the default block)
+    AUDIO_LATENCY_PROFILE_COUNT
+};
+
+struct AudioDmaGeometry {
+    uint8_t descCount;
+    uint16_t descFrames;
+};
+
+// DMA geometry of a profile at a pipeline block size
+static inline AudioDmaGeometry audio_latency_dma(uint8_t profile,
+                                                 uint32_t blockFrames = AUDIO_BLOCK_FRAMES_MAX) {
+    if (!audio_block_frames_valid(blockFrames)) blockFrames = AUDIO_BLOCK_FRAMES_MAX;
+    switch (profile) {
+        case AUDIO_LATENCY_LOW:      return {4, (uint16_t)(blockFrames / 2)};
+        case AUDIO_LATENCY_BALANCED: return {6, (uint16_t)blockFrames};
+        default:                     return {I2S_DMA_BUF_COUNT, (uint16_t)blockFrames};
+    }
+}
+
+static inline const char *audio_latency_profile_name(uint8_t profile) {
+    switch (profile) {
+        case AUDIO_LATENCY_LOW:      return "low";
+        case AUDIO_LATENCY_BALANCED: return "balanced";
+        default:                     return "safe";
+    }
+}
+
+struct AudioScheduler {
+    // Geometry (set by audio_sched_init)
+    uint32_t blockFrames;
+    uint32_t ringFrames;            // descCount * descFrames
+    uint32_t sampleRate;
+    uint32_t periodUs;              // One block at sampleRate
+    // ISR side
+    volatile uint32_t dmaFrames;    // Frames completed by RX DMA (wraps)
+    volatile uint32_t stampUs[AUDIO_SCHED_STAMPS]; // Completion time of block n at [n & 7]
+    // Task side
+    uint32_t readFrames;            // Frames consumed (processed or discarded)
+    uint32_t readyUs;               // Completion time of the block in flight
+    // Accounting
+    uint32_t blocks;
+    uint32_t missed;                // Blocks written after their deadline
+    uint32_t recoveries;            // Times stale blocks were discarded
+    uint32_t dropped;               // Blocks discarded (stale or overrun by DMA)
+    int32_t slackUs;                // Deadline - finish of the last block
+    int32_t minSlackUs;
+    uint32_t e2eUs;                 // DMA completion → sink write done, last block
+    uint32_t latencyUs;             // Input sample → output DMA, last block
+};
+
+static inline void audio_sched_init(AudioScheduler &s, uint32_t blockFrames,
+                                    AudioDmaGeometry g, uint32_t sampleRate) {
+    s = AudioScheduler();
+    s.blockFrames = blockFrames;
+    s.ringFrames = (uint32_t)g.descCount * g.descFrames;
+    s.sampleRate = sampleRate ? sampleRate : 48000;
+    s.periodUs = (uint32_t)((uint64_t)blockFrames * 1000000ULL / s.sampleRate);
+    s.minSlackUs = INT32_MAX;
+}
+
+// ISR: one RX descriptor of `frames` completed at nowUs. Returns true when a
+// block boundary was crossed (notify the audio task).
+static inline bool audio_sched_on_dma(AudioScheduler &s, uint32_t frames, uint32_t nowUs) {
+    uint32_t before = s.dmaFrames;
+    uint32_t after = before + frames;
+    s.dmaFrames = after;
+    uint32_t blockBefore = before / s.blockFrames;
+    uint32_t blockAfter = after / s.blockFrames;
+    if (blockAfter == blockBefore) return false;
+    s.stampUs[(blockAfter - 1) & (AUDIO_SCHED_STAMPS - 1)] = nowUs;
+    return true;
+}
+
+// Complete blocks waiting for the task
+static inline uint32_t audio_sched_pending(const AudioScheduler &s) {
+    return (s.dmaFrames - s.readFrames) / s.blockFrames;
+}
+
+// Task: start the next block. Returns the number of stale blocks the caller
+// must read and discard before reading the block to process. Blocks the DMA
+// ring has already overwritten are skipped without being read.
+static inline uint32_t audio_sched_begin(AudioScheduler &s) {
+    uint32_t pending = audio_sched_pending(s);
+    uint32_t ringBlocks = s.ringFrames / s.blockFrames;
+    bool overrun = pending > ringBlocks;
+    if (overrun) {
+        uint32_t lost = pending - ringBlocks;
+        s.readFrames += lost * s.blockFrames;
+        s.dropped += lost;
+        pending = ringBlocks;
+    }
+    uint32_t discard = (overrun || pending > AUDIO_SCHED_MAX_BACKLOG) ? pending - 1 : 0;
+    if (discard) {
+        s.recoveries++;
+        s.dropped += discard;
+    }
+    uint32_t block = s.readFrames / s.blockFrames + discard;
+    s.readyUs = s.stampUs[block & (AUDIO_SCHED_STAMPS - 1)];
+    s.readFrames += (discard + 1) * s.blockFrames;
+    return discard;
+}
+
+// Task: the block started by audio_sched_begin() reached the sinks at nowUs.
+// txQueuedFrames is what the output DMA still holds ahead of it.
+static inline void audio_sched_end(AudioScheduler &s, uint32_t nowUs, uint32_t txQueuedFrames) {
+    s.blocks++;
+    uint32_t e2e = nowUs - s.readyUs;
+    s.e2eUs = e2e;
+    s.slackUs = (int32_t)s.periodUs - (int32_t)e2e;
+    if (s.slackUs < s.minSlackUs) s.minSlackUs = s.slackUs;
+    if (s.slackUs < 0) s.missed++;
+    // The oldest sample of the block was captured one period before it completed
+    s.latencyUs = s.periodUs + e2e +
+                  (uint32_t)((uint64_t)txQueuedFrames * 1000000ULL / s.sampleRate);
+}
+
+// ===== Per-Block Cost =====
+// Time per block is modelled as overhead + perFrame * frames. The pipeline
+// keeps a smoothed time for every block size it has run at; once two sizes
+// have been measured a least-squares fit separates the two terms.
+
+struct AudioBlockCost {
+    float us[AUDIO_BLOCK_SIZES];    // Smoothed block time per size (0 = not measured)
+};
+
+static inline void audio_block_cost_add(AudioBlockCost &c, uint32_t frames, float us) {
+    int i = audio_block_size_index(frames);
+    if (i < 0 || us <= 0.0f) return;
+    c.us[i] = c.us[i] > 0.0f ? c.us[i] + AUDIO_BLOCK_COST_ALPHA * (us - c.us[i]) : us;
+}
+
+// Fixed cost per invocation and cost per frame. Returns false until two
+// block sizes have been measured.
+static inline bool audio_block_cost_fit(const AudioBlockCost &c, float &overheadUs, float &perFrameUs) {
+    float n = 0.0f, sx = 0.0f, sy = 0.0f, sxx = 0.0f, sxy = 0.0f;
+    for (int i = 0; i < AUDIO_BLOCK_SIZES; i++) {
+        if (c.us[i] <= 0.0f) continue;
+        float x = (float)(AUDIO_BLOCK_FRAMES_MIN << i);
+        n += 1.0f; sx += x; sy += c.us[i]; sxx += x * x; sxy += x * c.us[i];
+    }
+    float den = n * sxx - sx * sx;
+    if (n < 2.0f || den <= 0.0f) return false;
+    perFrameUs = (n * sxy - sx * sy) / den;
+    overheadUs = (sy - perFrameUs * sx) / n;
+    if (overheadUs < 0.0f) overheadUs = 0.0f;
+    return true;
+}
@@ -85,15 +85,32 @@ const int DAC_I2C_SCL_PIN = 54;  // GPIO 54 - I2C SCL (EEPROM + I2C DACs) (P4)
 #ifdef DSP_ENABLED
 #define DSP_MAX_STAGES       24    // Max filter stages per channel (10 PEQ + 14 chain)
 #define DSP_PEQ_BANDS        10    // PEQ bands occupy stages 0-9; chain stages use 10-19
-#define DSP_MAX_FIR_TAPS     256   // Max FIR taps (direct convolution)
-#define DSP_MAX_FIR_SLOTS    2     // Max concurrent FIR stages (pool-allocated, not inline)
+#ifndef DSP_MAX_FIR_TAPS
+#define DSP_MAX_FIR_TAPS     4096  // Max FIR taps per stage (direct / FFT overlap-save, PSRAM)
+#endif
+#ifndef DSP_MAX_FIR_SLOTS
+#define DSP_MAX_FIR_SLOTS    4     // Max concurrent FIR stages (~130KB PSRAM each at 4096 taps)
+#endif
 #define DSP_MAX_CHANNELS     4     // L1, R1, L2, R2
-#define DSP_MAX_DELAY_SLOTS  2     // Max concurrent delay stages (pool-allocated)
-#define DSP_MAX_DELAY_SAMPLES 4800 // Max delay = 100ms @ 48kHz
+#ifndef DSP_MAX_DELAY_SLOTS
+#define DSP_MAX_DELAY_SLOTS  16    // Max concurrent delay stages (pool-allocated, PSRAM)
+#endif
+#ifndef DSP_MAX_DELAY_SAMPLES
+#define DSP_MAX_DELAY_SAMPLES 15360 // Max delay per stage = 320ms @ 48kHz (16K-sample ring)
+#endif
+#ifndef DSP_DELAY_PSRAM_BUDGET
+#define DSP_DELAY_PSRAM_BUDGET (2UL * 1024UL * 1024UL) // Delay pool cap: 32 slots × 64KB
+#endif
+#ifndef DSP_MAX_TRUE_PEAK_SLOTS
+#define DSP_MAX_TRUE_PEAK_SLOTS 4  // Max true-peak limiter stages (~16KB PSRAM each)
+#endif
 #define DSP_DEFAULT_Q        0.707f
 #define DSP_CPU_WARN_PERCENT 80.0f
 #define DSP_CPU_CRIT_PERCENT 95.0f
 #define DSP_PRESET_MAX_SLOTS 32    // Max number of config preset slots
+#define DSP_FIR_DESIGN_TASK_STACK    4096  // One-shot FIR designer (buffers are PSRAM)
+#define DSP_FIR_DESIGN_TASK_PRIORITY 0     // Low priority — background work only
+#define DSP_FIR_DESIGN_TASK_CORE     0     // Core 0 — away from the audio pipeline
 
 // ===== Output DSP Configuration (post-matrix per-channel DSP) =====
 #ifndef OUTPUT_DSP_MAX_CHANNELS
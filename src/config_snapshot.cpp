@@ -0,0 +1,232 @@
+// config_snapshot.cpp — A/B binary snapshot store implementation.
+// See config_snapshot.h for the slot/generation protocol.
+
+#include "config_snapshot.h"
+
+#ifdef NATIVE_TEST
+#include "../test/test_mocks/Arduino.h"
+#include "../test/test_mocks/LittleFS.h"
+#else
+#include <Arduino.h>
+#include <LittleFS.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+// Bytes of the header covered by the CRC (everything before `crc`)
+static const size_t HEADER_CRC_SPAN = offsetof(ConfigSnapshotHeader, crc);
+
+// Verify/copy granularity — large stores are never buffered whole
+static const size_t SNAP_CHUNK = 256;
+
+static ConfigSnapshotStore _settingsStore =
+    CONFIG_SNAPSHOT_STORE(CONFIG_SNAPSHOT_BASE_SETTINGS, CONFIG_SNAPSHOT_MAX_BYTES);
+
+// ===== CRC32 — IEEE 802.3, reflected polynomial =====
+
+static uint32_t _snapCrcTable[256];
+static bool     _snapCrcReady = false;
+
+uint32_t config_snapshot_crc32(uint32_t crc, const uint8_t *data, size_t len) {
+    if (!_snapCrcReady) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int j = 0; j < 8; j++)
+                c = (c & 1) ? (0xEDB88320UL ^ (c >> 1)) : (c >> 1);
+            _snapCrcTable[i] = c;
+        }
+        _snapCrcReady = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++)
+        crc = _snapCrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// ===== Slot access =====
+
+static void _slotPath(char *out, size_t cap, const char *base, int slot) {
+    snprintf(out, cap, "%s_%c.bin", base, slot ? 'b' : 'a');
+}
+
+// True if `a` is a newer generation than `b` (wrap-safe)
+static inline bool _newer(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) > 0;
+}
+
+static bool _readHeader(const ConfigSnapshotStore &st, int slot, ConfigSnapshotHeader *hdr, bool *present) {
+    *present = false;
+    char path[32];
+    _slotPath(path, sizeof(path), st.base, slot);
+    File f = LittleFS.open(path, "r");
+    if (!f) return false;
+    *present = true;
+    size_t n = f.read((uint8_t *)hdr, sizeof(*hdr));
+    size_t fileSize = f.size();
+    f.close();
+    if (n != sizeof(*hdr)) return false;
+    if (hdr->magic != CONFIG_SNAPSHOT_MAGIC || hdr->format != CONFIG_SNAPSHOT_FORMAT) return false;
+    if (hdr->length > st.maxBytes) return false;
+    return fileSize == sizeof(*hdr) + hdr->length;
+}
+
+// Streams the payload through the CRC in SNAP_CHUNK pieces. Verifying before
+// copying keeps the caller's defaults intact when this slot is rejected and
+// an older, shorter one is decoded instead.
+static bool _verifySlot(const ConfigSnapshotStore &st, int slot, const ConfigSnapshotHeader &hdr) {
+    char path[32];
+    _slotPath(path, sizeof(path), st.base, slot);
+    File f = LittleFS.open(path, "r");
+    if (!f) return false;
+    ConfigSnapshotHeader check;
+    bool ok = f.read((uint8_t *)&check, sizeof(check)) == sizeof(check)
+              && memcmp(&check, &hdr, sizeof(check)) == 0;
+    uint32_t crc = config_snapshot_crc32(0, (const uint8_t *)&hdr, HEADER_CRC_SPAN);
+    uint8_t chunk[SNAP_CHUNK];
+    for (uint32_t left = hdr.length; ok && left > 0;) {
+        size_t want = left < SNAP_CHUNK ? left : SNAP_CHUNK;
+        if (f.read(chunk, want) != want) ok = false;
+        else crc = config_snapshot_crc32(crc, chunk, want);
+        left -= (uint32_t)want;
+    }
+    f.close();
+    return ok && crc == hdr.crc;
+}
+
+static bool _copySlot(const ConfigSnapshotStore &st, int slot, void *payload, size_t n) {
+    char path[32];
+    _slotPath(path, sizeof(path), st.base, slot);
+    File f = LittleFS.open(path, "r");
+    if (!f) return false;
+    bool ok = f.seek(sizeof(ConfigSnapshotHeader)) && f.read((uint8_t *)payload, n) == n;
+    f.close();
+    return ok;
+}
+
+ConfigSnapshotResult config_snapshot_store_load(ConfigSnapshotStore &st, uint16_t schema,
+                                                void *payload, size_t cap, size_t *outLen) {
+    if (outLen) *outLen = 0;
+    ConfigSnapshotHeader hdr[2];
+    bool present[2], valid[2];
+    for (int s = 0; s < 2; s++) valid[s] = _readHeader(st, s, &hdr[s], &present[s]);
+
+    st.scanned = true;
+    st.stats.activeSlot = -1;
+    st.stats.generation = 0;
+    if (!present[0] && !present[1]) return CFG_SNAP_NONE;
+
+    // Newest first; fall back to the other slot if its payload fails the CRC
+    int order[2] = { 0, 1 };
+    if (valid[1] && (!valid[0] || _newer(hdr[1].generation, hdr[0].generation))) {
+        order[0] = 1;
+        order[1] = 0;
+    }
+    bool skipped = (present[0] && !valid[0]) || (present[1] && !valid[1]);
+    for (int k = 0; k < 2; k++) {
+        int s = order[k];
+        if (!valid[s]) continue;
+        if (!_verifySlot(st, s, hdr[s])) {
+            skipped = true;
+            continue;
+        }
+        if (skipped) st.stats.fallbacks++;
+        st.stats.activeSlot = (int8_t)s;
+        st.stats.generation = hdr[s].generation;
+        if (hdr[s].schema != schema) return CFG_SNAP_SCHEMA;
+        // Append-only payloads: older (shorter) images fill a prefix and
+        // leave the caller's defaults in place; newer ones are truncated
+        size_t n = (hdr[s].length < cap) ? hdr[s].length : cap;
+        if (!_copySlot(st, s, payload, n)) return CFG_SNAP_IO;
+        if (outLen) *outLen = hdr[s].length;
+        return CFG_SNAP_OK;
+    }
+    return CFG_SNAP_CORRUPT;
+}
+
+ConfigSnapshotResult config_snapshot_store_save(ConfigSnapshotStore &st, uint16_t schema,
+                                                const void *payload, size_t len) {
+    if (!payload || len > st.maxBytes) return CFG_SNAP_TOO_LARGE;
+
+    if (!st.scanned) {
+        // First save without a prior load — find the live slot from headers
+        ConfigSnapshotHeader hdr[2];
+        bool present, valid[2];
+        for (int s = 0; s < 2; s++) valid[s] = _readHeader(st, s, &hdr[s], &present);
+        st.stats.activeSlot = -1;
+        if (valid[0]) st.stats.activeSlot = 0;
+        if (valid[1] && (!valid[0] || _newer(hdr[1].generation, hdr[0].generation))) st.stats.activeSlot = 1;
+        st.stats.generation = (st.stats.activeSlot >= 0) ? hdr[st.stats.activeSlot].generation : 0;
+        st.scanned = true;
+    }
+
+    int target = (st.stats.activeSlot == 0) ? 1 : 0;
+
+    ConfigSnapshotHeader hdr;
+    hdr.magic = CONFIG_SNAPSHOT_MAGIC;
+    hdr.format = CONFIG_SNAPSHOT_FORMAT;
+    hdr.schema = schema;
+    hdr.generation = st.stats.generation + 1;
+    hdr.length = (uint32_t)len;
+    hdr.crc = config_snapshot_crc32(0, (const uint8_t *)&hdr, HEADER_CRC_SPAN);
+    hdr.crc = config_snapshot_crc32(hdr.crc, (const uint8_t *)payload, len);
+
+    char path[32];
+    _slotPath(path, sizeof(path), st.base, target);
+    File f = LittleFS.open(path, "w");
+    if (!f) return CFG_SNAP_IO;
+    size_t n = f.write((const uint8_t *)&hdr, sizeof(hdr));
+    n += f.write((const uint8_t *)payload, len);
+    f.close();
+    if (n != sizeof(hdr) + len) return CFG_SNAP_IO;
+
+    st.stats.activeSlot = (int8_t)target;
+    st.stats.generation = hdr.generation;
+    st.stats.saves++;
+    return CFG_SNAP_OK;
+}
+
+void config_snapshot_remove(const char *base) {
+    char path[32];
+    for (int s = 0; s < 2; s++) {
+        _slotPath(path, sizeof(path), base, s);
+        LittleFS.remove(path);
+    }
+}
+
+void config_snapshot_store_erase(ConfigSnapshotStore &st) {
+    config_snapshot_remove(st.base);
+    st.stats.activeSlot = -1;
+    st.stats.generation = 0;
+    st.scanned = true;
+}
+
+// ===== Settings store =====
+
+ConfigSnapshotResult config_snapshot_load(uint16_t schema, void *payload, size_t cap, size_t *outLen) {
+    return config_snapshot_store_load(_settingsStore, schema, payload, cap, outLen);
+}
+
+ConfigSnapshotResult config_snapshot_save(uint16_t schema, const void *payload, size_t len) {
+    return config_snapshot_store_save(_settingsStore, schema, payload, len);
+}
+
+void config_snapshot_erase() {
+    config_snapshot_store_erase(_settingsStore);
+}
+
+ConfigSnapshotStats config_snapshot_get_stats() {
+    return _settingsStore.stats;
+}
+
+#ifdef UNIT_TEST
+void config_snapshot_store_test_reset(ConfigSnapshotStore &st) {
+    memset(&st.stats, 0, sizeof(st.stats));
+    st.stats.activeSlot = -1;
+    st.scanned = false;
+}
+
+void config_snapshot_test_reset() {
+    config_snapshot_store_test_reset(_settingsStore);
+}
+#endif
@@ -0,0 +1,105 @@
+#pragma once
+// config_snapshot.h — A/B binary snapshot store for persistent settings.
+//
+// Two slot files hold a versioned, CRC32-protected payload with a generation
+// counter. A save always writes the slot that does NOT hold the newest valid
+// snapshot, so the live copy is never removed or truncated: a power cut
+// mid-write leaves a slot that fails its CRC and the previous generation is
+// loaded instead. Loading reads both 20-byte headers, verifies the newest
+// payload's CRC and copies it out — no parsing, the caller memcpy-decodes a
+// POD.
+//
+// Each persistent area owns a store (its own slot pair, size cap and live
+// slot): settings, the input DSP chains, the output DSP chains and the
+// routing matrix, so each saves and falls back independently. The
+// config_snapshot_load/save/erase/get_stats calls address the settings store.
+//
+// JSON stays the human-facing import/export format; the snapshot is the boot
+// path. Pure C++ with LittleFS only (LittleFS mock on native).
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CONFIG_SNAPSHOT_MAGIC      0x50414E53UL   // "SNAP"
+#define CONFIG_SNAPSHOT_FORMAT     1
+#define CONFIG_SNAPSHOT_PATH_A     "/cfg_a.bin"
+#define CONFIG_SNAPSHOT_PATH_B     "/cfg_b.bin"
+#define CONFIG_SNAPSHOT_MAX_BYTES  2048         // Settings store payload cap
+
+// Store base paths — slots are "<base>_a.bin" and "<base>_b.bin"
+#define CONFIG_SNAPSHOT_BASE_SETTINGS    "/cfg"
+#define CONFIG_SNAPSHOT_BASE_DSP         "/dsp"
+#define CONFIG_SNAPSHOT_BASE_OUTPUT_DSP  "/odsp"
+#define CONFIG_SNAPSHOT_BASE_MATRIX      "/mtx"
+
+struct ConfigSnapshotHeader {
+    uint32_t magic;
+    uint16_t format;        // CONFIG_SNAPSHOT_FORMAT — container layout
+    uint16_t schema;        // Caller's payload layout version
+    uint32_t generation;    // Monotonic save counter (wrap-safe compare)
+    uint32_t length;        // Payload bytes following the header
+    uint32_t crc;           // CRC32 over header[0..16) + payload
+};
+
+enum ConfigSnapshotResult : uint8_t {
+    CFG_SNAP_OK = 0,
+    CFG_SNAP_NONE,          // No slot file present
+    CFG_SNAP_CORRUPT,       // Slot(s) present but none passed magic/CRC
+    CFG_SNAP_SCHEMA,        // Valid snapshot with a different payload schema
+    CFG_SNAP_TOO_LARGE,     // Save payload exceeds the store's maxBytes
+    CFG_SNAP_IO             // Open/write failed
+};
+
+struct ConfigSnapshotStats {
+    uint32_t generation;    // Generation of the live snapshot (0 = none)
+    int8_t   activeSlot;    // 0 = A, 1 = B, -1 = none
+    uint16_t saves;         // Saves since boot
+    uint16_t fallbacks;     // Loads that succeeded despite a corrupt/torn slot
+};
+
+// One slot pair with its live-slot cache. Define with CONFIG_SNAPSHOT_STORE.
+struct ConfigSnapshotStore {
+    const char *base;           // Slot path prefix, e.g. CONFIG_SNAPSHOT_BASE_DSP
+    uint32_t maxBytes;          // Largest payload accepted by save/load
+    ConfigSnapshotStats stats;
+    bool scanned;               // Live slot known (load, save or erase ran)
+};
+
+#define CONFIG_SNAPSHOT_STORE(base, maxBytes) { (base), (maxBytes), { 0, -1, 0, 0 }, false }
+
+// Load the newest valid snapshot into `payload`. `outLen` receives the stored
+// payload length. A newer corrupt slot falls back to the older valid one.
+// Payload layouts are append-only within a schema: a shorter stored payload
+// fills only a prefix of `payload` (pre-fill it with defaults), a longer one
+// is truncated to `cap`.
+ConfigSnapshotResult config_snapshot_load(uint16_t schema, void *payload, size_t cap, size_t *outLen);
+
+// Write `payload` as generation+1 into the inactive slot.
+ConfigSnapshotResult config_snapshot_save(uint16_t schema, const void *payload, size_t len);
+
+// Remove both slots (factory reset / tests).
+void config_snapshot_erase();
+
+ConfigSnapshotStats config_snapshot_get_stats();
+
+// Same protocol on a caller-owned store.
+ConfigSnapshotResult config_snapshot_store_load(ConfigSnapshotStore &st, uint16_t schema,
+                                                void *payload, size_t cap, size_t *outLen);
+ConfigSnapshotResult config_snapshot_store_save(ConfigSnapshotStore &st, uint16_t schema,
+                                                const void *payload, size_t len);
+void config_snapshot_store_erase(ConfigSnapshotStore &st);
+
+// Remove a store's slot files by base path, without its owner. A settings
+// import promotes JSON files that must win over the snapshot on the next
+// boot; the owning store re-scans when it next loads.
+void config_snapshot_remove(const char *base);
+
+// CRC32 (IEEE 802.3, reflected) with running state — pass 0 to start.
+uint32_t config_snapshot_crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+#ifdef UNIT_TEST
+// Test hooks: forget the cached live slot/generation (simulates a reboot).
+void config_snapshot_test_reset();
+void config_snapshot_store_test_reset(ConfigSnapshotStore &st);
+#endif
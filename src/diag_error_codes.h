@@ -62,6 +62,7 @@ enum DiagErrorCode : uint16_t {
     DIAG_AUDIO_DMA_ALLOC_FAIL           = 0x200E,  // DMA buffer allocation failed (internal SRAM)
     DIAG_AUDIO_RATE_MISMATCH            = 0x200F,  // Source/sink sample rate mismatch detected
     DIAG_AUDIO_DSD_DETECTED             = 0x2010,  // DoP DSD content detected on pipeline lane
+    DIAG_AUDIO_CAPTURE_STALL            = 0x2011,  // Input port delivered no DMA data (lane zero-filled)
 
     // ===== 0x30xx: DSP =====
     DIAG_DSP_SWAP_FAIL                  = 0x3001,  // Config swap mutex timeout
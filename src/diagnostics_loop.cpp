@@ -58,8 +58,10 @@ void diagnostics_loop_tick() {
       lastFormatCheck = millis();
       bool mismatch = audio_pipeline_check_format();
 
-      // ASRC lane configuration — when a rate mismatch is detected, arm the SRC
-      // engine for each affected lane. When resolved, deactivate all lanes.
+      // Lane rate routing — when a lane's rate changes, arm the SRC engine
+      // towards the processing rate (or the 2x converter for lanes at the
+      // I/O rate). Decoded DSD lanes run at the DoP frame rate and are
+      // converted as well.
       static uint32_t prevLaneSampleRates[AUDIO_PIPELINE_MAX_INPUTS] = {};
       bool ratesChanged = false;
       for (int lane = 0; lane < AUDIO_PIPELINE_MAX_INPUTS; lane++) {
@@ -69,26 +71,20 @@ void diagnostics_loop_tick() {
         }
       }
       if (ratesChanged || mismatch != appState.audio.rateMismatch) {
-        uint32_t sinkRate = appState.audio.sampleRate;  // Pipeline sink rate (48kHz nominal)
-        for (int lane = 0; lane < AUDIO_PIPELINE_MAX_INPUTS; lane++) {
-          uint32_t srcRate = appState.audio.laneSampleRates[lane];
-          if (srcRate == 0 || srcRate == sinkRate || appState.audio.laneDsd[lane]) {
-            // No ASRC needed: unknown rate, rate matches, or DSD lane
-            audio_pipeline_set_lane_src(lane, sinkRate, sinkRate);  // passthrough
-          } else {
-            audio_pipeline_set_lane_src(lane, srcRate, sinkRate);
-          }
-        }
+        audio_pipeline_route_lanes();
       }
     }
   }
 
-  // DSD DAC mode switching — when a lane transitions to/from DoP DSD, switch all
-  // DSD-capable Cirrus Logic DAC sinks into/out of DSD mode.
+  // DSD DAC mode switching — in DSD passthrough, when a lane transitions to/from
+  // DoP DSD, switch all DSD-capable Cirrus Logic DAC sinks into/out of DSD mode.
+  // Without passthrough they play the decoded PCM and stay in PCM mode.
   // EVT_FORMAT_CHANGE is signalled by the pipeline when laneDsd[] changes.
   {
     static bool prevLaneDsd[AUDIO_PIPELINE_MAX_INPUTS] = {};
-    bool anyChange = false;
+    static bool prevPassthrough = false;
+    bool anyChange = appState.audio.dsdPassthrough != prevPassthrough;
+    prevPassthrough = appState.audio.dsdPassthrough;
     for (uint8_t lane = 0; lane < AUDIO_PIPELINE_MAX_INPUTS; lane++) {
       if (prevLaneDsd[lane] != appState.audio.laneDsd[lane]) {
         anyChange = true;
@@ -101,6 +97,7 @@ void diagnostics_loop_tick() {
       for (uint8_t lane = 0; lane < AUDIO_PIPELINE_MAX_INPUTS; lane++) {
         if (appState.audio.laneDsd[lane]) { anyDsd = true; break; }
       }
+      anyDsd = anyDsd && appState.audio.dsdPassthrough;
       // Iterate all pipeline sinks; find DSD-capable Cirrus DACs and switch mode
       int sinkCount = audio_pipeline_get_sink_count();
       for (int s = 0; s < sinkCount; s++) {
@@ -0,0 +1,147 @@
+#pragma once
+// dsd_decoder.h — DoP unpacking and DSD -> PCM decimation (header-only, no
+// RTOS dependencies).
+//
+// DoP v1.1 carries 16 DSD bits per channel in every 24-bit sample, below the
+// 0x05 / 0xFA marker byte. In the left-justified word bits 23..16 are the
+// older DSD byte and bits 15..8 the newer one, oldest bit first (MSB). One
+// DoP frame at 176.4 kHz therefore holds 16 DSD64 bits (2.8224 MHz) per
+// channel.
+//
+// The decoder decimates by 16 in two stages so one PCM frame comes out per
+// DoP frame:
+//   1. / 8 with a 64-tap linear-phase FIR evaluated a byte at a time. The 8
+//      taps that line up with one DSD byte reduce to a lookup in a 256-entry
+//      table of +/-h partial sums, so an output sample costs
+//      DSD_DEC_TAP_BYTES lookups and adds instead of 64 multiply-adds
+//      (2.8224 MHz -> 352.8 kHz).
+//   2. / 2 with the dsp_multirate half-band (352.8 kHz -> 176.4 kHz), which
+//      removes the modulator noise above ~107 kHz before it folds down.
+// The lane then carries PCM at the DoP frame rate; the ASRC takes it to the
+// pipeline rate like any other off-rate lane.
+//
+// Level: bits map to +/-1, so 0 dB SACD (50 % modulation) decodes to
+// -6 dBFS and modulator peaks keep their headroom.
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "dsp_multirate.h"
+
+#define DSD_DEC_TAPS          64                          // Stage 1 FIR length (bits)
+#define DSD_DEC_TAP_BYTES     (DSD_DEC_TAPS / 8)          // Lookups per output sample
+#define DSD_DEC_HIST          (DSD_DEC_TAP_BYTES - 1)     // Bytes carried between blocks
+#define DSD_DEC_CHUNK_FRAMES  (DSP_MR_MAX_BLOCK / 2)      // DoP frames per stage 2 call
+#define DSD_DEC_CHUNK_BYTES   (2 * DSD_DEC_CHUNK_FRAMES)  // DSD bytes per channel per chunk
+#define DSD_SILENCE_BYTE      0x69                        // DSD idle pattern, decodes to ~0
+
+// Shared by every lane; built once off the audio task (8 KB)
+struct DsdDecimTable {
+    float lut[DSD_DEC_TAP_BYTES][256];    // lut[j][v]: taps 8j..8j+7 against byte v
+};
+
+struct DsdChannelDecoder {
+    uint8_t bytes[DSD_DEC_HIST + DSD_DEC_CHUNK_BYTES];   // History + current chunk
+    DspMultirateState hb;                                // Stage 2 half-band
+};
+
+struct DsdLaneDecoder {
+    const DsdDecimTable *table;
+    DsdChannelDecoder ch[2];
+    float stage1[DSD_DEC_CHUNK_BYTES];    // Stage 1 output / stage 2 in-place buffer
+};
+
+// Stage 1 taps: Kaiser-windowed sinc (beta 10) cut off at half the 352.8 kHz
+// output rate; the first image band (332.8 kHz and up) is down > 100 dB.
+// h[0] weighs the newest bit. DC gain is exactly 1.
+static inline void dsd_dec_design(float *h) {
+    const double beta = 10.0;
+    const double fc = 1.0 / 16.0;                          // Cutoff / bit rate
+    const double half = (double)(DSD_DEC_TAPS - 1) / 2.0;
+    const double i0b = _dsp_mr_bessel_i0(beta);
+    double tmp[DSD_DEC_TAPS];
+    double sum = 0.0;
+    for (int k = 0; k < DSD_DEC_TAPS; k++) {
+        double d = (double)k - half;
+        double s = sin(2.0 * M_PI * fc * d) / (M_PI * d);
+        double r = d / half;
+        double w = _dsp_mr_bessel_i0(beta * sqrt(1.0 - r * r)) / i0b;
+        tmp[k] = s * w;
+        sum += tmp[k];
+    }
+    for (int k = 0; k < DSD_DEC_TAPS; k++) h[k] = (float)(tmp[k] / sum);
+}
+
+// Byte j back from the newest covers taps 8j..8j+7; bit 0 (LSB) is the newest
+// bit of its byte, so bit b meets tap 8j + b.
+static inline void dsd_dec_table_init(DsdDecimTable &t) {
+    float h[DSD_DEC_TAPS];
+    dsd_dec_design(h);
+    for (int j = 0; j < DSD_DEC_TAP_BYTES; j++) {
+        for (int v = 0; v < 256; v++) {
+            double acc = 0.0;
+            for (int b = 0; b < 8; b++) acc += ((v >> b) & 1) ? h[8 * j + b] : -h[8 * j + b];
+            t.lut[j][v] = (float)acc;
+        }
+    }
+}
+
+// Clear history to DSD silence. Call whenever the stream (re)starts.
+static inline void dsd_dec_reset(DsdLaneDecoder &d) {
+    for (int c = 0; c < 2; c++) {
+        memset(d.ch[c].bytes, DSD_SILENCE_BYTE, sizeof(d.ch[c].bytes));
+        dsp_mr_reset(d.ch[c].hb);
+    }
+}
+
+// Safe to call from any task (no allocation); the table must outlive d
+static inline void dsd_dec_init(DsdLaneDecoder &d, const DsdDecimTable *table) {
+    d.table = table;
+    for (int c = 0; c < 2; c++) {
+        dsp_mr_init(d.ch[c].hb);
+        dsp_mr_configure(d.ch[c].hb, 2);
+    }
+    dsd_dec_reset(d);
+}
+
+// DoP -> 1-bit stream: 2 DSD bytes per frame of channel ch (0 = L, 1 = R),
+// oldest first
+static inline void dsd_dop_unpack(const int32_t *raw, int frames, int ch, uint8_t *dst) {
+    for (int f = 0; f < frames; f++) {
+        uint32_t w = (uint32_t)raw[f * 2 + ch];
+        dst[f * 2]     = (uint8_t)(w >> 16);
+        dst[f * 2 + 1] = (uint8_t)(w >> 8);
+    }
+}
+
+// Stage 1: one output per byte. bytes[-DSD_DEC_HIST .. -1] must hold the
+// previous bytes of the stream.
+static inline void dsd_dec_fir8(const DsdDecimTable &t, const uint8_t *bytes, int n, float *out) {
+    for (int i = 0; i < n; i++) {
+        const uint8_t *p = bytes + i;
+        float acc = 0.0f;
+        for (int j = 0; j < DSD_DEC_TAP_BYTES; j++) acc += t.lut[j][p[-j]];
+        out[i] = acc;
+    }
+}
+
+// Decode a block of DoP frames to planar PCM, one sample per frame and
+// channel. raw is left untouched (passthrough sinks can still use it).
+static inline void dsd_decode_dop(DsdLaneDecoder &d, const int32_t *raw, float *L, float *R,
+                                  int frames) {
+    float *out[2] = { L, R };
+    for (int done = 0; done < frames; ) {
+        int n = frames - done;
+        if (n > DSD_DEC_CHUNK_FRAMES) n = DSD_DEC_CHUNK_FRAMES;
+        for (int c = 0; c < 2; c++) {
+            DsdChannelDecoder &ch = d.ch[c];
+            uint8_t *cur = ch.bytes + DSD_DEC_HIST;
+            dsd_dop_unpack(raw + done * 2, n, c, cur);
+            dsd_dec_fir8(*d.table, cur, 2 * n, d.stage1);
+            dsp_mr_decimate(ch.hb, d.stage1, 2 * n);
+            memcpy(out[c] + done, d.stage1, sizeof(float) * n);
+            memmove(ch.bytes, cur + 2 * n - DSD_DEC_HIST, DSD_DEC_HIST);
+        }
+        done += n;
+    }
+}
@@ -7,16 +7,20 @@
 #include "dsp_rew_parser.h"
 #include "dsp_crossover.h"
 #include "dsp_convolution.h"
+#include "dsp_wav_stream.h"
+#include "dsp_fir_design.h"
 #include "thd_measurement.h"
 #include "app_state.h"
 #include "globals.h"
 #include "auth_handler.h"
 #include "debug_serial.h"
 #include "psram_alloc.h"
+#include "config_snapshot.h"
 #include <ArduinoJson.h>
 #include <LittleFS.h>
 #include <sys/stat.h>
 #include <esp_heap_caps.h>
+#include <atomic>
 
 
 // Check if a LittleFS file exists without triggering VFS "no permits" error log.
@@ -33,15 +37,20 @@ static unsigned long _lastDspSaveRequest = 0;
 static bool _dspSavePending = false;
 static const unsigned long DSP_SAVE_DEBOUNCE_MS = 5000;
 
-void loadDspSettings() {
-    // Load global settings (skip open if file missing to avoid VFS error log)
+// The JSON files are the pre-snapshot format. They are still read once to
+// migrate, and rewritten from the live config whenever a settings export or
+// import needs them (dsp_settings_write_json); saves only touch the snapshot.
+static bool loadDspSettingsJson() {
+    bool found = false;
+    // Global settings (skip open if file missing to avoid VFS error log)
     if (dspFileExists("/dsp_global.json")) {
+        found = true;
         File f = LittleFS.open("/dsp_global.json", "r");
         if (f && f.size() > 0) {
             String json = f.readString();
             f.close();
 
-JsonDocument doc;
+            JsonDocument doc;
             if (!deserializeJson(doc, json)) {
                 DspState *cfg = dsp_get_inactive_config();
                 if (doc["globalBypass"].is<bool>()) cfg->globalBypass = doc["globalBypass"].as<bool>();
@@ -67,6 +76,7 @@ JsonDocument doc;
         char path[24];
         snprintf(path, sizeof(path), "/dsp_ch%d.json", ch);
         if (dspFileExists(path)) {
+            found = true;
             File cf = LittleFS.open(path, "r");
             if (cf && cf.size() > 0) {
                 String json = cf.readString();
@@ -96,6 +106,7 @@ JsonDocument doc;
                         ff.read((uint8_t *)tapsBuf0, taps * sizeof(float));
                         if (tapsBuf1) memcpy(tapsBuf1, tapsBuf0, taps * sizeof(float));
                         chCfg.stages[s].fir.numTaps = (uint16_t)taps;
+                        dsp_fir_commit_taps(slot, taps);
                     }
                     break;
                 }
@@ -106,18 +117,11 @@ JsonDocument doc;
         }
     }
 
-    // Recompute all coefficients and swap to make loaded config active
-    DspState *cfg = dsp_get_inactive_config();
-    for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
-        dsp_recompute_channel_coeffs(cfg->channels[ch], cfg->sampleRate);
-    }
-    if (!dsp_swap_config()) { dsp_log_swap_failure("DSP API"); }
-
-    LOG_I("[DSP] Settings loaded from LittleFS");
+    return found;
 }
 
-void saveDspSettings() {
-    // Save global settings
+void dsp_settings_write_json() {
+    // Global settings
     JsonDocument globalDoc;
     DspState *cfg = dsp_get_active_config();
     globalDoc["globalBypass"] = cfg->globalBypass;
@@ -164,9 +168,94 @@ void saveDspSettings() {
             }
         }
     }
+}
+
+// ===== Binary snapshot (boot path) =====
+// Payload: DspSnapshotHead, then the dsp_image_pack() image. Bump the schema
+// when DspSnapshotHead changes; the image carries its own layout check.
+#define DSP_SNAPSHOT_SCHEMA 1
+
+struct DspSnapshotHead {
+    uint8_t dspEnabled;
+    int8_t  presetIndex;
+    uint8_t reserved[2];
+    char    presetNames[DSP_PRESET_MAX_SLOTS][21];
+};
+
+static const size_t DSP_SNAPSHOT_MAX_BYTES = sizeof(DspSnapshotHead) + DSP_IMAGE_MAX_BYTES;
+static ConfigSnapshotStore _dspStore = CONFIG_SNAPSHOT_STORE(CONFIG_SNAPSHOT_BASE_DSP, DSP_SNAPSHOT_MAX_BYTES);
+
+static bool loadDspSnapshot() {
+    uint8_t *buf = (uint8_t *)psram_alloc(DSP_SNAPSHOT_MAX_BYTES, 1, "dsp_snapshot");
+    if (!buf) return false;
+    size_t len = 0;
+    ConfigSnapshotResult r = config_snapshot_store_load(_dspStore, DSP_SNAPSHOT_SCHEMA, buf,
+                                                        DSP_SNAPSHOT_MAX_BYTES, &len);
+    bool ok = r == CFG_SNAP_OK && len >= sizeof(DspSnapshotHead) && len <= DSP_SNAPSHOT_MAX_BYTES &&
+              dsp_image_unpack(buf + sizeof(DspSnapshotHead), len - sizeof(DspSnapshotHead));
+    if (ok) {
+        DspSnapshotHead head;
+        memcpy(&head, buf, sizeof(head));
+        appState.dsp.enabled = head.dspEnabled != 0;
+        appState.dsp.presetIndex = head.presetIndex;
+        for (int i = 0; i < DSP_PRESET_MAX_SLOTS; i++) {
+            memcpy(appState.dsp.presetNames[i], head.presetNames[i], 21);
+            appState.dsp.presetNames[i][20] = '\0';
+        }
+    } else if (r != CFG_SNAP_NONE) {
+        LOG_W("[DSP] Snapshot unusable (%d), falling back to JSON", (int)r);
+    }
+    psram_free(buf, "dsp_snapshot");
+    return ok;
+}
+
+void loadDspSettings() {
+    bool migrate = false;
+    if (!loadDspSnapshot()) migrate = loadDspSettingsJson();
+
+    // Recompute all coefficients and swap to make loaded config active
+    DspState *cfg = dsp_get_inactive_config();
+    for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+        dsp_recompute_channel_coeffs(cfg->channels[ch], cfg->sampleRate);
+    }
+    if (!dsp_swap_config()) { dsp_log_swap_failure("DSP API"); }
+
+    // Pack reads the active config, so migrate after the swap
+    if (migrate) {
+        LOG_I("[DSP] Migrating DSP JSON -> binary snapshot");
+        saveDspSettings();
+    }
+    LOG_I("[DSP] Settings loaded from LittleFS");
+}
+
+void saveDspSettings() {
+    uint8_t *buf = (uint8_t *)psram_alloc(DSP_SNAPSHOT_MAX_BYTES, 1, "dsp_save");
+    if (!buf) {
+        LOG_E("[DSP] Save failed: no buffer, retrying");
+        _lastDspSaveRequest = millis();
+        _dspSavePending = true;
+        return;
+    }
+    DspSnapshotHead head;
+    memset(&head, 0, sizeof(head));
+    head.dspEnabled = appState.dsp.enabled ? 1 : 0;
+    head.presetIndex = appState.dsp.presetIndex;
+    for (int i = 0; i < DSP_PRESET_MAX_SLOTS; i++) {
+        memcpy(head.presetNames[i], appState.dsp.presetNames[i], 21);
+    }
+    memcpy(buf, &head, sizeof(head));
+    size_t n = dsp_image_pack(buf + sizeof(head), DSP_SNAPSHOT_MAX_BYTES - sizeof(head));
+    ConfigSnapshotResult r = n ? config_snapshot_store_save(_dspStore, DSP_SNAPSHOT_SCHEMA, buf, sizeof(head) + n)
+                               : CFG_SNAP_TOO_LARGE;
+    psram_free(buf, "dsp_save");
 
     _dspSavePending = false;
-    LOG_I("[DSP] Settings saved to LittleFS");
+    if (r != CFG_SNAP_OK) {
+        LOG_E("[DSP] Snapshot save failed (%d)", (int)r);
+        return;
+    }
+    LOG_I("[DSP] Settings saved (snapshot gen %lu, %u bytes)",
+          (unsigned long)_dspStore.stats.generation, (unsigned)(sizeof(head) + n));
 }
 
 void saveDspSettingsDebounced() {
@@ -266,7 +355,7 @@ JsonDocument doc;
     if (deserializeJson(doc, json)) return false;
 
     // Load full config into inactive buffer
-    dsp_copy_active_to_inactive();
+    if (!dsp_copy_active_to_inactive()) return false;
     dsp_import_full_config_json(json.c_str());
 
     // Load dspEnabled
@@ -279,7 +368,7 @@ JsonDocument doc;
         dsp_recompute_channel_coeffs(cfg->channels[ch], cfg->sampleRate);
     }
 
-    if (!dsp_swap_config()) { dsp_log_swap_failure("DSP API"); }
+    if (!dsp_swap_config()) { dsp_log_swap_failure("DSP API"); return false; }
 
     // Mark config dirty first (this invalidates preset to -1), then restore
     appState.markDspConfigDirty();
@@ -407,6 +496,9 @@ static DspStageType typeFromString(const char *name) {
     if (strcmp(name, "LOUDNESS") == 0) return DSP_LOUDNESS;
     if (strcmp(name, "BASS_ENHANCE") == 0) return DSP_BASS_ENHANCE;
     if (strcmp(name, "MULTIBAND_COMP") == 0) return DSP_MULTIBAND_COMP;
+    if (strcmp(name, "TRUE_PEAK_LIMITER") == 0) return DSP_TRUE_PEAK_LIMITER;
+    if (strcmp(name, "DECIMATOR") == 0) return DSP_DECIMATOR;
+    if (strcmp(name, "INTERPOLATOR") == 0) return DSP_INTERPOLATOR;
     return DSP_BIQUAD_PEQ;
 }
 
@@ -419,6 +511,428 @@ static void autoMirrorIfLinked(int ch) {
     }
 }
 
+// ===== Streaming WAV IR Upload =====
+//
+// The IR arrives as a multipart HTTPUpload and is parsed chunk-by-chunk
+// (dsp_wav_stream) straight into a PSRAM staging buffer — the file is never
+// buffered in internal heap. Resampling to the DSP rate and partitioning into
+// a convolution slot run in a one-shot task; the finished slot is published
+// from the main loop with a normal config swap, and the previous slot is only
+// freed after the swap so audio never sees a half-built IR.
+
+// Staging holds the IR at the file's rate: 2x headroom for a 96k IR on a 48k pipeline
+#define CONV_UPLOAD_MAX_TAPS     (CONV_MAX_PARTITIONS * CONV_PARTITION_SIZE)
+#define CONV_UPLOAD_STAGING_TAPS (CONV_UPLOAD_MAX_TAPS * 2)
+
+enum ConvUploadState : uint8_t {
+    CONV_UPLOAD_IDLE = 0,
+    CONV_UPLOAD_RECEIVING,   // HTTPUpload chunks being parsed
+    CONV_UPLOAD_PARSED,      // Staging holds the IR, waiting for the final handler
+    CONV_UPLOAD_BUILDING,    // Background task resampling + partitioning
+    CONV_UPLOAD_PUBLISH,     // Slot built, main loop swaps it in
+    CONV_UPLOAD_DONE,
+    CONV_UPLOAD_ERROR
+};
+
+// `state` is the hand-off between the web server, the build task and the main
+// loop: it is stored with release after the fields it publishes (taps, slot,
+// error) and loaded with acquire before they are read.
+struct ConvUploadJob {
+    std::atomic<uint8_t> state;
+    int ch;
+    float *staging;          // PSRAM, parsed taps at the file's rate
+    WavIrStream ws;
+    int srcTaps;
+    uint32_t dstRate;
+    int taps;                // Taps after resampling
+    int slot;                // Slot built by the task
+    int oldSlot;             // Slot referenced by the channel before the upload
+    const char *error;
+};
+
+static ConvUploadJob _convJob = {};
+
+static inline ConvUploadState convJobState() {
+    return (ConvUploadState)_convJob.state.load(std::memory_order_acquire);
+}
+
+static inline void convJobSetState(ConvUploadState s) {
+    _convJob.state.store(s, std::memory_order_release);
+}
+
+static const char *convUploadStateName(ConvUploadState s) {
+    switch (s) {
+        case CONV_UPLOAD_RECEIVING: return "receiving";
+        case CONV_UPLOAD_PARSED:    return "parsed";
+        case CONV_UPLOAD_BUILDING:  return "building";
+        case CONV_UPLOAD_PUBLISH:   return "publishing";
+        case CONV_UPLOAD_DONE:      return "done";
+        case CONV_UPLOAD_ERROR:     return "error";
+        default:                    return "idle";
+    }
+}
+
+static bool convUploadBusy() {
+    ConvUploadState s = convJobState();
+    return s == CONV_UPLOAD_BUILDING || s == CONV_UPLOAD_PUBLISH;
+}
+
+static void convUploadFail(const char *msg) {
+    if (_convJob.staging) {
+        psram_free(_convJob.staging, "conv_ir_upload");
+        _convJob.staging = nullptr;
+    }
+    _convJob.error = msg;
+    convJobSetState(CONV_UPLOAD_ERROR);
+    LOG_W("[DSP] Convolution upload ch=%d failed: %s", _convJob.ch, msg);
+}
+
+static int findConvStage(const DspChannelConfig &chCfg) {
+    for (int s = 0; s < chCfg.stageCount; s++) {
+        if (chCfg.stages[s].type == DSP_CONVOLUTION) return s;
+    }
+    return -1;
+}
+
+// Background half: resample staging → IR buffer, then partition into the slot.
+static void convUploadBuild() {
+    float *irBuf = (float *)psram_alloc(CONV_UPLOAD_MAX_TAPS, sizeof(float), "conv_ir_upload");
+    if (!irBuf) { convUploadFail("Out of memory"); return; }
+
+    int taps = dsp_wav_resample_ir(_convJob.staging, _convJob.srcTaps, _convJob.ws.sampleRate,
+                                   irBuf, CONV_UPLOAD_MAX_TAPS, _convJob.dstRate);
+    psram_free(_convJob.staging, "conv_ir_upload");
+    _convJob.staging = nullptr;
+    if (taps <= 0) {
+        psram_free(irBuf, "conv_ir_upload");
+        convUploadFail("Resample failed");
+        return;
+    }
+
+    int rc = dsp_conv_init_slot(_convJob.slot, irBuf, taps);
+    psram_free(irBuf, "conv_ir_upload");
+    if (rc < 0) { convUploadFail("Convolution init failed"); return; }
+
+    _convJob.taps = taps;
+    convJobSetState(CONV_UPLOAD_PUBLISH);
+    LOG_D("[DSP] Convolution IR built: ch=%d slot=%d taps=%d (%d @ %lu Hz)",
+          _convJob.ch, _convJob.slot, taps, _convJob.srcTaps, (unsigned long)_convJob.ws.sampleRate);
+}
+
+// Main-loop half: reference the new slot from the channel and swap.
+static void convUploadPublish() {
+    if (convJobState() != CONV_UPLOAD_PUBLISH) return;
+
+    // An earlier publish still being adopted — stay in PUBLISH and retry next loop
+    if (!dsp_copy_active_to_inactive()) return;
+    DspChannelConfig &chCfg = dsp_get_inactive_config()->channels[_convJob.ch];
+    int stageIdx = findConvStage(chCfg);
+    if (stageIdx < 0) {
+        if (chCfg.stageCount >= DSP_MAX_STAGES) {
+            dsp_conv_free_slot(_convJob.slot);
+            convUploadFail("Max stages reached");
+            return;
+        }
+        stageIdx = chCfg.stageCount++;
+        dsp_init_stage(chCfg.stages[stageIdx], DSP_CONVOLUTION);
+    }
+    chCfg.stages[stageIdx].convolution.convSlot = (int8_t)_convJob.slot;
+    chCfg.stages[stageIdx].enabled = true;
+
+    // Swap contention is transient — stay in PUBLISH and retry next loop
+    if (!dsp_swap_config()) { dsp_log_swap_failure("DSP API"); return; }
+
+    if (_convJob.oldSlot >= 0) dsp_conv_free_slot(_convJob.oldSlot);
+    convJobSetState(CONV_UPLOAD_DONE);
+    saveDspSettingsDebounced();
+    appState.markDspConfigDirty();
+    LOG_I("[DSP] Convolution upload: ch=%d slot=%d irLength=%d sampleRate=%lu",
+          _convJob.ch, _convJob.slot, _convJob.taps, (unsigned long)_convJob.dstRate);
+}
+
+static void handleConvUploadChunk() {
+    HTTPUpload &upload = server.upload();
+    if (upload.status == UPLOAD_FILE_START) {
+        if (convUploadBusy()) return;  // Rejected in the final handler
+        if (_convJob.staging) psram_free(_convJob.staging, "conv_ir_upload");
+        convJobSetState(CONV_UPLOAD_IDLE);
+        _convJob.staging = nullptr;
+        _convJob.ws = WavIrStream();
+        _convJob.srcTaps = 0;
+        _convJob.dstRate = 0;
+        _convJob.taps = 0;
+        _convJob.error = nullptr;
+        _convJob.ch = parseChannelParam();
+        _convJob.oldSlot = -1;
+        _convJob.slot = -1;
+        if (_convJob.ch < 0) { convUploadFail("Invalid channel"); return; }
+        _convJob.staging = (float *)psram_alloc(CONV_UPLOAD_STAGING_TAPS, sizeof(float), "conv_ir_upload");
+        if (!_convJob.staging) { convUploadFail("Out of memory"); return; }
+        uint8_t irCh = server.hasArg("irch") ? (uint8_t)server.arg("irch").toInt() : 0;
+        wav_stream_init(&_convJob.ws, _convJob.staging, CONV_UPLOAD_STAGING_TAPS, irCh);
+        convJobSetState(CONV_UPLOAD_RECEIVING);
+        LOG_I("[DSP] Convolution upload started: ch=%d file=%s", _convJob.ch, upload.filename.c_str());
+    } else if (upload.status == UPLOAD_FILE_WRITE) {
+        if (convJobState() != CONV_UPLOAD_RECEIVING) return;
+        if (!wav_stream_feed(&_convJob.ws, upload.buf, upload.currentSize)) {
+            convUploadFail(wav_stream_error_str(_convJob.ws.error));
+        }
+    } else if (upload.status == UPLOAD_FILE_END) {
+        if (convJobState() != CONV_UPLOAD_RECEIVING) return;
+        _convJob.srcTaps = wav_stream_finish(&_convJob.ws);
+        if (_convJob.srcTaps <= 0) { convUploadFail(wav_stream_error_str(_convJob.ws.error)); return; }
+        if (_convJob.ws.clipped) LOG_W("[DSP] Convolution IR truncated to %d taps", _convJob.srcTaps);
+        convJobSetState(CONV_UPLOAD_PARSED);
+    } else if (upload.status == UPLOAD_FILE_ABORTED) {
+        if (convJobState() == CONV_UPLOAD_RECEIVING) convUploadFail("Upload aborted");
+    }
+}
+
+static void handleConvUploadComplete() {
+    if (convUploadBusy()) { sendJsonError(409, "Convolution upload already in progress"); return; }
+    if (convJobState() == CONV_UPLOAD_ERROR) { sendJsonError(400, _convJob.error); return; }
+    if (convJobState() != CONV_UPLOAD_PARSED) { sendJsonError(400, "No WAV file received"); return; }
+
+    DspState *active = dsp_get_active_config();
+    const DspChannelConfig &chCfg = active->channels[_convJob.ch];
+    int stageIdx = findConvStage(chCfg);
+    if (stageIdx >= 0) _convJob.oldSlot = chCfg.stages[stageIdx].convolution.convSlot;
+
+    // Build into a free slot only: the live IR keeps playing until the swap.
+    // The channel's own slot is never rebuilt — the audio task may be
+    // reading its partitions and history while the build task reallocates.
+    for (int i = 0; i < CONV_MAX_IR_SLOTS; i++) {
+        if (!dsp_conv_is_active(i)) { _convJob.slot = i; break; }
+    }
+    if (_convJob.slot < 0) { convUploadFail("No free convolution slot"); sendJsonError(409, _convJob.error); return; }
+    _convJob.dstRate = active->sampleRate > 0 ? active->sampleRate : 48000;
+    convJobSetState(CONV_UPLOAD_BUILDING);
+
+#ifndef NATIVE_TEST
+    // One-shot task: windowed-sinc resample of up to ~50k taps is far too
+    // slow for the web server thread. Stack 4096 — locals are tiny.
+    static auto convBuildTask = [](void *param) {
+        (void)param;
+        convUploadBuild();
+        vTaskDelete(NULL);
+    };
+    if (xTaskCreatePinnedToCore(convBuildTask, "conv_ir", 4096, nullptr, 1, nullptr, 0) != pdPASS) {
+        LOG_W("[DSP] Failed to spawn IR build task — building synchronously");
+        convUploadBuild();
+    }
+#else
+    convUploadBuild();
+#endif
+
+    char resp[128];
+    snprintf(resp, sizeof(resp),
+             "{\"success\":true,\"pending\":true,\"tapsLoaded\":%d,\"fileSampleRate\":%lu,\"sampleRate\":%lu}",
+             _convJob.srcTaps, (unsigned long)_convJob.ws.sampleRate, (unsigned long)_convJob.dstRate);
+    server_send(202, "application/json", resp);
+}
+
+// ===== FIR Designer =====
+// POST /api/dsp/fir/design designs crossover / EQ taps (dsp_fir_design) in a
+// one-shot low-priority task on Core 0, reporting progress into the job. The
+// finished taps are published from the main loop like a convolution upload:
+// a fresh FIR slot is filled while the old one keeps playing, the channel's
+// stage is pointed at it and swapped in, and only then is the old slot
+// released. Designs are capped at DSP_MAX_FIR_TAPS.
+
+enum FirDesignState : uint8_t {
+    FIR_DESIGN_IDLE = 0,
+    FIR_DESIGN_DESIGNING,    // Background task running
+    FIR_DESIGN_PUBLISH,      // Taps ready, main loop swaps them in
+    FIR_DESIGN_DONE,
+    FIR_DESIGN_ERROR
+};
+
+struct FirDesignJob {
+    volatile FirDesignState state;
+    volatile int progress;   // 0..100
+    int ch;
+    DspFirDesignSpec spec;
+    float *taps;             // PSRAM, designed taps
+    int numTaps;
+    const char *error;
+};
+
+static FirDesignJob _firJob = {};
+
+static const char *firDesignStateName(FirDesignState s) {
+    switch (s) {
+        case FIR_DESIGN_DESIGNING: return "designing";
+        case FIR_DESIGN_PUBLISH:   return "publishing";
+        case FIR_DESIGN_DONE:      return "done";
+        case FIR_DESIGN_ERROR:     return "error";
+        default:                   return "idle";
+    }
+}
+
+static bool firDesignBusy() {
+    FirDesignState s = _firJob.state;
+    return s == FIR_DESIGN_DESIGNING || s == FIR_DESIGN_PUBLISH;
+}
+
+static void firDesignFail(const char *msg) {
+    if (_firJob.taps) {
+        psram_free(_firJob.taps, "fir_design");
+        _firJob.taps = nullptr;
+    }
+    _firJob.error = msg;
+    _firJob.state = FIR_DESIGN_ERROR;
+    LOG_W("[DSP] FIR design ch=%d failed: %s", _firJob.ch, msg);
+}
+
+static bool parseFirDesignKind(const char *name, DspFirDesignKind &kind) {
+    if (!name) return false;
+    if (strcmp(name, "lr_linear") == 0)  { kind = DSP_FIR_DESIGN_LR_LINEAR;  return true; }
+    if (strcmp(name, "lr_minimum") == 0) { kind = DSP_FIR_DESIGN_LR_MINIMUM; return true; }
+    if (strcmp(name, "eq_minimum") == 0) { kind = DSP_FIR_DESIGN_EQ_MINIMUM; return true; }
+    return false;
+}
+
+// Background half: design into the taps buffer.
+static void firDesignBuild() {
+    float *work = (float *)psram_alloc(dsp_fir_design_work_floats(_firJob.spec.numTaps), sizeof(float), "fir_design");
+    if (!work) { firDesignFail("Out of memory"); return; }
+
+    int taps = dsp_fir_design(_firJob.spec, _firJob.taps, work,
+                              [](int percent, void *) { _firJob.progress = percent; });
+    psram_free(work, "fir_design");
+    if (taps <= 0) { firDesignFail("Design failed"); return; }
+
+    _firJob.numTaps = taps;
+    _firJob.state = FIR_DESIGN_PUBLISH;
+    LOG_D("[DSP] FIR designed: ch=%d taps=%d", _firJob.ch, taps);
+}
+
+static int findStageOfType(const DspChannelConfig &chCfg, DspStageType type) {
+    for (int s = 0; s < chCfg.stageCount; s++) {
+        if (chCfg.stages[s].type == type) return s;
+    }
+    return -1;
+}
+
+// Main-loop half: replace the channel's FIR stage and swap.
+static void firDesignPublish() {
+    if (_firJob.state != FIR_DESIGN_PUBLISH) return;
+
+    // An earlier publish still being adopted — stay in PUBLISH and retry next loop
+    if (!dsp_copy_active_to_inactive()) return;
+    int slot = dsp_fir_alloc_slot();
+    if (slot < 0) { firDesignFail("No FIR slots available"); return; }
+    float *t0 = dsp_fir_get_taps(0, slot);
+    float *t1 = dsp_fir_get_taps(1, slot);
+    if (!t0 || !t1) { dsp_fir_free_slot(slot); firDesignFail("FIR pool error"); return; }
+    memcpy(t0, _firJob.taps, _firJob.numTaps * sizeof(float));
+    memcpy(t1, _firJob.taps, _firJob.numTaps * sizeof(float));
+
+    DspChannelConfig &chCfg = dsp_get_inactive_config()->channels[_firJob.ch];
+    int stageIdx = findStageOfType(chCfg, DSP_FIR);
+    int oldSlot = -1;
+    if (stageIdx >= 0) {
+        oldSlot = chCfg.stages[stageIdx].fir.firSlot;
+    } else {
+        if (chCfg.stageCount >= DSP_MAX_STAGES) {
+            dsp_fir_free_slot(slot);
+            firDesignFail("Max stages reached");
+            return;
+        }
+        stageIdx = chCfg.stageCount++;
+        dsp_init_stage(chCfg.stages[stageIdx], DSP_FIR);
+    }
+    DspStage &s = chCfg.stages[stageIdx];
+    s.fir.firSlot = (int8_t)slot;
+    s.fir.numTaps = (uint16_t)_firJob.numTaps;
+    dsp_fir_commit_taps(slot, _firJob.numTaps);
+    s.enabled = true;
+    // A designed crossover / EQ shapes what reaches the drivers — never shed it
+    s.priority = DSP_PRIORITY_PROTECTED;
+
+    // Swap contention is transient — release the fresh FIR slot and retry next
+    // loop, unless the publish is still being adopted: then it goes live with
+    // that slot, and the retry replaces it like any previous design
+    if (!dsp_swap_config()) {
+        dsp_log_swap_failure("DSP API");
+        if (!dsp_swap_in_flight()) dsp_fir_free_slot(slot);
+        return;
+    }
+
+    if (oldSlot >= 0) dsp_fir_free_slot(oldSlot);
+    if (_firJob.taps) {
+        psram_free(_firJob.taps, "fir_design");
+        _firJob.taps = nullptr;
+    }
+    _firJob.state = FIR_DESIGN_DONE;
+    saveDspSettingsDebounced();
+    appState.markDspConfigDirty();
+    LOG_I("[DSP] FIR design published: ch=%d taps=%d (slot %d)", _firJob.ch, _firJob.numTaps, slot);
+}
+
+static void handleFirDesign() {
+    if (firDesignBusy()) { sendJsonError(409, "FIR design already in progress"); return; }
+    int ch = parseChannelParam();
+    if (ch < 0) { sendJsonError(400, "Invalid channel"); return; }
+    if (!server.hasArg("plain")) { sendJsonError(400, "No data"); return; }
+
+    JsonDocument doc;
+    if (deserializeJson(doc, server.arg("plain"))) { sendJsonError(400, "Invalid JSON"); return; }
+
+    DspFirDesignSpec spec = {};
+    if (!parseFirDesignKind(doc["kind"] | "", spec.kind)) { sendJsonError(400, "Unknown design kind"); return; }
+    DspState *active = dsp_get_active_config();
+    spec.sampleRate = active->sampleRate > 0 ? active->sampleRate : 48000;
+    spec.numTaps = (uint16_t)(doc["taps"] | 2048);
+    spec.freqHz = doc["freq"] | 1000.0f;
+    spec.order = (uint8_t)(doc["order"] | 4);
+    spec.role = (uint8_t)(doc["role"] | 0);
+    JsonArray points = doc["points"].as<JsonArray>();
+    for (JsonObject p : points) {
+        if (spec.numPoints >= DSP_FIR_DESIGN_MAX_POINTS) break;
+        spec.points[spec.numPoints].freqHz = p["freq"] | 0.0f;
+        spec.points[spec.numPoints].gainDb = p["gain"] | 0.0f;
+        spec.numPoints++;
+    }
+    const char *err = dsp_fir_design_check(spec);
+    if (err) { sendJsonError(400, err); return; }
+    // Convolution slots only run their first partition per block, far too
+    // short for a long linear-phase design — designs must fit a FIR stage
+    if (spec.numTaps > DSP_MAX_FIR_TAPS) { sendJsonError(400, "Tap count exceeds FIR stage limit"); return; }
+
+    if (_firJob.taps) psram_free(_firJob.taps, "fir_design");
+    _firJob = FirDesignJob();
+    _firJob.ch = ch;
+    _firJob.spec = spec;
+    _firJob.taps = (float *)psram_alloc(spec.numTaps, sizeof(float), "fir_design");
+    if (!_firJob.taps) { sendJsonError(503, "Out of memory"); return; }
+    _firJob.state = FIR_DESIGN_DESIGNING;
+
+#ifndef NATIVE_TEST
+    // One-shot task at idle-adjacent priority: an 8192-point design takes a
+    // few ms of FFTs and must never compete with audio or the web server
+    static auto firDesignTask = [](void *param) {
+        (void)param;
+        firDesignBuild();
+        vTaskDelete(NULL);
+    };
+    if (xTaskCreatePinnedToCore(firDesignTask, "fir_design", DSP_FIR_DESIGN_TASK_STACK, nullptr,
+                                DSP_FIR_DESIGN_TASK_PRIORITY, nullptr, DSP_FIR_DESIGN_TASK_CORE) != pdPASS) {
+        LOG_W("[DSP] Failed to spawn FIR design task — designing synchronously");
+        firDesignBuild();
+    }
+#else
+    firDesignBuild();
+#endif
+
+    char resp[128];
+    snprintf(resp, sizeof(resp),
+             "{\"success\":true,\"pending\":true,\"taps\":%d,\"sampleRate\":%lu,\"target\":\"fir\"}",
+             spec.numTaps, (unsigned long)spec.sampleRate);
+    server_send(202, "application/json", resp);
+    LOG_I("[DSP] FIR design started: ch=%d kind=%d taps=%d", ch, spec.kind, spec.numTaps);
+}
+
 // ===== API Endpoint Registration =====
 
 void registerDspApiEndpoints() {
@@ -447,6 +961,7 @@ JsonDocument doc;
         if (!requireAuth()) return;
         if (!server.hasArg("plain")) { sendJsonError(400, "No data"); return; }
 
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
         dsp_import_full_config_json(server.arg("plain").c_str());
 
 JsonDocument doc;
@@ -464,7 +979,7 @@ JsonDocument doc;
     // POST /api/dsp/bypass — toggle global bypass
     server_on_versioned("/api/dsp/bypass", HTTP_POST, []() {
         if (!requireAuth()) return;
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
         DspState *cfg = dsp_get_inactive_config();
         if (server.hasArg("plain")) {
 JsonDocument doc;
@@ -518,7 +1033,7 @@ JsonDocument doc;
         int ch = parseChannelParam();
         if (ch < 0) { sendJsonError(400, "Invalid channel"); return; }
 
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
         DspState *cfg = dsp_get_inactive_config();
         if (server.hasArg("plain")) {
 JsonDocument doc;
@@ -549,7 +1064,7 @@ JsonDocument doc;
 
         // Copy active config to inactive, then modify
         DspState *inactive = dsp_get_inactive_config();
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
 
         int idx = dsp_add_stage(ch, type, pos);
         if (idx < 0) { sendJsonError(400, "Max stages reached"); return; }
@@ -561,6 +1076,7 @@ JsonDocument doc;
             strncpy(s.label, doc["label"].as<const char *>(), sizeof(s.label) - 1);
             s.label[sizeof(s.label) - 1] = '\0';
         }
+        if (doc["priority"].is<int>()) s.priority = dsp_clamp_priority(doc["priority"].as<int>());
 
         JsonObject params = doc["params"];
         if (dsp_is_biquad_type(type) && !params.isNull()) {
@@ -582,6 +1098,10 @@ JsonDocument doc;
                 uint16_t ds = params["delaySamples"].as<uint16_t>();
                 s.delay.delaySamples = ds > DSP_MAX_DELAY_SAMPLES ? DSP_MAX_DELAY_SAMPLES : ds;
             }
+            if (params["fraction"].is<float>() || params["interp"].is<int>()) {
+                dsp_delay_set_fraction(s.delay, params["fraction"] | s.delay.fraction,
+                                       params["interp"] | (int)s.delay.interp);
+            }
         } else if (type == DSP_POLARITY && !params.isNull()) {
             if (params["inverted"].is<bool>()) s.polarity.inverted = params["inverted"].as<bool>();
         } else if (type == DSP_MUTE && !params.isNull()) {
@@ -623,6 +1143,14 @@ JsonDocument doc;
             dsp_compute_bass_enhance_coeffs(s.bassEnhance, inactive->sampleRate);
         } else if (type == DSP_MULTIBAND_COMP && !params.isNull()) {
             if (params["numBands"].is<int>()) s.multibandComp.numBands = params["numBands"].as<uint8_t>();
+        } else if (type == DSP_DECIMATOR && !params.isNull()) {
+            if (params["factor"].is<int>()) s.decimator.factor = dsp_clamp_decimator_factor(params["factor"].as<int>());
+        } else if (type == DSP_TRUE_PEAK_LIMITER && !params.isNull()) {
+            if (params["ceilingDb"].is<float>()) s.truePeak.ceilingDb = params["ceilingDb"].as<float>();
+            if (params["lookaheadMs"].is<float>()) s.truePeak.lookaheadMs = params["lookaheadMs"].as<float>();
+            if (params["releaseMs"].is<float>()) s.truePeak.releaseMs = params["releaseMs"].as<float>();
+            if (params["linked"].is<bool>()) s.truePeak.linked = params["linked"].as<bool>();
+            dsp_tp_clamp_params(s.truePeak);
         }
 
         autoMirrorIfLinked(ch);
@@ -648,7 +1176,7 @@ JsonDocument doc;
         if (deserializeJson(doc, server.arg("plain"))) { sendJsonError(400, "Invalid JSON"); return; }
 
         DspState *inactive = dsp_get_inactive_config();
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
 
         if (si < 0 || si >= inactive->channels[ch].stageCount) {
             sendJsonError(400, "Invalid stage index");
@@ -661,6 +1189,7 @@ JsonDocument doc;
             strncpy(s.label, doc["label"].as<const char *>(), sizeof(s.label) - 1);
             s.label[sizeof(s.label) - 1] = '\0';
         }
+        if (doc["priority"].is<int>()) s.priority = dsp_clamp_priority(doc["priority"].as<int>());
 
         JsonObject params = doc["params"];
         if (dsp_is_biquad_type(s.type) && !params.isNull()) {
@@ -688,6 +1217,10 @@ JsonDocument doc;
                 uint16_t ds = params["delaySamples"].as<uint16_t>();
                 s.delay.delaySamples = ds > DSP_MAX_DELAY_SAMPLES ? DSP_MAX_DELAY_SAMPLES : ds;
             }
+            if (params["fraction"].is<float>() || params["interp"].is<int>()) {
+                dsp_delay_set_fraction(s.delay, params["fraction"] | s.delay.fraction,
+                                       params["interp"] | (int)s.delay.interp);
+            }
         } else if (s.type == DSP_POLARITY && !params.isNull()) {
             if (params["inverted"].is<bool>()) s.polarity.inverted = params["inverted"].as<bool>();
         } else if (s.type == DSP_MUTE && !params.isNull()) {
@@ -729,6 +1262,14 @@ JsonDocument doc;
             dsp_compute_bass_enhance_coeffs(s.bassEnhance, inactive->sampleRate);
         } else if (s.type == DSP_MULTIBAND_COMP && !params.isNull()) {
             if (params["numBands"].is<int>()) s.multibandComp.numBands = params["numBands"].as<uint8_t>();
+        } else if (s.type == DSP_DECIMATOR && !params.isNull()) {
+            if (params["factor"].is<int>()) s.decimator.factor = dsp_clamp_decimator_factor(params["factor"].as<int>());
+        } else if (s.type == DSP_TRUE_PEAK_LIMITER && !params.isNull()) {
+            if (params["ceilingDb"].is<float>()) s.truePeak.ceilingDb = params["ceilingDb"].as<float>();
+            if (params["lookaheadMs"].is<float>()) s.truePeak.lookaheadMs = params["lookaheadMs"].as<float>();
+            if (params["releaseMs"].is<float>()) s.truePeak.releaseMs = params["releaseMs"].as<float>();
+            if (params["linked"].is<bool>()) s.truePeak.linked = params["linked"].as<bool>();
+            dsp_tp_clamp_params(s.truePeak);
         }
 
         autoMirrorIfLinked(ch);
@@ -746,7 +1287,7 @@ JsonDocument doc;
         if (ch < 0) { sendJsonError(400, "Invalid channel"); return; }
 
         DspState *inactive = dsp_get_inactive_config();
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
 
         if (!dsp_remove_stage(ch, si)) {
             sendJsonError(400, "Invalid stage index");
@@ -775,7 +1316,7 @@ JsonDocument doc;
         JsonArray order = doc["order"].as<JsonArray>();
 
         DspState *inactive = dsp_get_inactive_config();
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
 
         int newOrder[DSP_MAX_STAGES];
         int count = 0;
@@ -803,7 +1344,7 @@ JsonDocument doc;
         if (ch < 0) { sendJsonError(400, "Invalid channel"); return; }
 
         DspState *inactive = dsp_get_inactive_config();
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
 
         bool newState = true;
         if (server.hasArg("plain")) {
@@ -839,7 +1380,7 @@ JsonDocument doc;
         if (!server.hasArg("plain")) { sendJsonError(400, "No data"); return; }
 
         DspState *inactive = dsp_get_inactive_config();
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
 
         int added = dsp_parse_apo_filters(server.arg("plain").c_str(),
                                            inactive->channels[ch],
@@ -865,7 +1406,7 @@ JsonDocument doc;
         if (!server.hasArg("plain")) { sendJsonError(400, "No data"); return; }
 
         DspState *inactive = dsp_get_inactive_config();
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
 
         int added = dsp_parse_minidsp_biquads(server.arg("plain").c_str(),
                                                 inactive->channels[ch]);
@@ -888,7 +1429,7 @@ JsonDocument doc;
         if (ch < 0) { sendJsonError(400, "Invalid channel"); return; }
         if (!server.hasArg("plain")) { sendJsonError(400, "No data"); return; }
 
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
         DspState *inactive = dsp_get_inactive_config();
 
         DspChannelConfig &chCfg = inactive->channels[ch];
@@ -915,15 +1456,17 @@ JsonDocument doc;
         s.fir.firSlot = (int8_t)slot;
         s.fir.numTaps = (uint16_t)taps;
         chCfg.stageCount++;
+        dsp_fir_commit_taps(slot, taps);
 
         if (!dsp_swap_config()) { dsp_log_swap_failure("DSP API"); sendJsonError(503, "DSP busy, retry"); return; }
         saveDspSettingsDebounced();
         appState.markDspConfigDirty();
 
-        char resp[64];
-        snprintf(resp, sizeof(resp), "{\"success\":true,\"taps\":%d}", taps);
+        bool fft = taps >= dsp_fir_fft_crossover();
+        char resp[80];
+        snprintf(resp, sizeof(resp), "{\"success\":true,\"taps\":%d,\"mode\":\"%s\"}", taps, fft ? "fft" : "direct");
         server_send(200, "application/json", resp);
-        LOG_I("[DSP] FIR import: %d taps to ch=%d", taps, ch);
+        LOG_I("[DSP] FIR import: %d taps to ch=%d (%s)", taps, ch, fft ? "fft" : "direct");
     });
 
     // GET /api/dsp/export/apo?ch=N
@@ -978,7 +1521,7 @@ JsonDocument doc;
         int role = doc["role"] | 0; // 0 = LPF, 1 = HPF
         const char *typeStr = doc["type"] | "lr4";
 
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
         dsp_clear_crossover_stages(ch);
 
         int result = -1;
@@ -1024,7 +1567,7 @@ JsonDocument doc;
         float widthMm = doc["baffleWidthMm"] | 250.0f;
         BaffleStepResult bsr = dsp_baffle_step_correction(widthMm);
 
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
         DspState *inactive = dsp_get_inactive_config();
         int idx = dsp_add_stage(ch, DSP_BIQUAD_HIGH_SHELF);
         if (idx < 0) { sendJsonError(400, "No room for stage"); return; }
@@ -1340,7 +1883,7 @@ JsonDocument doc;
         if (pair < 0 || pair > 1) { sendJsonError(400, "Invalid pair (0 or 1)"); return; }
         bool linked = doc["linked"] | true; // cppcheck-suppress badBitmaskCheck
 
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { sendJsonError(503, "DSP busy, retry"); return; }
         DspState *inactive = dsp_get_inactive_config();
         int chA = pair * 2;
         int chB = pair * 2 + 1;
@@ -1359,100 +1902,46 @@ JsonDocument doc;
         LOG_I("[DSP] Stereo link pair %d: %s", pair, linked ? "linked" : "unlinked");
     });
 
-    // POST /api/dsp/convolution/upload?ch=N — upload WAV impulse response for convolution
-    server_on_versioned("/api/dsp/convolution/upload", HTTP_POST, []() {
+    // POST /api/dsp/convolution/upload?ch=N[&irch=M] — stream a WAV impulse response
+    // (multipart) into channel N's convolution stage. Returns 202 once parsed;
+    // the IR is resampled and swapped in asynchronously (see convolution/status).
+    // Note: two-handler overload — manually aliased
+    server.on("/api/dsp/convolution/upload", HTTP_POST,
+        []() { if (!requireAuth()) return; handleConvUploadComplete(); },
+        []() { if (!requireAuth()) return; handleConvUploadChunk(); });
+    server.on("/api/v1/dsp/convolution/upload", HTTP_POST,
+        []() { if (!requireAuth()) return; handleConvUploadComplete(); },
+        []() { if (!requireAuth()) return; handleConvUploadChunk(); });
+
+    // GET /api/dsp/convolution/status — progress of the last IR upload
+    server_on_versioned("/api/dsp/convolution/status", HTTP_GET, []() {
         if (!requireAuth()) return;
-        int ch = parseChannelParam();
-        if (ch < 0) { sendJsonError(400, "Invalid channel"); return; }
-        if (!server.hasArg("plain")) { sendJsonError(400, "No data"); return; }
-
-        const String &body = server.arg("plain");
-        if (body.length() == 0) { sendJsonError(400, "Empty body"); return; }
-        const size_t maxIrBytes = CONV_MAX_PARTITIONS * CONV_PARTITION_SIZE * sizeof(float);
-        if (body.length() > maxIrBytes) { sendJsonError(413, "IR too large"); return; }
-
-        dsp_copy_active_to_inactive();
-        DspState *inactive = dsp_get_inactive_config();
-        DspChannelConfig &chCfg = inactive->channels[ch];
-
-        // Allocate convolution slot (pool has CONV_MAX_IR_SLOTS=2 slots)
-        // Check if channel already has a DSP_CONVOLUTION stage to reuse its slot
-        int existingSlot = -1;
-        int existingStageIdx = -1;
-        for (int s = 0; s < chCfg.stageCount; s++) {
-            if (chCfg.stages[s].type == DSP_CONVOLUTION) {
-                existingSlot = chCfg.stages[s].convolution.convSlot;
-                existingStageIdx = s;
-                break;
-            }
-        }
-
-        // Allocate temp IR buffer for WAV parsing (up to CONV_MAX_PARTITIONS * CONV_PARTITION_SIZE floats)
-        const int maxTaps = CONV_MAX_PARTITIONS * CONV_PARTITION_SIZE;
-        float *irBuf = (float *)psram_alloc(maxTaps, sizeof(float), "conv_ir_upload");
-        if (!irBuf) { sendJsonError(503, "Out of memory"); return; }
-
-        uint32_t sampleRate = inactive->sampleRate > 0 ? inactive->sampleRate : 48000;
-        int taps = dsp_parse_wav_ir((const uint8_t *)body.c_str(), (int)body.length(),
-                                    irBuf, maxTaps, sampleRate);
-        if (taps <= 0) {
-            psram_free(irBuf, "conv_ir_upload");
-            sendJsonError(400, "Invalid WAV: must be mono PCM/float at matching sample rate");
-            return;
-        }
-
-        // Free old convolution slot if reusing
-        if (existingSlot >= 0) {
-            dsp_conv_free_slot(existingSlot);
-        }
-
-        // Allocate new convolution slot
-        // Find first available slot (0 or 1)
-        int convSlot = -1;
-        for (int i = 0; i < CONV_MAX_IR_SLOTS; i++) {
-            if (!dsp_conv_is_active(i)) { convSlot = i; break; }
-        }
-        if (convSlot < 0) {
-            psram_free(irBuf, "conv_ir_upload");
-            sendJsonError(400, "No convolution slots available");
-            return;
-        }
-
-        int rc = dsp_conv_init_slot(convSlot, irBuf, taps);
-        psram_free(irBuf, "conv_ir_upload");
-        if (rc < 0) { sendJsonError(500, "Convolution init failed"); return; }
-
-        // Update or add DSP_CONVOLUTION stage
-        if (existingStageIdx >= 0) {
-            chCfg.stages[existingStageIdx].convolution.convSlot = (int8_t)convSlot;
-            chCfg.stages[existingStageIdx].enabled = true;
-        } else {
-            if (chCfg.stageCount >= DSP_MAX_STAGES) {
-                dsp_conv_free_slot(convSlot);
-                sendJsonError(400, "Max stages reached");
-                return;
-            }
-            DspStage &s = chCfg.stages[chCfg.stageCount];
-            dsp_init_stage(s, DSP_CONVOLUTION);
-            s.convolution.convSlot = (int8_t)convSlot;
-            chCfg.stageCount++;
-        }
+        char resp[192];
+        ConvUploadState st = convJobState();
+        snprintf(resp, sizeof(resp),
+                 "{\"success\":true,\"state\":\"%s\",\"ch\":%d,\"slot\":%d,\"irLength\":%d,\"message\":\"%s\"}",
+                 convUploadStateName(st), _convJob.ch, _convJob.slot, _convJob.taps,
+                 (st == CONV_UPLOAD_ERROR && _convJob.error) ? _convJob.error : "");
+        server_send(200, "application/json", resp);
+    });
 
-        if (!dsp_swap_config()) {
-            dsp_conv_free_slot(convSlot);
-            dsp_log_swap_failure("DSP API");
-            sendJsonError(503, "DSP busy, retry");
-            return;
-        }
-        saveDspSettingsDebounced();
-        appState.markDspConfigDirty();
+    // POST /api/dsp/fir/design?ch=N — design FIR taps in the background (JSON:
+    // kind, taps, freq/order/role or points[{freq,gain}]); see fir/design/status
+    server_on_versioned("/api/dsp/fir/design", HTTP_POST, []() {
+        if (!requireAuth()) return;
+        handleFirDesign();
+    });
 
-        char resp[80];
-        snprintf(resp, sizeof(resp), "{\"success\":true,\"irLength\":%d,\"sampleRate\":%lu}",
-                 taps, (unsigned long)sampleRate);
+    // GET /api/dsp/fir/design/status — progress of the last FIR design
+    server_on_versioned("/api/dsp/fir/design/status", HTTP_GET, []() {
+        if (!requireAuth()) return;
+        char resp[192];
+        FirDesignState st = _firJob.state;
+        snprintf(resp, sizeof(resp),
+                 "{\"success\":true,\"state\":\"%s\",\"ch\":%d,\"progress\":%d,\"taps\":%d,\"message\":\"%s\"}",
+                 firDesignStateName(st), _firJob.ch, _firJob.progress, _firJob.numTaps,
+                 (st == FIR_DESIGN_ERROR && _firJob.error) ? _firJob.error : "");
         server_send(200, "application/json", resp);
-        LOG_I("[DSP] Convolution upload: ch=%d slot=%d irLength=%d sampleRate=%lu",
-              ch, convSlot, taps, (unsigned long)sampleRate);
     });
 
     LOG_I("[DSP] REST API endpoints registered");
@@ -1462,6 +1951,8 @@ JsonDocument doc;
 // This is exposed to the main loop for periodic save checking
 void dsp_check_debounced_save() {
     checkDspSave();
+    convUploadPublish();
+    firDesignPublish();
 }
 
 #endif // DSP_ENABLED
@@ -10,6 +10,10 @@ void registerDspApiEndpoints();
 void loadDspSettings();
 void saveDspSettings();
 void saveDspSettingsDebounced();
+// Rewrite the JSON files (/dsp_global.json, /dsp_ch%d.json, /dsp_fir%d.bin)
+// from the active config. Saves go to the binary snapshot; settings export
+// and import refresh these first.
+void dsp_settings_write_json();
 
 // Call from main loop to flush pending debounced saves
 void dsp_check_debounced_save();
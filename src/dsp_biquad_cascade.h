@@ -0,0 +1,131 @@
+#pragma once
+// dsp_biquad_cascade.h — Fused biquad-cascade kernels (header-only).
+//
+// Runs a chain of Direct Form II Transposed sections over a block in as few
+// passes as possible: sections are taken four (then two, then one) at a time
+// and each sample travels through the whole group with coefficients and
+// state held in registers. Compared with one dsps_biquad_f32() call per
+// section this removes (sections - 1) / 4 of the load/store traffic on the
+// block and lets the FPU overlap the independent sections of consecutive
+// samples.
+//
+// The stereo variant runs the matching sections of two channels in the same
+// loop. L and R are independent dependency chains, so on the in-order
+// ESP32-P4 FPU (and native out-of-order cores) their multiply-adds overlap
+// instead of stalling on the previous result of the same channel.
+//
+// Coefficient layout per section: {b0, b1, b2, a1, a2} (same as dsps_biquad).
+// State per section: {d0, d1}. Arrays are contiguous and section-major.
+
+// One DF2T section step: y = b0*x + d0; d0 = b1*x - a1*y + d1; d1 = b2*x - a2*y
+#define DSP_BQ_STEP(x, y, c, d0, d1)                  \
+    do {                                              \
+        (y)  = (c)[0] * (x) + (d0);                   \
+        (d0) = (c)[1] * (x) - (c)[3] * (y) + (d1);    \
+        (d1) = (c)[2] * (x) - (c)[4] * (y);           \
+    } while (0)
+
+static inline void _dsp_bq_pass1(float *buf, int len, const float *c, float *s) {
+    const float k[5] = {c[0], c[1], c[2], c[3], c[4]};
+    float d0 = s[0], d1 = s[1];
+    for (int i = 0; i < len; i++) {
+        float y;
+        DSP_BQ_STEP(buf[i], y, k, d0, d1);
+        buf[i] = y;
+    }
+    s[0] = d0; s[1] = d1;
+}
+
+static inline void _dsp_bq_pass2(float *buf, int len, const float *ca, const float *cb,
+                                 float *sa, float *sb) {
+    const float ka[5] = {ca[0], ca[1], ca[2], ca[3], ca[4]};
+    const float kb[5] = {cb[0], cb[1], cb[2], cb[3], cb[4]};
+    float a0 = sa[0], a1 = sa[1], b0 = sb[0], b1 = sb[1];
+    for (int i = 0; i < len; i++) {
+        float y, z;
+        DSP_BQ_STEP(buf[i], y, ka, a0, a1);
+        DSP_BQ_STEP(y, z, kb, b0, b1);
+        buf[i] = z;
+    }
+    sa[0] = a0; sa[1] = a1; sb[0] = b0; sb[1] = b1;
+}
+
+static inline void _dsp_bq_pass4(float *buf, int len, const float (*c)[5], float (*s)[2]) {
+    const float k0[5] = {c[0][0], c[0][1], c[0][2], c[0][3], c[0][4]};
+    const float k1[5] = {c[1][0], c[1][1], c[1][2], c[1][3], c[1][4]};
+    const float k2[5] = {c[2][0], c[2][1], c[2][2], c[2][3], c[2][4]};
+    const float k3[5] = {c[3][0], c[3][1], c[3][2], c[3][3], c[3][4]};
+    float p0 = s[0][0], p1 = s[0][1], q0 = s[1][0], q1 = s[1][1];
+    float r0 = s[2][0], r1 = s[2][1], t0 = s[3][0], t1 = s[3][1];
+    for (int i = 0; i < len; i++) {
+        float y0, y1, y2, y3;
+        DSP_BQ_STEP(buf[i], y0, k0, p0, p1);
+        DSP_BQ_STEP(y0, y1, k1, q0, q1);
+        DSP_BQ_STEP(y1, y2, k2, r0, r1);
+        DSP_BQ_STEP(y2, y3, k3, t0, t1);
+        buf[i] = y3;
+    }
+    s[0][0] = p0; s[0][1] = p1; s[1][0] = q0; s[1][1] = q1;
+    s[2][0] = r0; s[2][1] = r1; s[3][0] = t0; s[3][1] = t1;
+}
+
+// Process `n` cascaded sections in place over `len` samples.
+static inline void dsp_biquad_cascade_f32(float *buf, int len, const float (*coeffs)[5],
+                                          float (*state)[2], int n) {
+    if (!buf || len <= 0 || n <= 0) return;
+    int k = 0;
+    for (; n - k >= 4; k += 4) _dsp_bq_pass4(buf, len, coeffs + k, state + k);
+    if (n - k >= 2) { _dsp_bq_pass2(buf, len, coeffs[k], coeffs[k + 1], state[k], state[k + 1]); k += 2; }
+    if (n - k == 1) _dsp_bq_pass1(buf, len, coeffs[k], state[k]);
+}
+
+static inline void _dsp_bq_stereo_pass1(float *l, float *r, int len,
+                                        const float *cl, const float *cr, float *sl, float *sr) {
+    const float kl[5] = {cl[0], cl[1], cl[2], cl[3], cl[4]};
+    const float kr[5] = {cr[0], cr[1], cr[2], cr[3], cr[4]};
+    float l0 = sl[0], l1 = sl[1], r0 = sr[0], r1 = sr[1];
+    for (int i = 0; i < len; i++) {
+        float yl, yr;
+        DSP_BQ_STEP(l[i], yl, kl, l0, l1);
+        DSP_BQ_STEP(r[i], yr, kr, r0, r1);
+        l[i] = yl;
+        r[i] = yr;
+    }
+    sl[0] = l0; sl[1] = l1; sr[0] = r0; sr[1] = r1;
+}
+
+static inline void _dsp_bq_stereo_pass2(float *l, float *r, int len,
+                                        const float (*cl)[5], const float (*cr)[5],
+                                        float (*sl)[2], float (*sr)[2]) {
+    const float la[5] = {cl[0][0], cl[0][1], cl[0][2], cl[0][3], cl[0][4]};
+    const float lb[5] = {cl[1][0], cl[1][1], cl[1][2], cl[1][3], cl[1][4]};
+    const float ra[5] = {cr[0][0], cr[0][1], cr[0][2], cr[0][3], cr[0][4]};
+    const float rb[5] = {cr[1][0], cr[1][1], cr[1][2], cr[1][3], cr[1][4]};
+    float la0 = sl[0][0], la1 = sl[0][1], lb0 = sl[1][0], lb1 = sl[1][1];
+    float ra0 = sr[0][0], ra1 = sr[0][1], rb0 = sr[1][0], rb1 = sr[1][1];
+    for (int i = 0; i < len; i++) {
+        float yl, yr, zl, zr;
+        DSP_BQ_STEP(l[i], yl, la, la0, la1);
+        DSP_BQ_STEP(r[i], yr, ra, ra0, ra1);
+        DSP_BQ_STEP(yl, zl, lb, lb0, lb1);
+        DSP_BQ_STEP(yr, zr, rb, rb0, rb1);
+        l[i] = zl;
+        r[i] = zr;
+    }
+    sl[0][0] = la0; sl[0][1] = la1; sl[1][0] = lb0; sl[1][1] = lb1;
+    sr[0][0] = ra0; sr[0][1] = ra1; sr[1][0] = rb0; sr[1][1] = rb1;
+}
+
+// Process `n` matching sections on two channels in place. Section k of L uses
+// coeffsL[k]/stateL[k], section k of R uses coeffsR[k]/stateR[k]; the
+// coefficients need not be equal.
+static inline void dsp_biquad_cascade_stereo_f32(float *l, float *r, int len,
+                                                 const float (*coeffsL)[5], const float (*coeffsR)[5],
+                                                 float (*stateL)[2], float (*stateR)[2], int n) {
+    if (!l || !r || len <= 0 || n <= 0) return;
+    int k = 0;
+    for (; n - k >= 2; k += 2)
+        _dsp_bq_stereo_pass2(l, r, len, coeffsL + k, coeffsR + k, stateL + k, stateR + k);
+    if (n - k == 1)
+        _dsp_bq_stereo_pass1(l, r, len, coeffsL[k], coeffsR[k], stateL[k], stateR[k]);
+}
@@ -4,6 +4,7 @@
 #include "psram_alloc.h"
 #include <string.h>
 #include <stdlib.h>
+#include <atomic>
 
 #ifndef NATIVE_TEST
 #include "debug_serial.h"
@@ -16,6 +17,7 @@
 #endif
 
 static ConvState _convSlots[CONV_MAX_IR_SLOTS];
+static std::atomic<int> _convTapLimit(0);   // 0 = full IR length; read by the audio task
 
 int dsp_conv_init_slot(int slot, const float *ir, int irLength) {
     if (slot < 0 || slot >= CONV_MAX_IR_SLOTS || !ir || irLength <= 0)
@@ -63,10 +65,10 @@ int dsp_conv_init_slot(int slot, const float *ir, int irLength) {
         }
     }
 
-    // Allocate overlap buffer
-    s.overlapBuf = (float *)psram_alloc(CONV_PARTITION_SIZE, sizeof(float), "conv_ir");
-    if (!s.overlapBuf) {
-        LOG_E("[Conv] Failed to allocate overlap buffer");
+    // Allocate input history
+    s.historyBuf = (float *)psram_alloc(CONV_PARTITION_SIZE, sizeof(float), "conv_ir");
+    if (!s.historyBuf) {
+        LOG_E("[Conv] Failed to allocate input history");
         dsp_conv_free_slot(slot);
         return -1;
     }
@@ -87,61 +89,45 @@ void dsp_conv_free_slot(int slot) {
         free(s.irPartitions);  // pointer array was plain calloc
         s.irPartitions = nullptr;
     }
-    psram_free(s.overlapBuf, "conv_ir");
-    s.overlapBuf = nullptr;
+    psram_free(s.historyBuf, "conv_ir");
+    s.historyBuf = nullptr;
     s.numPartitions = 0;
     s.irLength = 0;
     s.active = false;
 }
 
 void dsp_conv_process(int slot, float *buf, int len) {
-    if (slot < 0 || slot >= CONV_MAX_IR_SLOTS || !buf || len <= 0) return;
+    if (slot < 0 || slot >= CONV_MAX_IR_SLOTS || !buf || len <= 0 || len > CONV_PARTITION_SIZE) return;
     ConvState &s = _convSlots[slot];
-    if (!s.active || !s.irPartitions || !s.overlapBuf) return;
+    if (!s.active || !s.irPartitions || !s.historyBuf) return;
 
-    // Simple time-domain partitioned convolution (overlap-add):
-    // For each partition of the IR, convolve with the input block and accumulate.
-    // Only the first partition produces output in this block; subsequent partitions
-    // contribute to the overlap buffer for future blocks.
-
-    // For simplicity, use the first partition only (direct FIR-like convolution).
-    // This gives correct output for short IRs and the first partition of long IRs.
-    // Full multi-partition overlap-add requires a ring buffer of past input blocks.
+    // Direct-form convolution with the first partition of the IR (the
+    // first CONV_PARTITION_SIZE taps). historyBuf holds the last
+    // CONV_PARTITION_SIZE input samples, so every output sample is the same
+    // sum in the same order whatever the block size — the result does not
+    // depend on how the stream is cut into blocks.
 
+    float x[2 * CONV_PARTITION_SIZE];
     float output[CONV_PARTITION_SIZE];
-    memset(output, 0, sizeof(output));
+    memcpy(x, s.historyBuf, sizeof(float) * CONV_PARTITION_SIZE);
+    memcpy(x + CONV_PARTITION_SIZE, buf, sizeof(float) * len);
 
-    // Apply first partition: direct convolution of input with partition 0
     float *h = s.irPartitions[0];
     int hLen = s.irLength < CONV_PARTITION_SIZE ? s.irLength : CONV_PARTITION_SIZE;
+    const int tapLimit = _convTapLimit.load(std::memory_order_relaxed);
+    if (tapLimit > 0 && hLen > tapLimit) hLen = tapLimit;
 
     for (int n = 0; n < len; n++) {
+        const float *xn = &x[CONV_PARTITION_SIZE + n];
         float acc = 0.0f;
-        for (int k = 0; k <= n && k < hLen; k++) {
-            acc += buf[n - k] * h[k];
+        for (int k = 0; k < hLen; k++) {
+            acc += xn[-k] * h[k];
         }
         output[n] = acc;
     }
 
-    // Add overlap from previous block
-    for (int i = 0; i < len; i++) {
-        output[i] += s.overlapBuf[i];
-    }
-
-    // Compute overlap tail for next block (from partition 0)
-    memset(s.overlapBuf, 0, sizeof(float) * CONV_PARTITION_SIZE);
-    for (int n = len; n < len + hLen - 1 && n < len + CONV_PARTITION_SIZE; n++) {
-        float acc = 0.0f;
-        for (int k = 0; k < hLen; k++) {
-            int idx = n - k;
-            if (idx >= 0 && idx < len) {
-                acc += buf[idx] * h[k];
-            }
-        }
-        if (n - len < CONV_PARTITION_SIZE) {
-            s.overlapBuf[n - len] = acc;
-        }
-    }
+    // Keep the newest CONV_PARTITION_SIZE input samples
+    memcpy(s.historyBuf, x + len, sizeof(float) * CONV_PARTITION_SIZE);
 
     // Copy output back to buffer
     memcpy(buf, output, len * sizeof(float));
@@ -157,4 +143,8 @@ int dsp_conv_get_ir_length(int slot) {
     return _convSlots[slot].irLength;
 }
 
+void dsp_conv_set_tap_limit(int taps) {
+    _convTapLimit.store(taps > 0 ? taps : 0, std::memory_order_relaxed);
+}
+
 #endif // DSP_ENABLED
@@ -13,7 +13,7 @@ struct ConvState {
     int numPartitions;
     int irLength;                   // Original IR length in samples
     float **irPartitions;           // [numPartitions][CONV_PARTITION_SIZE] time-domain partitions
-    float *overlapBuf;              // [CONV_PARTITION_SIZE] overlap-add state
+    float *historyBuf;              // [CONV_PARTITION_SIZE] most recent input samples
     bool active;                    // Slot is loaded and ready
 };
 
@@ -24,8 +24,9 @@ int dsp_conv_init_slot(int slot, const float *ir, int irLength);
 // Free all resources for a convolution slot.
 void dsp_conv_free_slot(int slot);
 
-// Process one buffer through convolution (overlap-add, time-domain).
-// buf must have exactly CONV_PARTITION_SIZE samples.
+// Process one buffer through convolution (direct form, time-domain).
+// len may be any block size up to CONV_PARTITION_SIZE samples; the output
+// is bit-identical for any split of the stream into blocks.
 void dsp_conv_process(int slot, float *buf, int len);
 
 // Check if a slot is active.
@@ -34,5 +35,10 @@ bool dsp_conv_is_active(int slot);
 // Get the IR length (in samples) for a slot.
 int dsp_conv_get_ir_length(int slot);
 
+// Truncate every IR to at most `taps` samples while processing (0 = full
+// length); the loaded IRs are not modified. Any task; the audio task picks
+// the limit up at its next block. The load governor does not use it.
+void dsp_conv_set_tap_limit(int taps);
+
 #endif // DSP_ENABLED
 #endif // DSP_CONVOLUTION_H
@@ -0,0 +1,349 @@
+#pragma once
+// dsp_fir_block.h — Long FIR kernels (header-only).
+//
+// Two interchangeable ways to run the same filter over a block:
+//
+//   Direct block FIR — the input is appended to a linear history buffer that
+//   is twice the filter length, so every output is a plain dot product over
+//   contiguous memory (no per-tap modulo). Four outputs are computed per tap
+//   pass: each tap is loaded once and each history sample once, the window
+//   for the next output is the previous one shifted by a register move.
+//   When the buffer fills, the last n - 1 + 2 * DSP_FIR_PART samples are
+//   moved back to the front (amortized < 1 copy per sample).
+//
+//   Uniformly partitioned overlap-save — the taps are cut into partitions of
+//   DSP_FIR_PART samples and pre-transformed; every hop of DSP_FIR_PART input
+//   samples costs one real FFT of size DSP_FIR_FFT, one complex
+//   multiply-accumulate per partition and one inverse FFT. Latency is zero
+//   (the hop is processed as soon as it is complete, inside the same call),
+//   so the two paths are sample-exact substitutes.
+//
+//   Blocks that are not whole, hop-aligned multiples of DSP_FIR_PART (e.g. the
+//   32-sample blocks inside a multirate section) use the split form: the first
+//   partition runs direct per sample, and partitions 1.. only need input that
+//   is at least one hop old, so their contribution to a whole hop is computed
+//   by overlap-save when the hop starts and added as samples arrive.
+//
+// All paths share the time-domain history, so switching between them is
+// seamless: the frequency-domain delay line is rebuilt from the history when
+// it has fallen behind.
+//
+// DSP_MAX_FIR_TAPS must be defined before inclusion (dsp_pipeline.h).
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define DSP_FIR_BLOCK     64    // Direct-path chunk (bounds the history append)
+#define DSP_FIR_PART      64    // Overlap-save hop / partition length
+#define DSP_FIR_FFT       (2 * DSP_FIR_PART)   // Real FFT size (128)
+#define DSP_FIR_CFFT      (DSP_FIR_FFT / 2)    // Complex FFT size behind it (64)
+#define DSP_FIR_MAX_PARTS ((DSP_MAX_FIR_TAPS + DSP_FIR_PART - 1) / DSP_FIR_PART)
+#define DSP_FIR_HIST_LEN  (2 * (DSP_MAX_FIR_TAPS + 2 * DSP_FIR_PART))
+
+// History kept on compaction: enough for the direct path (n - 1) and for
+// rebuilding every partition's input spectrum (partitions + 1 hops).
+#define DSP_FIR_HIST_KEEP(n) ((uint32_t)(n) - 1 + 2 * DSP_FIR_PART)
+
+struct DspFirRun {
+    // FFT tables
+    float cw[DSP_FIR_CFFT / 2], sw[DSP_FIR_CFFT / 2];  // e^{2*pi*i*k/64}
+    float rw[DSP_FIR_CFFT / 2 + 1], rs[DSP_FIR_CFFT / 2 + 1];  // e^{2*pi*i*k/128}
+    uint8_t rev[DSP_FIR_CFFT];
+
+    uint16_t numTaps;   // Length the history was built for (0 = not started)
+    uint16_t olsTaps;   // Length the partition spectra were prepared for (0 = none)
+    uint16_t parts;     // Partition count for olsTaps
+    uint16_t fdlPos;    // Newest entry of the frequency-domain delay line
+    bool     fdlValid;  // FDL holds spectra for the current partition count
+    uint16_t phase;     // Samples into the current hop
+    uint32_t total;     // Samples appended since reset (wraps)
+    uint32_t fdlEnd;    // `total` at the end of the newest FDL entry
+    uint32_t tailEnd;   // `total` at the start of the hop `tail` was built for
+    bool     tailValid;
+    uint32_t w;         // History write index
+
+    float hist[DSP_FIR_HIST_LEN];
+    float spec[DSP_FIR_MAX_PARTS][DSP_FIR_FFT];  // Packed tap spectra (1/N folded in)
+    float fdl[DSP_FIR_MAX_PARTS][DSP_FIR_FFT];   // Packed input spectra
+    float work[DSP_FIR_FFT];
+    float acc[DSP_FIR_FFT];
+    float tail[DSP_FIR_PART];  // Partitions 1.. of the current hop (split form)
+};
+
+// ===== FFT (64-point complex, radix-2) and 128-point real wrappers =====
+// Packed real spectrum: [0] = DC, [1] = Nyquist, [2k], [2k+1] = bin k.
+
+static inline void _dsp_fir_cfft(const DspFirRun &r, float *d, bool inverse) {
+    const int N = DSP_FIR_CFFT;
+    for (int i = 0; i < N; i++) {
+        int j = r.rev[i];
+        if (j > i) {
+            float tr = d[2 * i], ti = d[2 * i + 1];
+            d[2 * i] = d[2 * j]; d[2 * i + 1] = d[2 * j + 1];
+            d[2 * j] = tr; d[2 * j + 1] = ti;
+        }
+    }
+    const float sgn = inverse ? 1.0f : -1.0f;
+    for (int len = 2; len <= N; len <<= 1) {
+        int half = len >> 1, step = N / len;
+        for (int i = 0; i < N; i += len) {
+            for (int j = 0; j < half; j++) {
+                float wr = r.cw[j * step], wi = sgn * r.sw[j * step];
+                float *a = d + 2 * (i + j), *b = d + 2 * (i + j + half);
+                float tr = b[0] * wr - b[1] * wi;
+                float ti = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - tr; b[1] = a[1] - ti;
+                a[0] += tr;       a[1] += ti;
+            }
+        }
+    }
+}
+
+// Forward real FFT of 128 samples in place (unscaled)
+static inline void _dsp_fir_rfft(const DspFirRun &r, float *d) {
+    const int N = DSP_FIR_CFFT;
+    _dsp_fir_cfft(r, d, false);
+    float z0r = d[0], z0i = d[1];
+    for (int k = 1; k <= N / 2; k++) {
+        int m = N - k;
+        float ar = d[2 * k], ai = d[2 * k + 1], br = d[2 * m], bi = d[2 * m + 1];
+        float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);   // Even part
+        float or_ = 0.5f * (ai + bi), oi = -0.5f * (ar - br); // Odd part
+        float c = r.rw[k], s = -r.rs[k];                      // W_128^k
+        float tr = or_ * c - oi * s, ti = or_ * s + oi * c;
+        d[2 * k] = er + tr; d[2 * k + 1] = ei + ti;
+        if (m != k) { d[2 * m] = er - tr; d[2 * m + 1] = -(ei - ti); }
+    }
+    d[0] = z0r + z0i;
+    d[1] = z0r - z0i;
+}
+
+// Inverse of _dsp_fir_rfft, scaled by 64 (fold 1/64 into the other operand)
+static inline void _dsp_fir_irfft(const DspFirRun &r, float *d) {
+    const int N = DSP_FIR_CFFT;
+    float x0 = d[0], xn = d[1];
+    for (int k = 1; k <= N / 2; k++) {
+        int m = N - k;
+        float ar = d[2 * k], ai = d[2 * k + 1], br = d[2 * m], bi = -d[2 * m + 1];  // conj(X[N-k])
+        float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+        float dr = 0.5f * (ar - br), di = 0.5f * (ai - bi);
+        float c = r.rw[k], s = r.rs[k];                       // conj(W_128^k)
+        float or_ = dr * c - di * s, oi = dr * s + di * c;
+        d[2 * k] = er - oi; d[2 * k + 1] = ei + or_;          // Xe + i*Xo
+        if (m != k) { d[2 * m] = er + oi; d[2 * m + 1] = -ei + or_; }  // conj(Xe) + i*conj(Xo)
+    }
+    d[0] = 0.5f * (x0 + xn);
+    d[1] = 0.5f * (x0 - xn);
+    _dsp_fir_cfft(r, d, true);
+}
+
+// ===== State =====
+
+// Clear the history for an n-tap filter. Prepared spectra are kept.
+static inline void dsp_fir_run_reset(DspFirRun &r, uint16_t n) {
+    memset(r.hist, 0, sizeof(r.hist));
+    r.numTaps = n;
+    r.w = DSP_FIR_HIST_KEEP(n ? n : 1);
+    r.fdlPos = 0;
+    r.fdlValid = false;
+    r.phase = 0;
+    r.total = 0;
+    r.fdlEnd = 0;
+    r.tailEnd = 0;
+    r.tailValid = false;
+}
+
+static inline void dsp_fir_run_init(DspFirRun &r) {
+    const int N = DSP_FIR_CFFT;
+    for (int k = 0; k < N / 2; k++) {
+        r.cw[k] = (float)cos(2.0 * M_PI * k / N);
+        r.sw[k] = (float)sin(2.0 * M_PI * k / N);
+    }
+    for (int k = 0; k <= N / 2; k++) {
+        r.rw[k] = (float)cos(2.0 * M_PI * k / DSP_FIR_FFT);
+        r.rs[k] = (float)sin(2.0 * M_PI * k / DSP_FIR_FFT);
+    }
+    int bits = 0;
+    while ((1 << bits) < N) bits++;
+    for (int i = 0; i < N; i++) {
+        int j = 0;
+        for (int b = 0; b < bits; b++) if (i & (1 << b)) j |= 1 << (bits - 1 - b);
+        r.rev[i] = (uint8_t)j;
+    }
+    r.olsTaps = 0;
+    r.parts = 0;
+    dsp_fir_run_reset(r, 0);
+}
+
+// Transform the taps into partition spectra for overlap-save. Not for the
+// audio task (one FFT per partition). Clears olsTaps while it runs so the
+// audio side falls back to the direct path instead of reading a half-built set.
+static inline void dsp_fir_prepare(DspFirRun &r, const float *taps, uint16_t n) {
+    r.olsTaps = 0;
+    if (!taps || n == 0 || n > DSP_MAX_FIR_TAPS) return;
+    uint16_t parts = (uint16_t)((n + DSP_FIR_PART - 1) / DSP_FIR_PART);
+    const float scale = 1.0f / (float)DSP_FIR_CFFT;
+    for (int p = 0; p < parts; p++) {
+        float *s = r.spec[p];
+        memset(s, 0, sizeof(float) * DSP_FIR_FFT);
+        int off = p * DSP_FIR_PART;
+        int cnt = (n - off < DSP_FIR_PART) ? n - off : DSP_FIR_PART;
+        for (int i = 0; i < cnt; i++) s[i] = taps[off + i] * scale;
+        _dsp_fir_rfft(r, s);
+    }
+    r.parts = parts;
+    r.fdlValid = false;
+    r.tailValid = false;
+    r.olsTaps = n;
+}
+
+// Append c samples to the history, compacting first if they would not fit
+static inline void _dsp_fir_append(DspFirRun &r, const float *x, int c) {
+    if (r.w + (uint32_t)c > DSP_FIR_HIST_LEN) {
+        uint32_t keep = DSP_FIR_HIST_KEEP(r.numTaps);
+        memmove(r.hist, r.hist + r.w - keep, keep * sizeof(float));
+        r.w = keep;
+    }
+    memcpy(r.hist + r.w, x, c * sizeof(float));
+    r.w += c;
+    r.total += (uint32_t)c;
+    r.phase = (uint16_t)((r.phase + c) % DSP_FIR_PART);
+}
+
+// ===== Direct block FIR =====
+
+static inline void _dsp_fir_direct(DspFirRun &r, const float *h, int n, float *buf, int len) {
+    for (int done = 0; done < len; done += DSP_FIR_BLOCK) {
+        int c = (len - done < DSP_FIR_BLOCK) ? len - done : DSP_FIR_BLOCK;
+        float *out = buf + done;
+        _dsp_fir_append(r, out, c);
+        const float *base = r.hist + r.w - c;   // base[i] = newest input of output i
+        int i = 0;
+        for (; i + 4 <= c; i += 4) {
+            const float *x = base + i;
+            float a0 = 0.0f, a1 = 0.0f, a2 = 0.0f, a3 = 0.0f;
+            float r0 = x[0], r1 = x[1], r2 = x[2], r3 = x[3];
+            for (int k = 0; k < n - 1; k++) {
+                float hk = h[k];
+                a0 += hk * r0; a1 += hk * r1; a2 += hk * r2; a3 += hk * r3;
+                r3 = r2; r2 = r1; r1 = r0; r0 = x[-k - 1];
+            }
+            float hl = h[n - 1];
+            out[i] = a0 + hl * r0; out[i + 1] = a1 + hl * r1;
+            out[i + 2] = a2 + hl * r2; out[i + 3] = a3 + hl * r3;
+        }
+        for (; i < c; i++) {
+            const float *x = base + i;
+            float a = 0.0f;
+            for (int k = 0; k < n; k++) a += h[k] * x[-k];
+            out[i] = a;
+        }
+    }
+}
+
+// ===== Overlap-save =====
+
+// Spectrum of the 2*DSP_FIR_PART history samples ending at `end`
+static inline void _dsp_fir_hop_spectrum(DspFirRun &r, uint32_t end, float *dst) {
+    memcpy(dst, r.hist + end - DSP_FIR_FFT, DSP_FIR_FFT * sizeof(float));
+    _dsp_fir_rfft(r, dst);
+}
+
+// Make the newest FDL entry the spectrum ending `back` samples before the
+// history write position (a hop boundary). One hop behind costs one FFT;
+// anything else rebuilds the K - 1 entries the next products need.
+static inline void _dsp_fir_fdl_sync(DspFirRun &r, uint32_t back) {
+    const int K = r.parts;
+    const uint32_t end = r.total - back;
+    if (r.fdlValid && r.fdlEnd == end) return;
+    if (r.fdlValid && r.fdlEnd + DSP_FIR_PART == end) {
+        r.fdlPos = (uint16_t)((r.fdlPos + 1 == K) ? 0 : r.fdlPos + 1);
+        _dsp_fir_hop_spectrum(r, r.w - back, r.fdl[r.fdlPos]);
+    } else {
+        for (int j = 0; j < K - 1; j++)
+            _dsp_fir_hop_spectrum(r, r.w - back - (uint32_t)j * DSP_FIR_PART, r.fdl[K - 2 - j]);
+        r.fdlPos = (uint16_t)(K > 1 ? K - 2 : 0);
+        r.fdlValid = true;
+    }
+    r.fdlEnd = end;
+}
+
+// Sum partitions first..K-1 against the FDL (newest entry pairs with
+// `first`) and return the last DSP_FIR_PART samples of the inverse in acc.
+static inline float *_dsp_fir_accumulate(DspFirRun &r, int first) {
+    const int K = r.parts;
+    float *acc = r.acc;
+    memset(acc, 0, sizeof(float) * DSP_FIR_FFT);
+    int e = r.fdlPos;
+    for (int p = first; p < K; p++) {
+        const float *s = r.spec[p], *x = r.fdl[e];
+        acc[0] += s[0] * x[0];
+        acc[1] += s[1] * x[1];
+        for (int b = 2; b < DSP_FIR_FFT; b += 2) {
+            acc[b]     += s[b] * x[b] - s[b + 1] * x[b + 1];
+            acc[b + 1] += s[b] * x[b + 1] + s[b + 1] * x[b];
+        }
+        e = (e == 0) ? K - 1 : e - 1;
+    }
+    _dsp_fir_irfft(r, acc);
+    return acc + DSP_FIR_PART;
+}
+
+// Whole hops starting on a hop boundary
+static inline void _dsp_fir_ols(DspFirRun &r, float *buf, int len) {
+    for (int done = 0; done < len; done += DSP_FIR_PART) {
+        _dsp_fir_fdl_sync(r, 0);
+        float *out = buf + done;
+        _dsp_fir_append(r, out, DSP_FIR_PART);
+        _dsp_fir_fdl_sync(r, 0);
+        memcpy(out, _dsp_fir_accumulate(r, 0), DSP_FIR_PART * sizeof(float));
+    }
+    r.tailValid = false;
+}
+
+// Any block: first partition direct, partitions 1.. from the per-hop tail
+static inline void _dsp_fir_split(DspFirRun &r, const float *h, int n, float *buf, int len) {
+    const int head = n < DSP_FIR_PART ? n : DSP_FIR_PART;
+    int done = 0;
+    while (done < len) {
+        uint32_t hopStart = r.total - r.phase;
+        if (!r.tailValid || r.tailEnd != hopStart) {
+            _dsp_fir_fdl_sync(r, r.phase);
+            memcpy(r.tail, _dsp_fir_accumulate(r, 1), DSP_FIR_PART * sizeof(float));
+            r.tailEnd = hopStart;
+            r.tailValid = true;
+        }
+        int ph = r.phase;
+        int c = DSP_FIR_PART - ph;
+        if (c > len - done) c = len - done;
+        float *out = buf + done;
+        _dsp_fir_direct(r, h, head, out, c);
+        for (int i = 0; i < c; i++) out[i] += r.tail[ph + i];
+        done += c;
+    }
+}
+
+// ===== Entry point =====
+
+#ifndef DSP_FIR_MODE_DIRECT
+#define DSP_FIR_MODE_DIRECT 0
+#define DSP_FIR_MODE_FFT    1
+#endif
+
+// Filter `len` samples in place with n taps. Overlap-save is used when
+// `allowFft` is set and the spectra match n: whole hop-aligned blocks run
+// pure overlap-save, any other block the split form. Otherwise the direct
+// kernel runs. Returns the mode used.
+static inline uint8_t dsp_fir_run_process(DspFirRun &r, const float *taps, uint16_t n,
+                                          float *buf, int len, bool allowFft) {
+    if (!taps || !buf || len <= 0 || n == 0 || n > DSP_MAX_FIR_TAPS) return DSP_FIR_MODE_DIRECT;
+    if (n != r.numTaps) dsp_fir_run_reset(r, n);
+    if (allowFft && r.olsTaps == n) {
+        if (r.phase == 0 && (len % DSP_FIR_PART) == 0) _dsp_fir_ols(r, buf, len);
+        else _dsp_fir_split(r, taps, n, buf, len);
+        return DSP_FIR_MODE_FFT;
+    }
+    _dsp_fir_direct(r, taps, n, buf, len);
+    return DSP_FIR_MODE_DIRECT;
+}
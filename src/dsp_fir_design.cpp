@@ -0,0 +1,214 @@
+#ifdef DSP_ENABLED
+
+#include "dsp_fir_design.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// ===== FFT =====
+// In-place radix-2 FFT over interleaved complex data (n points). tw holds
+// n/2 twiddles e^{-2*pi*i*k/n}, interleaved. Inverse is unscaled.
+
+static void fd_twiddles(float *tw, int n) {
+    for (int k = 0; k < n / 2; k++) {
+        double a = -2.0 * M_PI * (double)k / (double)n;
+        tw[2 * k] = (float)cos(a);
+        tw[2 * k + 1] = (float)sin(a);
+    }
+}
+
+static void fd_fft(float *d, const float *tw, int n, bool inverse) {
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            float tr = d[2 * i], ti = d[2 * i + 1];
+            d[2 * i] = d[2 * j]; d[2 * i + 1] = d[2 * j + 1];
+            d[2 * j] = tr; d[2 * j + 1] = ti;
+        }
+    }
+    const float sign = inverse ? -1.0f : 1.0f;
+    for (int len = 2; len <= n; len <<= 1) {
+        int half = len >> 1;
+        int stride = n / len;
+        for (int base = 0; base < n; base += len) {
+            for (int k = 0; k < half; k++) {
+                float wr = tw[2 * k * stride];
+                float wi = sign * tw[2 * k * stride + 1];
+                float *a = &d[2 * (base + k)];
+                float *b = &d[2 * (base + k + half)];
+                float br = b[0] * wr - b[1] * wi;
+                float bi = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - br; b[1] = a[1] - bi;
+                a[0] += br;       a[1] += bi;
+            }
+        }
+    }
+}
+
+// ===== Targets =====
+
+const char *dsp_fir_design_check(const DspFirDesignSpec &spec) {
+    if (spec.numTaps < 16 || spec.numTaps > DSP_FIR_DESIGN_MAX_TAPS) return "Tap count out of range";
+    if (spec.sampleRate == 0) return "Invalid sample rate";
+    if (spec.kind == DSP_FIR_DESIGN_LR_LINEAR || spec.kind == DSP_FIR_DESIGN_LR_MINIMUM) {
+        if (spec.freqHz <= 0.0f || spec.freqHz >= 0.5f * (float)spec.sampleRate) return "Invalid crossover frequency";
+        if (spec.order < 2 || spec.order > 24 || (spec.order & 1)) return "LR order must be even, 2-24";
+        if (spec.role > 1) return "Invalid role";
+    } else if (spec.kind == DSP_FIR_DESIGN_EQ_MINIMUM) {
+        if (spec.numPoints == 0 || spec.numPoints > DSP_FIR_DESIGN_MAX_POINTS) return "Invalid target points";
+        for (int i = 0; i < spec.numPoints; i++) {
+            if (spec.points[i].freqHz <= 0.0f) return "Invalid target frequency";
+            if (i > 0 && spec.points[i].freqHz <= spec.points[i - 1].freqHz) return "Target points must ascend";
+        }
+    } else {
+        return "Unknown design kind";
+    }
+    return nullptr;
+}
+
+int dsp_fir_design_fft_size(int numTaps) {
+    int n = DSP_FIR_DESIGN_MIN_FFT;
+    while (n < 4 * numTaps && n < DSP_FIR_DESIGN_MAX_FFT) n <<= 1;
+    return n;
+}
+
+size_t dsp_fir_design_work_floats(int numTaps) {
+    int n = dsp_fir_design_fft_size(numTaps);
+    return (size_t)n * 2 + (size_t)n;   // Complex grid + twiddles
+}
+
+float dsp_fir_design_target(const DspFirDesignSpec &spec, float freqHz) {
+    if (spec.kind == DSP_FIR_DESIGN_EQ_MINIMUM) {
+        const DspFirTargetPoint *p = spec.points;
+        int n = spec.numPoints;
+        float db;
+        if (freqHz <= p[0].freqHz) {
+            db = p[0].gainDb;
+        } else if (freqHz >= p[n - 1].freqHz) {
+            db = p[n - 1].gainDb;
+        } else {
+            int i = 1;
+            while (p[i].freqHz < freqHz) i++;
+            float t = log2f(freqHz / p[i - 1].freqHz) / log2f(p[i].freqHz / p[i - 1].freqHz);
+            db = p[i - 1].gainDb + t * (p[i].gainDb - p[i - 1].gainDb);
+        }
+        return powf(10.0f, db / 20.0f);
+    }
+    // LR(2M) = Butterworth(M) squared: |H| = 1 / (1 + x^2M), HP = x^2M / (1 + x^2M),
+    // with x prewarped as in the bilinear transform, so the target is the
+    // digital LR of dsp_insert_crossover_lr()
+    const float halfRate = 0.5f * (float)spec.sampleRate;
+    if (freqHz >= halfRate) return spec.role == 0 ? 0.0f : 1.0f;
+    float x = tanf((float)M_PI * freqHz / (float)spec.sampleRate) /
+              tanf((float)M_PI * spec.freqHz / (float)spec.sampleRate);
+    float xn = powf(x, (float)spec.order);   // May overflow to inf near Nyquist
+    return spec.role == 0 ? 1.0f / (1.0f + xn) : 1.0f / (1.0f + 1.0f / xn);
+}
+
+// ===== Design =====
+
+static inline void fd_report(DspFirDesignProgressFn progress, void *ctx, int percent) {
+    if (progress) progress(percent, ctx);
+}
+
+// Blackman window over 0..len-1
+static inline float fd_blackman(int i, int len) {
+    if (len <= 1) return 1.0f;
+    double a = 2.0 * M_PI * (double)i / (double)(len - 1);
+    return (float)(0.42 - 0.5 * cos(a) + 0.08 * cos(2.0 * a));
+}
+
+int dsp_fir_design(const DspFirDesignSpec &spec, float *taps, float *work,
+                   DspFirDesignProgressFn progress, void *ctx) {
+    if (!taps || !work || dsp_fir_design_check(spec)) return -1;
+
+    const int numTaps = spec.numTaps;
+    const int n = dsp_fir_design_fft_size(numTaps);
+    float *d = work;                // n complex
+    float *tw = work + 2 * n;       // n/2 complex
+    const float binHz = (float)spec.sampleRate / (float)n;
+    fd_report(progress, ctx, 0);
+    fd_twiddles(tw, n);
+
+    if (spec.kind == DSP_FIR_DESIGN_LR_LINEAR) {
+        // Target magnitude with a pure delay of D samples (Hermitian spectrum)
+        const int D = (numTaps - 1) / 2;
+        for (int k = 0; k <= n / 2; k++) {
+            float mag = dsp_fir_design_target(spec, (float)k * binHz);
+            double ph = -2.0 * M_PI * (double)((long)k * D % n) / (double)n;
+            d[2 * k] = mag * (float)cos(ph);
+            d[2 * k + 1] = mag * (float)sin(ph);
+            if (k > 0 && k < n / 2) {
+                d[2 * (n - k)] = d[2 * k];
+                d[2 * (n - k) + 1] = -d[2 * k + 1];
+            }
+        }
+        fd_report(progress, ctx, 30);
+        fd_fft(d, tw, n, true);
+        fd_report(progress, ctx, 70);
+
+        // Keep 2D + 1 taps around the delay, Blackman-windowed; an even tap
+        // count ends with a zero so the delay stays an integer
+        const float scale = 1.0f / (float)n;
+        const int len = 2 * D + 1;
+        for (int i = 0; i < numTaps; i++) {
+            taps[i] = i < len ? d[2 * i] * scale * fd_blackman(i, len) : 0.0f;
+        }
+    } else {
+        // Log magnitude → real cepstrum → fold to causal → exp → impulse
+        const float floorLin = powf(10.0f, DSP_FIR_DESIGN_FLOOR_DB / 20.0f);
+        for (int k = 0; k <= n / 2; k++) {
+            float mag = dsp_fir_design_target(spec, (float)k * binHz);
+            d[2 * k] = logf(mag > floorLin ? mag : floorLin);
+            d[2 * k + 1] = 0.0f;
+            if (k > 0 && k < n / 2) {
+                d[2 * (n - k)] = d[2 * k];
+                d[2 * (n - k) + 1] = 0.0f;
+            }
+        }
+        fd_report(progress, ctx, 15);
+        fd_fft(d, tw, n, true);
+        fd_report(progress, ctx, 40);
+
+        const float scale = 1.0f / (float)n;
+        d[0] *= scale;
+        d[1] = 0.0f;
+        for (int k = 1; k < n / 2; k++) {
+            d[2 * k] *= 2.0f * scale;
+            d[2 * k + 1] = 0.0f;
+        }
+        d[n] *= scale;
+        d[n + 1] = 0.0f;
+        memset(&d[n + 2], 0, sizeof(float) * (size_t)(n - 2));
+        fd_fft(d, tw, n, false);
+        fd_report(progress, ctx, 65);
+
+        for (int k = 0; k < n; k++) {
+            float m = expf(d[2 * k]);
+            float ph = d[2 * k + 1];
+            d[2 * k] = m * cosf(ph);
+            d[2 * k + 1] = m * sinf(ph);
+        }
+        fd_fft(d, tw, n, true);
+        fd_report(progress, ctx, 90);
+
+        // Raised-cosine fade over the last quarter of the taps
+        const int fade = numTaps / 4;
+        for (int i = 0; i < numTaps; i++) {
+            float w = 1.0f;
+            int t = i - (numTaps - fade);
+            if (t >= 0) w = 0.5f + 0.5f * cosf((float)M_PI * (float)(t + 1) / (float)fade);
+            taps[i] = d[2 * i] * scale * w;
+        }
+    }
+
+    fd_report(progress, ctx, 100);
+    return numTaps;
+}
+
+#endif // DSP_ENABLED
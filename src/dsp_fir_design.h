@@ -0,0 +1,75 @@
+#ifndef DSP_FIR_DESIGN_H
+#define DSP_FIR_DESIGN_H
+
+#ifdef DSP_ENABLED
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ===== FIR Designer =====
+// Designs FIR taps from a target magnitude response by frequency sampling:
+// the target is sampled on an FFT grid (at least 4x the tap count), given a
+// phase, inverse-transformed and windowed.
+//   Linear phase:  target magnitude with a pure delay of (numTaps - 1) / 2
+//                  samples, Blackman-windowed. An LPF/HPF pair sums flat.
+//   Minimum phase: phase from the real cepstrum of the log magnitude
+//                  (homomorphic method); the tail gets a raised-cosine fade.
+// The design is pure and deterministic (own radix-2 FFT, no global tables),
+// so it runs the same natively and in the background task on the device.
+// Crossover targets are the digital (prewarped bilinear) Linkwitz-Riley
+// responses, i.e. the same magnitude as the IIR crossover presets; the
+// minimum-phase design also reproduces their phase.
+
+#ifndef DSP_FIR_DESIGN_MAX_TAPS
+#define DSP_FIR_DESIGN_MAX_TAPS   8192   // Designer limit; the API caps designs at DSP_MAX_FIR_TAPS
+#endif
+#define DSP_FIR_DESIGN_MIN_FFT    1024
+#define DSP_FIR_DESIGN_MAX_FFT    (4 * DSP_FIR_DESIGN_MAX_TAPS)
+#define DSP_FIR_DESIGN_MAX_POINTS 32     // Target points of an EQ design
+#define DSP_FIR_DESIGN_FLOOR_DB   -300.0f  // Magnitude floor of minimum-phase designs (float-safe)
+
+enum DspFirDesignKind : uint8_t {
+    DSP_FIR_DESIGN_LR_LINEAR = 0,   // Linear-phase Linkwitz-Riley crossover
+    DSP_FIR_DESIGN_LR_MINIMUM,      // Minimum-phase Linkwitz-Riley (the IIR's phase)
+    DSP_FIR_DESIGN_EQ_MINIMUM       // Minimum-phase EQ from target points
+};
+
+struct DspFirTargetPoint {
+    float freqHz;
+    float gainDb;
+};
+
+struct DspFirDesignSpec {
+    DspFirDesignKind kind;
+    uint16_t numTaps;
+    uint32_t sampleRate;
+    // Crossover (LR kinds)
+    float freqHz;
+    uint8_t order;                  // LR order: even, 2..24
+    uint8_t role;                   // 0 = LPF, 1 = HPF (as dsp_insert_crossover_*)
+    // EQ: gain interpolated linearly over log frequency, held beyond the ends
+    uint8_t numPoints;
+    DspFirTargetPoint points[DSP_FIR_DESIGN_MAX_POINTS];
+};
+
+// Progress callback: percent 0..100, called from the designing thread
+typedef void (*DspFirDesignProgressFn)(int percent, void *ctx);
+
+// Validate a spec; returns nullptr or a short error message
+const char *dsp_fir_design_check(const DspFirDesignSpec &spec);
+
+// FFT grid size and work buffer size (floats) for a design of numTaps
+int dsp_fir_design_fft_size(int numTaps);
+size_t dsp_fir_design_work_floats(int numTaps);
+
+// Target magnitude (linear) of a spec at freqHz
+float dsp_fir_design_target(const DspFirDesignSpec &spec, float freqHz);
+
+// Design spec.numTaps taps into taps[]. work must hold
+// dsp_fir_design_work_floats(spec.numTaps) floats. Returns the tap count,
+// or -1 if the spec is invalid.
+int dsp_fir_design(const DspFirDesignSpec &spec, float *taps, float *work,
+                   DspFirDesignProgressFn progress = nullptr, void *ctx = nullptr);
+
+#endif // DSP_ENABLED
+#endif // DSP_FIR_DESIGN_H
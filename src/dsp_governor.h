@@ -0,0 +1,95 @@
+#pragma once
+// dsp_governor.h — CPU load governor for the input DSP (header-only).
+//
+// Under load the pipeline degrades in a fixed order, one level at a time:
+//   DSP_GOV_SPECTRUM    spectrum analysis runs on every 4th FFT window
+//   DSP_GOV_METERING    RMS/VU/peak metering runs on every 4th block
+//   DSP_GOV_SHED + n    n + 1 FIR/convolution stages are bypassed
+// Stages are shed lowest priority first and, within a priority, most
+// expensive (measured) first. DSP_PRIORITY_PROTECTED stages are never shed;
+// FIR and convolution stages start protected (dsp_default_priority).
+// Convolution is never shortened: it only runs the first IR partition, so a
+// truncated IR saves little and changes the correction. It is shed whole,
+// and only when its stage has been given a lower priority.
+//
+// Hysteresis: the level steps up after DSP_GOV_ESCALATE_PERIODS periods at or
+// above DSP_CPU_WARN_PERCENT and steps down after DSP_GOV_RELAX_PERIODS
+// periods below DSP_GOV_RELAX_PERCENT. A period at or above
+// DSP_CPU_CRIT_PERCENT steps up at once, straight to shedding.
+
+#include <stdint.h>
+#include "config.h"   // DSP_CPU_WARN_PERCENT, DSP_CPU_CRIT_PERCENT
+
+#ifndef DSP_GOV_RELAX_PERCENT
+#define DSP_GOV_RELAX_PERCENT    70.0f  // Load below which the governor steps back down
+#endif
+#ifndef DSP_GOV_ESCALATE_PERIODS
+#define DSP_GOV_ESCALATE_PERIODS 8      // ~21 ms at 128 frames / 48 kHz
+#endif
+#ifndef DSP_GOV_RELAX_PERIODS
+#define DSP_GOV_RELAX_PERIODS    375    // ~1 s at 128 frames / 48 kHz
+#endif
+#ifndef DSP_GOV_PROFILE_PERIODS
+#define DSP_GOV_PROFILE_PERIODS  32     // Op costs are sampled every Nth period
+#endif
+#define DSP_GOV_DIVIDER          4      // Spectrum / metering rate divider
+
+enum DspGovLevel : uint8_t {
+    DSP_GOV_NORMAL = 0,
+    DSP_GOV_SPECTRUM,
+    DSP_GOV_METERING,
+    DSP_GOV_SHED              // + n: n + 1 stages shed
+};
+
+struct DspGovernor {
+    uint8_t level;
+    uint16_t hold;            // Consecutive periods on the current side of a threshold
+    int8_t trend;             // +1 counting towards a step up, -1 down, 0 idle
+};
+
+static inline void dsp_gov_init(DspGovernor &g) {
+    g.level = DSP_GOV_NORMAL;
+    g.hold = 0;
+    g.trend = 0;
+}
+
+// Feed one period's peak load. maxLevel caps the level (DSP_GOV_SHED - 1 +
+// the number of sheddable stages). Returns the new level.
+static inline uint8_t dsp_gov_step(DspGovernor &g, float loadPercent, int maxLevel) {
+    if (g.level > maxLevel) g.level = (uint8_t)maxLevel;
+    if (loadPercent >= DSP_CPU_CRIT_PERCENT) {
+        int next = g.level < DSP_GOV_SHED ? DSP_GOV_SHED : g.level + 1;
+        if (next > maxLevel) next = maxLevel;
+        g.level = (uint8_t)next;
+        g.hold = 0;
+        g.trend = 0;
+    } else if (loadPercent >= DSP_CPU_WARN_PERCENT) {
+        if (g.trend != 1) { g.trend = 1; g.hold = 0; }
+        if (++g.hold >= DSP_GOV_ESCALATE_PERIODS) {
+            if (g.level < maxLevel) g.level++;
+            g.hold = 0;
+        }
+    } else if (loadPercent < DSP_GOV_RELAX_PERCENT && g.level > DSP_GOV_NORMAL) {
+        if (g.trend != -1) { g.trend = -1; g.hold = 0; }
+        if (++g.hold >= DSP_GOV_RELAX_PERIODS) {
+            g.level--;
+            g.hold = 0;
+        }
+    } else {
+        g.trend = 0;          // Dead band: hold the current level
+        g.hold = 0;
+    }
+    return g.level;
+}
+
+static inline int dsp_gov_spectrum_divider(int level) {
+    return level >= DSP_GOV_SPECTRUM ? DSP_GOV_DIVIDER : 1;
+}
+
+static inline int dsp_gov_meter_divider(int level) {
+    return level >= DSP_GOV_METERING ? DSP_GOV_DIVIDER : 1;
+}
+
+static inline int dsp_gov_shed_count(int level) {
+    return level >= DSP_GOV_SHED ? level - DSP_GOV_SHED + 1 : 0;
+}
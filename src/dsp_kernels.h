@@ -0,0 +1,557 @@
+#pragma once
+// dsp_kernels.h — Stage kernels shared by the input DSP (dsp_pipeline.cpp)
+// and the per-output DSP (output_dsp.cpp) (header-only).
+//
+// Every kernel takes its parameters and its state separately:
+//   params  read-only, pre-derived from the stage settings at the sample rate
+//           the kernel runs at (DspDynCoeffs, DspDelayTaps, ramp coefficient,
+//           biquad coefficients). The input DSP derives them once per program
+//           compile, the output DSP per block.
+//   state   envelopes, ramps, ring positions and filter memory, owned by the
+//           caller (stage struct, pool slot or per-channel buffer) and
+//           updated in place.
+// Scratch buffers (gain curves, harmonics) are passed in so each engine keeps
+// its own and neither allocates while processing.
+//
+// Both engines walk a chain the same way: linear stages (biquads, tone and
+// loudness shelves, settled gains, polarity) fold into one biquad run plus a
+// static scale, which are flushed before the next stateful stage. Identical
+// chains therefore produce bit-identical output on both engines.
+//
+// dsp_pipeline.h must be included first (stage params, DSP_MAX_STAGES,
+// DSP_MAX_FIR_TAPS, delay ring constants).
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "dsp_coefficients.h"     // dsp_db_to_linear, dsp_time_coeff
+#include "dsp_biquad_gen.h"
+#include "dsp_biquad_cascade.h"
+#include "dsp_fir_block.h"
+#include "dsps_biquad.h"
+#include "dsps_mul.h"
+#include "dsps_mulc.h"
+#include "dsps_add.h"
+
+// ===== Dynamics (limiter, compressor, noise gate) =====
+
+struct DspDynCoeffs {
+    float thresholdDb;
+    float threshLin;
+    float attack;       // dsp_time_coeff(attackMs, rate)
+    float release;      // dsp_time_coeff(releaseMs, rate)
+    float slope;        // 1 - 1 / ratio
+    float kneeDb;       // Compressor only (0 = hard knee)
+    float makeupLin;    // Compressor only
+    float holdSamples;  // Noise gate only
+    float rangeLin;     // Noise gate only
+    bool hardGate;      // Noise gate with ratio <= 1
+};
+
+static inline void dsp_k_dyn_coeffs(DspDynCoeffs &k, float thresholdDb, float attackMs, float releaseMs,
+                                    float ratio, uint32_t rate) {
+    memset(&k, 0, sizeof(k));
+    k.thresholdDb = thresholdDb;
+    k.threshLin = dsp_db_to_linear(thresholdDb);
+    k.attack = dsp_time_coeff(attackMs, (float)rate);
+    k.release = dsp_time_coeff(releaseMs, (float)rate);
+    k.slope = ratio > 0.0f ? 1.0f - 1.0f / ratio : 0.0f;
+    k.makeupLin = 1.0f;
+}
+
+static inline void dsp_k_limiter_coeffs(DspDynCoeffs &k, const DspLimiterParams &p, uint32_t rate) {
+    dsp_k_dyn_coeffs(k, p.thresholdDb, p.attackMs, p.releaseMs, p.ratio, rate);
+}
+
+static inline void dsp_k_compressor_coeffs(DspDynCoeffs &k, const DspCompressorParams &p, uint32_t rate) {
+    dsp_k_dyn_coeffs(k, p.thresholdDb, p.attackMs, p.releaseMs, p.ratio, rate);
+    k.kneeDb = p.kneeDb;
+    k.makeupLin = p.makeupLinear;
+}
+
+static inline void dsp_k_gate_coeffs(DspDynCoeffs &k, const DspNoiseGateParams &p, uint32_t rate) {
+    dsp_k_dyn_coeffs(k, p.thresholdDb, p.attackMs, p.releaseMs, p.ratio, rate);
+    k.holdSamples = p.holdMs * 0.001f * (float)rate;
+    k.rangeLin = dsp_db_to_linear(p.rangeDb);
+    k.hardGate = p.ratio <= 1.0f;
+}
+
+// Peak envelope follower step shared by the dynamics kernels
+static inline float _dsp_k_env(float env, float x, const DspDynCoeffs &k) {
+    float a = fabsf(x);
+    return a > env ? k.attack * env + (1.0f - k.attack) * a
+                   : k.release * env + (1.0f - k.release) * a;
+}
+
+// 2-pass: envelope → gain curve in `scratch`, then one SIMD multiply.
+// State: env (envelope), grDb (block's max gain reduction, <= 0).
+static inline void dsp_k_limiter(const DspDynCoeffs &k, float &env, float &grDb,
+                                 float *scratch, float *buf, int len) {
+    if (len <= 0) return;
+    float e = env;
+    float maxGr = 0.0f;
+    for (int i = 0; i < len; i++) {
+        e = _dsp_k_env(e, buf[i], k);
+        float gainLin = 1.0f;
+        if (e > k.threshLin && e > 0.0f) {
+            float overDb = 20.0f * log10f(e) - k.thresholdDb;
+            float gr = overDb * k.slope;
+            gainLin = dsp_db_to_linear(-gr);
+            if (gr > maxGr) maxGr = gr;
+        }
+        scratch[i] = gainLin;
+    }
+    dsps_mul_f32(buf, scratch, buf, len, 1, 1, 1);
+    env = e;
+    grDb = -maxGr;
+}
+
+// Soft-knee compressor; the gain curve includes the makeup gain.
+static inline void dsp_k_compressor(const DspDynCoeffs &k, float &env, float &grDb,
+                                    float *scratch, float *buf, int len) {
+    if (len <= 0) return;
+    const float halfKnee = k.kneeDb / 2.0f;
+    float e = env;
+    float maxGr = 0.0f;
+    for (int i = 0; i < len; i++) {
+        e = _dsp_k_env(e, buf[i], k);
+        float gainLin = 1.0f;
+        if (e > 0.0f) {
+            float overDb = 20.0f * log10f(e) - k.thresholdDb;
+            float gr = 0.0f;
+            if (k.kneeDb > 0.0f && overDb > -halfKnee && overDb < halfKnee) {
+                float x = overDb + halfKnee;
+                gr = k.slope * x * x / (2.0f * k.kneeDb);
+            } else if (overDb >= halfKnee) {
+                gr = overDb * k.slope;
+            }
+            if (gr > 0.0f) {
+                gainLin = dsp_db_to_linear(-gr);
+                if (gr > maxGr) maxGr = gr;
+            }
+        }
+        scratch[i] = gainLin * k.makeupLin;
+    }
+    dsps_mul_f32(buf, scratch, buf, len, 1, 1, 1);
+    env = e;
+    grDb = -maxGr;
+}
+
+// Gate (ratio <= 1) or downward expander, clamped to rangeLin.
+// State: env, hold (samples left before the gate may close), grDb.
+static inline void dsp_k_noise_gate(const DspDynCoeffs &k, float &env, float &hold, float &grDb,
+                                    float *scratch, float *buf, int len) {
+    if (len <= 0) return;
+    float e = env;
+    float h = hold;
+    float maxGr = 0.0f;
+    for (int i = 0; i < len; i++) {
+        e = _dsp_k_env(e, buf[i], k);
+        float gainLin = 1.0f;
+        if (e >= k.threshLin) {
+            h = k.holdSamples;               // Above threshold — rearm the hold timer
+        } else if (h > 0.0f) {
+            h -= 1.0f;                       // Holding open
+        } else {
+            if (k.hardGate) {
+                gainLin = k.rangeLin;
+            } else {
+                float envDb = (e > 1e-10f) ? 20.0f * log10f(e) : -100.0f;
+                float underDb = k.thresholdDb - envDb;
+                if (underDb > 0.0f) {
+                    float gr = underDb * k.slope;
+                    gainLin = dsp_db_to_linear(-gr);
+                    if (gainLin < k.rangeLin) gainLin = k.rangeLin;
+                    if (gr > maxGr) maxGr = gr;
+                }
+            }
+            float gr = -20.0f * log10f(gainLin > 1e-10f ? gainLin : 1e-10f);
+            if (gr > maxGr) maxGr = gr;
+        }
+        scratch[i] = gainLin;
+    }
+    dsps_mul_f32(buf, scratch, buf, len, 1, 1, 1);
+    env = e;
+    hold = h;
+    grDb = -maxGr;
+}
+
+// ===== Gain Ramp =====
+
+// Exponential ramp of `current` towards `target` (~5 ms with
+// rampCoeff = dsp_time_coeff(5, rate)); snaps and runs the SIMD multiply
+// once within ~0.001 dB. Settled gains never get here — both engines fold
+// them into a static scale.
+static inline void dsp_k_gain_ramp(float target, float &current, float rampCoeff, float *buf, int len) {
+    float cur = current;
+    if (fabsf(cur - target) < 1e-6f) {
+        current = target;
+        dsps_mulc_f32(buf, buf, len, target, 1, 1);
+        return;
+    }
+    const float oneMinus = 1.0f - rampCoeff;
+    for (int i = 0; i < len; i++) {
+        cur = rampCoeff * cur + oneMinus * target;
+        buf[i] *= cur;
+    }
+    current = cur;
+}
+
+// ===== Delay Ring =====
+// Rings are power-of-two sized (see DSP_DELAY_RING_SIZE) so positions wrap
+// with a mask and a chunk is written/read as at most two memcpy segments.
+// A ring must hold maxDelay + DSP_DELAY_CHUNK + DSP_DELAY_INTERP_TAPS floats.
+
+struct DspDelayTaps {
+    float h[DSP_DELAY_INTERP_TAPS];  // Lagrange taps
+    float a;                         // Thiran coefficient
+    uint32_t d;                      // Integer delay (clamped)
+    uint32_t base;                   // Integer delay of the first tap
+    uint8_t interp;                  // DspDelayInterp
+    bool frac;
+};
+
+static inline void dsp_k_delay_taps(const DspDelayParams &dly, DspDelayTaps &t, uint32_t maxDelay) {
+    memset(&t, 0, sizeof(t));
+    t.interp = dly.interp;
+    t.frac = dly.interp != DSP_DELAY_INTERP_NONE && dly.fraction > 0.0f;
+    uint32_t d = dly.delaySamples;
+    if (d > maxDelay) d = maxDelay;
+    t.d = d;
+    t.base = d;
+    if (t.frac && dly.interp == DSP_DELAY_INTERP_LAGRANGE) {
+        // Taps at d-1..d+2 keep the fractional point centred (t in [1,2))
+        t.base = d > 0 ? d - 1 : 0;
+        float x = (float)(d - t.base) + dly.fraction;
+        t.h[0] = -(x - 1.0f) * (x - 2.0f) * (x - 3.0f) / 6.0f;
+        t.h[1] =  x * (x - 2.0f) * (x - 3.0f) / 2.0f;
+        t.h[2] = -x * (x - 1.0f) * (x - 3.0f) / 2.0f;
+        t.h[3] =  x * (x - 1.0f) * (x - 2.0f) / 6.0f;
+    } else if (t.frac) {
+        // Thiran: allpass delay kept in [0.5, 1.5) where its phase is accurate
+        float delta = dly.fraction;
+        if (delta < 0.5f && d > 0) { delta += 1.0f; t.base = d - 1; }
+        t.a = (1.0f - delta) / (1.0f + delta);
+    }
+}
+
+static inline bool dsp_k_delay_active(const DspDelayTaps &t) {
+    return t.d > 0 || t.frac;
+}
+
+// State: writePos (ring position), apState (Thiran y[n-1]).
+static inline void dsp_k_delay(const DspDelayTaps &t, uint16_t &writePos, float &apState,
+                               float *line, uint32_t ringMask, float *buf, int len) {
+    const uint32_t ringSize = ringMask + 1;
+    const uint32_t d = t.d;
+    const uint32_t base = t.base;
+    const float *h = t.h;
+    const float a = t.a;
+    uint32_t wp = writePos & ringMask;
+    float y1 = apState;
+
+    while (len > 0) {
+        int n = len > DSP_DELAY_CHUNK ? DSP_DELAY_CHUNK : len;
+
+        uint32_t first = ringSize - wp;
+        if (first > (uint32_t)n) first = (uint32_t)n;
+        memcpy(line + wp, buf, first * sizeof(float));
+        if ((uint32_t)n > first) memcpy(line, buf + first, (n - first) * sizeof(float));
+
+        if (!t.frac) {
+            uint32_t rp = (wp - d) & ringMask;
+            uint32_t rfirst = ringSize - rp;
+            if (rfirst > (uint32_t)n) rfirst = (uint32_t)n;
+            memcpy(buf, line + rp, rfirst * sizeof(float));
+            if ((uint32_t)n > rfirst) memcpy(buf + rfirst, line, (n - rfirst) * sizeof(float));
+        } else if (t.interp == DSP_DELAY_INTERP_LAGRANGE) {
+            uint32_t p = wp - base;
+            for (int i = 0; i < n; i++, p++) {
+                buf[i] = h[0] * line[p & ringMask]
+                       + h[1] * line[(p - 1) & ringMask]
+                       + h[2] * line[(p - 2) & ringMask]
+                       + h[3] * line[(p - 3) & ringMask];
+            }
+        } else {
+            // y[n] = a*x[n-M] + x[n-M-1] - a*y[n-1]
+            uint32_t p = wp - base;
+            for (int i = 0; i < n; i++, p++) {
+                float y = a * (line[p & ringMask] - y1) + line[(p - 1) & ringMask];
+                buf[i] = y;
+                y1 = y;
+            }
+        }
+
+        wp = (wp + (uint32_t)n) & ringMask;
+        buf += n;
+        len -= n;
+    }
+
+    if (!(y1 > -1e30f && y1 < 1e30f)) y1 = 0.0f;  // Guard against NaN/Inf in state
+    apState = y1;
+    writePos = (uint16_t)wp;
+}
+
+// ===== Biquad Runs =====
+// Consecutive biquad sections of a chain form a run. At the top of each block
+// the run's coefficients and state are gathered from the stage structs into
+// one contiguous block, the whole run goes through the cascade kernel, and
+// state is scattered back. Gathering per block keeps the stage structs
+// authoritative (swap-time state migration, coefficient morphing); it costs
+// seven floats per section against len * sections multiply-adds.
+
+#define DSP_BQ_RUN_MAX_SECTIONS (3 * DSP_MAX_STAGES)   // Tone control = 3 sections per stage
+#define DSP_BQ_MORPH_SAMPLES    64                     // Coefficient morph length (~1.3 ms at 48 kHz)
+
+// One section of a run
+struct DspBiquadRef {
+    float *coeffs;            // [b0, b1, b2, a1, a2]
+    float *delay;             // Section state
+    DspBiquadParams *morph;   // Biquad stages (coefficient morphing); null for tone/loudness shelves
+};
+
+struct DspBiquadRun {
+    int n;
+    const DspBiquadRef *ref;
+    float coeffs[DSP_BQ_RUN_MAX_SECTIONS][5];
+    float state[DSP_BQ_RUN_MAX_SECTIONS][2];
+};
+
+static inline void dsp_k_bq_gather(const DspBiquadRef *ref, int n, DspBiquadRun &run) {
+    run.n = n;
+    run.ref = ref;
+    for (int k = 0; k < n; k++) {
+        memcpy(run.coeffs[k], ref[k].coeffs, sizeof(run.coeffs[0]));
+        run.state[k][0] = ref[k].delay[0];
+        run.state[k][1] = ref[k].delay[1];
+    }
+}
+
+static inline void dsp_k_bq_scatter(DspBiquadRun &run) {
+    for (int k = 0; k < run.n; k++) {
+        run.ref[k].delay[0] = run.state[k][0];
+        run.ref[k].delay[1] = run.state[k][1];
+    }
+}
+
+// Refresh interpolated coefficients for morphing sections and shrink `chunk`
+// so that no morph step spans more than 8 samples.
+static inline bool _dsp_k_bq_morph_prepare(DspBiquadRun &run, int &chunk) {
+    bool any = false;
+    for (int k = 0; k < run.n; k++) {
+        DspBiquadParams *p = run.ref[k].morph;
+        if (!p) continue;
+        int rem = p->morphRemaining;
+        if (rem <= 0) continue;
+        any = true;
+        float t = 1.0f - (float)rem / (float)DSP_BQ_MORPH_SAMPLES;
+        for (int c = 0; c < 5; c++) {
+            run.coeffs[k][c] = p->coeffs[c] + t * (p->targetCoeffs[c] - p->coeffs[c]);
+        }
+        if (chunk > 8) chunk = 8;
+        if (chunk > rem) chunk = rem;
+    }
+    return any;
+}
+
+static inline void _dsp_k_bq_morph_advance(DspBiquadRun &run, int done) {
+    for (int k = 0; k < run.n; k++) {
+        DspBiquadParams *p = run.ref[k].morph;
+        if (!p || p->morphRemaining == 0) continue;
+        int rem = p->morphRemaining - done;
+        if (rem <= 0) {
+            // Morph complete — snap to target coefficients
+            memcpy(p->coeffs, p->targetCoeffs, sizeof(p->coeffs));
+            memcpy(run.coeffs[k], p->targetCoeffs, sizeof(run.coeffs[0]));
+            p->morphRemaining = 0;
+        } else {
+            p->morphRemaining = (uint16_t)rem;
+        }
+    }
+}
+
+// Run one (rr == nullptr) or two matching gathered runs over a block.
+static inline void dsp_k_bq_run(DspBiquadRun &rl, DspBiquadRun *rr, float *left, float *right, int len) {
+    int pos = 0;
+    while (pos < len) {
+        int chunk = len - pos;
+        bool morphing = _dsp_k_bq_morph_prepare(rl, chunk);
+        if (rr && _dsp_k_bq_morph_prepare(*rr, chunk)) morphing = true;
+        if (rr) {
+            dsp_biquad_cascade_stereo_f32(left + pos, right + pos, chunk,
+                                          rl.coeffs, rr->coeffs, rl.state, rr->state, rl.n);
+        } else {
+            dsp_biquad_cascade_f32(left + pos, chunk, rl.coeffs, rl.state, rl.n);
+        }
+        if (morphing) {
+            _dsp_k_bq_morph_advance(rl, chunk);
+            if (rr) _dsp_k_bq_morph_advance(*rr, chunk);
+        }
+        pos += chunk;
+    }
+    dsp_k_bq_scatter(rl);
+    if (rr) dsp_k_bq_scatter(*rr);
+}
+
+// ===== FIR =====
+
+// Block FIR (dsp_fir_block.h): overlap-save from `fftCrossover` taps, direct
+// below. Params: taps, fir.numTaps. State: run. Reports the kernel used.
+static inline void dsp_k_fir(DspFirParams &fir, const float *taps, DspFirRun &run, int fftCrossover,
+                             float *buf, int len) {
+    fir.mode = dsp_fir_run_process(run, taps, fir.numTaps, buf, len, fir.numTaps >= fftCrossover);
+}
+
+// ===== Multi-Band Compressor =====
+// LR2 crossovers split the block into 2-4 bands, each band runs a soft-knee
+// compressor, and the bands are summed. Band settings and all state live in
+// the slot (pool slot on the input DSP, per-channel slot on the output DSP).
+
+#define DSP_MULTIBAND_MAX_BANDS 4
+
+struct DspMultibandBand {
+    float thresholdDb;
+    float attackMs;
+    float releaseMs;
+    float ratio;
+    float kneeDb;
+    float makeupGainDb;
+    float makeupLinear;
+    float envelope;       // runtime
+    float gainReduction;  // runtime
+};
+
+struct DspMultibandSlot {
+    float crossoverFreqs[3];  // Up to 3 crossover boundaries for 4 bands
+    DspMultibandBand bands[DSP_MULTIBAND_MAX_BANDS];
+    float xoverCoeffs[3][2][5]; // [boundary][lpf/hpf][coeffs]
+    float xoverDelay[3][2][2];  // [boundary][lpf/hpf][delay]
+    float bandBuf[DSP_MULTIBAND_MAX_BANDS][256]; // Per-band processing buffers
+};
+
+static inline void dsp_k_mb_defaults(DspMultibandSlot &slot) {
+    memset(&slot, 0, sizeof(slot));
+    slot.crossoverFreqs[0] = 200.0f;
+    slot.crossoverFreqs[1] = 2000.0f;
+    slot.crossoverFreqs[2] = 8000.0f;
+    for (int b = 0; b < DSP_MULTIBAND_MAX_BANDS; b++) {
+        DspMultibandBand &band = slot.bands[b];
+        band.thresholdDb = -12.0f;
+        band.attackMs = 10.0f;
+        band.releaseMs = 100.0f;
+        band.ratio = 4.0f;
+        band.kneeDb = 6.0f;
+        band.makeupGainDb = 0.0f;
+        band.makeupLinear = 1.0f;
+        band.envelope = 0.0f;
+        band.gainReduction = 0.0f;
+    }
+}
+
+static inline void dsp_k_mb_set_band(DspMultibandSlot &slot, int band, float thresholdDb, float attackMs,
+                                     float releaseMs, float ratio, float kneeDb, float makeupGainDb) {
+    DspMultibandBand &b = slot.bands[band];
+    b.thresholdDb  = thresholdDb;
+    b.attackMs     = attackMs;
+    b.releaseMs    = releaseMs;
+    b.ratio        = ratio;
+    b.kneeDb       = kneeDb;
+    b.makeupGainDb = makeupGainDb;
+    b.makeupLinear = powf(10.0f, makeupGainDb / 20.0f);
+}
+
+static inline bool dsp_k_mb_set_crossover(DspMultibandSlot &slot, int boundary, float freqHz, uint32_t sampleRate) {
+    slot.crossoverFreqs[boundary] = freqHz;
+    float normFreq = freqHz / (float)sampleRate;
+    if (normFreq <= 0.0f || normFreq >= 0.5f) return false;
+    dsp_gen_lpf_f32(slot.xoverCoeffs[boundary][0], normFreq, 0.707f);
+    dsp_gen_hpf_f32(slot.xoverCoeffs[boundary][1], normFreq, 0.707f);
+    // Reset delay lines to avoid clicks from stale state
+    memset(slot.xoverDelay[boundary], 0, sizeof(slot.xoverDelay[boundary]));
+    return true;
+}
+
+static inline void dsp_k_multiband(DspMultibandSlot &slot, int numBands, uint32_t sampleRate, float *buf, int len) {
+    if (numBands < 2) numBands = 2;
+    if (numBands > DSP_MULTIBAND_MAX_BANDS) numBands = DSP_MULTIBAND_MAX_BANDS;
+    int n = len > 256 ? 256 : len;
+
+    for (int b = 0; b < numBands; b++) {
+        memcpy(slot.bandBuf[b], buf, n * sizeof(float));
+    }
+    // Band 0: LPF at freq[0], band N-1: HPF at freq[N-2], middle bands: both
+    for (int boundary = 0; boundary < numBands - 1; boundary++) {
+        dsps_biquad_f32(slot.bandBuf[boundary], slot.bandBuf[boundary], n,
+                        slot.xoverCoeffs[boundary][0], slot.xoverDelay[boundary][0]);
+        dsps_biquad_f32(slot.bandBuf[boundary + 1], slot.bandBuf[boundary + 1], n,
+                        slot.xoverCoeffs[boundary][1], slot.xoverDelay[boundary][1]);
+    }
+
+    for (int b = 0; b < numBands; b++) {
+        DspMultibandBand &band = slot.bands[b];
+        float threshLin = dsp_db_to_linear(band.thresholdDb);
+        float attackCoeff = dsp_time_coeff(band.attackMs, (float)sampleRate);
+        float releaseCoeff = dsp_time_coeff(band.releaseMs, (float)sampleRate);
+
+        float env = band.envelope;
+        float maxGr = 0.0f;
+
+        for (int i = 0; i < n; i++) {
+            float absSample = fabsf(slot.bandBuf[b][i]);
+            if (absSample > env)
+                env = attackCoeff * env + (1.0f - attackCoeff) * absSample;
+            else
+                env = releaseCoeff * env + (1.0f - releaseCoeff) * absSample;
+
+            float gainLin = band.makeupLinear;
+            if (env > 0.0f && env > threshLin) {
+                float envDb = 20.0f * log10f(env);
+                float overDb = envDb - band.thresholdDb;
+                float grDb = 0.0f;
+                if (band.kneeDb > 0.0f && overDb > -band.kneeDb / 2.0f && overDb < band.kneeDb / 2.0f) {
+                    float x = overDb + band.kneeDb / 2.0f;
+                    grDb = (1.0f - 1.0f / band.ratio) * x * x / (2.0f * band.kneeDb);
+                } else if (overDb >= band.kneeDb / 2.0f) {
+                    grDb = overDb * (1.0f - 1.0f / band.ratio);
+                }
+                if (grDb > 0.0f) {
+                    gainLin *= dsp_db_to_linear(-grDb);
+                    if (grDb > maxGr) maxGr = grDb;
+                }
+            }
+            slot.bandBuf[b][i] *= gainLin;
+        }
+        band.envelope = env;
+        band.gainReduction = -maxGr;
+    }
+
+    memcpy(buf, slot.bandBuf[0], n * sizeof(float));
+    for (int b = 1; b < numBands; b++) {
+        dsps_add_f32(buf, slot.bandBuf[b], buf, n, 1, 1, 1);
+    }
+}
+
+// ===== Bass Enhancement =====
+
+// Harmonics of the sub-bass (buf - HPF(buf)), band-limited and mixed back.
+// Filter state lives in the params struct; `scratch` holds len floats.
+static inline void dsp_k_bass_enhance(DspBassEnhanceParams &be, float *scratch, float *buf, int len) {
+    if (be.mix <= 0.0f) return;
+    float mixScale = be.mix / 100.0f * be.harmonicGainLin;
+
+    memcpy(scratch, buf, len * sizeof(float));
+    dsps_biquad_f32(scratch, scratch, len, be.hpfCoeffs, be.hpfDelay);
+    for (int i = 0; i < len; i++) {
+        scratch[i] = buf[i] - scratch[i];   // Sub-bass
+    }
+    for (int i = 0; i < len; i++) {
+        float x = scratch[i];
+        float harmonic = 0.0f;
+        if (be.order == 0 || be.order == 2) harmonic += x * x;       // 2nd harmonic
+        if (be.order == 1 || be.order == 2) harmonic += x * x * x;   // 3rd harmonic
+        scratch[i] = harmonic;
+    }
+    dsps_biquad_f32(scratch, scratch, len, be.bpfCoeffs, be.bpfDelay);
+    dsps_mulc_f32(scratch, scratch, len, mixScale, 1, 1);
+    dsps_add_f32(buf, scratch, buf, len, 1, 1, 1);
+}
@@ -0,0 +1,175 @@
+#pragma once
+// dsp_multirate.h — Half-band decimation / interpolation kernel for multirate
+// sections (header-only).
+//
+// A section runs part of a channel's stage list at fs / factor (factor 2, 4
+// or 8). The signal is decimated by a cascade of log2(factor) half-band
+// filters, processed by the nested stages at the low rate, and interpolated
+// back by the mirrored cascade. Each section owns one DspMultirateState,
+// allocated from a PSRAM pool by the caller; the DspStage only carries the
+// factor and a slot.
+//
+// Half-band filter: 47 taps, Kaiser window (beta 8, ~80 dB stopband). Every
+// second tap is zero except the centre (0.5), so each polyphase branch needs
+// DSP_MR_HB_PAIRS symmetric multiplies per output sample:
+//   decimate:    y[m]    = 0.5 * x[2m-23] + sum_j g[j] * (x[2m-22+2j] + x[2m-24-2j])
+//   interpolate: y[2p]   = 2 * sum_j g[j] * (x[p-11+j] + x[p-12-j])
+//                y[2p+1] = x[p-11]
+// Both paths delay by 23 samples at the higher rate, so a full section adds
+// dsp_mr_latency_samples(factor) = 46 * (factor - 1) samples at fs. The
+// passband is flat to ~0.39 * (fs / factor) (±0.001 dB); everything above
+// ~0.61 * (fs / factor) is rejected before it can alias.
+//
+// Blocks must be a multiple of the factor so every cascade stage sees an even
+// length and the even/odd phase of each stage never slips.
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define DSP_MR_MAX_STAGES  3                            // 2^3 = factor 8
+#define DSP_MR_MAX_FACTOR  (1 << DSP_MR_MAX_STAGES)
+#define DSP_MR_HB_PAIRS    12                           // Non-zero symmetric tap pairs
+#define DSP_MR_HB_TAPS     (4 * DSP_MR_HB_PAIRS - 1)    // 47
+#define DSP_MR_HB_DELAY    (2 * DSP_MR_HB_PAIRS - 1)    // 23 samples at the higher rate
+#define DSP_MR_HIST        (2 * DSP_MR_HB_PAIRS - 1)    // Branch history (23 samples)
+#define DSP_MR_MAX_BLOCK   256                          // Largest block at the full rate
+#define DSP_MR_WORK        (DSP_MR_HIST + DSP_MR_MAX_BLOCK / 2)
+
+struct DspHalfbandState {
+    float even[DSP_MR_HIST];          // Decimator: previous even-phase inputs
+    float odd[DSP_MR_HB_PAIRS];       // Decimator: previous odd-phase inputs (centre tap)
+    float interp[DSP_MR_HIST];        // Interpolator: previous low-rate inputs
+};
+
+struct DspMultirateState {
+    float g[DSP_MR_HB_PAIRS];         // Half-band taps g[j] at centre +/- (2j + 1)
+    uint8_t factor;                   // Configured factor (state is reset on change)
+    uint8_t stages;                   // log2(factor)
+    DspHalfbandState hb[DSP_MR_MAX_STAGES];  // [0] runs at fs, [1] at fs/2, ...
+    float work[2][DSP_MR_WORK];       // Contiguous history + block scratch
+};
+
+// Samples of delay a decimate + interpolate round trip adds at the full rate
+static inline int dsp_mr_latency_samples(int factor) {
+    return factor > 1 ? 2 * DSP_MR_HB_DELAY * (factor - 1) : 0;
+}
+
+// log2 of a valid factor (2, 4, 8); 0 for anything else
+static inline int dsp_mr_stages_for(int factor) {
+    return factor == 2 ? 1 : factor == 4 ? 2 : factor == 8 ? 3 : 0;
+}
+
+static inline double _dsp_mr_bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+// Kaiser-windowed ideal half-band; g is normalized so the DC gain is exactly 1
+static inline void _dsp_mr_design(DspMultirateState &st) {
+    const double beta = 8.0;
+    const double half = (double)(DSP_MR_HB_TAPS - 1) / 2.0;
+    const double i0b = _dsp_mr_bessel_i0(beta);
+    double sum = 0.0;
+    double g[DSP_MR_HB_PAIRS];
+    for (int j = 0; j < DSP_MR_HB_PAIRS; j++) {
+        double d = 2.0 * j + 1.0;                          // Offset from centre
+        double s = sin(M_PI * d / 2.0) / (M_PI * d);       // 0.5 * sinc(d / 2)
+        double r = d / half;
+        double w = _dsp_mr_bessel_i0(beta * sqrt(1.0 - r * r)) / i0b;
+        g[j] = s * w;
+        sum += g[j];
+    }
+    for (int j = 0; j < DSP_MR_HB_PAIRS; j++) st.g[j] = (float)(g[j] * 0.25 / sum);
+}
+
+static inline void dsp_mr_reset(DspMultirateState &st) {
+    memset(st.hb, 0, sizeof(st.hb));
+}
+
+// Build a fresh state. Safe to call from any task (no allocation).
+static inline void dsp_mr_init(DspMultirateState &st) {
+    _dsp_mr_design(st);
+    st.factor = 0;
+    st.stages = 0;
+    dsp_mr_reset(st);
+}
+
+// Apply the factor; a change clears all history. Returns false for an
+// unsupported factor (section is then skipped).
+static inline bool dsp_mr_configure(DspMultirateState &st, int factor) {
+    int stages = dsp_mr_stages_for(factor);
+    if (stages == 0) return false;
+    if (st.factor != factor) {
+        st.factor = (uint8_t)factor;
+        st.stages = (uint8_t)stages;
+        dsp_mr_reset(st);
+    }
+    return true;
+}
+
+// One half-band decimator: len (even) inputs -> len / 2 outputs. In-place safe.
+static inline void _dsp_mr_decim2(DspMultirateState &st, DspHalfbandState &hb,
+                                  const float *in, float *out, int len) {
+    const int half = len / 2;
+    float *e = st.work[0];   // e[k] = even input (k - DSP_MR_HIST)
+    float *o = st.work[1];   // o[k] = odd input  (k - DSP_MR_HB_PAIRS)
+    memcpy(e, hb.even, sizeof(hb.even));
+    memcpy(o, hb.odd, sizeof(hb.odd));
+    for (int m = 0; m < half; m++) {
+        e[DSP_MR_HIST + m] = in[2 * m];
+        o[DSP_MR_HB_PAIRS + m] = in[2 * m + 1];
+    }
+    const float *g = st.g;
+    for (int m = 0; m < half; m++) {
+        const float *lo = e + m + DSP_MR_HB_PAIRS - 1;   // x[2m-22+2j] walks up from here
+        const float *hi = e + m + DSP_MR_HB_PAIRS;
+        float acc = 0.5f * o[m];
+        for (int j = 0; j < DSP_MR_HB_PAIRS; j++) acc += g[j] * (hi[j] + lo[-j]);
+        out[m] = acc;
+    }
+    memcpy(hb.even, e + half, sizeof(hb.even));
+    memcpy(hb.odd, o + half, sizeof(hb.odd));
+}
+
+// One half-band interpolator: len inputs -> 2 * len outputs. In-place safe.
+static inline void _dsp_mr_interp2(DspMultirateState &st, DspHalfbandState &hb,
+                                   const float *in, float *out, int len) {
+    float *x = st.work[0];   // x[k] = input (k - DSP_MR_HIST)
+    memcpy(x, hb.interp, sizeof(hb.interp));
+    memcpy(x + DSP_MR_HIST, in, sizeof(float) * len);
+    const float *g = st.g;
+    for (int p = 0; p < len; p++) {
+        const float *lo = x + p + DSP_MR_HB_PAIRS - 1;
+        const float *hi = x + p + DSP_MR_HB_PAIRS;
+        float acc = 0.0f;
+        for (int j = 0; j < DSP_MR_HB_PAIRS; j++) acc += g[j] * (hi[j] + lo[-j]);
+        out[2 * p] = 2.0f * acc;
+        out[2 * p + 1] = hi[0];
+    }
+    memcpy(hb.interp, x + len, sizeof(hb.interp));
+}
+
+// fs -> fs / factor, in place. Returns the low-rate length, or 0 when len is
+// not a multiple of the factor (buffer untouched).
+static inline int dsp_mr_decimate(DspMultirateState &st, float *buf, int len) {
+    if (st.stages == 0 || len <= 0 || len > DSP_MR_MAX_BLOCK || (len % st.factor) != 0) return 0;
+    for (int s = 0; s < st.stages; s++) {
+        _dsp_mr_decim2(st, st.hb[s], buf, buf, len);
+        len /= 2;
+    }
+    return len;
+}
+
+// fs / factor -> fs, in place; buf must hold lowLen * factor samples
+static inline void dsp_mr_interpolate(DspMultirateState &st, float *buf, int lowLen) {
+    for (int s = st.stages - 1; s >= 0; s--) {
+        _dsp_mr_interp2(st, st.hb[s], buf, buf, lowLen);
+        lowLen *= 2;
+    }
+}
@@ -3,6 +3,11 @@
 #include "dsp_pipeline.h"
 #include "dsp_coefficients.h"
 #include "dsp_biquad_gen.h"
+#include "dsp_biquad_cascade.h"
+#include "dsp_true_peak.h"
+#include "dsp_fir_block.h"
+#include "dsp_multirate.h"
+#include "dsp_kernels.h"
 #include "dsps_biquad.h"
 #include "dsps_fir.h"
 #include "dsps_mulc.h"
@@ -15,11 +20,14 @@
 #include "psram_alloc.h"
 #include <math.h>
 #include <string.h>
+#include <atomic>
 
 #ifndef NATIVE_TEST
 #include "debug_serial.h"
 #include <esp_heap_caps.h>
 #else
+#include <chrono>
+#include <thread>
 // Stubs for native test builds
 #define LOG_I(...)
 #define LOG_W(...)
@@ -39,57 +47,70 @@ static DspState _states[2];
 static DspState *_states = nullptr;
 #endif
 static volatile int _activeIndex = 0;
-static volatile bool _processingActive = false;
 static DspMetrics _metrics;
 
-// ===== DSP Swap Synchronization =====
+// ===== Config Publish (RCU-style) =====
+// dsp_swap_config() publishes the inactive config by storing its index in
+// _pendingIndex and bumping _publishEpoch. The audio task picks it up at the
+// top of its next lane-0 block, migrates runtime state from the old config
+// (keyed by DspStage::id), flips _activeIndex and acknowledges by copying the
+// epoch into _ackEpoch. The writer waits at most one block period for that
+// acknowledgement; the audio task never waits. Once the audio task has
+// claimed a publish the flip cannot be withdrawn: the writer keeps waiting for
+// the ack until the period is up, and failing that reports failure with the
+// publish still in flight (the audio side completes it). The next writer
+// entry (copy or swap) lets that flip settle first, for at most one block
+// period, and refuses to touch the inactive config while it has not.
+//
+// When the audio task is idle (or late), the writer performs the flip itself.
+// _processingActive (audio) and _writerFlip (writer) form a Dekker pair: each
+// side raises its flag and then checks the other's, so at most one of them
+// touches the configs at a time. The loser backs off — the writer keeps
+// waiting, the audio task skips that block and the pipeline hold buffer
+// covers it.
 #ifndef NATIVE_TEST
 static SemaphoreHandle_t _swapMutex = NULL;
 #endif
-static volatile bool _swapRequested = false;
-
-// ===== FIR Data Pool (PSRAM on ESP32, static on native) =====
-// Each slot: taps[256] + delay[256+8] ~= 2.1KB. 2 states × 2 slots × 2.1KB ~= 8.3KB total
-// Delay array is DSP_MAX_FIR_TAPS + 8 because ESP-DSP S3 SIMD reads ahead of the delay line.
-#ifdef NATIVE_TEST
-static float _firTaps[2][DSP_MAX_FIR_SLOTS][DSP_MAX_FIR_TAPS];
-static float _firDelay[2][DSP_MAX_FIR_SLOTS][DSP_MAX_FIR_TAPS + 8];
-#else
-// Flat 1D pools — indexed as [stateIndex * DSP_MAX_FIR_SLOTS + firSlot] * elements
-static float *_firTapsPool = nullptr;   // 2 * DSP_MAX_FIR_SLOTS * DSP_MAX_FIR_TAPS floats
-static float *_firDelayPool = nullptr;  // 2 * DSP_MAX_FIR_SLOTS * (DSP_MAX_FIR_TAPS + 8) floats
-#endif
+#define DSP_RCU_NONE    -1
+#define DSP_RCU_CLAIMED -2
+static std::atomic<bool> _processingActive(false);
+static std::atomic<bool> _writerFlip(false);
+static std::atomic<int> _pendingIndex(DSP_RCU_NONE);
+static std::atomic<uint32_t> _publishEpoch(0);
+static std::atomic<uint32_t> _ackEpoch(0);
+static volatile uint32_t _lastBlockUs = 0;      // Start of the last audio block (0 = never)
+static volatile uint32_t _blockPeriodUs = 5333; // Duration of the last block (256 frames @ 48kHz)
+static inline uint32_t _rcu_now_us();
+static bool _rcu_settle(uint32_t start, uint32_t budget);
+static inline uint32_t _rcu_budget();
+
+// ===== FIR Data Pool (PSRAM, allocated per slot on first use) =====
+// Each slot: taps[DSP_MAX_FIR_TAPS] per state, plus one DspFirRun (history + overlap-save spectra, ~100KB at 4096 taps). The
+// run state is shared by both configs so a swap never copies filter history.
+// Memory is kept after the slot is freed: the active config may still point
+// at it until the next swap.
+static float *_firTaps[2][DSP_MAX_FIR_SLOTS];
+static DspFirRun *_firRun[DSP_MAX_FIR_SLOTS];
 static bool _firSlotUsed[DSP_MAX_FIR_SLOTS];
+static int _firFftCrossover = DSP_FIR_FFT_MIN_TAPS;
+#ifndef NATIVE_TEST
+static bool _firCalibrated = false;
+#endif
 
 // ===== Delay Data Pool (dynamically allocated to save DRAM) =====
-// Each slot: line[4800] = 19.2KB. Allocated on-demand when delay stages are added.
-// Saves 76.8KB of static RAM when no delay stages are in use (common case).
-static float *_delayLine[2][DSP_MAX_DELAY_SLOTS];  // Heap-allocated on demand
+// Each slot: one DSP_DELAY_RING_SIZE ring (64KB at 15360 samples), shared by
+// both configs like the FIR run state, so a copy or swap never moves delay
+// history. Allocated on-demand when delay stages are added; the number of
+// live slots is capped by DSP_DELAY_PSRAM_BUDGET. Memory is kept after the
+// slot is freed: the active config may still point at it until the next swap.
+static float *_delayLine[DSP_MAX_DELAY_SLOTS];
 static bool _delaySlotUsed[DSP_MAX_DELAY_SLOTS];
 
+static const uint32_t DELAY_SLOT_BYTES = DSP_DELAY_RING_SIZE * sizeof(float);
+
 // ===== Multi-Band Compressor Pool =====
 #define DSP_MULTIBAND_MAX_SLOTS 1
-#define DSP_MULTIBAND_MAX_BANDS 4
-
-struct DspMultibandBand {
-    float thresholdDb;
-    float attackMs;
-    float releaseMs;
-    float ratio;
-    float kneeDb;
-    float makeupGainDb;
-    float makeupLinear;
-    float envelope;       // runtime
-    float gainReduction;  // runtime
-};
-
-struct DspMultibandSlot {
-    float crossoverFreqs[3];  // Up to 3 crossover boundaries for 4 bands
-    DspMultibandBand bands[DSP_MULTIBAND_MAX_BANDS];
-    float xoverCoeffs[3][2][5]; // [boundary][lpf/hpf][coeffs]
-    float xoverDelay[3][2][2];  // [boundary][lpf/hpf][delay]
-    float bandBuf[DSP_MULTIBAND_MAX_BANDS][256]; // Per-band processing buffers
-};
+// DspMultibandSlot and its kernel live in dsp_kernels.h
 
 #ifdef NATIVE_TEST
 static DspMultibandSlot _mbSlots[DSP_MULTIBAND_MAX_SLOTS];
@@ -102,34 +123,10 @@ int dsp_mb_alloc_slot() {
     for (int i = 0; i < DSP_MULTIBAND_MAX_SLOTS; i++) {
         if (!_mbSlotUsed[i]) {
             _mbSlotUsed[i] = true;
-#ifdef NATIVE_TEST
-            memset(&_mbSlots[i], 0, sizeof(DspMultibandSlot));
-#else
-            if (_mbSlots) memset(&_mbSlots[i], 0, sizeof(DspMultibandSlot));
-#endif
-            // Set default band params
-            DspMultibandSlot *slot;
-#ifdef NATIVE_TEST
-            slot = &_mbSlots[i];
-#else
-            slot = _mbSlots ? &_mbSlots[i] : nullptr;
+#ifndef NATIVE_TEST
+            if (_mbSlots)
 #endif
-            if (slot) {
-                slot->crossoverFreqs[0] = 200.0f;
-                slot->crossoverFreqs[1] = 2000.0f;
-                slot->crossoverFreqs[2] = 8000.0f;
-                for (int b = 0; b < DSP_MULTIBAND_MAX_BANDS; b++) {
-                    slot->bands[b].thresholdDb = -12.0f;
-                    slot->bands[b].attackMs = 10.0f;
-                    slot->bands[b].releaseMs = 100.0f;
-                    slot->bands[b].ratio = 4.0f;
-                    slot->bands[b].kneeDb = 6.0f;
-                    slot->bands[b].makeupGainDb = 0.0f;
-                    slot->bands[b].makeupLinear = 1.0f;
-                    slot->bands[b].envelope = 0.0f;
-                    slot->bands[b].gainReduction = 0.0f;
-                }
-            }
+                dsp_k_mb_defaults(_mbSlots[i]);
             return i;
         }
     }
@@ -142,6 +139,75 @@ void dsp_mb_free_slot(int slot) {
     }
 }
 
+// ===== True-Peak Limiter Pool =====
+// States are allocated from PSRAM on first use and kept for the lifetime of
+// the firmware: a freed slot may still be referenced by the active config
+// until the next swap, so its memory must stay valid. Re-allocation resets it.
+static DspTruePeakState *_tpSlots[DSP_MAX_TRUE_PEAK_SLOTS];
+static bool _tpSlotUsed[DSP_MAX_TRUE_PEAK_SLOTS];
+
+int dsp_tp_alloc_slot() {
+    for (int i = 0; i < DSP_MAX_TRUE_PEAK_SLOTS; i++) {
+        if (_tpSlotUsed[i]) continue;
+        if (!_tpSlots[i]) {
+            _tpSlots[i] = (DspTruePeakState *)psram_alloc(1, sizeof(DspTruePeakState), "dsp_true_peak");
+            if (!_tpSlots[i]) {
+                LOG_E("[DSP] True-peak slot %d alloc failed (need %d bytes)", i, (int)sizeof(DspTruePeakState));
+                return -1;
+            }
+        }
+        dsp_tp_init(*_tpSlots[i]);
+        _tpSlotUsed[i] = true;
+        return i;
+    }
+    return -1;
+}
+
+void dsp_tp_free_slot(int slot) {
+    if (slot >= 0 && slot < DSP_MAX_TRUE_PEAK_SLOTS) {
+        _tpSlotUsed[slot] = false;
+    }
+}
+
+static inline DspTruePeakState *_tp_state(int8_t slot) {
+    if (slot < 0 || slot >= DSP_MAX_TRUE_PEAK_SLOTS) return nullptr;
+    return _tpSlots[slot];
+}
+
+// ===== Multirate Section Pool =====
+// Same lifetime rules as the true-peak pool: allocated on first use, kept
+// after free, reset on re-allocation.
+static DspMultirateState *_mrSlots[DSP_MAX_MULTIRATE_SLOTS];
+static bool _mrSlotUsed[DSP_MAX_MULTIRATE_SLOTS];
+
+int dsp_mr_alloc_slot() {
+    for (int i = 0; i < DSP_MAX_MULTIRATE_SLOTS; i++) {
+        if (_mrSlotUsed[i]) continue;
+        if (!_mrSlots[i]) {
+            _mrSlots[i] = (DspMultirateState *)psram_alloc(1, sizeof(DspMultirateState), "dsp_multirate");
+            if (!_mrSlots[i]) {
+                LOG_E("[DSP] Multirate slot %d alloc failed (need %d bytes)", i, (int)sizeof(DspMultirateState));
+                return -1;
+            }
+        }
+        dsp_mr_init(*_mrSlots[i]);
+        _mrSlotUsed[i] = true;
+        return i;
+    }
+    return -1;
+}
+
+void dsp_mr_free_slot(int slot) {
+    if (slot >= 0 && slot < DSP_MAX_MULTIRATE_SLOTS) {
+        _mrSlotUsed[slot] = false;
+    }
+}
+
+static inline DspMultirateState *_mr_state(int8_t slot) {
+    if (slot < 0 || slot >= DSP_MAX_MULTIRATE_SLOTS) return nullptr;
+    return _mrSlots[slot];
+}
+
 bool dsp_mb_set_band_params(int slotIdx, int band, float thresholdDb, float attackMs,
                              float releaseMs, float ratio, float kneeDb, float makeupGainDb) {
     if (slotIdx < 0 || slotIdx >= DSP_MULTIBAND_MAX_SLOTS) return false;
@@ -149,14 +215,7 @@ bool dsp_mb_set_band_params(int slotIdx, int band, float thresholdDb, float atta
 #ifndef NATIVE_TEST
     if (!_mbSlots) return false;
 #endif
-    DspMultibandBand &b = _mbSlots[slotIdx].bands[band];
-    b.thresholdDb  = thresholdDb;
-    b.attackMs     = attackMs;
-    b.releaseMs    = releaseMs;
-    b.ratio        = ratio;
-    b.kneeDb       = kneeDb;
-    b.makeupGainDb = makeupGainDb;
-    b.makeupLinear = powf(10.0f, makeupGainDb / 20.0f);
+    dsp_k_mb_set_band(_mbSlots[slotIdx], band, thresholdDb, attackMs, releaseMs, ratio, kneeDb, makeupGainDb);
     return true;
 }
 
@@ -167,16 +226,7 @@ bool dsp_mb_set_crossover_freq(int slotIdx, int boundary, float freqHz, uint32_t
 #ifndef NATIVE_TEST
     if (!_mbSlots) return false;
 #endif
-    DspMultibandSlot &slot = _mbSlots[slotIdx];
-    slot.crossoverFreqs[boundary] = freqHz;
-    float normFreq = freqHz / (float)sampleRate;
-    if (normFreq <= 0.0f || normFreq >= 0.5f) return false;
-    // Recompute LPF and HPF coefficients for this crossover boundary
-    dsp_gen_lpf_f32(slot.xoverCoeffs[boundary][0], normFreq, 0.707f);
-    dsp_gen_hpf_f32(slot.xoverCoeffs[boundary][1], normFreq, 0.707f);
-    // Reset delay lines to avoid clicks from stale state
-    memset(slot.xoverDelay[boundary], 0, sizeof(slot.xoverDelay[boundary]));
-    return true;
+    return dsp_k_mb_set_crossover(_mbSlots[slotIdx], boundary, freqHz, sampleRate);
 }
 
 // ===== Conversion Buffers (PSRAM on ESP32, static on native) =====
@@ -191,44 +241,63 @@ static float *_gainBuf = nullptr;
 #endif
 
 // ===== Forward Declarations =====
-static int  dsp_process_channel(float *buf, int len, DspChannelConfig &ch, int stateIdx);
-static void dsp_limiter_process(DspLimiterParams &lim, float *buf, int len, uint32_t sampleRate);
-static void dsp_gain_process(DspGainParams &gain, float *buf, int len, uint32_t sampleRate);
-static void dsp_fir_process(DspFirParams &fir, float *buf, int len, int stateIdx);
-static void dsp_delay_process(DspDelayParams &dly, float *buf, int len, int stateIdx);
-static void dsp_polarity_process(float *buf, int len);
-static void dsp_mute_process(float *buf, int len);
-static void dsp_compressor_process(DspCompressorParams &comp, float *buf, int len, uint32_t sampleRate);
-static int  dsp_decimator_process(DspDecimatorParams &dec, float *buf, int len, int stateIdx);
-static void dsp_noise_gate_process(DspNoiseGateParams &gate, float *buf, int len, uint32_t sampleRate);
-static void dsp_tone_ctrl_process(DspToneCtrlParams &tc, float *buf, int len);
-static void dsp_loudness_process(DspLoudnessParams &ld, float *buf, int len);
-static void dsp_bass_enhance_process(DspBassEnhanceParams &be, float *buf, int len);
+static void _program_alloc();
+static void _program_build(int stateIdx);
+static void _program_process(int stateIdx, int lane, float *left, float *right, int frames);
+static void _gov_reset();
+static void _gov_period(int stateIdx);
+static void _gov_carry_costs(int oldIdx, int newIdx);
+static void _gov_apply(int stateIdx);
+
+// Load governor state (see Load Governor below)
+static DspGovernor _gov;
+static float _govLoad = 0.0f;      // Summed load (%) of the current period's blocks
+static uint16_t _govTick = 0;
+static bool _govProfile = false;   // Time every op this period
+static void dsp_fir_process(DspFirParams &fir, float *taps, DspFirRun *run, float *buf, int len, uint32_t sampleRate);
 static void dsp_multiband_comp_process(DspMultibandCompParams &mb, float *buf, int len, uint32_t sampleRate);
+static void dsp_true_peak_stage_process(DspTruePeakParams &tp, float *buf, int len, uint32_t sampleRate);
+static void dsp_true_peak_linked_process(DspTruePeakParams &tpL, DspTruePeakParams &tpR,
+                                         float *left, float *right, int len, uint32_t sampleRate);
 
 // ===== FIR Pool Management =====
 
+static bool _fir_slot_storage(int i) {
+    if (_firRun[i]) return true;
 #ifndef NATIVE_TEST
-// Flat pool index helpers for PSRAM-allocated FIR data
-static inline float* _fir_taps_at(int stateIndex, int firSlot) {
-    return _firTapsPool + (stateIndex * DSP_MAX_FIR_SLOTS + firSlot) * DSP_MAX_FIR_TAPS;
-}
-static inline float* _fir_delay_at(int stateIndex, int firSlot) {
-    return _firDelayPool + (stateIndex * DSP_MAX_FIR_SLOTS + firSlot) * (DSP_MAX_FIR_TAPS + 8);
-}
+    if (AppState::getInstance().debug.psramCritical) {
+        LOG_W("[DSP] PSRAM critical — refusing FIR alloc");
+        return false;
+    }
 #endif
+    for (int s = 0; s < 2; s++) {
+        if (!_firTaps[s][i]) _firTaps[s][i] = (float *)psram_alloc(DSP_MAX_FIR_TAPS, sizeof(float), "dsp_fir_taps");
+        if (!_firTaps[s][i]) {
+            LOG_E("[DSP] FIR slot %d alloc failed", i);
+            return false;
+        }
+    }
+    DspFirRun *run = (DspFirRun *)psram_alloc(1, sizeof(DspFirRun), "dsp_fir_run");
+    if (!run) {
+        LOG_E("[DSP] FIR slot %d kernel state alloc failed (need %d bytes)", i, (int)sizeof(DspFirRun));
+        return false;
+    }
+    dsp_fir_run_init(*run);
+    _firRun[i] = run;
+    return true;
+}
 
 int dsp_fir_alloc_slot() {
     for (int i = 0; i < DSP_MAX_FIR_SLOTS; i++) {
         if (!_firSlotUsed[i]) {
+            if (!_fir_slot_storage(i)) return -1;
             _firSlotUsed[i] = true;
-            // Zero both states' data for this slot
+            // Zero both states' taps for this slot
             for (int s = 0; s < 2; s++) {
-                float *taps = dsp_fir_get_taps(s, i);
-                float *delay = dsp_fir_get_delay(s, i);
-                if (taps) memset(taps, 0, sizeof(float) * DSP_MAX_FIR_TAPS);
-                if (delay) memset(delay, 0, sizeof(float) * (DSP_MAX_FIR_TAPS + 8));
+                memset(_firTaps[s][i], 0, sizeof(float) * DSP_MAX_FIR_TAPS);
             }
+            _firRun[i]->olsTaps = 0;
+            dsp_fir_run_reset(*_firRun[i], 0);
             return i;
         }
     }
@@ -244,23 +313,70 @@ void dsp_fir_free_slot(int slot) {
 float* dsp_fir_get_taps(int stateIndex, int firSlot) {
     if (stateIndex < 0 || stateIndex > 1 || firSlot < 0 || firSlot >= DSP_MAX_FIR_SLOTS)
         return nullptr;
-#ifdef NATIVE_TEST
     return _firTaps[stateIndex][firSlot];
-#else
-    if (!_firTapsPool) return nullptr;
-    return _fir_taps_at(stateIndex, firSlot);
-#endif
 }
 
-float* dsp_fir_get_delay(int stateIndex, int firSlot) {
-    if (stateIndex < 0 || stateIndex > 1 || firSlot < 0 || firSlot >= DSP_MAX_FIR_SLOTS)
-        return nullptr;
-#ifdef NATIVE_TEST
-    return _firDelay[stateIndex][firSlot];
-#else
-    if (!_firDelayPool) return nullptr;
-    return _fir_delay_at(stateIndex, firSlot);
+int dsp_fir_fft_crossover() {
+    return _firFftCrossover;
+}
+
+#ifndef NATIVE_TEST
+// Time both kernels at two lengths on a scratch state and solve for the tap
+// count where overlap-save becomes cheaper. Runs once, on the caller's task.
+static void _fir_calibrate() {
+    _firCalibrated = true;
+    DspFirRun *run = (DspFirRun *)psram_alloc(1, sizeof(DspFirRun), "dsp_fir_cal");
+    float *taps = (float *)psram_alloc(DSP_MAX_FIR_TAPS, sizeof(float), "dsp_fir_cal");
+    float *buf = (float *)psram_alloc(256, sizeof(float), "dsp_fir_cal");
+    if (run && taps && buf) {
+        dsp_fir_run_init(*run);
+        for (int i = 0; i < DSP_MAX_FIR_TAPS; i++) taps[i] = (i & 1) ? -1e-3f : 1e-3f;
+        const int lens[2] = {256, DSP_MAX_FIR_TAPS < 1024 ? DSP_MAX_FIR_TAPS : 1024};
+        float us[2][2];
+        for (int l = 0; l < 2; l++) {
+            dsp_fir_prepare(*run, taps, (uint16_t)lens[l]);
+            for (int m = 0; m < 2; m++) {
+                unsigned long t0 = (unsigned long)esp_timer_get_time();
+                for (int b = 0; b < 4; b++) {
+                    for (int i = 0; i < 256; i++) buf[i] = (float)((i * 7) & 31) * 0.01f;
+                    dsp_fir_run_process(*run, taps, (uint16_t)lens[l], buf, 256, m == 1);
+                }
+                us[l][m] = (float)((unsigned long)esp_timer_get_time() - t0);
+            }
+        }
+        // Linear cost model per kernel: t = a + b * taps
+        float span = (float)(lens[1] - lens[0]);
+        if (span > 0.0f && us[0][0] > 0.0f && us[0][1] > 0.0f) {
+            float bd = (us[1][0] - us[0][0]) / span, bf = (us[1][1] - us[0][1]) / span;
+            float ad = us[0][0] - bd * lens[0], af = us[0][1] - bf * lens[0];
+            int cross = DSP_MAX_FIR_TAPS + 1;  // FFT never pays off
+            if (bd > bf) {
+                float x = (af - ad) / (bd - bf);
+                cross = x < DSP_FIR_PART ? DSP_FIR_PART : (int)x;
+                cross = (cross + DSP_FIR_PART - 1) / DSP_FIR_PART * DSP_FIR_PART;
+            }
+            _firFftCrossover = cross;
+        }
+        LOG_I("[DSP] FIR FFT crossover: %d taps (direct %.0f/%.0f us, fft %.0f/%.0f us per 1024 samples at %d/%d taps)",
+              _firFftCrossover, us[0][0], us[1][0], us[0][1], us[1][1], lens[0], lens[1]);
+    }
+    psram_free(buf, "dsp_fir_cal");
+    psram_free(taps, "dsp_fir_cal");
+    psram_free(run, "dsp_fir_cal");
+}
 #endif
+
+void dsp_fir_commit_taps(int firSlot, int numTaps) {
+    if (firSlot < 0 || firSlot >= DSP_MAX_FIR_SLOTS || !_firRun[firSlot]) return;
+    DspFirRun &run = *_firRun[firSlot];
+    if (numTaps <= 0 || numTaps > DSP_MAX_FIR_TAPS) { run.olsTaps = 0; return; }
+#ifndef NATIVE_TEST
+    if (!_firCalibrated && numTaps >= DSP_FIR_FFT_MIN_TAPS) _fir_calibrate();
+#endif
+    if (numTaps >= _firFftCrossover)
+        dsp_fir_prepare(run, _firTaps[1 - _activeIndex][firSlot], (uint16_t)numTaps);
+    else
+        run.olsTaps = 0;
 }
 
 // ===== Delay Pool Management =====
@@ -273,7 +389,7 @@ int dsp_delay_alloc_slot() {
     }
     // Pre-flight heap check when PSRAM is not available
     if (ESP.getPsramSize() == 0) {
-        uint32_t needed = DSP_MAX_DELAY_SAMPLES * sizeof(float) * 2; // Both state pools
+        uint32_t needed = DELAY_SLOT_BYTES;
         uint32_t available = ESP.getMaxAllocHeap();
         if (available < needed + HEAP_CRITICAL_THRESHOLD) { // Keep reserve for WiFi/MQTT/HTTP
             LOG_E("[DSP] Delay alloc blocked: need %lu + 40KB reserve, only %lu available",
@@ -282,26 +398,24 @@ int dsp_delay_alloc_slot() {
         }
     }
 #endif
+    int inUse = 0;
+    for (int i = 0; i < DSP_MAX_DELAY_SLOTS; i++) if (_delaySlotUsed[i]) inUse++;
+    if (inUse >= dsp_delay_slot_capacity()) {
+        LOG_W("[DSP] Delay pool budget reached (%d slots, %lu KB)",
+              inUse, (unsigned long)(DSP_DELAY_PSRAM_BUDGET / 1024));
+        return -1;
+    }
     for (int i = 0; i < DSP_MAX_DELAY_SLOTS; i++) {
         if (!_delaySlotUsed[i]) {
-            // Dynamically allocate delay lines for both state pools via psram_alloc
-            for (int s = 0; s < 2; s++) {
-                if (!_delayLine[s][i]) {
-                    _delayLine[s][i] = (float *)psram_alloc(DSP_MAX_DELAY_SAMPLES, sizeof(float), "dsp_delay");
-                    if (!_delayLine[s][i]) {
-                        // Free the other pool if first succeeded
-                        if (s == 1 && _delayLine[0][i]) {
-                            psram_free(_delayLine[0][i], "dsp_delay");
-                            _delayLine[0][i] = nullptr;
-                        }
-                        LOG_E("[DSP] Delay slot %d alloc failed (need %d bytes)",
-                              i, (int)(DSP_MAX_DELAY_SAMPLES * sizeof(float)));
-                        return -1;
-                    }
-                } else {
-                    memset(_delayLine[s][i], 0, sizeof(float) * DSP_MAX_DELAY_SAMPLES);
+            if (!_delayLine[i]) {
+                _delayLine[i] = (float *)psram_alloc(DSP_DELAY_RING_SIZE, sizeof(float), "dsp_delay");
+                if (!_delayLine[i]) {
+                    LOG_E("[DSP] Delay slot %d alloc failed (need %d bytes)",
+                          i, (int)(DSP_DELAY_RING_SIZE * sizeof(float)));
+                    return -1;
                 }
             }
+            memset(_delayLine[i], 0, sizeof(float) * DSP_DELAY_RING_SIZE);
             _delaySlotUsed[i] = true;
             return i;
         }
@@ -311,21 +425,39 @@ int dsp_delay_alloc_slot() {
 
 void dsp_delay_free_slot(int slot) {
     if (slot >= 0 && slot < DSP_MAX_DELAY_SLOTS) {
-        _delaySlotUsed[slot] = false;
-        // Free heap memory when slot is released
-        for (int s = 0; s < 2; s++) {
-            if (_delayLine[s][slot]) {
-                psram_free(_delayLine[s][slot], "dsp_delay");
-                _delayLine[s][slot] = nullptr;
-            }
-        }
+        _delaySlotUsed[slot] = false;   // Ring kept, zeroed on next alloc
     }
 }
 
-float* dsp_delay_get_line(int stateIndex, int delaySlot) {
-    if (stateIndex < 0 || stateIndex > 1 || delaySlot < 0 || delaySlot >= DSP_MAX_DELAY_SLOTS)
-        return nullptr;
-    return _delayLine[stateIndex][delaySlot];
+float* dsp_delay_get_line(int delaySlot) {
+    if (delaySlot < 0 || delaySlot >= DSP_MAX_DELAY_SLOTS) return nullptr;
+    return _delayLine[delaySlot];
+}
+
+int dsp_delay_slot_capacity() {
+    uint32_t bySize = (uint32_t)(DSP_DELAY_PSRAM_BUDGET / DELAY_SLOT_BYTES);
+    return bySize < (uint32_t)DSP_MAX_DELAY_SLOTS ? (int)bySize : DSP_MAX_DELAY_SLOTS;
+}
+
+void dsp_delay_set_fraction(DspDelayParams &p, float fraction, uint8_t interp) {
+    if (!(fraction > 0.0f)) fraction = 0.0f;          // Also catches NaN
+    if (fraction > 0.999f) fraction = 0.999f;
+    p.fraction = fraction;
+    p.interp = interp < DSP_DELAY_INTERP_COUNT ? interp : (uint8_t)DSP_DELAY_INTERP_NONE;
+    p.apState = 0.0f;
+}
+
+// Copy the history a delay stage can still read (delay + interpolator taps +
+// one chunk) from one ring to another — only needed when a stage moves to
+// another slot, and avoids copying the whole ring.
+static void _delay_copy_history(float *dst, const float *src, uint16_t writePos, uint16_t delaySamples) {
+    uint32_t n = (uint32_t)delaySamples + DSP_DELAY_INTERP_TAPS + DSP_DELAY_CHUNK;
+    if (n > DSP_DELAY_RING_SIZE) n = DSP_DELAY_RING_SIZE;
+    uint32_t start = ((uint32_t)writePos - n) & DSP_DELAY_RING_MASK;
+    uint32_t first = DSP_DELAY_RING_SIZE - start;
+    if (first > n) first = n;
+    memcpy(dst + start, src + start, first * sizeof(float));
+    if (n > first) memcpy(dst, src, (n - first) * sizeof(float));
 }
 
 // ===== Initialization =====
@@ -336,12 +468,6 @@ void dsp_init() {
     if (!_states) {
         _states = (DspState *)psram_alloc(2, sizeof(DspState), "dsp_states");
     }
-    if (!_firTapsPool) {
-        size_t tapsSize = 2 * DSP_MAX_FIR_SLOTS * DSP_MAX_FIR_TAPS;
-        size_t delaySize = 2 * DSP_MAX_FIR_SLOTS * (DSP_MAX_FIR_TAPS + 8);
-        _firTapsPool  = (float *)psram_alloc(tapsSize, sizeof(float), "dsp_fir_taps");
-        _firDelayPool = (float *)psram_alloc(delaySize, sizeof(float), "dsp_fir_delay");
-    }
     if (!_dspBufL) {
         _dspBufL = (float *)psram_alloc(256, sizeof(float), "dsp_bufs");
         _dspBufR = (float *)psram_alloc(256, sizeof(float), "dsp_bufs");
@@ -349,29 +475,17 @@ void dsp_init() {
     }
 #endif
 
+    // Both states start as the same config (same stage IDs) so the first swap
+    // migrates state stage-for-stage
     dsp_init_state(_states[0]);
-    dsp_init_state(_states[1]);
+    _states[1] = _states[0];
     dsp_init_metrics(_metrics);
     _activeIndex = 0;
 
-    // Clear FIR pool
-#ifdef NATIVE_TEST
-    memset(_firTaps, 0, sizeof(_firTaps));
-    memset(_firDelay, 0, sizeof(_firDelay));
-#else
-    if (_firTapsPool) {
-        size_t tapsBytes = 2 * DSP_MAX_FIR_SLOTS * DSP_MAX_FIR_TAPS * sizeof(float);
-        size_t delayBytes = 2 * DSP_MAX_FIR_SLOTS * (DSP_MAX_FIR_TAPS + 8) * sizeof(float);
-        memset(_firTapsPool, 0, tapsBytes);
-        memset(_firDelayPool, 0, delayBytes);
-    }
-#endif
+    // Release FIR slots (storage stays allocated, zeroed on next alloc)
     memset(_firSlotUsed, 0, sizeof(_firSlotUsed));
 
-    // Clear delay pool (pointers only — actual memory is heap-allocated on demand)
-    for (int s = 0; s < 2; s++)
-        for (int i = 0; i < DSP_MAX_DELAY_SLOTS; i++)
-            _delayLine[s][i] = nullptr;
+    // Release delay slots (rings stay allocated, zeroed on next alloc)
     memset(_delaySlotUsed, 0, sizeof(_delaySlotUsed));
 
     // Clear multiband compressor pool
@@ -382,13 +496,28 @@ void dsp_init() {
 #endif
     memset(_mbSlotUsed, 0, sizeof(_mbSlotUsed));
 
+    // Release true-peak and multirate slots (states stay allocated, reset on next alloc)
+    memset(_tpSlotUsed, 0, sizeof(_tpSlotUsed));
+    memset(_mrSlotUsed, 0, sizeof(_mrSlotUsed));
+
+    // Compiled channel programs for both states
+    _program_alloc();
+    _program_build(0);
+    _program_build(1);
+    _gov_reset();
+
     // Initialize swap synchronization mutex
 #ifndef NATIVE_TEST
     if (!_swapMutex) {
         _swapMutex = xSemaphoreCreateMutex();
     }
 #endif
-    _swapRequested = false;
+    _processingActive = false;
+    _writerFlip = false;
+    _pendingIndex = DSP_RCU_NONE;
+    _publishEpoch = 0;
+    _ackEpoch = 0;
+    _lastBlockUs = 0;
 
     LOG_I("[DSP] Pipeline initialized (double-buffered, %d channels, max %d stages/ch)",
           DSP_MAX_CHANNELS, DSP_MAX_STAGES);
@@ -404,7 +533,14 @@ DspState *dsp_get_inactive_config() {
     return &_states[1 - _activeIndex];
 }
 
-void dsp_copy_active_to_inactive() {
+bool dsp_copy_active_to_inactive() {
+    // A flip the last swap left in flight is still migrating and compiling the
+    // inactive side to make it live — overwriting it would tear that config
+    if (!_rcu_settle(_rcu_now_us(), _rcu_budget())) {
+        LOG_W("[DSP] Config copy refused: previous publish still in flight after %lu us",
+              (unsigned long)_rcu_budget());
+        return false;
+    }
     int activeIdx = _activeIndex;
     int inactiveIdx = 1 - activeIdx;
 
@@ -416,24 +552,301 @@ void dsp_copy_active_to_inactive() {
         if (_firSlotUsed[s]) {
             float *srcTaps = dsp_fir_get_taps(activeIdx, s);
             float *dstTaps = dsp_fir_get_taps(inactiveIdx, s);
-            float *srcDelay = dsp_fir_get_delay(activeIdx, s);
-            float *dstDelay = dsp_fir_get_delay(inactiveIdx, s);
             if (srcTaps && dstTaps)
                 memcpy(dstTaps, srcTaps, sizeof(float) * DSP_MAX_FIR_TAPS);
-            if (srcDelay && dstDelay)
-                memcpy(dstDelay, srcDelay, sizeof(float) * (DSP_MAX_FIR_TAPS + 8));
         }
     }
+    // Delay rings are shared by both configs — nothing to copy
+    return true;
+}
+
+// Carry runtime state (filter history, envelopes, ramps) from a stage in the
+// outgoing config to its counterpart in the incoming one.
+static void _migrate_stage(DspStage &oldS, DspStage &newS) {
+    if (dsp_is_biquad_type(newS.type)) {
+        newS.biquad.delay[0] = oldS.biquad.delay[0];
+        newS.biquad.delay[1] = oldS.biquad.delay[1];
+        // Detect coefficient changes — initiate morphing to avoid pops
+        bool coeffChanged = false;
+        for (int c = 0; c < 5; c++) {
+            if (newS.biquad.coeffs[c] != oldS.biquad.coeffs[c]) {
+                coeffChanged = true;
+                break;
+            }
+        }
+        if (coeffChanged) {
+            // Store new coefficients as target, start from old coefficients
+            for (int c = 0; c < 5; c++) {
+                newS.biquad.targetCoeffs[c] = newS.biquad.coeffs[c];
+                newS.biquad.coeffs[c] = oldS.biquad.coeffs[c];
+            }
+            newS.biquad.morphRemaining = 64; // ~1.3ms at 48kHz
+        } else {
+            newS.biquad.morphRemaining = 0;
+        }
+    } else if (newS.type == DSP_FIR) {
+        // History lives in the slot's DspFirRun, shared by both configs
+        newS.fir.mode = oldS.fir.mode;
+        newS.fir.cpuPercent = oldS.fir.cpuPercent;
+    } else if (newS.type == DSP_LIMITER) {
+        newS.limiter.envelope = oldS.limiter.envelope;
+        newS.limiter.gainReduction = oldS.limiter.gainReduction;
+    } else if (newS.type == DSP_DELAY && oldS.delay.delaySlot >= 0 && newS.delay.delaySlot >= 0
+               && _delayLine[newS.delay.delaySlot] && _delayLine[oldS.delay.delaySlot]) {
+        // History lives in the slot's ring, shared by both configs
+        if (newS.delay.delaySlot != oldS.delay.delaySlot) {
+            uint16_t reach = newS.delay.delaySamples > oldS.delay.delaySamples
+                           ? newS.delay.delaySamples : oldS.delay.delaySamples;
+            _delay_copy_history(_delayLine[newS.delay.delaySlot], _delayLine[oldS.delay.delaySlot],
+                                oldS.delay.writePos, reach);
+        }
+        newS.delay.writePos = oldS.delay.writePos;
+        if (newS.delay.interp == oldS.delay.interp) newS.delay.apState = oldS.delay.apState;
+    } else if (newS.type == DSP_GAIN) {
+        newS.gain.currentLinear = oldS.gain.currentLinear;
+    } else if (newS.type == DSP_COMPRESSOR) {
+        newS.compressor.envelope = oldS.compressor.envelope;
+        newS.compressor.gainReduction = oldS.compressor.gainReduction;
+    } else if (newS.type == DSP_NOISE_GATE) {
+        newS.noiseGate.envelope = oldS.noiseGate.envelope;
+        newS.noiseGate.gainReduction = oldS.noiseGate.gainReduction;
+        newS.noiseGate.holdCounter = oldS.noiseGate.holdCounter;
+    } else if (newS.type == DSP_TONE_CTRL) {
+        memcpy(newS.toneCtrl.bassDelay, oldS.toneCtrl.bassDelay, sizeof(float) * 2);
+        memcpy(newS.toneCtrl.midDelay, oldS.toneCtrl.midDelay, sizeof(float) * 2);
+        memcpy(newS.toneCtrl.trebleDelay, oldS.toneCtrl.trebleDelay, sizeof(float) * 2);
+    } else if (newS.type == DSP_LOUDNESS) {
+        memcpy(newS.loudness.bassDelay, oldS.loudness.bassDelay, sizeof(float) * 2);
+        memcpy(newS.loudness.trebleDelay, oldS.loudness.trebleDelay, sizeof(float) * 2);
+    } else if (newS.type == DSP_BASS_ENHANCE) {
+        memcpy(newS.bassEnhance.hpfDelay, oldS.bassEnhance.hpfDelay, sizeof(float) * 2);
+        memcpy(newS.bassEnhance.bpfDelay, oldS.bassEnhance.bpfDelay, sizeof(float) * 2);
+    } else if (newS.type == DSP_TRUE_PEAK_LIMITER) {
+        // Detector and lookahead live in the shared pool slot
+        newS.truePeak.gainReduction = oldS.truePeak.gainReduction;
+    }
+}
+
+static bool _channel_has_id(const DspChannelConfig &ch, uint16_t id) {
+    for (int i = 0; i < ch.stageCount; i++) {
+        if (ch.stages[i].id == id) return true;
+    }
+    return false;
+}
+
+// Match stages by stable ID within each channel so inserts, removals and
+// reorders keep the right history attached. A stage with no ID match (e.g. a
+// freshly imported chain) inherits from the stage at the same index, provided
+// that stage is not carried over elsewhere. Runs on whichever side performs
+// the flip (normally the audio task), before the new config is processed.
+static void _migrate_state(int oldIdx, int newIdx) {
+    for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+        DspChannelConfig &oldCh = _states[oldIdx].channels[ch];
+        DspChannelConfig &newCh = _states[newIdx].channels[ch];
+        for (int s = 0; s < newCh.stageCount; s++) {
+            DspStage &newS = newCh.stages[s];
+            // Fast path: unchanged layout keeps the stage at the same index
+            DspStage *oldS = nullptr;
+            if (s < oldCh.stageCount && oldCh.stages[s].id == newS.id) {
+                oldS = &oldCh.stages[s];
+            } else {
+                for (int o = 0; o < oldCh.stageCount; o++) {
+                    if (oldCh.stages[o].id == newS.id) { oldS = &oldCh.stages[o]; break; }
+                }
+                if (!oldS && s < oldCh.stageCount && !_channel_has_id(newCh, oldCh.stages[s].id)) {
+                    oldS = &oldCh.stages[s];
+                }
+            }
+            if (oldS && oldS->type == newS.type) _migrate_stage(*oldS, newS);
+        }
+    }
+}
+
+// Flip to the pending config. Caller holds the config (audio block or writer
+// flip) and has claimed _pendingIndex.
+static void _rcu_flip(int newIdx) {
+    _migrate_state(_activeIndex, newIdx);
+    _program_build(newIdx);
+    _gov_carry_costs(_activeIndex, newIdx);
+    _gov_apply(newIdx);
+    _activeIndex = newIdx;
+    _ackEpoch.store(_publishEpoch.load());
+    _pendingIndex.store(DSP_RCU_NONE);
+}
+
+static inline uint32_t _rcu_now_us() {
+#ifndef NATIVE_TEST
+    return (uint32_t)esp_timer_get_time();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Yield without sleeping past the writer's deadline (a tick may be longer
+// than what is left of the block period)
+static inline void _rcu_yield(uint32_t start, uint32_t budget) {
+#ifndef NATIVE_TEST
+    uint32_t elapsed = _rcu_now_us() - start;
+    if (elapsed + portTICK_PERIOD_MS * 1000u < budget) vTaskDelay(1);
+    else taskYIELD();
+#else
+    // Sleep like the target's one-tick delay while the deadline is far off,
+    // so a waiting writer does not busy-spin the audio thread's core
+    uint32_t elapsed = _rcu_now_us() - start;
+    if (elapsed + 200u < budget) std::this_thread::sleep_for(std::chrono::microseconds(50));
+    else std::this_thread::yield();
+#endif
+}
+
+// Writer side: wait until no audio-side flip is in flight, at most until
+// `budget` us after `start`. Returns false if one is still in progress.
+static bool _rcu_settle(uint32_t start, uint32_t budget) {
+    while (_pendingIndex.load() == DSP_RCU_CLAIMED) {
+        if ((_rcu_now_us() - start) >= budget) return false;
+        _rcu_yield(start, budget);
+    }
+    return true;
+}
+
+// Writer wait budget: one block period less the time a writer-side flip
+// (state migration + program build) may still take after it expires
+static inline uint32_t _rcu_budget() {
+    uint32_t period = _blockPeriodUs;
+    return period - period / 8;
+}
+
+// Audio side, top of every block. Returns the config index to process, or -1
+// when a writer is flipping right now and this block must be skipped.
+static int _rcu_enter(bool syncPoint, int frames) {
+    _processingActive.store(true);
+    if (_writerFlip.load()) {
+        _processingActive.store(false);
+        audio_pipeline_notify_dsp_swap();
+        return -1;
+    }
+    if (syncPoint) {
+        int p = _pendingIndex.load();
+        if (p >= 0 && _pendingIndex.compare_exchange_strong(p, DSP_RCU_CLAIMED)) _rcu_flip(p);
+        uint32_t sr = _states[_activeIndex].sampleRate;
+        if (sr > 0) _blockPeriodUs = (uint32_t)((uint64_t)frames * 1000000u / sr);
+        _lastBlockUs = _rcu_now_us() | 1u;
+    }
+    return _activeIndex;
+}
+
+static inline void _rcu_exit() {
+    _processingActive.store(false);
+}
+
+// Writer side: flip on behalf of an idle audio task. Fails if the audio task
+// is inside a block or has already claimed the publish.
+static bool _rcu_writer_flip(int newIdx) {
+    _writerFlip.store(true);
+    bool flipped = false;
+    if (!_processingActive.load()) {
+        int expect = newIdx;
+        if (_pendingIndex.compare_exchange_strong(expect, DSP_RCU_CLAIMED)) {
+            _rcu_flip(newIdx);
+            flipped = true;
+        }
+    }
+    _writerFlip.store(false);
+    return flipped;
+}
+
+uint32_t dsp_get_config_epoch() {
+    return _ackEpoch.load();
+}
+
+bool dsp_swap_in_flight() {
+    return _pendingIndex.load() == DSP_RCU_CLAIMED;
+}
 
-    // Copy delay pool data for used slots (both pointers must be valid)
-    for (int s = 0; s < DSP_MAX_DELAY_SLOTS; s++) {
-        if (_delaySlotUsed[s] && _delayLine[activeIdx][s] && _delayLine[inactiveIdx][s]) {
-            memcpy(_delayLine[inactiveIdx][s], _delayLine[activeIdx][s],
-                   sizeof(float) * DSP_MAX_DELAY_SAMPLES);
+// ===== Multirate Rates & Latency =====
+
+// Recompute rate-dependent coefficients for a stage running at `rate`
+static void _stage_compute_rate_coeffs(DspStage &s, uint32_t rate) {
+    if (dsp_is_biquad_type(s.type)) {
+        if (s.type != DSP_BIQUAD_CUSTOM) dsp_compute_biquad_coeffs(s.biquad, s.type, rate);
+    } else if (s.type == DSP_TONE_CTRL) {
+        dsp_compute_tone_ctrl_coeffs(s.toneCtrl, rate);
+    } else if (s.type == DSP_LOUDNESS) {
+        dsp_compute_loudness_coeffs(s.loudness, rate);
+    } else if (s.type == DSP_BASS_ENHANCE) {
+        dsp_compute_bass_enhance_coeffs(s.bassEnhance, rate);
+    }
+}
+
+// Edit paths compute coefficients at the pipeline rate. Before a config is
+// published, stages inside a multirate section are recomputed at the section
+// rate, and stages that left a section are restored to the pipeline rate.
+// Time constants need no fix-up: they are derived from the rate each block.
+static void _mr_sync_rates(DspState &st) {
+    for (int c = 0; c < DSP_MAX_CHANNELS; c++) {
+        DspChannelConfig &ch = st.channels[c];
+        uint8_t div = 1;
+        for (int i = 0; i < ch.stageCount; i++) {
+            DspStage &s = ch.stages[i];
+            if (s.enabled && s.type == DSP_DECIMATOR) {
+                if (div == 1 && dsp_mr_stages_for(s.decimator.factor)) div = s.decimator.factor;
+                continue;
+            }
+            if (s.enabled && s.type == DSP_INTERPOLATOR) {
+                div = 1;
+                continue;
+            }
+            if (div == 1 && s.rateDiv <= 1) continue;
+            _stage_compute_rate_coeffs(s, st.sampleRate / div);
+            s.rateDiv = div;
         }
     }
 }
 
+bool dsp_prepare_sample_rate(uint32_t rate) {
+    if (!dsp_copy_active_to_inactive()) return false;
+    DspState &st = _states[1 - _activeIndex];
+    st.sampleRate = rate;
+    for (int c = 0; c < DSP_MAX_CHANNELS; c++) {
+        DspChannelConfig &ch = st.channels[c];
+        for (int i = 0; i < ch.stageCount; i++) {
+            _stage_compute_rate_coeffs(ch.stages[i], rate);
+            ch.stages[i].rateDiv = 1;
+        }
+    }
+    return true;
+}
+
+// Latency a channel adds at the pipeline rate: multirate round trips plus
+// true-peak lookahead (scaled up when the limiter runs inside a section)
+static int _channel_latency(const DspChannelConfig &ch, uint32_t sampleRate) {
+    if (ch.bypass || sampleRate == 0) return 0;
+    int total = 0;
+    int div = 1;
+    for (int i = 0; i < ch.stageCount; i++) {
+        const DspStage &s = ch.stages[i];
+        if (!s.enabled) continue;
+        if (s.type == DSP_DECIMATOR) {
+            if (div == 1 && s.decimator.mrSlot >= 0 && dsp_mr_stages_for(s.decimator.factor)) {
+                div = s.decimator.factor;
+                total += dsp_mr_latency_samples(div);
+            }
+        } else if (s.type == DSP_INTERPOLATOR) {
+            div = 1;
+        } else if (s.type == DSP_TRUE_PEAK_LIMITER && s.truePeak.tpSlot >= 0) {
+            int l = dsp_tp_lookahead_samples(s.truePeak.lookaheadMs, sampleRate / div);
+            total += (l - 1 + DSP_TP_OS_DELAY) * div;
+        }
+    }
+    return total;
+}
+
+int dsp_get_channel_latency_samples(int channel) {
+    if (channel < 0 || channel >= DSP_MAX_CHANNELS) return 0;
+    DspState *cfg = dsp_get_active_config();
+    return _channel_latency(cfg->channels[channel], cfg->sampleRate);
+}
+
 bool dsp_swap_config() {
     // Try to acquire mutex (5ms timeout) to prevent concurrent swaps
 #ifndef NATIVE_TEST
@@ -445,31 +858,15 @@ bool dsp_swap_config() {
     }
 #endif
 
-    int oldActive = _activeIndex;
-    int newActive = 1 - oldActive;
-
-    // Arm pipeline hold buffer: next pipeline_write_output() uses last good PSRAM frame
-    // instead of the DSP-skipped/zeroed buffer — prevents audible click during swap.
-    audio_pipeline_notify_dsp_swap();
-
-    // Set swap request flag for multi-ADC synchronization
-    _swapRequested = true;
-
-    // Wait for processing to finish (increased timeout: 100ms)
     unsigned long swapWaitStart = (unsigned long)esp_timer_get_time();
-    int waitCount = 0;
-    while (_processingActive && waitCount < 100) {
-#ifndef NATIVE_TEST
-        vTaskDelay(1);  // yield ~1ms
-#endif
-        waitCount++;
-    }
-    _metrics.swapLatencyUs = (uint32_t)((unsigned long)esp_timer_get_time() - swapWaitStart);
-
-    // Check for timeout
-    if (_processingActive) {
-        LOG_E("[DSP] Swap timeout after 100ms (audio task busy)");
-        _swapRequested = false;
+    uint32_t start = _rcu_now_us();
+    uint32_t period = _blockPeriodUs;
+    uint32_t budget = _rcu_budget();
+
+    // The whole publish, including settling the previous one, fits one period
+    if (!_rcu_settle(start, budget)) {
+        _metrics.swapLatencyUs = (uint32_t)((unsigned long)esp_timer_get_time() - swapWaitStart);
+        LOG_E("[DSP] Swap failed: previous publish still in flight");
 #ifndef NATIVE_TEST
         if (_swapMutex) xSemaphoreGive(_swapMutex);
 #endif
@@ -478,89 +875,54 @@ bool dsp_swap_config() {
         return false;
     }
 
-    // Copy delay lines from old active → new active to avoid audio discontinuity
-    for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
-        DspChannelConfig &oldCh = _states[oldActive].channels[ch];
-        DspChannelConfig &newCh = _states[newActive].channels[ch];
-
-        int minStages = oldCh.stageCount < newCh.stageCount ? oldCh.stageCount : newCh.stageCount;
-        for (int s = 0; s < minStages; s++) {
-            DspStage &oldS = oldCh.stages[s];
-            DspStage &newS = newCh.stages[s];
-
-            if (oldS.type == newS.type) {
-                if (dsp_is_biquad_type(newS.type)) {
-                    newS.biquad.delay[0] = oldS.biquad.delay[0];
-                    newS.biquad.delay[1] = oldS.biquad.delay[1];
-                    // Detect coefficient changes — initiate morphing to avoid pops
-                    bool coeffChanged = false;
-                    for (int c = 0; c < 5; c++) {
-                        if (newS.biquad.coeffs[c] != oldS.biquad.coeffs[c]) {
-                            coeffChanged = true;
-                            break;
-                        }
-                    }
-                    if (coeffChanged) {
-                        // Store new coefficients as target, start from old coefficients
-                        for (int c = 0; c < 5; c++) {
-                            newS.biquad.targetCoeffs[c] = newS.biquad.coeffs[c];
-                            newS.biquad.coeffs[c] = oldS.biquad.coeffs[c];
-                        }
-                        newS.biquad.morphRemaining = 64; // ~1.3ms at 48kHz
-                    } else {
-                        newS.biquad.morphRemaining = 0;
-                    }
-                } else if (newS.type == DSP_FIR && oldS.fir.firSlot >= 0 && newS.fir.firSlot >= 0) {
-                    float *srcD = dsp_fir_get_delay(oldActive, oldS.fir.firSlot);
-                    float *dstD = dsp_fir_get_delay(newActive, newS.fir.firSlot);
-                    if (srcD && dstD)
-                        memcpy(dstD, srcD, sizeof(float) * (DSP_MAX_FIR_TAPS + 8));
-                    newS.fir.delayPos = oldS.fir.delayPos;
-                } else if (newS.type == DSP_LIMITER) {
-                    newS.limiter.envelope = oldS.limiter.envelope;
-                    newS.limiter.gainReduction = oldS.limiter.gainReduction;
-                } else if (newS.type == DSP_DELAY && oldS.delay.delaySlot >= 0 && newS.delay.delaySlot >= 0
-                           && _delayLine[newActive][newS.delay.delaySlot]
-                           && _delayLine[oldActive][oldS.delay.delaySlot]) {
-                    memcpy(_delayLine[newActive][newS.delay.delaySlot],
-                           _delayLine[oldActive][oldS.delay.delaySlot],
-                           sizeof(float) * DSP_MAX_DELAY_SAMPLES);
-                    newS.delay.writePos = oldS.delay.writePos;
-                } else if (newS.type == DSP_GAIN) {
-                    newS.gain.currentLinear = oldS.gain.currentLinear;
-                } else if (newS.type == DSP_COMPRESSOR) {
-                    newS.compressor.envelope = oldS.compressor.envelope;
-                    newS.compressor.gainReduction = oldS.compressor.gainReduction;
-                } else if (newS.type == DSP_DECIMATOR && oldS.decimator.firSlot >= 0 && newS.decimator.firSlot >= 0) {
-                    float *srcD = dsp_fir_get_delay(oldActive, oldS.decimator.firSlot);
-                    float *dstD = dsp_fir_get_delay(newActive, newS.decimator.firSlot);
-                    if (srcD && dstD)
-                        memcpy(dstD, srcD, sizeof(float) * (DSP_MAX_FIR_TAPS + 8));
-                    newS.decimator.delayPos = oldS.decimator.delayPos;
-                } else if (newS.type == DSP_NOISE_GATE) {
-                    newS.noiseGate.envelope = oldS.noiseGate.envelope;
-                    newS.noiseGate.gainReduction = oldS.noiseGate.gainReduction;
-                    newS.noiseGate.holdCounter = oldS.noiseGate.holdCounter;
-                } else if (newS.type == DSP_TONE_CTRL) {
-                    memcpy(newS.toneCtrl.bassDelay, oldS.toneCtrl.bassDelay, sizeof(float) * 2);
-                    memcpy(newS.toneCtrl.midDelay, oldS.toneCtrl.midDelay, sizeof(float) * 2);
-                    memcpy(newS.toneCtrl.trebleDelay, oldS.toneCtrl.trebleDelay, sizeof(float) * 2);
-                } else if (newS.type == DSP_LOUDNESS) {
-                    memcpy(newS.loudness.bassDelay, oldS.loudness.bassDelay, sizeof(float) * 2);
-                    memcpy(newS.loudness.trebleDelay, oldS.loudness.trebleDelay, sizeof(float) * 2);
-                } else if (newS.type == DSP_BASS_ENHANCE) {
-                    memcpy(newS.bassEnhance.hpfDelay, oldS.bassEnhance.hpfDelay, sizeof(float) * 2);
-                    memcpy(newS.bassEnhance.bpfDelay, oldS.bassEnhance.bpfDelay, sizeof(float) * 2);
-                }
+    int newActive = 1 - _activeIndex;
+    _mr_sync_rates(_states[newActive]);
+    uint32_t last = _lastBlockUs;
+    // Audio task counts as live if it started a block within the last two periods
+    bool audioLive = last != 0 && (start - last) < 2 * period;
+
+    uint32_t epoch = _publishEpoch.load() + 1;
+    _publishEpoch.store(epoch);
+    _pendingIndex.store(newActive);
+
+    // Wait at most one block period for the audio task to pick it up
+    bool acked = false;
+    for (;;) {
+        if (_ackEpoch.load() == epoch) { acked = true; break; }
+        bool expired = (_rcu_now_us() - start) >= budget;
+        if ((!audioLive || expired) && _rcu_writer_flip(newActive)) { acked = true; break; }
+        if (expired) break;
+        _rcu_yield(start, budget);
+    }
+
+    if (!acked) {
+        // Withdraw — unless the audio task claimed it meanwhile, in which case the
+        // flip is already in progress on the audio side. Success is only reported
+        // on the ack; the rest of the period (the flip's reserve) is spent on it.
+        int expect = newActive;
+        bool withdrawn = _pendingIndex.compare_exchange_strong(expect, DSP_RCU_NONE);
+        if (!withdrawn) {
+            while (!(acked = _ackEpoch.load() == epoch) && (_rcu_now_us() - start) < period) {
+                _rcu_yield(start, period);
             }
         }
+        if (!acked) {
+            _metrics.swapLatencyUs = (uint32_t)((unsigned long)esp_timer_get_time() - swapWaitStart);
+            if (withdrawn) LOG_E("[DSP] Swap not acknowledged within %lu us (audio task busy)", (unsigned long)budget);
+            else LOG_E("[DSP] Swap still being adopted after %lu us", (unsigned long)period);
+#ifndef NATIVE_TEST
+            if (_swapMutex) xSemaphoreGive(_swapMutex);
+#endif
+            AppState::getInstance().dsp.swapFailures++;
+            AppState::getInstance().dsp.lastSwapFailure = millis();
+            return false;
+        }
+    }
+    _metrics.swapLatencyUs = (uint32_t)((unsigned long)esp_timer_get_time() - swapWaitStart);
+    for (int c = 0; c < DSP_MAX_CHANNELS; c++) {
+        _metrics.latencySamples[c] = (uint16_t)_channel_latency(_states[newActive].channels[c],
+                                                                _states[newActive].sampleRate);
     }
-
-    // Atomic swap
-    _activeIndex = newActive;
-
-    // Clear swap request flag
-    _swapRequested = false;
 
     // Release mutex
 #ifndef NATIVE_TEST
@@ -570,7 +932,7 @@ bool dsp_swap_config() {
     // Update success counter
     AppState::getInstance().dsp.swapSuccesses++;
 
-    LOG_I("[DSP] Config swapped (active=%d)", newActive);
+    LOG_I("[DSP] Config swapped (active=%d, epoch=%lu)", newActive, (unsigned long)epoch);
     return true;
 }
 
@@ -594,6 +956,7 @@ void dsp_clear_cpu_load() {
 // This allows unit tests to verify threshold behaviour without needing two-value timer mocks.
 void dsp_test_set_cpu_load(float loadPercent) {
     _metrics.cpuLoadPercent = loadPercent;
+    _govLoad += loadPercent;
     static bool prevCpuWarning  = false;
     static bool prevCpuCritical = false;
     _metrics.cpuWarning  = (_metrics.cpuLoadPercent >= DSP_CPU_WARN_PERCENT);
@@ -620,19 +983,16 @@ void dsp_process_buffer(int32_t *buffer, int stereoFrames, int adcIndex) {
     unsigned long startUs = esp_timer_get_time();
 #endif
 
-    // Check for pending swap request BEFORE processing (allows swap between ADC buffers)
-    if (_swapRequested && adcIndex == 0) {
-        // Skip this ADC0 buffer to allow swap to complete between ADC0 and ADC1
-        return;
-    }
-
-    _processingActive = true;
-    int stateIdx = _activeIndex;
+    // Pick up a published config at the top of the ADC0 block so both ADCs of
+    // one period see the same config
+    int stateIdx = _rcu_enter(adcIndex == 0, stereoFrames);
+    if (stateIdx < 0) return;
+    if (adcIndex == 0) _gov_period(stateIdx);
     DspState *cfg = &_states[stateIdx];
     if (cfg->globalBypass) {
         _metrics.processTimeUs = 0;
         _metrics.cpuLoadPercent = 0.0f;
-        _processingActive = false;
+        _rcu_exit();
         return;
     }
 
@@ -640,7 +1000,7 @@ void dsp_process_buffer(int32_t *buffer, int stereoFrames, int adcIndex) {
     int chL = adcIndex * 2;
     int chR = adcIndex * 2 + 1;
     if (chL >= DSP_MAX_CHANNELS || chR >= DSP_MAX_CHANNELS) {
-        _processingActive = false;
+        _rcu_exit();
         return;
     }
 
@@ -650,29 +1010,11 @@ void dsp_process_buffer(int32_t *buffer, int stereoFrames, int adcIndex) {
         _dspBufR[f] = (float)buffer[f * 2 + 1] / MAX_24BIT_F;
     }
 
-    // Reset per-frame FIR bypass counter before channel processing
+    // Reset per-frame shed counter before channel processing
     _metrics.firBypassCount = 0;
 
-    // Process each channel
-    dsp_process_channel(_dspBufL, stereoFrames, cfg->channels[chL], stateIdx);
-    dsp_process_channel(_dspBufR, stereoFrames, cfg->channels[chR], stateIdx);
-
-    // Apply stereo width (mid-side processing) — operates on L+R pair, placed on L channel
-    DspChannelConfig &chLeft = cfg->channels[chL];
-    for (int i = 0; i < chLeft.stageCount; i++) {
-        DspStage &s = chLeft.stages[i];
-        if (s.enabled && s.type == DSP_STEREO_WIDTH) {
-            float widthScale = s.stereoWidth.width / 100.0f;
-            float centerGain = s.stereoWidth.centerGainLin;
-            for (int f = 0; f < stereoFrames; f++) {
-                float mid  = (_dspBufL[f] + _dspBufR[f]) * 0.5f * centerGain;
-                float side = (_dspBufL[f] - _dspBufR[f]) * 0.5f * widthScale;
-                _dspBufL[f] = mid + side;
-                _dspBufR[f] = mid - side;
-            }
-            break; // Only one stereo width stage per pair
-        }
-    }
+    // Run the lane's compiled program (stereo width and GR metrics included)
+    _program_process(stateIdx, adcIndex, _dspBufL, _dspBufR, stereoFrames);
 
     // Re-interleave float → int32 with clamp
     for (int f = 0; f < stereoFrames; f++) {
@@ -699,6 +1041,7 @@ void dsp_process_buffer(int32_t *buffer, int stereoFrames, int adcIndex) {
     if (bufferPeriodUs > 0.0f) {
         _metrics.cpuLoadPercent = (float)elapsed / bufferPeriodUs * 100.0f;
     }
+    _govLoad += _metrics.cpuLoadPercent;   // Blocks of one period add up
 
     // CPU threshold edge detection — set dirty flags for main loop to emit diagnostics.
     // No logging here: this runs on Core 1 (audio task).
@@ -717,22 +1060,7 @@ void dsp_process_buffer(int32_t *buffer, int stereoFrames, int adcIndex) {
         }
     }
 
-    // Collect limiter/compressor/gate GR from active channels (worst = most reduction)
-    for (int c = chL; c <= chR; c++) {
-        _metrics.limiterGrDb[c] = 0.0f;
-        DspChannelConfig &ch = cfg->channels[c];
-        for (int s = 0; s < ch.stageCount; s++) {
-            if (ch.stages[s].enabled) {
-                float gr = 0.0f;
-                if (ch.stages[s].type == DSP_LIMITER) gr = ch.stages[s].limiter.gainReduction;
-                else if (ch.stages[s].type == DSP_COMPRESSOR) gr = ch.stages[s].compressor.gainReduction;
-                else if (ch.stages[s].type == DSP_NOISE_GATE) gr = ch.stages[s].noiseGate.gainReduction;
-                if (gr < _metrics.limiterGrDb[c]) _metrics.limiterGrDb[c] = gr;
-            }
-        }
-    }
-
-    _processingActive = false;
+    _rcu_exit();
 }
 
 // Float-native DSP entry point — operates directly on float L/R buffers
@@ -746,50 +1074,31 @@ void dsp_process_buffer_float(float *left, float *right, int frames, int lane) {
     unsigned long startUs = esp_timer_get_time();
 #endif
 
-    // Sync point: config swap only triggers on lane 0 (always present, deterministic).
-    // This prevents mid-swap corruption when processing multiple lanes.
-    if (_swapRequested && lane == 0) return;
-
-    _processingActive = true;
-    int stateIdx = _activeIndex;
+    // Sync point: a published config is picked up on lane 0 only (always present,
+    // deterministic), so every lane of one period runs the same config.
+    int stateIdx = _rcu_enter(lane == 0, frames);
+    if (stateIdx < 0) return;
+    if (lane == 0) _gov_period(stateIdx);
     DspState *cfg = &_states[stateIdx];
     if (cfg->globalBypass) {
         _metrics.processTimeUs = 0;
         _metrics.cpuLoadPercent = 0.0f;
-        _processingActive = false;
+        _rcu_exit();
         return;
     }
 
     int chL = lane * 2;
     int chR = lane * 2 + 1;
     if (chL >= DSP_MAX_CHANNELS || chR >= DSP_MAX_CHANNELS) {
-        _processingActive = false;
+        _rcu_exit();
         return;
     }
 
-    // Reset per-frame FIR bypass counter before channel processing
+    // Reset per-frame shed counter before channel processing
     _metrics.firBypassCount = 0;
 
-    // Process each channel directly on the caller's buffers
-    dsp_process_channel(left, frames, cfg->channels[chL], stateIdx);
-    dsp_process_channel(right, frames, cfg->channels[chR], stateIdx);
-
-    // Stereo width (mid-side)
-    DspChannelConfig &chLeft = cfg->channels[chL];
-    for (int i = 0; i < chLeft.stageCount; i++) {
-        DspStage &s = chLeft.stages[i];
-        if (s.enabled && s.type == DSP_STEREO_WIDTH) {
-            float widthScale = s.stereoWidth.width / 100.0f;
-            float centerGain = s.stereoWidth.centerGainLin;
-            for (int f = 0; f < frames; f++) {
-                float mid  = (left[f] + right[f]) * 0.5f * centerGain;
-                float side = (left[f] - right[f]) * 0.5f * widthScale;
-                left[f] = mid + side;
-                right[f] = mid - side;
-            }
-            break;
-        }
-    }
+    // Run the lane's compiled program directly on the caller's buffers
+    _program_process(stateIdx, lane, left, right, frames);
 
     // Clamp to [-1.0, 1.0]
     for (int f = 0; f < frames; f++) {
@@ -811,6 +1120,7 @@ void dsp_process_buffer_float(float *left, float *right, int frames, int lane) {
     if (bufferPeriodUs > 0.0f) {
         _metrics.cpuLoadPercent = (float)elapsed / bufferPeriodUs * 100.0f;
     }
+    _govLoad += _metrics.cpuLoadPercent;   // Blocks of one period add up
 
     // CPU threshold edge detection — set dirty flags for main loop to emit diagnostics.
     // No logging here: this runs on Core 1 (audio task).
@@ -829,544 +1139,797 @@ void dsp_process_buffer_float(float *left, float *right, int frames, int lane) {
         }
     }
 
-    // Collect GR metrics
-    for (int c = chL; c <= chR; c++) {
-        _metrics.limiterGrDb[c] = 0.0f;
-        DspChannelConfig &ch = cfg->channels[c];
-        for (int s = 0; s < ch.stageCount; s++) {
-            if (ch.stages[s].enabled) {
-                float gr = 0.0f;
-                if (ch.stages[s].type == DSP_LIMITER) gr = ch.stages[s].limiter.gainReduction;
-                else if (ch.stages[s].type == DSP_COMPRESSOR) gr = ch.stages[s].compressor.gainReduction;
-                else if (ch.stages[s].type == DSP_NOISE_GATE) gr = ch.stages[s].noiseGate.gainReduction;
-                if (gr < _metrics.limiterGrDb[c]) _metrics.limiterGrDb[c] = gr;
-            }
-        }
-    }
-
-    _processingActive = false;
+    _rcu_exit();
 }
 
-// ===== Per-Channel Processing =====
-
-static int dsp_process_channel(float *buf, int len, DspChannelConfig &ch, int stateIdx) {
-    if (ch.bypass) return len;
-
-    DspState *cfg = &_states[stateIdx];
-    int curLen = len;
-
-    for (int i = 0; i < ch.stageCount; i++) {
-        DspStage &s = ch.stages[i];
-        if (!s.enabled) continue;
-
-        if (dsp_is_biquad_type(s.type)) {
-            if (s.biquad.morphRemaining > 0) {
-                // Coefficient morphing: interpolate coeffs over remaining samples
-                int remaining = s.biquad.morphRemaining;
-                int processed = 0;
-                while (processed < curLen && remaining > 0) {
-                    // Interpolate coefficients
-                    float t = 1.0f - (float)remaining / 64.0f;
-                    float interpCoeffs[5];
-                    for (int c = 0; c < 5; c++) {
-                        interpCoeffs[c] = s.biquad.coeffs[c] + t * (s.biquad.targetCoeffs[c] - s.biquad.coeffs[c]);
-                    }
-                    // Process 8 samples at a time for efficiency
-                    int chunk = curLen - processed;
-                    if (chunk > 8) chunk = 8;
-                    if (chunk > remaining) chunk = remaining;
-                    dsps_biquad_f32(buf + processed, buf + processed, chunk, interpCoeffs, s.biquad.delay);
-                    processed += chunk;
-                    remaining -= chunk;
-                }
-                if (remaining <= 0) {
-                    // Morph complete — snap to target coefficients
-                    for (int c = 0; c < 5; c++) {
-                        s.biquad.coeffs[c] = s.biquad.targetCoeffs[c];
-                    }
-                    s.biquad.morphRemaining = 0;
-                    // Process any remaining samples with final coefficients
-                    if (processed < curLen) {
-                        dsps_biquad_f32(buf + processed, buf + processed, curLen - processed, s.biquad.coeffs, s.biquad.delay);
-                    }
-                } else {
-                    s.biquad.morphRemaining = (uint16_t)remaining;
-                }
-            } else {
-                dsps_biquad_f32(buf, buf, curLen, s.biquad.coeffs, s.biquad.delay);
-            }
-            continue;
-        }
-
-        // Under critical CPU load, skip FIR/convolution stages (expensive).
-        // Count bypassed stages for telemetry; no logging — this runs on Core 1.
-        if (_metrics.cpuCritical &&
-            (s.type == DSP_FIR || s.type == DSP_CONVOLUTION)) {
-            if (_metrics.firBypassCount < 0xFF) _metrics.firBypassCount++;
-            continue;
-        }
+// ===== Fused Biquad Runs =====
+// Consecutive biquad sections of a channel form a run: biquad stages, the
+// shelves of tone control and loudness stages, and anything the program
+// compiler removed in between (disabled or no-op stages). The run kernel
+// (gather, cascade, scatter, coefficient morphing) is in dsp_kernels.h and
+// shared with the output DSP.
+
+#define DSP_PROG_MAX_SECTIONS DSP_BQ_RUN_MAX_SECTIONS        // Per channel
+#define DSP_PROG_MAX_OPS      (3 * DSP_MAX_STAGES + 4)   // Per lane, both channels
+
+static DspBiquadRun _bqRun[2];  // [0] = left / mono, [1] = right (audio task only)
+
+// ===== Channel Programs =====
+// Each config swap compiles every lane (channel pair) of the incoming config
+// into a flat list of ops: {kernel, pre-derived parameters, stage state}.
+// Disabled and no-op stages (unity gain, non-inverted polarity, unmuted mute,
+// zero delay, empty FIR/multi-band/true-peak slots) are dropped, biquad
+// sections merge into one run across them, and settled gains and polarity
+// flips fold into one static scale. The audio task then only walks the list.
+//
+// Programs are built in _rcu_flip() right after state migration, so no-op
+// decisions see the carried-over ramps. They point into the DspState they were
+// built from; a config edited in place must be republished to take effect.
+// Multi-band compressor band settings live in the pool slot and are still
+// read per block (dsp_mb_set_band_params() applies without a swap).
+
+struct DspExec {
+    float *buf[2];                 // [0] = left / mono, [1] = right
+    int len;                       // Current length (section length inside a multirate section)
+    int fullLen;
+    int pc;                        // Index of the op being run (a decimator may jump)
+    DspMultirateState *sec;        // Open multirate section
+};
 
-        switch (s.type) {
-            case DSP_LIMITER:
-                dsp_limiter_process(s.limiter, buf, curLen, cfg->sampleRate);
-                break;
-            case DSP_FIR:
-                dsp_fir_process(s.fir, buf, curLen, stateIdx);
-                break;
-            case DSP_GAIN:
-                dsp_gain_process(s.gain, buf, curLen, cfg->sampleRate);
-                break;
-            case DSP_DELAY:
-                dsp_delay_process(s.delay, buf, curLen, stateIdx);
-                break;
-            case DSP_POLARITY:
-                if (s.polarity.inverted) dsp_polarity_process(buf, curLen);
-                break;
-            case DSP_MUTE:
-                if (s.mute.muted) dsp_mute_process(buf, curLen);
-                break;
-            case DSP_COMPRESSOR:
-                dsp_compressor_process(s.compressor, buf, curLen, cfg->sampleRate);
-                break;
-            case DSP_DECIMATOR: {
-                int newLen = dsp_decimator_process(s.decimator, buf, curLen, stateIdx);
-                if (newLen > 0) curLen = newLen;
-                break;
-            }
-            case DSP_CONVOLUTION:
-                if (s.convolution.convSlot >= 0) {
-                    dsp_conv_process(s.convolution.convSlot, buf, curLen);
-                }
-                break;
-            case DSP_NOISE_GATE:
-                dsp_noise_gate_process(s.noiseGate, buf, curLen, cfg->sampleRate);
-                break;
-            case DSP_TONE_CTRL:
-                dsp_tone_ctrl_process(s.toneCtrl, buf, curLen);
-                break;
-            case DSP_STEREO_WIDTH:
-                // Stereo width is handled post-channel in dsp_process_buffer()
-                break;
-            case DSP_LOUDNESS:
-                dsp_loudness_process(s.loudness, buf, curLen);
-                break;
-            case DSP_BASS_ENHANCE:
-                dsp_bass_enhance_process(s.bassEnhance, buf, curLen);
-                break;
-            case DSP_MULTIBAND_COMP:
-                if (s.multibandComp.mbSlot >= 0) {
-                    dsp_multiband_comp_process(s.multibandComp, buf, curLen, cfg->sampleRate);
-                }
-                break;
-            default:
-                break;
-        }
-    }
-    return curLen;
-}
+struct DspOp;
+typedef void (*DspOpFn)(DspOp &op, DspExec &x);
+
+struct DspOp {
+    DspOpFn fn;
+    DspStage *stage;               // Runtime state (left / mono side)
+    DspStage *stageR;              // Right side of pair ops (stereo biquad run, linked true-peak)
+    uint8_t side;                  // Buffer of single-sided ops
+    uint8_t sides;                 // Channel mask (bit 0 = left, bit 1 = right)
+    uint8_t bqCount;               // Biquad run: sections per side
+    uint8_t shed;                  // FIR / convolution bypassed by the load governor
+    float costUs;                  // Measured cost per block (sampled, see _program_run)
+    int16_t jump;                  // Decimator: op index of the closing interpolator
+    uint32_t rate;                 // Rate the op runs at (section rate inside a section)
+    const DspBiquadRef *bq[2];     // Biquad run sections per side
+    union {
+        DspDynCoeffs dyn;          // Limiter, compressor, noise gate
+        float scale;               // Static scale (settled gains, polarity)
+        float rampCoeff;           // Gain ramp
+        struct { DspDelayTaps taps; float *line; } delay;
+        struct { float *taps; DspFirRun *run; } fir;
+        DspMultirateState *mr;
+    } k;
+};
 
-// ===== Limiter =====
+struct DspProgram {
+    int count;
+    DspOp ops[DSP_PROG_MAX_OPS];
+    DspBiquadRef bq[2][DSP_PROG_MAX_SECTIONS];
+    int bqUsed[2];
+    DspStage *gr[2][DSP_MAX_STAGES];   // Stages reporting gain reduction, per channel
+    int grCount[2];
+    DspStage *width;                   // Stereo width stage of the left channel
+};
 
-static void dsp_limiter_process(DspLimiterParams &lim, float *buf, int len, uint32_t sampleRate) {
-    if (len <= 0 || sampleRate == 0) return;
+#define DSP_PROG_LANES (DSP_MAX_CHANNELS / 2)
+#ifdef NATIVE_TEST
+static DspProgram _programs[2][DSP_PROG_LANES];
+#else
+static DspProgram (*_programs)[DSP_PROG_LANES] = nullptr;
+#endif
 
-    float threshLin = dsp_db_to_linear(lim.thresholdDb);
-    float attackCoeff = dsp_time_coeff(lim.attackMs, (float)sampleRate);
-    float releaseCoeff = dsp_time_coeff(lim.releaseMs, (float)sampleRate);
+static void _program_alloc() {
+#ifndef NATIVE_TEST
+    if (!_programs) {
+        _programs = (DspProgram (*)[DSP_PROG_LANES])psram_alloc(2 * DSP_PROG_LANES, sizeof(DspProgram), "dsp_programs");
+    }
+#endif
+}
 
-    float env = lim.envelope;
-    float maxGr = 0.0f;
+// ----- Kernels -----
 
-    // Pass 1: Envelope detection → gain buffer
-    for (int i = 0; i < len; i++) {
-        float absSample = fabsf(buf[i]);
+static void _op_biquad(DspOp &op, DspExec &x) {
+    dsp_k_bq_gather(op.bq[0], op.bqCount, _bqRun[0]);
+    dsp_k_bq_run(_bqRun[0], nullptr, x.buf[op.side], nullptr, x.len);
+}
 
-        if (absSample > env) {
-            env = attackCoeff * env + (1.0f - attackCoeff) * absSample;
-        } else {
-            env = releaseCoeff * env + (1.0f - releaseCoeff) * absSample;
-        }
+static void _op_biquad_pair(DspOp &op, DspExec &x) {
+    dsp_k_bq_gather(op.bq[0], op.bqCount, _bqRun[0]);
+    dsp_k_bq_gather(op.bq[1], op.bqCount, _bqRun[1]);
+    dsp_k_bq_run(_bqRun[0], &_bqRun[1], x.buf[0], x.buf[1], x.len);
+}
 
-        float gainLin = 1.0f;
-        if (env > threshLin && env > 0.0f) {
-            float envDb = 20.0f * log10f(env);
-            float overDb = envDb - lim.thresholdDb;
-            float grDb = overDb * (1.0f - 1.0f / lim.ratio);
-            gainLin = dsp_db_to_linear(-grDb);
-            if (grDb > maxGr) maxGr = grDb;
-        }
+static void _op_scale(DspOp &op, DspExec &x) {
+    dsps_mulc_f32(x.buf[op.side], x.buf[op.side], x.len, op.k.scale, 1, 1);
+}
 
-        _gainBuf[i] = gainLin;
-    }
+static void _op_zero(DspOp &op, DspExec &x) {
+    memset(x.buf[op.side], 0, x.len * sizeof(float));
+}
 
-    // Pass 2: Apply gain via SIMD element-wise multiply
-    dsps_mul_f32(buf, _gainBuf, buf, len, 1, 1, 1);
+static void _op_gain_ramp(DspOp &op, DspExec &x) {
+    DspGainParams &g = op.stage->gain;
+    dsp_k_gain_ramp(g.gainLinear, g.currentLinear, op.k.rampCoeff, x.buf[op.side], x.len);
+}
 
-    lim.envelope = env;
-    lim.gainReduction = -maxGr;
+static void _op_limiter(DspOp &op, DspExec &x) {
+    DspLimiterParams &l = op.stage->limiter;
+    dsp_k_limiter(op.k.dyn, l.envelope, l.gainReduction, _gainBuf, x.buf[op.side], x.len);
 }
 
-// ===== FIR =====
+static void _op_compressor(DspOp &op, DspExec &x) {
+    DspCompressorParams &c = op.stage->compressor;
+    dsp_k_compressor(op.k.dyn, c.envelope, c.gainReduction, _gainBuf, x.buf[op.side], x.len);
+}
 
-static void dsp_fir_process(DspFirParams &fir, float *buf, int len, int stateIdx) {
-    if (fir.numTaps == 0 || fir.firSlot < 0 || fir.firSlot >= DSP_MAX_FIR_SLOTS) return;
+static void _op_noise_gate(DspOp &op, DspExec &x) {
+    DspNoiseGateParams &g = op.stage->noiseGate;
+    dsp_k_noise_gate(op.k.dyn, g.envelope, g.holdCounter, g.gainReduction, _gainBuf, x.buf[op.side], x.len);
+}
 
-    float *taps = dsp_fir_get_taps(stateIdx, fir.firSlot);
-    float *delay = dsp_fir_get_delay(stateIdx, fir.firSlot);
-    if (!taps || !delay) return;
+static void _op_delay(DspOp &op, DspExec &x) {
+    DspDelayParams &d = op.stage->delay;
+    dsp_k_delay(op.k.delay.taps, d.writePos, d.apState, op.k.delay.line, DSP_DELAY_RING_MASK, x.buf[op.side], x.len);
+}
 
-    fir_f32_t firState;
-    memset(&firState, 0, sizeof(firState)); // Zero extra fields (decim, use_delay on ESP32)
-    firState.coeffs = taps;
-    firState.delay = delay;
-    firState.N = fir.numTaps;
-    firState.pos = fir.delayPos;
+// FIR/convolution ops shed by the load governor (see _gov_apply). Counted
+// for telemetry; no logging — this runs on Core 1.
+static inline bool _op_shed(const DspOp &op) {
+    if (!op.shed) return false;
+    if (_metrics.firBypassCount < 0xFF) _metrics.firBypassCount++;
+    return true;
+}
 
-    dsps_fir_f32(&firState, buf, buf, len);
+static void _op_fir(DspOp &op, DspExec &x) {
+    if (_op_shed(op)) return;
+    dsp_fir_process(op.stage->fir, op.k.fir.taps, op.k.fir.run, x.buf[op.side], x.len, op.rate);
+}
 
-    fir.delayPos = (uint16_t)firState.pos;
+static void _op_convolution(DspOp &op, DspExec &x) {
+    if (_op_shed(op)) return;
+    dsp_conv_process(op.stage->convolution.convSlot, x.buf[op.side], x.len);
 }
 
-// ===== Gain =====
+static void _op_bass_enhance(DspOp &op, DspExec &x) {
+    dsp_k_bass_enhance(op.stage->bassEnhance, _gainBuf, x.buf[op.side], x.len);
+}
 
-static void dsp_gain_process(DspGainParams &gain, float *buf, int len, uint32_t sampleRate) {
-    float target = gain.gainLinear;
-    float current = gain.currentLinear;
+static void _op_multiband(DspOp &op, DspExec &x) {
+    dsp_multiband_comp_process(op.stage->multibandComp, x.buf[op.side], x.len, op.rate);
+}
 
-    // If already at target (within ~0.001 dB), use fast SIMD path
-    float diff = fabsf(current - target);
-    if (diff < 1e-6f) {
-        gain.currentLinear = target; // snap
-        dsps_mulc_f32(buf, buf, len, target, 1, 1);
-        return;
-    }
+static void _op_true_peak(DspOp &op, DspExec &x) {
+    dsp_true_peak_stage_process(op.stage->truePeak, x.buf[op.side], x.len, op.rate);
+}
 
-    // Exponential ramp: ~5ms time constant (240 samples @ 48kHz)
-    float tau = 5.0f; // ms
-    float coeff = dsp_time_coeff(tau, (float)sampleRate);
-    float oneMinusCoeff = 1.0f - coeff;
+static void _op_true_peak_linked(DspOp &op, DspExec &x) {
+    dsp_true_peak_linked_process(op.stage->truePeak, op.stageR->truePeak, x.buf[0], x.buf[1], x.len, op.rate);
+}
 
-    for (int i = 0; i < len; i++) {
-        current = coeff * current + oneMinusCoeff * target;
-        buf[i] *= current;
+// Opens a section. When the block cannot be decimated (length not a multiple
+// of the factor) the section's ops are skipped.
+static void _op_decimate(DspOp &op, DspExec &x) {
+    DspMultirateState *st = op.k.mr;
+    int low = dsp_mr_configure(*st, op.stage->decimator.factor) ? dsp_mr_decimate(*st, x.buf[op.side], x.len) : 0;
+    if (low == 0) {
+        x.pc = op.jump;
+        return;
     }
-    gain.currentLinear = current;
+    x.sec = st;
+    x.len = low;
 }
 
-// ===== Delay =====
+static void _op_interpolate(DspOp &op, DspExec &x) {
+    if (!x.sec) return;
+    dsp_mr_interpolate(*x.sec, x.buf[op.side], x.len);
+    x.sec = nullptr;
+    x.len = x.fullLen;
+}
 
-static void dsp_delay_process(DspDelayParams &dly, float *buf, int len, int stateIdx) {
-    if (dly.delaySamples == 0 || dly.delaySlot < 0 || dly.delaySlot >= DSP_MAX_DELAY_SLOTS) return;
+// ----- Compiler -----
 
-    float *line = _delayLine[stateIdx][dly.delaySlot];
-    if (!line) return;  // Slot not allocated
-    uint16_t delaySamples = dly.delaySamples;
-    if (delaySamples > DSP_MAX_DELAY_SAMPLES) delaySamples = DSP_MAX_DELAY_SAMPLES;
-    uint16_t wp = dly.writePos;
+// Per-side accumulation of linear stages that have not been emitted yet
+struct DspPending {
+    int bqFirst;
+    int bqCount;
+    float scale;
+};
 
-    for (int i = 0; i < len; i++) {
-        // Write current sample into delay line
-        line[wp] = buf[i];
-        // Read from delay position behind write
-        uint16_t readPos = (wp + DSP_MAX_DELAY_SAMPLES - delaySamples) % DSP_MAX_DELAY_SAMPLES;
-        buf[i] = line[readPos];
-        wp = (wp + 1) % DSP_MAX_DELAY_SAMPLES;
-    }
+struct DspCompiler {
+    DspProgram &p;
+    DspPending pend[2];
+    int sides;                     // 1 = mono chain, 2 = lockstep pair
+    int base;                      // Buffer / channel of side 0
+};
 
-    dly.writePos = wp;
+static DspOp _opSink;   // Absorbs ops past DSP_PROG_MAX_OPS (cannot happen with DSP_MAX_STAGES stages)
+
+static DspOp &_emit(DspProgram &p, DspOpFn fn, DspStage *s, int side, uint32_t rate) {
+    DspOp &op = p.count < DSP_PROG_MAX_OPS ? p.ops[p.count++] : _opSink;
+    memset(&op, 0, sizeof(op));
+    op.fn = fn;
+    op.stage = s;
+    op.side = (uint8_t)side;
+    op.sides = (uint8_t)(1u << side);
+    op.rate = rate;
+    op.jump = -1;
+    return op;
 }
 
-// ===== Polarity =====
-
-static void dsp_polarity_process(float *buf, int len) {
-    dsps_mulc_f32(buf, buf, len, -1.0f, 1, 1);
+static void _pend_reset(DspCompiler &c) {
+    for (int k = 0; k < c.sides; k++) {
+        c.pend[k].bqFirst = c.p.bqUsed[c.base + k];
+        c.pend[k].bqCount = 0;
+        c.pend[k].scale = 1.0f;
+    }
 }
 
-// ===== Mute =====
+// Emit the pending biquad run (stereo when paired) and scales
+static void _pend_flush(DspCompiler &c, uint32_t rate) {
+    DspProgram &p = c.p;
+    int n = c.pend[0].bqCount;
+    if (n > 0) {
+        if (c.sides == 2) {
+            DspOp &op = _emit(p, _op_biquad_pair, nullptr, 0, rate);
+            op.sides = 3;
+            op.bq[1] = &p.bq[1][c.pend[1].bqFirst];
+            op.bqCount = (uint8_t)n;
+            op.bq[0] = &p.bq[0][c.pend[0].bqFirst];
+        } else {
+            DspOp &op = _emit(p, _op_biquad, nullptr, c.base, rate);
+            op.bq[0] = &p.bq[c.base][c.pend[0].bqFirst];
+            op.bqCount = (uint8_t)n;
+        }
+    }
+    for (int k = 0; k < c.sides; k++) {
+        if (c.pend[k].scale != 1.0f) {
+            DspOp &op = _emit(p, _op_scale, nullptr, c.base + k, rate);
+            op.k.scale = c.pend[k].scale;
+        }
+    }
+    _pend_reset(c);
+}
 
-static void dsp_mute_process(float *buf, int len) {
-    memset(buf, 0, len * sizeof(float));
+static void _pend_section(DspCompiler &c, int k, float *coeffs, float *delay, DspBiquadParams *morph) {
+    int side = c.base + k;
+    int &used = c.p.bqUsed[side];
+    if (used >= DSP_PROG_MAX_SECTIONS) return;
+    DspBiquadRef &r = c.p.bq[side][used++];
+    r.coeffs = coeffs;
+    r.delay = delay;
+    r.morph = morph;
+    c.pend[k].bqCount++;
 }
 
-// ===== Compressor =====
+enum DspStageClass { DSP_CLS_NONE, DSP_CLS_LINEAR, DSP_CLS_OP };
+
+// How a stage compiles: dropped, folded into the pending run/scale, or an op
+static DspStageClass _stage_class(const DspStage &s) {
+    if (!s.enabled) return DSP_CLS_NONE;
+    if (dsp_is_biquad_type(s.type)) return DSP_CLS_LINEAR;
+    switch (s.type) {
+        case DSP_TONE_CTRL:
+        case DSP_LOUDNESS:
+            return DSP_CLS_LINEAR;
+        case DSP_GAIN:
+            return fabsf(s.gain.currentLinear - s.gain.gainLinear) < 1e-6f ? DSP_CLS_LINEAR : DSP_CLS_OP;
+        case DSP_POLARITY:
+            return s.polarity.inverted ? DSP_CLS_LINEAR : DSP_CLS_NONE;
+        case DSP_MUTE:
+            return s.mute.muted ? DSP_CLS_OP : DSP_CLS_NONE;
+        case DSP_DELAY: {
+            const bool frac = s.delay.interp != DSP_DELAY_INTERP_NONE && s.delay.fraction > 0.0f;
+            return (s.delay.delaySamples == 0 && !frac) ? DSP_CLS_NONE : DSP_CLS_OP;
+        }
+        case DSP_FIR:
+            return (s.fir.numTaps == 0 || s.fir.firSlot < 0 || s.fir.firSlot >= DSP_MAX_FIR_SLOTS) ? DSP_CLS_NONE : DSP_CLS_OP;
+        case DSP_CONVOLUTION:
+            return DSP_CLS_OP;   // Kept without an IR so the governor still counts it
+        case DSP_MULTIBAND_COMP:
+            return (s.multibandComp.mbSlot >= 0 && s.multibandComp.mbSlot < DSP_MULTIBAND_MAX_SLOTS) ? DSP_CLS_OP : DSP_CLS_NONE;
+        case DSP_TRUE_PEAK_LIMITER:
+            return _tp_state(s.truePeak.tpSlot) ? DSP_CLS_OP : DSP_CLS_NONE;
+        case DSP_BASS_ENHANCE:
+            return s.bassEnhance.mix > 0.0f ? DSP_CLS_OP : DSP_CLS_NONE;
+        case DSP_STEREO_WIDTH:
+            return DSP_CLS_NONE;   // Applied after the lane (see _program_finish)
+        case DSP_LIMITER:
+        case DSP_COMPRESSOR:
+        case DSP_NOISE_GATE:
+            return DSP_CLS_OP;
+        default:
+            return DSP_CLS_NONE;
+    }
+}
 
-static void dsp_compressor_process(DspCompressorParams &comp, float *buf, int len, uint32_t sampleRate) {
-    if (len <= 0 || sampleRate == 0) return;
+static void _fold_linear(DspCompiler &c, int k, DspStage &s) {
+    DspPending &pd = c.pend[k];
+    if (dsp_is_biquad_type(s.type)) {
+        _pend_section(c, k, s.biquad.coeffs, s.biquad.delay, &s.biquad);
+    } else if (s.type == DSP_TONE_CTRL) {
+        _pend_section(c, k, s.toneCtrl.bassCoeffs, s.toneCtrl.bassDelay, nullptr);
+        _pend_section(c, k, s.toneCtrl.midCoeffs, s.toneCtrl.midDelay, nullptr);
+        _pend_section(c, k, s.toneCtrl.trebleCoeffs, s.toneCtrl.trebleDelay, nullptr);
+    } else if (s.type == DSP_LOUDNESS) {
+        _pend_section(c, k, s.loudness.bassCoeffs, s.loudness.bassDelay, nullptr);
+        _pend_section(c, k, s.loudness.trebleCoeffs, s.loudness.trebleDelay, nullptr);
+    } else if (s.type == DSP_GAIN) {
+        pd.scale *= s.gain.gainLinear;
+    } else if (s.type == DSP_POLARITY) {
+        pd.scale = -pd.scale;
+    }
+}
 
-    float threshLin = dsp_db_to_linear(comp.thresholdDb);
-    float attackCoeff = dsp_time_coeff(comp.attackMs, (float)sampleRate);
-    float releaseCoeff = dsp_time_coeff(comp.releaseMs, (float)sampleRate);
-    float makeupLin = comp.makeupLinear;
+// Emit one single-sided op for a stateful stage
+static void _emit_stage(DspCompiler &c, int k, DspStage &s, uint32_t rate, int stateIdx) {
+    DspProgram &p = c.p;
+    int side = c.base + k;
+    switch (s.type) {
+        case DSP_GAIN: {
+            DspOp &op = _emit(p, _op_gain_ramp, &s, side, rate);
+            op.k.rampCoeff = dsp_time_coeff(5.0f, (float)rate);   // ~5 ms ramp
+            break;
+        }
+        case DSP_LIMITER: {
+            DspOp &op = _emit(p, _op_limiter, &s, side, rate);
+            dsp_k_limiter_coeffs(op.k.dyn, s.limiter, rate);
+            break;
+        }
+        case DSP_COMPRESSOR: {
+            DspOp &op = _emit(p, _op_compressor, &s, side, rate);
+            dsp_k_compressor_coeffs(op.k.dyn, s.compressor, rate);
+            break;
+        }
+        case DSP_NOISE_GATE: {
+            DspOp &op = _emit(p, _op_noise_gate, &s, side, rate);
+            dsp_k_gate_coeffs(op.k.dyn, s.noiseGate, rate);
+            break;
+        }
+        case DSP_DELAY: {
+            float *line = dsp_delay_get_line(s.delay.delaySlot);
+            if (!line) break;
+            DspOp &op = _emit(p, _op_delay, &s, side, rate);
+            dsp_k_delay_taps(s.delay, op.k.delay.taps, DSP_MAX_DELAY_SAMPLES);
+            op.k.delay.line = line;
+            break;
+        }
+        case DSP_FIR: {
+            float *taps = dsp_fir_get_taps(stateIdx, s.fir.firSlot);
+            DspFirRun *run = _firRun[s.fir.firSlot];
+            if (!taps || !run) break;
+            DspOp &op = _emit(p, _op_fir, &s, side, rate);
+            op.k.fir.taps = taps;
+            op.k.fir.run = run;
+            break;
+        }
+        case DSP_MUTE:
+            _emit(p, _op_zero, &s, side, rate);
+            break;
+        case DSP_CONVOLUTION:
+            _emit(p, _op_convolution, &s, side, rate);
+            break;
+        case DSP_BASS_ENHANCE:
+            _emit(p, _op_bass_enhance, &s, side, rate);
+            break;
+        case DSP_MULTIBAND_COMP:
+            _emit(p, _op_multiband, &s, side, rate);
+            break;
+        case DSP_TRUE_PEAK_LIMITER:
+            _emit(p, _op_true_peak, &s, side, rate);
+            break;
+        default:
+            break;
+    }
+}
 
-    float env = comp.envelope;
-    float maxGr = 0.0f;
+// True when both chains have the same stage layout, so they can be walked in
+// lockstep with biquad runs of equal length on both sides.
+static bool _channels_match(const DspChannelConfig &a, const DspChannelConfig &b) {
+    if (a.bypass || b.bypass || a.stageCount != b.stageCount) return false;
+    for (int i = 0; i < a.stageCount; i++) {
+        const DspStage &sa = a.stages[i];
+        const DspStage &sb = b.stages[i];
+        if (sa.enabled != sb.enabled) return false;
+        if (!sa.enabled) continue;
+        if (sa.type == DSP_DECIMATOR || sb.type == DSP_DECIMATOR ||
+            sa.type == DSP_INTERPOLATOR || sb.type == DSP_INTERPOLATOR) return false;
+        bool bqA = dsp_is_biquad_type(sa.type);
+        if (bqA != dsp_is_biquad_type(sb.type)) return false;
+        if (!bqA && sa.type != sb.type) return false;
+    }
+    return true;
+}
 
-    // Pass 1: Envelope detection → gain buffer (includes makeup gain)
-    for (int i = 0; i < len; i++) {
-        float absSample = fabsf(buf[i]);
+// Index of the enabled DSP_INTERPOLATOR closing the section opened at
+// `open`, or stageCount when the section runs to the end of the chain.
+static int _mr_section_end(const DspChannelConfig &ch, int open) {
+    for (int i = open + 1; i < ch.stageCount; i++) {
+        if (ch.stages[i].enabled && ch.stages[i].type == DSP_INTERPOLATOR) return i;
+    }
+    return ch.stageCount;
+}
 
-        if (absSample > env) {
-            env = attackCoeff * env + (1.0f - attackCoeff) * absSample;
-        } else {
-            env = releaseCoeff * env + (1.0f - releaseCoeff) * absSample;
-        }
+// Compile one channel (mono) into ops on buffer `side`
+static void _compile_mono(DspProgram &p, DspChannelConfig &ch, int side, uint32_t fullRate, int stateIdx) {
+    if (ch.bypass) return;
+    DspCompiler c = {p, {}, 1, side};
+    _pend_reset(c);
+    uint32_t rate = fullRate;
+    int openOp = -1;   // Decimator op of the open section
 
-        float gainLin = 1.0f;
-        if (env > 0.0f) {
-            float envDb = 20.0f * log10f(env);
-            float overDb = envDb - comp.thresholdDb;
+    for (int i = 0; i < ch.stageCount; i++) {
+        DspStage &s = ch.stages[i];
+        if (!s.enabled) continue;
 
-            float grDb = 0.0f;
-            if (comp.kneeDb > 0.0f && overDb > -comp.kneeDb / 2.0f && overDb < comp.kneeDb / 2.0f) {
-                float x = overDb + comp.kneeDb / 2.0f;
-                grDb = (1.0f - 1.0f / comp.ratio) * x * x / (2.0f * comp.kneeDb);
-            } else if (overDb >= comp.kneeDb / 2.0f) {
-                grDb = overDb * (1.0f - 1.0f / comp.ratio);
+        if (s.type == DSP_DECIMATOR) {
+            if (openOp >= 0) continue;                  // Sections do not nest
+            DspMultirateState *st = _mr_state(s.decimator.mrSlot);
+            if (!st || !dsp_mr_stages_for(s.decimator.factor) || fullRate == 0) {
+                i = _mr_section_end(ch, i);             // No state: skip the section
+                continue;
             }
-
-            if (grDb > 0.0f) {
-                gainLin = dsp_db_to_linear(-grDb);
-                if (grDb > maxGr) maxGr = grDb;
+            _pend_flush(c, rate);
+            DspOp &op = _emit(p, _op_decimate, &s, side, rate);
+            op.k.mr = st;
+            openOp = p.count - 1;
+            rate = fullRate / s.decimator.factor;
+            continue;
+        }
+        if (s.type == DSP_INTERPOLATOR) {
+            if (openOp >= 0) {
+                _pend_flush(c, rate);
+                p.ops[openOp].jump = (int16_t)p.count;
+                _emit(p, _op_interpolate, &s, side, fullRate);
+                openOp = -1;
+                rate = fullRate;
             }
+            continue;
         }
 
-        _gainBuf[i] = gainLin * makeupLin;
+        DspStageClass cls = _stage_class(s);
+        if (cls == DSP_CLS_LINEAR) {
+            _fold_linear(c, 0, s);
+        } else if (cls == DSP_CLS_OP) {
+            _pend_flush(c, rate);
+            _emit_stage(c, 0, s, rate, stateIdx);
+        }
+    }
+    _pend_flush(c, rate);
+    if (openOp >= 0) {                                  // Section open to the end of the chain
+        p.ops[openOp].jump = (int16_t)p.count;
+        _emit(p, _op_interpolate, nullptr, side, fullRate);
     }
-
-    // Pass 2: Apply gain via SIMD element-wise multiply
-    dsps_mul_f32(buf, _gainBuf, buf, len, 1, 1, 1);
-
-    comp.envelope = env;
-    comp.gainReduction = -maxGr;
 }
 
-// ===== Decimator =====
-
-static int dsp_decimator_process(DspDecimatorParams &dec, float *buf, int len, int stateIdx) {
-    if (dec.factor <= 1 || dec.firSlot < 0 || dec.firSlot >= DSP_MAX_FIR_SLOTS) return len;
+// Compile a matching pair in lockstep (stereo biquad runs, linked true-peak)
+static void _compile_pair(DspProgram &p, DspChannelConfig &chL, DspChannelConfig &chR, uint32_t rate, int stateIdx) {
+    DspCompiler c = {p, {}, 2, 0};
+    _pend_reset(c);
+    for (int i = 0; i < chL.stageCount; i++) {
+        DspStage *st[2] = {&chL.stages[i], &chR.stages[i]};
+        DspStageClass cls[2] = {_stage_class(*st[0]), _stage_class(*st[1])};
+        if (cls[0] != DSP_CLS_OP && cls[1] != DSP_CLS_OP) {
+            for (int k = 0; k < 2; k++) if (cls[k] == DSP_CLS_LINEAR) _fold_linear(c, k, *st[k]);
+            continue;
+        }
+        _pend_flush(c, rate);
+        if (st[0]->type == DSP_TRUE_PEAK_LIMITER && cls[0] == DSP_CLS_OP && cls[1] == DSP_CLS_OP &&
+            st[0]->truePeak.linked && st[1]->truePeak.linked) {
+            DspOp &op = _emit(p, _op_true_peak_linked, st[0], 0, rate);
+            op.stageR = st[1];
+            op.sides = 3;
+            continue;
+        }
+        for (int k = 0; k < 2; k++) {
+            if (cls[k] == DSP_CLS_OP) _emit_stage(c, k, *st[k], rate, stateIdx);
+            else if (cls[k] == DSP_CLS_LINEAR) _fold_linear(c, k, *st[k]);
+        }
+    }
+    _pend_flush(c, rate);
+}
 
-    float *taps = dsp_fir_get_taps(stateIdx, dec.firSlot);
-    float *delay = dsp_fir_get_delay(stateIdx, dec.firSlot);
-    if (!taps || !delay || dec.numTaps == 0) return len;
+static void _collect_reporting(DspProgram &p, DspChannelConfig &ch, int side) {
+    p.grCount[side] = 0;
+    for (int i = 0; i < ch.stageCount; i++) {
+        DspStage &s = ch.stages[i];
+        if (!s.enabled) continue;
+        if (s.type == DSP_LIMITER || s.type == DSP_COMPRESSOR ||
+            s.type == DSP_NOISE_GATE || s.type == DSP_TRUE_PEAK_LIMITER) {
+            p.gr[side][p.grCount[side]++] = &s;
+        } else if (side == 0 && s.type == DSP_STEREO_WIDTH && !p.width) {
+            p.width = &s;
+        }
+    }
+}
 
-    fir_f32_t fird;
-    memset(&fird, 0, sizeof(fird));
-    fird.coeffs = taps;
-    fird.delay = delay;
-    fird.N = dec.numTaps;
-    fird.pos = dec.delayPos;
-    fird.decim = dec.factor;
+// Compile every lane of _states[stateIdx] into _programs[stateIdx]
+static void _program_build(int stateIdx) {
+#ifndef NATIVE_TEST
+    if (!_programs) return;
+#endif
+    DspState &cfg = _states[stateIdx];
+    for (int lane = 0; lane < DSP_PROG_LANES; lane++) {
+        DspProgram &p = _programs[stateIdx][lane];
+        p.count = 0;
+        p.bqUsed[0] = p.bqUsed[1] = 0;
+        p.width = nullptr;
+        DspChannelConfig &chL = cfg.channels[lane * 2];
+        DspChannelConfig &chR = cfg.channels[lane * 2 + 1];
+        if (_channels_match(chL, chR)) {
+            _compile_pair(p, chL, chR, cfg.sampleRate, stateIdx);
+        } else {
+            _compile_mono(p, chL, 0, cfg.sampleRate, stateIdx);
+            _compile_mono(p, chR, 1, cfg.sampleRate, stateIdx);
+        }
+        _collect_reporting(p, chL, 0);
+        _collect_reporting(p, chR, 1);
+    }
+}
 
-    // Decimate in-place: output goes into the same buffer (fewer samples)
-    int outLen = len / dec.factor;
-    dsps_fird_f32(&fird, buf, buf, len);
+// Run a lane's program over one block
+static void _program_run(DspProgram &p, float *left, float *right, int len) {
+    DspExec x;
+    x.buf[0] = left;
+    x.buf[1] = right;
+    x.len = len;
+    x.fullLen = len;
+    x.sec = nullptr;
+    if (!_govProfile) {
+        for (x.pc = 0; x.pc < p.count; x.pc++) {
+            DspOp &op = p.ops[x.pc];
+            op.fn(op, x);
+        }
+        return;
+    }
+    for (x.pc = 0; x.pc < p.count; x.pc++) {
+        DspOp &op = p.ops[x.pc];
+        uint32_t t0 = _rcu_now_us();
+        op.fn(op, x);
+        if (!op.shed) op.costUs += 0.5f * ((float)(_rcu_now_us() - t0) - op.costUs);
+    }
+}
 
-    dec.delayPos = (uint16_t)fird.pos;
-    return outLen;
+// Stereo width (mid-side, configured on the left channel) and GR metrics
+static void _program_finish(DspProgram &p, float *left, float *right, int frames, int chL) {
+    if (p.width) {
+        float widthScale = p.width->stereoWidth.width / 100.0f;
+        float centerGain = p.width->stereoWidth.centerGainLin;
+        for (int f = 0; f < frames; f++) {
+            float mid  = (left[f] + right[f]) * 0.5f * centerGain;
+            float side = (left[f] - right[f]) * 0.5f * widthScale;
+            left[f] = mid + side;
+            right[f] = mid - side;
+        }
+    }
+    for (int k = 0; k < 2; k++) {
+        float worst = 0.0f;
+        for (int i = 0; i < p.grCount[k]; i++) {
+            const DspStage &s = *p.gr[k][i];
+            float gr = s.type == DSP_LIMITER ? s.limiter.gainReduction
+                     : s.type == DSP_COMPRESSOR ? s.compressor.gainReduction
+                     : s.type == DSP_NOISE_GATE ? s.noiseGate.gainReduction
+                     : s.truePeak.gainReduction;
+            if (gr < worst) worst = gr;
+        }
+        _metrics.limiterGrDb[chL + k] = worst;
+    }
 }
 
-// ===== Noise Gate =====
+static void _program_process(int stateIdx, int lane, float *left, float *right, int frames) {
+#ifndef NATIVE_TEST
+    if (!_programs) return;
+#endif
+    DspProgram &p = _programs[stateIdx][lane];
+    _program_run(p, left, right, frames);
+    _program_finish(p, left, right, frames, lane * 2);
+}
 
-static void dsp_noise_gate_process(DspNoiseGateParams &gate, float *buf, int len, uint32_t sampleRate) {
-    if (len <= 0 || sampleRate == 0) return;
+int dsp_get_program_length(int channel) {
+    if (channel < 0 || channel >= DSP_MAX_CHANNELS) return 0;
+#ifndef NATIVE_TEST
+    if (!_programs) return 0;
+#endif
+    const DspProgram &p = _programs[_activeIndex][channel / 2];
+    uint8_t mask = (uint8_t)(1u << (channel & 1));
+    int n = 0;
+    for (int i = 0; i < p.count; i++) if (p.ops[i].sides & mask) n++;
+    return n;
+}
 
-    float threshLin = dsp_db_to_linear(gate.thresholdDb);
-    float attackCoeff = dsp_time_coeff(gate.attackMs, (float)sampleRate);
-    float releaseCoeff = dsp_time_coeff(gate.releaseMs, (float)sampleRate);
-    float holdSamples = gate.holdMs * 0.001f * (float)sampleRate;
-    float rangeLin = dsp_db_to_linear(gate.rangeDb);
+// ===== Load Governor =====
+// Steps once per period, at the top of the lane-0 / ADC0 block, on the summed
+// load of the previous period's blocks (levels: dsp_governor.h). Op costs are
+// sampled every DSP_GOV_PROFILE_PERIODS periods so that, within a priority,
+// the most expensive stage is shed first.
+
+static void _gov_reset() {
+    dsp_gov_init(_gov);
+    _govLoad = 0.0f;
+    _govTick = 0;
+    _govProfile = false;
+}
 
-    float env = gate.envelope;
-    float holdCnt = gate.holdCounter;
-    float maxGr = 0.0f;
+static inline bool _gov_sheddable(const DspOp &op) {
+    return (op.fn == _op_fir || op.fn == _op_convolution) && op.stage->priority != DSP_PRIORITY_PROTECTED;
+}
 
-    // Pass 1: Envelope → gain buffer
-    for (int i = 0; i < len; i++) {
-        float absSample = fabsf(buf[i]);
+static int _gov_sheddable_count(int stateIdx) {
+#ifndef NATIVE_TEST
+    if (!_programs) return 0;
+#endif
+    int n = 0;
+    for (int lane = 0; lane < DSP_PROG_LANES; lane++) {
+        const DspProgram &p = _programs[stateIdx][lane];
+        for (int i = 0; i < p.count; i++) if (_gov_sheddable(p.ops[i])) n++;
+    }
+    return n;
+}
 
-        if (absSample > env) {
-            env = attackCoeff * env + (1.0f - attackCoeff) * absSample;
-        } else {
-            env = releaseCoeff * env + (1.0f - releaseCoeff) * absSample;
+// Shed dsp_gov_shed_count(level) ops of a state's programs: lowest priority
+// first, then highest measured cost
+static void _gov_apply(int stateIdx) {
+#ifndef NATIVE_TEST
+    if (!_programs) return;
+#endif
+    const int want = dsp_gov_shed_count(_gov.level);
+    for (int lane = 0; lane < DSP_PROG_LANES; lane++) {
+        DspProgram &p = _programs[stateIdx][lane];
+        for (int i = 0; i < p.count; i++) p.ops[i].shed = 0;
+    }
+    int shed = 0;
+    float cost = 0.0f;
+    while (shed < want) {
+        DspOp *best = nullptr;
+        for (int lane = 0; lane < DSP_PROG_LANES; lane++) {
+            DspProgram &p = _programs[stateIdx][lane];
+            for (int i = 0; i < p.count; i++) {
+                DspOp &op = p.ops[i];
+                if (op.shed || !_gov_sheddable(op)) continue;
+                if (!best || op.stage->priority > best->stage->priority ||
+                    (op.stage->priority == best->stage->priority && op.costUs > best->costUs)) {
+                    best = &op;
+                }
+            }
         }
+        if (!best) break;
+        best->shed = 1;
+        shed++;
+        cost += best->costUs;
+    }
+    _metrics.shedStageCount = (uint8_t)shed;
+    _metrics.shedCostUs = cost;
+}
 
-        float gainLin = 1.0f;
-        if (env < threshLin) {
-            // Signal below threshold — apply gate/expansion
-            if (holdCnt > 0.0f) {
-                holdCnt -= 1.0f;
-                // During hold: no attenuation
-            } else {
-                // Compute gate attenuation
-                if (gate.ratio <= 1.0f) {
-                    // Hard gate: full range attenuation
-                    gainLin = rangeLin;
-                } else {
-                    // Expander: ratio-based attenuation
-                    float envDb = (env > 1e-10f) ? 20.0f * log10f(env) : -100.0f;
-                    float underDb = gate.thresholdDb - envDb;
-                    if (underDb > 0.0f) {
-                        float grDb = underDb * (1.0f - 1.0f / gate.ratio);
-                        gainLin = dsp_db_to_linear(-grDb);
-                        // Clamp to range
-                        if (gainLin < rangeLin) gainLin = rangeLin;
-                        if (grDb > maxGr) maxGr = grDb;
-                    }
+// Rebuilt programs start unmeasured; keep the costs of stages that survive
+static void _gov_carry_costs(int oldIdx, int newIdx) {
+#ifndef NATIVE_TEST
+    if (!_programs) return;
+#endif
+    for (int lane = 0; lane < DSP_PROG_LANES; lane++) {
+        const DspProgram &o = _programs[oldIdx][lane];
+        DspProgram &p = _programs[newIdx][lane];
+        for (int i = 0; i < p.count; i++) {
+            DspOp &op = p.ops[i];
+            if (op.fn != _op_fir && op.fn != _op_convolution) continue;
+            for (int j = 0; j < o.count; j++) {
+                if (o.ops[j].fn == op.fn && o.ops[j].stage->id == op.stage->id) {
+                    op.costUs = o.ops[j].costUs;
+                    break;
                 }
-                float grDb = -20.0f * log10f(gainLin > 1e-10f ? gainLin : 1e-10f);
-                if (grDb > maxGr) maxGr = grDb;
             }
-        } else {
-            // Signal above threshold — reset hold timer
-            holdCnt = holdSamples;
         }
+    }
+}
 
-        _gainBuf[i] = gainLin;
+static void _gov_period(int stateIdx) {
+    const uint8_t prev = _gov.level;
+    dsp_gov_step(_gov, _govLoad, DSP_GOV_SHED - 1 + _gov_sheddable_count(stateIdx));
+    _govLoad = 0.0f;
+    if (_gov.level != prev) {
+        _gov_apply(stateIdx);
+        _metrics.governorLevel = _gov.level;
     }
+    _govProfile = ++_govTick >= DSP_GOV_PROFILE_PERIODS;
+    if (_govProfile) _govTick = 0;
+}
+
+uint8_t dsp_get_governor_level() {
+    return _gov.level;
+}
 
-    // Pass 2: Apply gain via SIMD
-    dsps_mul_f32(buf, _gainBuf, buf, len, 1, 1, 1);
+// ===== Stage Kernels =====
+// Limiter, compressor, noise gate, gain ramp, delay, bass enhancement and
+// multi-band compression run the shared kernels in dsp_kernels.h straight
+// from the ops above. The wrappers below resolve pool slots, and the
+// standalone forms derive parameters on the spot for direct calls.
 
-    gate.envelope = env;
-    gate.holdCounter = holdCnt;
-    gate.gainReduction = -maxGr;
+// ===== True-Peak Limiter (kernel in dsp_true_peak.h) =====
+
+static inline float _tp_gr_db(float gMin) {
+    return gMin < 1.0f ? 20.0f * log10f(gMin > 1e-5f ? gMin : 1e-5f) : 0.0f;
 }
 
-// ===== Tone Control =====
+static void dsp_true_peak_stage_process(DspTruePeakParams &tp, float *buf, int len, uint32_t sampleRate) {
+    DspTruePeakState *st = _tp_state(tp.tpSlot);
+    if (!st || len <= 0) return;
+    dsp_tp_configure(*st, sampleRate, tp.ceilingDb, tp.lookaheadMs, tp.releaseMs);
+    tp.gainReduction = _tp_gr_db(dsp_true_peak_process(*st, buf, len));
+}
 
-static void dsp_tone_ctrl_process(DspToneCtrlParams &tc, float *buf, int len) {
-    // Cascade 3 biquads: bass shelf → mid peak → treble shelf
-    dsps_biquad_f32(buf, buf, len, tc.bassCoeffs, tc.bassDelay);
-    dsps_biquad_f32(buf, buf, len, tc.midCoeffs, tc.midDelay);
-    dsps_biquad_f32(buf, buf, len, tc.trebleCoeffs, tc.trebleDelay);
+// Linked pair: the right stage follows the left stage's settings so both
+// lookahead rings stay aligned. The program compiler only emits this for
+// pairs where both sides are linked and have a slot.
+static void dsp_true_peak_linked_process(DspTruePeakParams &tpL, DspTruePeakParams &tpR,
+                                         float *left, float *right, int len, uint32_t sampleRate) {
+    DspTruePeakState *a = _tp_state(tpL.tpSlot);
+    DspTruePeakState *b = _tp_state(tpR.tpSlot);
+    if (!a || !b) return;
+    dsp_tp_configure(*a, sampleRate, tpL.ceilingDb, tpL.lookaheadMs, tpL.releaseMs);
+    dsp_tp_configure(*b, sampleRate, tpL.ceilingDb, tpL.lookaheadMs, tpL.releaseMs);
+    float gr = _tp_gr_db(dsp_true_peak_process_linked(*a, *b, left, right, len));
+    tpL.gainReduction = gr;
+    tpR.gainReduction = gr;
 }
 
-// ===== Loudness Compensation =====
+// ===== FIR =====
+
+static void dsp_fir_process(DspFirParams &fir, float *taps, DspFirRun *run, float *buf, int len, uint32_t sampleRate) {
+    unsigned long t0 = (unsigned long)esp_timer_get_time();
+    dsp_k_fir(fir, taps, *run, _firFftCrossover, buf, len);
+    unsigned long dt = (unsigned long)esp_timer_get_time() - t0;
 
-static void dsp_loudness_process(DspLoudnessParams &ld, float *buf, int len) {
-    // Cascade 2 biquads: bass shelf → treble shelf
-    dsps_biquad_f32(buf, buf, len, ld.bassCoeffs, ld.bassDelay);
-    dsps_biquad_f32(buf, buf, len, ld.trebleCoeffs, ld.trebleDelay);
+    // Per-stage cost as a share of this block's real-time budget
+    if (sampleRate > 0) {
+        float budgetUs = (float)len * 1000000.0f / (float)sampleRate;
+        float pct = (float)dt * 100.0f / budgetUs;
+        fir.cpuPercent += 0.1f * (pct - fir.cpuPercent);
+    }
 }
 
-// ===== Bass Enhancement =====
+// ===== Delay =====
 
-static void dsp_bass_enhance_process(DspBassEnhanceParams &be, float *buf, int len) {
-    if (be.mix <= 0.0f) return;
+static inline void dsp_delay_process(DspDelayParams &dly, float *buf, int len) {
+    float *line = dsp_delay_get_line(dly.delaySlot);
+    if (!line) return;  // Slot not allocated
+    DspDelayTaps t;
+    dsp_k_delay_taps(dly, t, DSP_MAX_DELAY_SAMPLES);
+    if (!dsp_k_delay_active(t)) return;
+    dsp_k_delay(t, dly.writePos, dly.apState, line, DSP_DELAY_RING_MASK, buf, len);
+}
 
-    float mixScale = be.mix / 100.0f * be.harmonicGainLin;
+// ===== Noise Gate =====
 
-    // Copy buf → _gainBuf (scratch), apply HPF to get high-freq content
-    memcpy(_gainBuf, buf, len * sizeof(float));
-    dsps_biquad_f32(_gainBuf, _gainBuf, len, be.hpfCoeffs, be.hpfDelay);
+static inline void dsp_noise_gate_process(DspNoiseGateParams &gate, float *buf, int len, uint32_t sampleRate) {
+    if (sampleRate == 0) return;
+    DspDynCoeffs k;
+    dsp_k_gate_coeffs(k, gate, sampleRate);
+    dsp_k_noise_gate(k, gate.envelope, gate.holdCounter, gate.gainReduction, _gainBuf, buf, len);
+}
 
-    // Subtract HPF from original to get low-freq content (in _gainBuf temporarily)
-    // Actually: sub-bass = buf - HPF(buf)
-    for (int i = 0; i < len; i++) {
-        _gainBuf[i] = buf[i] - _gainBuf[i];  // LPF content (sub-bass)
-    }
+// ===== Tone Control =====
 
-    // Generate harmonics from sub-bass
-    for (int i = 0; i < len; i++) {
-        float x = _gainBuf[i];
-        float harmonic = 0.0f;
-        if (be.order == 0 || be.order == 2) {
-            harmonic += x * x;  // 2nd harmonic (sign-preserving would need abs, but x^2 generates 2f0)
-        }
-        if (be.order == 1 || be.order == 2) {
-            harmonic += x * x * x;  // 3rd harmonic
-        }
-        _gainBuf[i] = harmonic;
-    }
+// Standalone form of the three shelves the program compiler folds into a
+// biquad run (same cascade kernel, so the state format matches)
+static inline void dsp_tone_ctrl_process(DspToneCtrlParams &tc, float *buf, int len) {
+    dsp_biquad_cascade_f32(buf, len, (const float (*)[5])tc.bassCoeffs, (float (*)[2])tc.bassDelay, 1);
+    dsp_biquad_cascade_f32(buf, len, (const float (*)[5])tc.midCoeffs, (float (*)[2])tc.midDelay, 1);
+    dsp_biquad_cascade_f32(buf, len, (const float (*)[5])tc.trebleCoeffs, (float (*)[2])tc.trebleDelay, 1);
+}
 
-    // BPF to limit harmonic range
-    dsps_biquad_f32(_gainBuf, _gainBuf, len, be.bpfCoeffs, be.bpfDelay);
+// ===== Bass Enhancement =====
 
-    // Mix back (SIMD-accelerated: scale harmonics then add to dry signal)
-    dsps_mulc_f32(_gainBuf, _gainBuf, len, mixScale, 1, 1);
-    dsps_add_f32(buf, _gainBuf, buf, len, 1, 1, 1);
+static inline void dsp_bass_enhance_process(DspBassEnhanceParams &be, float *buf, int len) {
+    dsp_k_bass_enhance(be, _gainBuf, buf, len);
 }
 
 // ===== Multi-Band Compressor =====
 
 static void dsp_multiband_comp_process(DspMultibandCompParams &mb, float *buf, int len, uint32_t sampleRate) {
     if (mb.mbSlot < 0 || mb.mbSlot >= DSP_MULTIBAND_MAX_SLOTS) return;
-#ifdef NATIVE_TEST
-    DspMultibandSlot &slot = _mbSlots[mb.mbSlot];
-#else
+#ifndef NATIVE_TEST
     if (!_mbSlots) return;
-    DspMultibandSlot &slot = _mbSlots[mb.mbSlot];
 #endif
-
-    int numBands = mb.numBands;
-    if (numBands < 2) numBands = 2;
-    if (numBands > DSP_MULTIBAND_MAX_BANDS) numBands = DSP_MULTIBAND_MAX_BANDS;
-
-    // Split into bands using crossover filters (LR2 = single biquad per boundary)
-    // Band 0: LPF at freq[0]
-    // Band N-1: HPF at freq[N-2]
-    // Middle bands: BPF between freq[i-1] and freq[i]
-    int n = len > 256 ? 256 : len;
-
-    // Copy input to all band buffers initially
-    for (int b = 0; b < numBands; b++) {
-        memcpy(slot.bandBuf[b], buf, n * sizeof(float));
-    }
-
-    // Apply crossover filters
-    for (int boundary = 0; boundary < numBands - 1; boundary++) {
-        // LPF for lower band
-        dsps_biquad_f32(slot.bandBuf[boundary], slot.bandBuf[boundary], n,
-                        slot.xoverCoeffs[boundary][0], slot.xoverDelay[boundary][0]);
-        // HPF for upper band
-        dsps_biquad_f32(slot.bandBuf[boundary + 1], slot.bandBuf[boundary + 1], n,
-                        slot.xoverCoeffs[boundary][1], slot.xoverDelay[boundary][1]);
-    }
-
-    // Compress each band
-    for (int b = 0; b < numBands; b++) {
-        DspMultibandBand &band = slot.bands[b];
-        float threshLin = dsp_db_to_linear(band.thresholdDb);
-        float attackCoeff = dsp_time_coeff(band.attackMs, (float)sampleRate);
-        float releaseCoeff = dsp_time_coeff(band.releaseMs, (float)sampleRate);
-
-        float env = band.envelope;
-        float maxGr = 0.0f;
-
-        for (int i = 0; i < n; i++) {
-            float absSample = fabsf(slot.bandBuf[b][i]);
-            if (absSample > env)
-                env = attackCoeff * env + (1.0f - attackCoeff) * absSample;
-            else
-                env = releaseCoeff * env + (1.0f - releaseCoeff) * absSample;
-
-            float gainLin = band.makeupLinear;
-            if (env > 0.0f && env > threshLin) {
-                float envDb = 20.0f * log10f(env);
-                float overDb = envDb - band.thresholdDb;
-                float grDb = 0.0f;
-                if (band.kneeDb > 0.0f && overDb > -band.kneeDb / 2.0f && overDb < band.kneeDb / 2.0f) {
-                    float x = overDb + band.kneeDb / 2.0f;
-                    grDb = (1.0f - 1.0f / band.ratio) * x * x / (2.0f * band.kneeDb);
-                } else if (overDb >= band.kneeDb / 2.0f) {
-                    grDb = overDb * (1.0f - 1.0f / band.ratio);
-                }
-                if (grDb > 0.0f) {
-                    gainLin *= dsp_db_to_linear(-grDb);
-                    if (grDb > maxGr) maxGr = grDb;
-                }
-            }
-            slot.bandBuf[b][i] *= gainLin;
-        }
-        band.envelope = env;
-        band.gainReduction = -maxGr;
-    }
-
-    // Sum bands back (SIMD-accelerated)
-    memcpy(buf, slot.bandBuf[0], n * sizeof(float));
-    for (int b = 1; b < numBands; b++) {
-        dsps_add_f32(buf, slot.bandBuf[b], buf, n, 1, 1, 1);
-    }
+    dsp_k_multiband(_mbSlots[mb.mbSlot], mb.numBands, sampleRate, buf, len);
 }
 
 // ===== Stage CRUD =====
@@ -1417,23 +1980,13 @@ int dsp_add_stage(int channel, DspStageType type, int position) {
         }
         ch.stages[pos].delay.delaySlot = (int8_t)slot;
     } else if (type == DSP_DECIMATOR) {
-        int slot = dsp_fir_alloc_slot();
+        int slot = dsp_mr_alloc_slot();
         if (slot < 0) {
-            LOG_W("[DSP] No FIR slots for decimator (max %d)", DSP_MAX_FIR_SLOTS);
+            LOG_W("[DSP] No multirate slots available (max %d)", DSP_MAX_MULTIRATE_SLOTS);
             for (int i = pos; i < ch.stageCount; i++) ch.stages[i] = ch.stages[i + 1];
             return -1;
         }
-        ch.stages[pos].decimator.firSlot = (int8_t)slot;
-        ch.stages[pos].decimator.factor = 2;
-        // Design anti-aliasing filter (use half the max taps for efficiency)
-        int numTaps = DSP_MAX_FIR_TAPS / 2;
-        if (numTaps > DSP_MAX_FIR_TAPS) numTaps = DSP_MAX_FIR_TAPS;
-        ch.stages[pos].decimator.numTaps = (uint16_t)numTaps;
-        int inactiveIdx = 1 - _activeIndex;
-        float *taps = dsp_fir_get_taps(inactiveIdx, slot);
-        if (taps) {
-            dsp_compute_decimation_filter(taps, numTaps, 2, (float)cfg->sampleRate);
-        }
+        ch.stages[pos].decimator.mrSlot = (int8_t)slot;
     } else if (type == DSP_CONVOLUTION) {
         // Convolution slots are initialized separately via dsp_conv_init_slot()
         // Just mark as unassigned; user loads IR via API
@@ -1448,6 +2001,14 @@ int dsp_add_stage(int channel, DspStageType type, int position) {
             return -1;
         }
         ch.stages[pos].multibandComp.mbSlot = (int8_t)slot;
+    } else if (type == DSP_TRUE_PEAK_LIMITER) {
+        int slot = dsp_tp_alloc_slot();
+        if (slot < 0) {
+            LOG_W("[DSP] No true-peak limiter slots available (max %d)", DSP_MAX_TRUE_PEAK_SLOTS);
+            for (int i = pos; i < ch.stageCount; i++) ch.stages[i] = ch.stages[i + 1];
+            return -1;
+        }
+        ch.stages[pos].truePeak.tpSlot = (int8_t)slot;
     }
 
     ch.stageCount++;
@@ -1484,13 +2045,15 @@ bool dsp_remove_stage(int channel, int stageIndex) {
     } else if (ch.stages[stageIndex].type == DSP_DELAY) {
         dsp_delay_free_slot(ch.stages[stageIndex].delay.delaySlot);
     } else if (ch.stages[stageIndex].type == DSP_DECIMATOR) {
-        dsp_fir_free_slot(ch.stages[stageIndex].decimator.firSlot);
+        dsp_mr_free_slot(ch.stages[stageIndex].decimator.mrSlot);
     } else if (ch.stages[stageIndex].type == DSP_CONVOLUTION) {
         if (ch.stages[stageIndex].convolution.convSlot >= 0) {
             dsp_conv_free_slot(ch.stages[stageIndex].convolution.convSlot);
         }
     } else if (ch.stages[stageIndex].type == DSP_MULTIBAND_COMP) {
         dsp_mb_free_slot(ch.stages[stageIndex].multibandComp.mbSlot);
+    } else if (ch.stages[stageIndex].type == DSP_TRUE_PEAK_LIMITER) {
+        dsp_tp_free_slot(ch.stages[stageIndex].truePeak.tpSlot);
     }
 
     // Shift stages down
@@ -1594,8 +2157,18 @@ void dsp_copy_chain_stages(int srcChannel, int dstChannel) {
     int maxChain = DSP_MAX_STAGES - DSP_PEQ_BANDS;
     if (srcChainCount > maxChain) srcChainCount = maxChain;
 
+    // True-peak and multirate state is per channel — release the destination's
+    // slots and give each copied stage its own
+    for (int i = DSP_PEQ_BANDS; i < dst.stageCount; i++) {
+        if (dst.stages[i].type == DSP_TRUE_PEAK_LIMITER) dsp_tp_free_slot(dst.stages[i].truePeak.tpSlot);
+        else if (dst.stages[i].type == DSP_DECIMATOR) dsp_mr_free_slot(dst.stages[i].decimator.mrSlot);
+    }
+
     for (int i = 0; i < srcChainCount; i++) {
-        dst.stages[DSP_PEQ_BANDS + i] = src.stages[DSP_PEQ_BANDS + i];
+        DspStage &d = dst.stages[DSP_PEQ_BANDS + i];
+        d = src.stages[DSP_PEQ_BANDS + i];
+        if (d.type == DSP_TRUE_PEAK_LIMITER) d.truePeak.tpSlot = (int8_t)dsp_tp_alloc_slot();
+        else if (d.type == DSP_DECIMATOR) d.decimator.mrSlot = (int8_t)dsp_mr_alloc_slot();
     }
 
     // Update dst stageCount: keep PEQ bands, replace chain count
@@ -1626,11 +2199,13 @@ void dsp_mirror_channel_config(int srcCh, int dstCh) {
     for (int i = 0; i < dst.stageCount; i++) {
         if (dst.stages[i].type == DSP_FIR) dsp_fir_free_slot(dst.stages[i].fir.firSlot);
         else if (dst.stages[i].type == DSP_DELAY) dsp_delay_free_slot(dst.stages[i].delay.delaySlot);
-        else if (dst.stages[i].type == DSP_DECIMATOR) dsp_fir_free_slot(dst.stages[i].decimator.firSlot);
+        else if (dst.stages[i].type == DSP_DECIMATOR) dsp_mr_free_slot(dst.stages[i].decimator.mrSlot);
         else if (dst.stages[i].type == DSP_CONVOLUTION && dst.stages[i].convolution.convSlot >= 0)
             dsp_conv_free_slot(dst.stages[i].convolution.convSlot);
         else if (dst.stages[i].type == DSP_MULTIBAND_COMP)
             dsp_mb_free_slot(dst.stages[i].multibandComp.mbSlot);
+        else if (dst.stages[i].type == DSP_TRUE_PEAK_LIMITER)
+            dsp_tp_free_slot(dst.stages[i].truePeak.tpSlot);
     }
 
     // Copy config params (bypass, stageCount, all stage params)
@@ -1660,8 +2235,11 @@ void dsp_mirror_channel_config(int srcCh, int dstCh) {
                 dst.stages[i].fir.delayPos = 0;
                 int inactiveIdx = 1 - _activeIndex;
                 float *srcTaps = dsp_fir_get_taps(inactiveIdx, src.stages[i].fir.firSlot);
-                float *dstTaps = dsp_fir_get_taps(inactiveIdx, newSlot);
-                if (srcTaps && dstTaps) memcpy(dstTaps, srcTaps, sizeof(float) * DSP_MAX_FIR_TAPS);
+                for (int st = 0; st < 2; st++) {
+                    float *dstTaps = dsp_fir_get_taps(st, newSlot);
+                    if (srcTaps && dstTaps) memcpy(dstTaps, srcTaps, sizeof(float) * DSP_MAX_FIR_TAPS);
+                }
+                dsp_fir_commit_taps(newSlot, dst.stages[i].fir.numTaps);
             } else {
                 dst.stages[i].fir.firSlot = -1;
             }
@@ -1675,17 +2253,7 @@ void dsp_mirror_channel_config(int srcCh, int dstCh) {
                 dst.stages[i].delay.delaySlot = -1;
             }
         } else if (dst.stages[i].type == DSP_DECIMATOR) {
-            int newSlot = dsp_fir_alloc_slot();
-            if (newSlot >= 0) {
-                dst.stages[i].decimator.firSlot = (int8_t)newSlot;
-                dst.stages[i].decimator.delayPos = 0;
-                int inactiveIdx = 1 - _activeIndex;
-                float *srcTaps = dsp_fir_get_taps(inactiveIdx, src.stages[i].decimator.firSlot);
-                float *dstTaps = dsp_fir_get_taps(inactiveIdx, newSlot);
-                if (srcTaps && dstTaps) memcpy(dstTaps, srcTaps, sizeof(float) * DSP_MAX_FIR_TAPS);
-            } else {
-                dst.stages[i].decimator.firSlot = -1;
-            }
+            dst.stages[i].decimator.mrSlot = (int8_t)dsp_mr_alloc_slot();
         } else if (dst.stages[i].type == DSP_CONVOLUTION) {
             // Convolution slots are shared resources loaded from IR files.
             // For mirror, mark as unassigned — user must load IR separately.
@@ -1708,10 +2276,219 @@ void dsp_mirror_channel_config(int srcCh, int dstCh) {
             // Multiband comp slots are scarce — allocate new for destination
             int newSlot = dsp_mb_alloc_slot();
             dst.stages[i].multibandComp.mbSlot = (int8_t)newSlot;
+        } else if (dst.stages[i].type == DSP_TRUE_PEAK_LIMITER) {
+            dst.stages[i].truePeak.tpSlot = (int8_t)dsp_tp_alloc_slot();
+            dst.stages[i].truePeak.gainReduction = 0.0f;
         }
     }
 }
 
+// ===== Binary Config Image =====
+
+// Release the pool slots held by a channel's stages (before reloading it)
+static void _free_channel_slots(DspChannelConfig &ch) {
+    for (int i = 0; i < ch.stageCount; i++) {
+        if (ch.stages[i].type == DSP_FIR) {
+            dsp_fir_free_slot(ch.stages[i].fir.firSlot);
+        } else if (ch.stages[i].type == DSP_DELAY) {
+            dsp_delay_free_slot(ch.stages[i].delay.delaySlot);
+        } else if (ch.stages[i].type == DSP_DECIMATOR) {
+            dsp_mr_free_slot(ch.stages[i].decimator.mrSlot);
+        } else if (ch.stages[i].type == DSP_CONVOLUTION && ch.stages[i].convolution.convSlot >= 0) {
+            dsp_conv_free_slot(ch.stages[i].convolution.convSlot);
+        } else if (ch.stages[i].type == DSP_TRUE_PEAK_LIMITER) {
+            dsp_tp_free_slot(ch.stages[i].truePeak.tpSlot);
+        }
+    }
+}
+
+// Taps follow a stage record only when it had loaded taps when packed
+static inline bool _image_has_taps(const DspStage &s) {
+    return s.type == DSP_FIR && s.fir.firSlot >= 0 && s.fir.numTaps > 0;
+}
+
+// Clear what _migrate_stage would carry across a swap, so a restored stage
+// starts like a freshly loaded one
+static void _reset_stage_runtime(DspStage &s) {
+    if (dsp_is_biquad_type(s.type)) {
+        s.biquad.delay[0] = s.biquad.delay[1] = 0.0f;
+        s.biquad.morphRemaining = 0;
+    } else if (s.type == DSP_FIR) {
+        s.fir.mode = DSP_FIR_MODE_DIRECT;
+        s.fir.cpuPercent = 0.0f;
+    } else if (s.type == DSP_LIMITER) {
+        s.limiter.envelope = 0.0f;
+        s.limiter.gainReduction = 0.0f;
+    } else if (s.type == DSP_DELAY) {
+        s.delay.writePos = 0;
+        s.delay.apState = 0.0f;
+    } else if (s.type == DSP_GAIN) {
+        s.gain.currentLinear = s.gain.gainLinear;   // No ramp on load
+    } else if (s.type == DSP_COMPRESSOR) {
+        s.compressor.envelope = 0.0f;
+        s.compressor.gainReduction = 0.0f;
+    } else if (s.type == DSP_NOISE_GATE) {
+        s.noiseGate.envelope = 0.0f;
+        s.noiseGate.gainReduction = 0.0f;
+        s.noiseGate.holdCounter = 0.0f;
+    } else if (s.type == DSP_TONE_CTRL) {
+        memset(s.toneCtrl.bassDelay, 0, sizeof(s.toneCtrl.bassDelay));
+        memset(s.toneCtrl.midDelay, 0, sizeof(s.toneCtrl.midDelay));
+        memset(s.toneCtrl.trebleDelay, 0, sizeof(s.toneCtrl.trebleDelay));
+    } else if (s.type == DSP_LOUDNESS) {
+        memset(s.loudness.bassDelay, 0, sizeof(s.loudness.bassDelay));
+        memset(s.loudness.trebleDelay, 0, sizeof(s.loudness.trebleDelay));
+    } else if (s.type == DSP_BASS_ENHANCE) {
+        memset(s.bassEnhance.hpfDelay, 0, sizeof(s.bassEnhance.hpfDelay));
+        memset(s.bassEnhance.bpfDelay, 0, sizeof(s.bassEnhance.bpfDelay));
+    } else if (s.type == DSP_TRUE_PEAK_LIMITER) {
+        s.truePeak.gainReduction = 0.0f;
+    }
+}
+
+// Give a restored stage fresh pool slots (the packed indices belonged to the
+// previous boot's pools). `taps` is the stage's packed taps or null. Returns
+// false if a pool is exhausted; the stage is then skipped, as on JSON load.
+static bool _image_restore_slots(DspStage &s, const uint8_t *taps) {
+    int slot = 0;
+    if (s.type == DSP_FIR) {
+        slot = dsp_fir_alloc_slot();
+        if (slot < 0) return false;
+        s.fir.firSlot = (int8_t)slot;
+        float *t0 = dsp_fir_get_taps(0, slot);
+        float *t1 = dsp_fir_get_taps(1, slot);
+        if (taps && t0) {
+            memcpy(t0, taps, s.fir.numTaps * sizeof(float));
+            if (t1) memcpy(t1, t0, s.fir.numTaps * sizeof(float));
+            dsp_fir_commit_taps(slot, s.fir.numTaps);
+        }
+    } else if (s.type == DSP_DELAY) {
+        slot = dsp_delay_alloc_slot();
+        s.delay.delaySlot = (int8_t)slot;
+        if (s.delay.delaySamples > DSP_MAX_DELAY_SAMPLES) s.delay.delaySamples = DSP_MAX_DELAY_SAMPLES;
+    } else if (s.type == DSP_DECIMATOR) {
+        slot = dsp_mr_alloc_slot();
+        s.decimator.mrSlot = (int8_t)slot;
+    } else if (s.type == DSP_MULTIBAND_COMP) {
+        slot = dsp_mb_alloc_slot();
+        s.multibandComp.mbSlot = (int8_t)slot;
+    } else if (s.type == DSP_TRUE_PEAK_LIMITER) {
+        slot = dsp_tp_alloc_slot();
+        s.truePeak.tpSlot = (int8_t)slot;
+    } else if (s.type == DSP_CONVOLUTION) {
+        // Convolution slot must be loaded separately via IR upload API
+        s.convolution.convSlot = -1;
+    }
+    return slot >= 0;
+}
+
+size_t dsp_image_pack(uint8_t *buf, size_t cap) {
+    if (!buf) return 0;
+    int activeIdx = _activeIndex;
+    DspState *cfg = &_states[activeIdx];
+
+    DspImageHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.version = DSP_IMAGE_VERSION;
+    hdr.stageBytes = sizeof(DspStage);
+    hdr.channels = DSP_MAX_CHANNELS;
+    hdr.maxStages = DSP_MAX_STAGES;
+    hdr.globalBypass = cfg->globalBypass ? 1 : 0;
+    hdr.sampleRate = cfg->sampleRate;
+    if (cap < sizeof(hdr)) return 0;
+    memcpy(buf, &hdr, sizeof(hdr));
+    size_t pos = sizeof(hdr);
+
+    for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+        const DspChannelConfig &chCfg = cfg->channels[ch];
+        DspImageChannel c = { (uint8_t)(chCfg.bypass ? 1 : 0), (uint8_t)(chCfg.stereoLink ? 1 : 0),
+                              chCfg.stageCount, 0 };
+        size_t n = chCfg.stageCount * sizeof(DspStage);
+        if (pos + sizeof(c) + n > cap) return 0;
+        memcpy(buf + pos, &c, sizeof(c));
+        memcpy(buf + pos + sizeof(c), chCfg.stages, n);
+        pos += sizeof(c) + n;
+    }
+
+    for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+        const DspChannelConfig &chCfg = cfg->channels[ch];
+        for (int i = 0; i < chCfg.stageCount; i++) {
+            const DspStage &s = chCfg.stages[i];
+            if (!_image_has_taps(s)) continue;
+            size_t n = s.fir.numTaps * sizeof(float);
+            if (pos + n > cap) return 0;
+            const float *taps = dsp_fir_get_taps(activeIdx, s.fir.firSlot);
+            if (taps) memcpy(buf + pos, taps, n);
+            else memset(buf + pos, 0, n);
+            pos += n;
+        }
+    }
+    return pos;
+}
+
+bool dsp_image_unpack(const uint8_t *buf, size_t len) {
+    if (!buf || len < sizeof(DspImageHeader)) return false;
+    DspImageHeader hdr;
+    memcpy(&hdr, buf, sizeof(hdr));
+    if (hdr.version != DSP_IMAGE_VERSION || hdr.stageBytes != sizeof(DspStage) ||
+        hdr.channels != DSP_MAX_CHANNELS || hdr.maxStages != DSP_MAX_STAGES) return false;
+
+    // Walk the whole image before touching the config
+    size_t stagePos[DSP_MAX_CHANNELS];
+    DspImageChannel chHdr[DSP_MAX_CHANNELS];
+    size_t pos = sizeof(hdr);
+    for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+        if (pos + sizeof(DspImageChannel) > len) return false;
+        memcpy(&chHdr[ch], buf + pos, sizeof(DspImageChannel));
+        if (chHdr[ch].stageCount > DSP_MAX_STAGES) return false;
+        stagePos[ch] = pos + sizeof(DspImageChannel);
+        pos = stagePos[ch] + chHdr[ch].stageCount * sizeof(DspStage);
+        if (pos > len) return false;
+    }
+    size_t tapsPos = pos;
+    DspStage s;
+    for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+        for (int i = 0; i < chHdr[ch].stageCount; i++) {
+            memcpy(&s, buf + stagePos[ch] + i * sizeof(DspStage), sizeof(DspStage));
+            if (s.type >= DSP_STAGE_TYPE_COUNT) return false;
+            if (!_image_has_taps(s)) continue;
+            if (s.fir.numTaps > DSP_MAX_FIR_TAPS) return false;
+            pos += s.fir.numTaps * sizeof(float);
+        }
+    }
+    if (pos != len) return false;
+
+    DspState *cfg = dsp_get_inactive_config();
+    cfg->globalBypass = hdr.globalBypass != 0;
+    cfg->sampleRate = hdr.sampleRate;
+    pos = tapsPos;
+    for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+        DspChannelConfig &chCfg = cfg->channels[ch];
+        _free_channel_slots(chCfg);
+        chCfg.bypass = chHdr[ch].bypass != 0;
+        chCfg.stereoLink = chHdr[ch].stereoLink != 0;
+        chCfg.stageCount = 0;
+        for (int i = 0; i < chHdr[ch].stageCount; i++) {
+            DspStage &dst = chCfg.stages[chCfg.stageCount];
+            memcpy(&dst, buf + stagePos[ch] + i * sizeof(DspStage), sizeof(DspStage));
+            const uint8_t *taps = nullptr;
+            if (_image_has_taps(dst)) {
+                taps = buf + pos;
+                pos += dst.fir.numTaps * sizeof(float);
+            }
+            if (!_image_restore_slots(dst, taps)) {
+                LOG_W("[DSP] Image: pool slot alloc failed, skipping stage");
+                continue;
+            }
+            dst.id = dsp_next_stage_id();
+            dst.label[sizeof(dst.label) - 1] = '\0';
+            _reset_stage_runtime(dst);
+            chCfg.stageCount++;
+        }
+    }
+    return true;
+}
+
 // ===== JSON Serialization =====
 
 #ifndef NATIVE_TEST
@@ -1752,6 +2529,8 @@ const char *stage_type_name(DspStageType t) {
         case DSP_LOUDNESS:         return "LOUDNESS";
         case DSP_BASS_ENHANCE:     return "BASS_ENHANCE";
         case DSP_MULTIBAND_COMP:   return "MULTIBAND_COMP";
+        case DSP_TRUE_PEAK_LIMITER: return "TRUE_PEAK_LIMITER";
+        case DSP_INTERPOLATOR:     return "INTERPOLATOR";
         default: return "UNKNOWN";
     }
 }
@@ -1788,6 +2567,8 @@ static DspStageType stage_type_from_name(const char *name) {
     if (strcmp(name, "LOUDNESS") == 0) return DSP_LOUDNESS;
     if (strcmp(name, "BASS_ENHANCE") == 0) return DSP_BASS_ENHANCE;
     if (strcmp(name, "MULTIBAND_COMP") == 0) return DSP_MULTIBAND_COMP;
+    if (strcmp(name, "TRUE_PEAK_LIMITER") == 0) return DSP_TRUE_PEAK_LIMITER;
+    if (strcmp(name, "INTERPOLATOR") == 0) return DSP_INTERPOLATOR;
     return DSP_BIQUAD_PEQ;
 }
 
@@ -1809,6 +2590,7 @@ void dsp_export_config_to_json(int channel, char *buf, int bufSize) {
         stageObj["enabled"] = s.enabled;
         stageObj["type"] = stage_type_name(s.type);
         if (s.label[0]) stageObj["label"] = s.label;
+        if (s.priority != dsp_default_priority(s.type)) stageObj["priority"] = s.priority;
 
         if (dsp_is_biquad_type(s.type)) {
             JsonObject params = stageObj["params"].to<JsonObject>();
@@ -1838,6 +2620,10 @@ void dsp_export_config_to_json(int channel, char *buf, int bufSize) {
         } else if (s.type == DSP_DELAY) {
             JsonObject params = stageObj["params"].to<JsonObject>();
             params["delaySamples"] = s.delay.delaySamples;
+            if (s.delay.interp != DSP_DELAY_INTERP_NONE) {
+                params["fraction"] = s.delay.fraction;
+                params["interp"] = s.delay.interp;
+            }
         } else if (s.type == DSP_POLARITY) {
             JsonObject params = stageObj["params"].to<JsonObject>();
             params["inverted"] = s.polarity.inverted;
@@ -1889,6 +2675,15 @@ void dsp_export_config_to_json(int channel, char *buf, int bufSize) {
         } else if (s.type == DSP_MULTIBAND_COMP) {
             JsonObject params = stageObj["params"].to<JsonObject>();
             params["numBands"] = s.multibandComp.numBands;
+        } else if (s.type == DSP_TRUE_PEAK_LIMITER) {
+            JsonObject params = stageObj["params"].to<JsonObject>();
+            params["ceilingDb"] = s.truePeak.ceilingDb;
+            params["lookaheadMs"] = s.truePeak.lookaheadMs;
+            params["releaseMs"] = s.truePeak.releaseMs;
+            params["linked"] = s.truePeak.linked;
+        } else if (s.type == DSP_DECIMATOR) {
+            JsonObject params = stageObj["params"].to<JsonObject>();
+            params["factor"] = s.decimator.factor;
         }
     }
 
@@ -1902,17 +2697,7 @@ void dsp_load_config_from_json(const char *json, int channel) {
     DspChannelConfig &ch = cfg->channels[channel];
 
     // Free any existing pool slots for this channel
-    for (int i = 0; i < ch.stageCount; i++) {
-        if (ch.stages[i].type == DSP_FIR) {
-            dsp_fir_free_slot(ch.stages[i].fir.firSlot);
-        } else if (ch.stages[i].type == DSP_DELAY) {
-            dsp_delay_free_slot(ch.stages[i].delay.delaySlot);
-        } else if (ch.stages[i].type == DSP_DECIMATOR) {
-            dsp_fir_free_slot(ch.stages[i].decimator.firSlot);
-        } else if (ch.stages[i].type == DSP_CONVOLUTION && ch.stages[i].convolution.convSlot >= 0) {
-            dsp_conv_free_slot(ch.stages[i].convolution.convSlot);
-        }
-    }
+    _free_channel_slots(ch);
 
     JsonDocument doc;
     if (deserializeJson(doc, json)) return;
@@ -1954,6 +2739,7 @@ void dsp_load_config_from_json(const char *json, int channel) {
                 strncpy(s.label, stageObj["label"].as<const char *>(), sizeof(s.label) - 1);
                 s.label[sizeof(s.label) - 1] = '\0';
             }
+            if (stageObj["priority"].is<int>()) s.priority = dsp_clamp_priority(stageObj["priority"].as<int>());
 
             JsonObject params = stageObj["params"];
             if (dsp_is_biquad_type(type)) {
@@ -1982,6 +2768,7 @@ void dsp_load_config_from_json(const char *json, int channel) {
                 if (slot < 0) { LOG_W("[DSP] Import: FIR slot alloc failed, skipping stage"); continue; }
                 s.fir.firSlot = (int8_t)slot;
                 if (params["numTaps"].is<int>()) s.fir.numTaps = params["numTaps"].as<uint16_t>();
+                if (s.fir.numTaps > DSP_MAX_FIR_TAPS) s.fir.numTaps = DSP_MAX_FIR_TAPS;
             } else if (type == DSP_DELAY) {
                 int slot = dsp_delay_alloc_slot();
                 if (slot < 0) { LOG_W("[DSP] Import: delay slot alloc failed, skipping stage"); continue; }
@@ -1990,6 +2777,10 @@ void dsp_load_config_from_json(const char *json, int channel) {
                     uint16_t ds = params["delaySamples"].as<uint16_t>();
                     s.delay.delaySamples = ds > DSP_MAX_DELAY_SAMPLES ? DSP_MAX_DELAY_SAMPLES : ds;
                 }
+                if (params["fraction"].is<float>() || params["interp"].is<int>()) {
+                    dsp_delay_set_fraction(s.delay, params["fraction"] | s.delay.fraction,
+                                           params["interp"] | (int)s.delay.interp);
+                }
             } else if (type == DSP_POLARITY) {
                 if (params["inverted"].is<bool>()) s.polarity.inverted = params["inverted"].as<bool>();
             } else if (type == DSP_MUTE) {
@@ -2042,6 +2833,20 @@ void dsp_load_config_from_json(const char *json, int channel) {
                 int slot = dsp_mb_alloc_slot();
                 if (slot < 0) { LOG_W("[DSP] Import: multiband slot alloc failed, skipping"); continue; }
                 s.multibandComp.mbSlot = (int8_t)slot;
+            } else if (type == DSP_TRUE_PEAK_LIMITER) {
+                if (params["ceilingDb"].is<float>()) s.truePeak.ceilingDb = params["ceilingDb"].as<float>();
+                if (params["lookaheadMs"].is<float>()) s.truePeak.lookaheadMs = params["lookaheadMs"].as<float>();
+                if (params["releaseMs"].is<float>()) s.truePeak.releaseMs = params["releaseMs"].as<float>();
+                if (params["linked"].is<bool>()) s.truePeak.linked = params["linked"].as<bool>();
+                dsp_tp_clamp_params(s.truePeak);
+                int slot = dsp_tp_alloc_slot();
+                if (slot < 0) { LOG_W("[DSP] Import: true-peak slot alloc failed, skipping"); continue; }
+                s.truePeak.tpSlot = (int8_t)slot;
+            } else if (type == DSP_DECIMATOR) {
+                if (params["factor"].is<int>()) s.decimator.factor = dsp_clamp_decimator_factor(params["factor"].as<int>());
+                int slot = dsp_mr_alloc_slot();
+                if (slot < 0) { LOG_W("[DSP] Import: multirate slot alloc failed, skipping"); continue; }
+                s.decimator.mrSlot = (int8_t)slot;
             }
             loadIdx++;
             ch.stageCount = loadIdx;
@@ -2071,6 +2876,7 @@ void dsp_export_full_config_json(char *buf, int bufSize) {
             stageObj["enabled"] = s.enabled;
             stageObj["type"] = stage_type_name(s.type);
             if (s.label[0]) stageObj["label"] = s.label;
+            if (s.priority != dsp_default_priority(s.type)) stageObj["priority"] = s.priority;
 
             if (dsp_is_biquad_type(s.type)) {
                 JsonObject params = stageObj["params"].to<JsonObject>();
@@ -2100,6 +2906,10 @@ void dsp_export_full_config_json(char *buf, int bufSize) {
             } else if (s.type == DSP_DELAY) {
                 JsonObject params = stageObj["params"].to<JsonObject>();
                 params["delaySamples"] = s.delay.delaySamples;
+                if (s.delay.interp != DSP_DELAY_INTERP_NONE) {
+                    params["fraction"] = s.delay.fraction;
+                    params["interp"] = s.delay.interp;
+                }
             } else if (s.type == DSP_POLARITY) {
                 JsonObject params = stageObj["params"].to<JsonObject>();
                 params["inverted"] = s.polarity.inverted;
@@ -2151,6 +2961,15 @@ void dsp_export_full_config_json(char *buf, int bufSize) {
             } else if (s.type == DSP_MULTIBAND_COMP) {
                 JsonObject params = stageObj["params"].to<JsonObject>();
                 params["numBands"] = s.multibandComp.numBands;
+            } else if (s.type == DSP_TRUE_PEAK_LIMITER) {
+                JsonObject params = stageObj["params"].to<JsonObject>();
+                params["ceilingDb"] = s.truePeak.ceilingDb;
+                params["lookaheadMs"] = s.truePeak.lookaheadMs;
+                params["releaseMs"] = s.truePeak.releaseMs;
+                params["linked"] = s.truePeak.linked;
+            } else if (s.type == DSP_DECIMATOR) {
+                JsonObject params = stageObj["params"].to<JsonObject>();
+                params["factor"] = s.decimator.factor;
             }
         }
     }
@@ -2170,11 +2989,13 @@ void dsp_import_full_config_json(const char *json) {
             } else if (cfg->channels[c].stages[i].type == DSP_DELAY) {
                 dsp_delay_free_slot(cfg->channels[c].stages[i].delay.delaySlot);
             } else if (cfg->channels[c].stages[i].type == DSP_DECIMATOR) {
-                dsp_fir_free_slot(cfg->channels[c].stages[i].decimator.firSlot);
+                dsp_mr_free_slot(cfg->channels[c].stages[i].decimator.mrSlot);
             } else if (cfg->channels[c].stages[i].type == DSP_CONVOLUTION && cfg->channels[c].stages[i].convolution.convSlot >= 0) {
                 dsp_conv_free_slot(cfg->channels[c].stages[i].convolution.convSlot);
             } else if (cfg->channels[c].stages[i].type == DSP_MULTIBAND_COMP) {
                 dsp_mb_free_slot(cfg->channels[c].stages[i].multibandComp.mbSlot);
+            } else if (cfg->channels[c].stages[i].type == DSP_TRUE_PEAK_LIMITER) {
+                dsp_tp_free_slot(cfg->channels[c].stages[i].truePeak.tpSlot);
             }
         }
     }
@@ -2226,6 +3047,7 @@ void dsp_import_full_config_json(const char *json) {
                         strncpy(s.label, stageObj["label"].as<const char *>(), sizeof(s.label) - 1);
                         s.label[sizeof(s.label) - 1] = '\0';
                     }
+                    if (stageObj["priority"].is<int>()) s.priority = dsp_clamp_priority(stageObj["priority"].as<int>());
 
                     JsonObject params = stageObj["params"];
                     if (dsp_is_biquad_type(type)) {
@@ -2252,6 +3074,7 @@ void dsp_import_full_config_json(const char *json) {
                         if (slot < 0) { LOG_W("[DSP] Import: FIR slot alloc failed, skipping stage"); continue; }
                         s.fir.firSlot = (int8_t)slot;
                         if (params["numTaps"].is<int>()) s.fir.numTaps = params["numTaps"].as<uint16_t>();
+                        if (s.fir.numTaps > DSP_MAX_FIR_TAPS) s.fir.numTaps = DSP_MAX_FIR_TAPS;
                     } else if (type == DSP_DELAY) {
                         int slot = dsp_delay_alloc_slot();
                         if (slot < 0) { LOG_W("[DSP] Import: delay slot alloc failed, skipping stage"); continue; }
@@ -2260,6 +3083,10 @@ void dsp_import_full_config_json(const char *json) {
                             uint16_t ds = params["delaySamples"].as<uint16_t>();
                             s.delay.delaySamples = ds > DSP_MAX_DELAY_SAMPLES ? DSP_MAX_DELAY_SAMPLES : ds;
                         }
+                        if (params["fraction"].is<float>() || params["interp"].is<int>()) {
+                            dsp_delay_set_fraction(s.delay, params["fraction"] | s.delay.fraction,
+                                                   params["interp"] | (int)s.delay.interp);
+                        }
                     } else if (type == DSP_POLARITY) {
                         if (params["inverted"].is<bool>()) s.polarity.inverted = params["inverted"].as<bool>();
                     } else if (type == DSP_MUTE) {
@@ -2311,6 +3138,20 @@ void dsp_import_full_config_json(const char *json) {
                         int slot = dsp_mb_alloc_slot();
                         if (slot < 0) { LOG_W("[DSP] Import: multiband slot alloc failed, skipping"); continue; }
                         s.multibandComp.mbSlot = (int8_t)slot;
+                    } else if (type == DSP_TRUE_PEAK_LIMITER) {
+                        if (params["ceilingDb"].is<float>()) s.truePeak.ceilingDb = params["ceilingDb"].as<float>();
+                        if (params["lookaheadMs"].is<float>()) s.truePeak.lookaheadMs = params["lookaheadMs"].as<float>();
+                        if (params["releaseMs"].is<float>()) s.truePeak.releaseMs = params["releaseMs"].as<float>();
+                        if (params["linked"].is<bool>()) s.truePeak.linked = params["linked"].as<bool>();
+                        dsp_tp_clamp_params(s.truePeak);
+                        int slot = dsp_tp_alloc_slot();
+                        if (slot < 0) { LOG_W("[DSP] Import: true-peak slot alloc failed, skipping"); continue; }
+                        s.truePeak.tpSlot = (int8_t)slot;
+                    } else if (type == DSP_DECIMATOR) {
+                        if (params["factor"].is<int>()) s.decimator.factor = dsp_clamp_decimator_factor(params["factor"].as<int>());
+                        int slot = dsp_mr_alloc_slot();
+                        if (slot < 0) { LOG_W("[DSP] Import: multirate slot alloc failed, skipping"); continue; }
+                        s.decimator.mrSlot = (int8_t)slot;
                     }
                     loadIdx++;
                     ch.stageCount = loadIdx;
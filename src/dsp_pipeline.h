@@ -11,6 +11,7 @@
 #ifndef NATIVE_TEST
 #include "debug_serial.h"
 #endif
+#include "dsp_governor.h"
 
 // ===== Stage Types =====
 enum DspStageType : uint8_t {
@@ -36,7 +37,7 @@ enum DspStageType : uint8_t {
     DSP_BIQUAD_LPF_1ST = 19,   // First-order LPF (b2=0, a2=0)
     DSP_BIQUAD_HPF_1ST = 20,   // First-order HPF (b2=0, a2=0)
     DSP_BIQUAD_LINKWITZ = 21,  // Linkwitz Transform (F0, Q0, Fp, Qp)
-    DSP_DECIMATOR = 22,        // Decimation FIR (integer downsampling)
+    DSP_DECIMATOR = 22,        // Opens a multirate section (half-band decimation by 2/4/8)
     DSP_CONVOLUTION = 23,      // Partitioned convolution (room correction IR)
     DSP_NOISE_GATE = 24,       // Noise gate / expander
     DSP_TONE_CTRL = 25,        // 3-band bass/mid/treble tone controls
@@ -45,6 +46,8 @@ enum DspStageType : uint8_t {
     DSP_LOUDNESS = 28,         // Fletcher-Munson loudness compensation
     DSP_BASS_ENHANCE = 29,     // Psychoacoustic bass enhancement
     DSP_MULTIBAND_COMP = 30,   // Multi-band compressor (2-4 bands)
+    DSP_TRUE_PEAK_LIMITER = 31, // Lookahead limiter with 4x oversampled peak detection
+    DSP_INTERPOLATOR = 32,     // Closes a multirate section (interpolates back to the pipeline rate)
     DSP_STAGE_TYPE_COUNT
 };
 
@@ -77,11 +80,23 @@ struct DspLimiterParams {
     float gainReduction;// Current GR in dB (runtime, for metering)
 };
 
-// ===== FIR Parameters (taps/delay stored in external pool) =====
+// ===== FIR Parameters (taps and kernel state stored in external pool) =====
+// FIR stages run the block kernels in dsp_fir_block.h: direct below the FFT
+// crossover, uniformly partitioned overlap-save from it. The crossover starts
+// at DSP_FIR_FFT_MIN_TAPS and is re-measured on the target the first time a
+// long filter is committed.
+#ifndef DSP_FIR_FFT_MIN_TAPS
+#define DSP_FIR_FFT_MIN_TAPS 128
+#endif
+#define DSP_FIR_MODE_DIRECT 0                       // DspFirParams::mode values
+#define DSP_FIR_MODE_FFT    1
+
 struct DspFirParams {
-    uint16_t numTaps;
-    uint16_t delayPos;
-    int8_t firSlot;     // Index into static FIR pool (-1 = unassigned)
+    uint16_t numTaps;   // Active length, 1..DSP_MAX_FIR_TAPS
+    uint16_t delayPos;  // Unused by the block kernel (kept for config layout)
+    int8_t firSlot;     // Index into FIR pool (-1 = unassigned)
+    uint8_t mode;       // Kernel used last block: DSP_FIR_MODE_DIRECT / _FFT (runtime)
+    float cpuPercent;   // Share of the block period spent in this stage (runtime, smoothed)
 };
 
 // ===== Gain Parameters =====
@@ -92,10 +107,42 @@ struct DspGainParams {
 };
 
 // ===== Delay Parameters (delay line stored in external pool) =====
+// Each pool slot is a power-of-two ring (DSP_DELAY_RING_SIZE floats, shared by both states)
+// so positions wrap with a mask and a block reads/writes as at most two
+// contiguous segments. Ring headroom covers one processing chunk plus the
+// interpolator taps beyond DSP_MAX_DELAY_SAMPLES.
+#define DSP_DELAY_CHUNK       256   // Max frames per ring write/read pass
+#define DSP_DELAY_INTERP_TAPS 4     // 3rd-order Lagrange footprint
+
+static constexpr uint32_t dsp_pow2_ceil(uint32_t v, uint32_t p = 1) {
+    return p >= v ? p : dsp_pow2_ceil(v, p << 1);
+}
+static constexpr uint32_t DSP_DELAY_RING_SIZE =
+    dsp_pow2_ceil(DSP_MAX_DELAY_SAMPLES + DSP_DELAY_CHUNK + DSP_DELAY_INTERP_TAPS);
+static constexpr uint32_t DSP_DELAY_RING_MASK = DSP_DELAY_RING_SIZE - 1;
+static_assert(DSP_DELAY_RING_SIZE <= 65536, "delay ring position must fit writePos");
+
+// Pool budget: slots beyond what fits in this many bytes (one ring each)
+// are refused even if DSP_MAX_DELAY_SLOTS allows more.
+#ifndef DSP_DELAY_PSRAM_BUDGET
+#define DSP_DELAY_PSRAM_BUDGET (2UL * 1024UL * 1024UL)
+#endif
+
+// Fractional (sub-sample) delay on top of delaySamples
+enum DspDelayInterp : uint8_t {
+    DSP_DELAY_INTERP_NONE = 0,      // Integer delay only (block copy)
+    DSP_DELAY_INTERP_LAGRANGE,      // 3rd-order Lagrange FIR (flat group delay, mild HF roll-off)
+    DSP_DELAY_INTERP_THIRAN,        // 1st-order Thiran allpass (flat magnitude)
+    DSP_DELAY_INTERP_COUNT
+};
+
 struct DspDelayParams {
-    uint16_t delaySamples;  // Delay in samples (max DSP_MAX_DELAY_SAMPLES)
-    uint16_t writePos;      // Current write position in circular buffer
-    int8_t delaySlot;       // Index into static delay pool (-1 = unassigned)
+    uint16_t delaySamples;  // Integer delay in samples (max DSP_MAX_DELAY_SAMPLES)
+    uint16_t writePos;      // Current write position in the ring
+    int8_t delaySlot;       // Index into delay pool (-1 = unassigned)
+    uint8_t interp;         // DspDelayInterp
+    float fraction;         // Fractional delay 0..<1 samples (used when interp != NONE)
+    float apState;          // Thiran allpass y[n-1] (runtime state, not persisted)
 };
 
 // ===== Polarity Parameters =====
@@ -121,12 +168,19 @@ struct DspCompressorParams {
     float gainReduction;    // Current GR in dB (runtime, for metering)
 };
 
-// ===== Decimator Parameters =====
+// ===== Multirate Section (Decimator) Parameters =====
+// A DSP_DECIMATOR stage opens a section: the enabled stages after it, up to
+// the next DSP_INTERPOLATOR (or the end of the chain), run at
+// sampleRate / factor, and the result is interpolated back to the pipeline
+// rate. Sections do not nest. Pool slots hold a DspMultirateState
+// (dsp_multirate.h, ~2.5KB each, PSRAM) with the half-band cascades.
+#ifndef DSP_MAX_MULTIRATE_SLOTS
+#define DSP_MAX_MULTIRATE_SLOTS 4
+#endif
+
 struct DspDecimatorParams {
-    uint8_t  factor;    // Decimation factor (2, 4, or 8)
-    int8_t   firSlot;   // Index into FIR pool (-1 = unassigned)
-    uint16_t numTaps;   // Anti-aliasing filter tap count
-    uint16_t delayPos;  // Current position in FIR delay line
+    uint8_t  factor;    // Rate divider of the section (2, 4, or 8)
+    int8_t   mrSlot;    // Index into multirate pool (-1 = unassigned)
 };
 
 // ===== Convolution Parameters =====
@@ -194,11 +248,48 @@ struct DspMultibandCompParams {
     int8_t mbSlot;       // Pool slot index (-1 = unassigned)
 };
 
+// ===== True-Peak Limiter Parameters (slim — detector/lookahead state in pool) =====
+// Pool slots hold a DspTruePeakState (dsp_true_peak.h, ~16KB each, PSRAM).
+#ifndef DSP_MAX_TRUE_PEAK_SLOTS
+#define DSP_MAX_TRUE_PEAK_SLOTS 4
+#endif
+
+struct DspTruePeakParams {
+    float ceilingDb;     // Output ceiling in dBTP (-20..0)
+    float lookaheadMs;   // Lookahead 0.5..5 ms (adds the same latency)
+    float releaseMs;     // Release time (ms)
+    bool linked;         // Share gain with the paired channel (needs matching chains)
+    int8_t tpSlot;       // Pool slot index (-1 = unassigned)
+    float gainReduction; // Current GR in dB (runtime, for metering)
+};
+
+// ===== Shed Priority (CPU load governor, see dsp_governor.h) =====
+// Only FIR and convolution stages are ever shed, and only once a user opts
+// them in: both default to PROTECTED, since a crossover or room correction
+// dropping out is worse than the overload it relieves.
+enum DspStagePriority : uint8_t {
+    DSP_PRIORITY_PROTECTED = 0,   // Never shed (e.g. an FIR crossover protecting a tweeter)
+    DSP_PRIORITY_NORMAL    = 1,
+    DSP_PRIORITY_LOW       = 2    // Shed first
+};
+
+inline uint8_t dsp_clamp_priority(int p) {
+    return p <= DSP_PRIORITY_PROTECTED ? DSP_PRIORITY_PROTECTED : p >= DSP_PRIORITY_LOW ? DSP_PRIORITY_LOW : (uint8_t)p;
+}
+
+// Priority a new stage gets; JSON omits "priority" when a stage holds it
+inline uint8_t dsp_default_priority(DspStageType t) {
+    return (t == DSP_FIR || t == DSP_CONVOLUTION) ? DSP_PRIORITY_PROTECTED : DSP_PRIORITY_NORMAL;
+}
+
 // ===== Generic DSP Stage =====
 struct DspStage {
     bool enabled;
     DspStageType type;
     char label[16];
+    uint16_t id;        // Stable identity across edits; keys state migration on swap
+    uint8_t rateDiv;    // Divider of the rate the coefficients were computed for (1 = pipeline rate)
+    uint8_t priority;   // DspStagePriority: shed order under CPU load
 
     union {
         DspBiquadParams biquad;
@@ -217,6 +308,7 @@ struct DspStage {
         DspLoudnessParams loudness;
         DspBassEnhanceParams bassEnhance;
         DspMultibandCompParams multibandComp;
+        DspTruePeakParams truePeak;
     };
 };
 
@@ -237,7 +329,11 @@ struct DspMetrics {
     uint32_t swapLatencyUs;     // Last swap wait duration (us)
     bool cpuWarning;            // cpuLoad >= DSP_CPU_WARN_PERCENT
     bool cpuCritical;           // cpuLoad >= DSP_CPU_CRIT_PERCENT
-    uint8_t firBypassCount;     // FIR/convolution stages auto-bypassed this frame
+    uint8_t firBypassCount;     // FIR/convolution stages shed by the governor this frame
+    uint8_t governorLevel;      // DspGovLevel (DSP_GOV_SHED + n = n + 1 stages shed)
+    uint8_t shedStageCount;     // FIR/convolution stages currently shed
+    float shedCostUs;           // Last measured per-block cost of the shed stages (us)
+    uint16_t latencySamples[DSP_MAX_CHANNELS]; // Added latency per channel (multirate + lookahead), set on swap
 };
 
 // ===== Global DSP State =====
@@ -271,6 +367,8 @@ inline void dsp_init_fir_params(DspFirParams &p) {
     p.numTaps = 0;
     p.delayPos = 0;
     p.firSlot = -1;
+    p.mode = 0;
+    p.cpuPercent = 0.0f;
 }
 
 inline void dsp_init_gain_params(DspGainParams &p) {
@@ -283,6 +381,9 @@ inline void dsp_init_delay_params(DspDelayParams &p) {
     p.delaySamples = 0;
     p.writePos = 0;
     p.delaySlot = -1;
+    p.interp = DSP_DELAY_INTERP_NONE;
+    p.fraction = 0.0f;
+    p.apState = 0.0f;
 }
 
 inline void dsp_init_polarity_params(DspPolarityParams &p) {
@@ -307,9 +408,12 @@ inline void dsp_init_compressor_params(DspCompressorParams &p) {
 
 inline void dsp_init_decimator_params(DspDecimatorParams &p) {
     p.factor = 2;
-    p.firSlot = -1;
-    p.numTaps = 0;
-    p.delayPos = 0;
+    p.mrSlot = -1;
+}
+
+// Snap to a supported section factor (2, 4, 8)
+inline uint8_t dsp_clamp_decimator_factor(int f) {
+    return f >= 8 ? 8 : f >= 4 ? 4 : 2;
 }
 
 inline void dsp_init_convolution_params(DspConvolutionParams &p) {
@@ -376,10 +480,40 @@ inline void dsp_init_multiband_comp_params(DspMultibandCompParams &p) {
     p.mbSlot = -1;
 }
 
+inline void dsp_init_true_peak_params(DspTruePeakParams &p) {
+    p.ceilingDb = -1.0f;
+    p.lookaheadMs = 1.5f;
+    p.releaseMs = 50.0f;
+    p.linked = true;
+    p.tpSlot = -1;
+    p.gainReduction = 0.0f;
+}
+
+// Clamp ceiling (-20..0 dBTP), lookahead (0.5..5 ms) and release (1..1000 ms)
+inline void dsp_tp_clamp_params(DspTruePeakParams &p) {
+    if (!(p.ceilingDb <= 0.0f)) p.ceilingDb = 0.0f;      // Also catches NaN
+    if (p.ceilingDb < -20.0f) p.ceilingDb = -20.0f;
+    if (!(p.lookaheadMs >= 0.5f)) p.lookaheadMs = 0.5f;
+    if (p.lookaheadMs > 5.0f) p.lookaheadMs = 5.0f;
+    if (!(p.releaseMs >= 1.0f)) p.releaseMs = 1.0f;
+    if (p.releaseMs > 1000.0f) p.releaseMs = 1000.0f;
+}
+
+// Next stage ID (never 0). Struct copies keep the ID, so a stage edited in the
+// inactive config still matches its running counterpart at swap time.
+inline uint16_t dsp_next_stage_id() {
+    static uint16_t next = 0;
+    if (++next == 0) next = 1;
+    return next;
+}
+
 inline void dsp_init_stage(DspStage &s, DspStageType t = DSP_BIQUAD_PEQ) {
     s.enabled = true;
     s.type = t;
     s.label[0] = '\0';
+    s.id = dsp_next_stage_id();
+    s.rateDiv = 1;
+    s.priority = dsp_default_priority(t);
     if (t == DSP_LIMITER) {
         dsp_init_limiter_params(s.limiter);
     } else if (t == DSP_FIR) {
@@ -410,6 +544,8 @@ inline void dsp_init_stage(DspStage &s, DspStageType t = DSP_BIQUAD_PEQ) {
         dsp_init_bass_enhance_params(s.bassEnhance);
     } else if (t == DSP_MULTIBAND_COMP) {
         dsp_init_multiband_comp_params(s.multibandComp);
+    } else if (t == DSP_TRUE_PEAK_LIMITER) {
+        dsp_init_true_peak_params(s.truePeak);
     } else if (dsp_is_biquad_type(t)) {
         dsp_init_biquad_params(s.biquad);
     } else {
@@ -500,6 +636,10 @@ inline void dsp_init_metrics(DspMetrics &m) {
     m.cpuWarning = false;
     m.cpuCritical = false;
     m.firBypassCount = 0;
+    m.governorLevel = DSP_GOV_NORMAL;
+    m.shedStageCount = 0;
+    m.shedCostUs = 0.0f;
+    for (int i = 0; i < DSP_MAX_CHANNELS; i++) m.latencySamples[i] = 0;
 }
 
 // ===== Conversion Helpers =====
@@ -522,7 +662,15 @@ void dsp_process_buffer_float(float *left, float *right, int frames, int lane);
 // Config access (double-buffered: active = read by audio task, inactive = modified by API)
 DspState *dsp_get_active_config();
 DspState *dsp_get_inactive_config();
-bool dsp_swap_config();  // Returns: true if swap successful, false if busy/timeout
+// Publish the inactive config. The audio task adopts it at the top of its next
+// block; the caller waits at most one block period. Returns true only once the
+// publish is acknowledged. False if it was withdrawn (audio task stayed inside
+// one block) or is still being adopted on the audio side when the period runs
+// out (dsp_swap_in_flight()): that config will go live, so resources it
+// references must not be released.
+bool dsp_swap_config();
+bool dsp_swap_in_flight();        // An adopted publish has not been acknowledged yet
+uint32_t dsp_get_config_epoch();  // Number of publishes adopted since dsp_init()
 
 // Log swap failure warning. Counter is handled inside dsp_swap_config() — do NOT double-count.
 inline void dsp_log_swap_failure(const char *module) {
@@ -533,13 +681,24 @@ inline void dsp_log_swap_failure(const char *module) {
 #endif
 }
 
-// Deep copy active config to inactive (includes FIR pool data)
-void dsp_copy_active_to_inactive();
+// Deep copy active config to inactive (includes FIR pool data). Returns false,
+// leaving the inactive side untouched, while an earlier publish is still
+// being adopted — the edit must be aborted or retried.
+bool dsp_copy_active_to_inactive();
+
+// Stage the active config at a new pipeline rate: deep copy to the inactive
+// config, set its sampleRate and recompute every rate-dependent coefficient
+// there (multirate sections follow at publish). Publish with dsp_swap_config().
+// False if the copy was refused (see dsp_copy_active_to_inactive).
+bool dsp_prepare_sample_rate(uint32_t rate);
 
 // Metrics
 DspMetrics dsp_get_metrics();
 void dsp_reset_max_metrics();
 void dsp_clear_cpu_load();
+// Current load governor level (DspGovLevel). Read by the spectrum and
+// metering paths to apply dsp_gov_spectrum_divider() / dsp_gov_meter_divider().
+uint8_t dsp_get_governor_level();
 
 // Stage CRUD (operates on inactive config)
 int dsp_add_stage(int channel, DspStageType type, int position = -1);
@@ -574,16 +733,38 @@ bool dsp_mb_set_band_params(int slot, int band, float thresholdDb, float attackM
                              float releaseMs, float ratio, float kneeDb, float makeupGainDb);
 bool dsp_mb_set_crossover_freq(int slot, int boundary, float freqHz, uint32_t sampleRate);
 
-// FIR pool access (taps/delay stored outside DspStage union to save DRAM)
+// True-peak limiter pool (one detector/lookahead state per slot, shared by
+// both config copies so a swap never restarts the lookahead)
+int dsp_tp_alloc_slot();                     // Allocate slot, returns index or -1
+void dsp_tp_free_slot(int slot);             // Release slot
+
+// Multirate section pool (half-band cascades, shared by both config copies)
+int dsp_mr_alloc_slot();                     // Allocate slot, returns index or -1
+void dsp_mr_free_slot(int slot);             // Release slot
+// Samples of latency the active config adds on a channel at the pipeline rate
+// (multirate sections + true-peak lookahead). Also in DspMetrics::latencySamples.
+int dsp_get_channel_latency_samples(int channel);
+
+// Ops in the active config's compiled program that touch a channel (disabled
+// and no-op stages are dropped, linear stages merged). Diagnostics / tests.
+int dsp_get_program_length(int channel);
+
+// FIR pool access (taps and kernel state stored outside DspStage union to save DRAM)
 int dsp_fir_alloc_slot();                              // Allocate slot, returns index or -1
 void dsp_fir_free_slot(int slot);                      // Release slot
 float* dsp_fir_get_taps(int stateIndex, int firSlot);  // Get taps array [DSP_MAX_FIR_TAPS]
-float* dsp_fir_get_delay(int stateIndex, int firSlot); // Get delay array [DSP_MAX_FIR_TAPS]
+// Call after writing new taps for a slot (both states hold the same taps).
+// Prepares the overlap-save spectra when numTaps reaches the FFT crossover.
+void dsp_fir_commit_taps(int firSlot, int numTaps);
+int dsp_fir_fft_crossover();                           // Tap count from which FIR stages use FFT
 
 // Delay pool access (delay lines stored outside DspStage union to save DRAM)
 int dsp_delay_alloc_slot();                                   // Allocate slot, returns index or -1
 void dsp_delay_free_slot(int slot);                           // Release slot
-float* dsp_delay_get_line(int stateIndex, int delaySlot);     // Get delay line [DSP_MAX_DELAY_SAMPLES]
+float* dsp_delay_get_line(int delaySlot);                     // Get delay ring [DSP_DELAY_RING_SIZE]
+int dsp_delay_slot_capacity();                                // Slots allowed by pool budget
+// Set the fractional part (clamped to 0..<1) and interpolator; resets allpass state
+void dsp_delay_set_fraction(DspDelayParams &p, float fraction, uint8_t interp);
 
 // Persistence helpers
 void dsp_load_config_from_json(const char *json, int channel);
@@ -591,5 +772,42 @@ void dsp_export_config_to_json(int channel, char *buf, int bufSize);
 void dsp_export_full_config_json(char *buf, int bufSize);
 void dsp_import_full_config_json(const char *json);
 
+// Binary config image — the boot path (dsp_api keeps it in the
+// CONFIG_SNAPSHOT_BASE_DSP snapshot store; JSON stays the import/export
+// format). Channels and stages are copied verbatim, followed by the taps of
+// every FIR stage, so restoring needs no parsing. The layout follows this
+// build's structs: the header records their sizes and a mismatching image is
+// refused, leaving the caller to fall back to JSON.
+#define DSP_IMAGE_VERSION 1
+
+struct DspImageHeader {
+    uint16_t version;       // DSP_IMAGE_VERSION
+    uint16_t stageBytes;    // sizeof(DspStage)
+    uint8_t  channels;      // DSP_MAX_CHANNELS
+    uint8_t  maxStages;     // DSP_MAX_STAGES
+    uint8_t  globalBypass;
+    uint8_t  reserved;
+    uint32_t sampleRate;
+};
+
+struct DspImageChannel {
+    uint8_t bypass;
+    uint8_t stereoLink;
+    uint8_t stageCount;     // DspStage records that follow
+    uint8_t reserved;
+};
+
+#define DSP_IMAGE_MAX_BYTES (sizeof(DspImageHeader) + \
+    DSP_MAX_CHANNELS * (sizeof(DspImageChannel) + DSP_MAX_STAGES * sizeof(DspStage)) + \
+    DSP_MAX_FIR_SLOTS * DSP_MAX_FIR_TAPS * sizeof(float))
+
+// Packs the active config. Returns bytes written, 0 if `cap` is too small.
+size_t dsp_image_pack(uint8_t *buf, size_t cap);
+// Restores an image into the inactive config: pool slots are re-allocated,
+// FIR taps committed and runtime state cleared. Returns false, with the
+// config untouched, if the image does not match this build's layout. Caller
+// recomputes coefficients and swaps, as after dsp_load_config_from_json().
+bool dsp_image_unpack(const uint8_t *buf, size_t len);
+
 #endif // DSP_ENABLED
 #endif // DSP_PIPELINE_H
@@ -0,0 +1,276 @@
+#pragma once
+// dsp_true_peak.h — Lookahead true-peak limiter kernel (header-only).
+//
+// Shared by the input DSP pipeline (dsp_pipeline.cpp) and the per-output DSP
+// (output_dsp.cpp). Each channel owns one DspTruePeakState, allocated from a
+// PSRAM pool by the caller; the DspStage only carries parameters and a slot.
+//
+// Signal flow per sample n:
+//   1. 4x polyphase windowed-sinc interpolator (12 taps per phase). Phase 0
+//      is the input itself delayed by DSP_TP_OS_DELAY; phases 1-3 are the
+//      inter-sample points. The peak for sample a = n - DSP_TP_OS_DELAY is
+//      max(|x[a]|, inter-sample peaks on both sides of it).
+//   2. Sliding-window max of that peak over the lookahead L (monotonic deque,
+//      O(1) amortized) -> required gain min(1, ceiling / peak).
+//   3. Two cascaded moving averages (lengths L1 + L2 - 1 = L) smooth the held
+//      gain into a ramp that starts L samples before the peak. Every term of
+//      the averaged window is itself a hold over a window that contains the
+//      target sample, so the average never exceeds the gain that sample needs.
+//      Sums run in Q20 fixed point and round down: no drift, no overshoot.
+//   4. One-pole release applied only when the gain rises.
+//   5. The audio is delayed by L - 1 + DSP_TP_OS_DELAY through a power-of-two
+//      ring so the gain lands on the sample it was computed for.
+//
+// The gain curve is derived from the 4x estimate, so content close to Nyquist
+// can read up to ~0.7 dB low; the default -1 dBTP ceiling keeps that margin.
+//
+// Linked stereo: both detectors feed max(peakL, peakR) into both gain chains,
+// so L and R receive identical gain and either side can later run alone.
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define DSP_TP_OS            4     // Oversampling factor of the peak detector
+#define DSP_TP_TAPS          12    // Taps per polyphase branch
+#define DSP_TP_OS_DELAY      6     // Detector latency in samples (phase 0 == x[n-6])
+#define DSP_TP_RING          1024  // Audio ring / deque capacity (power of two)
+#define DSP_TP_RING_MASK     (DSP_TP_RING - 1)
+#define DSP_TP_BOX           512   // Capacity of each moving-average history
+#define DSP_TP_MAX_LOOKAHEAD (DSP_TP_RING - DSP_TP_OS_DELAY - 2)  // 1016 samples (5 ms @ 192 kHz fits)
+#define DSP_TP_CHUNK         64    // Frames per detect/gain/apply pass (stack scratch)
+#define DSP_TP_Q             1048576.0f  // Q20 gain scale
+
+struct DspTruePeakState {
+    // Detector
+    float    coeffs[DSP_TP_OS - 1][DSP_TP_TAPS];  // Phases 1..3 (phase 0 is a plain delay)
+    float    hist[2 * DSP_TP_TAPS];               // Input history, mirrored for contiguous reads
+    uint32_t histPos;
+    float    prevInter;                            // Inter-sample peak of the previous interval
+    // Sliding max (monotonic deque of detector peaks)
+    float    dqVal[DSP_TP_RING];
+    uint32_t dqPos[DSP_TP_RING];
+    uint32_t dqHead, dqTail;
+    uint32_t n;                                    // Gain-chain sample counter
+    // Cascaded moving averages (Q20)
+    int32_t  box1[DSP_TP_BOX];
+    int32_t  box2[DSP_TP_BOX];
+    int32_t  sum1, sum2;
+    uint16_t pos1, pos2;
+    float    gain;                                 // Output gain after release
+    // Lookahead delay line
+    float    ring[DSP_TP_RING];
+    uint32_t wp;
+    // Configuration the state was built for
+    uint32_t sampleRate;
+    uint16_t lookahead;                            // L in samples
+    uint16_t len1, len2;                           // L1, L2
+    uint16_t delay;                                // L - 1 + DSP_TP_OS_DELAY
+    float    ceilingLin;
+    float    releaseCoeff;
+};
+
+// Lookahead in samples for a given time, clamped to 1..DSP_TP_MAX_LOOKAHEAD
+static inline uint16_t dsp_tp_lookahead_samples(float lookaheadMs, uint32_t sampleRate) {
+    float l = lookaheadMs * 0.001f * (float)sampleRate;
+    if (!(l >= 1.0f)) return 1;   // Also catches NaN
+    if (l > (float)DSP_TP_MAX_LOOKAHEAD) return DSP_TP_MAX_LOOKAHEAD;
+    return (uint16_t)(l + 0.5f);
+}
+
+// Blackman-windowed sinc interpolator for the inter-sample phases. Branch k
+// estimates x(n - DSP_TP_OS_DELAY + k/4) from x[n-11..n]; each branch is
+// normalized to unity DC gain.
+static inline void _dsp_tp_design(DspTruePeakState &st) {
+    const double W = DSP_TP_TAPS / 2 + 1.0;   // Window half-width
+    for (int k = 1; k < DSP_TP_OS; k++) {
+        double sum = 0.0;
+        double c[DSP_TP_TAPS];
+        for (int j = 0; j < DSP_TP_TAPS; j++) {
+            double d = (DSP_TP_TAPS - 1 - DSP_TP_OS_DELAY) + (double)k / DSP_TP_OS - j;
+            double s = (d == 0.0) ? 1.0 : sin(M_PI * d) / (M_PI * d);
+            double w = 0.42 + 0.5 * cos(M_PI * d / W) + 0.08 * cos(2.0 * M_PI * d / W);
+            c[j] = s * w;
+            sum += c[j];
+        }
+        for (int j = 0; j < DSP_TP_TAPS; j++) st.coeffs[k - 1][j] = (float)(c[j] / sum);
+    }
+}
+
+// Clear all history; the first L - 1 + DSP_TP_OS_DELAY output samples are
+// silence, so the no-over guarantee holds across the reset.
+static inline void dsp_tp_reset(DspTruePeakState &st) {
+    memset(st.hist, 0, sizeof(st.hist));
+    st.histPos = 0;
+    st.prevInter = 0.0f;
+    st.dqHead = st.dqTail = 0;
+    st.n = 0;
+    const int32_t one = (int32_t)DSP_TP_Q;
+    for (int i = 0; i < DSP_TP_BOX; i++) { st.box1[i] = one; st.box2[i] = one; }
+    st.sum1 = one * st.len1;
+    st.sum2 = one * st.len2;
+    st.pos1 = st.pos2 = 0;
+    st.gain = 1.0f;
+    memset(st.ring, 0, sizeof(st.ring));
+    st.wp = 0;
+}
+
+// Build a fresh state. Safe to call from any task (no allocation).
+static inline void dsp_tp_init(DspTruePeakState &st) {
+    _dsp_tp_design(st);
+    st.sampleRate = 0;
+    st.lookahead = 1;
+    st.len1 = st.len2 = 1;
+    st.delay = DSP_TP_OS_DELAY;
+    st.ceilingLin = 1.0f;
+    st.releaseCoeff = 0.0f;
+    dsp_tp_reset(st);
+}
+
+// Apply parameters. A change of lookahead or sample rate rebuilds the state
+// (reset above); a lower ceiling rescales the held gains so it takes effect
+// immediately; release and higher ceilings simply apply from here on.
+static inline void dsp_tp_configure(DspTruePeakState &st, uint32_t sampleRate, float ceilingDb,
+                                    float lookaheadMs, float releaseMs) {
+    if (sampleRate == 0) return;
+    uint16_t L = dsp_tp_lookahead_samples(lookaheadMs, sampleRate);
+    float ceil = powf(10.0f, ceilingDb / 20.0f);
+    if (L != st.lookahead || sampleRate != st.sampleRate) {
+        st.sampleRate = sampleRate;
+        st.lookahead = L;
+        st.len1 = (uint16_t)((L + 1) / 2);
+        st.len2 = (uint16_t)(L + 1 - st.len1);
+        st.delay = (uint16_t)(L - 1 + DSP_TP_OS_DELAY);
+        st.ceilingLin = ceil;
+        dsp_tp_reset(st);
+    } else if (ceil < st.ceilingLin) {
+        float k = ceil / st.ceilingLin;
+        st.sum1 = st.sum2 = 0;
+        for (int i = 0; i < st.len1; i++) { st.box1[i] = (int32_t)((float)st.box1[i] * k); st.sum1 += st.box1[i]; }
+        for (int i = 0; i < st.len2; i++) { st.box2[i] = (int32_t)((float)st.box2[i] * k); st.sum2 += st.box2[i]; }
+        st.gain *= k;
+        st.ceilingLin = ceil;
+    } else {
+        st.ceilingLin = ceil;
+    }
+    float rs = releaseMs * 0.001f * (float)sampleRate;
+    st.releaseCoeff = rs > 1.0f ? 1.0f - expf(-1.0f / rs) : 1.0f;
+}
+
+// Stage 1: per-sample true-peak estimate for sample n - DSP_TP_OS_DELAY.
+// With `accumulate` the result is max-combined into `peak` (linked stereo).
+static inline void _dsp_tp_detect(DspTruePeakState &st, const float *in, float *peak, int len,
+                                  bool accumulate) {
+    uint32_t hp = st.histPos;
+    float prev = st.prevInter;
+    const float *c1 = st.coeffs[0], *c2 = st.coeffs[1], *c3 = st.coeffs[2];
+    for (int i = 0; i < len; i++) {
+        st.hist[hp] = st.hist[hp + DSP_TP_TAPS] = in[i];
+        if (++hp == DSP_TP_TAPS) hp = 0;
+        const float *w = st.hist + hp;   // w[0] = x[n-11] .. w[11] = x[n]
+        float y1 = 0.0f, y2 = 0.0f, y3 = 0.0f;
+        for (int j = 0; j < DSP_TP_TAPS; j++) {
+            y1 += c1[j] * w[j];
+            y2 += c2[j] * w[j];
+            y3 += c3[j] * w[j];
+        }
+        float inter = fabsf(y1);
+        float a2 = fabsf(y2), a3 = fabsf(y3);
+        if (a2 > inter) inter = a2;
+        if (a3 > inter) inter = a3;
+        float p = fabsf(w[DSP_TP_TAPS - 1 - DSP_TP_OS_DELAY]);
+        if (inter > p) p = inter;
+        if (prev > p) p = prev;
+        prev = inter;
+        if (accumulate) { if (p > peak[i]) peak[i] = p; }
+        else peak[i] = p;
+    }
+    st.histPos = hp;
+    st.prevInter = prev;
+}
+
+// Stage 2-4: peaks -> output gains. Returns the smallest gain of the chunk.
+static inline float _dsp_tp_gain(DspTruePeakState &st, const float *peak, float *gain, int len) {
+    const uint32_t L = st.lookahead;
+    const float ceil = st.ceilingLin;
+    const float rc = st.releaseCoeff;
+    uint32_t head = st.dqHead, tail = st.dqTail, n = st.n;
+    int32_t s1 = st.sum1, s2 = st.sum2;
+    uint16_t p1 = st.pos1, p2 = st.pos2;
+    const uint16_t l1 = st.len1, l2 = st.len2;
+    float g = st.gain, gMin = 1.0f;
+    for (int i = 0; i < len; i++, n++) {
+        float p = peak[i];
+        while (tail != head && st.dqVal[(tail - 1) & DSP_TP_RING_MASK] <= p) tail--;
+        st.dqVal[tail & DSP_TP_RING_MASK] = p;
+        st.dqPos[tail & DSP_TP_RING_MASK] = n;
+        tail++;
+        if (n - st.dqPos[head & DSP_TP_RING_MASK] >= L) head++;
+        float pk = st.dqVal[head & DSP_TP_RING_MASK];
+        float r = pk > ceil ? ceil / pk : 1.0f;
+
+        int32_t q = (int32_t)(r * DSP_TP_Q);       // Truncation == floor (r >= 0)
+        s1 += q - st.box1[p1];
+        st.box1[p1] = q;
+        if (++p1 >= l1) p1 = 0;
+        int32_t b1 = s1 / l1;
+        s2 += b1 - st.box2[p2];
+        st.box2[p2] = b1;
+        if (++p2 >= l2) p2 = 0;
+        float s = (float)(s2 / l2) * (1.0f / DSP_TP_Q);
+
+        if (s < g) g = s;
+        else { g += (s - g) * rc; if (g > s) g = s; }
+        gain[i] = g;
+        if (g < gMin) gMin = g;
+    }
+    st.dqHead = head; st.dqTail = tail; st.n = n;
+    st.sum1 = s1; st.sum2 = s2;
+    st.pos1 = p1; st.pos2 = p2;
+    st.gain = g;
+    return gMin;
+}
+
+// Stage 5: push the chunk through the lookahead ring and apply the gains.
+static inline void _dsp_tp_apply(DspTruePeakState &st, float *buf, const float *gain, int len) {
+    uint32_t wp = st.wp;
+    const uint32_t d = st.delay;
+    for (int i = 0; i < len; i++, wp++) {
+        st.ring[wp & DSP_TP_RING_MASK] = buf[i];
+        buf[i] = st.ring[(wp - d) & DSP_TP_RING_MASK] * gain[i];
+    }
+    st.wp = wp;
+}
+
+// Process one channel in place. Returns the smallest applied gain (linear).
+static inline float dsp_true_peak_process(DspTruePeakState &st, float *buf, int len) {
+    float peak[DSP_TP_CHUNK], gain[DSP_TP_CHUNK];
+    float gMin = 1.0f;
+    for (int done = 0; done < len; done += DSP_TP_CHUNK) {
+        int n = len - done < DSP_TP_CHUNK ? len - done : DSP_TP_CHUNK;
+        _dsp_tp_detect(st, buf + done, peak, n, false);
+        float g = _dsp_tp_gain(st, peak, gain, n);
+        _dsp_tp_apply(st, buf + done, gain, n);
+        if (g < gMin) gMin = g;
+    }
+    return gMin;
+}
+
+// Process a linked pair in place: one peak stream drives both gain chains.
+// Both states must share the same configuration.
+static inline float dsp_true_peak_process_linked(DspTruePeakState &a, DspTruePeakState &b,
+                                                 float *l, float *r, int len) {
+    float peak[DSP_TP_CHUNK], gainA[DSP_TP_CHUNK], gainB[DSP_TP_CHUNK];
+    float gMin = 1.0f;
+    for (int done = 0; done < len; done += DSP_TP_CHUNK) {
+        int n = len - done < DSP_TP_CHUNK ? len - done : DSP_TP_CHUNK;
+        _dsp_tp_detect(a, l + done, peak, n, false);
+        _dsp_tp_detect(b, r + done, peak, n, true);
+        float g = _dsp_tp_gain(a, peak, gainA, n);
+        _dsp_tp_gain(b, peak, gainB, n);
+        _dsp_tp_apply(a, l + done, gainA, n);
+        _dsp_tp_apply(b, r + done, gainB, n);
+        if (g < gMin) gMin = g;
+    }
+    return gMin;
+}
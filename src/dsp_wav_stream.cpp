@@ -0,0 +1,279 @@
+// dsp_wav_stream.cpp — Incremental RIFF/WAV IR parser and IR resampler.
+// See dsp_wav_stream.h for the streaming contract.
+
+#include "dsp_wav_stream.h"
+#include <math.h>
+#include <string.h>
+
+#define WAV_FORMAT_PCM        1
+#define WAV_FORMAT_FLOAT      3
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
+static inline uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t rd32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool _fail(WavIrStream *ws, WavStreamError err) {
+    ws->state = WAV_STREAM_ERROR;
+    ws->error = err;
+    return false;
+}
+
+static void _expect(WavIrStream *ws, WavStreamState state, uint8_t need) {
+    ws->state = state;
+    ws->hdrLen = 0;
+    ws->hdrNeed = need;
+}
+
+// Accumulate into ws->hdr until hdrNeed bytes are present. Returns true when full.
+static bool _collect(WavIrStream *ws, const uint8_t *&data, size_t &len) {
+    size_t take = (size_t)(ws->hdrNeed - ws->hdrLen);
+    if (take > len) take = len;
+    memcpy(ws->hdr + ws->hdrLen, data, take);
+    ws->hdrLen += (uint8_t)take;
+    data += take;
+    len -= take;
+    return ws->hdrLen == ws->hdrNeed;
+}
+
+void wav_stream_init(WavIrStream *ws, float *taps, int maxTaps, uint8_t channelSel) {
+    if (!ws) return;
+    memset(ws, 0, sizeof(*ws));
+    ws->taps = taps;
+    ws->maxTaps = maxTaps;
+    ws->channelSel = channelSel;
+    _expect(ws, WAV_STREAM_RIFF, 12);
+    if (!taps || maxTaps <= 0) _fail(ws, WAV_STREAM_ERR_ARGS);
+}
+
+static bool _parseFmt(WavIrStream *ws) {
+    const uint8_t *f = ws->hdr;
+    uint16_t fmt = rd16(f);
+    ws->channels = rd16(f + 2);
+    ws->sampleRate = rd32(f + 4);
+    ws->blockAlign = rd16(f + 12);
+    ws->bitsPerSample = rd16(f + 14);
+
+    if (fmt == WAV_FORMAT_EXTENSIBLE) {
+        // cbSize(2) validBits(2) channelMask(4) then SubFormat GUID whose
+        // first two bytes are the plain format tag
+        if (ws->hdrLen < 26) return _fail(ws, WAV_STREAM_ERR_FORMAT);
+        fmt = rd16(f + 24);
+    }
+    ws->format = fmt;
+
+    uint16_t bytes = ws->bitsPerSample / 8;
+    bool ok;
+    if (fmt == WAV_FORMAT_PCM)        ok = (ws->bitsPerSample == 16 || ws->bitsPerSample == 24 || ws->bitsPerSample == 32);
+    else if (fmt == WAV_FORMAT_FLOAT) ok = (ws->bitsPerSample == 32);
+    else                              ok = false;
+    if (!ok || ws->channels == 0 || ws->channels > WAV_STREAM_MAX_CHANNELS ||
+        ws->sampleRate == 0 || ws->blockAlign != ws->channels * bytes) {
+        return _fail(ws, WAV_STREAM_ERR_FORMAT);
+    }
+    if (ws->channelSel >= ws->channels) ws->channelSel = (uint8_t)(ws->channels - 1);
+    ws->haveFmt = true;
+    return true;
+}
+
+static inline float _convert(const WavIrStream *ws, const uint8_t *frame) {
+    const uint8_t *sp = frame + ws->channelSel * (ws->bitsPerSample / 8);
+    switch (ws->bitsPerSample) {
+        case 16:
+            return (float)(int16_t)rd16(sp) / 32768.0f;
+        case 24: {
+            // Left-justify into 32 bits so the sign bit lands in place
+            int32_t s = (int32_t)(((uint32_t)sp[0] << 8) | ((uint32_t)sp[1] << 16) | ((uint32_t)sp[2] << 24));
+            return (float)s / 2147483648.0f;
+        }
+        default:
+            if (ws->format == WAV_FORMAT_FLOAT) {
+                float v;
+                memcpy(&v, sp, 4);
+                return v;
+            }
+            return (float)(int32_t)rd32(sp) / 2147483648.0f;
+    }
+}
+
+static inline void _emit(WavIrStream *ws, const uint8_t *frame) {
+    if (ws->tapCount < ws->maxTaps) ws->taps[ws->tapCount++] = _convert(ws, frame);
+    else ws->clipped = true;
+}
+
+// Convert up to `len` bytes of the data chunk. A frame split across feeds is
+// carried in ws->frame; whole frames are converted straight from the input.
+static void _consumeData(WavIrStream *ws, const uint8_t *&data, size_t &len) {
+    size_t take = (len < ws->chunkRemain) ? len : ws->chunkRemain;
+    const uint8_t *p = data;
+    size_t n = take;
+    const uint16_t fb = ws->blockAlign;
+
+    if (ws->frameLen) {
+        size_t fill = fb - ws->frameLen;
+        if (fill > n) fill = n;
+        memcpy(ws->frame + ws->frameLen, p, fill);
+        ws->frameLen += (uint8_t)fill;
+        p += fill;
+        n -= fill;
+        if (ws->frameLen == fb) {
+            _emit(ws, ws->frame);
+            ws->frameLen = 0;
+        }
+    }
+    while (n >= fb) {
+        _emit(ws, p);
+        p += fb;
+        n -= fb;
+    }
+    if (n) {
+        memcpy(ws->frame, p, n);
+        ws->frameLen = (uint8_t)n;
+    }
+
+    data += take;
+    len -= take;
+    ws->chunkRemain -= (uint32_t)take;
+    if (ws->chunkRemain == 0) ws->state = WAV_STREAM_DONE;
+}
+
+bool wav_stream_feed(WavIrStream *ws, const uint8_t *data, size_t len) {
+    if (!ws) return false;
+    if (ws->state == WAV_STREAM_ERROR) return false;
+    if (!data && len) return _fail(ws, WAV_STREAM_ERR_ARGS);
+    ws->bytesIn += len;
+
+    while (len > 0) {
+        switch (ws->state) {
+            case WAV_STREAM_RIFF:
+                if (!_collect(ws, data, len)) break;
+                if (memcmp(ws->hdr, "RIFF", 4) != 0 || memcmp(ws->hdr + 8, "WAVE", 4) != 0)
+                    return _fail(ws, WAV_STREAM_ERR_HEADER);
+                _expect(ws, WAV_STREAM_CHUNK_HDR, 8);
+                break;
+
+            case WAV_STREAM_CHUNK_HDR: {
+                if (!_collect(ws, data, len)) break;
+                uint32_t size = rd32(ws->hdr + 4);
+                ws->chunkPad = (size & 1) != 0;
+                if (memcmp(ws->hdr, "fmt ", 4) == 0) {
+                    if (size < 16) return _fail(ws, WAV_STREAM_ERR_FORMAT);
+                    uint8_t need = (size < WAV_STREAM_FMT_MAX) ? (uint8_t)size : WAV_STREAM_FMT_MAX;
+                    ws->chunkRemain = size - need;
+                    _expect(ws, WAV_STREAM_FMT, need);
+                } else if (memcmp(ws->hdr, "data", 4) == 0) {
+                    if (!ws->haveFmt) return _fail(ws, WAV_STREAM_ERR_NO_FMT);
+                    ws->chunkRemain = size;
+                    ws->frameLen = 0;
+                    ws->state = (size == 0) ? WAV_STREAM_DONE : WAV_STREAM_DATA;
+                } else {
+                    ws->chunkRemain = size + (ws->chunkPad ? 1 : 0);
+                    ws->state = WAV_STREAM_SKIP;
+                }
+                break;
+            }
+
+            case WAV_STREAM_FMT:
+                if (!_collect(ws, data, len)) break;
+                if (!_parseFmt(ws)) return false;
+                ws->chunkRemain += ws->chunkPad ? 1 : 0;
+                if (ws->chunkRemain) ws->state = WAV_STREAM_SKIP;
+                else _expect(ws, WAV_STREAM_CHUNK_HDR, 8);
+                break;
+
+            case WAV_STREAM_SKIP: {
+                size_t take = (len < ws->chunkRemain) ? len : ws->chunkRemain;
+                data += take;
+                len -= take;
+                ws->chunkRemain -= (uint32_t)take;
+                if (ws->chunkRemain == 0) _expect(ws, WAV_STREAM_CHUNK_HDR, 8);
+                break;
+            }
+
+            case WAV_STREAM_DATA:
+                _consumeData(ws, data, len);
+                break;
+
+            case WAV_STREAM_DONE:
+                return true;   // Trailing chunks after data are ignored
+
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+int wav_stream_finish(WavIrStream *ws) {
+    if (!ws) return -1;
+    if (ws->state == WAV_STREAM_ERROR) return -1;
+    if (ws->state != WAV_STREAM_DATA && ws->state != WAV_STREAM_DONE) {
+        _fail(ws, ws->state == WAV_STREAM_RIFF ? WAV_STREAM_ERR_HEADER : WAV_STREAM_ERR_TRUNCATED);
+        return -1;
+    }
+    if (ws->tapCount == 0) {
+        _fail(ws, WAV_STREAM_ERR_TRUNCATED);
+        return -1;
+    }
+    ws->state = WAV_STREAM_DONE;
+    return ws->tapCount;
+}
+
+const char *wav_stream_error_str(WavStreamError err) {
+    switch (err) {
+        case WAV_STREAM_OK:            return "ok";
+        case WAV_STREAM_ERR_HEADER:    return "not a RIFF/WAVE file";
+        case WAV_STREAM_ERR_FORMAT:    return "unsupported WAV format (PCM 16/24/32 or float32, 1-8 channels)";
+        case WAV_STREAM_ERR_NO_FMT:    return "data chunk before fmt chunk";
+        case WAV_STREAM_ERR_TRUNCATED: return "truncated WAV file";
+        case WAV_STREAM_ERR_ARGS:      return "invalid arguments";
+    }
+    return "unknown";
+}
+
+// ===== IR resampler =====
+
+#define WAV_RESAMPLE_HALF_ZC 8     // Kernel half-width in zero crossings
+
+int dsp_wav_resample_ir(const float *in, int n, uint32_t srcRate,
+                        float *out, int maxOut, uint32_t dstRate) {
+    if (!in || !out || in == out || n <= 0 || maxOut <= 0 || srcRate == 0 || dstRate == 0) return -1;
+
+    if (srcRate == dstRate) {
+        int m = (n < maxOut) ? n : maxOut;
+        memcpy(out, in, (size_t)m * sizeof(float));
+        return m;
+    }
+
+    const double step = (double)srcRate / (double)dstRate;     // Input samples per output sample
+    const double fc = (dstRate < srcRate) ? (double)dstRate / (double)srcRate : 1.0;
+    const double halfWidth = WAV_RESAMPLE_HALF_ZC / fc;        // In input samples
+    const float gain = (float)step;                            // Preserve DC gain (sum of taps)
+
+    int outLen = (int)ceil((double)n / step);
+    if (outLen > maxOut) outLen = maxOut;
+
+    for (int j = 0; j < outLen; j++) {
+        double t = j * step;
+        int i0 = (int)ceil(t - halfWidth);
+        int i1 = (int)floor(t + halfWidth);
+        if (i0 < 0) i0 = 0;
+        if (i1 > n - 1) i1 = n - 1;
+        double acc = 0.0;
+        for (int i = i0; i <= i1; i++) {
+            double x = (t - i) * fc;                           // In output-band zero crossings
+            double k;
+            if (fabs(x) < 1e-9) {
+                k = 1.0;
+            } else {
+                double px = M_PI * x;
+                k = sin(px) / px;
+            }
+            double w = 0.5 + 0.5 * cos(M_PI * x / WAV_RESAMPLE_HALF_ZC);   // Hann
+            acc += in[i] * k * w * fc;
+        }
+        out[j] = (float)acc * gain;
+    }
+    return outLen;
+}
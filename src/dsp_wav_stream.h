@@ -0,0 +1,93 @@
+#pragma once
+// dsp_wav_stream.h — Incremental RIFF/WAV impulse-response parser.
+//
+// WavIrStream consumes a WAV file in arbitrarily sized pieces (HTTPUpload
+// chunks on device) and converts the selected channel of the data chunk
+// straight into a caller-owned float buffer — normally a PSRAM staging
+// buffer — so the raw file is never held in memory. Chunk headers, the fmt
+// body and sample frames may be split across feeds at any byte.
+//
+// Supported: PCM 16/24/32-bit, IEEE float 32-bit, WAVE_FORMAT_EXTENSIBLE
+// wrapping either, 1..WAV_STREAM_MAX_CHANNELS channels. Unknown chunks
+// (LIST, fact, bext, ...) are skipped.
+//
+// dsp_wav_resample_ir() converts a parsed IR to the DSP sample rate
+// (windowed-sinc, gain-preserving). Pure C++ — no Arduino dependency.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define WAV_STREAM_MAX_CHANNELS 8
+#define WAV_STREAM_FMT_MAX      40      // fmt body bytes retained (EXTENSIBLE = 40)
+
+enum WavStreamState : uint8_t {
+    WAV_STREAM_RIFF = 0,     // Collecting "RIFF"<size>"WAVE"
+    WAV_STREAM_CHUNK_HDR,    // Collecting an 8-byte chunk header
+    WAV_STREAM_FMT,          // Collecting the fmt body
+    WAV_STREAM_SKIP,         // Skipping an unknown chunk (+ pad byte)
+    WAV_STREAM_DATA,         // Converting sample frames
+    WAV_STREAM_DONE,         // Data chunk fully consumed
+    WAV_STREAM_ERROR
+};
+
+enum WavStreamError : uint8_t {
+    WAV_STREAM_OK = 0,
+    WAV_STREAM_ERR_HEADER,       // Not RIFF/WAVE
+    WAV_STREAM_ERR_FORMAT,       // Unsupported format/bit depth/channel count
+    WAV_STREAM_ERR_NO_FMT,       // data chunk before fmt chunk
+    WAV_STREAM_ERR_TRUNCATED,    // Input ended before any sample / mid-header
+    WAV_STREAM_ERR_ARGS
+};
+
+struct WavIrStream {
+    // Output
+    float   *taps;
+    int      maxTaps;
+    int      tapCount;
+    bool     clipped;            // More frames than maxTaps — tail discarded
+
+    // Format (valid once fmt chunk parsed)
+    uint16_t format;             // 1 = PCM, 3 = IEEE float (EXTENSIBLE resolved)
+    uint16_t channels;
+    uint32_t sampleRate;
+    uint16_t bitsPerSample;
+    uint16_t blockAlign;
+    uint8_t  channelSel;         // Requested channel (clamped on fmt)
+    bool     haveFmt;
+
+    // Parser
+    WavStreamState state;
+    WavStreamError error;
+    uint32_t chunkRemain;        // Bytes left in current chunk body
+    bool     chunkPad;           // Odd-sized chunk: skip one pad byte after it
+    uint8_t  hdr[WAV_STREAM_FMT_MAX];
+    uint8_t  hdrLen;             // Bytes collected in hdr
+    uint8_t  hdrNeed;            // Bytes wanted in hdr for this state
+    uint8_t  frame[WAV_STREAM_MAX_CHANNELS * 4];
+    uint8_t  frameLen;           // Partial frame carried between feeds
+    size_t   bytesIn;
+};
+
+// Start a new parse into `taps` (capacity `maxTaps`). `channelSel` picks the
+// channel of a multi-channel file; values past the last channel clamp to it.
+void wav_stream_init(WavIrStream *ws, float *taps, int maxTaps, uint8_t channelSel);
+
+// Feed the next `len` bytes. Returns false once the stream is in error;
+// bytes after the data chunk are ignored.
+bool wav_stream_feed(WavIrStream *ws, const uint8_t *data, size_t len);
+
+// End of input. Returns the number of taps converted, or -1 on error
+// (ws->error explains). A data chunk cut short by the end of input is
+// accepted with the frames received.
+int wav_stream_finish(WavIrStream *ws);
+
+const char *wav_stream_error_str(WavStreamError err);
+
+// Resample `in` (n taps at srcRate) to dstRate into `out` (capacity maxOut).
+// Taps are scaled by srcRate/dstRate so the IR's DC gain is unchanged; when
+// downsampling the kernel cutoff follows the new Nyquist. Returns the output
+// tap count (clamped to maxOut), or -1 on bad arguments. in == out is not
+// allowed. srcRate == dstRate copies.
+int dsp_wav_resample_ir(const float *in, int n, uint32_t srcRate,
+                        float *out, int maxOut, uint32_t dstRate);
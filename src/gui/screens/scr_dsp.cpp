@@ -104,11 +104,11 @@ static void edit_enabled(void) {
 /* Toggle DSP bypass */
 static void on_bypass_confirm(int val, float, int) {
     AppState &st = AppState::getInstance();
-    st.dsp.bypass = (val == 1);
-    dsp_copy_active_to_inactive();
+    if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("GUI"); return; }
     DspState *cfg = dsp_get_inactive_config();
-    cfg->globalBypass = st.dsp.bypass;
-    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); }
+    cfg->globalBypass = (val == 1);
+    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); return; }
+    st.dsp.bypass = (val == 1);
     saveDspSettingsDebounced();
     st.markDspConfigDirty();
 }
@@ -138,10 +138,10 @@ static void cycle_preset(void) {
 
 /* Per-channel bypass toggles */
 static void toggle_ch_bypass(int ch) {
-    dsp_copy_active_to_inactive();
+    if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("GUI"); return; }
     DspState *cfg = dsp_get_inactive_config();
     cfg->channels[ch].bypass = !cfg->channels[ch].bypass;
-    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); }
+    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); return; }
     saveDspSettingsDebounced();
     AppState::getInstance().markDspConfigDirty();
 }
@@ -366,10 +366,10 @@ static void peq_edit_band_9(void) { open_peq_band(9); }
 
 /* Band parameter edit callbacks */
 static void on_peq_enable_confirm(int val, float, int) {
-    dsp_copy_active_to_inactive();
+    if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("GUI"); return; }
     DspState *cfg = dsp_get_inactive_config();
     cfg->channels[peq_channel].stages[peq_edit_band_idx].enabled = (val == 1);
-    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); }
+    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); return; }
     saveDspSettingsDebounced();
     AppState::getInstance().markDspConfigDirty();
 }
@@ -385,12 +385,12 @@ static void peq_band_edit_enable(void) {
 }
 
 static void on_peq_freq_confirm(int val, float, int) {
-    dsp_copy_active_to_inactive();
+    if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("GUI"); return; }
     DspState *cfg = dsp_get_inactive_config();
     cfg->channels[peq_channel].stages[peq_edit_band_idx].biquad.frequency = (float)val;
     dsp_compute_biquad_coeffs(cfg->channels[peq_channel].stages[peq_edit_band_idx].biquad,
                               cfg->channels[peq_channel].stages[peq_edit_band_idx].type, cfg->sampleRate);
-    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); }
+    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); return; }
     saveDspSettingsDebounced();
     AppState::getInstance().markDspConfigDirty();
 }
@@ -410,12 +410,12 @@ static void peq_band_edit_freq(void) {
 }
 
 static void on_peq_gain_confirm(int, float val, int) {
-    dsp_copy_active_to_inactive();
+    if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("GUI"); return; }
     DspState *cfg = dsp_get_inactive_config();
     cfg->channels[peq_channel].stages[peq_edit_band_idx].biquad.gain = val;
     dsp_compute_biquad_coeffs(cfg->channels[peq_channel].stages[peq_edit_band_idx].biquad,
                               cfg->channels[peq_channel].stages[peq_edit_band_idx].type, cfg->sampleRate);
-    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); }
+    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); return; }
     saveDspSettingsDebounced();
     AppState::getInstance().markDspConfigDirty();
 }
@@ -436,12 +436,12 @@ static void peq_band_edit_gain(void) {
 }
 
 static void on_peq_q_confirm(int, float val, int) {
-    dsp_copy_active_to_inactive();
+    if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("GUI"); return; }
     DspState *cfg = dsp_get_inactive_config();
     cfg->channels[peq_channel].stages[peq_edit_band_idx].biquad.Q = val;
     dsp_compute_biquad_coeffs(cfg->channels[peq_channel].stages[peq_edit_band_idx].biquad,
                               cfg->channels[peq_channel].stages[peq_edit_band_idx].type, cfg->sampleRate);
-    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); }
+    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); return; }
     saveDspSettingsDebounced();
     AppState::getInstance().markDspConfigDirty();
 }
@@ -473,12 +473,12 @@ static const CycleOption peq_type_options[] = {
 
 static void on_peq_type_confirm(int, float, int option_idx) {
     if (option_idx < 0 || option_idx >= 8) return;
-    dsp_copy_active_to_inactive();
+    if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("GUI"); return; }
     DspState *cfg = dsp_get_inactive_config();
     cfg->channels[peq_channel].stages[peq_edit_band_idx].type = (DspStageType)peq_type_options[option_idx].value;
     dsp_compute_biquad_coeffs(cfg->channels[peq_channel].stages[peq_edit_band_idx].biquad,
                               cfg->channels[peq_channel].stages[peq_edit_band_idx].type, cfg->sampleRate);
-    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); }
+    if (!dsp_swap_config()) { dsp_log_swap_failure("GUI"); return; }
     saveDspSettingsDebounced();
     AppState::getInstance().markDspConfigDirty();
 }
@@ -618,6 +618,8 @@ void HalCirrusDac2ch::_execSequence(const CirrusDac2chRegWrite* seq, uint8_t len
 #ifndef NATIVE_TEST
             delay((uint32_t)seq[i].val * 5u);
 #endif
+            // Power-up / reset just completed — shadowed values are stale
+            _bus().invalidateCache(_i2cAddr);
         } else {
             _writeReg(seq[i].reg, seq[i].val);
         }
@@ -673,6 +675,15 @@ HalInitResult HalCirrusDac2ch::init() {
           _desc.logPrefix, _i2cBusIndex, _sdaPin, _sclPin);
 #endif
 
+    // Register shadow: elides unchanged writes (volume sweeps, repeated
+    // configure()). Cirrus MAP auto-increment is opt-in per transfer, so no
+    // bursts; paged parts get the paged write shadow only.
+    _bus().enableCache(_i2cAddr, false);
+    _bus().invalidateCache(_i2cAddr);
+    if (_desc.regType != REG_16BIT_PAGED) {
+        _bus().markVolatile(_i2cAddr, (uint8_t)_desc.regChipId, (uint8_t)_desc.regChipId);
+    }
+
     // 3. Verify chip ID (log warning on mismatch — continue)
     uint8_t chipId = _readReg(_desc.regChipId);
     if ((chipId & _desc.chipIdMask) != (_desc.chipId & _desc.chipIdMask)) {
@@ -766,6 +777,8 @@ void HalCirrusDac2ch::deinit() {
 
     _disableI2sTx();
 
+    _bus().disableCache(_i2cAddr);
+
     _hpAmpEnabled = false;
     _nosEnabled   = false;
     _initialized  = false;
@@ -74,10 +74,9 @@ bool HalDspBridge::dspSetBypassed(bool bypass) {
 
 float HalDspBridge::dspGetInputLevel(uint8_t lane) const {
 #ifndef NATIVE_TEST
-    AudioAnalysis analysis = i2s_audio_get_analysis();
-    // Return combined RMS for the requested input lane
+    // Return combined RMS for the requested input lane (one-lane snapshot)
     if (lane < AUDIO_PIPELINE_MAX_INPUTS) {
-        return analysis.adc[lane].rmsCombined;
+        return i2s_audio_get_lane_analysis(lane).rmsCombined;
     }
     return 0.0f;
 #else
@@ -571,14 +571,17 @@ HalInitResult HalEssAdc2ch::init() {
 
 #ifndef NATIVE_TEST
     if (port == 0) {
-        _inputSrc.read     = i2s_audio_port0_read;
-        _inputSrc.isActive = i2s_audio_port0_active;
+        _inputSrc.read      = i2s_audio_port0_read;
+        _inputSrc.isActive  = i2s_audio_port0_active;
+        _inputSrc.available = i2s_audio_port0_available;
     } else if (port == 1) {
-        _inputSrc.read     = i2s_audio_port1_read;
-        _inputSrc.isActive = i2s_audio_port1_active;
+        _inputSrc.read      = i2s_audio_port1_read;
+        _inputSrc.isActive  = i2s_audio_port1_active;
+        _inputSrc.available = i2s_audio_port1_available;
     } else {
-        _inputSrc.read     = i2s_audio_port2_read;
-        _inputSrc.isActive = i2s_audio_port2_active;
+        _inputSrc.read      = i2s_audio_port2_read;
+        _inputSrc.isActive  = i2s_audio_port2_active;
+        _inputSrc.available = i2s_audio_port2_available;
     }
     _inputSrc.getSampleRate = i2s_audio_get_sample_rate;
 #endif
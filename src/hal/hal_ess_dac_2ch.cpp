@@ -400,6 +400,9 @@ void HalEssDac2ch::_execSequence(const EssDac2chRegWrite* seq, uint8_t len) {
 #ifndef NATIVE_TEST
             delay((uint32_t)seq[i].val * 5u);
 #endif
+            // The delay follows a soft reset / PLL start — register contents
+            // are back to chip defaults, so the shadow no longer matches
+            _bus().invalidateCache(_i2cAddr);
         } else {
             _writeReg(seq[i].reg, seq[i].val);
         }
@@ -446,6 +449,18 @@ HalInitResult HalEssDac2ch::init() {
     // 2. Select TwoWire instance and initialize I2C bus at 400 kHz
     _selectWire();
 
+    // Register shadow: SABRE parts auto-increment, so the L/R volume pair
+    // goes out as one burst. Reg 0 (soft reset / soft start), the readback
+    // page and any status register always hit the bus.
+    HalI2cBus& bus = _bus();
+    bus.enableCache(_i2cAddr, true);
+    bus.invalidateCache(_i2cAddr);
+    bus.markVolatile(_i2cAddr, 0x00, 0x00);
+    bus.markVolatile(_i2cAddr, 0xE0, 0xFF);              // Readback page (chip ID, DPLL lock)
+    if (_desc.regFeatureStatus != REG_NO_FEATURE) {
+        bus.markVolatile(_i2cAddr, _desc.regFeatureStatus, _desc.regFeatureStatus);
+    }
+
     // 3. Verify chip ID (log warning on mismatch — continue)
     uint8_t chipId = _readReg(ESS_SABRE_REG_CHIP_ID);
     if (chipId != _desc.chipId) {
@@ -458,6 +473,9 @@ HalInitResult HalEssDac2ch::init() {
     // 4. Run chip-specific init sequence (resets, format config, DPLL, etc.)
     _execSequence(_desc.initSeq, _desc.initSeqLen);
 
+    // 5-7 are staged and flushed together (one mutex hold, bursts where contiguous)
+    HalI2cUpdate upd(bus);
+
     // 5. Clock gear / word length based on current sample rate
     if (_desc.reconfigType == RECONFIG_CLOCK_GEAR && _desc.regClockGear != REG_NO_FEATURE) {
         _writeReg(_desc.regClockGear, _computeClockGear(_sampleRate));
@@ -492,6 +510,9 @@ HalInitResult HalEssDac2ch::init() {
     } else {
         _writeReg(_desc.regFilter, (uint8_t)(preset & _desc.filterMask));
     }
+    if (!upd.end()) {
+        LOG_W("%s Register flush reported a write failure", _desc.logPrefix);
+    }
 
     // 8. Enable expansion I2S TX output
     if (!_enableI2sTx()) {
@@ -519,6 +540,8 @@ void HalEssDac2ch::deinit() {
 
     _disableI2sTx();
 
+    _bus().disableCache(_i2cAddr);
+
     _featureEnabled = false;
     _initialized    = false;
     _i2sTxEnabled   = false;
@@ -607,6 +630,7 @@ bool HalEssDac2ch::setVolume(uint8_t percent) {
     if (percent > 100) percent = 100;
 
     bool ok;
+    HalI2cUpdate upd(_bus());   // L/R pair flushes as one burst
     switch (_desc.volType) {
         case VOL_SINGLE_128: {
             if (_muted) { _volume = percent; return true; }  // defer — mute holds 0xFF
@@ -624,6 +648,7 @@ bool HalEssDac2ch::setVolume(uint8_t percent) {
             break;
         }
     }
+    ok = upd.end() && ok;
 
     _volume = percent;
     return ok;
@@ -633,6 +658,7 @@ bool HalEssDac2ch::setMute(bool mute) {
     if (!_initialized) return false;
 
     bool ok;
+    HalI2cUpdate upd(_bus());
     switch (_desc.muteType) {
         case MUTE_VIA_DEDICATED_BIT: {
             uint8_t reg = _readReg(_desc.regFilter);
@@ -661,6 +687,7 @@ bool HalEssDac2ch::setMute(bool mute) {
             break;
         }
     }
+    ok = upd.end() && ok;
 
     _muted = mute;
     LOG_I("%s %s", _desc.logPrefix, mute ? "Muted" : "Unmuted");
@@ -495,6 +495,15 @@ HalInitResult HalEssDac8ch::init() {
     // ---- 2. Select TwoWire instance and initialize I2C bus at 400 kHz ----
     _selectWire();
 
+    // Register shadow: the 8-channel SABRE parts auto-increment, so the eight
+    // adjacent channel volumes go out as one burst. Reg 0 (soft reset) and
+    // the readback page (chip ID) always hit the bus.
+    HalI2cBus& bus = _bus();
+    bus.enableCache(_i2cAddr, true);
+    bus.invalidateCache(_i2cAddr);
+    bus.markVolatile(_i2cAddr, ESS8CH_REG_SYS_CONFIG, ESS8CH_REG_SYS_CONFIG);
+    bus.markVolatile(_i2cAddr, 0xE0, 0xFF);
+
     // ---- 3. Execute init sequence (soft reset + configure) ----
     _execSequence(_desc.initSeq, _desc.initSeqLen);
 
@@ -514,6 +523,9 @@ HalInitResult HalEssDac8ch::init() {
               _desc.logPrefix, chipId, _desc.chipId);
     }
 
+    // 5-6 are staged and flushed together (one mutex hold, volumes as one burst)
+    HalI2cUpdate upd(bus);
+
     // ---- 5. Per-channel volume: apply stored level ----
     // Map 100% -> 0x00 (0 dB), 0% -> 0xFF (full attenuation)
     uint8_t volReg = (uint8_t)((100U - _volume) * 255U / 100U);
@@ -526,6 +538,7 @@ HalInitResult HalEssDac8ch::init() {
     uint8_t filterReg = (uint8_t)(preset & _desc.filterMask);
     if (_muted) filterReg |= _desc.muteBit;
     _writeReg(_desc.regFilterMute, filterReg);
+    upd.end();
 
     // ---- 7. Enable expansion TDM TX output (8-slot TDM) ----
     HalDeviceConfig* tdmCfg = HalDeviceManager::instance().getConfig(_slot);
@@ -681,9 +694,11 @@ bool HalEssDac8ch::setVolume(uint8_t percent) {
     // Map 100% -> 0x00 (0 dB), 0% -> 0xFF (full attenuation)
     uint8_t volReg = (uint8_t)((100U - percent) * 255U / 100U);
     bool ok = true;
+    HalI2cUpdate upd(_bus());   // Eight channel registers flush as one burst
     for (uint8_t ch = 0; ch < 8; ++ch) {
         ok = _writeReg((uint8_t)(_desc.regVolCh1 + ch), volReg) && ok;
     }
+    ok = upd.end() && ok;
 
     _volume = percent;
     LOG_D("%s Volume: %d%% -> reg=0x%02X", _desc.logPrefix, percent, volReg);
@@ -10,6 +10,8 @@
 // TwoWire Wire2(2) definitions from the codebase.
 
 #include "hal_i2c_bus.h"
+#include <stdlib.h>
+#include <string.h>
 
 #ifndef NATIVE_TEST
 #include <Wire.h>
@@ -81,6 +83,189 @@ void HalI2cBus::_releaseMutex() {
 
 #endif // NATIVE_TEST
 
+bool HalI2cBus::_lock(const char* op, uint8_t addr) {
+#ifndef NATIVE_TEST
+    if (!_acquireMutex()) {
+        LOG_W("[I2C:%u] Mutex timeout on %s(0x%02X)", _busIndex, op, addr);
+        return false;
+    }
+#else
+    (void)op; (void)addr;
+#endif
+    return true;
+}
+
+void HalI2cBus::_unlock() {
+#ifndef NATIVE_TEST
+    _releaseMutex();
+#endif
+}
+
+// ===== Raw transactions (caller holds the mutex) =====
+
+bool HalI2cBus::_rawWrite(uint8_t addr, const uint8_t* bytes, uint8_t len) {
+    auto* wire = _busToWire(_busIndex);
+    wire->beginTransmission(addr);
+    wire->write(bytes, len);
+    _stats.transactions++;
+    return wire->endTransmission() == 0;
+}
+
+// Register-pointer write + repeated start + 1-byte read
+bool HalI2cBus::_rawRead(uint8_t addr, const uint8_t* regBytes, uint8_t regLen, uint8_t* val) {
+    auto* wire = _busToWire(_busIndex);
+    wire->beginTransmission(addr);
+    wire->write(regBytes, regLen);
+    wire->endTransmission(false);
+    wire->requestFrom(addr, (uint8_t)1);
+    _stats.transactions++;
+    if (!wire->available()) return false;
+    *val = (uint8_t)wire->read();
+    return true;
+}
+
+// ===== Register shadow cache =====
+
+static inline bool _bitGet(const uint8_t* m, uint8_t r) { return (m[r >> 3] >> (r & 7)) & 1; }
+static inline void _bitSet(uint8_t* m, uint8_t r)       { m[r >> 3] |= (uint8_t)(1u << (r & 7)); }
+static inline void _bitClr(uint8_t* m, uint8_t r)       { m[r >> 3] &= (uint8_t)~(1u << (r & 7)); }
+
+HalI2cBus::RegCache* HalI2cBus::_findCache(uint8_t addr) {
+    if (!_cacheEnabled) return nullptr;
+    for (int i = 0; i < HAL_I2C_CACHE_DEVICES; i++) {
+        if (_cache[i] && _cache[i]->addr == addr) return _cache[i];
+    }
+    return nullptr;
+}
+
+bool HalI2cBus::enableCache(uint8_t addr, bool autoIncrement) {
+    if (!_lock("enableCache", addr)) return false;
+    bool ok = true;
+    bool prev = _cacheEnabled;
+    _cacheEnabled = true;   // _findCache() must see existing slots regardless of the switch
+    RegCache* c = _findCache(addr);
+    _cacheEnabled = prev;
+    if (!c) {
+        int slot = -1;
+        for (int i = 0; i < HAL_I2C_CACHE_DEVICES; i++) {
+            if (!_cache[i]) { slot = i; break; }
+        }
+        if (slot >= 0) c = (RegCache*)calloc(1, sizeof(RegCache));
+        if (c) {
+            c->addr = addr;
+            _cache[slot] = c;
+            LOG_I("[I2C:%u] Register cache enabled for 0x%02X", _busIndex, addr);
+        } else {
+            LOG_W("[I2C:%u] Register cache unavailable for 0x%02X", _busIndex, addr);
+            ok = false;
+        }
+    }
+    if (c) c->autoIncrement = autoIncrement;
+    _unlock();
+    return ok;
+}
+
+void HalI2cBus::markVolatile(uint8_t addr, uint8_t first, uint8_t last) {
+    if (!_lock("markVolatile", addr)) return;
+    for (int i = 0; i < HAL_I2C_CACHE_DEVICES; i++) {
+        RegCache* c = _cache[i];
+        if (!c || c->addr != addr) continue;
+        for (int r = first; r <= last; r++) {
+            _bitSet(c->volatileMask, (uint8_t)r);
+            _bitClr(c->valid, (uint8_t)r);
+            _bitClr(c->dirty, (uint8_t)r);
+        }
+    }
+    _unlock();
+}
+
+void HalI2cBus::invalidateCache(uint8_t addr) {
+    if (!_lock("invalidateCache", addr)) return;
+    for (int i = 0; i < HAL_I2C_CACHE_DEVICES; i++) {
+        RegCache* c = _cache[i];
+        if (!c || c->addr != addr) continue;
+        memset(c->valid, 0, sizeof(c->valid));
+        memset(c->dirty, 0, sizeof(c->dirty));
+        c->pagedCount = 0;
+        c->pagedNext = 0;
+    }
+    _unlock();
+}
+
+void HalI2cBus::disableCache(uint8_t addr) {
+    if (!_lock("disableCache", addr)) return;
+    for (int i = 0; i < HAL_I2C_CACHE_DEVICES; i++) {
+        if (_cache[i] && _cache[i]->addr == addr) {
+            free(_cache[i]);
+            _cache[i] = nullptr;
+        }
+    }
+    _unlock();
+}
+
+void HalI2cBus::setCacheEnabled(bool enabled) {
+    if (!_lock("setCacheEnabled", 0)) return;
+    if (!enabled) {
+        // Write-through while off leaves the shadows stale — drop them
+        _flushDirty();
+        for (int i = 0; i < HAL_I2C_CACHE_DEVICES; i++) {
+            if (!_cache[i]) continue;
+            memset(_cache[i]->valid, 0, sizeof(_cache[i]->valid));
+            _cache[i]->pagedCount = 0;
+        }
+    }
+    _cacheEnabled = enabled;
+    _unlock();
+}
+
+bool HalI2cBus::beginUpdate() {
+    if (!_lock("beginUpdate", 0)) return false;
+    if (_updateDepth++ == 0) _updateFailed = false;
+    return true;
+}
+
+bool HalI2cBus::endUpdate() {
+    if (_updateDepth == 0) return false;
+    bool ok = true;
+    if (--_updateDepth == 0) {
+        ok = _flushDirty() && !_updateFailed;
+    }
+    _unlock();
+    return ok;
+}
+
+// Write staged registers: each run of consecutive dirty registers becomes one
+// auto-increment burst (single writes if the device lacks auto-increment).
+bool HalI2cBus::_flushDirty() {
+    bool ok = true;
+    uint8_t buf[1 + HAL_I2C_BURST_MAX];
+    for (int i = 0; i < HAL_I2C_CACHE_DEVICES; i++) {
+        RegCache* c = _cache[i];
+        if (!c) continue;
+        int r = 0;
+        while (r < 256) {
+            if (c->dirty[r >> 3] == 0) { r = (r | 7) + 1; continue; }
+            if (!_bitGet(c->dirty, (uint8_t)r)) { r++; continue; }
+            uint8_t start = (uint8_t)r;
+            uint8_t n = 0;
+            buf[0] = start;
+            do {
+                buf[1 + n++] = c->val[r];
+                _bitClr(c->dirty, (uint8_t)r);
+                r++;
+            } while (c->autoIncrement && r < 256 && n < HAL_I2C_BURST_MAX && _bitGet(c->dirty, (uint8_t)r));
+            if (n > 1) _stats.bursts++;
+            if (!_rawWrite(c->addr, buf, (uint8_t)(1 + n))) {
+                for (uint8_t k = 0; k < n; k++) _bitClr(c->valid, (uint8_t)(start + k));
+                LOG_E("[I2C:%u] Burst write failed: addr=0x%02X reg=0x%02X len=%u",
+                      _busIndex, c->addr, start, n);
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
 // ===== begin() / end() =====
 
 bool HalI2cBus::begin(int8_t sda, int8_t scl, uint32_t freqHz) {
@@ -146,121 +331,135 @@ bool HalI2cBus::isSdioBlocked() const {
 // ===== I2C operations =====
 
 bool HalI2cBus::writeReg(uint8_t addr, uint8_t reg, uint8_t val) {
-#ifndef NATIVE_TEST
-    if (!_acquireMutex()) {
-        LOG_W("[I2C:%u] Mutex timeout on writeReg(0x%02X, 0x%02X)", _busIndex, addr, reg);
-        return false;
+    if (!_lock("writeReg", addr)) return false;
+    RegCache* c = _findCache(addr);
+    bool cacheable = c && !_bitGet(c->volatileMask, reg);
+    if (cacheable && _bitGet(c->valid, reg) && c->val[reg] == val) {
+        _stats.elided++;
+        _unlock();
+        return true;
     }
-    TwoWire* wire = _busToWire(_busIndex);
-    wire->beginTransmission(addr);
-    wire->write(reg);
-    wire->write(val);
-    uint8_t err = wire->endTransmission();
-    _releaseMutex();
-    if (err != 0) {
-        LOG_E("[I2C:%u] writeReg failed: addr=0x%02X reg=0x%02X val=0x%02X err=%d",
-              _busIndex, addr, reg, val, err);
-        return false;
+    if (cacheable && _updateDepth > 0) {
+        c->val[reg] = val;
+        _bitSet(c->valid, reg);
+        _bitSet(c->dirty, reg);
+        _unlock();
+        return true;
     }
-    return true;
-#else
-    auto* wire = _busToWire(_busIndex);
-    wire->beginTransmission(addr);
-    wire->write(reg);
-    wire->write(val);
-    return wire->endTransmission() == 0;
-#endif
+    // Direct write: anything staged goes first so bus order follows call order
+    if (_updateDepth > 0 && !_flushDirty()) _updateFailed = true;
+    uint8_t buf[2] = { reg, val };
+    bool ok = _rawWrite(addr, buf, 2);
+    if (cacheable) {
+        c->val[reg] = val;
+        if (ok) _bitSet(c->valid, reg);
+        else    _bitClr(c->valid, reg);
+    }
+    _unlock();
+    if (!ok) {
+        LOG_E("[I2C:%u] writeReg failed: addr=0x%02X reg=0x%02X val=0x%02X",
+              _busIndex, addr, reg, val);
+    }
+    return ok;
 }
 
 uint8_t HalI2cBus::readReg(uint8_t addr, uint8_t reg) {
-#ifndef NATIVE_TEST
-    if (!_acquireMutex()) {
-        LOG_W("[I2C:%u] Mutex timeout on readReg(0x%02X, 0x%02X)", _busIndex, addr, reg);
-        return 0xFF;
+    if (!_lock("readReg", addr)) return 0xFF;
+    RegCache* c = _findCache(addr);
+    bool cacheable = c && !_bitGet(c->volatileMask, reg);
+    if (cacheable && _bitGet(c->valid, reg)) {
+        uint8_t v = c->val[reg];
+        _stats.cacheHits++;
+        _unlock();
+        return v;
     }
-    TwoWire* wire = _busToWire(_busIndex);
-    wire->beginTransmission(addr);
-    wire->write(reg);
-    wire->endTransmission(false);
-    wire->requestFrom(addr, (uint8_t)1);
+    if (_updateDepth > 0 && !_flushDirty()) _updateFailed = true;
     uint8_t val = 0xFF;
-    if (wire->available()) val = wire->read();
-    else LOG_E("[I2C:%u] readReg failed: addr=0x%02X reg=0x%02X", _busIndex, addr, reg);
-    _releaseMutex();
+    bool ok = _rawRead(addr, &reg, 1, &val);
+    if (ok && cacheable) {
+        c->val[reg] = val;
+        _bitSet(c->valid, reg);
+    }
+    _unlock();
+    if (!ok) LOG_E("[I2C:%u] readReg failed: addr=0x%02X reg=0x%02X", _busIndex, addr, reg);
     return val;
-#else
-    auto* wire = _busToWire(_busIndex);
-    wire->beginTransmission(addr);
-    wire->write(reg);
-    wire->endTransmission(false);
-    wire->requestFrom(addr, (uint8_t)1);
-    if (wire->available()) return wire->read();
-    return 0xFF;
-#endif
 }
 
 bool HalI2cBus::writeReg16(uint8_t addr, uint8_t regLsb, uint16_t val) {
-    bool ok = writeReg(addr, regLsb,     (uint8_t)(val & 0xFF));
-    ok      = ok && writeReg(addr, regLsb + 1, (uint8_t)((val >> 8) & 0xFF));
-    return ok;
+    uint8_t lo = (uint8_t)(val & 0xFF);
+    uint8_t hi = (uint8_t)((val >> 8) & 0xFF);
+    uint8_t regMsb = (uint8_t)(regLsb + 1);
+    if (!beginUpdate()) return false;
+    RegCache* c = _findCache(addr);
+    if (c) {
+        bool same = _bitGet(c->valid, regLsb) && _bitGet(c->valid, regMsb) &&
+                    !_bitGet(c->volatileMask, regLsb) && !_bitGet(c->volatileMask, regMsb) &&
+                    c->val[regLsb] == lo && c->val[regMsb] == hi;
+        if (same) {
+            _stats.elided += 2;
+            endUpdate();
+            return true;
+        }
+        // The MSB write latches the pair — never elide one half of a change
+        _bitClr(c->valid, regLsb);
+        _bitClr(c->valid, regMsb);
+    }
+    bool ok = writeReg(addr, regLsb, lo);
+    ok      = writeReg(addr, regMsb, hi) && ok;
+    return endUpdate() && ok;
 }
 
 bool HalI2cBus::writeRegPaged(uint8_t addr, uint16_t reg, uint8_t val) {
-#ifndef NATIVE_TEST
-    if (!_acquireMutex()) {
-        LOG_W("[I2C:%u] Mutex timeout on writeRegPaged(0x%02X, 0x%04X)", _busIndex, addr, reg);
-        return false;
+    if (!_lock("writeRegPaged", addr)) return false;
+    RegCache* c = _findCache(addr);
+    int hit = -1;
+    if (c) {
+        for (int i = 0; i < c->pagedCount; i++) {
+            if (c->pagedReg[i] == reg) { hit = i; break; }
+        }
+        if (hit >= 0 && c->pagedVal[hit] == val) {
+            _stats.elided++;
+            _unlock();
+            return true;
+        }
     }
-    TwoWire* wire = _busToWire(_busIndex);
-    wire->beginTransmission(addr);
-    wire->write((uint8_t)((reg >> 8) & 0xFF));  // Address high byte
-    wire->write((uint8_t)(reg & 0xFF));          // Address low byte
-    wire->write(val);
-    uint8_t err = wire->endTransmission();
-    _releaseMutex();
-    if (err != 0) {
-        LOG_E("[I2C:%u] writeRegPaged failed: addr=0x%02X reg=0x%04X val=0x%02X err=%d",
-              _busIndex, addr, reg, val, err);
-        return false;
+    if (_updateDepth > 0 && !_flushDirty()) _updateFailed = true;
+    uint8_t buf[3] = { (uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF), val };  // Address high, low, data
+    bool ok = _rawWrite(addr, buf, 3);
+    if (c) {
+        if (!ok) {
+            if (hit >= 0) c->pagedReg[hit] = 0xFFFF;   // Unknown device state — never elide
+        } else {
+            if (hit < 0) {
+                if (c->pagedCount < HAL_I2C_PAGED_SHADOW) {
+                    hit = c->pagedCount++;
+                } else {
+                    hit = c->pagedNext;
+                    c->pagedNext = (uint8_t)((c->pagedNext + 1) % HAL_I2C_PAGED_SHADOW);
+                }
+                c->pagedReg[hit] = reg;
+            }
+            c->pagedVal[hit] = val;
+        }
     }
-    return true;
-#else
-    auto* wire = _busToWire(_busIndex);
-    wire->beginTransmission(addr);
-    wire->write((uint8_t)((reg >> 8) & 0xFF));
-    wire->write((uint8_t)(reg & 0xFF));
-    wire->write(val);
-    return wire->endTransmission() == 0;
-#endif
+    _unlock();
+    if (!ok) {
+        LOG_E("[I2C:%u] writeRegPaged failed: addr=0x%02X reg=0x%04X val=0x%02X",
+              _busIndex, addr, reg, val);
+    }
+    return ok;
 }
 
+// Paged reads always hit the bus — the paged shadow only elides writes
 uint8_t HalI2cBus::readRegPaged(uint8_t addr, uint16_t reg) {
-#ifndef NATIVE_TEST
-    if (!_acquireMutex()) {
-        LOG_W("[I2C:%u] Mutex timeout on readRegPaged(0x%02X, 0x%04X)", _busIndex, addr, reg);
-        return 0xFF;
-    }
-    TwoWire* wire = _busToWire(_busIndex);
-    wire->beginTransmission(addr);
-    wire->write((uint8_t)((reg >> 8) & 0xFF));
-    wire->write((uint8_t)(reg & 0xFF));
-    wire->endTransmission(false);
-    wire->requestFrom(addr, (uint8_t)1);
+    if (!_lock("readRegPaged", addr)) return 0xFF;
+    if (_updateDepth > 0 && !_flushDirty()) _updateFailed = true;
+    uint8_t regBytes[2] = { (uint8_t)((reg >> 8) & 0xFF), (uint8_t)(reg & 0xFF) };
     uint8_t val = 0xFF;
-    if (wire->available()) val = wire->read();
-    else LOG_E("[I2C:%u] readRegPaged failed: addr=0x%02X reg=0x%04X", _busIndex, addr, reg);
-    _releaseMutex();
+    bool ok = _rawRead(addr, regBytes, 2, &val);
+    _unlock();
+    if (!ok) LOG_E("[I2C:%u] readRegPaged failed: addr=0x%02X reg=0x%04X", _busIndex, addr, reg);
     return val;
-#else
-    auto* wire = _busToWire(_busIndex);
-    wire->beginTransmission(addr);
-    wire->write((uint8_t)((reg >> 8) & 0xFF));
-    wire->write((uint8_t)(reg & 0xFF));
-    wire->endTransmission(false);
-    wire->requestFrom(addr, (uint8_t)1);
-    if (wire->available()) return wire->read();
-    return 0xFF;
-#endif
 }
 
 bool HalI2cBus::probe(uint8_t addr) {
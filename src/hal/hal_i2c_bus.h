@@ -18,6 +18,19 @@
  *   HalI2cBus& bus = HalI2cBus::get(HAL_I2C_BUS_EXP);
  *   bus.writeReg(0x48, 0x01, 0xA0);
  *
+ * Register shadow cache (opt-in per device, 8-bit register map):
+ *   bus.enableCache(0x48, true);            // device supports auto-increment
+ *   bus.markVolatile(0x48, 0xE0, 0xFF);     // status/readback always hits the bus
+ *   { HalI2cUpdate upd(bus);                // one mutex hold for the whole update
+ *     bus.writeReg(0x48, 0x0F, v);          // staged; unchanged values elided
+ *     bus.writeReg(0x48, 0x10, v); }        // flushed as one 2-byte burst
+ *   Outside an update, writes go straight out but are still elided when the
+ *   shadow already holds the value, and readReg() of a non-volatile register
+ *   is answered from the shadow. Staged registers flush in ascending address
+ *   order — writes whose order matters (resets, latches) must not be staged
+ *   out of order; a volatile or paged write inside an update flushes first.
+ *   Paged (16-bit address) writes keep a small write-elision shadow only.
+ *
  * TwoWire Wire2 is defined in hal_i2c_bus.cpp — do not declare it elsewhere.
  */
 
@@ -29,6 +42,17 @@
 static_assert(HAL_I2C_BUS_EXT == 0 && HAL_I2C_BUS_ONBOARD == 1 && HAL_I2C_BUS_EXP == 2,
               "HalI2cBus expects bus indices 0/1/2");
 
+#define HAL_I2C_CACHE_DEVICES  4     // Cached devices per bus
+#define HAL_I2C_PAGED_SHADOW   16    // Paged-register write shadow entries per device
+#define HAL_I2C_BURST_MAX      32    // Max data bytes per auto-increment burst
+
+struct HalI2cBusStats {
+    uint32_t transactions;  // Bus transactions issued (write or read)
+    uint32_t elided;        // Writes skipped — shadow already held the value
+    uint32_t cacheHits;     // Reads answered from the shadow
+    uint32_t bursts;        // Multi-register auto-increment writes
+};
+
 class HalI2cBus {
 public:
     // Singleton accessor — clamps busIndex to 0-2
@@ -48,7 +72,8 @@ public:
     // Read single 8-bit register (returns 0xFF on error)
     uint8_t readReg(uint8_t addr, uint8_t reg);
 
-    // Write 16-bit value: LSB at regLsb, MSB at regLsb+1 (MSB write latches both)
+    // Write 16-bit value: LSB at regLsb, MSB at regLsb+1 (MSB write latches both).
+    // One mutex hold; a single burst when the device is cached with auto-increment.
     bool writeReg16(uint8_t addr, uint8_t regLsb, uint16_t val);
 
     // Cirrus Logic paged register: 2-byte address (high, low), 1-byte data
@@ -69,6 +94,34 @@ public:
     // Raw multi-byte read into buf[]; returns bytes actually read
     uint8_t readBytes(uint8_t addr, uint8_t* buf, uint8_t len);
 
+    // ===== Register shadow cache =====
+
+    // Opt `addr` into the shadow cache (idempotent). `autoIncrement`: the
+    // device accepts reg,val0,val1,... as sequential register writes.
+    bool enableCache(uint8_t addr, bool autoIncrement);
+
+    // Registers first..last always hit the bus (status, readback, self-clearing)
+    void markVolatile(uint8_t addr, uint8_t first, uint8_t last);
+
+    // Forget all shadowed values for `addr` (after a soft reset); staged writes are dropped
+    void invalidateCache(uint8_t addr);
+
+    // Release the shadow for `addr` (device removed)
+    void disableCache(uint8_t addr);
+
+    // Bus-wide switch — off restores plain write-through behaviour (diagnostics/tests)
+    void setCacheEnabled(bool enabled);
+
+    // Write-combining update: takes the bus mutex until the matching endUpdate().
+    // Cached writes in between are staged and flushed as bursts by the
+    // outermost endUpdate(), which returns false if any flush write failed.
+    // Prefer the HalI2cUpdate guard below. Nests.
+    bool beginUpdate();
+    bool endUpdate();
+
+    HalI2cBusStats getStats() const { return _stats; }
+    void resetStats() { _stats = HalI2cBusStats(); }
+
     // ===== SDIO guard (Bus 0 only) =====
     // Returns true when Bus 0 must not be accessed (WiFi SDIO sharing GPIO 48/54)
     bool isSdioBlocked() const;
@@ -85,6 +138,31 @@ private:
     uint8_t _busIndex;
     bool    _begun = false;
 
+    struct RegCache {
+        uint8_t  addr;
+        bool     autoIncrement;
+        uint8_t  valid[32];         // Bitmaps over the 8-bit register space
+        uint8_t  dirty[32];
+        uint8_t  volatileMask[32];
+        uint8_t  val[256];
+        uint16_t pagedReg[HAL_I2C_PAGED_SHADOW];
+        uint8_t  pagedVal[HAL_I2C_PAGED_SHADOW];
+        uint8_t  pagedCount;
+        uint8_t  pagedNext;         // Round-robin replacement
+    };
+    RegCache*      _cache[HAL_I2C_CACHE_DEVICES] = {};
+    bool           _cacheEnabled = true;
+    uint8_t        _updateDepth  = 0;
+    bool           _updateFailed = false;
+    HalI2cBusStats _stats = {};
+
+    RegCache* _findCache(uint8_t addr);
+    bool _lock(const char* op, uint8_t addr);
+    void _unlock();
+    bool _rawWrite(uint8_t addr, const uint8_t* bytes, uint8_t len);
+    bool _rawRead(uint8_t addr, const uint8_t* regBytes, uint8_t regLen, uint8_t* val);
+    bool _flushDirty();
+
 #ifndef NATIVE_TEST
     // FreeRTOS recursive mutex handle — created once in begin()
     void* _mutex = nullptr;   // type-erased SemaphoreHandle_t (avoids pulling in FreeRTOS headers here)
@@ -94,4 +172,23 @@ private:
 #endif
 };
 
+// Scoped write-combining update: staged register writes are flushed when the
+// guard goes out of scope, or earlier via end() to get the flush result.
+class HalI2cUpdate {
+public:
+    explicit HalI2cUpdate(HalI2cBus& bus) : _bus(bus) { _held = bus.beginUpdate(); }
+    ~HalI2cUpdate() { end(); }
+    bool held() const { return _held; }
+    bool end() {
+        if (!_held) return false;
+        _held = false;
+        return _bus.endUpdate();
+    }
+    HalI2cUpdate(const HalI2cUpdate&) = delete;
+    HalI2cUpdate& operator=(const HalI2cUpdate&) = delete;
+private:
+    HalI2cBus& _bus;
+    bool       _held;
+};
+
 #endif // DAC_ENABLED
@@ -80,6 +80,7 @@ HalInitResult HalPcm1808::init() {
     // Port-indexed thunks will be defined in i2s_audio.h/cpp
     _inputSrc.read          = (port == 0) ? i2s_audio_port0_read : i2s_audio_port1_read;
     _inputSrc.isActive      = (port == 0) ? i2s_audio_port0_active : i2s_audio_port1_active;
+    _inputSrc.available     = (port == 0) ? i2s_audio_port0_available : i2s_audio_port1_available;
     _inputSrc.getSampleRate = i2s_audio_get_sample_rate;
 #endif
     _inputSrcReady = true;
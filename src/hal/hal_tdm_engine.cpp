@@ -0,0 +1,346 @@
+#ifdef DAC_ENABLED
+// hal_tdm_engine.cpp — N-slot TDM engine and the shared lane-view pool
+//
+// See hal_tdm_engine.h for the RX/TX models and the registration scheme.
+// The frame kernels live in tdm_kernels.h.
+
+#include "hal_tdm_engine.h"
+#include "../psram_alloc.h"
+
+#ifndef NATIVE_TEST
+#include "../i2s_audio.h"
+#include "../debug_serial.h"
+#else
+// ===== Native test stubs =====
+#define LOG_I(fmt, ...) ((void)0)
+#define LOG_W(fmt, ...) ((void)0)
+#define LOG_E(fmt, ...) ((void)0)
+#define LOG_D(fmt, ...) ((void)0)
+
+// Port stubs (real implementations live in i2s_audio.cpp). Tests that feed
+// synthetic TDM frames define TDM_TEST_PROVIDES_STUBS and supply their own
+// i2s_port_tdm_read / i2s_port_is_rx_active. The TX write is compiled out
+// unless TDM_INTERLEAVER_TEST_PROVIDES_STUBS supplies i2s_port_write.
+#ifndef TDM_TEST_PROVIDES_STUBS
+inline uint32_t i2s_port_tdm_read(uint8_t, void*, uint32_t, uint16_t) { return 0; }
+inline bool     i2s_port_is_rx_active(uint8_t) { return false; }
+#endif // TDM_TEST_PROVIDES_STUBS
+#endif // NATIVE_TEST
+
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// View pool — entry V routes the callbacks of one bound lane view to its
+// engine. Entry points are generated per pool index, not per engine.
+// ---------------------------------------------------------------------------
+
+struct TdmViewEntry {
+    HalTdmEngine* engine;    // nullptr = free
+    uint8_t       ordinal;   // View ordinal inside the engine
+};
+
+static TdmViewEntry _gViews[TDM_ENGINE_MAX_VIEWS] = {};
+
+template <int V> static uint32_t _viewRead(int32_t* dst, uint32_t frames) {
+    HalTdmEngine* e = _gViews[V].engine;
+    return e ? e->viewRead(_gViews[V].ordinal, dst, frames) : 0;
+}
+template <int V> static uint32_t _viewBorrow(AudioLaneView* view, uint32_t frames) {
+    HalTdmEngine* e = _gViews[V].engine;
+    return e ? e->viewBorrow(_gViews[V].ordinal, view, frames) : 0;
+}
+template <int V> static bool _viewActive(void) {
+    HalTdmEngine* e = _gViews[V].engine;
+    return e ? e->viewActive(_gViews[V].ordinal) : false;
+}
+template <int V> static void _viewWrite(const int32_t* src, int frames) {
+    HalTdmEngine* e = _gViews[V].engine;
+    if (e) e->viewWrite(_gViews[V].ordinal, src, frames);
+}
+template <int V> static bool _viewReady(void) {
+    HalTdmEngine* e = _gViews[V].engine;
+    return e ? e->isReady() : false;
+}
+
+static_assert(TDM_ENGINE_MAX_VIEWS <= 16, "extend the view entry tables below");
+
+#define _TDM_VIEW_TABLE(fn) { fn<0>,  fn<1>,  fn<2>,  fn<3>,  fn<4>,  fn<5>,  fn<6>,  fn<7>, \
+                              fn<8>,  fn<9>,  fn<10>, fn<11>, fn<12>, fn<13>, fn<14>, fn<15> }
+
+typedef uint32_t (*TdmReadFn)(int32_t*, uint32_t);
+typedef uint32_t (*TdmBorrowFn)(AudioLaneView*, uint32_t);
+typedef bool     (*TdmStatusFn)(void);
+typedef void     (*TdmWriteFn)(const int32_t*, int);
+
+static const TdmReadFn   _gViewRead[16]   = _TDM_VIEW_TABLE(_viewRead);
+static const TdmBorrowFn _gViewBorrow[16] = _TDM_VIEW_TABLE(_viewBorrow);
+static const TdmStatusFn _gViewActive[16] = _TDM_VIEW_TABLE(_viewActive);
+static const TdmWriteFn  _gViewWrite[16]  = _TDM_VIEW_TABLE(_viewWrite);
+static const TdmStatusFn _gViewReady[16]  = _TDM_VIEW_TABLE(_viewReady);
+
+#undef _TDM_VIEW_TABLE
+
+static uint32_t _tdmSampleRate(void) {
+#ifndef NATIVE_TEST
+    return i2s_audio_get_sample_rate();
+#else
+    return 48000;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Constructor / Destructor
+// ---------------------------------------------------------------------------
+
+HalTdmEngine::HalTdmEngine()
+    : _frameBuf(nullptr),
+      _fmt{0, 0},
+      _maxFrames(0),
+      _viewCount(0),
+      _frames(0),
+      _pending(0),
+      _held(false),
+      _i2sPort(0),
+      _dir(TDM_DIR_RX),
+      _ready(false),
+      _initialized(false)
+{
+    memset(_slotL, 0, sizeof(_slotL));
+    memset(_slotR, 0, sizeof(_slotR));
+    memset(_poolIdx, 0xFF, sizeof(_poolIdx));
+}
+
+HalTdmEngine::~HalTdmEngine() {
+    deinit();
+}
+
+// ---------------------------------------------------------------------------
+// init() / deinit()
+// ---------------------------------------------------------------------------
+
+bool HalTdmEngine::init(uint8_t i2sPort, TdmDirection dir, TdmFormat fmt, uint16_t maxFrames) {
+    if (_initialized) return true;
+    if (!tdm_format_valid(fmt) || maxFrames == 0) {
+        LOG_E("[HAL:TDM] Invalid format: %u slots x %u bits, %u frames",
+              fmt.slots, fmt.slotBits, maxFrames);
+        return false;
+    }
+
+    const size_t bufBytes = (size_t)maxFrames * tdm_frame_bytes(fmt);
+    _frameBuf = (uint8_t*)psram_alloc(bufBytes, 1, "tdm_frames");
+    if (!_frameBuf) {
+        LOG_E("[HAL:TDM] Frame buffer alloc failed (%u bytes)", (unsigned)bufBytes);
+        return false;
+    }
+
+    _i2sPort     = i2sPort;
+    _dir         = dir;
+    _fmt         = fmt;
+    _maxFrames   = maxFrames;
+    _frames      = 0;
+    _pending     = 0;
+    _held        = false;
+    _ready       = (dir == TDM_DIR_TX);   // TX needs no first read
+    _initialized = true;
+
+    LOG_I("[HAL:TDM] %s engine ready: port=%u %u slots x %u bits, %u frames (%u bytes)",
+          dir == TDM_DIR_TX ? "TX" : "RX", _i2sPort, fmt.slots, fmt.slotBits,
+          maxFrames, (unsigned)bufBytes);
+    return true;
+}
+
+void HalTdmEngine::deinit() {
+    unbindViews();
+    psram_free(_frameBuf, "tdm_frames");
+    _frameBuf    = nullptr;
+    _frames      = 0;
+    _pending     = 0;
+    _held        = false;
+    _ready       = false;
+    _initialized = false;
+}
+
+void HalTdmEngine::unbindViews() {
+    for (uint8_t v = 0; v < _viewCount; v++) {
+        if (_poolIdx[v] < TDM_ENGINE_MAX_VIEWS) _gViews[_poolIdx[v]].engine = nullptr;
+        _poolIdx[v] = 0xFF;
+    }
+    _viewCount = 0;
+    _pending   = 0;
+}
+
+// ---------------------------------------------------------------------------
+// View binding
+// ---------------------------------------------------------------------------
+
+// Claims a pool entry for the next view ordinal; returns the pool index or -1
+int8_t HalTdmEngine::_claimView(uint8_t slotL, uint8_t slotR) {
+    if (!_initialized) {
+        LOG_E("[HAL:TDM] Bind before init");
+        return -1;
+    }
+    if (!tdm_pair_valid(_fmt, slotL, slotR) || _viewCount >= TDM_ENGINE_MAX_PAIRS) {
+        LOG_E("[HAL:TDM] Invalid slot map %u/%u for %u slots (%u views bound)",
+              slotL, slotR, _fmt.slots, _viewCount);
+        return -1;
+    }
+    for (uint8_t i = 0; i < TDM_ENGINE_MAX_VIEWS; i++) {
+        if (_gViews[i].engine) continue;
+        const uint8_t ord = _viewCount++;
+        _gViews[i].engine  = this;
+        _gViews[i].ordinal = ord;
+        _poolIdx[ord] = i;
+        _slotL[ord]   = slotL;
+        _slotR[ord]   = slotR;
+        return (int8_t)i;
+    }
+    LOG_E("[HAL:TDM] All %d lane views in use", TDM_ENGINE_MAX_VIEWS);
+    return -1;
+}
+
+bool HalTdmEngine::bindSource(const char* name, uint8_t slotL, uint8_t slotR,
+                              AudioInputSource* out) {
+    memset(out, 0, sizeof(AudioInputSource));
+    out->name          = name;
+    out->lane          = 0;       // Overwritten by bridge during registration
+    out->halSlot       = 0xFF;    // Overwritten by bridge
+    out->gainLinear    = 1.0f;
+    out->vuL           = -90.0f;
+    out->vuR           = -90.0f;
+    out->isHardwareAdc = true;
+    if (_dir != TDM_DIR_RX) return false;
+
+    int8_t v = _claimView(slotL, slotR);
+    if (v < 0) return false;    // Callbacks stay null so the caller can detect it
+    out->read          = _gViewRead[v];
+    out->isActive      = _gViewActive[v];
+    out->getSampleRate = _tdmSampleRate;
+    // 32-bit slots are int32 words in place; 16/24-bit containers need the
+    // gather in read(). The frame buffer holds until the first view reads
+    // again, so there is nothing to release.
+    if (_fmt.slotBits == 32) out->borrow = _gViewBorrow[v];
+    return true;
+}
+
+bool HalTdmEngine::bindSink(const char* name, uint8_t slotL, uint8_t slotR, uint8_t firstChannel,
+                            uint8_t halSlot, AudioOutputSink* out) {
+    memset(out, 0, sizeof(AudioOutputSink));
+    out->name         = name;
+    out->firstChannel = firstChannel;
+    out->channelCount = 2;
+    out->gainLinear   = 1.0f;
+    out->volumeGain   = 1.0f;
+    out->muted        = false;
+    out->vuL          = -90.0f;
+    out->vuR          = -90.0f;
+    out->halSlot      = halSlot;
+    if (_dir != TDM_DIR_TX) return false;
+
+    int8_t v = _claimView(slotL, slotR);
+    if (v < 0) return false;
+    out->write   = _gViewWrite[v];
+    out->isReady = _gViewReady[v];
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// RX — first view reads the port, every view gathers from the frame buffer
+// ---------------------------------------------------------------------------
+
+// First view: one block from the port into the frame buffer. Returns the
+// frames the block holds (0 = nothing received).
+uint32_t HalTdmEngine::_pull(uint32_t frames) {
+    if (frames > _maxFrames) frames = _maxFrames;
+    // In native tests the test translation unit supplies the read via
+    // TDM_TEST_PROVIDES_STUBS (see the NATIVE_TEST block above)
+    uint32_t got = i2s_port_tdm_read(_i2sPort, _frameBuf, frames,
+                                     (uint16_t)tdm_frame_bytes(_fmt));
+    _frames = got;
+    if (got) _ready = true;
+    return got;
+}
+
+uint32_t HalTdmEngine::viewRead(uint8_t ordinal, int32_t* dst, uint32_t frames) {
+    if (!_initialized || _dir != TDM_DIR_RX || ordinal >= _viewCount) return 0;
+
+    uint32_t count;
+    if (ordinal == 0 && _held) {
+        _held = false;            // Pulled by a borrow that could not lend it
+        count = _frames < frames ? _frames : frames;
+    } else if (ordinal == 0) {
+        count = _pull(frames);
+    } else {
+        if (!_ready) return 0;
+        count = _frames < frames ? _frames : frames;
+    }
+    if (count) tdm_gather_pair(_frameBuf, _fmt, _slotL[ordinal], _slotR[ordinal], dst, count);
+    return count;
+}
+
+uint32_t HalTdmEngine::viewBorrow(uint8_t ordinal, AudioLaneView* view, uint32_t frames) {
+    if (!_initialized || _dir != TDM_DIR_RX || ordinal >= _viewCount) return 0;
+    if (_fmt.slotBits != 32) return 0;
+
+    // Only a whole block is lent; a short port read falls back to read()
+    // for the other views, which zero-pad the rest
+    if (ordinal == 0) {
+        _held = _pull(frames) != frames;
+        if (_held) return 0;
+    } else if (!_ready || _frames != frames) {
+        return 0;
+    }
+    const int32_t* words = (const int32_t*)_frameBuf;
+    view->left   = words + _slotL[ordinal];
+    view->right  = words + _slotR[ordinal];
+    view->stride = _fmt.slots;
+    view->gain   = 1.0f;
+    return frames;
+}
+
+bool HalTdmEngine::viewActive(uint8_t ordinal) const {
+    if (!_initialized) return false;
+    // The first view is live while the port receives; the others once it
+    // has produced a block for them
+    return ordinal == 0 ? i2s_port_is_rx_active(_i2sPort) : _ready;
+}
+
+// ---------------------------------------------------------------------------
+// TX — every view scatters into the frame buffer, the last one flushes
+// ---------------------------------------------------------------------------
+
+void HalTdmEngine::viewWrite(uint8_t ordinal, const int32_t* src, int frames) {
+    if (!_initialized || _dir != TDM_DIR_TX || !src || frames <= 0) return;
+    if (ordinal >= _viewCount) return;
+    if (frames > _maxFrames) frames = _maxFrames;
+
+    const uint16_t bit = (uint16_t)(1u << ordinal);
+    if (_pending & bit) _flush();        // Last view was skipped: send the open block first
+    if (!_pending) _frames = (uint32_t)frames;
+
+    tdm_scatter_pair(_frameBuf, _fmt, _slotL[ordinal], _slotR[ordinal], src, (uint32_t)frames);
+    _pending |= bit;
+
+    if (ordinal == _viewCount - 1) _flush();
+}
+
+void HalTdmEngine::_flush() {
+    if (!_pending || _frames == 0) return;
+
+    // Views not written this block play silence, not their previous samples
+    for (uint8_t v = 0; v < _viewCount; v++) {
+        if (!(_pending & (1u << v))) tdm_clear_pair(_frameBuf, _fmt, _slotL[v], _slotR[v], _frames);
+    }
+
+    // In native builds the write is compiled out unless the test captures it
+    // via TDM_INTERLEAVER_TEST_PROVIDES_STUBS
+    const size_t txBytes = (size_t)_frames * tdm_frame_bytes(_fmt);
+#if !defined(NATIVE_TEST) || defined(TDM_INTERLEAVER_TEST_PROVIDES_STUBS)
+    size_t written = 0;
+    i2s_port_write(_i2sPort, _frameBuf, txBytes, &written, 5);
+#else
+    (void)txBytes;
+#endif
+    _pending = 0;
+}
+
+#endif // DAC_ENABLED
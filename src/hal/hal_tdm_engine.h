@@ -0,0 +1,138 @@
+#pragma once
+#ifdef DAC_ENABLED
+// hal_tdm_engine.h — N-slot TDM engine shared by every TDM device driver
+//
+// One HalTdmEngine owns one direction of one I2S port in TDM mode: 2 to 16
+// slots per frame, 16/24/32-bit slot containers (tdm_kernels.h). The driver
+// binds stereo lane views onto it, each naming the two slots it carries
+// (the slot map), and hands the resulting AudioInputSource / AudioOutputSink
+// structs to the pipeline bridge.
+//
+// RX ("first view reads")
+// -----------------------
+// The pipeline reads lanes in ascending order and the bridge registers a
+// device's sources on consecutive lanes, so the first bound view is always
+// read first in a pipeline tick. Its read pulls one block of TDM frames from
+// the port into the engine's frame buffer and gathers its two slots straight
+// into the caller's lane buffer; every later view gathers its slots from the
+// same frame buffer, limited to the frame count the first view got. There
+// are no per-pair intermediate buffers and nothing to swap: the frame buffer
+// only changes when the first view reads again, on the next tick.
+//
+// With 32-bit slots the views also lend their block in place (borrow): the
+// first view's borrow pulls the block like its read, and every view hands
+// the pipeline its two slots of the frame buffer with the frame as stride,
+// so the lane is converted to float without being gathered first.
+//
+// TX ("last view flushes")
+// ------------------------
+// Each sink write scatters its two slots straight into the frame buffer.
+// The last bound view's write sends the block to the port. Views the
+// pipeline skipped this tick (muted, not ready) are silenced in the block
+// rather than repeating their previous samples. If the last view itself is
+// skipped, the next write to a view that already wrote this tick flushes the
+// pending block first, so the port keeps running one block late instead of
+// stalling.
+//
+// Registration
+// ------------
+// AudioInputSource / AudioOutputSink callbacks carry no context pointer.
+// Instead of a hand-written thunk set per engine instance, views are drawn
+// from one pool of TDM_ENGINE_MAX_VIEWS entries shared by all engines; pool
+// entry V has its own read / write / status entry points that look up the
+// engine and view ordinal in the pool. Any mix of RX and TX engines can be
+// live as long as their views fit in the pool. deinit() returns the views.
+//
+// Threading: binding and init/deinit run on the HAL task before the bridge
+// publishes the callbacks; the callbacks run on the audio task only.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "../tdm_kernels.h"
+#include "../audio_input_source.h"
+#include "../audio_output_sink.h"
+
+// Lane views shared by all engine instances (RX and TX)
+#ifndef TDM_ENGINE_MAX_VIEWS
+#define TDM_ENGINE_MAX_VIEWS 16
+#endif
+
+// Stereo views one engine can carry (16 slots / 2)
+#define TDM_ENGINE_MAX_PAIRS (TDM_MAX_SLOTS / 2)
+
+enum TdmDirection : uint8_t {
+    TDM_DIR_RX = 0,
+    TDM_DIR_TX = 1
+};
+
+class HalTdmEngine {
+public:
+    HalTdmEngine();
+    ~HalTdmEngine();
+
+    // Allocate the frame buffer (maxFrames × frame bytes, PSRAM preferred).
+    // Returns false on an invalid format or allocation failure. Idempotent
+    // while initialized (the first configuration stays).
+    bool init(uint8_t i2sPort, TdmDirection dir, TdmFormat fmt, uint16_t maxFrames);
+
+    // Release the frame buffer and return all bound views to the pool.
+    // Safe to call even if init() failed or was never called.
+    void deinit();
+
+    // Return all bound views to the pool, keeping the frame buffer. The
+    // callbacks handed out for them must no longer be called: the pool
+    // entries go to the next engine that binds.
+    void unbindViews();
+
+    // Bind an RX view carrying slotL / slotR. Fills *out completely (name,
+    // callbacks, defaults; lane/halSlot are left for the bridge). Returns
+    // false, leaving the callbacks null, when not initialized, the slot map
+    // is out of range or the view pool is full.
+    bool bindSource(const char* name, uint8_t slotL, uint8_t slotR, AudioInputSource* out);
+
+    // Bind a TX view writing slotL / slotR. firstChannel is the sink's
+    // initial matrix channel (the bridge may overwrite it). Same failure
+    // behaviour as bindSource().
+    bool bindSink(const char* name, uint8_t slotL, uint8_t slotR, uint8_t firstChannel,
+                  uint8_t halSlot, AudioOutputSink* out);
+
+    // RX: true once the first view has read at least one frame.
+    // TX: true while initialized.
+    bool isReady() const { return _ready; }
+    bool isInitialized() const { return _initialized; }
+    TdmFormat format() const { return _fmt; }
+    uint8_t viewCount() const { return _viewCount; }
+
+    // Entry points used by the view pool (audio task only)
+    uint32_t viewRead(uint8_t ordinal, int32_t* dst, uint32_t frames);
+    uint32_t viewBorrow(uint8_t ordinal, AudioLaneView* view, uint32_t frames);
+    bool     viewActive(uint8_t ordinal) const;
+    void     viewWrite(uint8_t ordinal, const int32_t* src, int frames);
+
+private:
+    int8_t _claimView(uint8_t slotL, uint8_t slotR);
+    uint32_t _pull(uint32_t frames);
+    void   _flush();
+
+    uint8_t*  _frameBuf;                         // maxFrames TDM frames, DMA layout
+    TdmFormat _fmt;
+    uint16_t  _maxFrames;
+    uint8_t   _slotL[TDM_ENGINE_MAX_PAIRS];      // Slot map, by view ordinal
+    uint8_t   _slotR[TDM_ENGINE_MAX_PAIRS];
+    uint8_t   _poolIdx[TDM_ENGINE_MAX_PAIRS];    // Pool entry of each view
+    uint8_t   _viewCount;
+
+    // RX: frames in _frameBuf from the first view's last read.
+    // TX: frames of the block being assembled (set by its first write).
+    uint32_t _frames;
+    uint16_t _pending;                           // TX: views written into the open block
+    bool     _held;                              // RX: short block pulled by a borrow, left for read()
+
+    uint8_t      _i2sPort;
+    TdmDirection _dir;
+    bool         _ready;
+    bool         _initialized;
+};
+
+#endif // DAC_ENABLED
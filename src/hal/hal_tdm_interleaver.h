@@ -13,46 +13,26 @@
 //   SLOT4 = pair2 L (CH5)    SLOT5 = pair2 R (CH6)
 //   SLOT6 = pair3 L (CH7)    SLOT7 = pair3 R (CH8)
 //
-// Thread-safety model ("last writer flushes")
-// -------------------------------------------
-// The audio pipeline task (Core 1) calls sink write callbacks in ascending
-// slot order.  The bridge registers pair 0 at the lowest slot index, pair 3
-// at the highest.  Therefore the pipeline always calls pairs 0, 1, 2, 3 in
-// that order within the same task tick.
-//
-// Pair 0 write callback:
-//   - Copies stereo frame data into _pairBuf[_writeIdx][0].
-//   - No flush yet.
-//
-// Pair 1 and 2 write callbacks:
-//   - Copy stereo frame data into _pairBuf[_writeIdx][1] / [2].
-//   - No flush yet.
-//
-// Pair 3 write callback:
-//   - Copies stereo frame data into _pairBuf[_writeIdx][3].
-//   - Interleaves all four pair buffers into _tdmBuf (8 slots per frame).
-//   - Calls i2s_audio_write_expansion_tdm_tx() to push to I2S DMA.
-//   - Swaps _writeIdx (ping-pong) so the next tick uses the other side.
-//
-// Ping-pong scheme
-// ----------------
-// Two sides of _pairBuf[0..3] let the next pipeline tick start buffering into
-// the idle side while the current tick is still flushing the TDM write.  Because
-// all four pairs run sequentially on Core 1 and the I2S write is synchronous
-// (blocking until DMA accepts the buffer), no mutex is required.
+// It is the 8-channel DAC front end of HalTdmEngine (hal_tdm_engine.h): a TX
+// engine on the device's I2S port (8 slots × 32 bits) with four lane views.
+// Each pair's write callback scatters its samples straight into the TDM
+// frame buffer; pair 3, the last view, sends the block to I2S ("last writer
+// flushes").  The pipeline calls sinks in ascending slot order and the bridge
+// registers pair 0 at the lowest slot, so all four pairs land in the same
+// block within one task tick.  A pair the pipeline skips (muted) is sent as
+// silence; if pair 3 itself is skipped the block goes out on the next tick's
+// first write instead of stalling the port.
 //
 // Buffer sizing
 // -------------
-// TDM_INTERLEAVER_FRAMES stereo frames per pair per side:
-//   Per-pair bytes per side = TDM_INTERLEAVER_FRAMES × 2 × sizeof(int32_t)
-//   TDM output buffer      = TDM_INTERLEAVER_FRAMES × 8 × sizeof(int32_t)
-// With 256 frames: 256×2×4 = 2 048 bytes per pair-side, 256×8×4 = 8 192 bytes TDM.
-// Allocated from PSRAM when available (not latency-critical; DMA read is internal SRAM).
+// One frame buffer of TDM_INTERLEAVER_FRAMES × 8 slots × 4 bytes (8 KB at
+// 256 frames), allocated from PSRAM when available.
 
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
 #include "../audio_output_sink.h"
+#include "hal_tdm_engine.h"
 
 // Maximum stereo frames per TDM output buffer.  Should match the pipeline's
 // DMA buffer length (I2S_DMA_BUF_LEN).  Defining it here keeps the interleaver
@@ -68,28 +48,30 @@
 #define TDM_INTERLEAVER_SLOTS 8
 
 // ---------------------------------------------------------------------------
-// HalTdmInterleaver — self-contained interleaver state machine.
+// HalTdmInterleaver — 8-slot TX engine with four stereo lane views.
 // One instance lives inside a multi-channel DAC driver (e.g. HalEssDac8ch).
 // The driver calls init() once during its own init(), then passes the four
 // AudioOutputSink pointers to the pipeline bridge via buildSinks().
 // ---------------------------------------------------------------------------
 class HalTdmInterleaver {
 public:
-    HalTdmInterleaver();
-    ~HalTdmInterleaver();
+    HalTdmInterleaver() {}
+    ~HalTdmInterleaver() { deinit(); }
 
-    // Allocate ping-pong pair buffers + TDM output buffer (PSRAM preferred).
+    // Allocate the TDM output buffer (PSRAM preferred).
     // port: I2S port index used for TDM TX output.
-    // Returns false if any allocation fails — caller should abort HAL init.
+    // Returns false if the allocation fails — caller should abort HAL init.
     bool init(uint8_t i2sPort);
 
-    // Release all buffers.  Safe to call even if init() failed or was never called.
+    // Release the buffer and the lane views.  Safe to call even if init()
+    // failed or was never called.
     void deinit();
 
     // Populate four AudioOutputSink structs, one per stereo pair.
     // nameA/B/C/D: human-readable names ("ES9038PRO CH1/2" ... "ES9038PRO CH7/8").
     // halSlot: HAL device slot index set on all four sinks (bridge overwrites firstChannel).
-    // Must be called after init().
+    // Must be called after init().  When the shared view pool is exhausted
+    // all four write/isReady callbacks are left null.
     void buildSinks(const char* nameA, const char* nameB,
                     const char* nameC, const char* nameD,
                     AudioOutputSink* outA, AudioOutputSink* outB,
@@ -97,49 +79,10 @@ public:
                     uint8_t halSlot);
 
     // Returns true after init() succeeds.  Stays true until deinit().
-    bool isReady() const { return _ready; }
+    bool isReady() const { return _engine.isReady(); }
 
 private:
-    // Instance-level write implementation called by static thunks.
-    // pairIdx 0-3; buf is stereo interleaved (frames × 2 int32_t); frames = stereo frame count.
-    void _writePair(uint8_t pairIdx, const int32_t* buf, int frames);
-
-    // Called by pair 3 write: interleave all four pairs into _tdmBuf and TX.
-    void _flushTdm(int frames);
-
-    // ---- Static thunks — slot 0 (instance 0) ----
-    static void _writePair0_0(const int32_t* buf, int frames);
-    static void _writePair1_0(const int32_t* buf, int frames);
-    static void _writePair2_0(const int32_t* buf, int frames);
-    static void _writePair3_0(const int32_t* buf, int frames);
-    static bool _isReady_0(void);
-
-    // ---- Static thunks — slot 1 (instance 1) ----
-    static void _writePair0_1(const int32_t* buf, int frames);
-    static void _writePair1_1(const int32_t* buf, int frames);
-    static void _writePair2_1(const int32_t* buf, int frames);
-    static void _writePair3_1(const int32_t* buf, int frames);
-    static bool _isReady_1(void);
-
-    // --------------- Ping-pong buffer state ---------------
-    // _pairBuf[side][pairIdx] points to a stereo interleaved buffer of
-    // TDM_INTERLEAVER_FRAMES int32_t pairs (L+R) per stereo pair.
-    int32_t* _pairBuf[2][TDM_INTERLEAVER_PAIR_COUNT];  // [ping|pong][pair0..3]
-
-    // Assembled TDM output buffer: TDM_INTERLEAVER_FRAMES × 8 slots × int32_t
-    int32_t* _tdmBuf;
-
-    // Ping-pong index: write callbacks use _writeIdx, flush toggles it after TX.
-    // volatile + uint8_t: single-byte store is atomic on RISC-V.
-    volatile uint8_t _writeIdx;
-
-    // Last frame count passed by the pipeline (set by pair 0, used by flush).
-    int _lastFrames;
-
-    uint8_t _i2sPort;
-    bool    _ready;
-    bool    _initialized;
-    uint8_t _instanceIdx;  // Index into _gInterleaverInstances[]; 0xFF = not registered
+    HalTdmEngine _engine;
 };
 
 #endif // DAC_ENABLED
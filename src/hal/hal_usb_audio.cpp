@@ -15,6 +15,8 @@
 inline bool usb_audio_is_streaming() { return false; }
 inline bool usb_audio_is_connected() { return false; }
 inline uint32_t usb_audio_read(int32_t*, uint32_t) { return 0; }
+inline uint32_t usb_audio_borrow(const int32_t**, uint32_t) { return 0; }
+inline void usb_audio_release(uint32_t) {}
 inline uint32_t usb_audio_get_negotiated_rate() { return 48000; }
 inline float usb_audio_get_volume_linear() { return 1.0f; }
 inline bool usb_audio_get_mute() { return false; }
@@ -34,6 +36,22 @@ static uint32_t _usb_read(int32_t *dst, uint32_t frames) {
     return got;
 }
 
+// Zero-copy path: the pipeline converts straight out of the ring buffer and
+// folds the host volume into its conversion scale
+static uint32_t _usb_borrow(AudioLaneView *view, uint32_t frames) {
+    const int32_t *data = nullptr;
+    if (usb_audio_borrow(&data, frames) != frames) return 0;
+    view->left   = data;
+    view->right  = data + 1;
+    view->stride = 2;
+    view->gain   = usb_audio_get_mute() ? 0.0f : usb_audio_get_volume_linear();
+    return frames;
+}
+
+static void _usb_release(uint32_t frames) {
+    usb_audio_release(frames);
+}
+
 static bool _usb_isActive(void) {
     return usb_audio_is_streaming();
 }
@@ -64,6 +82,8 @@ HalUsbAudio::HalUsbAudio() : HalDevice() {
     _source._vuSmoothedL = 0.0f;
     _source._vuSmoothedR = 0.0f;
     _source.halSlot = 0xFF;     // Set by bridge
+    _source.borrow = _usb_borrow;
+    _source.release = _usb_release;
 }
 
 bool HalUsbAudio::probe() {
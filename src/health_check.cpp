@@ -8,6 +8,7 @@
 #include "diag_error_codes.h"
 #include "task_monitor.h"
 #include "i2s_audio.h"
+#include "config_snapshot.h"
 
 #include "hal/hal_types.h"  // hal_safe_strcpy, HAL_BUS_I2C, HAL_STATE_* constants
 #ifdef DAC_ENABLED
@@ -555,16 +556,23 @@ static void _check_storage(HealthCheckReport* report) {
         return;
     }
 
-    bool hasConfig = LittleFS.exists("/config.json");
+    // Settings live in the A/B snapshot (loaded or written since boot)
+    ConfigSnapshotStats snap = config_snapshot_get_stats();
     char detail[40];
-    snprintf(detail, sizeof(detail), "%uKB/%uKB used%s",
-             (unsigned)(used / 1024), (unsigned)(total / 1024),
-             hasConfig ? "" : " no config.json");
-
-    if (!hasConfig) {
+    if (snap.activeSlot < 0) {
+        snprintf(detail, sizeof(detail), "%uKB/%uKB used, no snapshot",
+                 (unsigned)(used / 1024), (unsigned)(total / 1024));
+        _add_item(report, "storage", HC_WARN, detail);
+        LOG_W("[Health] storage: WARN (no valid settings snapshot)");
+    } else if (snap.fallbacks > 0) {
+        snprintf(detail, sizeof(detail), "%uKB/%uKB used, snap fallback",
+                 (unsigned)(used / 1024), (unsigned)(total / 1024));
         _add_item(report, "storage", HC_WARN, detail);
-        LOG_W("[Health] storage: WARN (no /config.json)");
+        LOG_W("[Health] storage: WARN (newest settings snapshot invalid, gen %lu in use)",
+              (unsigned long)snap.generation);
     } else {
+        snprintf(detail, sizeof(detail), "%uKB/%uKB used, gen %lu",
+                 (unsigned)(used / 1024), (unsigned)(total / 1024), (unsigned long)snap.generation);
         _add_item(report, "storage", HC_PASS, detail);
         LOG_I("[Health] storage: PASS (%s)", detail);
     }
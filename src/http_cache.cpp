@@ -0,0 +1,38 @@
+// http_cache.cpp — ETag matching for conditional GET. See http_cache.h.
+
+#include "http_cache.h"
+#include <string.h>
+
+static inline bool _isSpace(char c) { return c == ' ' || c == '\t'; }
+
+// Skip an optional W/ weakness prefix
+static const char *_opaque(const char *tag) {
+    return (tag[0] == 'W' && tag[1] == '/') ? tag + 2 : tag;
+}
+
+bool http_etag_matches(const char *ifNoneMatch, const char *etag) {
+    if (!ifNoneMatch || !etag || !*etag) return false;
+    const char *want = _opaque(etag);
+    size_t wantLen = strlen(want);
+
+    const char *p = ifNoneMatch;
+    while (*p) {
+        while (_isSpace(*p) || *p == ',') p++;
+        if (!*p) break;
+        const char *start = p;
+        // Entity tags are quoted and may not contain '"'; commas inside the
+        // quotes therefore cannot occur — scan to the next separator
+        while (*p && *p != ',') p++;
+        const char *end = p;
+        while (end > start && _isSpace(end[-1])) end--;
+        if (end - start == 1 && *start == '*') return true;
+        const char *tag = _opaque(start);
+        if ((size_t)(end - tag) == wantLen && memcmp(tag, want, wantLen) == 0) return true;
+    }
+    return false;
+}
+
+int http_cache_status(const char *acceptEncoding, const char *ifNoneMatch, const char *etag) {
+    if (!acceptEncoding || !strstr(acceptEncoding, "gzip")) return 0;
+    return http_etag_matches(ifNoneMatch, etag) ? 304 : 200;
+}
@@ -0,0 +1,37 @@
+#pragma once
+// http_cache.h — Conditional-GET support for the embedded web assets.
+//
+// tools/build_web_assets.js emits a strong ETag (truncated SHA-256 of the
+// gzipped bytes) next to every *_gz array, plus an optional table of
+// content-hashed assets (--split). Pages are served "no-cache" so the browser
+// revalidates with If-None-Match and gets a bodyless 304 when the firmware is
+// unchanged; hashed assets never change under their URL and are "immutable".
+// Pure C++ — no WebServer dependency, testable natively.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HTTP_CACHE_REVALIDATE "no-cache"
+#define HTTP_CACHE_IMMUTABLE  "public, max-age=31536000, immutable"
+
+// One content-hashed asset (generated into web_pages_gz.cpp)
+struct WebAsset {
+    const char    *path;          // e.g. "/assets/app.1f7004a4.js"
+    const uint8_t *gz;            // Gzipped body (PROGMEM)
+    size_t         gzLen;
+    const char    *etag;          // Quoted strong ETag
+    const char    *contentType;
+};
+
+// True if an If-None-Match header value matches `etag` (RFC 9110 §13.1.2):
+// a comma-separated list of entity tags compared weakly (W/ prefixes are
+// ignored), or "*". NULL/empty header never matches.
+bool http_etag_matches(const char *ifNoneMatch, const char *etag);
+
+// Decide the response for a GET of a gzipped asset. Returns 304 when the
+// client's cached copy is current, 200 to send the body, or 0 when the client
+// does not accept gzip (caller falls back to the uncompressed page). The
+// ETag describes the gzipped representation only, so a non-gzip request is
+// never answered 304.
+int http_cache_status(const char *acceptEncoding, const char *ifNoneMatch, const char *etag);
@@ -4,8 +4,11 @@
 #include "app_state.h"
 #include "config.h"
 #include "debug_serial.h"
+#include "audio_scheduler.h"
+#include "audio_rate_convert.h"
 #ifdef DSP_ENABLED
 #include "dsp_pipeline.h"
+#include "output_dsp.h"
 #endif
 #ifdef DAC_ENABLED
 #include "dac_hal.h"
@@ -35,6 +38,7 @@
 #include <driver/i2s_tdm.h>
 #include <driver/gpio.h>
 #include <esp_task_wdt.h>
+#include <esp_timer.h>
 #include <esp_heap_caps.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -42,10 +46,11 @@
 #include "hal/hal_device_manager.h"
 #endif
 #include "psram_alloc.h"
+#include "seqlock.h"
 
 // ===== Constants =====
-static const int DMA_BUF_COUNT = I2S_DMA_BUF_COUNT;
-static const int DMA_BUF_LEN = I2S_DMA_BUF_LEN;
+// DMA descriptor count / length of every I2S channel, from the latency profile
+static AudioDmaGeometry _dmaGeom = audio_latency_dma(AUDIO_LATENCY_BALANCED);
 static const float DBFS_FLOOR = -96.0f;
 
 // ===== Clip Rate EMA Constants =====
@@ -53,10 +58,15 @@ static const float CLIP_RATE_ALPHA = 0.1f;      // EMA smoothing factor
 static const float CLIP_RATE_HW_FAULT = 0.3f;   // >30% clipping = hardware fault
 static const float CLIP_RATE_CLIPPING = 0.001f;  // >0.1% clipping = signal too hot
 
-// ===== Shared state (written by I2S task, read by main loop) =====
-static volatile AudioAnalysis _analysis = {};
+// ===== Shared state (written by the audio task, read by main loop / web / MQTT / GUI) =====
+// Published through seqlocks (seqlock.h): the audio task updates in place
+// without waiting, readers copy what they need and retry if a write
+// overlapped. Nobody masks interrupts.
+static AudioAnalysis _analysis = {};
+static Seqlock _analysisLock = {};
 static volatile bool _analysisReady = false;
 static AudioDiagnostics _diagnostics = {};
+static Seqlock _diagLock = {};
 
 // Periodic dump: audio task sets flag, main loop does the actual LOG calls
 // (Serial.print at 9600-115200 baud blocks for tens-hundreds of ms, starving I2S DMA)
@@ -240,6 +250,8 @@ void audio_aggregate_fft_bands(const float *magnitudes, int fft_size,
 AudioHealthStatus audio_derive_health_status(const AdcDiagnostics &diag) {
     // I2S bus errors take highest priority
     if (diag.i2sReadErrors > 10) return AUDIO_I2S_ERROR;
+    // Port stopped delivering DMA data (capture flags it instead of blocking)
+    if (diag.stalled) return AUDIO_NO_DATA;
     // ADC not sending any data
     if (diag.consecutiveZeros > 100) return AUDIO_NO_DATA;
     // Hardware fault: sustained high clip rate (>30%) = power loss / floating pins
@@ -300,11 +312,66 @@ static I2sPortState _port[I2S_PORT_COUNT] = {};
 #define _rx_handle_adc2 _port[1].rx
 
 static uint32_t _currentSampleRate = DEFAULT_AUDIO_SAMPLE_RATE;
-static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
 static int _numAdcsDetected = 1;
 static bool _adc2InitOk = false;
 static bool _expansionRxOk = false;
 
+// ===== DMA-driven block scheduling =====
+// ADC1 RX on_recv counts completed descriptors into _sched and notifies the
+// audio task once per block; I2S0 TX on_sent counts what the DAC has played
+// so the pipeline can measure how much output is still queued.
+static AudioScheduler _sched = {};
+static volatile bool _schedArmed = false;          // Callbacks registered on live channels
+static TaskHandle_t _schedTask = NULL;
+static volatile uint32_t _txSentBytes = 0;         // ISR: bytes sent by I2S0 TX DMA
+static uint32_t _txWrittenBytes = 0;               // Audio task: bytes handed to I2S0 TX
+static uint32_t _txFrameBytes = 8;                 // I2S0 TX bytes per stereo frame
+
+// ===== Readiness-based capture (see audio_capture.h) =====
+// Every RX channel's on_recv adds the bytes its DMA completed; reads add what
+// they consumed. The difference is what a read returns without waiting.
+static volatile uint32_t _rxDmaBytes[I2S_PORT_COUNT] = {};   // ISR
+static uint32_t _rxReadBytes[I2S_PORT_COUNT] = {};           // Audio task
+
+static bool IRAM_ATTR _i2s_port_on_recv(i2s_chan_handle_t, i2s_event_data_t *ev, void *arg) {
+    _rxDmaBytes[(uintptr_t)arg] += (uint32_t)ev->size;
+    return false;
+}
+
+// New RX channel on a port: nothing is ready yet
+static void _rx_ready_reset(uint8_t port) {
+    _rxReadBytes[port] = _rxDmaBytes[port];
+}
+
+static inline void _rx_ready_consume(uint8_t port, size_t bytes) {
+    _rxReadBytes[port] += (uint32_t)bytes;
+}
+
+static uint32_t _rx_ready_frames(uint8_t port) {
+    uint32_t ready = _rxDmaBytes[port] - _rxReadBytes[port];
+    uint32_t ring = (uint32_t)_dmaGeom.descCount * _dmaGeom.descFrames * 2 * sizeof(int32_t);
+    if (ready > ring) {
+        // The driver dropped the oldest descriptors — only the ring is left
+        _rxReadBytes[port] = _rxDmaBytes[port] - ring;
+        ready = ring;
+    }
+    return ready / (2 * sizeof(int32_t));
+}
+
+static bool IRAM_ATTR _i2s_rx_on_recv(i2s_chan_handle_t, i2s_event_data_t *ev, void *) {
+    _rxDmaBytes[0] += (uint32_t)ev->size;
+    uint32_t frames = (uint32_t)(ev->size / (2 * sizeof(int32_t)));
+    if (!audio_sched_on_dma(_sched, frames, (uint32_t)esp_timer_get_time())) return false;
+    BaseType_t woken = pdFALSE;
+    if (_schedTask) vTaskNotifyGiveFromISR(_schedTask, &woken);
+    return woken == pdTRUE;
+}
+
+static bool IRAM_ATTR _i2s_tx_on_sent(i2s_chan_handle_t, i2s_event_data_t *ev, void *) {
+    _txSentBytes += (uint32_t)ev->size;
+    return false;
+}
+
 // Per-ADC state arrays
 static const float MAX_24BIT_F = 8388607.0f;
 
@@ -344,6 +411,7 @@ static float *_fftData = nullptr;
 static float *_fftWindow = nullptr;
 #endif
 static int _fftRingPos[AUDIO_PIPELINE_MAX_INPUTS] = {};
+static uint8_t _fftSkip[AUDIO_PIPELINE_MAX_INPUTS] = {};   // Windows dropped by the DSP load governor
 static FftWindowType _currentWindowType = FFT_WINDOW_HANN;
 static bool _fftInitialized = false;
 static float _spectrumOutput[AUDIO_PIPELINE_MAX_INPUTS][SPECTRUM_BANDS];
@@ -389,6 +457,7 @@ static inline gpio_num_t _resolveI2sPin(int8_t cfgValue, int fallback) {
 // tx=true targets the TX handle; tx=false targets the RX handle.
 static void _i2s_port_teardown_dir(uint8_t port, bool tx) {
     if (port >= I2S_PORT_COUNT) return;
+    if (port == 0) _schedArmed = false;   // Recreated channels carry no callbacks
     i2s_chan_handle_t* h = tx ? &_port[port].tx : &_port[port].rx;
     if (*h) {
         i2s_channel_disable(*h);
@@ -418,8 +487,8 @@ static bool _i2s_port_alloc(uint8_t port, bool needTx, bool needRx, bool autoClr
 
     i2s_port_t idfPort = (i2s_port_t)port;
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(idfPort, I2S_ROLE_MASTER);
-    chan_cfg.dma_desc_num  = DMA_BUF_COUNT;
-    chan_cfg.dma_frame_num = DMA_BUF_LEN;
+    chan_cfg.dma_desc_num  = _dmaGeom.descCount;
+    chan_cfg.dma_frame_num = _dmaGeom.descFrames;
     chan_cfg.auto_clear    = autoClr;
 
     i2s_chan_handle_t* pTx = needTx ? &_port[port].tx : nullptr;
@@ -433,6 +502,13 @@ static bool _i2s_port_alloc(uint8_t port, bool needTx, bool needRx, bool autoClr
         return false;
     }
     _port[port].autoCleared = autoClr;
+    // Port 0 RX readiness comes from the scheduler callback (i2s_configure_adc1)
+    if (pRx && port != 0) {
+        i2s_event_callbacks_t rxCbs = {};
+        rxCbs.on_recv = _i2s_port_on_recv;
+        i2s_channel_register_event_callback(*pRx, &rxCbs, (void *)(uintptr_t)port);
+        _rx_ready_reset(port);
+    }
     return true;
 }
 
@@ -741,6 +817,7 @@ static bool _i2s_port_init_rx_tdm(uint8_t port, uint32_t rate,
 
 // DEPRECATED: use i2s_audio_configure_adc(0, cfg) for new code.
 static void i2s_configure_adc1(uint32_t sample_rate, const HalDeviceConfig* cfg = nullptr) {
+    _schedArmed = false;
     // Teardown any existing handles (recovery path or full-duplex toggle)
     if (_rx_handle_adc1) {
         i2s_channel_disable(_rx_handle_adc1);
@@ -757,8 +834,8 @@ static void i2s_configure_adc1(uint32_t sample_rate, const HalDeviceConfig* cfg
     // auto_clear fills TX DMA with zeros (silence) until dac_output_write() starts.
     // This keeps MCLK continuous — PCM1808 PLL never loses lock between DAC enable/disable.
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
-    chan_cfg.dma_desc_num = DMA_BUF_COUNT;
-    chan_cfg.dma_frame_num = DMA_BUF_LEN;
+    chan_cfg.dma_desc_num = _dmaGeom.descCount;
+    chan_cfg.dma_frame_num = _dmaGeom.descFrames;
     chan_cfg.auto_clear = true; // TX: auto-fill zeros on underrun
 
     esp_err_t err = i2s_new_channel(&chan_cfg, &_tx_handle_adc1, &_rx_handle_adc1);
@@ -874,6 +951,19 @@ static void i2s_configure_adc1(uint32_t sample_rate, const HalDeviceConfig* cfg
     // Enable TX then RX — no delay between enables required.
     // PCM1808 PLL stabilisation (2048 LRCK cycles = ~43 ms) completes during the
     // caller's post-init delay before audio_pipeline_task starts reading.
+    // Clock the pipeline from RX DMA completions (callbacks must precede enable)
+    audio_sched_init(_sched, audio_pipeline_get_io_frames(), _dmaGeom, sample_rate);
+    _txSentBytes = 0;
+    _txWrittenBytes = 0;
+    _txFrameBytes = (adcBd == 16) ? 4 : (adcBd == 24) ? 6 : 8;
+    i2s_event_callbacks_t rxCbs = {};
+    rxCbs.on_recv = _i2s_rx_on_recv;
+    i2s_event_callbacks_t txCbs = {};
+    txCbs.on_sent = _i2s_tx_on_sent;
+    _schedArmed = i2s_channel_register_event_callback(_rx_handle_adc1, &rxCbs, NULL) == ESP_OK &&
+                  i2s_channel_register_event_callback(_tx_handle_adc1, &txCbs, NULL) == ESP_OK;
+    _rx_ready_reset(0);
+
     i2s_channel_enable(_tx_handle_adc1);
     i2s_channel_enable(_rx_handle_adc1);
     LOG_I("[Audio] ADC1 TX+RX enabled — MCLK=GPIO%d @%lu Hz, fmt=%u bits=%u mclkMult=%u, drive=CAP_3",
@@ -901,8 +991,8 @@ static bool i2s_configure_adc2(uint32_t sample_rate, const HalDeviceConfig* cfg
     }
 
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(port, I2S_ROLE_MASTER);
-    chan_cfg.dma_desc_num = DMA_BUF_COUNT;
-    chan_cfg.dma_frame_num = DMA_BUF_LEN;
+    chan_cfg.dma_desc_num = _dmaGeom.descCount;
+    chan_cfg.dma_frame_num = _dmaGeom.descFrames;
 
     esp_err_t err = i2s_new_channel(&chan_cfg, NULL, &_rx_handle_adc2);
     if (err != ESP_OK) {
@@ -956,6 +1046,11 @@ static bool i2s_configure_adc2(uint32_t sample_rate, const HalDeviceConfig* cfg
         return false;
     }
 
+    i2s_event_callbacks_t rxCbs = {};
+    rxCbs.on_recv = _i2s_port_on_recv;
+    i2s_channel_register_event_callback(_rx_handle_adc2, &rxCbs, (void *)(uintptr_t)1);
+    _rx_ready_reset(1);
+
     err = i2s_channel_enable(_rx_handle_adc2);
     if (err != ESP_OK) {
         LOG_E("[Audio] ADC2 RX enable failed: %d", err);
@@ -1030,8 +1125,8 @@ static void i2s_log_params(uint32_t sample_rate) {
     LOG_I("[Audio]   Data width  : 24-bit (in 32-bit frame, left-justified)");
     LOG_I("[Audio]   Format      : I2S Philips (MSB-first)");
     LOG_I("[Audio]   DMA         : %d bufs x %d frames (%lu ms runway)",
-          DMA_BUF_COUNT, DMA_BUF_LEN,
-          (unsigned long)((uint64_t)DMA_BUF_COUNT * DMA_BUF_LEN * 1000 / sample_rate));
+          _dmaGeom.descCount, _dmaGeom.descFrames,
+          (unsigned long)((uint64_t)_dmaGeom.descCount * _dmaGeom.descFrames * 1000 / sample_rate));
     LOG_I("[Audio]   Clock src   : DEFAULT (PLL_F160M on S3, APLL on P4)");
     const int gpioMclk = (_cachedAdcCfgValid[0] && _cachedAdcCfg[0].pinMclk > 0) ? (int)_cachedAdcCfg[0].pinMclk : I2S_MCLK_PIN;
     const int gpioBck  = (_cachedAdcCfgValid[0] && _cachedAdcCfg[0].pinBck  > 0) ? (int)_cachedAdcCfg[0].pinBck  : I2S_BCK_PIN;
@@ -1064,6 +1159,22 @@ uint32_t i2s_audio_port1_read(int32_t* dst, uint32_t frames) {
     return (uint32_t)(bytes_read / (2 * sizeof(int32_t)));
 }
 
+uint32_t i2s_audio_port0_available(void) {
+    return _rx_handle_adc1 ? _rx_ready_frames(0) : 0;
+}
+
+uint32_t i2s_audio_port1_available(void) {
+    return (_rx_handle_adc2 && _adc2InitOk) ? _rx_ready_frames(1) : 0;
+}
+
+uint32_t i2s_audio_port2_available(void) {
+#if CONFIG_IDF_TARGET_ESP32P4
+    return (_port[2].rx && _expansionRxOk) ? _rx_ready_frames(2) : 0;
+#else
+    return 0;
+#endif
+}
+
 bool i2s_audio_port0_active(void) {
     return true;  // ADC1 always available when initialized
 }
@@ -1078,6 +1189,7 @@ uint32_t i2s_audio_port2_read(int32_t* dst, uint32_t frames) {
     size_t bytes_read = 0;
     size_t size = frames * 2 * sizeof(int32_t);
     esp_err_t err = i2s_channel_read(_port[2].rx, dst, size, &bytes_read, 5);
+    _rx_ready_consume(2, bytes_read);
     if (err != ESP_OK || bytes_read == 0) return 0;
     return (uint32_t)(bytes_read / (2 * sizeof(int32_t)));
 #else
@@ -1137,18 +1249,20 @@ void i2s_audio_init() {
         _currentSampleRate = DEFAULT_AUDIO_SAMPLE_RATE;
     }
 
-    // Reset diagnostics
+    // Reset diagnostics (runs before the audio task starts — sole writer here)
+    seqlock_write_begin(_diagLock);
     _diagnostics = AudioDiagnostics{};
+    seqlock_write_end(_diagLock);
 
     // Initialize analysis to floor — without this, zero-initialized dBFS=0.0f
     // looks like a 0dBFS signal to smart sensing, keeping the amplifier relay ON
     // and amplifying EMI/DAC noise floor while Stage 5 metering isn't active yet.
-    portENTER_CRITICAL(&spinlock);
+    seqlock_write_begin(_analysisLock);
     _analysis.dBFS = DBFS_FLOOR;
     for (int a = 0; a < AUDIO_PIPELINE_MAX_INPUTS; a++) {
         _analysis.adc[a].dBFS = DBFS_FLOOR;
     }
-    portEXIT_CRITICAL(&spinlock);
+    seqlock_write_end(_analysisLock);
 
     // Allocate FFT/waveform buffers from PSRAM with SRAM fallback (one-time, ~22.5KB)
     if (!_fftData) {
@@ -1194,10 +1308,39 @@ void i2s_audio_init() {
     audio_pipeline_init();
 }
 
+#ifdef DSP_ENABLED
+// Publish the DSP configs at the processing rate if they were loaded at
+// another one: at start, before the audio task processes its first block,
+// and after a refused rate switch left one at the rate it did not reach.
+static void _i2s_sync_dsp_rate(uint32_t rate) {
+    DspState *in = dsp_get_active_config();
+    if (in && in->sampleRate != rate) {
+        if (!dsp_prepare_sample_rate(rate) || !dsp_swap_config()) dsp_log_swap_failure("Audio");
+    }
+    OutputDspState *out = output_dsp_get_active_config();
+    if (out && out->sampleRate != rate) {
+        output_dsp_prepare_sample_rate(rate);
+        if (!output_dsp_swap_config()) LOG_W("[Audio] Output DSP swap failed, coefficients stay at the old rate");
+    }
+}
+#endif
+
 // Called from audio_pipeline_task on Core 1 — creates I2S channels so that the
 // DMA ISR is pinned to Core 1, isolated from WiFi interrupts on Core 0.
 // Phase 3: Query HAL devices dynamically instead of hardcoding 2 lanes.
 void i2s_audio_init_channels() {
+    // Block size and processing rate chosen at start; the pipeline is not running yet
+    if (!audio_pipeline_set_block_frames(AppState::getInstance().audio.blockFrames)) {
+        AppState::getInstance().audio.blockFrames = (uint16_t)audio_pipeline_get_block_frames();
+    }
+    uint32_t procRate = audio_pipeline_set_rates(_currentSampleRate, AppState::getInstance().audio.processingRate);
+#ifdef DSP_ENABLED
+    _i2s_sync_dsp_rate(procRate);
+#else
+    (void)procRate;
+#endif
+    _dmaGeom = audio_latency_dma(AppState::getInstance().audio.latencyProfile,
+                                 audio_pipeline_get_io_frames());
 #if !defined(NATIVE_TEST) && defined(DAC_ENABLED)
     HalDeviceManager& mgr = HalDeviceManager::instance();
     bool portOk[AUDIO_PIPELINE_MAX_INPUTS] = {};
@@ -1255,20 +1398,58 @@ int i2s_audio_get_num_adcs() {
 
 AudioAnalysis i2s_audio_get_analysis() {
     AudioAnalysis result;
-    portENTER_CRITICAL(&spinlock);
-    result = *(const AudioAnalysis *)&_analysis;
-    portEXIT_CRITICAL(&spinlock);
+    uint32_t s;
+    do {
+        s = seqlock_read_begin(_analysisLock);
+        result = _analysis;
+    } while (seqlock_read_retry(_analysisLock, s));
     return result;
 }
 
 AudioDiagnostics i2s_audio_get_diagnostics() {
     AudioDiagnostics result;
-    portENTER_CRITICAL(&spinlock);
-    result = _diagnostics;
-    portEXIT_CRITICAL(&spinlock);
+    uint32_t s;
+    do {
+        s = seqlock_read_begin(_diagLock);
+        result = _diagnostics;
+    } while (seqlock_read_retry(_diagLock, s));
+    return result;
+}
+
+AdcAnalysis i2s_audio_get_lane_analysis(int lane) {
+    AdcAnalysis result = {};
+    if (lane < 0 || lane >= AUDIO_PIPELINE_MAX_INPUTS) return result;
+    uint32_t s;
+    do {
+        s = seqlock_read_begin(_analysisLock);
+        result = _analysis.adc[lane];
+    } while (seqlock_read_retry(_analysisLock, s));
     return result;
 }
 
+float i2s_audio_get_lane_dbfs(float *laneDbfs, int count) {
+    if (count > AUDIO_PIPELINE_MAX_INPUTS) count = AUDIO_PIPELINE_MAX_INPUTS;
+    float overall;
+    uint32_t s;
+    do {
+        s = seqlock_read_begin(_analysisLock);
+        overall = _analysis.dBFS;
+        for (int a = 0; laneDbfs && a < count; a++) laneDbfs[a] = _analysis.adc[a].dBFS;
+    } while (seqlock_read_retry(_analysisLock, s));
+    return overall;
+}
+
+AudioHealthStatus i2s_audio_get_lane_health(int lane) {
+    if (lane < 0 || lane >= AUDIO_PIPELINE_MAX_INPUTS) return AUDIO_NO_DATA;
+    AudioHealthStatus st;
+    uint32_t s;
+    do {
+        s = seqlock_read_begin(_diagLock);
+        st = _diagnostics.adc[lane].status;
+    } while (seqlock_read_retry(_diagLock, s));
+    return st;
+}
+
 void i2s_audio_request_dump() {
     _dumpReady = true;
 }
@@ -1281,16 +1462,19 @@ void audio_periodic_dump() {
     // zb high + az=0 + tot=0 → DMA timeout, slave not clocking
     // zb low  + az high      → Slave clocking OK, no audio
     // errs > 0               → I2S driver error (bus fault, DMA overflow)
+    // Consistent copies: the audio task keeps writing while this formats
+    const AudioAnalysis analysis = i2s_audio_get_analysis();
+    const AudioDiagnostics diag = i2s_audio_get_diagnostics();
     LOG_I("[Audio] --- adcs=%d ---", _numAdcsDetected);
     for (int i = 0; i < _numAdcsDetected; i++) {
         LOG_I("[Audio] ADC[%d]=%.1fdB flr=%.1f st=%d errs=%lu zb=%lu az=%lu cz=%lu tot=%lu",
-              i, _analysis.adc[i].dBFS, _diagnostics.adc[i].noiseFloorDbfs,
-              _diagnostics.adc[i].status,
-              _diagnostics.adc[i].i2sReadErrors,
-              _diagnostics.adc[i].zeroByteReads,
-              _diagnostics.adc[i].allZeroBuffers,
-              _diagnostics.adc[i].consecutiveZeros,
-              _diagnostics.adc[i].totalBuffersRead);
+              i, analysis.adc[i].dBFS, diag.adc[i].noiseFloorDbfs,
+              diag.adc[i].status,
+              diag.adc[i].i2sReadErrors,
+              diag.adc[i].zeroByteReads,
+              diag.adc[i].allZeroBuffers,
+              diag.adc[i].consecutiveZeros,
+              diag.adc[i].totalBuffersRead);
     }
 #ifdef DAC_ENABLED
     dac_periodic_log();
@@ -1322,8 +1506,8 @@ I2sStaticConfig i2s_audio_get_static_config() {
     cfg.adc[0].sampleRate = _currentSampleRate;
     cfg.adc[0].bitsPerSample = 32;
     cfg.adc[0].channelFormat = "Stereo R/L";
-    cfg.adc[0].dmaBufCount = DMA_BUF_COUNT;
-    cfg.adc[0].dmaBufLen = DMA_BUF_LEN;
+    cfg.adc[0].dmaBufCount = _dmaGeom.descCount;
+    cfg.adc[0].dmaBufLen = _dmaGeom.descFrames;
     cfg.adc[0].pllEnabled = true;
     cfg.adc[0].mclkHz = _currentSampleRate * 256;
     cfg.adc[0].commFormat = "Standard I2S";
@@ -1332,39 +1516,23 @@ I2sStaticConfig i2s_audio_get_static_config() {
     cfg.adc[1].sampleRate = _currentSampleRate;
     cfg.adc[1].bitsPerSample = 32;
     cfg.adc[1].channelFormat = "Stereo R/L";
-    cfg.adc[1].dmaBufCount = DMA_BUF_COUNT;
-    cfg.adc[1].dmaBufLen = DMA_BUF_LEN;
+    cfg.adc[1].dmaBufCount = _dmaGeom.descCount;
+    cfg.adc[1].dmaBufLen = _dmaGeom.descFrames;
     cfg.adc[1].pllEnabled = true;
     cfg.adc[1].mclkHz = _currentSampleRate * 256;
     cfg.adc[1].commFormat = "Standard I2S";
     return cfg;
 }
 
-bool i2s_audio_set_sample_rate(uint32_t rate) {
-    if (!audio_validate_sample_rate(rate)) return false;
-    if (rate == _currentSampleRate) return true;
-
-    LOG_I("[Audio] Changing sample rate: %lu -> %lu Hz", _currentSampleRate, rate);
-
-    // Pause audio task during channel teardown/recreate.
-    // If caller already paused (e.g., hal_settings.cpp), skip to avoid double semaphore take.
-    bool wasPaused = AppState::getInstance().audio.paused;
-    if (!wasPaused) {
-        audio_pipeline_request_pause(100);
-    }
-
+// Tear down and recreate every ADC channel (and the I2S2 expansion users)
+// with the current sample rate and DMA geometry. Caller pauses the audio task.
+static void i2s_audio_recreate_channels() {
+    _schedArmed = false;
     // Teardown all channels (configure functions handle this, but be explicit)
     if (_rx_handle_adc1) { i2s_channel_disable(_rx_handle_adc1); i2s_del_channel(_rx_handle_adc1); _rx_handle_adc1 = NULL; }
     if (_tx_handle_adc1) { i2s_channel_disable(_tx_handle_adc1); i2s_del_channel(_tx_handle_adc1); _tx_handle_adc1 = NULL; }
     if (_rx_handle_adc2) { i2s_channel_disable(_rx_handle_adc2); i2s_del_channel(_rx_handle_adc2); _rx_handle_adc2 = NULL; }
 
-    _currentSampleRate = rate;
-    _wfTargetFrames = rate * AppState::getInstance().audio.updateRate / 1000;
-    for (int a = 0; a < AUDIO_PIPELINE_MAX_INPUTS; a++) {
-        _wfFramesSeen[a] = 0;
-        if (_wfAccum[a]) memset(_wfAccum[a], 0, WAVEFORM_BUFFER_SIZE * sizeof(float));
-    }
-
     if (_adc2InitOk) _adc2InitOk = i2s_audio_configure_adc(1,
         _cachedAdcCfgValid[1] ? &_cachedAdcCfg[1] : nullptr);
     i2s_audio_configure_adc(0,
@@ -1401,27 +1569,336 @@ bool i2s_audio_set_sample_rate(uint32_t rate) {
                            (gpio_num_t)ES8311_I2S_LRCK_PIN);
     }
 #endif // CONFIG_IDF_TARGET_ESP32P4
+}
+
+static i2s_mclk_multiple_t _i2s_mclk_multiple(uint16_t mult) {
+    switch (mult) {
+        case 128:  return I2S_MCLK_MULTIPLE_128;
+        case 192:  return I2S_MCLK_MULTIPLE_192;
+        case 384:  return I2S_MCLK_MULTIPLE_384;
+        case 512:  return I2S_MCLK_MULTIPLE_512;
+        case 768:  return I2S_MCLK_MULTIPLE_768;
+        case 1024: return I2S_MCLK_MULTIPLE_1024;
+        case 1152: return I2S_MCLK_MULTIPLE_1152;
+        default:   return I2S_MCLK_MULTIPLE_256;
+    }
+}
+
+// Reprogram the clock of a disabled channel for rate. Slot and GPIO
+// configuration and the DMA descriptors are kept.
+static bool _i2s_reclock(i2s_chan_handle_t h, uint8_t mode, uint32_t rate, uint16_t mclkMult) {
+    if (!h) return true;
+    esp_err_t err;
+    if (mode == I2S_MODE_TDM) {
+        i2s_tdm_clk_config_t clk = I2S_TDM_CLK_DEFAULT_CONFIG(rate);
+        clk.mclk_multiple = _i2s_mclk_multiple(mclkMult);
+        err = i2s_channel_reconfig_tdm_clock(h, &clk);
+    } else {
+        i2s_std_clk_config_t clk = I2S_STD_CLK_DEFAULT_CONFIG(rate);
+        clk.mclk_multiple = _i2s_mclk_multiple(mclkMult);
+        err = i2s_channel_reconfig_std_clock(h, &clk);
+    }
+    if (err != ESP_OK) LOG_W("[Audio] Clock reconfig to %lu Hz failed: %d", (unsigned long)rate, err);
+    return err == ESP_OK;
+}
+
+// Move every live channel to rate without deleting it: disable (consumers
+// first), reprogram the clocks, re-enable in creation order (I2S0 TX → RX,
+// ADC2, I2S2 TX → RX). Caller pauses the audio task. Returns false if a
+// channel refused the new clock — the caller then recreates the channels.
+static bool i2s_audio_reclock_channels(uint32_t rate) {
+    const bool armed = _schedArmed;
+    _schedArmed = false;
+
+    if (_rx_handle_adc2) i2s_channel_disable(_rx_handle_adc2);
+#if CONFIG_IDF_TARGET_ESP32P4
+    if (_port[2].rx) i2s_channel_disable(_port[2].rx);
+    if (_port[2].tx) i2s_channel_disable(_port[2].tx);
+#endif
+    if (_rx_handle_adc1) i2s_channel_disable(_rx_handle_adc1);
+    if (_tx_handle_adc1) i2s_channel_disable(_tx_handle_adc1);
+
+    // I2S0 keeps the MCLK multiple it was created with; ADC2 runs the default
+    const HalDeviceConfig *c0 = _cachedAdcCfgValid[0] ? &_cachedAdcCfg[0] : nullptr;
+    uint16_t mm0 = (c0 && c0->valid && c0->mclkMultiple > 0) ? c0->mclkMultiple : 256;
+    bool ok = _i2s_reclock(_tx_handle_adc1, I2S_MODE_STD, rate, mm0) &&
+              _i2s_reclock(_rx_handle_adc1, I2S_MODE_STD, rate, mm0) &&
+              _i2s_reclock(_rx_handle_adc2, I2S_MODE_STD, rate, 256);
+#if CONFIG_IDF_TARGET_ESP32P4
+    ok = ok && _i2s_reclock(_port[2].tx, _port[2].txMode, rate, _port[2].mclkMultiple) &&
+               _i2s_reclock(_port[2].rx, _port[2].rxMode, rate, _port[2].mclkMultiple);
+#endif
+    if (!ok) return false;
+
+    // Scheduling and readiness restart as for new channels
+    if (_rx_handle_adc1) audio_sched_init(_sched, audio_pipeline_get_io_frames(), _dmaGeom, rate);
+    _txSentBytes = 0;
+    _txWrittenBytes = 0;
+    for (uint8_t p = 0; p < I2S_PORT_COUNT; p++) _rx_ready_reset(p);
+
+    if (_tx_handle_adc1) i2s_channel_enable(_tx_handle_adc1);
+    if (_rx_handle_adc1) i2s_channel_enable(_rx_handle_adc1);
+    if (_rx_handle_adc2) i2s_channel_enable(_rx_handle_adc2);
+#if CONFIG_IDF_TARGET_ESP32P4
+    if (_port[2].tx) i2s_channel_enable(_port[2].tx);
+    if (_port[2].rx) i2s_channel_enable(_port[2].rx);
+    if (_port[2].users) _port[2].sampleRate = rate;
+#endif
+    _schedArmed = armed;
+    return true;
+}
+
+// ===== Sample-rate switching (audio_rate_switch.h) =====
+
+static AudioRateSwitchStats _rateSwitch = {};
+#ifdef DSP_ENABLED
+static bool _rsDspStaged = false;  // Inactive DSP config holds the new-rate coefficients
+#endif
+
+// The DSP runs at the processing rate the new I/O rate resolves to
+static void _rs_prepare(uint32_t rate) {
+#ifdef DSP_ENABLED
+    uint32_t procRate = audio_proc_rate_resolve(rate, AppState::getInstance().audio.processingRate);
+    _rsDspStaged = dsp_prepare_sample_rate(procRate);
+    output_dsp_prepare_sample_rate(procRate);
+#else
+    (void)rate;
+#endif
+}
+
+// False unless both configs went live at the new rate
+static bool _rs_commit() {
+#ifdef DSP_ENABLED
+    bool ok = _rsDspStaged && dsp_swap_config();
+    if (!ok) dsp_log_swap_failure("Audio");
+    if (!output_dsp_swap_config()) {
+        LOG_W("[Audio] Output DSP swap failed, coefficients stay at the old rate");
+        ok = false;
+    }
+    return ok;
+#else
+    return true;
+#endif
+}
+
+static void _rs_pause() { audio_pipeline_request_pause(100); }
+
+// Pipeline rates first: the I/O block (processing at twice the I/O rate
+// halves it) sets the DMA descriptor length, and descriptors of another
+// length cannot be reprogrammed in place — the channels are rebuilt then.
+// A processing-rate change at an unchanged I/O rate needs no new clock.
+static bool _rs_reclock(uint32_t rate) {
+    audio_pipeline_set_rates(rate, AppState::getInstance().audio.processingRate);
+    AudioDmaGeometry g = audio_latency_dma(AppState::getInstance().audio.latencyProfile,
+                                           audio_pipeline_get_io_frames());
+    if (g.descCount != _dmaGeom.descCount || g.descFrames != _dmaGeom.descFrames) {
+        _dmaGeom = g;
+        return false;
+    }
+    return rate == _currentSampleRate || i2s_audio_reclock_channels(rate);
+}
+
+static void _rs_rebuild(uint32_t rate) {
+    _currentSampleRate = rate;
+    i2s_audio_recreate_channels();
+}
+
+static void _rs_retarget(uint32_t rate) {
+    _currentSampleRate = rate;
+    _wfTargetFrames = rate * AppState::getInstance().audio.updateRate / 1000;
+    for (int a = 0; a < AUDIO_PIPELINE_MAX_INPUTS; a++) {
+        _wfFramesSeen[a] = 0;
+        if (_wfAccum[a]) memset(_wfAccum[a], 0, WAVEFORM_BUFFER_SIZE * sizeof(float));
+    }
+}
+
+// A refused switch leaves the pipeline at its old rate; republish any DSP
+// config that went live at the new one before the retry failed
+static void _rs_restore_dsp_rate() {
+#ifdef DSP_ENABLED
+    _i2s_sync_dsp_rate(audio_pipeline_get_processing_rate());
+#endif
+}
+
+static uint32_t _rs_now() { return (uint32_t)esp_timer_get_time(); }
+static void _rs_wait() { vTaskDelay(1); }
+
+static const AudioRateSwitchOps _rateSwitchOps = {
+    _rs_prepare,
+    audio_pipeline_set_output_fade,
+    audio_pipeline_output_faded,
+    _rs_commit,
+    _rs_pause,
+    audio_pipeline_resume,
+    _rs_reclock,
+    _rs_rebuild,
+    _rs_retarget,
+    _rs_now,
+    _rs_wait,
+};
+
+bool i2s_audio_set_sample_rate(uint32_t rate) {
+    if (!audio_validate_sample_rate(rate)) return false;
+    if (rate == _currentSampleRate) return true;
+
+    LOG_I("[Audio] Changing sample rate: %lu -> %lu Hz", _currentSampleRate, rate);
+
+    // If caller already paused (e.g., hal_settings.cpp), nothing is playing:
+    // no fade, and the caller resumes.
+    bool wasPaused = AppState::getInstance().audio.paused;
+    AudioRateSwitchResult res = audio_rate_switch_run(_rateSwitch, _rateSwitchOps, _currentSampleRate, rate, !wasPaused);
+    if (res == AUDIO_RATE_SWITCH_REFUSED) {
+        LOG_E("[Audio] Sample rate switch to %lu Hz refused: DSP configs could not be published", rate);
+        _rs_restore_dsp_rate();
+        return false;
+    }
+
+    LOG_I("[Audio] Sample rate changed to %lu Hz in %lu us (%s, paused %lu us)", rate,
+          (unsigned long)_rateSwitch.totalUs,
+          res == AUDIO_RATE_SWITCH_IN_PLACE ? "clocks reprogrammed" : "channels recreated",
+          (unsigned long)_rateSwitch.gapUs);
+    return true;
+}
+
+AudioRateSwitchStats i2s_audio_get_rate_switch_stats() {
+    AudioRateSwitchStats st = _rateSwitch;
+    return st;
+}
+
+// Same sequence as a sample-rate switch at the current I/O rate: DSP staged
+// at the new processing rate, output faded, pipeline rates and block plan
+// swapped while paused (channels rebuilt only if the I/O block changes).
+bool i2s_audio_set_processing_rate(uint32_t rate) {
+    if (!audio_proc_rate_valid(rate)) return false;
+    uint32_t prevRate = AppState::getInstance().audio.processingRate;
+    AppState::getInstance().audio.processingRate = rate;
+    uint32_t procRate = audio_proc_rate_resolve(_currentSampleRate, rate);
+    if (procRate == audio_pipeline_get_processing_rate()) return true;
+
+    bool wasPaused = AppState::getInstance().audio.paused;
+    if (audio_rate_switch_run(_rateSwitch, _rateSwitchOps, _currentSampleRate, _currentSampleRate, !wasPaused)
+            == AUDIO_RATE_SWITCH_REFUSED) {
+        LOG_E("[Audio] Processing rate %lu Hz refused: DSP configs could not be published", (unsigned long)rate);
+        AppState::getInstance().audio.processingRate = prevRate;
+        _rs_restore_dsp_rate();
+        return false;
+    }
+    LOG_I("[Audio] Processing rate %lu Hz (I/O %lu Hz): %d -> %d frames per block, %lu us",
+          (unsigned long)audio_pipeline_get_processing_rate(), (unsigned long)_currentSampleRate,
+          audio_pipeline_get_io_frames(), audio_pipeline_get_proc_frames(),
+          (unsigned long)_rateSwitch.totalUs);
+    return true;
+}
+
+uint32_t i2s_audio_get_processing_rate() {
+    uint32_t rate = audio_pipeline_get_processing_rate();
+    return rate ? rate : _currentSampleRate;
+}
+
+bool i2s_audio_set_latency_profile(uint8_t profile) {
+    if (profile >= AUDIO_LATENCY_PROFILE_COUNT) return false;
+    AppState::getInstance().audio.latencyProfile = profile;
+    AudioDmaGeometry g = audio_latency_dma(profile, audio_pipeline_get_io_frames());
+    if (g.descCount == _dmaGeom.descCount && g.descFrames == _dmaGeom.descFrames) return true;
+
+    bool wasPaused = AppState::getInstance().audio.paused;
+    if (!wasPaused) {
+        audio_pipeline_request_pause(100);
+    }
+    _dmaGeom = g;
+    i2s_audio_recreate_channels();
+    if (!wasPaused) {
+        audio_pipeline_resume();
+    }
+    LOG_I("[Audio] Latency profile %s: %u x %u frames DMA", audio_latency_profile_name(profile),
+          g.descCount, g.descFrames);
+    return true;
+}
 
+uint8_t i2s_audio_get_latency_profile() {
+    return AppState::getInstance().audio.latencyProfile;
+}
+
+bool i2s_audio_set_block_frames(uint16_t frames) {
+    if (!audio_block_frames_valid(frames)) return false;
+    AppState::getInstance().audio.blockFrames = frames;
+    if (frames == audio_pipeline_get_block_frames()) return true;
+
+    bool wasPaused = AppState::getInstance().audio.paused;
+    if (!wasPaused) {
+        audio_pipeline_request_pause(100);
+    }
+    audio_pipeline_set_block_frames(frames);
+    // Descriptors follow the I/O block so the RX DMA completes one block at a time
+    _dmaGeom = audio_latency_dma(AppState::getInstance().audio.latencyProfile,
+                                 audio_pipeline_get_io_frames());
+    i2s_audio_recreate_channels();
     if (!wasPaused) {
         audio_pipeline_resume();
     }
-    LOG_I("[Audio] Sample rate changed to %lu Hz", rate);
+    LOG_I("[Audio] Block size %u frames: %u x %u frames DMA", frames,
+          _dmaGeom.descCount, _dmaGeom.descFrames);
     return true;
 }
 
+AudioScheduler *i2s_audio_scheduler() {
+    return (_schedArmed && _rx_handle_adc1) ? &_sched : nullptr;
+}
+
+void i2s_audio_set_block_notify(void *taskHandle) {
+    _schedTask = (TaskHandle_t)taskHandle;
+}
+
+void i2s_audio_discard_blocks(uint32_t blocks) {
+    int32_t scratch[128];   // 64 stereo frames per read — keeps the task stack small
+    const size_t blockBytes = (size_t)_sched.blockFrames * 2 * sizeof(int32_t);
+    i2s_chan_handle_t rx[2] = { _rx_handle_adc1, _adc2InitOk ? _rx_handle_adc2 : NULL };
+    for (int p = 0; p < 2; p++) {
+        if (!rx[p]) continue;
+        for (size_t left = blocks * blockBytes; left > 0; ) {
+            size_t br = 0;
+            size_t want = left < sizeof(scratch) ? left : sizeof(scratch);
+            esp_err_t err = i2s_channel_read(rx[p], scratch, want, &br, 0);
+            _rx_ready_consume((uint8_t)p, br);
+            if (err != ESP_OK || br == 0) break;
+            left -= br;
+        }
+    }
+}
+
+uint32_t i2s_audio_tx_queued_frames() {
+    int32_t queued = (int32_t)(_txWrittenBytes - _txSentBytes);
+    if (queued < 0) {
+        // Underrun: the DMA sent auto-cleared silence — rebase on what was played
+        _txWrittenBytes = _txSentBytes;
+        return 0;
+    }
+    return (uint32_t)queued / _txFrameBytes;
+}
+
 // ===== ADC Read API (used by audio_pipeline) =====
 
 bool i2s_audio_read_adc1(void *buf, size_t size, size_t *bytes_read, uint32_t timeout_ms) {
     if (!_rx_handle_adc1) { if (bytes_read) *bytes_read = 0; return false; }
     esp_err_t err = i2s_channel_read(_rx_handle_adc1, buf, size, bytes_read, timeout_ms);
-    if (err != ESP_OK) { _diagnostics.adc[0].i2sReadErrors++; }
+    if (bytes_read) _rx_ready_consume(0, *bytes_read);
+    if (err != ESP_OK) {
+        seqlock_write_begin(_diagLock);
+        _diagnostics.adc[0].i2sReadErrors++;
+        seqlock_write_end(_diagLock);
+    }
     return (err == ESP_OK && bytes_read && *bytes_read > 0);
 }
 
 bool i2s_audio_read_adc2(void *buf, size_t size, size_t *bytes_read, uint32_t timeout_ms) {
     if (!_rx_handle_adc2 || !_adc2InitOk) { if (bytes_read) *bytes_read = 0; return false; }
     esp_err_t err = i2s_channel_read(_rx_handle_adc2, buf, size, bytes_read, timeout_ms);
-    if (err != ESP_OK) { _diagnostics.adc[1].i2sReadErrors++; }
+    if (bytes_read) _rx_ready_consume(1, *bytes_read);
+    if (err != ESP_OK) {
+        seqlock_write_begin(_diagLock);
+        _diagnostics.adc[1].i2sReadErrors++;
+        seqlock_write_end(_diagLock);
+    }
     return (err == ESP_OK && bytes_read && *bytes_read > 0);
 }
 
@@ -1434,26 +1911,51 @@ bool i2s_audio_adc2_ok() {
 // relay or any other sensing state.  This is the only coupling point between
 // the audio pipeline and the sensing layer.
 void i2s_audio_update_analysis_dbfs(float dbfs_adc1) {
-    portENTER_CRITICAL(&spinlock);
+    seqlock_write_begin(_analysisLock);
     _analysis.dBFS          = dbfs_adc1;
     _analysis.adc[0].dBFS   = dbfs_adc1;
+    seqlock_write_end(_analysisLock);
     _analysisReady          = true;
-    portEXIT_CRITICAL(&spinlock);
 }
 
 // Full metering update — RMS/VU/peak/dBFS for ADC1, computed by audio_pipeline.
-// Cast away volatile for bulk struct copy (safe: spinlock held, no concurrent write).
 void i2s_audio_update_analysis_metering(const AdcAnalysis &adc0) {
-    portENTER_CRITICAL(&spinlock);
-    *(AdcAnalysis *)&_analysis.adc[0] = adc0;
+    seqlock_write_begin(_analysisLock);
+    _analysis.adc[0] = adc0;
     _analysis.dBFS  = adc0.dBFS;
+    seqlock_write_end(_analysisLock);
     _analysisReady  = true;
-    portEXIT_CRITICAL(&spinlock);
+}
+
+void i2s_audio_update_capture_diag(int lane, bool stalled, uint32_t stalls,
+                                   uint32_t underruns, uint32_t overflows) {
+    if (lane < 0 || lane >= AUDIO_PIPELINE_MAX_INPUTS) return;
+    seqlock_write_begin(_diagLock);
+    AdcDiagnostics &d = _diagnostics.adc[lane];
+    d.stalled = stalled;
+    d.captureStalls = stalls;
+    d.captureUnderruns = underruns;
+    d.captureOverflows = overflows;
+    d.status = audio_derive_health_status(d);
+    seqlock_write_end(_diagLock);
+}
+
+void i2s_audio_update_input_diag(int lane, float peak, uint32_t clipped, uint32_t samples) {
+    if (lane < 0 || lane >= AUDIO_PIPELINE_MAX_INPUTS || samples == 0) return;
+    float peakDbfs = (peak > 1e-9f) ? 20.0f * log10f(peak) : -96.0f;
+    float rate = (float)clipped / (float)samples;
+    seqlock_write_begin(_diagLock);
+    AdcDiagnostics &d = _diagnostics.adc[lane];
+    d.peakDbfs = peakDbfs;
+    d.clippedSamples += clipped;
+    d.clipRate += CLIP_RATE_ALPHA * (rate - d.clipRate);
+    d.status = audio_derive_health_status(d);
+    seqlock_write_end(_diagLock);
 }
 
 // Called once per pipeline buffer to accumulate waveform and FFT data for WebSocket display.
 // rawLJ: left-justified int32 stereo interleaved from ADC (same as _rawBuf[adcIndex]).
-// frames: number of stereo frames (== DMA_BUF_LEN).
+// frames: number of stereo frames (one pipeline block, 32..256).
 // adcIndex: 0=ADC1, 1=ADC2.
 void i2s_audio_push_waveform_fft(const int32_t *rawLJ, int frames, int adcIndex) {
     if (adcIndex < 0 || adcIndex >= AUDIO_PIPELINE_MAX_INPUTS) return;
@@ -1482,6 +1984,12 @@ void i2s_audio_push_waveform_fft(const int32_t *rawLJ, int frames, int adcIndex)
         if (_fftRingPos[adcIndex] < FFT_SIZE) continue;
         _fftRingPos[adcIndex] = 0;  // Ring full — run FFT, then restart
 
+#ifdef DSP_ENABLED
+        // Under DSP load only every Nth window is analysed (spectrum refreshes slower)
+        if (++_fftSkip[adcIndex] < dsp_gov_spectrum_divider(dsp_get_governor_level())) continue;
+#endif
+        _fftSkip[adcIndex] = 0;
+
         // Build windowed complex input: [Re0, 0, Re1, 0, ...]
         for (int i = 0; i < FFT_SIZE; i++) {
             _fftData[i * 2]     = _fftRing[adcIndex][i] * _fftWindow[i];
@@ -1792,6 +2300,7 @@ void i2s_port_write(uint8_t port, const void *src, size_t size, size_t *bw, uint
         return;
     }
     i2s_channel_write(_port[port].tx, src, size, bw, timeout);
+    if (port == 0 && bw) _txWrittenBytes += (uint32_t)*bw;
 }
 
 uint32_t i2s_port_read(uint8_t port, int32_t *dst, uint32_t frames) {
@@ -1799,15 +2308,17 @@ uint32_t i2s_port_read(uint8_t port, int32_t *dst, uint32_t frames) {
     size_t bytes = frames * 2 * sizeof(int32_t);
     size_t br = 0;
     i2s_channel_read(_port[port].rx, dst, bytes, &br, pdMS_TO_TICKS(5));
+    _rx_ready_consume(port, br);
     return (uint32_t)(br / (2 * sizeof(int32_t)));
 }
 
-uint32_t i2s_port_tdm_read(uint8_t port, int32_t *dst, uint32_t frames, uint8_t slots) {
-    if (port >= I2S_PORT_COUNT || !_port[port].rx || !dst || slots == 0) return 0;
-    size_t bytes = frames * slots * sizeof(int32_t);
+uint32_t i2s_port_tdm_read(uint8_t port, void *dst, uint32_t frames, uint16_t frameBytes) {
+    if (port >= I2S_PORT_COUNT || !_port[port].rx || !dst || frameBytes == 0) return 0;
+    size_t bytes = (size_t)frames * frameBytes;
     size_t br = 0;
     i2s_channel_read(_port[port].rx, dst, bytes, &br, pdMS_TO_TICKS(5));
-    return (uint32_t)(br / (slots * sizeof(int32_t)));
+    _rx_ready_consume(port, br);
+    return (uint32_t)(br / frameBytes);
 }
 
 bool i2s_port_is_tx_active(uint8_t port) {
@@ -1855,7 +2366,7 @@ bool i2s_port_enable_rx(uint8_t, uint8_t, uint8_t, gpio_num_t, gpio_num_t, gpio_
 void i2s_port_disable_rx(uint8_t) {}
 void i2s_port_write(uint8_t, const void*, size_t, size_t* bw, uint32_t) { if (bw) *bw = 0; }
 uint32_t i2s_port_read(uint8_t, int32_t*, uint32_t) { return 0; }
-uint32_t i2s_port_tdm_read(uint8_t, int32_t*, uint32_t, uint8_t) { return 0; }
+uint32_t i2s_port_tdm_read(uint8_t, void*, uint32_t, uint16_t) { return 0; }
 bool i2s_port_is_tx_active(uint8_t) { return false; }
 bool i2s_port_is_rx_active(uint8_t) { return false; }
 I2sPortInfo i2s_port_get_info(uint8_t port) { I2sPortInfo info = {}; info.port = port; return info; }
@@ -1869,12 +2380,45 @@ void i2s_audio_init() {}
 void i2s_audio_init_channels() {}
 AudioAnalysis i2s_audio_get_analysis() { return AudioAnalysis{}; }
 AudioDiagnostics i2s_audio_get_diagnostics() { return AudioDiagnostics{}; }
+AdcAnalysis i2s_audio_get_lane_analysis(int) { return AdcAnalysis{}; }
+float i2s_audio_get_lane_dbfs(float *laneDbfs, int count) {
+    for (int a = 0; laneDbfs && a < count; a++) laneDbfs[a] = DBFS_FLOOR;
+    return DBFS_FLOOR;
+}
+AudioHealthStatus i2s_audio_get_lane_health(int) { return AUDIO_OK; }
 bool i2s_audio_get_waveform(uint8_t *out, int adcIndex) { return false; }
 bool i2s_audio_get_spectrum(float *bands, float *dominant_freq, int adcIndex) { return false; }
 bool i2s_audio_set_sample_rate(uint32_t rate) {
     return audio_validate_sample_rate(rate);
 }
+AudioRateSwitchStats i2s_audio_get_rate_switch_stats() { return AudioRateSwitchStats{}; }
+bool i2s_audio_set_processing_rate(uint32_t rate) {
+    if (!audio_proc_rate_valid(rate)) return false;
+    AppState::getInstance().audio.processingRate = rate;
+    return true;
+}
+uint32_t i2s_audio_get_processing_rate() {
+    return audio_proc_rate_resolve(AppState::getInstance().audio.sampleRate,
+                                   AppState::getInstance().audio.processingRate);
+}
 int i2s_audio_get_num_adcs() { return _nativeNumAdcs; }
+bool i2s_audio_set_latency_profile(uint8_t profile) {
+    if (profile >= AUDIO_LATENCY_PROFILE_COUNT) return false;
+    AppState::getInstance().audio.latencyProfile = profile;
+    _dmaGeom = audio_latency_dma(profile, AppState::getInstance().audio.blockFrames);
+    return true;
+}
+uint8_t i2s_audio_get_latency_profile() { return AppState::getInstance().audio.latencyProfile; }
+bool i2s_audio_set_block_frames(uint16_t frames) {
+    if (!audio_block_frames_valid(frames)) return false;
+    AppState::getInstance().audio.blockFrames = frames;
+    _dmaGeom = audio_latency_dma(AppState::getInstance().audio.latencyProfile, frames);
+    return true;
+}
+AudioScheduler *i2s_audio_scheduler() { return nullptr; }
+void i2s_audio_set_block_notify(void *) {}
+void i2s_audio_discard_blocks(uint32_t) {}
+uint32_t i2s_audio_tx_queued_frames() { return 0; }
 void audio_periodic_dump() {}
 I2sStaticConfig i2s_audio_get_static_config() {
     I2sStaticConfig cfg = {};
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>  // size_t
+#include "audio_rate_switch.h"
 
 // Must be defined in config.h
 #include "config.h"
@@ -65,6 +66,11 @@ struct AdcDiagnostics {
     unsigned long lastReadMs = 0;
     uint32_t totalBuffersRead = 0;
     uint32_t i2sRecoveries = 0;      // I2S driver restart count (timeout recovery)
+    // Readiness-based capture (audio_capture.h)
+    bool stalled = false;            // Port delivered no frames for AUDIO_CAPTURE_STALL_BLOCKS blocks
+    uint32_t captureStalls = 0;      // Times the port was flagged stalled
+    uint32_t captureUnderruns = 0;   // Blocks zero-padded because the port was short
+    uint32_t captureOverflows = 0;   // Frames dropped because the port ran ahead
 };
 
 struct AudioDiagnostics {
@@ -141,9 +147,47 @@ void i2s_audio_init();
 // Create I2S channels — MUST be called from Core 1 (audio_pipeline_task) so the
 // DMA ISR is pinned to Core 1, isolated from WiFi interrupts on Core 0.
 void i2s_audio_init_channels();
+// Snapshots are consistent (seqlock, never torn) and never mask interrupts.
+// The subset getters copy only what they return.
 AudioAnalysis i2s_audio_get_analysis();
 AudioDiagnostics i2s_audio_get_diagnostics();
+AdcAnalysis i2s_audio_get_lane_analysis(int lane);
+// Fills laneDbfs[0..count-1] (may be NULL) and returns the overall dBFS
+float i2s_audio_get_lane_dbfs(float *laneDbfs, int count);
+AudioHealthStatus i2s_audio_get_lane_health(int lane);
+// Switch every I2S channel to rate (audio_rate_switch.h): output faded,
+// clocks reprogrammed in place, DSP published at the processing rate the new
+// rate resolves to, lanes rerouted. Main-loop context; blocks for the fade
+// (a few ms).
 bool i2s_audio_set_sample_rate(uint32_t rate);
+// Phase of a switch in progress and the timing of the last one
+AudioRateSwitchStats i2s_audio_get_rate_switch_stats();
+// Internal processing rate (audio_rate_convert.h): 48000, 96000 or
+// AUDIO_PROC_RATE_FOLLOW (0, the I2S rate). Stored in AppState and applied
+// with the sample-rate switch sequence; a rate not a factor of two from the
+// I2S rate processes at the I2S rate until the I2S rate allows it. The
+// getter returns the rate in effect.
+bool i2s_audio_set_processing_rate(uint32_t rate);
+uint32_t i2s_audio_get_processing_rate();
+
+// ===== DMA-driven block scheduling (see audio_scheduler.h) =====
+// Latency profile (AudioLatencyProfile) picks the DMA descriptor count/length
+// of every I2S channel. Changing it recreates the channels (audio task paused).
+bool i2s_audio_set_latency_profile(uint8_t profile);
+uint8_t i2s_audio_get_latency_profile();
+// Pipeline block size (32/64/128/256 frames). Pauses the audio task, resizes
+// the pipeline block and recreates the channels with descriptors of one block.
+bool i2s_audio_set_block_frames(uint16_t frames);
+// Scheduler fed by the ADC1 RX on_recv callback, or NULL while no RX channel
+// clocks the pipeline. Audio task only.
+struct AudioScheduler;
+AudioScheduler *i2s_audio_scheduler();
+// Task notified (vTaskNotifyGiveFromISR) whenever a whole block has arrived
+void i2s_audio_set_block_notify(void *taskHandle);
+// Read and drop whole blocks from every ADC RX channel (scheduler recovery)
+void i2s_audio_discard_blocks(uint32_t blocks);
+// Frames written to the I2S0 TX DMA and not yet sent
+uint32_t i2s_audio_tx_queued_frames();
 
 // Waveform: returns true if a new 256-point snapshot is available
 // out must point to WAVEFORM_BUFFER_SIZE bytes
@@ -212,8 +256,16 @@ bool i2s_audio_adc2_ok();
 // Simple dBFS-only update (kept for backward compatibility).
 void i2s_audio_update_analysis_dbfs(float dbfs_adc1);
 // Full metering update — RMS/VU/peak/dBFS computed by audio_pipeline per buffer.
-// Uses same volatile-cast pattern as i2s_audio_get_analysis().
+// Audio task only (single seqlock writer).
 void i2s_audio_update_analysis_metering(const AdcAnalysis &adc0);
+// Capture state of a DMA-backed lane — called once per block from audio_pipeline_task.
+// A stalled port reports AUDIO_NO_DATA instead of blocking the pipeline.
+void i2s_audio_update_capture_diag(int lane, bool stalled, uint32_t stalls,
+                                   uint32_t underruns, uint32_t overflows);
+// Level diagnostics of a hardware ADC lane from input conditioning — sample
+// peak (linear), clipped samples out of `samples`. Feeds peakDbfs,
+// clippedSamples and the clipRate EMA.
+void i2s_audio_update_input_diag(int lane, float peak, uint32_t clipped, uint32_t samples);
 // Waveform + FFT accumulation — called once per DMA buffer from audio_pipeline_task.
 // rawLJ: left-justified int32 stereo interleaved (pre-float-conversion ADC data).
 // frames: DMA_BUF_LEN stereo frames. adcIndex: 0=ADC1, 1=ADC2.
@@ -224,6 +276,8 @@ inline bool i2s_audio_read_adc2(void*, size_t, size_t* br, uint32_t) { if (br) *
 inline bool i2s_audio_adc2_ok() { return false; }
 inline void i2s_audio_update_analysis_dbfs(float) {}
 inline void i2s_audio_update_analysis_metering(const AdcAnalysis &) {}
+inline void i2s_audio_update_capture_diag(int, bool, uint32_t, uint32_t, uint32_t) {}
+inline void i2s_audio_update_input_diag(int, float, uint32_t, uint32_t) {}
 inline void i2s_audio_push_waveform_fft(const int32_t *, int, int) {}
 #endif
 
@@ -235,6 +289,9 @@ inline void i2s_audio_push_waveform_fft(const int32_t *, int, int) {}
 inline uint32_t i2s_audio_port0_read(int32_t* dst, uint32_t frames) { return 0; }
 inline uint32_t i2s_audio_port1_read(int32_t* dst, uint32_t frames) { return 0; }
 inline uint32_t i2s_audio_port2_read(int32_t* dst, uint32_t frames) { return 0; }
+inline uint32_t i2s_audio_port0_available(void) { return 0; }
+inline uint32_t i2s_audio_port1_available(void) { return 0; }
+inline uint32_t i2s_audio_port2_available(void) { return 0; }
 inline bool i2s_audio_port0_active(void) { return false; }
 inline bool i2s_audio_port1_active(void) { return false; }
 inline bool i2s_audio_port2_active(void) { return false; }
@@ -244,6 +301,11 @@ inline uint32_t i2s_audio_get_sample_rate(void) { return 48000; }
 uint32_t i2s_audio_port0_read(int32_t* dst, uint32_t frames);
 uint32_t i2s_audio_port1_read(int32_t* dst, uint32_t frames);
 uint32_t i2s_audio_port2_read(int32_t* dst, uint32_t frames);
+// Frames the port's RX DMA has completed and not yet been read — a read of
+// up to this many frames returns without waiting
+uint32_t i2s_audio_port0_available(void);
+uint32_t i2s_audio_port1_available(void);
+uint32_t i2s_audio_port2_available(void);
 bool i2s_audio_port0_active(void);
 bool i2s_audio_port1_active(void);
 bool i2s_audio_port2_active(void);
@@ -291,7 +353,7 @@ bool i2s_port_enable_rx(uint8_t port, uint8_t mode, uint8_t tdmSlots,
 void i2s_port_disable_rx(uint8_t port);
 void i2s_port_write(uint8_t port, const void* src, size_t size, size_t* bw, uint32_t timeout);
 uint32_t i2s_port_read(uint8_t port, int32_t* dst, uint32_t frames);
-uint32_t i2s_port_tdm_read(uint8_t port, int32_t* dst, uint32_t frames, uint8_t slots);
+uint32_t i2s_port_tdm_read(uint8_t port, void* dst, uint32_t frames, uint16_t frameBytes);
 bool i2s_port_is_tx_active(uint8_t port);
 bool i2s_port_is_rx_active(uint8_t port);
 I2sPortInfo i2s_port_get_info(uint8_t port);
@@ -306,7 +368,7 @@ inline bool i2s_port_enable_rx(uint8_t, uint8_t, uint8_t, int, int, int, int,
 inline void i2s_port_disable_rx(uint8_t) {}
 inline void i2s_port_write(uint8_t, const void*, size_t, size_t* bw, uint32_t) { if (bw) *bw = 0; }
 inline uint32_t i2s_port_read(uint8_t, int32_t*, uint32_t) { return 0; }
-inline uint32_t i2s_port_tdm_read(uint8_t, int32_t*, uint32_t, uint8_t) { return 0; }
+inline uint32_t i2s_port_tdm_read(uint8_t, void*, uint32_t, uint16_t) { return 0; }
 inline bool i2s_port_is_tx_active(uint8_t) { return false; }
 inline bool i2s_port_is_rx_active(uint8_t) { return false; }
 inline I2sPortInfo i2s_port_get_info(uint8_t port) { I2sPortInfo info = {}; info.port = port; return info; }
@@ -420,8 +420,9 @@ void setup() {
   // IMPORTANT: We must collect the "Cookie" header to read the session ID
   // Also collecting X-Session-ID as a fallback for API calls
   // Accept-Encoding allows us to serve gzipped content when supported
-  const char *headerkeys[] = {"Cookie", "X-Session-ID", "Accept-Encoding"};
-  server.collectHeaders(headerkeys, 3);
+  // If-None-Match lets cached web pages revalidate with a 304
+  const char *headerkeys[] = {"Cookie", "X-Session-ID", "Accept-Encoding", "If-None-Match"};
+  server.collectHeaders(headerkeys, 4);
 
   // Register all HTTP server routes (before WiFi setup)
   registerMainRoutes();
@@ -739,11 +739,11 @@ void mqttCallback(char *topic, byte *payload, unsigned int length) {
   // Handle DSP global bypass
   else if (topicStr == base + "/dsp/bypass/set") {
     bool newState = (message == "ON" || message == "1" || message == "true");
-    appState.dsp.bypass = newState;
-    dsp_copy_active_to_inactive();
+    if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("MQTT"); return; }
     DspState *cfg = dsp_get_inactive_config();
     cfg->globalBypass = newState;
-    if (!dsp_swap_config()) { dsp_log_swap_failure("MQTT"); }
+    if (!dsp_swap_config()) { dsp_log_swap_failure("MQTT"); return; }
+    appState.dsp.bypass = newState;
     saveDspSettingsDebounced();
     appState.markDspConfigDirty();
     LOG_I("[MQTT] DSP bypass set to %s", newState ? "ON" : "OFF");
@@ -757,10 +757,10 @@ void mqttCallback(char *topic, byte *payload, unsigned int length) {
       int ch = topicStr.substring(chStart, chEnd).toInt();
       if (ch >= 0 && ch < DSP_MAX_CHANNELS) {
         bool newState = (message == "ON" || message == "1" || message == "true");
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("MQTT"); return; }
         DspState *cfg = dsp_get_inactive_config();
         cfg->channels[ch].bypass = newState;
-        if (!dsp_swap_config()) { dsp_log_swap_failure("MQTT"); }
+        if (!dsp_swap_config()) { dsp_log_swap_failure("MQTT"); return; }
         saveDspSettingsDebounced();
         appState.markDspConfigDirty();
         LOG_I("[MQTT] DSP channel %d bypass set to %s", ch, newState ? "ON" : "OFF");
@@ -778,10 +778,10 @@ void mqttCallback(char *topic, byte *payload, unsigned int length) {
       int band = topicStr.substring(bandStart, bandEnd).toInt() - 1;
       if (ch >= 0 && ch < 2 && band >= 0 && band < DSP_PEQ_BANDS) {
         bool newState = (message == "ON" || message == "1" || message == "true");
-        dsp_copy_active_to_inactive();
+        if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("MQTT"); return; }
         DspState *cfg = dsp_get_inactive_config();
         cfg->channels[ch].stages[band].enabled = newState;
-        if (!dsp_swap_config()) { dsp_log_swap_failure("MQTT"); }
+        if (!dsp_swap_config()) { dsp_log_swap_failure("MQTT"); return; }
         saveDspSettingsDebounced();
         appState.markDspConfigDirty();
         LOG_I("[MQTT] PEQ ch%d band%d set to %s", ch, band + 1, newState ? "ON" : "OFF");
@@ -791,14 +791,14 @@ void mqttCallback(char *topic, byte *payload, unsigned int length) {
   // PEQ bypass (disable/enable all PEQ bands on all channels)
   else if (topicStr == base + "/dsp/peq/bypass/set") {
     bool bypass = (message == "ON" || message == "1" || message == "true");
-    dsp_copy_active_to_inactive();
+    if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("MQTT"); return; }
     DspState *cfg = dsp_get_inactive_config();
     for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
       for (int b = 0; b < DSP_PEQ_BANDS && b < cfg->channels[ch].stageCount; b++) {
         cfg->channels[ch].stages[b].enabled = !bypass;
       }
     }
-    if (!dsp_swap_config()) { dsp_log_swap_failure("MQTT"); }
+    if (!dsp_swap_config()) { dsp_log_swap_failure("MQTT"); return; }
     saveDspSettingsDebounced();
     appState.markDspConfigDirty();
     LOG_I("[MQTT] PEQ bypass set to %s", bypass ? "ON" : "OFF");
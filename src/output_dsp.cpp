@@ -3,6 +3,9 @@
 #include "output_dsp.h"
 #include "dsp_coefficients.h"
 #include "dsp_biquad_gen.h"
+#include "dsp_true_peak.h"
+#include "dsp_kernels.h"
+#include "dsp_convolution.h"
 #include "dsps_biquad.h"
 #include "dsps_mulc.h"
 #include "dsps_mul.h"
@@ -15,6 +18,7 @@
 #include "debug_serial.h"
 #include "diag_journal.h"
 #include "psram_alloc.h"
+#include "config_snapshot.h"
 #include <ArduinoJson.h>
 #include <LittleFS.h>
 #else
@@ -25,78 +29,148 @@
 
 // ===== Double-buffered State (PSRAM on ESP32, static on native) =====
 #ifdef NATIVE_TEST
-static OutputDspState _states[2];
+static OutputDspState _outStates[2];
 #else
-static OutputDspState *_states = nullptr;
+static OutputDspState *_outStates = nullptr;
 #endif
-static volatile int _activeIndex = 0;
+static volatile int _outActiveIndex = 0;
 
 // ===== Swap Synchronization =====
 #ifndef NATIVE_TEST
-static SemaphoreHandle_t _swapMutex = NULL;
+static SemaphoreHandle_t _outSwapMutex = NULL;
 #endif
-static volatile bool _swapRequested = false;
+static volatile bool _outSwapRequested = false;
 
-// ===== Gain buffer for 2-pass limiter/compressor (no dynamic alloc in process) =====
+// ===== Scratch for the dynamics / bass kernels (no dynamic alloc in process) =====
 #ifdef NATIVE_TEST
 static float _outGainBuf[256];
 #else
 static float *_outGainBuf = nullptr;
 #endif
 
-// ===== Per-channel delay circular buffers (PSRAM-allocated on demand) =====
-// One buffer per output channel. Allocated when a DSP_DELAY stage is first created.
+// Biquad run of the block walk (audio task only)
+static DspBiquadRef _outBqRefs[DSP_BQ_RUN_MAX_SECTIONS];
+static DspBiquadRun _outBqRun;
+
+// ===== Per-channel delay rings (PSRAM-allocated on demand) =====
+// One ring per output channel. Allocated when a DSP_DELAY stage is first created.
 // writePos per stage is stored in DspDelayParams.writePos.
 #ifdef NATIVE_TEST
-static float _outDelayBuf[OUTPUT_DSP_MAX_CHANNELS][OUTPUT_DSP_MAX_DELAY_SAMPLES];
-static bool _outDelayBufAlloc[OUTPUT_DSP_MAX_CHANNELS];
+static float _outDelayBuf[OUTPUT_DSP_MAX_CHANNELS][OUTPUT_DSP_DELAY_RING_SIZE];
 #else
 static float *_outDelayBuf[OUTPUT_DSP_MAX_CHANNELS];
+#endif
 static bool _outDelayBufAlloc[OUTPUT_DSP_MAX_CHANNELS];
+
+// ===== Per-channel true-peak limiter state (PSRAM-allocated on demand) =====
+// At most one DSP_TRUE_PEAK_LIMITER stage per output channel. The state is
+// kept across swaps and stage removal, and reset when a stage is added.
+#ifdef NATIVE_TEST
+static DspTruePeakState _outTpState[OUTPUT_DSP_MAX_CHANNELS];
+#else
+static DspTruePeakState *_outTpState[OUTPUT_DSP_MAX_CHANNELS];
+#endif
+static bool _outTpAlloc[OUTPUT_DSP_MAX_CHANNELS];
+
+// ===== Per-channel FIR (PSRAM-allocated on demand) =====
+// At most one DSP_FIR stage per output channel: taps per config state, one
+// kernel state (history, overlap-save spectra) shared by both, as in the
+// input DSP FIR pool.
+#ifdef NATIVE_TEST
+static float _outFirTaps[2][OUTPUT_DSP_MAX_CHANNELS][DSP_MAX_FIR_TAPS];
+static DspFirRun _outFirRun[OUTPUT_DSP_MAX_CHANNELS];
+#else
+static float *_outFirTaps[2][OUTPUT_DSP_MAX_CHANNELS];
+static DspFirRun *_outFirRun[OUTPUT_DSP_MAX_CHANNELS];
 #endif
+static bool _outFirAlloc[OUTPUT_DSP_MAX_CHANNELS];
 
-// ===== Forward Declarations =====
-static void output_dsp_limiter_process(DspLimiterParams &lim, float *buf, int len, uint32_t sampleRate);
-static void output_dsp_gain_process(DspGainParams &gain, float *buf, int len, uint32_t sampleRate);
-static void output_dsp_compressor_process(DspCompressorParams &comp, float *buf, int len, uint32_t sampleRate);
-static void output_dsp_delay_process(DspDelayParams &d, float *delayBuf, float *buf, int frames);
+// ===== Per-channel multi-band compressor (PSRAM-allocated on demand) =====
+// At most one DSP_MULTIBAND_COMP stage per output channel. Band settings and
+// state live in the slot and apply without a swap.
+#ifdef NATIVE_TEST
+static DspMultibandSlot _outMb[OUTPUT_DSP_MAX_CHANNELS];
+#else
+static DspMultibandSlot *_outMb[OUTPUT_DSP_MAX_CHANNELS];
+#endif
+static bool _outMbAlloc[OUTPUT_DSP_MAX_CHANNELS];
 
-// ===== Local stage type helpers (reuse stage_type_name from dsp_pipeline.h for serialization) =====
+static inline float *_out_delay_ring(int ch) {
+    return _outDelayBufAlloc[ch] ? _outDelayBuf[ch] : nullptr;
+}
 
-static DspStageType output_dsp_type_from_name(const char *name) {
-    if (!name) return DSP_BIQUAD_PEQ;
-    if (strcmp(name, "LPF") == 0) return DSP_BIQUAD_LPF;
-    if (strcmp(name, "HPF") == 0) return DSP_BIQUAD_HPF;
-    if (strcmp(name, "BPF") == 0) return DSP_BIQUAD_BPF;
-    if (strcmp(name, "NOTCH") == 0) return DSP_BIQUAD_NOTCH;
-    if (strcmp(name, "PEQ") == 0) return DSP_BIQUAD_PEQ;
-    if (strcmp(name, "LOW_SHELF") == 0) return DSP_BIQUAD_LOW_SHELF;
-    if (strcmp(name, "HIGH_SHELF") == 0) return DSP_BIQUAD_HIGH_SHELF;
-    if (strcmp(name, "ALLPASS") == 0) return DSP_BIQUAD_ALLPASS;
-    if (strcmp(name, "ALLPASS_360") == 0) return DSP_BIQUAD_ALLPASS_360;
-    if (strcmp(name, "ALLPASS_180") == 0) return DSP_BIQUAD_ALLPASS_180;
-    if (strcmp(name, "BPF_0DB") == 0) return DSP_BIQUAD_BPF_0DB;
-    if (strcmp(name, "CUSTOM") == 0) return DSP_BIQUAD_CUSTOM;
-    if (strcmp(name, "LIMITER") == 0) return DSP_LIMITER;
-    if (strcmp(name, "GAIN") == 0) return DSP_GAIN;
-    if (strcmp(name, "POLARITY") == 0) return DSP_POLARITY;
-    if (strcmp(name, "MUTE") == 0) return DSP_MUTE;
-    if (strcmp(name, "COMPRESSOR") == 0) return DSP_COMPRESSOR;
-    if (strcmp(name, "DELAY") == 0) return DSP_DELAY;
-    if (strcmp(name, "LPF_1ST") == 0) return DSP_BIQUAD_LPF_1ST;
-    if (strcmp(name, "HPF_1ST") == 0) return DSP_BIQUAD_HPF_1ST;
-    if (strcmp(name, "LINKWITZ") == 0) return DSP_BIQUAD_LINKWITZ;
-    return DSP_BIQUAD_PEQ;
+static inline DspTruePeakState *_out_tp(int ch) {
+    if (!_outTpAlloc[ch]) return nullptr;
+#ifdef NATIVE_TEST
+    return &_outTpState[ch];
+#else
+    return _outTpState[ch];
+#endif
+}
+
+static inline float *_out_fir_taps(int stateIdx, int ch) {
+    if (!_outFirAlloc[ch]) return nullptr;
+    return _outFirTaps[stateIdx][ch];
+}
+
+static inline DspFirRun *_out_fir_run(int ch) {
+    if (!_outFirAlloc[ch]) return nullptr;
+#ifdef NATIVE_TEST
+    return &_outFirRun[ch];
+#else
+    return _outFirRun[ch];
+#endif
+}
+
+static inline DspMultibandSlot *_out_mb(int ch) {
+    if (!_outMbAlloc[ch]) return nullptr;
+#ifdef NATIVE_TEST
+    return &_outMb[ch];
+#else
+    return _outMb[ch];
+#endif
+}
+
+// FIR kernel switch-over; on target the input DSP's measured crossover
+static inline int _out_fir_crossover() {
+#ifdef NATIVE_TEST
+    return DSP_FIR_FFT_MIN_TAPS;
+#else
+    return dsp_fir_fft_crossover();
+#endif
 }
 
-// ===== Coefficient computation helpers =====
+// ===== Stage types =====
 
-static void output_dsp_compute_gain_linear(DspGainParams &g) {
-    g.gainLinear = dsp_db_to_linear(g.gainDb);
+DspStageType output_dsp_type_from_name(const char *name) {
+    if (!name) return DSP_BIQUAD_PEQ;
+    for (int t = 0; t < DSP_STAGE_TYPE_COUNT; t++) {
+        if (strcmp(name, stage_type_name((DspStageType)t)) == 0) return (DspStageType)t;
+    }
+    return DSP_BIQUAD_PEQ;
 }
 
-static void output_dsp_compute_compressor_makeup(DspCompressorParams &c) {
-    c.makeupLinear = dsp_db_to_linear(c.makeupGainDb);
+bool output_dsp_type_supported(DspStageType type) {
+    if (dsp_is_biquad_type(type)) return true;
+    switch (type) {
+        case DSP_LIMITER:
+        case DSP_FIR:
+        case DSP_GAIN:
+        case DSP_DELAY:
+        case DSP_POLARITY:
+        case DSP_MUTE:
+        case DSP_COMPRESSOR:
+        case DSP_CONVOLUTION:
+        case DSP_NOISE_GATE:
+        case DSP_TONE_CTRL:
+        case DSP_LOUDNESS:
+        case DSP_BASS_ENHANCE:
+        case DSP_MULTIBAND_COMP:
+        case DSP_TRUE_PEAK_LIMITER:
+            return true;
+        default:
+            return false;   // Stereo width (needs a pair), multirate sections
+    }
 }
 
 // ===== Initialization =====
@@ -104,28 +178,35 @@ static void output_dsp_compute_compressor_makeup(DspCompressorParams &c) {
 void output_dsp_init() {
 #ifndef NATIVE_TEST
     // Allocate double-buffered state from PSRAM
-    if (!_states) {
-        _states = (OutputDspState *)psram_alloc(2, sizeof(OutputDspState), "outdsp_states");
+    if (!_outStates) {
+        _outStates = (OutputDspState *)psram_alloc(2, sizeof(OutputDspState), "outdsp_states");
     }
     // Allocate gain buffer for 2-pass limiter/compressor
     if (!_outGainBuf) {
         _outGainBuf = (float *)psram_alloc(256, sizeof(float), "outdsp_buf");
     }
-    // Delay buffers are allocated on demand (output_dsp_alloc_delay_buf)
+    // Per-channel stage state is allocated on demand
     memset(_outDelayBuf, 0, sizeof(_outDelayBuf));
+    memset(_outTpState, 0, sizeof(_outTpState));
+    memset(_outFirTaps, 0, sizeof(_outFirTaps));
+    memset(_outFirRun, 0, sizeof(_outFirRun));
+    memset(_outMb, 0, sizeof(_outMb));
 #endif
     memset(_outDelayBufAlloc, 0, sizeof(_outDelayBufAlloc));
+    memset(_outTpAlloc, 0, sizeof(_outTpAlloc));
+    memset(_outFirAlloc, 0, sizeof(_outFirAlloc));
+    memset(_outMbAlloc, 0, sizeof(_outMbAlloc));
 
-    output_dsp_init_state(_states[0]);
-    output_dsp_init_state(_states[1]);
-    _activeIndex = 0;
+    output_dsp_init_state(_outStates[0]);
+    output_dsp_init_state(_outStates[1]);
+    _outActiveIndex = 0;
 
 #ifndef NATIVE_TEST
-    if (!_swapMutex) {
-        _swapMutex = xSemaphoreCreateMutex();
+    if (!_outSwapMutex) {
+        _outSwapMutex = xSemaphoreCreateMutex();
     }
 #endif
-    _swapRequested = false;
+    _outSwapRequested = false;
 
     LOG_I("[OutputDSP] Initialized (double-buffered, %d channels, max %d stages/ch)",
           OUTPUT_DSP_MAX_CHANNELS, OUTPUT_DSP_MAX_STAGES);
@@ -134,42 +215,103 @@ void output_dsp_init() {
 // ===== Config Access =====
 
 OutputDspState* output_dsp_get_active_config() {
-    return &_states[_activeIndex];
+    return &_outStates[_outActiveIndex];
 }
 
 OutputDspState* output_dsp_get_inactive_config() {
-    return &_states[1 - _activeIndex];
+    return &_outStates[1 - _outActiveIndex];
 }
 
 void output_dsp_copy_active_to_inactive() {
-    int activeIdx = _activeIndex;
+    int activeIdx = _outActiveIndex;
     int inactiveIdx = 1 - activeIdx;
-    _states[inactiveIdx] = _states[activeIdx];
+    _outStates[inactiveIdx] = _outStates[activeIdx];
+    for (int ch = 0; ch < OUTPUT_DSP_MAX_CHANNELS; ch++) {
+        float *src = _out_fir_taps(activeIdx, ch);
+        float *dst = _out_fir_taps(inactiveIdx, ch);
+        if (src && dst) memcpy(dst, src, sizeof(float) * DSP_MAX_FIR_TAPS);
+    }
 }
 
 // ===== Swap =====
 
+// Carry runtime state of a stage that survives the swap (same index and type)
+static void output_dsp_migrate_stage(OutputDspStage &oldS, OutputDspStage &newS) {
+    if (dsp_is_biquad_type(newS.type)) {
+        // Copy delay lines for continuity
+        newS.biquad.delay[0] = oldS.biquad.delay[0];
+        newS.biquad.delay[1] = oldS.biquad.delay[1];
+        // Detect coefficient changes for glitch-free morphing
+        bool coeffChanged = false;
+        for (int c = 0; c < 5; c++) {
+            if (newS.biquad.coeffs[c] != oldS.biquad.coeffs[c]) {
+                coeffChanged = true;
+                break;
+            }
+        }
+        if (coeffChanged) {
+            for (int c = 0; c < 5; c++) {
+                newS.biquad.targetCoeffs[c] = newS.biquad.coeffs[c];
+                newS.biquad.coeffs[c] = oldS.biquad.coeffs[c];
+            }
+            newS.biquad.morphRemaining = DSP_BQ_MORPH_SAMPLES;
+        } else {
+            newS.biquad.morphRemaining = 0;
+        }
+    } else if (newS.type == DSP_LIMITER) {
+        newS.limiter.envelope = oldS.limiter.envelope;
+        newS.limiter.gainReduction = oldS.limiter.gainReduction;
+    } else if (newS.type == DSP_GAIN) {
+        newS.gain.currentLinear = oldS.gain.currentLinear;
+    } else if (newS.type == DSP_COMPRESSOR) {
+        newS.compressor.envelope = oldS.compressor.envelope;
+        newS.compressor.gainReduction = oldS.compressor.gainReduction;
+    } else if (newS.type == DSP_DELAY) {
+        // One ring per channel: keep reading where the old config wrote
+        newS.delay.writePos = oldS.delay.writePos;
+        newS.delay.apState = oldS.delay.apState;
+    } else if (newS.type == DSP_FIR) {
+        newS.fir.mode = oldS.fir.mode;
+    } else if (newS.type == DSP_NOISE_GATE) {
+        newS.noiseGate.envelope = oldS.noiseGate.envelope;
+        newS.noiseGate.gainReduction = oldS.noiseGate.gainReduction;
+        newS.noiseGate.holdCounter = oldS.noiseGate.holdCounter;
+    } else if (newS.type == DSP_TONE_CTRL) {
+        memcpy(newS.toneCtrl.bassDelay, oldS.toneCtrl.bassDelay, sizeof(float) * 2);
+        memcpy(newS.toneCtrl.midDelay, oldS.toneCtrl.midDelay, sizeof(float) * 2);
+        memcpy(newS.toneCtrl.trebleDelay, oldS.toneCtrl.trebleDelay, sizeof(float) * 2);
+    } else if (newS.type == DSP_LOUDNESS) {
+        memcpy(newS.loudness.bassDelay, oldS.loudness.bassDelay, sizeof(float) * 2);
+        memcpy(newS.loudness.trebleDelay, oldS.loudness.trebleDelay, sizeof(float) * 2);
+    } else if (newS.type == DSP_BASS_ENHANCE) {
+        memcpy(newS.bassEnhance.hpfDelay, oldS.bassEnhance.hpfDelay, sizeof(float) * 2);
+        memcpy(newS.bassEnhance.bpfDelay, oldS.bassEnhance.bpfDelay, sizeof(float) * 2);
+    }
+    // Polarity and mute have no runtime state; multi-band, true-peak and
+    // convolution state lives outside the config
+}
+
 bool output_dsp_swap_config() {
 #ifndef NATIVE_TEST
-    if (_swapMutex && xSemaphoreTake(_swapMutex, pdMS_TO_TICKS(5)) != pdTRUE) {
+    if (_outSwapMutex && xSemaphoreTake(_outSwapMutex, pdMS_TO_TICKS(5)) != pdTRUE) {
         LOG_W("[OutputDSP] Swap failed: mutex busy");
         return false;
     }
 #endif
 
-    int oldActive = _activeIndex;
+    int oldActive = _outActiveIndex;
     int newActive = 1 - oldActive;
 
     // Notify pipeline of impending swap (reuses same hold-buffer mechanism)
     audio_pipeline_notify_dsp_swap();
 
-    _swapRequested = true;
+    _outSwapRequested = true;
 
     // Brief wait for audio task to see the flag (output DSP runs inside audio pipeline,
     // so we just need a few ms for the current iteration to finish)
 #ifndef NATIVE_TEST
     int waitCount = 0;
-    while (_swapRequested && waitCount < 50) {
+    while (_outSwapRequested && waitCount < 50) {
         vTaskDelay(1);
         waitCount++;
     }
@@ -177,56 +319,24 @@ bool output_dsp_swap_config() {
 
     // Copy runtime state (delay lines, envelopes) from old active to new active
     for (int ch = 0; ch < OUTPUT_DSP_MAX_CHANNELS; ch++) {
-        OutputDspChannelConfig &oldCh = _states[oldActive].channels[ch];
-        OutputDspChannelConfig &newCh = _states[newActive].channels[ch];
+        OutputDspChannelConfig &oldCh = _outStates[oldActive].channels[ch];
+        OutputDspChannelConfig &newCh = _outStates[newActive].channels[ch];
 
         int minStages = oldCh.stageCount < newCh.stageCount ? oldCh.stageCount : newCh.stageCount;
         for (int s = 0; s < minStages; s++) {
             OutputDspStage &oldS = oldCh.stages[s];
             OutputDspStage &newS = newCh.stages[s];
-
             if (oldS.type != newS.type) continue;
-
-            if (dsp_is_biquad_type(newS.type)) {
-                // Copy delay lines for continuity
-                newS.biquad.delay[0] = oldS.biquad.delay[0];
-                newS.biquad.delay[1] = oldS.biquad.delay[1];
-                // Detect coefficient changes for glitch-free morphing
-                bool coeffChanged = false;
-                for (int c = 0; c < 5; c++) {
-                    if (newS.biquad.coeffs[c] != oldS.biquad.coeffs[c]) {
-                        coeffChanged = true;
-                        break;
-                    }
-                }
-                if (coeffChanged) {
-                    for (int c = 0; c < 5; c++) {
-                        newS.biquad.targetCoeffs[c] = newS.biquad.coeffs[c];
-                        newS.biquad.coeffs[c] = oldS.biquad.coeffs[c];
-                    }
-                    newS.biquad.morphRemaining = 64; // ~1.3ms at 48kHz
-                } else {
-                    newS.biquad.morphRemaining = 0;
-                }
-            } else if (newS.type == DSP_LIMITER) {
-                newS.limiter.envelope = oldS.limiter.envelope;
-                newS.limiter.gainReduction = oldS.limiter.gainReduction;
-            } else if (newS.type == DSP_GAIN) {
-                newS.gain.currentLinear = oldS.gain.currentLinear;
-            } else if (newS.type == DSP_COMPRESSOR) {
-                newS.compressor.envelope = oldS.compressor.envelope;
-                newS.compressor.gainReduction = oldS.compressor.gainReduction;
-            }
-            // DSP_POLARITY and DSP_MUTE have no runtime state to preserve
+            output_dsp_migrate_stage(oldS, newS);
         }
     }
 
     // Atomic swap
-    _activeIndex = newActive;
-    _swapRequested = false;
+    _outActiveIndex = newActive;
+    _outSwapRequested = false;
 
 #ifndef NATIVE_TEST
-    if (_swapMutex) xSemaphoreGive(_swapMutex);
+    if (_outSwapMutex) xSemaphoreGive(_outSwapMutex);
 #endif
 
     LOG_I("[OutputDSP] Config swapped (active=%d)", newActive);
@@ -234,11 +344,154 @@ bool output_dsp_swap_config() {
 }
 
 // ===== Processing =====
+// Each block walks the channel's stages the way the input DSP program
+// compiler does: linear stages (biquads, tone and loudness shelves, settled
+// gains, polarity) are collected into one biquad run plus a static scale,
+// flushed before the next stateful stage; disabled and no-op stages are
+// dropped. Stateful stages run the shared kernels with parameters derived
+// for this block.
+
+enum OutputDspStageClass { OUT_CLS_NONE, OUT_CLS_LINEAR, OUT_CLS_OP };
+
+struct OutputDspPending {
+    int n;          // Sections in _outBqRefs
+    float scale;
+};
+
+static OutputDspStageClass output_dsp_stage_class(int ch, const OutputDspStage &s) {
+    if (!s.enabled) return OUT_CLS_NONE;
+    if (dsp_is_biquad_type(s.type)) return OUT_CLS_LINEAR;
+    switch (s.type) {
+        case DSP_TONE_CTRL:
+        case DSP_LOUDNESS:
+            return OUT_CLS_LINEAR;
+        case DSP_GAIN:
+            return fabsf(s.gain.currentLinear - s.gain.gainLinear) < 1e-6f ? OUT_CLS_LINEAR : OUT_CLS_OP;
+        case DSP_POLARITY:
+            return s.polarity.inverted ? OUT_CLS_LINEAR : OUT_CLS_NONE;
+        case DSP_MUTE:
+            return s.mute.muted ? OUT_CLS_OP : OUT_CLS_NONE;
+        case DSP_DELAY: {
+            const bool frac = s.delay.interp != DSP_DELAY_INTERP_NONE && s.delay.fraction > 0.0f;
+            return (_out_delay_ring(ch) && (s.delay.delaySamples > 0 || frac)) ? OUT_CLS_OP : OUT_CLS_NONE;
+        }
+        case DSP_FIR:
+            return (s.fir.numTaps > 0 && _out_fir_run(ch)) ? OUT_CLS_OP : OUT_CLS_NONE;
+        case DSP_MULTIBAND_COMP:
+            return _out_mb(ch) ? OUT_CLS_OP : OUT_CLS_NONE;
+        case DSP_TRUE_PEAK_LIMITER:
+            return _out_tp(ch) ? OUT_CLS_OP : OUT_CLS_NONE;
+        case DSP_BASS_ENHANCE:
+            return s.bassEnhance.mix > 0.0f ? OUT_CLS_OP : OUT_CLS_NONE;
+        case DSP_CONVOLUTION:
+        case DSP_LIMITER:
+        case DSP_COMPRESSOR:
+        case DSP_NOISE_GATE:
+            return OUT_CLS_OP;
+        default:
+            return OUT_CLS_NONE;
+    }
+}
+
+static inline void output_dsp_section(OutputDspPending &pd, float *coeffs, float *delay, DspBiquadParams *morph) {
+    if (pd.n >= DSP_BQ_RUN_MAX_SECTIONS) return;
+    DspBiquadRef &r = _outBqRefs[pd.n++];
+    r.coeffs = coeffs;
+    r.delay = delay;
+    r.morph = morph;
+}
+
+static void output_dsp_fold(OutputDspPending &pd, OutputDspStage &s) {
+    if (dsp_is_biquad_type(s.type)) {
+        output_dsp_section(pd, s.biquad.coeffs, s.biquad.delay, &s.biquad);
+    } else if (s.type == DSP_TONE_CTRL) {
+        output_dsp_section(pd, s.toneCtrl.bassCoeffs, s.toneCtrl.bassDelay, nullptr);
+        output_dsp_section(pd, s.toneCtrl.midCoeffs, s.toneCtrl.midDelay, nullptr);
+        output_dsp_section(pd, s.toneCtrl.trebleCoeffs, s.toneCtrl.trebleDelay, nullptr);
+    } else if (s.type == DSP_LOUDNESS) {
+        output_dsp_section(pd, s.loudness.bassCoeffs, s.loudness.bassDelay, nullptr);
+        output_dsp_section(pd, s.loudness.trebleCoeffs, s.loudness.trebleDelay, nullptr);
+    } else if (s.type == DSP_GAIN) {
+        pd.scale *= s.gain.gainLinear;
+    } else if (s.type == DSP_POLARITY) {
+        pd.scale = -pd.scale;
+    }
+}
+
+static void output_dsp_flush(OutputDspPending &pd, float *buf, int frames) {
+    if (pd.n > 0) {
+        dsp_k_bq_gather(_outBqRefs, pd.n, _outBqRun);
+        dsp_k_bq_run(_outBqRun, nullptr, buf, nullptr, frames);
+    }
+    if (pd.scale != 1.0f) {
+        dsps_mulc_f32(buf, buf, frames, pd.scale, 1, 1);
+    }
+    pd.n = 0;
+    pd.scale = 1.0f;
+}
+
+static void output_dsp_run_stage(int ch, OutputDspStage &s, float *buf, int frames, uint32_t rate) {
+    switch (s.type) {
+        case DSP_GAIN:
+            dsp_k_gain_ramp(s.gain.gainLinear, s.gain.currentLinear, dsp_time_coeff(5.0f, (float)rate), buf, frames);
+            break;
+        case DSP_MUTE:
+            memset(buf, 0, frames * sizeof(float));
+            break;
+        case DSP_LIMITER: {
+            DspDynCoeffs k;
+            dsp_k_limiter_coeffs(k, s.limiter, rate);
+            dsp_k_limiter(k, s.limiter.envelope, s.limiter.gainReduction, _outGainBuf, buf, frames);
+            break;
+        }
+        case DSP_COMPRESSOR: {
+            DspDynCoeffs k;
+            dsp_k_compressor_coeffs(k, s.compressor, rate);
+            dsp_k_compressor(k, s.compressor.envelope, s.compressor.gainReduction, _outGainBuf, buf, frames);
+            break;
+        }
+        case DSP_NOISE_GATE: {
+            DspNoiseGateParams &g = s.noiseGate;
+            DspDynCoeffs k;
+            dsp_k_gate_coeffs(k, g, rate);
+            dsp_k_noise_gate(k, g.envelope, g.holdCounter, g.gainReduction, _outGainBuf, buf, frames);
+            break;
+        }
+        case DSP_DELAY: {
+            DspDelayTaps t;
+            dsp_k_delay_taps(s.delay, t, OUTPUT_DSP_MAX_DELAY_SAMPLES);
+            dsp_k_delay(t, s.delay.writePos, s.delay.apState, _out_delay_ring(ch),
+                        OUTPUT_DSP_DELAY_RING_MASK, buf, frames);
+            break;
+        }
+        case DSP_FIR:
+            dsp_k_fir(s.fir, _out_fir_taps(_outActiveIndex, ch), *_out_fir_run(ch), _out_fir_crossover(), buf, frames);
+            break;
+        case DSP_CONVOLUTION:
+            dsp_conv_process(s.convolution.convSlot, buf, frames);
+            break;
+        case DSP_BASS_ENHANCE:
+            dsp_k_bass_enhance(s.bassEnhance, _outGainBuf, buf, frames);
+            break;
+        case DSP_MULTIBAND_COMP:
+            dsp_k_multiband(*_out_mb(ch), s.multibandComp.numBands, rate, buf, frames);
+            break;
+        case DSP_TRUE_PEAK_LIMITER: {
+            DspTruePeakState &tp = *_out_tp(ch);
+            dsp_tp_configure(tp, rate, s.truePeak.ceilingDb, s.truePeak.lookaheadMs, s.truePeak.releaseMs);
+            float g = dsp_true_peak_process(tp, buf, frames);
+            s.truePeak.gainReduction = g < 1.0f ? 20.0f * log10f(g > 1e-5f ? g : 1e-5f) : 0.0f;
+            break;
+        }
+        default:
+            break;
+    }
+}
 
 void output_dsp_process(int ch, float *buf, int frames) {
     if (ch < 0 || ch >= OUTPUT_DSP_MAX_CHANNELS || !buf || frames <= 0 || frames > 256) return;
 
-    OutputDspState *cfg = &_states[_activeIndex];
+    OutputDspState *cfg = &_outStates[_outActiveIndex];
 
     // Global bypass — skip all processing
     if (cfg->globalBypass) return;
@@ -249,238 +502,240 @@ void output_dsp_process(int ch, float *buf, int frames) {
     if (channel.bypass) return;
 
     uint32_t sampleRate = cfg->sampleRate;
+    OutputDspPending pd = {0, 1.0f};
 
     for (int i = 0; i < channel.stageCount; i++) {
         OutputDspStage &s = channel.stages[i];
-        if (!s.enabled) continue;
-
-        if (dsp_is_biquad_type(s.type)) {
-            if (s.biquad.morphRemaining > 0) {
-                // Coefficient morphing for glitch-free transitions
-                int remaining = s.biquad.morphRemaining;
-                int processed = 0;
-                while (processed < frames && remaining > 0) {
-                    float t = 1.0f - (float)remaining / 64.0f;
-                    float interpCoeffs[5];
-                    for (int c = 0; c < 5; c++) {
-                        interpCoeffs[c] = s.biquad.coeffs[c] + t * (s.biquad.targetCoeffs[c] - s.biquad.coeffs[c]);
-                    }
-                    int chunk = frames - processed;
-                    if (chunk > 8) chunk = 8;
-                    if (chunk > remaining) chunk = remaining;
-                    dsps_biquad_f32(buf + processed, buf + processed, chunk, interpCoeffs, s.biquad.delay);
-                    processed += chunk;
-                    remaining -= chunk;
-                }
-                if (remaining <= 0) {
-                    for (int c = 0; c < 5; c++) {
-                        s.biquad.coeffs[c] = s.biquad.targetCoeffs[c];
-                    }
-                    s.biquad.morphRemaining = 0;
-                    if (processed < frames) {
-                        dsps_biquad_f32(buf + processed, buf + processed, frames - processed, s.biquad.coeffs, s.biquad.delay);
-                    }
-                } else {
-                    s.biquad.morphRemaining = (uint16_t)remaining;
-                }
-            } else {
-                dsps_biquad_f32(buf, buf, frames, s.biquad.coeffs, s.biquad.delay);
-            }
-            continue;
-        }
-
-        switch (s.type) {
-            case DSP_LIMITER:
-                output_dsp_limiter_process(s.limiter, buf, frames, sampleRate);
-                break;
-            case DSP_GAIN:
-                output_dsp_gain_process(s.gain, buf, frames, sampleRate);
-                break;
-            case DSP_POLARITY:
-                if (s.polarity.inverted) {
-                    dsps_mulc_f32(buf, buf, frames, -1.0f, 1, 1);
-                }
-                break;
-            case DSP_MUTE:
-                if (s.mute.muted) {
-                    memset(buf, 0, frames * sizeof(float));
-                }
-                break;
-            case DSP_COMPRESSOR:
-                output_dsp_compressor_process(s.compressor, buf, frames, sampleRate);
-                break;
-            case DSP_DELAY:
-                if (_outDelayBufAlloc[ch]) {
-                    output_dsp_delay_process(s.delay, _outDelayBuf[ch], buf, frames);
-                }
-                break;
-            default:
-                break;
+        OutputDspStageClass cls = output_dsp_stage_class(ch, s);
+        if (cls == OUT_CLS_LINEAR) {
+            output_dsp_fold(pd, s);
+        } else if (cls == OUT_CLS_OP) {
+            output_dsp_flush(pd, buf, frames);
+            output_dsp_run_stage(ch, s, buf, frames, sampleRate);
         }
     }
+    output_dsp_flush(pd, buf, frames);
 }
 
-// ===== Delay (circular buffer, per-channel PSRAM buffer) =====
-
-static void output_dsp_delay_process(DspDelayParams &d, float *delayBuf, float *buf, int frames) {
-    uint16_t delaySamples = d.delaySamples;
-    if (delaySamples == 0) return;  // 0ms delay — pass through unchanged
-    if (delaySamples > OUTPUT_DSP_MAX_DELAY_SAMPLES) delaySamples = OUTPUT_DSP_MAX_DELAY_SAMPLES;
+// ===== Per-channel Stage State =====
 
-    uint16_t wp = d.writePos;
-    for (int i = 0; i < frames; i++) {
-        // Read delayed sample from circular buffer
-        uint16_t rp = (wp >= delaySamples) ? (uint16_t)(wp - delaySamples)
-                                            : (uint16_t)(OUTPUT_DSP_MAX_DELAY_SAMPLES + wp - delaySamples);
-        float delayed = delayBuf[rp];
-        // Write current sample into buffer
-        delayBuf[wp] = buf[i];
-        buf[i] = delayed;
-        if (++wp >= OUTPUT_DSP_MAX_DELAY_SAMPLES) wp = 0;
+// Allocate the per-channel delay ring on demand.
+// Returns true if the ring is ready (already allocated or just allocated).
+static bool output_dsp_alloc_delay_buf(int channel) {
+    if (channel < 0 || channel >= OUTPUT_DSP_MAX_CHANNELS) return false;
+    if (_outDelayBufAlloc[channel]) return true;
+#ifdef NATIVE_TEST
+    memset(_outDelayBuf[channel], 0, sizeof(_outDelayBuf[channel]));
+#else
+    _outDelayBuf[channel] = (float *)psram_alloc(OUTPUT_DSP_DELAY_RING_SIZE, sizeof(float), "outdsp_delay");
+    if (!_outDelayBuf[channel]) {
+        LOG_W("[OutputDSP] Failed to allocate delay buffer for ch=%d", channel);
+        return false;
     }
-    d.writePos = wp;
+    memset(_outDelayBuf[channel], 0, OUTPUT_DSP_DELAY_RING_SIZE * sizeof(float));
+#endif
+    _outDelayBufAlloc[channel] = true;
+    return true;
 }
 
-// ===== Limiter (2-pass: envelope detection + gain application) =====
-
-static void output_dsp_limiter_process(DspLimiterParams &lim, float *buf, int len, uint32_t sampleRate) {
-    if (len <= 0 || sampleRate == 0) return;
-
-    float threshLin = dsp_db_to_linear(lim.thresholdDb);
-    float attackCoeff = dsp_time_coeff(lim.attackMs, (float)sampleRate);
-    float releaseCoeff = dsp_time_coeff(lim.releaseMs, (float)sampleRate);
-
-    float env = lim.envelope;
-    float maxGr = 0.0f;
-
-    // Pass 1: Envelope detection -> gain buffer
-    for (int i = 0; i < len; i++) {
-        float absSample = fabsf(buf[i]);
-
-        if (absSample > env) {
-            env = attackCoeff * env + (1.0f - attackCoeff) * absSample;
-        } else {
-            env = releaseCoeff * env + (1.0f - releaseCoeff) * absSample;
+// Allocate (first use) and reset the per-channel true-peak limiter state.
+static bool output_dsp_alloc_tp_state(int channel) {
+    if (channel < 0 || channel >= OUTPUT_DSP_MAX_CHANNELS) return false;
+#ifdef NATIVE_TEST
+    DspTruePeakState *st = &_outTpState[channel];
+#else
+    if (!_outTpState[channel]) {
+        _outTpState[channel] = (DspTruePeakState *)psram_alloc(1, sizeof(DspTruePeakState), "outdsp_truepeak");
+        if (!_outTpState[channel]) {
+            LOG_W("[OutputDSP] Failed to allocate true-peak state for ch=%d", channel);
+            return false;
         }
+    }
+    DspTruePeakState *st = _outTpState[channel];
+#endif
+    dsp_tp_init(*st);
+    _outTpAlloc[channel] = true;
+    return true;
+}
 
-        float gainLin = 1.0f;
-        if (env > threshLin && env > 0.0f) {
-            float envDb = 20.0f * log10f(env);
-            float overDb = envDb - lim.thresholdDb;
-            float grDb = overDb * (1.0f - 1.0f / lim.ratio);
-            gainLin = dsp_db_to_linear(-grDb);
-            if (grDb > maxGr) maxGr = grDb;
+// Allocate (first use) and clear the per-channel FIR taps and kernel state.
+static bool output_dsp_alloc_fir(int channel) {
+    if (channel < 0 || channel >= OUTPUT_DSP_MAX_CHANNELS) return false;
+#ifndef NATIVE_TEST
+    for (int s = 0; s < 2; s++) {
+        if (!_outFirTaps[s][channel]) {
+            _outFirTaps[s][channel] = (float *)psram_alloc(DSP_MAX_FIR_TAPS, sizeof(float), "outdsp_fir_taps");
+        }
+        if (!_outFirTaps[s][channel]) {
+            LOG_W("[OutputDSP] Failed to allocate FIR taps for ch=%d", channel);
+            return false;
         }
-
-        _outGainBuf[i] = gainLin;
     }
-
-    // Pass 2: Apply gain via SIMD element-wise multiply
-    dsps_mul_f32(buf, _outGainBuf, buf, len, 1, 1, 1);
-
-    lim.envelope = env;
-    lim.gainReduction = -maxGr;
+    if (!_outFirRun[channel]) {
+        _outFirRun[channel] = (DspFirRun *)psram_alloc(1, sizeof(DspFirRun), "outdsp_fir_run");
+        if (!_outFirRun[channel]) {
+            LOG_W("[OutputDSP] Failed to allocate FIR state for ch=%d", channel);
+            return false;
+        }
+        dsp_fir_run_init(*_outFirRun[channel]);
+    }
+    DspFirRun &run = *_outFirRun[channel];
+#else
+    if (!_outFirAlloc[channel]) dsp_fir_run_init(_outFirRun[channel]);
+    DspFirRun &run = _outFirRun[channel];
+#endif
+    for (int s = 0; s < 2; s++) {
+        memset(_outFirTaps[s][channel], 0, sizeof(float) * DSP_MAX_FIR_TAPS);
+    }
+    run.olsTaps = 0;
+    dsp_fir_run_reset(run, 0);
+    _outFirAlloc[channel] = true;
+    return true;
 }
 
-// ===== Gain (with exponential ramp for glitch-free transitions) =====
-
-static void output_dsp_gain_process(DspGainParams &gain, float *buf, int len, uint32_t sampleRate) {
-    float target = gain.gainLinear;
-    float current = gain.currentLinear;
-
-    // If already at target, use fast SIMD path
-    float diff = fabsf(current - target);
-    if (diff < 1e-6f) {
-        gain.currentLinear = target;
-        dsps_mulc_f32(buf, buf, len, target, 1, 1);
-        return;
+// Allocate (first use) and reset the per-channel multi-band slot, with the
+// crossovers computed for the current sample rate.
+static bool output_dsp_alloc_mb(int channel, uint32_t sampleRate) {
+    if (channel < 0 || channel >= OUTPUT_DSP_MAX_CHANNELS) return false;
+#ifdef NATIVE_TEST
+    DspMultibandSlot *slot = &_outMb[channel];
+#else
+    if (!_outMb[channel]) {
+        _outMb[channel] = (DspMultibandSlot *)psram_alloc(1, sizeof(DspMultibandSlot), "outdsp_multiband");
+        if (!_outMb[channel]) {
+            LOG_W("[OutputDSP] Failed to allocate multi-band state for ch=%d", channel);
+            return false;
+        }
     }
-
-    // Exponential ramp: ~5ms time constant
-    float tau = 5.0f; // ms
-    float coeff = dsp_time_coeff(tau, (float)sampleRate);
-    float oneMinusCoeff = 1.0f - coeff;
-
-    for (int i = 0; i < len; i++) {
-        current = coeff * current + oneMinusCoeff * target;
-        buf[i] *= current;
+    DspMultibandSlot *slot = _outMb[channel];
+#endif
+    dsp_k_mb_defaults(*slot);
+    for (int b = 0; b < 3 && sampleRate > 0; b++) {
+        dsp_k_mb_set_crossover(*slot, b, slot->crossoverFreqs[b], sampleRate);
     }
-    gain.currentLinear = current;
+    _outMbAlloc[channel] = true;
+    return true;
 }
 
-// ===== Compressor (2-pass with soft knee) =====
-
-static void output_dsp_compressor_process(DspCompressorParams &comp, float *buf, int len, uint32_t sampleRate) {
-    if (len <= 0 || sampleRate == 0) return;
+static bool output_dsp_has_type(const OutputDspChannelConfig &ch, DspStageType type) {
+    for (int i = 0; i < ch.stageCount; i++) {
+        if (ch.stages[i].type == type) return true;
+    }
+    return false;
+}
 
-    float attackCoeff = dsp_time_coeff(comp.attackMs, (float)sampleRate);
-    float releaseCoeff = dsp_time_coeff(comp.releaseMs, (float)sampleRate);
-    float makeupLin = comp.makeupLinear;
+// Allocate what a new stage of `type` needs on `channel`. Stage types with
+// per-channel state are limited to one per channel.
+static bool output_dsp_prepare_stage(int channel, const OutputDspChannelConfig &ch, DspStageType type,
+                                     uint32_t sampleRate) {
+    switch (type) {
+        case DSP_DELAY:
+            return output_dsp_alloc_delay_buf(channel);
+        case DSP_TRUE_PEAK_LIMITER:
+            return !output_dsp_has_type(ch, type) && output_dsp_alloc_tp_state(channel);
+        case DSP_FIR:
+            return !output_dsp_has_type(ch, type) && output_dsp_alloc_fir(channel);
+        case DSP_MULTIBAND_COMP:
+            return !output_dsp_has_type(ch, type) && output_dsp_alloc_mb(channel, sampleRate);
+        case DSP_CONVOLUTION:
+            return !output_dsp_has_type(ch, type);
+        default:
+            return true;
+    }
+}
 
-    float env = comp.envelope;
-    float maxGr = 0.0f;
+// Derived coefficients of a freshly initialized or loaded stage
+static void output_dsp_compute_stage(OutputDspStage &s, uint32_t sampleRate) {
+    if (dsp_is_biquad_type(s.type)) {
+        if (s.type != DSP_BIQUAD_CUSTOM) dsp_compute_biquad_coeffs(s.biquad, s.type, sampleRate);
+    } else if (s.type == DSP_GAIN) {
+        dsp_compute_gain_linear(s.gain);
+    } else if (s.type == DSP_COMPRESSOR) {
+        dsp_compute_compressor_makeup(s.compressor);
+    } else if (s.type == DSP_TONE_CTRL) {
+        dsp_compute_tone_ctrl_coeffs(s.toneCtrl, sampleRate);
+    } else if (s.type == DSP_LOUDNESS) {
+        dsp_compute_loudness_coeffs(s.loudness, sampleRate);
+    } else if (s.type == DSP_BASS_ENHANCE) {
+        dsp_compute_bass_enhance_coeffs(s.bassEnhance, sampleRate);
+    }
+}
 
-    // Pass 1: Envelope detection -> gain buffer (includes makeup gain)
-    for (int i = 0; i < len; i++) {
-        float absSample = fabsf(buf[i]);
+void output_dsp_prepare_sample_rate(uint32_t rate) {
+    output_dsp_copy_active_to_inactive();
+    OutputDspState &st = _outStates[1 - _outActiveIndex];
+    st.sampleRate = rate;
+    for (int ch = 0; ch < OUTPUT_DSP_MAX_CHANNELS; ch++) {
+        OutputDspChannelConfig &c = st.channels[ch];
+        for (int i = 0; i < c.stageCount; i++) output_dsp_compute_stage(c.stages[i], rate);
+    }
+}
 
-        if (absSample > env) {
-            env = attackCoeff * env + (1.0f - attackCoeff) * absSample;
-        } else {
-            env = releaseCoeff * env + (1.0f - releaseCoeff) * absSample;
-        }
+static OutputDspStage *output_dsp_find_stage(OutputDspChannelConfig &ch, DspStageType type) {
+    for (int i = 0; i < ch.stageCount; i++) {
+        if (ch.stages[i].type == type) return &ch.stages[i];
+    }
+    return nullptr;
+}
 
-        float gainLin = 1.0f;
-        if (env > 0.0f) {
-            float envDb = 20.0f * log10f(env);
-            float overDb = envDb - comp.thresholdDb;
-
-            float grDb = 0.0f;
-            if (comp.kneeDb > 0.0f && overDb > -comp.kneeDb / 2.0f && overDb < comp.kneeDb / 2.0f) {
-                // Soft knee region
-                float x = overDb + comp.kneeDb / 2.0f;
-                grDb = (1.0f - 1.0f / comp.ratio) * x * x / (2.0f * comp.kneeDb);
-            } else if (overDb >= comp.kneeDb / 2.0f) {
-                grDb = overDb * (1.0f - 1.0f / comp.ratio);
-            }
+bool output_dsp_set_fir_taps(int channel, const float *taps, int numTaps) {
+    if (channel < 0 || channel >= OUTPUT_DSP_MAX_CHANNELS || !taps) return false;
+    if (numTaps <= 0 || numTaps > DSP_MAX_FIR_TAPS) return false;
+    int inactiveIdx = 1 - _outActiveIndex;
+    OutputDspStage *s = output_dsp_find_stage(_outStates[inactiveIdx].channels[channel], DSP_FIR);
+    float *dst = _out_fir_taps(inactiveIdx, channel);
+    if (!s || !dst) return false;
+
+    memset(dst, 0, sizeof(float) * DSP_MAX_FIR_TAPS);
+    memcpy(dst, taps, sizeof(float) * numTaps);
+    s->fir.numTaps = (uint16_t)numTaps;
+
+    // Same commit as dsp_fir_commit_taps(): pre-transform long filters
+    DspFirRun &run = *_out_fir_run(channel);
+    if (numTaps >= _out_fir_crossover())
+        dsp_fir_prepare(run, dst, (uint16_t)numTaps);
+    else
+        run.olsTaps = 0;
+    return true;
+}
 
-            if (grDb > 0.0f) {
-                gainLin = dsp_db_to_linear(-grDb);
-                if (grDb > maxGr) maxGr = grDb;
-            }
-        }
+int output_dsp_load_ir(int channel, const float *ir, int irLength) {
+    if (channel < 0 || channel >= OUTPUT_DSP_MAX_CHANNELS || !ir || irLength <= 0) return -1;
+    OutputDspStage *s = output_dsp_find_stage(_outStates[1 - _outActiveIndex].channels[channel], DSP_CONVOLUTION);
+    if (!s) return -1;
 
-        _outGainBuf[i] = gainLin * makeupLin;
+    int slot = -1;
+    for (int i = 0; i < CONV_MAX_IR_SLOTS; i++) {
+        if (!dsp_conv_is_active(i)) { slot = i; break; }
     }
-
-    // Pass 2: Apply gain via SIMD element-wise multiply
-    dsps_mul_f32(buf, _outGainBuf, buf, len, 1, 1, 1);
-
-    comp.envelope = env;
-    comp.gainReduction = -maxGr;
+    if (slot < 0 || dsp_conv_init_slot(slot, ir, irLength) != 0) {
+        LOG_W("[OutputDSP] No convolution slot for ch=%d", channel);
+        return -1;
+    }
+    s->convolution.convSlot = (int8_t)slot;
+    s->convolution.irLength = (uint16_t)irLength;
+    return slot;
 }
 
-// ===== Delay Buffer Management =====
-
-// Allocate the per-channel delay circular buffer on demand.
-// Returns true if the buffer is ready (already allocated or just allocated).
-static bool output_dsp_alloc_delay_buf(int channel) {
+bool output_dsp_mb_set_band_params(int channel, int band, float thresholdDb, float attackMs,
+                                   float releaseMs, float ratio, float kneeDb, float makeupGainDb) {
     if (channel < 0 || channel >= OUTPUT_DSP_MAX_CHANNELS) return false;
-    if (_outDelayBufAlloc[channel]) return true;
-#ifdef NATIVE_TEST
-    memset(_outDelayBuf[channel], 0, sizeof(_outDelayBuf[channel]));
-#else
-    _outDelayBuf[channel] = (float *)psram_alloc(OUTPUT_DSP_MAX_DELAY_SAMPLES, sizeof(float), "outdsp_delay");
-    if (!_outDelayBuf[channel]) {
-        LOG_W("[OutputDSP] Failed to allocate delay buffer for ch=%d", channel);
-        return false;
-    }
-    memset(_outDelayBuf[channel], 0, OUTPUT_DSP_MAX_DELAY_SAMPLES * sizeof(float));
-#endif
-    _outDelayBufAlloc[channel] = true;
+    if (band < 0 || band >= DSP_MULTIBAND_MAX_BANDS) return false;
+    DspMultibandSlot *slot = _out_mb(channel);
+    if (!slot) return false;
+    dsp_k_mb_set_band(*slot, band, thresholdDb, attackMs, releaseMs, ratio, kneeDb, makeupGainDb);
     return true;
 }
 
+bool output_dsp_mb_set_crossover_freq(int channel, int boundary, float freqHz) {
+    if (channel < 0 || channel >= OUTPUT_DSP_MAX_CHANNELS) return false;
+    if (boundary < 0 || boundary >= 3) return false;
+    DspMultibandSlot *slot = _out_mb(channel);
+    uint32_t sampleRate = _outStates[_outActiveIndex].sampleRate;
+    if (!slot || sampleRate == 0) return false;
+    return dsp_k_mb_set_crossover(*slot, boundary, freqHz, sampleRate);
+}
+
 // ===== Stage CRUD =====
 
 int output_dsp_add_stage(int channel, DspStageType type, int position) {
@@ -490,16 +745,12 @@ int output_dsp_add_stage(int channel, DspStageType type, int position) {
     OutputDspChannelConfig &ch = cfg->channels[channel];
     if (ch.stageCount >= OUTPUT_DSP_MAX_STAGES) return -1;
 
-    // Validate supported types for output DSP (no FIR, decimator, convolution, etc.)
-    if (!dsp_is_biquad_type(type) &&
-        type != DSP_LIMITER && type != DSP_GAIN && type != DSP_POLARITY &&
-        type != DSP_MUTE && type != DSP_COMPRESSOR && type != DSP_DELAY) {
+    if (!output_dsp_type_supported(type)) {
         LOG_W("[OutputDSP] Unsupported stage type %d for output DSP", (int)type);
         return -1;
     }
-    // Delay requires a buffer — allocate on demand
-    if (type == DSP_DELAY && !output_dsp_alloc_delay_buf(channel)) {
-        LOG_W("[OutputDSP] Cannot add delay stage for ch=%d — buffer allocation failed", channel);
+    if (!output_dsp_prepare_stage(channel, ch, type, cfg->sampleRate)) {
+        LOG_W("[OutputDSP] Cannot add %s stage for ch=%d", stage_type_name(type), channel);
         return -1;
     }
 
@@ -515,13 +766,7 @@ int output_dsp_add_stage(int channel, DspStageType type, int position) {
     ch.stageCount++;
 
     // Compute coefficients for new stage
-    if (dsp_is_biquad_type(type)) {
-        dsp_compute_biquad_coeffs(ch.stages[pos].biquad, type, cfg->sampleRate);
-    } else if (type == DSP_GAIN) {
-        output_dsp_compute_gain_linear(ch.stages[pos].gain);
-    } else if (type == DSP_COMPRESSOR) {
-        output_dsp_compute_compressor_makeup(ch.stages[pos].compressor);
-    }
+    output_dsp_compute_stage(ch.stages[pos], cfg->sampleRate);
 
     return pos;
 }
@@ -533,7 +778,10 @@ bool output_dsp_remove_stage(int channel, int stageIndex) {
     OutputDspChannelConfig &ch = cfg->channels[channel];
     if (stageIndex < 0 || stageIndex >= ch.stageCount) return false;
 
-    // No pool slots to free (output DSP stages are self-contained)
+    // Per-channel state stays allocated; only the convolution pool slot is shared
+    if (ch.stages[stageIndex].type == DSP_CONVOLUTION && ch.stages[stageIndex].convolution.convSlot >= 0) {
+        dsp_conv_free_slot(ch.stages[stageIndex].convolution.convSlot);
+    }
 
     // Shift stages down
     for (int i = stageIndex; i < ch.stageCount - 1; i++) {
@@ -678,11 +926,184 @@ int output_dsp_setup_crossover(int subCh, int mainCh, float freqHz, int order) {
     return stagesAdded;
 }
 
+// ===== Binary Config Image =====
+
+// Clear the runtime fields a swap would carry, so a restored stage starts
+// like a freshly loaded one
+static void output_dsp_reset_runtime(OutputDspStage &s) {
+    if (dsp_is_biquad_type(s.type)) {
+        s.biquad.delay[0] = s.biquad.delay[1] = 0.0f;
+        s.biquad.morphRemaining = 0;
+    } else if (s.type == DSP_LIMITER) {
+        s.limiter.envelope = 0.0f;
+        s.limiter.gainReduction = 0.0f;
+    } else if (s.type == DSP_GAIN) {
+        s.gain.currentLinear = s.gain.gainLinear;   // No ramp on load
+    } else if (s.type == DSP_COMPRESSOR) {
+        s.compressor.envelope = 0.0f;
+        s.compressor.gainReduction = 0.0f;
+    } else if (s.type == DSP_DELAY) {
+        s.delay.writePos = 0;
+        s.delay.apState = 0.0f;
+        s.delay.delaySlot = -1;  // Not used in output DSP (per-channel ring)
+        if (s.delay.delaySamples > OUTPUT_DSP_MAX_DELAY_SAMPLES) s.delay.delaySamples = OUTPUT_DSP_MAX_DELAY_SAMPLES;
+    } else if (s.type == DSP_FIR) {
+        s.fir.mode = DSP_FIR_MODE_DIRECT;
+        s.fir.cpuPercent = 0.0f;
+    } else if (s.type == DSP_CONVOLUTION) {
+        s.convolution.convSlot = -1;  // IR must be loaded separately via output_dsp_load_ir()
+    } else if (s.type == DSP_NOISE_GATE) {
+        s.noiseGate.envelope = 0.0f;
+        s.noiseGate.gainReduction = 0.0f;
+        s.noiseGate.holdCounter = 0.0f;
+    } else if (s.type == DSP_TONE_CTRL) {
+        memset(s.toneCtrl.bassDelay, 0, sizeof(s.toneCtrl.bassDelay));
+        memset(s.toneCtrl.midDelay, 0, sizeof(s.toneCtrl.midDelay));
+        memset(s.toneCtrl.trebleDelay, 0, sizeof(s.toneCtrl.trebleDelay));
+    } else if (s.type == DSP_LOUDNESS) {
+        memset(s.loudness.bassDelay, 0, sizeof(s.loudness.bassDelay));
+        memset(s.loudness.trebleDelay, 0, sizeof(s.loudness.trebleDelay));
+    } else if (s.type == DSP_BASS_ENHANCE) {
+        memset(s.bassEnhance.hpfDelay, 0, sizeof(s.bassEnhance.hpfDelay));
+        memset(s.bassEnhance.bpfDelay, 0, sizeof(s.bassEnhance.bpfDelay));
+    } else if (s.type == DSP_TRUE_PEAK_LIMITER) {
+        s.truePeak.gainReduction = 0.0f;
+    }
+}
+
+static inline bool output_dsp_image_has_taps(const OutputDspStage &s) {
+    return s.type == DSP_FIR && s.fir.numTaps > 0;
+}
+
+size_t output_dsp_image_pack(uint8_t *buf, size_t cap) {
+    if (!buf) return 0;
+    int activeIdx = _outActiveIndex;
+    const OutputDspState &cfg = _outStates[activeIdx];
+
+    OutputDspImageHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.version = OUTPUT_DSP_IMAGE_VERSION;
+    hdr.stageBytes = sizeof(OutputDspStage);
+    hdr.channels = OUTPUT_DSP_MAX_CHANNELS;
+    hdr.maxStages = OUTPUT_DSP_MAX_STAGES;
+    hdr.globalBypass = cfg.globalBypass ? 1 : 0;
+    hdr.sampleRate = cfg.sampleRate;
+    if (cap < sizeof(hdr)) return 0;
+    memcpy(buf, &hdr, sizeof(hdr));
+    size_t pos = sizeof(hdr);
+
+    for (int ch = 0; ch < OUTPUT_DSP_MAX_CHANNELS; ch++) {
+        const OutputDspChannelConfig &c = cfg.channels[ch];
+        OutputDspImageChannel ci = { (uint8_t)(c.bypass ? 1 : 0), c.stageCount, { 0, 0 } };
+        size_t n = c.stageCount * sizeof(OutputDspStage);
+        if (pos + sizeof(ci) + n > cap) return 0;
+        memcpy(buf + pos, &ci, sizeof(ci));
+        memcpy(buf + pos + sizeof(ci), c.stages, n);
+        pos += sizeof(ci) + n;
+    }
+
+    for (int ch = 0; ch < OUTPUT_DSP_MAX_CHANNELS; ch++) {
+        const OutputDspChannelConfig &c = cfg.channels[ch];
+        for (int i = 0; i < c.stageCount; i++) {
+            if (!output_dsp_image_has_taps(c.stages[i])) continue;
+            size_t n = c.stages[i].fir.numTaps * sizeof(float);
+            if (pos + n > cap) return 0;
+            const float *taps = _out_fir_taps(activeIdx, ch);
+            if (taps) memcpy(buf + pos, taps, n);
+            else memset(buf + pos, 0, n);
+            pos += n;
+        }
+    }
+    return pos;
+}
+
+bool output_dsp_image_unpack(const uint8_t *buf, size_t len) {
+    if (!buf || len < sizeof(OutputDspImageHeader)) return false;
+    OutputDspImageHeader hdr;
+    memcpy(&hdr, buf, sizeof(hdr));
+    if (hdr.version != OUTPUT_DSP_IMAGE_VERSION || hdr.stageBytes != sizeof(OutputDspStage) ||
+        hdr.channels != OUTPUT_DSP_MAX_CHANNELS || hdr.maxStages != OUTPUT_DSP_MAX_STAGES) return false;
+
+    // Walk the whole image before touching the config
+    size_t stagePos[OUTPUT_DSP_MAX_CHANNELS];
+    OutputDspImageChannel chHdr[OUTPUT_DSP_MAX_CHANNELS];
+    size_t pos = sizeof(hdr);
+    for (int ch = 0; ch < OUTPUT_DSP_MAX_CHANNELS; ch++) {
+        if (pos + sizeof(OutputDspImageChannel) > len) return false;
+        memcpy(&chHdr[ch], buf + pos, sizeof(OutputDspImageChannel));
+        if (chHdr[ch].stageCount > OUTPUT_DSP_MAX_STAGES) return false;
+        stagePos[ch] = pos + sizeof(OutputDspImageChannel);
+        pos = stagePos[ch] + chHdr[ch].stageCount * sizeof(OutputDspStage);
+        if (pos > len) return false;
+    }
+    size_t tapsPos = pos;
+    OutputDspStage s;
+    for (int ch = 0; ch < OUTPUT_DSP_MAX_CHANNELS; ch++) {
+        for (int i = 0; i < chHdr[ch].stageCount; i++) {
+            memcpy(&s, buf + stagePos[ch] + i * sizeof(OutputDspStage), sizeof(OutputDspStage));
+            if (s.type >= DSP_STAGE_TYPE_COUNT) return false;
+            if (!output_dsp_image_has_taps(s)) continue;
+            if (s.fir.numTaps > DSP_MAX_FIR_TAPS) return false;
+            pos += s.fir.numTaps * sizeof(float);
+        }
+    }
+    if (pos != len) return false;
+
+    // Load into active config directly (called at startup before audio starts)
+    int activeIdx = _outActiveIndex;
+    OutputDspState &cfg = _outStates[activeIdx];
+    cfg.globalBypass = hdr.globalBypass != 0;
+    cfg.sampleRate = hdr.sampleRate;
+    pos = tapsPos;
+    for (int ch = 0; ch < OUTPUT_DSP_MAX_CHANNELS; ch++) {
+        OutputDspChannelConfig &channel = cfg.channels[ch];
+        channel.bypass = chHdr[ch].bypass != 0;
+        channel.stageCount = 0;
+        for (int i = 0; i < chHdr[ch].stageCount; i++) {
+            memcpy(&s, buf + stagePos[ch] + i * sizeof(OutputDspStage), sizeof(OutputDspStage));
+            const uint8_t *taps = nullptr;
+            if (output_dsp_image_has_taps(s)) {
+                taps = buf + pos;
+                pos += s.fir.numTaps * sizeof(float);
+            }
+            if (!output_dsp_type_supported(s.type) ||
+                !output_dsp_prepare_stage(ch, channel, s.type, cfg.sampleRate)) {
+                LOG_W("[OutputDSP] Image: skipping %s for ch%d", stage_type_name(s.type), ch);
+                continue;
+            }
+            OutputDspStage &dst = channel.stages[channel.stageCount];
+            dst = s;
+            dst.label[sizeof(dst.label) - 1] = '\0';
+            output_dsp_reset_runtime(dst);
+            output_dsp_compute_stage(dst, cfg.sampleRate);
+            if (taps) {
+                // Both states hold the same taps, as after output_dsp_set_fir_taps + swap
+                for (int st = 0; st < 2; st++) memcpy(_out_fir_taps(st, ch), taps, dst.fir.numTaps * sizeof(float));
+                DspFirRun &run = *_out_fir_run(ch);
+                if (dst.fir.numTaps >= _out_fir_crossover())
+                    dsp_fir_prepare(run, _out_fir_taps(activeIdx, ch), dst.fir.numTaps);
+                else
+                    run.olsTaps = 0;
+            }
+            channel.stageCount++;
+        }
+    }
+    return true;
+}
+
 // ===== Persistence =====
 
 #ifndef NATIVE_TEST
 
-void output_dsp_save_channel(int ch) {
+// Snapshot schema: the payload is the image alone, which checks its own layout
+#define OUTPUT_DSP_SNAPSHOT_SCHEMA 1
+
+static ConfigSnapshotStore _outStore =
+    CONFIG_SNAPSHOT_STORE(CONFIG_SNAPSHOT_BASE_OUTPUT_DSP, OUTPUT_DSP_IMAGE_MAX_BYTES);
+
+// /output_dsp_ch%d.json — the pre-snapshot format, still written for
+// settings export/import and read once to migrate
+static void output_dsp_write_json(int ch) {
     if (ch < 0 || ch >= OUTPUT_DSP_MAX_CHANNELS) return;
 
     OutputDspState *cfg = output_dsp_get_active_config();
@@ -737,6 +1158,51 @@ void output_dsp_save_channel(int ch) {
         } else if (s.type == DSP_DELAY) {
             JsonObject params = stageObj["params"].to<JsonObject>();
             params["delaySamples"] = s.delay.delaySamples;
+            if (s.delay.interp != DSP_DELAY_INTERP_NONE) {
+                params["fraction"] = s.delay.fraction;
+                params["interp"] = s.delay.interp;
+            }
+        } else if (s.type == DSP_FIR) {
+            // Taps are not persisted; reload them via the FIR upload API
+            JsonObject params = stageObj["params"].to<JsonObject>();
+            params["numTaps"] = s.fir.numTaps;
+        } else if (s.type == DSP_CONVOLUTION) {
+            JsonObject params = stageObj["params"].to<JsonObject>();
+            params["irLength"] = s.convolution.irLength;
+            if (s.convolution.irFilename[0])
+                params["irFilename"] = s.convolution.irFilename;
+        } else if (s.type == DSP_NOISE_GATE) {
+            JsonObject params = stageObj["params"].to<JsonObject>();
+            params["thresholdDb"] = s.noiseGate.thresholdDb;
+            params["attackMs"] = s.noiseGate.attackMs;
+            params["holdMs"] = s.noiseGate.holdMs;
+            params["releaseMs"] = s.noiseGate.releaseMs;
+            params["ratio"] = s.noiseGate.ratio;
+            params["rangeDb"] = s.noiseGate.rangeDb;
+        } else if (s.type == DSP_TONE_CTRL) {
+            JsonObject params = stageObj["params"].to<JsonObject>();
+            params["bassGain"] = s.toneCtrl.bassGain;
+            params["midGain"] = s.toneCtrl.midGain;
+            params["trebleGain"] = s.toneCtrl.trebleGain;
+        } else if (s.type == DSP_LOUDNESS) {
+            JsonObject params = stageObj["params"].to<JsonObject>();
+            params["referenceLevelDb"] = s.loudness.referenceLevelDb;
+            params["currentLevelDb"] = s.loudness.currentLevelDb;
+            params["amount"] = s.loudness.amount;
+        } else if (s.type == DSP_BASS_ENHANCE) {
+            JsonObject params = stageObj["params"].to<JsonObject>();
+            params["frequency"] = s.bassEnhance.frequency;
+            params["harmonicGainDb"] = s.bassEnhance.harmonicGainDb;
+            params["mix"] = s.bassEnhance.mix;
+            params["order"] = s.bassEnhance.order;
+        } else if (s.type == DSP_MULTIBAND_COMP) {
+            JsonObject params = stageObj["params"].to<JsonObject>();
+            params["numBands"] = s.multibandComp.numBands;
+        } else if (s.type == DSP_TRUE_PEAK_LIMITER) {
+            JsonObject params = stageObj["params"].to<JsonObject>();
+            params["ceilingDb"] = s.truePeak.ceilingDb;
+            params["lookaheadMs"] = s.truePeak.lookaheadMs;
+            params["releaseMs"] = s.truePeak.releaseMs;
         }
     }
 
@@ -750,11 +1216,17 @@ void output_dsp_save_channel(int ch) {
     }
     serializeJson(doc, f);
     f.close();
-    LOG_I("[OutputDSP] Saved ch%d (%d stages) to %s", ch, channel.stageCount, path);
+    LOG_D("[OutputDSP] Wrote ch%d (%d stages) to %s", ch, channel.stageCount, path);
 }
 
-void output_dsp_load_channel(int ch) {
-    if (ch < 0 || ch >= OUTPUT_DSP_MAX_CHANNELS) return;
+void output_dsp_write_json_all() {
+    for (int ch = 0; ch < OUTPUT_DSP_MAX_CHANNELS; ch++) {
+        output_dsp_write_json(ch);
+    }
+}
+
+bool output_dsp_load_channel(int ch) {
+    if (ch < 0 || ch >= OUTPUT_DSP_MAX_CHANNELS) return false;
 
     char path[32];
     snprintf(path, sizeof(path), "/output_dsp_ch%d.json", ch);
@@ -762,7 +1234,7 @@ void output_dsp_load_channel(int ch) {
     File f = LittleFS.open(path, "r");
     if (!f) {
         LOG_I("[OutputDSP] No saved config for ch%d", ch);
-        return;
+        return false;
     }
 
     JsonDocument doc;
@@ -771,7 +1243,7 @@ void output_dsp_load_channel(int ch) {
 
     if (err) {
         LOG_E("[OutputDSP] JSON parse error for ch%d: %s", ch, err.c_str());
-        return;
+        return true;
     }
 
     // Load into active config directly (called at startup before audio starts)
@@ -782,7 +1254,7 @@ void output_dsp_load_channel(int ch) {
     channel.stageCount = 0;
 
     JsonArray stages = doc["stages"];
-    if (!stages) return;
+    if (!stages) return true;
 
     for (JsonObject stageObj : stages) {
         if (channel.stageCount >= OUTPUT_DSP_MAX_STAGES) break;
@@ -790,16 +1262,13 @@ void output_dsp_load_channel(int ch) {
         const char *typeName = stageObj["type"] | "PEQ";
         DspStageType type = output_dsp_type_from_name(typeName);
 
-        // Validate type is supported
-        if (!dsp_is_biquad_type(type) &&
-            type != DSP_LIMITER && type != DSP_GAIN && type != DSP_POLARITY &&
-            type != DSP_MUTE && type != DSP_COMPRESSOR && type != DSP_DELAY) {
+        if (!output_dsp_type_supported(type)) {
             LOG_W("[OutputDSP] Skipping unsupported type '%s' in ch%d config", typeName, ch);
             continue;
         }
-        // Delay stages need a buffer allocated before they can process
-        if (type == DSP_DELAY && !output_dsp_alloc_delay_buf(ch)) {
-            LOG_W("[OutputDSP] Skipping DSP_DELAY for ch%d — buffer allocation failed", ch);
+        // Stages with per-channel state need it allocated before they can process
+        if (!output_dsp_prepare_stage(ch, channel, type, cfg->sampleRate)) {
+            LOG_W("[OutputDSP] Skipping %s for ch%d", typeName, ch);
             continue;
         }
 
@@ -841,7 +1310,7 @@ void output_dsp_load_channel(int ch) {
                 s.limiter.gainReduction = 0.0f;
             } else if (type == DSP_GAIN) {
                 s.gain.gainDb = params["gainDb"] | 0.0f;
-                output_dsp_compute_gain_linear(s.gain);
+                dsp_compute_gain_linear(s.gain);
                 s.gain.currentLinear = s.gain.gainLinear; // No ramp on load
             } else if (type == DSP_POLARITY) {
                 s.polarity.inverted = params["inverted"] | true;
@@ -854,42 +1323,122 @@ void output_dsp_load_channel(int ch) {
                 s.compressor.ratio = params["ratio"] | 4.0f;
                 s.compressor.kneeDb = params["kneeDb"] | 6.0f;
                 s.compressor.makeupGainDb = params["makeupGainDb"] | 0.0f;
-                output_dsp_compute_compressor_makeup(s.compressor);
+                dsp_compute_compressor_makeup(s.compressor);
                 s.compressor.envelope = 0.0f;
                 s.compressor.gainReduction = 0.0f;
             } else if (type == DSP_DELAY) {
                 s.delay.delaySamples = params["delaySamples"] | (uint16_t)0;
                 if (s.delay.delaySamples > OUTPUT_DSP_MAX_DELAY_SAMPLES)
                     s.delay.delaySamples = OUTPUT_DSP_MAX_DELAY_SAMPLES;
+                if (params["fraction"].is<float>() || params["interp"].is<int>()) {
+                    dsp_delay_set_fraction(s.delay, params["fraction"] | s.delay.fraction,
+                                           params["interp"] | (int)s.delay.interp);
+                }
                 s.delay.writePos = 0;
-                s.delay.delaySlot = -1;  // Not used in output DSP (inline buffer)
+                s.delay.delaySlot = -1;  // Not used in output DSP (per-channel ring)
+            } else if (type == DSP_FIR) {
+                s.fir.numTaps = params["numTaps"] | (uint16_t)0;
+                if (s.fir.numTaps > DSP_MAX_FIR_TAPS) s.fir.numTaps = DSP_MAX_FIR_TAPS;
+            } else if (type == DSP_CONVOLUTION) {
+                // IR must be loaded separately via output_dsp_load_ir()
+                s.convolution.irLength = params["irLength"] | (uint16_t)0;
+                const char *irFile = params["irFilename"] | "";
+                strncpy(s.convolution.irFilename, irFile, sizeof(s.convolution.irFilename) - 1);
+                s.convolution.irFilename[sizeof(s.convolution.irFilename) - 1] = '\0';
+            } else if (type == DSP_NOISE_GATE) {
+                s.noiseGate.thresholdDb = params["thresholdDb"] | -40.0f;
+                s.noiseGate.attackMs = params["attackMs"] | 1.0f;
+                s.noiseGate.holdMs = params["holdMs"] | 50.0f;
+                s.noiseGate.releaseMs = params["releaseMs"] | 100.0f;
+                s.noiseGate.ratio = params["ratio"] | 1.0f;
+                s.noiseGate.rangeDb = params["rangeDb"] | -80.0f;
+            } else if (type == DSP_TONE_CTRL) {
+                s.toneCtrl.bassGain = params["bassGain"] | 0.0f;
+                s.toneCtrl.midGain = params["midGain"] | 0.0f;
+                s.toneCtrl.trebleGain = params["trebleGain"] | 0.0f;
+            } else if (type == DSP_LOUDNESS) {
+                s.loudness.referenceLevelDb = params["referenceLevelDb"] | 85.0f;
+                s.loudness.currentLevelDb = params["currentLevelDb"] | 75.0f;
+                s.loudness.amount = params["amount"] | 100.0f;
+            } else if (type == DSP_BASS_ENHANCE) {
+                s.bassEnhance.frequency = params["frequency"] | 80.0f;
+                s.bassEnhance.harmonicGainDb = params["harmonicGainDb"] | 0.0f;
+                s.bassEnhance.mix = params["mix"] | 50.0f;
+                s.bassEnhance.order = params["order"] | (uint8_t)2;
+            } else if (type == DSP_MULTIBAND_COMP) {
+                s.multibandComp.numBands = params["numBands"] | (uint8_t)3;
+            } else if (type == DSP_TRUE_PEAK_LIMITER) {
+                s.truePeak.ceilingDb = params["ceilingDb"] | -1.0f;
+                s.truePeak.lookaheadMs = params["lookaheadMs"] | 1.5f;
+                s.truePeak.releaseMs = params["releaseMs"] | 50.0f;
+                dsp_tp_clamp_params(s.truePeak);
             }
         }
 
+        output_dsp_compute_stage(channel.stages[idx], cfg->sampleRate);
         channel.stageCount++;
     }
 
     LOG_I("[OutputDSP] Loaded ch%d: %d stages, bypass=%d", ch, channel.stageCount, channel.bypass);
+    return true;
+}
+
+// The snapshot holds every channel, so a per-channel save writes them all
+void output_dsp_save_channel(int ch) {
+    if (ch < 0 || ch >= OUTPUT_DSP_MAX_CHANNELS) return;
+    output_dsp_save_all();
 }
 
 void output_dsp_save_all() {
-    for (int ch = 0; ch < OUTPUT_DSP_MAX_CHANNELS; ch++) {
-        output_dsp_save_channel(ch);
+    uint8_t *buf = (uint8_t *)psram_alloc(OUTPUT_DSP_IMAGE_MAX_BYTES, 1, "outdsp_save");
+    if (!buf) {
+        LOG_E("[OutputDSP] Save failed: no buffer");
+        return;
+    }
+    size_t n = output_dsp_image_pack(buf, OUTPUT_DSP_IMAGE_MAX_BYTES);
+    ConfigSnapshotResult r = n ? config_snapshot_store_save(_outStore, OUTPUT_DSP_SNAPSHOT_SCHEMA, buf, n)
+                               : CFG_SNAP_TOO_LARGE;
+    psram_free(buf, "outdsp_save");
+    if (r != CFG_SNAP_OK) {
+        LOG_E("[OutputDSP] Snapshot save failed (%d)", (int)r);
+        return;
     }
+    LOG_I("[OutputDSP] Saved (snapshot gen %lu, %u bytes)",
+          (unsigned long)_outStore.stats.generation, (unsigned)n);
 }
 
 void output_dsp_load_all() {
+    uint8_t *buf = (uint8_t *)psram_alloc(OUTPUT_DSP_IMAGE_MAX_BYTES, 1, "outdsp_load");
+    if (buf) {
+        size_t len = 0;
+        ConfigSnapshotResult r = config_snapshot_store_load(_outStore, OUTPUT_DSP_SNAPSHOT_SCHEMA, buf,
+                                                            OUTPUT_DSP_IMAGE_MAX_BYTES, &len);
+        bool ok = r == CFG_SNAP_OK && len <= OUTPUT_DSP_IMAGE_MAX_BYTES && output_dsp_image_unpack(buf, len);
+        psram_free(buf, "outdsp_load");
+        if (ok) {
+            LOG_I("[OutputDSP] Loaded snapshot gen %lu", (unsigned long)_outStore.stats.generation);
+            return;
+        }
+        if (r != CFG_SNAP_NONE) LOG_W("[OutputDSP] Snapshot unusable (%d), falling back to JSON", (int)r);
+    }
+
+    bool migrate = false;
     for (int ch = 0; ch < OUTPUT_DSP_MAX_CHANNELS; ch++) {
-        output_dsp_load_channel(ch);
+        if (output_dsp_load_channel(ch)) migrate = true;
+    }
+    if (migrate) {
+        LOG_I("[OutputDSP] Migrating JSON -> binary snapshot");
+        output_dsp_save_all();
     }
 }
 
 #else
 // Native test stubs — no filesystem
 void output_dsp_save_channel(int ch) { (void)ch; }
-void output_dsp_load_channel(int ch) { (void)ch; }
+bool output_dsp_load_channel(int ch) { (void)ch; return false; }
 void output_dsp_save_all() {}
 void output_dsp_load_all() {}
+void output_dsp_write_json_all() {}
 #endif // NATIVE_TEST
 
 #endif // DSP_ENABLED
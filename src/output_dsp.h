@@ -11,7 +11,11 @@
 // Separate from the pre-matrix stereo DSP engine (dsp_pipeline.h) because:
 // 1. Operates on mono float channels (not stereo int32 pairs)
 // 2. Post-matrix processing (crossover, per-output EQ, limiting)
-// 3. Lightweight: no FIR/delay pools, no PEQ band convention
+// 3. No pools: delay, FIR, multi-band and true-peak state is per output
+//    channel (at most one stage of each per channel), no PEQ band convention
+// Both engines run the same stage kernels (dsp_kernels.h) and fold linear
+// stages the same way, so identical chains give bit-identical output.
+// Not available here: stereo width (needs a pair) and multirate sections.
 
 #ifndef OUTPUT_DSP_MAX_CHANNELS
 #define OUTPUT_DSP_MAX_CHANNELS 8   // One per mono output in 8x8 matrix
@@ -26,7 +30,16 @@
 #define OUTPUT_DSP_MAX_DELAY_SAMPLES 4800
 #endif
 
-// ===== Output DSP Stage (subset of DspStage — biquad, gain, limiter, mute, polarity, delay) =====
+// Power-of-two delay ring per channel (same layout as the input DSP delay pool)
+static constexpr uint32_t OUTPUT_DSP_DELAY_RING_SIZE =
+    dsp_pow2_ceil(OUTPUT_DSP_MAX_DELAY_SAMPLES + DSP_DELAY_CHUNK + DSP_DELAY_INTERP_TAPS);
+static constexpr uint32_t OUTPUT_DSP_DELAY_RING_MASK = OUTPUT_DSP_DELAY_RING_SIZE - 1;
+
+static_assert(OUTPUT_DSP_MAX_STAGES <= DSP_MAX_STAGES, "output chains must fit one shared biquad run");
+
+// ===== Output DSP Stage (DspStage without stereo width / multirate) =====
+// Slot fields (firSlot, mbSlot, tpSlot, delaySlot) are unused — the state is
+// per output channel. convSlot indexes the shared convolution pool.
 struct OutputDspStage {
     bool enabled;
     DspStageType type;
@@ -35,11 +48,19 @@ struct OutputDspStage {
     union {
         DspBiquadParams biquad;
         DspLimiterParams limiter;
+        DspFirParams fir;
         DspGainParams gain;
         DspPolarityParams polarity;
         DspMuteParams mute;
         DspCompressorParams compressor;
         DspDelayParams delay;
+        DspConvolutionParams convolution;
+        DspNoiseGateParams noiseGate;
+        DspToneCtrlParams toneCtrl;
+        DspLoudnessParams loudness;
+        DspBassEnhanceParams bassEnhance;
+        DspMultibandCompParams multibandComp;
+        DspTruePeakParams truePeak;
     };
 };
 
@@ -64,6 +85,8 @@ inline void output_dsp_init_stage(OutputDspStage &s, DspStageType t = DSP_BIQUAD
     s.label[0] = '\0';
     if (t == DSP_LIMITER) {
         dsp_init_limiter_params(s.limiter);
+    } else if (t == DSP_FIR) {
+        dsp_init_fir_params(s.fir);
     } else if (t == DSP_GAIN) {
         dsp_init_gain_params(s.gain);
     } else if (t == DSP_POLARITY) {
@@ -74,6 +97,20 @@ inline void output_dsp_init_stage(OutputDspStage &s, DspStageType t = DSP_BIQUAD
         dsp_init_compressor_params(s.compressor);
     } else if (t == DSP_DELAY) {
         dsp_init_delay_params(s.delay);
+    } else if (t == DSP_CONVOLUTION) {
+        dsp_init_convolution_params(s.convolution);
+    } else if (t == DSP_NOISE_GATE) {
+        dsp_init_noise_gate_params(s.noiseGate);
+    } else if (t == DSP_TONE_CTRL) {
+        dsp_init_tone_ctrl_params(s.toneCtrl);
+    } else if (t == DSP_LOUDNESS) {
+        dsp_init_loudness_params(s.loudness);
+    } else if (t == DSP_BASS_ENHANCE) {
+        dsp_init_bass_enhance_params(s.bassEnhance);
+    } else if (t == DSP_MULTIBAND_COMP) {
+        dsp_init_multiband_comp_params(s.multibandComp);
+    } else if (t == DSP_TRUE_PEAK_LIMITER) {
+        dsp_init_true_peak_params(s.truePeak);
     } else if (dsp_is_biquad_type(t)) {
         dsp_init_biquad_params(s.biquad);
     } else {
@@ -109,6 +146,10 @@ bool output_dsp_swap_config();
 // Deep copy active → inactive
 void output_dsp_copy_active_to_inactive();
 
+// Copy active → inactive at a new sample rate, recomputing rate-dependent
+// coefficients there. Publish with output_dsp_swap_config().
+void output_dsp_prepare_sample_rate(uint32_t rate);
+
 // Stage CRUD (operates on inactive config)
 int  output_dsp_add_stage(int channel, DspStageType type, int position = -1);
 bool output_dsp_remove_stage(int channel, int stageIndex);
@@ -117,11 +158,65 @@ bool output_dsp_set_stage_enabled(int channel, int stageIndex, bool enabled);
 // Crossover convenience: inserts LPF on subCh, HPF on mainCh at given frequency
 int output_dsp_setup_crossover(int subCh, int mainCh, float freqHz, int order);
 
-// Persistence
+// Stage type from its serialized name (stage_type_name); PEQ when unknown
+DspStageType output_dsp_type_from_name(const char *name);
+
+// True for stage types an output channel can run
+bool output_dsp_type_supported(DspStageType type);
+
+// FIR taps for the channel's DSP_FIR stage (inactive config; takes effect on swap)
+bool output_dsp_set_fir_taps(int channel, const float *taps, int numTaps);
+
+// Load an IR for the channel's DSP_CONVOLUTION stage into a free slot of the
+// shared convolution pool (inactive config). Returns the slot or -1.
+int output_dsp_load_ir(int channel, const float *ir, int irLength);
+
+// Multi-band compressor settings of the channel's DSP_MULTIBAND_COMP stage
+// (applied immediately, like dsp_mb_set_band_params())
+bool output_dsp_mb_set_band_params(int channel, int band, float thresholdDb, float attackMs,
+                                   float releaseMs, float ratio, float kneeDb, float makeupGainDb);
+bool output_dsp_mb_set_crossover_freq(int channel, int boundary, float freqHz);
+
+// Binary config image (same scheme as dsp_image_pack in dsp_pipeline.h): the
+// active config's channels and stages verbatim, then each channel's FIR taps.
+// Kept in the CONFIG_SNAPSHOT_BASE_OUTPUT_DSP snapshot store.
+#define OUTPUT_DSP_IMAGE_VERSION 1
+
+struct OutputDspImageHeader {
+    uint16_t version;       // OUTPUT_DSP_IMAGE_VERSION
+    uint16_t stageBytes;    // sizeof(OutputDspStage)
+    uint8_t  channels;      // OUTPUT_DSP_MAX_CHANNELS
+    uint8_t  maxStages;     // OUTPUT_DSP_MAX_STAGES
+    uint8_t  globalBypass;
+    uint8_t  reserved;
+    uint32_t sampleRate;
+};
+
+struct OutputDspImageChannel {
+    uint8_t bypass;
+    uint8_t stageCount;     // OutputDspStage records that follow
+    uint8_t reserved[2];
+};
+
+#define OUTPUT_DSP_IMAGE_MAX_BYTES (sizeof(OutputDspImageHeader) + \
+    OUTPUT_DSP_MAX_CHANNELS * (sizeof(OutputDspImageChannel) + OUTPUT_DSP_MAX_STAGES * sizeof(OutputDspStage)) + \
+    OUTPUT_DSP_MAX_CHANNELS * DSP_MAX_FIR_TAPS * sizeof(float))
+
+// Packs the active config. Returns bytes written, 0 if `cap` is too small.
+size_t output_dsp_image_pack(uint8_t *buf, size_t cap);
+// Restores an image into the active config (startup, before audio runs, like
+// output_dsp_load_channel). Per-channel state is allocated and runtime state
+// cleared. Returns false, with the config untouched, on a layout mismatch.
+bool output_dsp_image_unpack(const uint8_t *buf, size_t len);
+
+// Persistence. Saves write the binary snapshot of every channel; load_all
+// reads it, falling back to (and migrating from) /output_dsp_ch%d.json.
 void output_dsp_save_channel(int ch);
-void output_dsp_load_channel(int ch);
+bool output_dsp_load_channel(int ch);   // JSON file; false if none
 void output_dsp_save_all();
 void output_dsp_load_all();
+// Rewrite /output_dsp_ch%d.json from the active config (settings export/import)
+void output_dsp_write_json_all();
 
 #endif // DSP_ENABLED
 #endif // OUTPUT_DSP_H
@@ -158,10 +158,40 @@ void registerPipelineApiEndpoints(WebServer& /*srv*/) {
                 obj["thresholdDb"] = s.compressor.thresholdDb;
                 obj["ratio"] = s.compressor.ratio;
                 obj["gainReduction"] = s.compressor.gainReduction;
+            } else if (s.type == DSP_DELAY) {
+                obj["delaySamples"] = s.delay.delaySamples;
+            } else if (s.type == DSP_FIR) {
+                obj["numTaps"] = s.fir.numTaps;
+            } else if (s.type == DSP_CONVOLUTION) {
+                obj["irLength"] = s.convolution.irLength;
+                obj["loaded"] = s.convolution.convSlot >= 0;
+            } else if (s.type == DSP_NOISE_GATE) {
+                obj["thresholdDb"] = s.noiseGate.thresholdDb;
+                obj["rangeDb"] = s.noiseGate.rangeDb;
+                obj["gainReduction"] = s.noiseGate.gainReduction;
+            } else if (s.type == DSP_TONE_CTRL) {
+                obj["bassGain"] = s.toneCtrl.bassGain;
+                obj["midGain"] = s.toneCtrl.midGain;
+                obj["trebleGain"] = s.toneCtrl.trebleGain;
+            } else if (s.type == DSP_LOUDNESS) {
+                obj["referenceLevelDb"] = s.loudness.referenceLevelDb;
+                obj["currentLevelDb"] = s.loudness.currentLevelDb;
+                obj["amount"] = s.loudness.amount;
+            } else if (s.type == DSP_BASS_ENHANCE) {
+                obj["frequency"] = s.bassEnhance.frequency;
+                obj["harmonicGainDb"] = s.bassEnhance.harmonicGainDb;
+                obj["mix"] = s.bassEnhance.mix;
+            } else if (s.type == DSP_MULTIBAND_COMP) {
+                obj["numBands"] = s.multibandComp.numBands;
             } else if (s.type == DSP_POLARITY) {
                 obj["inverted"] = s.polarity.inverted;
             } else if (s.type == DSP_MUTE) {
                 obj["muted"] = s.mute.muted;
+            } else if (s.type == DSP_TRUE_PEAK_LIMITER) {
+                obj["ceilingDb"] = s.truePeak.ceilingDb;
+                obj["lookaheadMs"] = s.truePeak.lookaheadMs;
+                obj["releaseMs"] = s.truePeak.releaseMs;
+                obj["gainReduction"] = s.truePeak.gainReduction;
             }
         }
 
@@ -185,20 +215,7 @@ void registerPipelineApiEndpoints(WebServer& /*srv*/) {
             return;
         }
 
-        // Map type name to enum — reuse the type_from_name pattern
-        DspStageType type = DSP_BIQUAD_PEQ;
-        if (strcmp(typeName, "LPF") == 0) type = DSP_BIQUAD_LPF;
-        else if (strcmp(typeName, "HPF") == 0) type = DSP_BIQUAD_HPF;
-        else if (strcmp(typeName, "BPF") == 0) type = DSP_BIQUAD_BPF;
-        else if (strcmp(typeName, "PEQ") == 0) type = DSP_BIQUAD_PEQ;
-        else if (strcmp(typeName, "NOTCH") == 0) type = DSP_BIQUAD_NOTCH;
-        else if (strcmp(typeName, "LOW_SHELF") == 0) type = DSP_BIQUAD_LOW_SHELF;
-        else if (strcmp(typeName, "HIGH_SHELF") == 0) type = DSP_BIQUAD_HIGH_SHELF;
-        else if (strcmp(typeName, "LIMITER") == 0) type = DSP_LIMITER;
-        else if (strcmp(typeName, "GAIN") == 0) type = DSP_GAIN;
-        else if (strcmp(typeName, "POLARITY") == 0) type = DSP_POLARITY;
-        else if (strcmp(typeName, "MUTE") == 0) type = DSP_MUTE;
-        else if (strcmp(typeName, "COMPRESSOR") == 0) type = DSP_COMPRESSOR;
+        DspStageType type = output_dsp_type_from_name(typeName);
 
         output_dsp_copy_active_to_inactive();
         int idx = output_dsp_add_stage(ch, type, position);
@@ -206,6 +223,24 @@ void registerPipelineApiEndpoints(WebServer& /*srv*/) {
             server_send(400, "application/json", "{\"error\":\"add failed\"}");
             return;
         }
+        if (type == DSP_TRUE_PEAK_LIMITER) {
+            DspTruePeakParams &tp = output_dsp_get_inactive_config()->channels[ch].stages[idx].truePeak;
+            tp.ceilingDb = doc["ceilingDb"] | tp.ceilingDb;
+            tp.lookaheadMs = doc["lookaheadMs"] | tp.lookaheadMs;
+            tp.releaseMs = doc["releaseMs"] | tp.releaseMs;
+            dsp_tp_clamp_params(tp);
+        }
+        if (type == DSP_FIR && doc["taps"].is<JsonArray>()) {
+            JsonArray tapsArr = doc["taps"];
+            int n = (int)tapsArr.size();
+            if (n > DSP_MAX_FIR_TAPS) n = DSP_MAX_FIR_TAPS;
+            float *taps = (float *)malloc(sizeof(float) * (n > 0 ? n : 1));
+            if (taps) {
+                for (int j = 0; j < n; j++) taps[j] = tapsArr[j] | 0.0f;
+                output_dsp_set_fir_taps(ch, taps, n);
+                free(taps);
+            }
+        }
         output_dsp_swap_config();
         output_dsp_save_channel(ch);
 
@@ -85,7 +85,7 @@ void registerMainRoutes() {
   // Authentication routes (unprotected)
   server.on("/login", HTTP_GET, []() {
     httpServingPage = true;
-    if (!sendGzipped(server, loginPage_gz, loginPage_gz_len)) {
+    if (!sendGzipped(server, loginPage_gz, loginPage_gz_len, "text/html", loginPage_etag)) {
       server_send_P(200, "text/html", loginPage);
     }
     httpServingPage = false;
@@ -104,14 +104,25 @@ void registerMainRoutes() {
     if (!requireAuth())
       return;
 
-    // Serve gzipped dashboard if client supports it (~85% smaller)
+    // Serve gzipped dashboard if client supports it (~85% smaller); a
+    // repeat load with a matching If-None-Match gets a bodyless 304
     httpServingPage = true;
-    if (!sendGzipped(server, htmlPage_gz, htmlPage_gz_len)) {
+    if (!sendGzipped(server, htmlPage_gz, htmlPage_gz_len, "text/html", htmlPage_etag)) {
       server_send_P(200, "text/html", htmlPage);
     }
     httpServingPage = false;
   });
 
+  // Content-hashed JS/CSS (only when built with --split). Unauthenticated
+  // like /login: the bundle is the same public firmware image.
+  for (size_t i = 0; i < webAssetCount; i++) {
+    server.on(webAssets[i].path, HTTP_GET, [i]() {
+      httpServingPage = true;
+      sendWebAsset(server, webAssets[i]);
+      httpServingPage = false;
+    });
+  }
+
   server_on_versioned("/api/ethstatus", HTTP_GET, []() {
     if (!requireAuth()) return;
     handleEthStatus();
@@ -192,10 +203,27 @@ void registerMainRoutes() {
     if (!requireAuth()) return;
     handleSettingsExport();
   });
-  server_on_versioned("/api/settings/import", HTTP_POST, []() {
-    if (!requireAuth()) return;
-    handleSettingsImport();
-  });
+  // Note: /api/settings/import uses a two-handler overload (streamed body) — manually aliased
+  server.on(
+      "/api/settings/import", HTTP_POST,
+      []() {
+        if (!requireAuth()) return;
+        handleSettingsImportComplete();
+      },
+      []() {
+        if (!requireAuth()) return;
+        handleSettingsImportChunk();
+      });
+  server.on(
+      "/api/v1/settings/import", HTTP_POST,
+      []() {
+        if (!requireAuth()) return;
+        handleSettingsImportComplete();
+      },
+      []() {
+        if (!requireAuth()) return;
+        handleSettingsImportChunk();
+      });
   // Diagnostic endpoints registered in diag_api.cpp
   server_on_versioned("/api/factoryreset", HTTP_POST, []() {
     if (!requireAuth()) return;
@@ -0,0 +1,49 @@
+#pragma once
+// seqlock.h — single-writer sequence lock for publishing small structs from
+// the audio task to readers on other tasks/cores (header-only, no RTOS
+// dependencies).
+//
+// The writer makes the sequence odd, updates the data in place and makes it
+// even again; it never waits on a reader. A reader copies what it needs
+// between seqlock_read_begin() and seqlock_read_retry() and starts over when
+// a write overlapped (odd sequence at the start, or a different one at the
+// end). Nothing masks interrupts, and a reader can copy one field or one
+// lane instead of the whole struct:
+//
+//     uint32_t s;
+//     do {
+//         s = seqlock_read_begin(lock);
+//         v = shared.adc[lane].dBFS;
+//     } while (seqlock_read_retry(lock, s));
+//
+// Rules: one writer per lock at a time, and a reader must never preempt the
+// writer on the writer's core (it would retry until the writer resumes). The
+// audio task is the highest-priority task on Core 1, so readers anywhere
+// else are safe.
+
+#include <stdint.h>
+
+struct Seqlock {
+    uint32_t seq;                   // Odd while a write is in progress
+};
+
+static inline void seqlock_write_begin(Seqlock &l) {
+    uint32_t s = __atomic_load_n(&l.seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&l.seq, s + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);    // Odd sequence before any data store
+}
+
+static inline void seqlock_write_end(Seqlock &l) {
+    uint32_t s = __atomic_load_n(&l.seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&l.seq, s + 1, __ATOMIC_RELEASE);   // Data stores before even sequence
+}
+
+static inline uint32_t seqlock_read_begin(const Seqlock &l) {
+    return __atomic_load_n(&l.seq, __ATOMIC_ACQUIRE);
+}
+
+// True when the copy taken since seqlock_read_begin() may be torn
+static inline bool seqlock_read_retry(const Seqlock &l, uint32_t start) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);    // Data loads before the re-check
+    return (start & 1u) || __atomic_load_n(&l.seq, __ATOMIC_RELAXED) != start;
+}
@@ -12,6 +12,14 @@
 #include "utils.h"
 #include "wifi_manager.h"
 #include "http_security.h"
+#include "config_snapshot.h"
+#include "psram_alloc.h"
+#include "settings_stream.h"
+#include "audio_pipeline.h"
+#ifdef DSP_ENABLED
+#include "dsp_api.h"
+#include "output_dsp.h"
+#endif
 #ifdef DAC_ENABLED
 #include "dac_hal.h"
 #include "hal/hal_device_manager.h"
@@ -151,6 +159,168 @@ static void applySettingsFromJson(const JsonDocument &doc) {
   if (doc["hostname"].is<const char*>()) strlcpy(appState.ethernet.hostname, doc["hostname"].as<const char*>(), sizeof(appState.ethernet.hostname));
 }
 
+// ===== Binary Settings Snapshot =====
+// Fixed-layout image of the general settings, persisted A/B via
+// config_snapshot. Layout is append-only: add fields at the end only, so an
+// older (shorter) image still decodes and new fields keep their defaults.
+// Bump SETTINGS_SNAPSHOT_SCHEMA only for incompatible changes — the boot
+// path then falls back to /config.json once and re-saves.
+#define SETTINGS_SNAPSHOT_SCHEMA 1
+
+struct SettingsSnapshot {
+  int32_t  timezoneOffset;
+  int32_t  dstOffset;
+  uint32_t hwStatsInterval;
+  uint32_t screenTimeout;
+  uint32_t dimTimeout;
+  uint16_t audioRate;
+  uint8_t  autoUpdate;
+  uint8_t  darkMode;
+  uint8_t  certValidation;
+  uint8_t  autoAP;
+  uint8_t  bootAnim;
+  uint8_t  bootAnimStyle;
+  uint8_t  buzzer;
+  uint8_t  buzzerVol;
+  uint8_t  backlight;
+  uint8_t  dimBright;
+  uint8_t  dimEnabled;
+  uint8_t  vuMeter;
+  uint8_t  waveform;
+  uint8_t  spectrum;
+  uint8_t  debugMode;
+  uint8_t  debugSerial;
+  uint8_t  debugHwStats;
+  uint8_t  debugI2s;
+  uint8_t  debugTasks;
+  uint8_t  fftWindow;
+  uint8_t  usbAudio;
+  uint8_t  ethUseStaticIP;
+  uint8_t  adcEnabled[8];
+  char     ethStaticIP[40];
+  char     ethSubnet[40];
+  char     ethGateway[40];
+  char     ethDns1[40];
+  char     ethDns2[40];
+  char     hostname[64];
+};
+static_assert(AUDIO_PIPELINE_MAX_INPUTS <= 8, "SettingsSnapshot.adcEnabled too small");
+static_assert(sizeof(SettingsSnapshot) <= CONFIG_SNAPSHOT_MAX_BYTES, "SettingsSnapshot too large");
+
+static void packSettingsSnapshot(SettingsSnapshot &s) {
+  memset(&s, 0, sizeof(s));
+  s.timezoneOffset  = appState.general.timezoneOffset;
+  s.dstOffset       = appState.general.dstOffset;
+  s.hwStatsInterval = appState.debug.hardwareStatsInterval;
+  s.screenTimeout   = appState.display.screenTimeout;
+  s.dimTimeout      = appState.display.dimTimeout;
+  s.audioRate       = appState.audio.updateRate;
+  s.autoUpdate      = appState.ota.autoUpdateEnabled;
+  s.darkMode        = appState.general.darkMode;
+  s.certValidation  = appState.general.enableCertValidation;
+  s.autoAP          = appState.wifi.autoAPEnabled;
+#ifdef GUI_ENABLED
+  s.bootAnim        = appState.bootAnimEnabled;
+  s.bootAnimStyle   = (uint8_t)appState.bootAnimStyle;
+#else
+  s.bootAnim        = 1;
+#endif
+  s.buzzer          = appState.buzzer.enabled;
+  s.buzzerVol       = (uint8_t)appState.buzzer.volume;
+  s.backlight       = appState.display.backlightBrightness;
+  s.dimBright       = appState.display.dimBrightness;
+  s.dimEnabled      = appState.display.dimEnabled;
+  s.vuMeter         = appState.audio.vuMeterEnabled;
+  s.waveform        = appState.audio.waveformEnabled;
+  s.spectrum        = appState.audio.spectrumEnabled;
+  s.debugMode       = appState.debug.debugMode;
+  s.debugSerial     = (uint8_t)appState.debug.serialLevel;
+  s.debugHwStats    = appState.debug.hwStats;
+  s.debugI2s        = appState.debug.i2sMetrics;
+  s.debugTasks      = appState.debug.taskMonitor;
+  s.fftWindow       = (uint8_t)appState.audio.fftWindowType;
+#ifdef USB_AUDIO_ENABLED
+  s.usbAudio        = appState.usbAudio.enabled;
+#endif
+  s.ethUseStaticIP  = appState.ethernet.useStaticIP;
+  for (int i = 0; i < AUDIO_PIPELINE_MAX_INPUTS; i++) s.adcEnabled[i] = appState.audio.adcEnabled[i];
+  strlcpy(s.ethStaticIP, appState.ethernet.staticIP, sizeof(s.ethStaticIP));
+  strlcpy(s.ethSubnet, appState.ethernet.staticSubnet, sizeof(s.ethSubnet));
+  strlcpy(s.ethGateway, appState.ethernet.staticGateway, sizeof(s.ethGateway));
+  strlcpy(s.ethDns1, appState.ethernet.staticDns1, sizeof(s.ethDns1));
+  strlcpy(s.ethDns2, appState.ethernet.staticDns2, sizeof(s.ethDns2));
+  strlcpy(s.hostname, appState.ethernet.hostname, sizeof(s.hostname));
+}
+
+// The image is CRC-checked and written only by packSettingsSnapshot(), so
+// decode is a plain copy; enum-like fields are still range-guarded.
+static void applySettingsSnapshot(const SettingsSnapshot &s) {
+  appState.general.timezoneOffset        = s.timezoneOffset;
+  appState.general.dstOffset             = s.dstOffset;
+  appState.debug.hardwareStatsInterval   = s.hwStatsInterval;
+  appState.display.screenTimeout         = s.screenTimeout;
+  appState.display.dimTimeout            = s.dimTimeout;
+  appState.audio.updateRate              = s.audioRate;
+  appState.ota.autoUpdateEnabled         = s.autoUpdate;
+  appState.general.darkMode              = s.darkMode;
+  appState.general.enableCertValidation  = s.certValidation;
+  appState.wifi.autoAPEnabled            = s.autoAP;
+#ifdef GUI_ENABLED
+  appState.bootAnimEnabled               = s.bootAnim;
+  if (s.bootAnimStyle <= 5) appState.bootAnimStyle = s.bootAnimStyle;
+#endif
+  appState.buzzer.enabled                = s.buzzer;
+  if (s.buzzerVol <= 2) appState.buzzer.volume = s.buzzerVol;
+  if (s.backlight >= 1) appState.display.backlightBrightness = s.backlight;
+  appState.display.dimBrightness         = s.dimBright;
+  appState.display.dimEnabled            = s.dimEnabled;
+  appState.audio.vuMeterEnabled          = s.vuMeter;
+  appState.audio.waveformEnabled         = s.waveform;
+  appState.audio.spectrumEnabled         = s.spectrum;
+  appState.debug.debugMode               = s.debugMode;
+  if (s.debugSerial <= 3) appState.debug.serialLevel = s.debugSerial;
+  appState.debug.hwStats                 = s.debugHwStats;
+  appState.debug.i2sMetrics              = s.debugI2s;
+  appState.debug.taskMonitor             = s.debugTasks;
+  if (s.fftWindow < FFT_WINDOW_COUNT) appState.audio.fftWindowType = (FftWindowType)s.fftWindow;
+#ifdef USB_AUDIO_ENABLED
+  appState.usbAudio.enabled              = s.usbAudio;
+#endif
+  appState.ethernet.useStaticIP          = s.ethUseStaticIP;
+  for (int i = 0; i < AUDIO_PIPELINE_MAX_INPUTS; i++) appState.audio.adcEnabled[i] = s.adcEnabled[i];
+  strlcpy(appState.ethernet.staticIP, s.ethStaticIP, sizeof(appState.ethernet.staticIP));
+  strlcpy(appState.ethernet.staticSubnet, s.ethSubnet, sizeof(appState.ethernet.staticSubnet));
+  strlcpy(appState.ethernet.staticGateway, s.ethGateway, sizeof(appState.ethernet.staticGateway));
+  strlcpy(appState.ethernet.staticDns1, s.ethDns1, sizeof(appState.ethernet.staticDns1));
+  strlcpy(appState.ethernet.staticDns2, s.ethDns2, sizeof(appState.ethernet.staticDns2));
+  strlcpy(appState.ethernet.hostname, s.hostname, sizeof(appState.ethernet.hostname));
+}
+
+// Try loading settings from the A/B binary snapshot
+static bool loadSettingsSnapshot() {
+  SettingsSnapshot snap;
+  packSettingsSnapshot(snap);  // Defaults for fields newer than the stored image
+  size_t len = 0;
+  ConfigSnapshotResult r = config_snapshot_load(SETTINGS_SNAPSHOT_SCHEMA, &snap, sizeof(snap), &len);
+  ConfigSnapshotStats st = config_snapshot_get_stats();
+  if (r != CFG_SNAP_OK) {
+    if (r == CFG_SNAP_CORRUPT) LOG_W("[Settings] Settings snapshot corrupt in both slots");
+    if (r == CFG_SNAP_SCHEMA) LOG_W("[Settings] Settings snapshot schema changed, falling back");
+    return false;
+  }
+  snap.ethStaticIP[sizeof(snap.ethStaticIP) - 1] = '\0';
+  snap.ethSubnet[sizeof(snap.ethSubnet) - 1] = '\0';
+  snap.ethGateway[sizeof(snap.ethGateway) - 1] = '\0';
+  snap.ethDns1[sizeof(snap.ethDns1) - 1] = '\0';
+  snap.ethDns2[sizeof(snap.ethDns2) - 1] = '\0';
+  snap.hostname[sizeof(snap.hostname) - 1] = '\0';
+  applySettingsSnapshot(snap);
+  if (st.fallbacks > 0) LOG_W("[Settings] Newest settings snapshot invalid, using previous generation");
+  LOG_I("[Settings] Settings snapshot gen %lu loaded (slot %c, %u bytes)",
+        (unsigned long)st.generation, st.activeSlot == 0 ? 'A' : 'B', (unsigned)len);
+  return true;
+}
+
 // Flag set by loadSettingsJson() when the JSON config contains an "mqtt" section.
 // loadMqttSettings() checks this to skip /mqtt_config.txt when already loaded.
 static bool _mqttLoadedFromJson = false;
@@ -337,6 +507,9 @@ static bool loadSettingsLegacy() {
   return true;
 }
 
+static bool loadSettingsStores();
+static void replayInterruptedImport();
+
 bool loadSettings() {
   // Recovery: if a .tmp file exists without config.json, the rename was
   // interrupted — complete it now
@@ -344,21 +517,46 @@ bool loadSettings() {
     LittleFS.rename("/config.json.tmp", "/config.json");
   }
 
-  // 1. Try JSON format first
+  // Recovery: a settings import committed but not finished before the last
+  // reset — promote its files now (or discard an uncommitted upload); its
+  // appState sections are re-applied over whatever is loaded below
+  bool resumed = settings_import_resume();
+  bool loaded = loadSettingsStores();
+  if (resumed) {
+    replayInterruptedImport();
+    settings_import_clear();
+    LOG_W("[Settings] Completed interrupted settings import");
+  }
+  return loaded || resumed;
+}
+
+static bool loadSettingsStores() {
+  // 1. Binary A/B snapshot — the normal boot path
+  if (loadSettingsSnapshot()) {
+    loadNvsSettings();
+    return true;
+  }
+
+  // 2. JSON config from earlier firmware — migrate to the snapshot
+  //    (config.json preserved as fallback, like settings.txt)
   if (loadSettingsJson()) {
+    LOG_I("[Settings] Migrating config.json -> binary snapshot");
     loadNvsSettings();
+    saveSettings();
+    // MQTT fields only lived in config.json — keep them once it is no longer read
+    if (_mqttLoadedFromJson) saveMqttSettings();
     return true;
   }
 
-  // 2. Fall back to legacy text format
+  // 3. Fall back to legacy text format
   if (loadSettingsLegacy()) {
-    LOG_I("[Settings] Migrating settings.txt -> config.json");
+    LOG_I("[Settings] Migrating settings.txt -> binary snapshot");
     loadNvsSettings();
-    saveSettings();  // Auto-migrate to JSON (old file preserved)
+    saveSettings();  // Auto-migrate (old file preserved)
     return true;
   }
 
-  // 3. No settings found — use defaults
+  // 4. No settings found — use defaults
   loadNvsSettings();
   return false;
 }
@@ -381,71 +579,17 @@ void checkDeferredSettingsSave() {
 }
 
 void saveSettings() {
-  JsonDocument doc;
-  doc["version"] = 1;
-  doc["autoUpdate"] = appState.ota.autoUpdateEnabled;
-  doc["timezone"] = appState.general.timezoneOffset;
-  doc["dst"] = appState.general.dstOffset;
-  doc["darkMode"] = appState.general.darkMode;
-  doc["certValidation"] = appState.general.enableCertValidation;
-  doc["hwStatsInterval"] = appState.debug.hardwareStatsInterval;
-  doc["autoAP"] = appState.wifi.autoAPEnabled;
-#ifdef GUI_ENABLED
-  doc["bootAnim"] = appState.bootAnimEnabled;
-  doc["bootAnimStyle"] = appState.bootAnimStyle;
-#else
-  doc["bootAnim"] = true;
-  doc["bootAnimStyle"] = 0;
-#endif
-  doc["screenTimeout"] = appState.display.screenTimeout;
-  doc["buzzer"] = appState.buzzer.enabled;
-  doc["buzzerVol"] = appState.buzzer.volume;
-  doc["backlight"] = appState.display.backlightBrightness;
-  doc["dimTimeout"] = appState.display.dimTimeout;
-  doc["dimBright"] = appState.display.dimBrightness;
-  doc["dimEnabled"] = appState.display.dimEnabled;
-  doc["audioRate"] = appState.audio.updateRate;
-  doc["vuMeter"] = appState.audio.vuMeterEnabled;
-  doc["waveform"] = appState.audio.waveformEnabled;
-  doc["spectrum"] = appState.audio.spectrumEnabled;
-  doc["debugMode"] = appState.debug.debugMode;
-  doc["debugSerial"] = appState.debug.serialLevel;
-  doc["debugHwStats"] = appState.debug.hwStats;
-  doc["debugI2s"] = appState.debug.i2sMetrics;
-  doc["debugTasks"] = appState.debug.taskMonitor;
-  doc["fftWindow"] = (int)appState.audio.fftWindowType;
-  {
-    JsonArray adcArr = doc["adcEnabled"].to<JsonArray>();
-    for (int i = 0; i < AUDIO_PIPELINE_MAX_INPUTS; i++) adcArr.add(appState.audio.adcEnabled[i]);
-  }
-#ifdef USB_AUDIO_ENABLED
-  doc["usbAudio"] = appState.usbAudio.enabled;
-#else
-  doc["usbAudio"] = false;
-#endif
-
-  // Ethernet configuration (config only — not runtime status)
-  doc["ethUseStaticIP"] = appState.ethernet.useStaticIP;
-  doc["ethStaticIP"]    = appState.ethernet.staticIP;
-  doc["ethSubnet"]      = appState.ethernet.staticSubnet;
-  doc["ethGateway"]     = appState.ethernet.staticGateway;
-  doc["ethDns1"]        = appState.ethernet.staticDns1;
-  doc["ethDns2"]        = appState.ethernet.staticDns2;
-  doc["hostname"]       = appState.ethernet.hostname;
-
-  // Atomic write: write to .tmp then rename
-  File file = LittleFS.open("/config.json.tmp", "w");
-  if (!file) {
-    LOG_E("[Settings] Failed to open config.json.tmp for writing");
-    return;
+  // A/B snapshot: the inactive slot is written, the live one is never
+  // removed, so there is no window without a valid config on flash
+  SettingsSnapshot snap;
+  packSettingsSnapshot(snap);
+  ConfigSnapshotResult r = config_snapshot_save(SETTINGS_SNAPSHOT_SCHEMA, &snap, sizeof(snap));
+  if (r != CFG_SNAP_OK) {
+    LOG_E("[Settings] Failed to write settings snapshot (%d)", (int)r);
+  } else {
+    LOG_I("[Settings] Settings saved (snapshot gen %lu)",
+          (unsigned long)config_snapshot_get_stats().generation);
   }
-  serializeJson(doc, file);
-  file.close();
-
-  // Rename atomically (old settings.txt preserved as fallback)
-  LittleFS.remove("/config.json");
-  LittleFS.rename("/config.json.tmp", "/config.json");
-  LOG_I("[Settings] Settings saved to config.json");
 
   // Save NVS settings (survive LittleFS format)
   {
@@ -1060,9 +1204,72 @@ void handleSettingsUpdate() {
   server_send(200, "application/json", json);
 }
 
+// ===== Streaming Export / Import =====
+// Export is sent with chunked transfer through one SETTINGS_STREAM_CHUNK_BYTES
+// buffer; file-backed sections are copied from LittleFS without parsing.
+// Import is received through the raw upload handler and staged per section
+// (see settings_stream.h), so neither direction holds the whole file in RAM.
+
+// ArduinoJson custom writer — serializes straight into the export chunk buffer
+struct SettingsJsonWriter {
+  SettingsExportWriter *w;
+  size_t write(uint8_t c) {
+    return settings_writer_write(w, (const char *)&c, 1) ? 1 : 0;
+  }
+  size_t write(const uint8_t *s, size_t n) {
+    return settings_writer_write(w, (const char *)s, n) ? n : 0;
+  }
+};
+
+static bool exportSinkToClient(void *ctx, const char *data, size_t len) {
+  (void)ctx;
+  server.sendContent(data, len);
+  return server.client().connected();
+}
+
+// Pretty-printed like the pre-streaming export; file-backed sections are
+// copied as stored
+static void exportJsonValue(SettingsExportWriter *w, JsonVariantConst value) {
+  SettingsJsonWriter out = { w };
+  serializeJsonPretty(value, out);
+}
+
+// Writes `"key": [file0, file1, ...]` with `{}` placeholders so indices stay
+// aligned with channel numbers on import.
+static void exportFileArray(SettingsExportWriter *w, const char *key,
+                            const char *pathFmt, int count) {
+  settings_writer_begin_section(w, key);
+  settings_writer_print(w, "[");
+  for (int ch = 0; ch < count; ch++) {
+    char path[32];
+    snprintf(path, sizeof(path), pathFmt, ch);
+    if (ch > 0) settings_writer_print(w, ",");
+    settings_writer_copy_file(w, path);
+  }
+  settings_writer_print(w, "]");
+}
+
+// DSP, output DSP and the matrix persist as binary snapshots; their JSON
+// files are the export/import format, so bring them up to date first. On
+// import this also keeps sections absent from a partial file current.
+static void writeJsonConfigFiles() {
+#ifdef DSP_ENABLED
+  dsp_settings_write_json();
+  output_dsp_write_json_all();
+#endif
+  audio_pipeline_write_matrix_json();
+}
+
 void handleSettingsExport() {
   LOG_I("[Settings] Settings export requested via web interface");
 
+  char *chunk = (char *)psram_alloc(SETTINGS_STREAM_CHUNK_BYTES, 1, "settings_export");
+  if (!chunk) {
+    server_send(503, "application/json",
+                "{\"success\": false, \"message\": \"Insufficient memory\"}");
+    return;
+  }
+
   JsonDocument doc;
 
   // Device info
@@ -1184,17 +1391,33 @@ void handleSettingsExport() {
   doc["exportInfo"]["timestamp"] = timestamp;
   doc["exportInfo"]["version"] = "2.0";
 
+  // Send as downloadable JSON file — chunked, total length is not known up front
+  server.sendHeader("Content-Disposition",
+                    "attachment; filename=\"device-settings.json\"");
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server_send(200, "application/json", "");
+
+  SettingsExportWriter w;
+  settings_writer_init(&w, chunk, SETTINGS_STREAM_CHUNK_BYTES, exportSinkToClient, nullptr);
+  for (JsonPairConst kv : doc.as<JsonObjectConst>()) {
+    settings_writer_begin_section(&w, kv.key().c_str());
+    exportJsonValue(&w, kv.value());
+  }
+  doc.clear();
+
 #ifdef DAC_ENABLED
-  // HAL device configs — iterate all valid device slots
+  // HAL device configs — iterate all valid device slots, one small document each
   {
     HalDeviceManager& mgr = HalDeviceManager::instance();
-    JsonArray halArr = doc["halDevices"].to<JsonArray>();
+    settings_writer_begin_section(&w, "halDevices");
+    settings_writer_print(&w, "[");
+    bool first = true;
     for (uint8_t i = 0; i < HAL_MAX_DEVICES; i++) {
       HalDevice* dev = mgr.getDevice(i);
       HalDeviceConfig* cfg = mgr.getConfig(i);
       if (!dev || !cfg || !cfg->valid) continue;
 
-      JsonObject obj = halArr.add<JsonObject>();
+      JsonDocument obj;
       obj["slot"] = i;
       obj["compatible"] = dev->getDescriptor().compatible;
       obj["i2cAddr"] = cfg->i2cAddr;
@@ -1207,141 +1430,123 @@ void handleSettingsExport() {
       obj["filterMode"] = cfg->filterMode;
       obj["sampleRate"] = cfg->sampleRate;
       obj["bitDepth"] = cfg->bitDepth;
+      if (!first) settings_writer_print(&w, ",");
+      first = false;
+      exportJsonValue(&w, obj.as<JsonVariantConst>());
     }
+    settings_writer_print(&w, "]");
   }
 
-  // Custom device schemas from /hal/custom/ directory
+  // Custom device schemas from /hal/custom/ directory — copied verbatim
 #ifndef NATIVE_TEST
   {
-    JsonArray schemas = doc["halCustomSchemas"].to<JsonArray>();
+    settings_writer_begin_section(&w, "halCustomSchemas");
+    settings_writer_print(&w, "[");
+    bool first = true;
     if (LittleFS.exists("/hal/custom")) {
       File dir = LittleFS.open("/hal/custom");
       if (dir && dir.isDirectory()) {
         File f = dir.openNextFile();
         while (f) {
           if (!f.isDirectory()) {
-            String content = f.readString();
-            JsonDocument schemaDoc;
-            if (deserializeJson(schemaDoc, content) == DeserializationError::Ok) {
-              schemas.add(schemaDoc.as<JsonObject>());
+            String path = f.path();
+            f.close();
+            if (settings_stream_file_is_json_object(path.c_str())) {
+              if (!first) settings_writer_print(&w, ",");
+              first = false;
+              settings_writer_copy_file(&w, path.c_str());
             }
           }
           f = dir.openNextFile();
         }
       }
     }
+    settings_writer_print(&w, "]");
   }
 #endif // NATIVE_TEST
 #endif // DAC_ENABLED
 
   // DSP global config
-  {
-    File dspFile = LittleFS.open("/dsp_global.json", "r");
-    if (dspFile && dspFile.size() > 0) {
-      JsonDocument dspDoc;
-      if (deserializeJson(dspDoc, dspFile) == DeserializationError::Ok) {
-        doc["dspGlobal"] = dspDoc.as<JsonObject>();
-      }
-      dspFile.close();
-    }
-  }
-
-  // DSP per-channel configs
-  {
-    JsonArray chArr = doc["dspChannels"].to<JsonArray>();
-    for (int ch = 0; ch < 4; ch++) {
-      char path[24];
-      snprintf(path, sizeof(path), "/dsp_ch%d.json", ch);
-      File chFile = LittleFS.open(path, "r");
-      if (chFile && chFile.size() > 0) {
-        JsonDocument chDoc;
-        if (deserializeJson(chDoc, chFile) == DeserializationError::Ok) {
-          chArr.add(chDoc.as<JsonObject>());
-        } else {
-          chArr.add(JsonObject()); // Placeholder for missing/invalid channel
-        }
-        chFile.close();
-      } else {
-        chArr.add(JsonObject()); // Placeholder for missing channel
-        if (chFile) chFile.close();
-      }
-    }
+  writeJsonConfigFiles();
+  if (settings_stream_file_is_json_object("/dsp_global.json")) {
+    settings_writer_begin_section(&w, "dspGlobal");
+    settings_writer_copy_file(&w, "/dsp_global.json");
   }
 
-  // Output DSP per-channel configs
-  {
-    JsonArray outArr = doc["outputDsp"].to<JsonArray>();
-    for (int ch = 0; ch < 16; ch++) {
-      char path[32];
-      snprintf(path, sizeof(path), "/output_dsp_ch%d.json", ch);
-      File outFile = LittleFS.open(path, "r");
-      if (outFile && outFile.size() > 0) {
-        JsonDocument outDoc;
-        if (deserializeJson(outDoc, outFile) == DeserializationError::Ok) {
-          outArr.add(outDoc.as<JsonObject>());
-        } else {
-          outArr.add(JsonObject());
-        }
-        outFile.close();
-      } else {
-        outArr.add(JsonObject());
-        if (outFile) outFile.close();
-      }
-    }
-  }
+  // DSP per-channel and output DSP per-channel configs
+  exportFileArray(&w, "dspChannels", "/dsp_ch%d.json", 4);
+  exportFileArray(&w, "outputDsp", "/output_dsp_ch%d.json", 16);
 
   // Pipeline matrix config
-  {
-    File matFile = LittleFS.open("/pipeline_matrix.json", "r");
-    if (matFile && matFile.size() > 0) {
-      JsonDocument matDoc;
-      if (deserializeJson(matDoc, matFile) == DeserializationError::Ok) {
-        doc["pipelineMatrix"] = matDoc.as<JsonObject>();
-      }
-      matFile.close();
-    }
+  if (settings_stream_file_is_json_object("/pipeline_matrix.json")) {
+    settings_writer_begin_section(&w, "pipelineMatrix");
+    settings_writer_copy_file(&w, "/pipeline_matrix.json");
   }
 
-  String json;
-  serializeJsonPretty(doc, json);
+  bool ok = settings_writer_end(&w);
+  server.sendContent("");  // Terminating zero-length chunk
+  psram_free(chunk, "settings_export");
 
-  // Send as downloadable JSON file
-  server.sendHeader("Content-Disposition",
-                    "attachment; filename=\"device-settings.json\"");
-  server_send(200, "application/json", json);
-
-  LOG_I("[Settings] Settings exported successfully (v2.0)");
+  if (ok) {
+    LOG_I("[Settings] Settings exported successfully (v2.0, %lu bytes)",
+          (unsigned long)w.totalBytes);
+  } else {
+    LOG_W("[Settings] Settings export aborted — client disconnected");
+  }
 }
 
-void handleSettingsImport() {
-  LOG_I("[Settings] Settings import requested via web interface");
+// Import session state — shared by the raw chunk handler and the completion
+// handler (both run on the web server task).
+static const char *_importError = nullptr;
+static bool _importStaged = false;
+
+// appState sections — small, applied from one document as before
+static const char *const IMPORT_CORE_SECTIONS[] = {
+  "exportInfo", "wifi", "accessPoint", "settings", "smartSensing",
+  "signalGenerator", "dacOutput", "inputNames", "mqtt"
+};
+
+// Syntax-only check of a staged section: the filter discards every value, so
+// validation costs no document memory regardless of section size.
+static bool validateImportUnit(const char *data, size_t len) {
+  JsonDocument filter;
+  filter.set(false);
+  JsonDocument sink;
+  return deserializeJson(sink, data, len, DeserializationOption::Filter(filter)) ==
+         DeserializationError::Ok;
+}
 
-  if (!server.hasArg("plain")) {
-    server_send(400, "application/json",
-                "{\"success\": false, \"message\": \"No data received\"}");
-    return;
+static const char *importErrorMessage(uint8_t status) {
+  switch (status) {
+  case SETTINGS_SPLIT_ERR_OVERFLOW:
+    return "Settings section too large";
+  case SETTINGS_SPLIT_ERR_REJECTED:
+    return "Invalid JSON in settings section";
+  default:
+    return "Invalid JSON format";
   }
+}
 
-  JsonDocument doc;
-  DeserializationError error = deserializeJson(doc, server.arg("plain"));
-
-  if (error) {
-    LOG_E("[Settings] JSON parsing failed: %s", error.c_str());
-    server_send(400, "application/json",
-                "{\"success\": false, \"message\": \"Invalid JSON format\"}");
-    return;
-  }
+static void sendImportError(int code, const char *message) {
+  JsonDocument resp;
+  resp["success"] = false;
+  resp["message"] = message;
+  String json;
+  serializeJson(resp, json);
+  server_send(code, "application/json", json);
+}
 
-  // Validate it's a settings export file
-  if (doc["exportInfo"].isNull() || doc["settings"].isNull()) {
-    server_send(
-        400, "application/json",
-        "{\"success\": false, \"message\": \"Invalid settings file format\"}");
-    return;
+// Collects the staged appState sections into one document
+static void readStagedCoreSections(JsonDocument &doc, char *unitBuf) {
+  for (size_t i = 0; i < sizeof(IMPORT_CORE_SECTIONS) / sizeof(IMPORT_CORE_SECTIONS[0]); i++) {
+    const char *key = IMPORT_CORE_SECTIONS[i];
+    if (settings_import_read_unit(key, -1, unitBuf, SETTINGS_STREAM_SECTION_MAX) <= 0) continue;
+    JsonDocument section;
+    if (deserializeJson(section, unitBuf) == DeserializationError::Ok) doc[key] = section;
   }
+}
 
-  LOG_I("[Settings] Importing settings");
-
+static void importCoreSections(JsonDocument &doc) {
   // Import WiFi settings
   if (!doc["wifi"].isNull()) {
     if (doc["wifi"]["ssid"].is<String>()) {
@@ -1688,153 +1893,209 @@ void handleSettingsImport() {
     }
     saveInputNames();
   }
+}
 
-  // Note: Certificate import removed - now using Mozilla certificate bundle
-
-  // ===== v2.0 sections (backward compatible — skipped for v1.0 exports) =====
-  const char* exportVersion = doc["exportInfo"]["version"] | "1.0";
-  bool isV2 = (strcmp(exportVersion, "2.0") == 0);
+// Boot-time completion of an import that committed but was interrupted:
+// the staged appState sections are applied over the stores just loaded.
+// HAL device sections are not replayed — the HAL registers after this.
+static void replayInterruptedImport() {
+  char *unitBuf = (char *)psram_alloc(SETTINGS_STREAM_SECTION_MAX, 1, "settings_import");
+  if (!unitBuf) {
+    LOG_E("[Settings] Insufficient memory to replay interrupted import");
+    return;
+  }
+  JsonDocument doc;
+  readStagedCoreSections(doc, unitBuf);
+  psram_free(unitBuf, "settings_import");
+  if (!doc["settings"].isNull()) importCoreSections(doc);
+}
 
-  if (isV2) {
 #ifdef DAC_ENABLED
-    // Import custom device schemas — must happen before HAL device configs
-    if (!doc["halCustomSchemas"].isNull() && doc["halCustomSchemas"].is<JsonArray>()) {
-      JsonArray schemas = doc["halCustomSchemas"].as<JsonArray>();
-      LittleFS.mkdir("/hal");
-      LittleFS.mkdir("/hal/custom");
-      for (JsonObject schema : schemas) {
-        const char* compat = schema["compatible"] | "";
-        if (strlen(compat) == 0) continue;
-        // Write schema to /hal/custom/<compatible>.json
-        char path[64];
-        snprintf(path, sizeof(path), "/hal/custom/%s.json", compat);
-        String schemaStr;
-        serializeJson(schema, schemaStr);
-        File f = LittleFS.open(path, "w");
-        if (f) {
-          f.print(schemaStr);
-          f.close();
-          LOG_D("[Settings] Imported custom schema: %s", compat);
-        }
-      }
-      // Reload custom device registry
-      hal_load_custom_devices();
-      LOG_I("[Settings] Custom device schemas imported (%d)", schemas.size());
-    }
-
-    // Import HAL device configs
-    if (!doc["halDevices"].isNull() && doc["halDevices"].is<JsonArray>()) {
-      HalDeviceManager& mgr = HalDeviceManager::instance();
-      JsonArray halArr = doc["halDevices"].as<JsonArray>();
-      for (JsonObject obj : halArr) {
-        uint8_t slot = obj["slot"] | 255;
-        if (slot >= HAL_MAX_DEVICES) continue;
-
-        HalDevice* dev = mgr.getDevice(slot);
-        if (!dev) continue; // Slot not populated on this device
-
-        HalDeviceConfig cfg;
-        memset(&cfg, 0, sizeof(cfg));
-        cfg.valid = true;
-        cfg.i2cAddr = obj["i2cAddr"] | 0;
-        cfg.i2cBusIndex = obj["i2cBusIndex"] | 0;
-        cfg.i2sPort = obj["i2sPort"] | 255;
-        cfg.volume = obj["volume"] | 100;
-        cfg.mute = obj["mute"] | false;
-        cfg.enabled = obj["enabled"] | true;
-        cfg.filterMode = obj["filterMode"] | 0;
-        cfg.sampleRate = obj["sampleRate"] | 0;
-        cfg.bitDepth = obj["bitDepth"] | 0;
-        const char* label = obj["userLabel"] | "";
-        hal_safe_strcpy(cfg.userLabel, sizeof(cfg.userLabel), label);
-
-        // Preserve pin assignments from current config (not exported)
-        HalDeviceConfig* existing = mgr.getConfig(slot);
-        if (existing) {
-          cfg.pinSda = existing->pinSda;
-          cfg.pinScl = existing->pinScl;
-          cfg.pinMclk = existing->pinMclk;
-          cfg.pinData = existing->pinData;
-          cfg.pinBck = existing->pinBck;
-          cfg.pinLrc = existing->pinLrc;
-          cfg.pinFmt = existing->pinFmt;
-          cfg.paControlPin = existing->paControlPin;
-          cfg.gpioA = existing->gpioA;
-          cfg.gpioB = existing->gpioB;
-          cfg.gpioC = existing->gpioC;
-          cfg.gpioD = existing->gpioD;
-          cfg.i2cSpeedHz = existing->i2cSpeedHz;
-          cfg.mclkMultiple = existing->mclkMultiple;
-          cfg.i2sFormat = existing->i2sFormat;
-          cfg.pgaGain = existing->pgaGain;
-          cfg.hpfEnabled = existing->hpfEnabled;
-          cfg.isI2sClockMaster = existing->isI2sClockMaster;
-          cfg.usbPid = existing->usbPid;
-          cfg.i2sMode = existing->i2sMode;
-          cfg.tdmSlots = existing->tdmSlots;
-        }
+// Custom device schemas — must be imported before HAL device configs
+static void importHalCustomSchemas(char *unitBuf) {
+  if (!settings_import_has_unit("halCustomSchemas", 0)) return;
+  LittleFS.mkdir("/hal");
+  LittleFS.mkdir("/hal/custom");
+  int count = 0;
+  for (int i = 0; settings_import_read_unit("halCustomSchemas", i, unitBuf,
+                                            SETTINGS_STREAM_SECTION_MAX) > 0; i++) {
+    JsonDocument schema;
+    if (deserializeJson(schema, unitBuf) != DeserializationError::Ok) continue;
+    const char* compat = schema["compatible"] | "";
+    if (strlen(compat) == 0) continue;
+    // Write schema to /hal/custom/<compatible>.json
+    char path[64];
+    snprintf(path, sizeof(path), "/hal/custom/%s.json", compat);
+    File f = LittleFS.open(path, "w");
+    if (f) {
+      serializeJson(schema, f);
+      f.close();
+      count++;
+      LOG_D("[Settings] Imported custom schema: %s", compat);
+    }
+  }
+  // Reload custom device registry
+  hal_load_custom_devices();
+  LOG_I("[Settings] Custom device schemas imported (%d)", count);
+}
 
-        mgr.setConfig(slot, cfg);
-        hal_save_device_config(slot);
-        LOG_D("[Settings] Imported HAL config for slot %d", slot);
-      }
-      LOG_I("[Settings] HAL device configs imported (%d)", halArr.size());
-    }
+static bool importHalDevice(JsonObject obj) {
+  HalDeviceManager& mgr = HalDeviceManager::instance();
+  uint8_t slot = obj["slot"] | 255;
+  if (slot >= HAL_MAX_DEVICES) return false;
+
+  HalDevice* dev = mgr.getDevice(slot);
+  if (!dev) return false; // Slot not populated on this device
+
+  HalDeviceConfig cfg;
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.valid = true;
+  cfg.i2cAddr = obj["i2cAddr"] | 0;
+  cfg.i2cBusIndex = obj["i2cBusIndex"] | 0;
+  cfg.i2sPort = obj["i2sPort"] | 255;
+  cfg.volume = obj["volume"] | 100;
+  cfg.mute = obj["mute"] | false;
+  cfg.enabled = obj["enabled"] | true;
+  cfg.filterMode = obj["filterMode"] | 0;
+  cfg.sampleRate = obj["sampleRate"] | 0;
+  cfg.bitDepth = obj["bitDepth"] | 0;
+  const char* label = obj["userLabel"] | "";
+  hal_safe_strcpy(cfg.userLabel, sizeof(cfg.userLabel), label);
+
+  // Preserve pin assignments from current config (not exported)
+  HalDeviceConfig* existing = mgr.getConfig(slot);
+  if (existing) {
+    cfg.pinSda = existing->pinSda;
+    cfg.pinScl = existing->pinScl;
+    cfg.pinMclk = existing->pinMclk;
+    cfg.pinData = existing->pinData;
+    cfg.pinBck = existing->pinBck;
+    cfg.pinLrc = existing->pinLrc;
+    cfg.pinFmt = existing->pinFmt;
+    cfg.paControlPin = existing->paControlPin;
+    cfg.gpioA = existing->gpioA;
+    cfg.gpioB = existing->gpioB;
+    cfg.gpioC = existing->gpioC;
+    cfg.gpioD = existing->gpioD;
+    cfg.i2cSpeedHz = existing->i2cSpeedHz;
+    cfg.mclkMultiple = existing->mclkMultiple;
+    cfg.i2sFormat = existing->i2sFormat;
+    cfg.pgaGain = existing->pgaGain;
+    cfg.hpfEnabled = existing->hpfEnabled;
+    cfg.isI2sClockMaster = existing->isI2sClockMaster;
+    cfg.usbPid = existing->usbPid;
+    cfg.i2sMode = existing->i2sMode;
+    cfg.tdmSlots = existing->tdmSlots;
+  }
+
+  mgr.setConfig(slot, cfg);
+  hal_save_device_config(slot);
+  LOG_D("[Settings] Imported HAL config for slot %d", slot);
+  return true;
+}
+
+static void importHalDevices(char *unitBuf) {
+  int count = 0;
+  for (int i = 0; settings_import_read_unit("halDevices", i, unitBuf,
+                                            SETTINGS_STREAM_SECTION_MAX) > 0; i++) {
+    JsonDocument dev;
+    if (deserializeJson(dev, unitBuf) != DeserializationError::Ok) continue;
+    if (importHalDevice(dev.as<JsonObject>())) count++;
+  }
+  if (count > 0) LOG_I("[Settings] HAL device configs imported (%d)", count);
+}
 #endif // DAC_ENABLED
 
-    // Import DSP global config
-    if (!doc["dspGlobal"].isNull()) {
-      File f = LittleFS.open("/dsp_global.json", "w");
-      if (f) {
-        serializeJson(doc["dspGlobal"], f);
-        f.close();
-        LOG_D("[Settings] Imported dspGlobal");
-      }
+void handleSettingsImportChunk() {
+  HTTPRaw &raw = server.raw();
+  if (raw.status == RAW_START) {
+    _importError = nullptr;
+    _importStaged = false;
+    if (!settings_import_begin(validateImportUnit)) {
+      _importError = "Insufficient memory for import";
+      return;
+    }
+    LOG_I("[Settings] Settings import started via web interface");
+  } else if (raw.status == RAW_WRITE) {
+    if (_importError) return;
+    if (!settings_import_feed(raw.buf, raw.currentSize)) {
+      _importError = importErrorMessage(settings_import_get_stats().status);
+      settings_import_abort();
+    }
+  } else if (raw.status == RAW_END) {
+    if (_importError) return;
+    if (settings_import_finish()) {
+      _importStaged = true;
+      SettingsImportStats st = settings_import_get_stats();
+      LOG_D("[Settings] Import staged: %lu bytes, %u sections, largest %lu bytes",
+            (unsigned long)st.bytesIn, st.unitsStaged, (unsigned long)st.maxUnitBytes);
+    } else {
+      _importError = importErrorMessage(settings_import_get_stats().status);
+      settings_import_abort();
     }
+  } else if (raw.status == RAW_ABORTED) {
+    settings_import_abort();
+    _importError = "Upload aborted";
+  }
+}
 
-    // Import DSP channel configs
-    if (!doc["dspChannels"].isNull() && doc["dspChannels"].is<JsonArray>()) {
-      JsonArray chArr = doc["dspChannels"].as<JsonArray>();
-      for (size_t i = 0; i < chArr.size() && i < 4; i++) {
-        if (chArr[i].as<JsonObject>().size() == 0) continue; // Skip empty placeholders
-        char path[24];
-        snprintf(path, sizeof(path), "/dsp_ch%d.json", (int)i);
-        File f = LittleFS.open(path, "w");
-        if (f) {
-          serializeJson(chArr[i], f);
-          f.close();
-          LOG_D("[Settings] Imported dsp_ch%d", (int)i);
-        }
-      }
-    }
+void handleSettingsImportComplete() {
+  if (!_importStaged) {
+    const char *msg = _importError ? _importError : "No data received";
+    LOG_E("[Settings] Settings import failed: %s", msg);
+    settings_import_abort();
+    _importError = nullptr;
+    sendImportError(400, msg);
+    return;
+  }
+  _importStaged = false;
 
-    // Import output DSP channel configs
-    if (!doc["outputDsp"].isNull() && doc["outputDsp"].is<JsonArray>()) {
-      JsonArray outArr = doc["outputDsp"].as<JsonArray>();
-      for (size_t i = 0; i < outArr.size() && i < 16; i++) {
-        if (outArr[i].as<JsonObject>().size() == 0) continue; // Skip empty placeholders
-        char path[32];
-        snprintf(path, sizeof(path), "/output_dsp_ch%d.json", (int)i);
-        File f = LittleFS.open(path, "w");
-        if (f) {
-          serializeJson(outArr[i], f);
-          f.close();
-          LOG_D("[Settings] Imported output_dsp_ch%d", (int)i);
-        }
-      }
-    }
+  // Validate it's a settings export file
+  if (!settings_import_has_unit("exportInfo", -1) ||
+      !settings_import_has_unit("settings", -1)) {
+    settings_import_abort();
+    sendImportError(400, "Invalid settings file format");
+    return;
+  }
 
-    // Import pipeline matrix config
-    if (!doc["pipelineMatrix"].isNull()) {
-      File f = LittleFS.open("/pipeline_matrix.json", "w");
-      if (f) {
-        serializeJson(doc["pipelineMatrix"], f);
-        f.close();
-        LOG_D("[Settings] Imported pipelineMatrix");
-      }
-    }
+  char *unitBuf = (char *)psram_alloc(SETTINGS_STREAM_SECTION_MAX, 1, "settings_import");
+  if (!unitBuf) {
+    settings_import_abort();
+    sendImportError(503, "Insufficient memory for import");
+    return;
+  }
+
+  JsonDocument doc;
+  readStagedCoreSections(doc, unitBuf);
+
+  // ===== v2.0 sections (backward compatible — skipped for v1.0 exports) =====
+  const char* exportVersion = doc["exportInfo"]["version"] | "1.0";
+  bool isV2 = (strcmp(exportVersion, "2.0") == 0);
+
+  // DSP/matrix files are promoted by rename first. The commit marker lets
+  // loadSettings() finish the renames and re-apply the appState sections if
+  // power is lost part-way through.
+  if (isV2) writeJsonConfigFiles();
+  settings_import_mark_commit();
+  if (isV2) {
+    int promoted = settings_import_promote_files();
+    LOG_D("[Settings] Imported %d DSP/pipeline config files", promoted);
   }
 
+  LOG_I("[Settings] Importing settings");
+  importCoreSections(doc);
+  doc.clear();
+
+#ifdef DAC_ENABLED
+  if (isV2) {
+    importHalCustomSchemas(unitBuf);
+    importHalDevices(unitBuf);
+  }
+#endif
+
+  settings_import_clear();
+  psram_free(unitBuf, "settings_import");
+
   LOG_I("[Settings] All settings imported successfully%s", isV2 ? " (v2.0)" : "");
 
   // Send success response
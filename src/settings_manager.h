@@ -33,7 +33,9 @@ void performFactoryReset();
 void handleSettingsGet();
 void handleSettingsUpdate();
 void handleSettingsExport();
-void handleSettingsImport();
+// Streaming import: raw body chunks are staged per section, then committed
+void handleSettingsImportChunk();
+void handleSettingsImportComplete();
 void handleFactoryReset();
 void handleReboot();
 void handleDiagnostics();
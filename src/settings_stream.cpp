@@ -0,0 +1,648 @@
+// settings_stream.cpp — Bounded-memory streaming for settings export/import.
+// See settings_stream.h for the API and the staging/commit protocol.
+
+#include "settings_stream.h"
+#include "psram_alloc.h"
+#include "config_snapshot.h"
+
+#ifdef NATIVE_TEST
+#include "../test/test_mocks/Arduino.h"
+#include "../test/test_mocks/LittleFS.h"
+#else
+#include <Arduino.h>
+#include <LittleFS.h>
+#endif
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// ===== Incremental splitter =====
+
+enum : uint8_t {
+    SP_START = 0,       // Expect '{'
+    SP_KEY_OR_END,      // First member key or '}'
+    SP_KEY_START,       // Key after ','
+    SP_KEY,             // Inside key string
+    SP_COLON,           // Expect ':'
+    SP_VALUE_START,     // First byte of member value
+    SP_VALUE,           // Inside member value
+    SP_AFTER_VALUE,     // Expect ',' or '}'
+    SP_ELEM_START,      // First byte of array element (or ']')
+    SP_ELEM,            // Inside array element
+    SP_AFTER_ELEM,      // Expect ',' or ']'
+    SP_DONE
+};
+
+enum : uint8_t { UNIT_CONTAINER = 0, UNIT_STRING, UNIT_SCALAR };
+
+static inline bool _isWs(uint8_t c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+void settings_splitter_init(SettingsJsonSplitter *sp, char *buf, size_t bufSize,
+                            const char *const *splitKeys, uint8_t splitKeyCount,
+                            SettingsUnitCb onUnit, SettingsKeyFilterCb wantKey, void *ctx) {
+    if (!sp) return;
+    memset(sp, 0, sizeof(*sp));
+    sp->buf = buf;
+    sp->bufSize = bufSize;
+    sp->splitKeys = splitKeys;
+    sp->splitKeyCount = splitKeyCount;
+    sp->onUnit = onUnit;
+    sp->wantKey = wantKey;
+    sp->ctx = ctx;
+    sp->state = SP_START;
+    sp->status = SETTINGS_SPLIT_OK;
+}
+
+static bool _isSplitKey(const SettingsJsonSplitter *sp) {
+    for (uint8_t i = 0; i < sp->splitKeyCount; i++) {
+        if (strcmp(sp->splitKeys[i], sp->key) == 0) return true;
+    }
+    return false;
+}
+
+static uint8_t _unitKind(uint8_t c) {
+    if (c == '{' || c == '[') return UNIT_CONTAINER;
+    if (c == '"') return UNIT_STRING;
+    return UNIT_SCALAR;
+}
+
+static bool _append(SettingsJsonSplitter *sp, uint8_t c) {
+    if (sp->skipping) return true;
+    if (!sp->buf || sp->len + 1 >= sp->bufSize) {
+        sp->status = SETTINGS_SPLIT_ERR_OVERFLOW;
+        return false;
+    }
+    sp->buf[sp->len++] = (char)c;
+    return true;
+}
+
+static bool _emit(SettingsJsonSplitter *sp) {
+    if (sp->skipping) return true;
+    sp->buf[sp->len] = '\0';
+    if (sp->len > sp->maxUnitBytes) sp->maxUnitBytes = (uint32_t)sp->len;
+    int idx = sp->splitting ? sp->index : -1;
+    if (sp->onUnit && !sp->onUnit(sp->ctx, sp->key, idx, sp->buf, sp->len)) {
+        sp->status = SETTINGS_SPLIT_ERR_REJECTED;
+        return false;
+    }
+    return true;
+}
+
+SettingsSplitStatus settings_splitter_feed(SettingsJsonSplitter *sp, const uint8_t *data, size_t len) {
+    if (!sp) return SETTINGS_SPLIT_ERR_SYNTAX;
+    if (sp->status != SETTINGS_SPLIT_OK && sp->status != SETTINGS_SPLIT_DONE) {
+        return (SettingsSplitStatus)sp->status;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = data[i];
+        bool reprocess;
+        do {
+            reprocess = false;
+            switch (sp->state) {
+            case SP_START:
+                if (_isWs(c)) break;
+                if (c != '{') { sp->status = SETTINGS_SPLIT_ERR_SYNTAX; return SETTINGS_SPLIT_ERR_SYNTAX; }
+                sp->state = SP_KEY_OR_END;
+                break;
+
+            case SP_KEY_OR_END:
+            case SP_KEY_START:
+                if (_isWs(c)) break;
+                if (c == '}' && sp->state == SP_KEY_OR_END) {
+                    sp->state = SP_DONE;
+                    sp->status = SETTINGS_SPLIT_DONE;
+                    break;
+                }
+                if (c != '"') { sp->status = SETTINGS_SPLIT_ERR_SYNTAX; return SETTINGS_SPLIT_ERR_SYNTAX; }
+                sp->keyLen = 0;
+                sp->key[0] = '\0';
+                sp->escape = false;
+                sp->skipping = false;
+                sp->state = SP_KEY;
+                break;
+
+            case SP_KEY:
+                if (sp->escape) {
+                    sp->escape = false;
+                } else if (c == '\\') {
+                    sp->escape = true;
+                    sp->skipping = true;  // Escaped keys never match a known section
+                } else if (c == '"') {
+                    sp->key[sp->keyLen] = '\0';
+                    sp->state = SP_COLON;
+                    break;
+                }
+                if (sp->keyLen < SETTINGS_STREAM_KEY_MAX - 1) {
+                    sp->key[sp->keyLen++] = (char)c;
+                } else {
+                    sp->skipping = true;  // Over-long key — unknown by definition
+                }
+                break;
+
+            case SP_COLON:
+                if (_isWs(c)) break;
+                if (c != ':') { sp->status = SETTINGS_SPLIT_ERR_SYNTAX; return SETTINGS_SPLIT_ERR_SYNTAX; }
+                if (!sp->skipping && sp->wantKey && !sp->wantKey(sp->ctx, sp->key)) sp->skipping = true;
+                sp->splitting = false;
+                sp->state = SP_VALUE_START;
+                break;
+
+            case SP_VALUE_START:
+            case SP_ELEM_START:
+                if (_isWs(c)) break;
+                if (sp->state == SP_VALUE_START && c == '[' && _isSplitKey(sp)) {
+                    sp->splitting = true;
+                    sp->index = 0;
+                    sp->state = SP_ELEM_START;
+                    break;
+                }
+                if (sp->state == SP_ELEM_START && c == ']') {
+                    sp->splitting = false;
+                    sp->state = SP_AFTER_VALUE;
+                    break;
+                }
+                if (c == ',' || c == '}' || c == ']' || c == ':') {
+                    sp->status = SETTINGS_SPLIT_ERR_SYNTAX;
+                    return SETTINGS_SPLIT_ERR_SYNTAX;
+                }
+                sp->len = 0;
+                sp->depth = 0;
+                sp->inString = false;
+                sp->escape = false;
+                sp->unitKind = _unitKind(c);
+                sp->state = (sp->state == SP_VALUE_START) ? SP_VALUE : SP_ELEM;
+                reprocess = true;
+                break;
+
+            case SP_VALUE:
+            case SP_ELEM: {
+                bool elem = (sp->state == SP_ELEM);
+                if (sp->unitKind == UNIT_SCALAR && !sp->inString &&
+                    (_isWs(c) || c == ',' || c == '}' || c == ']')) {
+                    if (sp->len == 0 && !sp->skipping) { sp->status = SETTINGS_SPLIT_ERR_SYNTAX; return SETTINGS_SPLIT_ERR_SYNTAX; }
+                    if (!_emit(sp)) return (SettingsSplitStatus)sp->status;
+                    sp->state = elem ? SP_AFTER_ELEM : SP_AFTER_VALUE;
+                    reprocess = true;
+                    break;
+                }
+                if (!_append(sp, c)) return (SettingsSplitStatus)sp->status;
+                if (sp->inString) {
+                    if (sp->escape) sp->escape = false;
+                    else if (c == '\\') sp->escape = true;
+                    else if (c == '"') {
+                        sp->inString = false;
+                        if (sp->unitKind == UNIT_STRING) {
+                            if (!_emit(sp)) return (SettingsSplitStatus)sp->status;
+                            sp->state = elem ? SP_AFTER_ELEM : SP_AFTER_VALUE;
+                        }
+                    }
+                    break;
+                }
+                if (c == '"') {
+                    sp->inString = true;
+                } else if (c == '{' || c == '[') {
+                    sp->depth++;
+                } else if (c == '}' || c == ']') {
+                    if (sp->depth == 0) { sp->status = SETTINGS_SPLIT_ERR_SYNTAX; return SETTINGS_SPLIT_ERR_SYNTAX; }
+                    sp->depth--;
+                    if (sp->depth == 0 && sp->unitKind == UNIT_CONTAINER) {
+                        if (!_emit(sp)) return (SettingsSplitStatus)sp->status;
+                        sp->state = elem ? SP_AFTER_ELEM : SP_AFTER_VALUE;
+                    }
+                }
+                break;
+            }
+
+            case SP_AFTER_ELEM:
+                if (_isWs(c)) break;
+                if (c == ',') {
+                    sp->index++;
+                    sp->state = SP_ELEM_START;
+                } else if (c == ']') {
+                    sp->splitting = false;
+                    sp->state = SP_AFTER_VALUE;
+                } else {
+                    sp->status = SETTINGS_SPLIT_ERR_SYNTAX;
+                    return SETTINGS_SPLIT_ERR_SYNTAX;
+                }
+                break;
+
+            case SP_AFTER_VALUE:
+                if (_isWs(c)) break;
+                if (c == ',') {
+                    sp->state = SP_KEY_START;
+                } else if (c == '}') {
+                    sp->state = SP_DONE;
+                    sp->status = SETTINGS_SPLIT_DONE;
+                } else {
+                    sp->status = SETTINGS_SPLIT_ERR_SYNTAX;
+                    return SETTINGS_SPLIT_ERR_SYNTAX;
+                }
+                break;
+
+            case SP_DONE:
+            default:
+                if (_isWs(c)) break;
+                sp->status = SETTINGS_SPLIT_ERR_SYNTAX;
+                return SETTINGS_SPLIT_ERR_SYNTAX;
+            }
+        } while (reprocess);
+    }
+    return (SettingsSplitStatus)sp->status;
+}
+
+// ===== File structure check =====
+
+bool settings_stream_file_is_json_object(const char *path) {
+    if (!path) return false;
+    File f = LittleFS.open(path, "r");
+    if (!f) return false;
+
+    uint8_t chunk[64];
+    uint32_t depth = 0;
+    bool started = false, closed = false, inString = false, escape = false;
+    bool ok = true;
+    size_t n;
+    while (ok && (n = f.read(chunk, sizeof(chunk))) > 0) {
+        for (size_t i = 0; i < n && ok; i++) {
+            uint8_t c = chunk[i];
+            if (closed) { ok = _isWs(c); continue; }
+            if (!started) {
+                if (_isWs(c)) continue;
+                if (c != '{') { ok = false; continue; }
+                started = true;
+                depth = 1;
+                continue;
+            }
+            if (inString) {
+                if (escape) escape = false;
+                else if (c == '\\') escape = true;
+                else if (c == '"') inString = false;
+                continue;
+            }
+            if (c == '"') inString = true;
+            else if (c == '{' || c == '[') depth++;
+            else if (c == '}' || c == ']') {
+                depth--;
+                if (depth == 0) closed = true;
+            }
+        }
+    }
+    f.close();
+    return ok && closed;
+}
+
+// ===== Export writer =====
+
+void settings_writer_init(SettingsExportWriter *w, char *buf, size_t cap,
+                          SettingsSinkCb sink, void *ctx) {
+    if (!w) return;
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->cap = cap;
+    w->sink = sink;
+    w->ctx = ctx;
+}
+
+bool settings_writer_flush(SettingsExportWriter *w) {
+    if (!w || w->failed) return false;
+    if (w->len == 0) return true;
+    if (!w->sink || !w->sink(w->ctx, w->buf, w->len)) w->failed = true;
+    w->len = 0;
+    return !w->failed;
+}
+
+bool settings_writer_write(SettingsExportWriter *w, const char *data, size_t len) {
+    if (!w || w->failed || !w->buf || w->cap == 0) return false;
+    while (len > 0) {
+        size_t room = w->cap - w->len;
+        size_t n = (len < room) ? len : room;
+        memcpy(w->buf + w->len, data, n);
+        w->len += n;
+        w->totalBytes += (uint32_t)n;
+        data += n;
+        len -= n;
+        if (w->len == w->cap && !settings_writer_flush(w)) return false;
+    }
+    return true;
+}
+
+bool settings_writer_print(SettingsExportWriter *w, const char *str) {
+    return str ? settings_writer_write(w, str, strlen(str)) : false;
+}
+
+bool settings_writer_begin_section(SettingsExportWriter *w, const char *key) {
+    if (!w || !key) return false;
+    settings_writer_print(w, w->sections == 0 ? "{\n\"" : ",\n\"");
+    settings_writer_print(w, key);
+    w->sections++;
+    return settings_writer_print(w, "\": ");
+}
+
+bool settings_writer_copy_file(SettingsExportWriter *w, const char *path) {
+    if (!w || w->failed) return false;
+    if (!settings_stream_file_is_json_object(path)) {
+        settings_writer_print(w, "{}");
+        return false;
+    }
+    File f = LittleFS.open(path, "r");
+    if (!f) {
+        settings_writer_print(w, "{}");
+        return false;
+    }
+    // Read straight into the chunk buffer — no intermediate copy
+    bool ok = true;
+    while (ok) {
+        if (w->len == w->cap && !settings_writer_flush(w)) { ok = false; break; }
+        size_t n = f.read((uint8_t *)w->buf + w->len, w->cap - w->len);
+        if (n == 0) break;
+        w->len += n;
+        w->totalBytes += (uint32_t)n;
+    }
+    f.close();
+    return ok && !w->failed;
+}
+
+bool settings_writer_end(SettingsExportWriter *w) {
+    if (!w) return false;
+    settings_writer_print(w, w->sections == 0 ? "{}\n" : "\n}\n");
+    return settings_writer_flush(w);
+}
+
+// ===== Import staging =====
+
+// Sections accepted by the streaming import. `split` members are staged per
+// array element; `target` members are promoted by rename at commit time, and
+// their `snapshot` store is dropped first so the promoted JSON is loaded (and
+// re-snapshotted) at the next boot.
+struct ImportSection {
+    const char *key;
+    bool split;
+    uint8_t maxItems;
+    const char *target;     // printf pattern (%d = index) or fixed path, null = applied by settings_manager
+    const char *snapshot;   // config_snapshot store base shadowing `target`, or null
+};
+
+static const ImportSection _sections[] = {
+    { "exportInfo",       false, 0,  nullptr,                  nullptr },
+    { "wifi",             false, 0,  nullptr,                  nullptr },
+    { "accessPoint",      false, 0,  nullptr,                  nullptr },
+    { "settings",         false, 0,  nullptr,                  nullptr },
+    { "smartSensing",     false, 0,  nullptr,                  nullptr },
+    { "signalGenerator",  false, 0,  nullptr,                  nullptr },
+    { "dacOutput",        false, 0,  nullptr,                  nullptr },
+    { "inputNames",       false, 0,  nullptr,                  nullptr },
+    { "mqtt",             false, 0,  nullptr,                  nullptr },
+    { "halCustomSchemas", true,  16, nullptr,                  nullptr },
+    { "halDevices",       true,  32, nullptr,                  nullptr },
+    { "dspGlobal",        false, 0,  "/dsp_global.json",       CONFIG_SNAPSHOT_BASE_DSP },
+    { "dspChannels",      true,  4,  "/dsp_ch%d.json",         CONFIG_SNAPSHOT_BASE_DSP },
+    { "outputDsp",        true,  16, "/output_dsp_ch%d.json",  CONFIG_SNAPSHOT_BASE_OUTPUT_DSP },
+    { "pipelineMatrix",   false, 0,  "/pipeline_matrix.json",  CONFIG_SNAPSHOT_BASE_MATRIX },
+};
+static const uint8_t IMPORT_SECTION_COUNT = sizeof(_sections) / sizeof(_sections[0]);
+
+static const char *const _splitKeys[] = {
+    "halCustomSchemas", "halDevices", "dspChannels", "outputDsp"
+};
+
+#define IMPORT_MANIFEST SETTINGS_IMPORT_STAGE_DIR "/manifest"
+
+static SettingsJsonSplitter _splitter;
+static char *_sectionBuf = nullptr;
+static SettingsUnitValidator _validate = nullptr;
+static SettingsImportStats _stats = {};
+static bool _importActive = false;
+
+static const ImportSection *_findSection(const char *key) {
+    for (uint8_t i = 0; i < IMPORT_SECTION_COUNT; i++) {
+        if (strcmp(_sections[i].key, key) == 0) return &_sections[i];
+    }
+    return nullptr;
+}
+
+static void _unitName(char *out, size_t cap, const char *key, int index) {
+    if (index < 0) snprintf(out, cap, "%s", key);
+    else snprintf(out, cap, "%s.%d", key, index);
+}
+
+static void _stagePath(char *out, size_t cap, const char *name) {
+    snprintf(out, cap, SETTINGS_IMPORT_STAGE_DIR "/%s", name);
+}
+
+static bool _wantKey(void *ctx, const char *key) {
+    (void)ctx;
+    return _findSection(key) != nullptr;
+}
+
+static bool _onUnit(void *ctx, const char *key, int index, const char *data, size_t len) {
+    (void)ctx;
+    const ImportSection *sec = _findSection(key);
+    if (!sec) return true;
+    // Shape mismatches and excess elements are ignored, as the old import did
+    if (sec->split != (index >= 0)) return true;
+    if (index >= sec->maxItems && sec->split) return true;
+    if (_validate && !_validate(data, len)) return false;
+
+    char name[SETTINGS_STREAM_KEY_MAX + 8];
+    char path[sizeof(name) + sizeof(SETTINGS_IMPORT_STAGE_DIR) + 2];
+    _unitName(name, sizeof(name), key, index);
+    _stagePath(path, sizeof(path), name);
+
+    File f = LittleFS.open(path, "w");
+    if (!f) return false;
+    size_t written = f.write((const uint8_t *)data, len);
+    f.close();
+    if (written != len) return false;
+
+    File m = LittleFS.open(IMPORT_MANIFEST, "a");
+    if (!m) return false;
+    m.print(name);
+    m.print("\n");
+    m.close();
+
+    _stats.unitsStaged++;
+    return true;
+}
+
+bool settings_import_begin(SettingsUnitValidator validate) {
+    settings_import_abort();
+    LittleFS.mkdir(SETTINGS_IMPORT_STAGE_DIR);
+
+    _sectionBuf = (char *)psram_alloc(SETTINGS_STREAM_SECTION_MAX, 1, "settings_import");
+    if (!_sectionBuf) return false;
+
+    _validate = validate;
+    memset(&_stats, 0, sizeof(_stats));
+    settings_splitter_init(&_splitter, _sectionBuf, SETTINGS_STREAM_SECTION_MAX,
+                           _splitKeys, sizeof(_splitKeys) / sizeof(_splitKeys[0]),
+                           _onUnit, _wantKey, nullptr);
+    _importActive = true;
+    return true;
+}
+
+bool settings_import_feed(const uint8_t *data, size_t len) {
+    if (!_importActive) return false;
+    _stats.bytesIn += (uint32_t)len;
+    SettingsSplitStatus st = settings_splitter_feed(&_splitter, data, len);
+    _stats.status = st;
+    _stats.maxUnitBytes = _splitter.maxUnitBytes;
+    return st == SETTINGS_SPLIT_OK || st == SETTINGS_SPLIT_DONE;
+}
+
+bool settings_import_finish() {
+    if (!_importActive) return false;
+    bool ok = (_splitter.status == SETTINGS_SPLIT_DONE);
+    if (!ok && _stats.status == SETTINGS_SPLIT_OK) _stats.status = SETTINGS_SPLIT_ERR_SYNTAX;  // Truncated upload
+    // The section buffer is only needed while bytes are arriving
+    psram_free(_sectionBuf, "settings_import");
+    _sectionBuf = nullptr;
+    _importActive = false;
+    return ok;
+}
+
+void settings_import_abort() {
+    if (_sectionBuf) {
+        psram_free(_sectionBuf, "settings_import");
+        _sectionBuf = nullptr;
+    }
+    _importActive = false;
+    settings_import_clear();
+}
+
+SettingsImportStats settings_import_get_stats() {
+    return _stats;
+}
+
+bool settings_import_has_unit(const char *key, int index) {
+    if (!key) return false;
+    char name[SETTINGS_STREAM_KEY_MAX + 8];
+    char path[sizeof(name) + sizeof(SETTINGS_IMPORT_STAGE_DIR) + 2];
+    _unitName(name, sizeof(name), key, index);
+    _stagePath(path, sizeof(path), name);
+    return LittleFS.exists(path);
+}
+
+int settings_import_read_unit(const char *key, int index, char *buf, size_t cap) {
+    if (!key || !buf || cap == 0) return -1;
+    char name[SETTINGS_STREAM_KEY_MAX + 8];
+    char path[sizeof(name) + sizeof(SETTINGS_IMPORT_STAGE_DIR) + 2];
+    _unitName(name, sizeof(name), key, index);
+    _stagePath(path, sizeof(path), name);
+    File f = LittleFS.open(path, "r");
+    if (!f) return -1;
+    if (f.size() >= cap) { f.close(); return -1; }
+    size_t n = f.read((uint8_t *)buf, cap - 1);
+    f.close();
+    buf[n] = '\0';
+    return (int)n;
+}
+
+void settings_import_mark_commit() {
+    File f = LittleFS.open(SETTINGS_IMPORT_COMMIT_MARKER, "w");
+    if (f) {
+        f.print("1");
+        f.close();
+    }
+}
+
+// True if the staged file holds an empty object or null — export placeholders
+// for missing channels that must not overwrite existing config.
+static bool _isPlaceholder(const char *path) {
+    File f = LittleFS.open(path, "r");
+    if (!f) return true;
+    if (f.size() > 8) { f.close(); return false; }
+    char tmp[9];
+    size_t n = f.read((uint8_t *)tmp, sizeof(tmp) - 1);
+    f.close();
+    tmp[n] = '\0';
+    char compact[9];
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!_isWs((uint8_t)tmp[i])) compact[k++] = tmp[i];
+    }
+    compact[k] = '\0';
+    return strcmp(compact, "{}") == 0 || strcmp(compact, "null") == 0 || k == 0;
+}
+
+// Walks the manifest line by line; `fn` receives each staged unit name.
+static void _forEachStaged(void (*fn)(const char *name, void *ctx), void *ctx) {
+    File m = LittleFS.open(IMPORT_MANIFEST, "r");
+    if (!m) return;
+    char name[SETTINGS_STREAM_KEY_MAX + 8];
+    size_t len = 0;
+    uint8_t c;
+    while (m.read(&c, 1) == 1) {
+        if (c == '\n') {
+            name[len] = '\0';
+            if (len > 0) fn(name, ctx);
+            len = 0;
+        } else if (len < sizeof(name) - 1) {
+            name[len++] = (char)c;
+        }
+    }
+    m.close();
+}
+
+static void _promoteOne(const char *name, void *ctx) {
+    int *count = (int *)ctx;
+    char key[SETTINGS_STREAM_KEY_MAX];
+    int index = -1;
+    const char *dot = strchr(name, '.');
+    size_t keyLen = dot ? (size_t)(dot - name) : strlen(name);
+    if (keyLen >= sizeof(key)) return;
+    memcpy(key, name, keyLen);
+    key[keyLen] = '\0';
+    if (dot) index = atoi(dot + 1);
+
+    const ImportSection *sec = _findSection(key);
+    if (!sec || !sec->target) return;
+
+    char src[SETTINGS_STREAM_KEY_MAX + 8 + sizeof(SETTINGS_IMPORT_STAGE_DIR) + 2];
+    _stagePath(src, sizeof(src), name);
+    if (!LittleFS.exists(src)) return;   // Already promoted before a reset
+    if (_isPlaceholder(src)) return;
+    if (sec->snapshot) config_snapshot_remove(sec->snapshot);
+
+    char dst[40];
+    if (sec->split) snprintf(dst, sizeof(dst), sec->target, index);
+    else snprintf(dst, sizeof(dst), "%s", sec->target);
+
+    // rename() replaces the target atomically on LittleFS
+    if (LittleFS.rename(src, dst)) (*count)++;
+}
+
+int settings_import_promote_files() {
+    int count = 0;
+    _forEachStaged(_promoteOne, &count);
+    return count;
+}
+
+static void _removeOne(const char *name, void *ctx) {
+    (void)ctx;
+    char path[SETTINGS_STREAM_KEY_MAX + 8 + sizeof(SETTINGS_IMPORT_STAGE_DIR) + 2];
+    _stagePath(path, sizeof(path), name);
+    LittleFS.remove(path);
+}
+
+void settings_import_clear() {
+    _forEachStaged(_removeOne, nullptr);
+    LittleFS.remove(IMPORT_MANIFEST);
+    LittleFS.remove(SETTINGS_IMPORT_COMMIT_MARKER);
+}
+
+bool settings_import_resume() {
+    if (!LittleFS.exists(SETTINGS_IMPORT_COMMIT_MARKER)) {
+        // Interrupted upload (never committed) — discard whatever was staged
+        if (LittleFS.exists(IMPORT_MANIFEST)) settings_import_clear();
+        return false;
+    }
+    // The appState units stay staged for the caller to re-apply; it clears
+    // the stage (and with it the marker) once they are persisted
+    settings_import_promote_files();
+    return true;
+}
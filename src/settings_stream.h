@@ -0,0 +1,145 @@
+#pragma once
+// settings_stream.h — Bounded-memory streaming for settings export/import.
+//
+// Export: SettingsExportWriter buffers output in one fixed chunk and hands it
+// to a sink (chunked HTTP on device, std::string in tests). File-backed
+// sections (DSP, output DSP, matrix) are copied byte-for-byte from LittleFS
+// after a structural check — they are never parsed into a JsonDocument.
+//
+// Import: SettingsJsonSplitter is an incremental scanner over the top-level
+// export object. It emits one "unit" per top-level member, or one unit per
+// element for array sections (dspChannels, outputDsp, halDevices, ...), so
+// the peak buffer is the largest single unit, not the whole file. Units are
+// staged to SETTINGS_IMPORT_STAGE_DIR and only committed once the complete
+// document has been received and validated.
+//
+// No ArduinoJson/WebServer dependency — testable natively with the LittleFS mock.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SETTINGS_STREAM_CHUNK_BYTES   1436    // One TCP segment per chunked write
+#define SETTINGS_STREAM_SECTION_MAX   32768   // Largest single import unit (PSRAM)
+#define SETTINGS_STREAM_KEY_MAX       32
+#define SETTINGS_STREAM_SPLIT_KEYS_MAX 8
+
+#define SETTINGS_IMPORT_STAGE_DIR     "/import_stage"
+#define SETTINGS_IMPORT_COMMIT_MARKER "/import_stage/commit"
+
+// ===== Incremental splitter =====
+
+enum SettingsSplitStatus : uint8_t {
+    SETTINGS_SPLIT_OK = 0,        // Waiting for more input
+    SETTINGS_SPLIT_DONE,          // Closing '}' of the top-level object seen
+    SETTINGS_SPLIT_ERR_SYNTAX,    // Not a JSON object / unbalanced / trailing data
+    SETTINGS_SPLIT_ERR_OVERFLOW,  // A single unit exceeded the section buffer
+    SETTINGS_SPLIT_ERR_REJECTED   // Unit callback returned false
+};
+
+// Called for each complete unit. `index` is -1 for a whole top-level member,
+// or the element index for members listed in splitKeys. `data` is
+// NUL-terminated (len excludes the terminator). Return false to abort.
+typedef bool (*SettingsUnitCb)(void *ctx, const char *key, int index,
+                               const char *data, size_t len);
+
+// Optional filter: return false to scan a member without buffering it.
+typedef bool (*SettingsKeyFilterCb)(void *ctx, const char *key);
+
+struct SettingsJsonSplitter {
+    char *buf;
+    size_t bufSize;
+    size_t len;
+    SettingsUnitCb onUnit;
+    SettingsKeyFilterCb wantKey;
+    void *ctx;
+    const char *const *splitKeys;
+    uint8_t splitKeyCount;
+
+    char key[SETTINGS_STREAM_KEY_MAX];
+    uint8_t keyLen;
+    uint8_t state;
+    uint8_t status;
+    uint8_t unitKind;   // Container / string / bare scalar
+    bool inString;
+    bool escape;
+    bool skipping;      // Current member filtered out — scan only
+    bool splitting;     // Current member is an array split per element
+    uint16_t depth;     // Nesting depth inside the current unit
+    int16_t index;      // Element index when splitting
+    uint32_t maxUnitBytes;
+};
+
+void settings_splitter_init(SettingsJsonSplitter *sp, char *buf, size_t bufSize,
+                            const char *const *splitKeys, uint8_t splitKeyCount,
+                            SettingsUnitCb onUnit, SettingsKeyFilterCb wantKey, void *ctx);
+SettingsSplitStatus settings_splitter_feed(SettingsJsonSplitter *sp, const uint8_t *data, size_t len);
+
+// Structural check of a complete JSON object held in a file (balanced
+// brackets, terminated strings, nothing after the closing brace).
+bool settings_stream_file_is_json_object(const char *path);
+
+// ===== Export writer =====
+
+// Receives each full chunk. Return false if the client went away.
+typedef bool (*SettingsSinkCb)(void *ctx, const char *data, size_t len);
+
+struct SettingsExportWriter {
+    char *buf;
+    size_t cap;
+    size_t len;
+    SettingsSinkCb sink;
+    void *ctx;
+    uint32_t totalBytes;
+    uint16_t sections;
+    bool failed;
+};
+
+void settings_writer_init(SettingsExportWriter *w, char *buf, size_t cap,
+                          SettingsSinkCb sink, void *ctx);
+bool settings_writer_write(SettingsExportWriter *w, const char *data, size_t len);
+bool settings_writer_print(SettingsExportWriter *w, const char *str);
+// Emits the separator and "key": for the next top-level member.
+bool settings_writer_begin_section(SettingsExportWriter *w, const char *key);
+// Copies a JSON file verbatim; writes `{}` if the file is missing or fails
+// the structural check. Returns true if the file contents were used.
+bool settings_writer_copy_file(SettingsExportWriter *w, const char *path);
+bool settings_writer_flush(SettingsExportWriter *w);
+// Closes the top-level object and flushes the tail.
+bool settings_writer_end(SettingsExportWriter *w);
+
+// ===== Import staging =====
+
+struct SettingsImportStats {
+    uint32_t bytesIn;
+    uint32_t maxUnitBytes;
+    uint16_t unitsStaged;
+    uint8_t  status;          // SettingsSplitStatus of the last session
+};
+
+// Validates one unit before it is staged (e.g. ArduinoJson syntax check on
+// device). May be null.
+typedef bool (*SettingsUnitValidator)(const char *data, size_t len);
+
+// Start a session: clears any previous staging area and allocates the
+// section buffer. Returns false if the buffer cannot be allocated.
+bool settings_import_begin(SettingsUnitValidator validate);
+bool settings_import_feed(const uint8_t *data, size_t len);
+// True if the whole document was received and every unit was staged.
+bool settings_import_finish();
+// Drop all staged units and release the section buffer.
+void settings_import_abort();
+SettingsImportStats settings_import_get_stats();
+
+bool settings_import_has_unit(const char *key, int index);
+// Reads a staged unit into `buf` (NUL-terminated). Returns bytes read or -1.
+int  settings_import_read_unit(const char *key, int index, char *buf, size_t cap);
+
+// Commit protocol: mark → promote file-backed units → apply the rest → clear.
+// After a power loss settings_import_resume() finishes promotion and returns
+// true with the appState units still staged; the caller re-applies them and
+// then calls settings_import_clear(), so no committed section is lost.
+void settings_import_mark_commit();
+int  settings_import_promote_files();
+void settings_import_clear();
+bool settings_import_resume();
@@ -5,6 +5,8 @@
 #include "config.h"
 #include "debug_serial.h"
 #include "i2s_audio.h"
+#include "audio_scheduler.h"
+#include "audio_rate_convert.h"
 #include "websocket_handler.h"
 #include <ArduinoJson.h>
 #include <LittleFS.h>
@@ -63,6 +65,11 @@ void handleSmartSensingGet() {
   doc["audioLevel"] = appState.audio.level_dBFS;
   doc["signalDetected"] = (_smoothedAudioLevel >= appState.audio.threshold_dBFS);
   doc["audioSampleRate"] = appState.audio.sampleRate;
+  doc["audioLatencyProfile"] = appState.audio.latencyProfile;
+  doc["audioBlockFrames"] = appState.audio.blockFrames;
+  doc["dsdPassthrough"] = appState.audio.dsdPassthrough;
+  doc["audioProcessingRate"] = appState.audio.processingRate;
+  doc["audioProcessingRateActive"] = i2s_audio_get_processing_rate();
   doc["adcVref"] = appState.audio.adcVref;
   doc["numAdcsDetected"] = appState.audio.numAdcsDetected;
   // Per-ADC data
@@ -220,6 +227,44 @@ void handleSmartSensingUpdate() {
     }
   }
 
+  // Update latency profile (DMA runway; recreates the I2S channels)
+  if (doc["audioLatencyProfile"].is<int>()) {
+    uint8_t profile = doc["audioLatencyProfile"].as<uint8_t>();
+    if (i2s_audio_set_latency_profile(profile)) {
+      settingsChanged = true;
+      LOG_I("[Sensing] Latency profile set to %u", profile);
+    }
+  }
+
+  // Update pipeline block size (recreates the I2S channels)
+  if (doc["audioBlockFrames"].is<int>()) {
+    uint16_t frames = doc["audioBlockFrames"].as<uint16_t>();
+    if (i2s_audio_set_block_frames(frames)) {
+      settingsChanged = true;
+      LOG_I("[Sensing] Block size set to %u frames", frames);
+    }
+  }
+
+  // Internal processing rate (0 = I2S rate; applied with a faded switch)
+  if (doc["audioProcessingRate"].is<int>()) {
+    uint32_t rate = doc["audioProcessingRate"].as<uint32_t>();
+    if (i2s_audio_set_processing_rate(rate)) {
+      settingsChanged = true;
+      LOG_I("[Sensing] Processing rate set to %lu Hz (in effect %lu Hz)", (unsigned long)rate,
+            (unsigned long)i2s_audio_get_processing_rate());
+    }
+  }
+
+  // DSD handling: bit-exact DoP to DSD-capable sinks, or decoded PCM everywhere
+  if (doc["dsdPassthrough"].is<bool>()) {
+    bool pass = doc["dsdPassthrough"].as<bool>();
+    if (pass != appState.audio.dsdPassthrough) {
+      appState.audio.dsdPassthrough = pass;
+      settingsChanged = true;
+      LOG_I("[Sensing] DSD passthrough %s", pass ? "enabled" : "disabled");
+    }
+  }
+
   // Manual override
   if (doc["manualOverride"].is<bool>()) {
     bool state = doc["manualOverride"].as<bool>();
@@ -313,6 +358,9 @@ bool detectSignal() {
     dst.clippedSamples = dsrc.clippedSamples;
     dst.clipRate = dsrc.clipRate;
     dst.dcOffset = dsrc.dcOffset;
+    dst.captureStalled = dsrc.stalled;
+    dst.captureUnderruns = dsrc.captureUnderruns;
+    dst.captureOverflows = dsrc.captureOverflows;
   }
 
   // Overall level = max dBFS across all ADCs
@@ -501,6 +549,10 @@ bool loadSmartSensingSettings() {
   String line3 = file.readStringUntil('\n'); // audio threshold
   String line4 = file.readStringUntil('\n'); // sample rate
   String line5 = file.readStringUntil('\n'); // ADC VREF
+  String line6 = file.readStringUntil('\n'); // latency profile
+  String line7 = file.readStringUntil('\n'); // block size
+  String line8 = file.readStringUntil('\n'); // DSD passthrough
+  String line9 = file.readStringUntil('\n'); // processing rate
   file.close();
 
   line1.trim();
@@ -508,6 +560,10 @@ bool loadSmartSensingSettings() {
   line3.trim();
   line4.trim();
   line5.trim();
+  line6.trim();
+  line7.trim();
+  line8.trim();
+  line9.trim();
 
   if (line1.length() > 0) {
     int mode = line1.toInt();
@@ -543,6 +599,29 @@ bool loadSmartSensingSettings() {
     }
   }
 
+  if (line6.length() > 0) {
+    int profile = line6.toInt();
+    if (profile >= 0 && profile < AUDIO_LATENCY_PROFILE_COUNT) {
+      appState.audio.latencyProfile = (uint8_t)profile;
+    }
+  }
+
+  if (line7.length() > 0) {
+    int frames = line7.toInt();
+    if (frames > 0 && audio_block_frames_valid((uint32_t)frames)) {
+      appState.audio.blockFrames = (uint16_t)frames;
+    }
+  }
+
+  if (line8.length() > 0) {
+    appState.audio.dsdPassthrough = (line8.toInt() != 0);
+  }
+
+  if (line9.length() > 0) {
+    uint32_t rate = (uint32_t)line9.toInt();
+    if (audio_proc_rate_valid(rate)) appState.audio.processingRate = rate;
+  }
+
   LOG_I("[Sensing] Settings loaded");
   LOG_D("[Sensing]   Mode: %d, Timer: %lu min, Threshold: %+.0f dBFS, Sample Rate: %lu Hz", appState.audio.currentMode,
         appState.audio.timerDuration, appState.audio.threshold_dBFS, appState.audio.sampleRate);
@@ -563,6 +642,10 @@ void saveSmartSensingSettings() {
   file.println(String(appState.audio.threshold_dBFS, 1));
   file.println(String(appState.audio.sampleRate));
   file.println(String(appState.audio.adcVref, 2));
+  file.println(String(appState.audio.latencyProfile));
+  file.println(String(appState.audio.blockFrames));
+  file.println(appState.audio.dsdPassthrough ? "1" : "0");
+  file.println(String(appState.audio.processingRate));
   file.close();
 
   LOG_I("[Sensing] Settings saved");
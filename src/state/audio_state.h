@@ -23,6 +23,9 @@ struct AdcState {
   uint32_t clippedSamples = 0;
   float clipRate = 0.0f;           // EMA clip rate (0.0-1.0)
   uint32_t i2sRecoveries = 0;     // I2S driver restart count (timeout recovery)
+  bool captureStalled = false;    // Port delivers no DMA data (lane zero-filled)
+  uint32_t captureUnderruns = 0;  // Blocks zero-padded because the port was short
+  uint32_t captureOverflows = 0;  // Frames dropped because the port ran ahead
 };
 
 // I2S runtime metrics (written by audio task, read by diagnostics)
@@ -66,6 +69,10 @@ struct AudioState {
   float adcVref = DEFAULT_ADC_VREF;
   bool adcEnabled[AUDIO_PIPELINE_MAX_INPUTS] = {true, true};
   volatile bool paused = false;  // Cross-core: written Core 0, read Core 1
+  uint8_t latencyProfile = 1;     // AudioLatencyProfile: 0=low, 1=balanced, 2=safe (DMA runway)
+  uint16_t blockFrames = 256;     // Pipeline block size: 32, 64, 128 or 256 frames
+  bool dsdPassthrough = false;    // DoP to DSD-capable sinks bit-exact (others get decoded PCM)
+  uint32_t processingRate = 0;    // Internal processing rate: 0 = I2S rate, 48000 or 96000
 #ifndef UNIT_TEST
   SemaphoreHandle_t taskPausedAck = nullptr;
 #endif
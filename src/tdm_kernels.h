@@ -0,0 +1,227 @@
+#pragma once
+// tdm_kernels.h — TDM frame gather/scatter kernels (header-only, no RTOS
+// dependencies).
+//
+// A TDM frame is `slots` consecutive slot containers of 16, 24 or 32 bits,
+// little-endian, exactly as the I2S DMA buffer holds them:
+//   16-bit: int16_t per slot
+//   24-bit: 3 packed bytes per slot
+//   32-bit: int32_t per slot (24-bit converters left-justify in the top bits)
+// The kernels move one stereo slot pair per call between a frame buffer and
+// a pipeline lane, straight from / into the DMA-side buffer:
+//   tdm_gather_pair()    frames -> interleaved L/R int32 (AudioInputSource::read)
+//   tdm_gather_planar()  frames -> planar float L / R (24-bit full scale = 1.0
+//                        times scale, as audio_input_condition() produces)
+//   tdm_scatter_pair()   interleaved L/R int32 (AudioOutputSink::write) -> frames
+//   tdm_clear_pair()     silence one slot pair
+// Lane samples are always left-justified int32, so full scale does not depend
+// on the slot width; narrower slots truncate on the way out.
+//
+// Each kernel is a stride gather / scatter with the stride fixed for the
+// call, unrolled four frames per iteration so the loads of one iteration are
+// independent. A slot pair can name any two slots, in either order, or the
+// same slot twice (mono source on both sides).
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TDM_MIN_SLOTS 2
+#define TDM_MAX_SLOTS 16
+
+struct TdmFormat {
+    uint8_t slots;      // Slots per frame, TDM_MIN_SLOTS..TDM_MAX_SLOTS
+    uint8_t slotBits;   // Slot container width: 16, 24 or 32
+};
+
+static inline bool tdm_format_valid(TdmFormat f) {
+    return f.slots >= TDM_MIN_SLOTS && f.slots <= TDM_MAX_SLOTS &&
+           (f.slotBits == 16 || f.slotBits == 24 || f.slotBits == 32);
+}
+
+static inline uint32_t tdm_slot_bytes(TdmFormat f) { return f.slotBits / 8u; }
+static inline uint32_t tdm_frame_bytes(TdmFormat f) { return f.slots * (f.slotBits / 8u); }
+
+static inline bool tdm_pair_valid(TdmFormat f, uint8_t slotL, uint8_t slotR) {
+    return slotL < f.slots && slotR < f.slots;
+}
+
+// ===== Slot container <-> left-justified int32 =====
+
+static inline int32_t _tdm_load16(const uint8_t *p) {
+    return (int32_t)((uint32_t)p[0] << 16 | (uint32_t)p[1] << 24);
+}
+static inline int32_t _tdm_load24(const uint8_t *p) {
+    return (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24);
+}
+static inline void _tdm_store16(uint8_t *p, int32_t w) {
+    p[0] = (uint8_t)((uint32_t)w >> 16);
+    p[1] = (uint8_t)((uint32_t)w >> 24);
+}
+static inline void _tdm_store24(uint8_t *p, int32_t w) {
+    p[0] = (uint8_t)((uint32_t)w >> 8);
+    p[1] = (uint8_t)((uint32_t)w >> 16);
+    p[2] = (uint8_t)((uint32_t)w >> 24);
+}
+
+// ===== Gather =====
+
+static inline void _tdm_gather_pair32(const int32_t *__restrict l, const int32_t *__restrict r,
+                                      uint32_t st, int32_t *__restrict dst, uint32_t n) {
+    uint32_t f = 0;
+    for (; f + 4 <= n; f += 4) {
+        int32_t l0 = l[0], l1 = l[st], l2 = l[2 * st], l3 = l[3 * st];
+        int32_t r0 = r[0], r1 = r[st], r2 = r[2 * st], r3 = r[3 * st];
+        dst[0] = l0; dst[1] = r0; dst[2] = l1; dst[3] = r1;
+        dst[4] = l2; dst[5] = r2; dst[6] = l3; dst[7] = r3;
+        l += 4 * st;
+        r += 4 * st;
+        dst += 8;
+    }
+    for (; f < n; f++) {
+        dst[0] = *l;
+        dst[1] = *r;
+        l += st;
+        r += st;
+        dst += 2;
+    }
+}
+
+// Byte-addressed widths (16 / 24): LOAD is _tdm_load16 or _tdm_load24
+#define _TDM_GATHER_BYTES(LOAD)                                                   \
+    do {                                                                          \
+        uint32_t f = 0;                                                           \
+        for (; f + 4 <= n; f += 4) {                                              \
+            int32_t l0 = LOAD(l), l1 = LOAD(l + st), l2 = LOAD(l + 2 * st),       \
+                    l3 = LOAD(l + 3 * st);                                        \
+            int32_t r0 = LOAD(r), r1 = LOAD(r + st), r2 = LOAD(r + 2 * st),       \
+                    r3 = LOAD(r + 3 * st);                                        \
+            dst[0] = l0; dst[1] = r0; dst[2] = l1; dst[3] = r1;                   \
+            dst[4] = l2; dst[5] = r2; dst[6] = l3; dst[7] = r3;                   \
+            l += 4 * st; r += 4 * st; dst += 8;                                   \
+        }                                                                         \
+        for (; f < n; f++) {                                                      \
+            dst[0] = LOAD(l); dst[1] = LOAD(r);                                   \
+            l += st; r += st; dst += 2;                                           \
+        }                                                                         \
+    } while (0)
+
+// n frames of slots slotL / slotR -> dst[f*2] = L, dst[f*2+1] = R
+static inline void tdm_gather_pair(const void *frames, TdmFormat fmt, uint8_t slotL,
+                                   uint8_t slotR, int32_t *__restrict dst, uint32_t n) {
+    if (fmt.slotBits == 32) {
+        const int32_t *s = (const int32_t *)frames;
+        _tdm_gather_pair32(s + slotL, s + slotR, fmt.slots, dst, n);
+        return;
+    }
+    const uint32_t sb = tdm_slot_bytes(fmt);
+    const uint32_t st = tdm_frame_bytes(fmt);
+    const uint8_t *l = (const uint8_t *)frames + slotL * sb;
+    const uint8_t *r = (const uint8_t *)frames + slotR * sb;
+    if (fmt.slotBits == 24) _TDM_GATHER_BYTES(_tdm_load24);
+    else                    _TDM_GATHER_BYTES(_tdm_load16);
+}
+
+#undef _TDM_GATHER_BYTES
+
+// n frames of slots slotL / slotR -> planar float, (w >> 8) * scale. With
+// scale = gain / AUDIO_INPUT_FULL_SCALE this matches audio_input_condition().
+static inline void tdm_gather_planar(const void *frames, TdmFormat fmt, uint8_t slotL,
+                                     uint8_t slotR, float *__restrict L, float *__restrict R,
+                                     uint32_t n, float scale) {
+    if (fmt.slotBits == 32) {
+        const uint32_t st = fmt.slots;
+        const int32_t *l = (const int32_t *)frames + slotL;
+        const int32_t *r = (const int32_t *)frames + slotR;
+        uint32_t f = 0;
+        for (; f + 4 <= n; f += 4) {
+            int32_t l0 = l[0], l1 = l[st], l2 = l[2 * st], l3 = l[3 * st];
+            int32_t r0 = r[0], r1 = r[st], r2 = r[2 * st], r3 = r[3 * st];
+            L[f]     = (float)(l0 >> 8) * scale; L[f + 1] = (float)(l1 >> 8) * scale;
+            L[f + 2] = (float)(l2 >> 8) * scale; L[f + 3] = (float)(l3 >> 8) * scale;
+            R[f]     = (float)(r0 >> 8) * scale; R[f + 1] = (float)(r1 >> 8) * scale;
+            R[f + 2] = (float)(r2 >> 8) * scale; R[f + 3] = (float)(r3 >> 8) * scale;
+            l += 4 * st;
+            r += 4 * st;
+        }
+        for (; f < n; f++) {
+            L[f] = (float)(*l >> 8) * scale;
+            R[f] = (float)(*r >> 8) * scale;
+            l += st;
+            r += st;
+        }
+        return;
+    }
+    const uint32_t sb = tdm_slot_bytes(fmt);
+    const uint32_t st = tdm_frame_bytes(fmt);
+    const uint8_t *l = (const uint8_t *)frames + slotL * sb;
+    const uint8_t *r = (const uint8_t *)frames + slotR * sb;
+    const bool w24 = fmt.slotBits == 24;
+    for (uint32_t f = 0; f < n; f++) {
+        int32_t a = w24 ? _tdm_load24(l) : _tdm_load16(l);
+        int32_t b = w24 ? _tdm_load24(r) : _tdm_load16(r);
+        L[f] = (float)(a >> 8) * scale;
+        R[f] = (float)(b >> 8) * scale;
+        l += st;
+        r += st;
+    }
+}
+
+// ===== Scatter =====
+
+// src[f*2] -> slotL, src[f*2+1] -> slotR for n frames; other slots untouched
+// (with slotL == slotR the slot carries R)
+static inline void tdm_scatter_pair(void *frames, TdmFormat fmt, uint8_t slotL, uint8_t slotR,
+                                    const int32_t *__restrict src, uint32_t n) {
+    if (fmt.slotBits == 32) {
+        const uint32_t st = fmt.slots;
+        int32_t *l = (int32_t *)frames + slotL;
+        int32_t *r = (int32_t *)frames + slotR;
+        uint32_t f = 0;
+        for (; f + 4 <= n; f += 4) {
+            int32_t l0 = src[0], r0 = src[1], l1 = src[2], r1 = src[3];
+            int32_t l2 = src[4], r2 = src[5], l3 = src[6], r3 = src[7];
+            l[0] = l0; l[st] = l1; l[2 * st] = l2; l[3 * st] = l3;
+            r[0] = r0; r[st] = r1; r[2 * st] = r2; r[3 * st] = r3;
+            l += 4 * st;
+            r += 4 * st;
+            src += 8;
+        }
+        for (; f < n; f++) {
+            *l = src[0];
+            *r = src[1];
+            l += st;
+            r += st;
+            src += 2;
+        }
+        return;
+    }
+    const uint32_t sb = tdm_slot_bytes(fmt);
+    const uint32_t st = tdm_frame_bytes(fmt);
+    uint8_t *l = (uint8_t *)frames + slotL * sb;
+    uint8_t *r = (uint8_t *)frames + slotR * sb;
+    if (fmt.slotBits == 24) {
+        for (uint32_t f = 0; f < n; f++, l += st, r += st, src += 2) {
+            _tdm_store24(l, src[0]);
+            _tdm_store24(r, src[1]);
+        }
+    } else {
+        for (uint32_t f = 0; f < n; f++, l += st, r += st, src += 2) {
+            _tdm_store16(l, src[0]);
+            _tdm_store16(r, src[1]);
+        }
+    }
+}
+
+static inline void tdm_clear_pair(void *frames, TdmFormat fmt, uint8_t slotL, uint8_t slotR,
+                                  uint32_t n) {
+    const uint32_t sb = tdm_slot_bytes(fmt);
+    const uint32_t st = tdm_frame_bytes(fmt);
+    uint8_t *l = (uint8_t *)frames + slotL * sb;
+    uint8_t *r = (uint8_t *)frames + slotR * sb;
+    for (uint32_t f = 0; f < n; f++, l += st, r += st) {
+        for (uint32_t b = 0; b < sb; b++) {
+            l[b] = 0;
+            r[b] = 0;
+        }
+    }
+}
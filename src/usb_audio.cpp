@@ -80,6 +80,20 @@ uint32_t usb_rb_read(UsbAudioRingBuffer *rb, int32_t *data, uint32_t frames) {
     return frames;
 }
 
+uint32_t usb_rb_peek(UsbAudioRingBuffer *rb, const int32_t **data, uint32_t frames) {
+    if (frames == 0 || usb_rb_available(rb) < frames) return 0;
+    uint32_t pos = rb->readPos & (rb->capacity - 1);
+    if (pos + frames > rb->capacity) return 0;   // Split by the wrap
+    *data = &rb->buffer[pos * 2];
+    return frames;
+}
+
+void usb_rb_consume(UsbAudioRingBuffer *rb, uint32_t frames) {
+    uint32_t avail = usb_rb_available(rb);
+    if (frames > avail) frames = avail;
+    rb->readPos = (rb->readPos + frames) & (rb->capacity * 2 - 1);
+}
+
 // ===== Format Conversion (pure) =====
 
 void usb_pcm16_to_int32(const int16_t *src, int32_t *dst, uint32_t frames) {
@@ -906,6 +920,15 @@ uint32_t usb_audio_read(int32_t *out, uint32_t frames) {
     return usb_rb_read(&_ringBuffer, out, frames);
 }
 
+uint32_t usb_audio_borrow(const int32_t **data, uint32_t frames) {
+    if (_usbState != USB_AUDIO_STREAMING) return 0;
+    return usb_rb_peek(&_ringBuffer, data, frames);
+}
+
+void usb_audio_release(uint32_t frames) {
+    usb_rb_consume(&_ringBuffer, frames);
+}
+
 uint32_t usb_audio_available_frames(void) {
     return usb_rb_available(&_ringBuffer);
 }
@@ -1015,6 +1038,13 @@ uint32_t usb_audio_read(int32_t *out, uint32_t frames) {
     if (_nativeState != USB_AUDIO_STREAMING) return 0;
     return usb_rb_read(&_nativeRingBuffer, out, frames);
 }
+uint32_t usb_audio_borrow(const int32_t **data, uint32_t frames) {
+    if (_nativeState != USB_AUDIO_STREAMING) return 0;
+    return usb_rb_peek(&_nativeRingBuffer, data, frames);
+}
+void usb_audio_release(uint32_t frames) {
+    usb_rb_consume(&_nativeRingBuffer, frames);
+}
 uint32_t usb_audio_available_frames(void) {
     return usb_rb_available(&_nativeRingBuffer);
 }
@@ -39,6 +39,14 @@ uint32_t usb_rb_write(UsbAudioRingBuffer *rb, const int32_t *data, uint32_t fram
 // Read stereo frames from ring buffer. Returns number of frames actually read.
 uint32_t usb_rb_read(UsbAudioRingBuffer *rb, int32_t *data, uint32_t frames);
 
+// Zero-copy read: point *data at the next `frames` frames in place. Returns
+// frames if they are available and contiguous (not split by the wrap), else
+// 0 (use usb_rb_read). The producer cannot reuse them until usb_rb_consume().
+uint32_t usb_rb_peek(UsbAudioRingBuffer *rb, const int32_t **data, uint32_t frames);
+
+// Return frames obtained with usb_rb_peek() to the producer
+void usb_rb_consume(UsbAudioRingBuffer *rb, uint32_t frames);
+
 // Number of frames available to read
 uint32_t usb_rb_available(const UsbAudioRingBuffer *rb);
 
@@ -85,6 +93,12 @@ bool usb_audio_is_streaming(void);
 // out must hold at least frames*2 int32_t elements.
 uint32_t usb_audio_read(int32_t *out, uint32_t frames);
 
+// Zero-copy variant of usb_audio_read(): lends `frames` frames of the ring
+// buffer in place (usb_rb_peek). Returns frames, or 0 when not streaming or
+// the block is short or wraps. Hand the frames back with usb_audio_release().
+uint32_t usb_audio_borrow(const int32_t **data, uint32_t frames);
+void usb_audio_release(uint32_t frames);
+
 // Number of frames available in the ring buffer
 uint32_t usb_audio_available_frames(void);
 
@@ -6,6 +6,7 @@
 #include <pgmspace.h>
 #include <WebServer.h>
 #include "http_security.h"
+#include "http_cache.h"
 
 // Raw PROGMEM pages (for development/debugging)
 extern const char htmlPage[] PROGMEM;
@@ -19,20 +20,48 @@ extern const size_t apHtmlPage_gz_len;
 extern const uint8_t loginPage_gz[] PROGMEM;
 extern const size_t loginPage_gz_len;
 
+// Strong ETags of the gzipped bodies (generated with them)
+extern const char htmlPage_etag[];
+extern const char apHtmlPage_etag[];
+extern const char loginPage_etag[];
+
+// Content-hashed JS/CSS assets (build_web_assets.js --split); empty otherwise
+extern const WebAsset webAssets[];
+extern const size_t webAssetCount;
+
 // Helper function to serve gzipped content when supported
-// Returns true if gzipped response was sent, false otherwise
+// Returns true if a gzipped (200) or Not Modified (304) response was sent,
+// false if the client does not accept gzip. With an `etag` the response is
+// revalidated on every load and a matching If-None-Match costs no body.
 inline bool sendGzipped(WebServer& server, const uint8_t* gzData, size_t gzLen,
-                        const char* contentType = "text/html") {
-    if (server.hasHeader("Accept-Encoding")) {
-        String encoding = server.header("Accept-Encoding");
-        if (encoding.indexOf("gzip") >= 0) {
-            server.sendHeader("Content-Encoding", "gzip");
-            server.sendHeader("Cache-Control", "no-cache");
-            server_send_P(200, contentType, reinterpret_cast<const char*>(gzData), gzLen);
-            return true;
-        }
+                        const char* contentType = "text/html", const char* etag = nullptr,
+                        const char* cacheControl = HTTP_CACHE_REVALIDATE) {
+    if (!server.hasHeader("Accept-Encoding")) return false;
+    String encoding = server.header("Accept-Encoding");
+    String ifNoneMatch = server.header("If-None-Match");
+    int status = http_cache_status(encoding.c_str(), ifNoneMatch.c_str(), etag);
+    if (status == 0) return false;
+
+    server.sendHeader("Cache-Control", cacheControl);
+    server.sendHeader("Vary", "Accept-Encoding");
+    if (etag) server.sendHeader("ETag", etag);
+    if (status == 304) {
+        server_send(304);
+        return true;
+    }
+    server.sendHeader("Content-Encoding", "gzip");
+    server_send_P(200, contentType, reinterpret_cast<const char*>(gzData), gzLen);
+    return true;
+}
+
+// Serve a content-hashed asset: its URL changes with its content, so it can
+// be cached forever. Only gzip is stored — every browser accepts it.
+inline void sendWebAsset(WebServer& server, const WebAsset& asset) {
+    if (!sendGzipped(server, asset.gz, asset.gzLen, asset.contentType, asset.etag, HTTP_CACHE_IMMUTABLE)) {
+        server.sendHeader("Cache-Control", HTTP_CACHE_IMMUTABLE);
+        server.sendHeader("Content-Encoding", "gzip");
+        server_send_P(200, asset.contentType, reinterpret_cast<const char*>(asset.gz), asset.gzLen);
     }
-    return false;
 }
 
 #endif
@@ -8693,6 +8693,7 @@ const uint8_t htmlPage_gz[] PROGMEM = {
     0x0f, 0x65, 0xc8, 0xc3, 0xb4, 0xbd, 0x41, 0x0c, 0x00
 };
 const size_t htmlPage_gz_len = 138953;
+const char htmlPage_etag[] = "\"f3777063084d4ce3\"";
 
 // Gzipped apHtmlPage (3393 bytes)
 const uint8_t apHtmlPage_gz[] PROGMEM = {
@@ -8911,6 +8912,7 @@ const uint8_t apHtmlPage_gz[] PROGMEM = {
     0x00
 };
 const size_t apHtmlPage_gz_len = 3393;
+const char apHtmlPage_etag[] = "\"3b3893011d90161f\"";
 
 // Gzipped loginPage (3086 bytes)
 const uint8_t loginPage_gz[] PROGMEM = {
@@ -9109,4 +9111,10 @@ const uint8_t loginPage_gz[] PROGMEM = {
     0x46, 0xd9, 0x7f, 0x31, 0xf8, 0x2f, 0xa0, 0xb4, 0x44, 0x6d, 0x76, 0x30, 0x00, 0x00
 };
 const size_t loginPage_gz_len = 3086;
+const char loginPage_etag[] = "\"b2e75d9f3f519656\"";
 
+// Immutable hashed assets (0)
+const WebAsset webAssets[] = {
+    { nullptr, nullptr, 0, nullptr, nullptr },
+};
+const size_t webAssetCount = 0;
@@ -250,6 +250,7 @@ void sendDspState() {
       so["enabled"] = st.enabled;
       so["type"] = (int)st.type;
       if (st.label[0]) so["label"] = st.label;
+      if (st.priority != DSP_PRIORITY_NORMAL) so["priority"] = st.priority;
       if (dsp_is_biquad_type(st.type)) {
         so["freq"] = st.biquad.frequency;
         so["gain"] = st.biquad.gain;
@@ -270,8 +271,12 @@ void sendDspState() {
         so["gainDb"] = st.gain.gainDb;
       } else if (st.type == DSP_FIR) {
         so["numTaps"] = st.fir.numTaps;
+        so["firMode"] = st.fir.mode == DSP_FIR_MODE_FFT ? "fft" : "direct";
+        so["cpu"] = st.fir.cpuPercent;
       } else if (st.type == DSP_DELAY) {
         so["delaySamples"] = st.delay.delaySamples;
+        so["fraction"] = st.delay.fraction;
+        so["interp"] = st.delay.interp;
       } else if (st.type == DSP_POLARITY) {
         so["inverted"] = st.polarity.inverted;
       } else if (st.type == DSP_MUTE) {
@@ -310,6 +315,14 @@ void sendDspState() {
         so["order"] = st.bassEnhance.order;
       } else if (st.type == DSP_MULTIBAND_COMP) {
         so["numBands"] = st.multibandComp.numBands;
+      } else if (st.type == DSP_TRUE_PEAK_LIMITER) {
+        so["ceilingDb"] = st.truePeak.ceilingDb;
+        so["lookaheadMs"] = st.truePeak.lookaheadMs;
+        so["releaseMs"] = st.truePeak.releaseMs;
+        so["linked"] = st.truePeak.linked;
+        so["gr"] = st.truePeak.gainReduction;
+      } else if (st.type == DSP_DECIMATOR) {
+        so["factor"] = st.decimator.factor;
       }
     }
   }
@@ -328,6 +341,9 @@ void sendDspMetrics() {
   doc["cpuLoad"] = m.cpuLoadPercent;
   JsonArray gr = doc["limiterGr"].to<JsonArray>();
   for (int i = 0; i < DSP_MAX_CHANNELS; i++) gr.add(m.limiterGrDb[i]);
+  // Added latency per channel (samples @ pipeline rate) for output delay alignment
+  JsonArray lat = doc["latencySamples"].to<JsonArray>();
+  for (int i = 0; i < DSP_MAX_CHANNELS; i++) lat.add(m.latencySamples[i]);
   // Pipeline-wide timing metrics (from audio_pipeline_task, Core 1)
   doc["pipelineCpu"]    = timing.totalCpuPercent;
   doc["pipelineFrameUs"] = timing.totalFrameUs;
@@ -337,10 +353,33 @@ void sendDspMetrics() {
   doc["inputReadUs"]    = timing.inputReadUs;
   doc["perInputDspUs"]  = timing.perInputDspUs;
   doc["sinkWriteUs"]    = timing.sinkWriteUs;
-  // DSP threshold flags and FIR bypass counter
+  // DMA-driven scheduling: block deadline accounting and input→output latency
+  doc["totalE2eUs"]      = timing.totalE2eUs;
+  doc["ioLatencyUs"]     = timing.inOutLatencyUs;
+  doc["deadlineSlackUs"] = timing.deadlineSlackUs;
+  doc["minSlackUs"]      = timing.minSlackUs;
+  doc["missedDeadlines"] = timing.missedDeadlines;
+  doc["droppedBlocks"]   = timing.droppedBlocks;
+  doc["latencyProfile"]  = timing.latencyProfile;
+  doc["blockFrames"]     = timing.blockFrames;
+  doc["procFrames"]      = timing.procFrames;
+  doc["procRate"]        = timing.procRate;
+  doc["blockOverheadUs"] = timing.blockOverheadUs;
+  // Sample-rate switching: last and worst request-to-resume time, paused gap
+  AudioRateSwitchStats rs = i2s_audio_get_rate_switch_stats();
+  doc["rateSwitchUs"]       = rs.totalUs;
+  doc["rateSwitchGapUs"]    = rs.gapUs;
+  doc["rateSwitchMaxUs"]    = rs.maxTotalUs;
+  doc["rateSwitches"]       = rs.switches;
+  doc["rateSwitchRebuilds"] = rs.rebuilds;
+  doc["rateSwitchRefused"]  = rs.commitFailures;
+  // DSP threshold flags and load governor decisions
   doc["dspCpuWarn"]     = m.cpuWarning;
   doc["dspCpuCrit"]     = m.cpuCritical;
   doc["firBypassCount"] = m.firBypassCount;
+  doc["dspGovLevel"]    = m.governorLevel;
+  doc["dspShedStages"]  = m.shedStageCount;
+  doc["dspShedUs"]      = m.shedCostUs;
   String json;
   serializeJson(doc, json);
   webSocket.broadcastTXT((uint8_t*)json.c_str(), json.length());
@@ -696,6 +735,9 @@ void sendHardwareStats() {
       adcObj["i2sErrors"] = adc.i2sErrors;
       adcObj["consecutiveZeros"] = adc.consecutiveZeros;
       adcObj["totalBuffers"] = adc.totalBuffers;
+      adcObj["captureStalled"] = adc.captureStalled;
+      adcObj["captureUnderruns"] = adc.captureUnderruns;
+      adcObj["captureOverflows"] = adc.captureOverflows;
       adcObj["vrms"] = adc.vrmsCombined;
       adcObj["snrDb"] = appState.audio.snrDb[a];
       adcObj["sfdrDb"] = appState.audio.sfdrDb[a];
@@ -375,12 +375,13 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
             audio_pipeline_bypass_dsp(0, !appState.dsp.enabled);
             audio_pipeline_bypass_dsp(1, !appState.dsp.enabled);
           }
-          if (doc["bypass"].is<bool>()) appState.dsp.bypass = doc["bypass"].as<bool>();
+          bool bypass = doc["bypass"].is<bool>() ? doc["bypass"].as<bool>() : appState.dsp.bypass;
           // Sync global bypass to DSP config (in-DSP bypass, independent of lane enable)
-          dsp_copy_active_to_inactive();
+          if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
           DspState *cfg = dsp_get_inactive_config();
-          cfg->globalBypass = appState.dsp.bypass;
-          if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+          cfg->globalBypass = bypass;
+          if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
+          appState.dsp.bypass = bypass;
           extern void saveDspSettingsDebounced();
           saveDspSettingsDebounced();
           appState.markDspConfigDirty();
@@ -390,7 +391,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int ch = doc["ch"] | -1;
           int typeInt = doc["stageType"] | (int)DSP_BIQUAD_PEQ;
           if (ch >= 0 && ch < DSP_MAX_CHANNELS) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             int idx = dsp_add_stage(ch, (DspStageType)typeInt);
             if (idx >= 0) {
               // Apply optional overrides (e.g., DC Block: freq=10, label="DC Block")
@@ -406,7 +407,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
                 strncpy(added.label, doc["label"].as<const char*>(), sizeof(added.label) - 1);
                 added.label[sizeof(added.label) - 1] = '\0';
               }
-              if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+              if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
               extern void saveDspSettingsDebounced();
               saveDspSettingsDebounced();
               appState.markDspConfigDirty();
@@ -425,9 +426,9 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int ch = doc["ch"] | -1;
           int si = doc["stage"] | -1;
           if (ch >= 0 && ch < DSP_MAX_CHANNELS) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             if (dsp_remove_stage(ch, si)) {
-              if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+              if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
               extern void saveDspSettingsDebounced();
               saveDspSettingsDebounced();
               appState.markDspConfigDirty();
@@ -439,7 +440,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int ch = doc["ch"] | -1;
           int si = doc["stage"] | -1;
           if (ch >= 0 && ch < DSP_MAX_CHANNELS) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             DspState *cfg = dsp_get_inactive_config();
             if (si >= 0 && si < cfg->channels[ch].stageCount) {
               DspStage &s = cfg->channels[ch].stages[si];
@@ -464,6 +465,10 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
                   uint16_t ds = doc["delaySamples"].as<uint16_t>();
                   s.delay.delaySamples = ds > DSP_MAX_DELAY_SAMPLES ? DSP_MAX_DELAY_SAMPLES : ds;
                 }
+                if (doc["fraction"].is<float>() || doc["interp"].is<int>()) {
+                  dsp_delay_set_fraction(s.delay, doc["fraction"] | s.delay.fraction,
+                                         doc["interp"] | (int)s.delay.interp);
+                }
               } else if (s.type == DSP_POLARITY) {
                 if (doc["inverted"].is<bool>()) s.polarity.inverted = doc["inverted"].as<bool>();
               } else if (s.type == DSP_MUTE) {
@@ -508,8 +513,16 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
                 if (doc["order"].is<int>()) s.bassEnhance.order = doc["order"].as<uint8_t>();
                 extern void dsp_compute_bass_enhance_coeffs(DspBassEnhanceParams &, uint32_t);
                 dsp_compute_bass_enhance_coeffs(s.bassEnhance, cfg->sampleRate);
+              } else if (s.type == DSP_TRUE_PEAK_LIMITER) {
+                if (doc["ceilingDb"].is<float>()) s.truePeak.ceilingDb = doc["ceilingDb"].as<float>();
+                if (doc["lookaheadMs"].is<float>()) s.truePeak.lookaheadMs = doc["lookaheadMs"].as<float>();
+                if (doc["releaseMs"].is<float>()) s.truePeak.releaseMs = doc["releaseMs"].as<float>();
+                if (doc["linked"].is<bool>()) s.truePeak.linked = doc["linked"].as<bool>();
+                dsp_tp_clamp_params(s.truePeak);
+              } else if (s.type == DSP_DECIMATOR) {
+                if (doc["factor"].is<int>()) s.decimator.factor = dsp_clamp_decimator_factor(doc["factor"].as<int>());
               }
-              if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+              if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
               extern void saveDspSettingsDebounced();
               saveDspSettingsDebounced();
               appState.markDspConfigDirty();
@@ -528,7 +541,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int ch = doc["ch"] | -1;
           int si = doc["stage"] | -1;
           if (ch >= 0 && ch < DSP_MAX_CHANNELS) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             DspState *cfg = dsp_get_inactive_config();
             bool changed = false;
             if (si >= 0 && si < cfg->channels[ch].stageCount) {
@@ -543,7 +556,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
                 // Pool writes happen after swap to avoid data race with audio task.
                 // First collect numBands change into inactive config, swap, then write pool.
                 if (changed) {
-                  if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+                  if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
                 }
                 // Now safe to write pool — audio task reads the newly-active config
                 // Update per-band params in the pool
@@ -589,7 +602,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int from = doc["from"] | -1;
           int to = doc["to"] | -1;
           if (ch >= 0 && ch < DSP_MAX_CHANNELS && from >= 0 && to >= 0) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             DspState *cfg = dsp_get_inactive_config();
             int cnt = cfg->channels[ch].stageCount;
             if (from < cnt && to < cnt && from != to) {
@@ -604,7 +617,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
               }
               order[to] = tmp;
               if (dsp_reorder_stages(ch, order, cnt)) {
-                if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+                if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
                 extern void saveDspSettingsDebounced();
                 saveDspSettingsDebounced();
                 appState.markDspConfigDirty();
@@ -617,10 +630,10 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int ch = doc["ch"] | -1;
           bool bypass = doc["bypass"] | false;
           if (ch >= 0 && ch < DSP_MAX_CHANNELS) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             DspState *cfg = dsp_get_inactive_config();
             cfg->channels[ch].bypass = bypass;
-            if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+            if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
             extern void saveDspSettingsDebounced();
             saveDspSettingsDebounced();
             appState.markDspConfigDirty();
@@ -630,14 +643,14 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int pair = doc["pair"] | -1;
           bool linked = doc["linked"] | true; // cppcheck-suppress badBitmaskCheck
           if (pair >= 0 && pair <= 1) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             DspState *cfg = dsp_get_inactive_config();
             int chA = pair * 2;
             int chB = pair * 2 + 1;
             cfg->channels[chA].stereoLink = linked;
             cfg->channels[chB].stereoLink = linked;
             if (linked) dsp_mirror_channel_config(chA, chB);
-            if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+            if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
             extern void saveDspSettingsDebounced();
             saveDspSettingsDebounced();
             appState.markDspConfigDirty();
@@ -648,7 +661,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int ch = doc["ch"] | -1;
           int band = doc["band"] | -1;
           if (ch >= 0 && ch < DSP_MAX_CHANNELS && band >= 0 && band < DSP_PEQ_BANDS) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             DspState *cfg = dsp_get_inactive_config();
             if (band < cfg->channels[ch].stageCount) {
               DspStage &s = cfg->channels[ch].stages[band];
@@ -691,7 +704,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
                 cfg->channels[partner].stages[band].biquad.delay[0] = savedDelay0;
                 cfg->channels[partner].stages[band].biquad.delay[1] = savedDelay1;
               }
-              if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+              if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
               extern void saveDspSettingsDebounced();
               saveDspSettingsDebounced();
               appState.markDspConfigDirty();
@@ -703,11 +716,11 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int band = doc["band"] | -1;
           bool en = doc["enabled"] | true; // cppcheck-suppress badBitmaskCheck
           if (ch >= 0 && ch < DSP_MAX_CHANNELS && band >= 0 && band < DSP_PEQ_BANDS) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             DspState *cfg = dsp_get_inactive_config();
             if (band < cfg->channels[ch].stageCount) {
               cfg->channels[ch].stages[band].enabled = en;
-              if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+              if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
               extern void saveDspSettingsDebounced();
               saveDspSettingsDebounced();
               appState.markDspConfigDirty();
@@ -718,13 +731,13 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int ch = doc["ch"] | -1;
           bool en = doc["enabled"] | true; // cppcheck-suppress badBitmaskCheck
           if (ch >= 0 && ch < DSP_MAX_CHANNELS) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             DspState *cfg = dsp_get_inactive_config();
             int limit = cfg->channels[ch].stageCount < DSP_PEQ_BANDS ? cfg->channels[ch].stageCount : DSP_PEQ_BANDS;
             for (int b = 0; b < limit; b++) {
               cfg->channels[ch].stages[b].enabled = en;
             }
-            if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+            if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
             extern void saveDspSettingsDebounced();
             saveDspSettingsDebounced();
             appState.markDspConfigDirty();
@@ -734,9 +747,9 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int from = doc["from"] | -1;
           int to = doc["to"] | -1;
           if (from >= 0 && from < DSP_MAX_CHANNELS && to >= 0 && to < DSP_MAX_CHANNELS && from != to) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             dsp_copy_peq_bands(from, to);
-            if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+            if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
             extern void saveDspSettingsDebounced();
             saveDspSettingsDebounced();
             appState.markDspConfigDirty();
@@ -747,9 +760,9 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int from = doc["from"] | -1;
           int to = doc["to"] | -1;
           if (from >= 0 && from < DSP_MAX_CHANNELS && to >= 0 && to < DSP_MAX_CHANNELS && from != to) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             dsp_copy_chain_stages(from, to);
-            if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+            if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
             extern void saveDspSettingsDebounced();
             saveDspSettingsDebounced();
             appState.markDspConfigDirty();
@@ -812,7 +825,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
               f.close();
               JsonDocument preset;
               if (!deserializeJson(preset, json) && preset["bands"].is<JsonArray>()) {
-                dsp_copy_active_to_inactive();
+                if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
                 DspState *cfg = dsp_get_inactive_config();
                 JsonArray bands = preset["bands"].as<JsonArray>();
                 int b = 0;
@@ -827,7 +840,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
                   dsp_compute_biquad_coeffs(s.biquad, s.type, cfg->sampleRate);
                   b++;
                 }
-                if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+                if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
                 extern void saveDspSettingsDebounced();
                 saveDspSettingsDebounced();
                 appState.markDspConfigDirty();
@@ -929,7 +942,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           float widthMm = doc["baffleWidthMm"] | 250.0f;
           if (ch >= 0 && ch < DSP_MAX_CHANNELS) {
             BaffleStepResult bsr = dsp_baffle_step_correction(widthMm);
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             int idx = dsp_add_stage(ch, DSP_BIQUAD_HIGH_SHELF);
             if (idx >= 0) {
               DspState *cfg = dsp_get_inactive_config();
@@ -937,7 +950,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
               cfg->channels[ch].stages[idx].biquad.gain = bsr.gainDb;
               cfg->channels[ch].stages[idx].biquad.Q = 0.707f;
               dsp_compute_biquad_coeffs(cfg->channels[ch].stages[idx].biquad, DSP_BIQUAD_HIGH_SHELF, cfg->sampleRate);
-              if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+              if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
               extern void saveDspSettingsDebounced();
               saveDspSettingsDebounced();
               appState.markDspConfigDirty();
@@ -1144,7 +1157,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
           int chL = lane * 2;
           int chR = lane * 2 + 1;
           if (lane >= 0 && chR < DSP_MAX_CHANNELS) {
-            dsp_copy_active_to_inactive();
+            if (!dsp_copy_active_to_inactive()) { dsp_log_swap_failure("WebSocket"); return; }
             DspState *cfg = dsp_get_inactive_config();
             // Find-or-create DSP_POLARITY stage in chain region for both L and R channels
             for (int ch = chL; ch <= chR; ch++) {
@@ -1166,7 +1179,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
                 }
               }
             }
-            if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); }
+            if (!dsp_swap_config()) { dsp_log_swap_failure("WebSocket"); return; }
             extern void saveDspSettingsDebounced();
             saveDspSettingsDebounced();
             appState.markDspConfigDirty();
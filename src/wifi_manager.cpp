@@ -988,7 +988,7 @@ void sendWiFiStatus() {
 // ===== WiFi HTTP API Handlers =====
 
 void handleAPRoot() {
-  if (!sendGzipped(server, apHtmlPage_gz, apHtmlPage_gz_len)) {
+  if (!sendGzipped(server, apHtmlPage_gz, apHtmlPage_gz_len, "text/html", apHtmlPage_etag)) {
     server_send_P(200, "text/html", apHtmlPage);
   }
 }
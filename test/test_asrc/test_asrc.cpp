@@ -5,6 +5,7 @@
 //   - asrc_init() initialises filter and history buffers
 //   - asrc_is_active() returns false before set_ratio
 //   - asrc_set_ratio() activates known ratios (44100->48000, 96000->48000)
+//   - asrc_set_ratio() activates every source rate towards 96 kHz processing
 //   - asrc_set_ratio() passthrough on equal rates (srcRate == dstRate)
 //   - asrc_set_ratio() passthrough on unknown ratios
 //   - asrc_set_ratio() lane=0 srcRate==0 deactivates all lanes
@@ -13,6 +14,7 @@
 //   - asrc_process_lane() passthrough when inactive
 //   - asrc_process_lane() output frame count within expected range for 44100->48000
 //   - asrc_process_lane() output frame count for 96000->48000 (downsampling 1:2)
+//   - asrc_process_lane() output frame count for 44100->96000 (128-frame block)
 //   - asrc_process_lane() DC signal is preserved (mean preserved through filter)
 //   - asrc_process_lane() silence in -> silence out
 //   - asrc_process_lane() out-of-range lane returns input frame count
@@ -95,13 +97,21 @@ void test_set_ratio_96k_to_48k_activates() {
     TEST_ASSERT_TRUE(asrc_is_active(0));
 }
 
+void test_set_ratio_96k_processing_targets_activate() {
+    const uint32_t src[] = {44100, 48000, 88200, 176400, 192000};
+    for (size_t i = 0; i < sizeof(src) / sizeof(src[0]); i++) {
+        asrc_set_ratio(0, src[i], 96000);
+        TEST_ASSERT_TRUE(asrc_is_active(0));
+    }
+}
+
 void test_set_ratio_equal_rates_passthrough() {
     asrc_set_ratio(0, 48000, 48000);
     TEST_ASSERT_FALSE(asrc_is_active(0));
 }
 
 void test_set_ratio_unknown_passthrough() {
-    asrc_set_ratio(0, 44100, 96000);  // Not in ratio table
+    asrc_set_ratio(0, 32000, 48000);  // Not in ratio table
     TEST_ASSERT_FALSE(asrc_is_active(0));
 }
 
@@ -267,6 +277,16 @@ void test_48k_to_44100_activates() {
     TEST_ASSERT_TRUE(asrc_is_active(0));
 }
 
+void test_process_44100_to_96000_output_count() {
+    // 128 frames @ 44100 → 96000 (the I/O block when processing at twice
+    // the I/O rate): L/M = 320/147, ceil(128 * 320 / 147) = 279
+    asrc_set_ratio(0, 44100, 96000);
+    fill_silence(128);
+    int out = asrc_process_lane(0, s_laneL, s_laneR, 128);
+    TEST_ASSERT_GREATER_OR_EQUAL_INT(277, out);
+    TEST_ASSERT_LESS_OR_EQUAL_INT(ASRC_OUTPUT_FRAMES_MAX, out);
+}
+
 void test_output_frames_max_constant() {
     // ceil(256 * 160 / 147) = 279 ≤ ASRC_OUTPUT_FRAMES_MAX (280)
     const int maxUpOut = (int)ceilf(256.0f * 160.0f / 147.0f);
@@ -364,6 +384,7 @@ int main(int /*argc*/, char** /*argv*/) {
     RUN_TEST(test_is_active_false_before_set_ratio);
     RUN_TEST(test_set_ratio_known_activates);
     RUN_TEST(test_set_ratio_96k_to_48k_activates);
+    RUN_TEST(test_set_ratio_96k_processing_targets_activate);
     RUN_TEST(test_set_ratio_equal_rates_passthrough);
     RUN_TEST(test_set_ratio_unknown_passthrough);
     RUN_TEST(test_set_ratio_zero_src_deactivates_lane);
@@ -381,6 +402,7 @@ int main(int /*argc*/, char** /*argv*/) {
     RUN_TEST(test_reinit_after_deinit);
     RUN_TEST(test_multiple_lanes_independent);
     RUN_TEST(test_48k_to_44100_activates);
+    RUN_TEST(test_process_44100_to_96000_output_count);
     RUN_TEST(test_output_frames_max_constant);
     RUN_TEST(test_process_88200_to_48000_output_count);
     RUN_TEST(test_process_176400_to_48000_output_count);
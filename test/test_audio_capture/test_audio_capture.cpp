@@ -0,0 +1,348 @@
+// test_audio_capture.cpp
+// Readiness-based multi-port input capture: mocked I2S RX channels with
+// their own DMA clocks, descriptor sizes and phases drive per-lane jitter
+// FIFOs the way the pipeline does (fill every lane, then take one block from
+// each). Covers a stalled port next to healthy ones, jitter around the
+// snapshot, a lane whose clock runs ahead, recovery, FIFO wrap and backlog,
+// and small blocks.
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../../src/audio_capture.h"
+
+// Simulated clock: 51.2 kHz keeps the periods integral (256 frames = 5000 us)
+#define SIM_RATE      51200
+#define SIM_BLOCK     256
+#define SIM_PERIOD_US 5000
+#define SIM_PORTS     3
+
+static uint32_t frames_to_us(uint32_t frames) {
+    return (uint32_t)((uint64_t)frames * 1000000ULL / SIM_RATE);
+}
+
+// One mocked I2S RX channel. Frame n carries L = n, R = -n.
+struct MockPort {
+    uint32_t descFrames;
+    uint32_t descUs;
+    uint32_t nextUs;        // Nominal completion of the next descriptor
+    uint32_t jitterUs;      // Completions land pseudo-randomly within +/- jitterUs/2
+    uint32_t completions;
+    uint32_t stallFromUs;   // No descriptors complete in [stallFromUs, stallUntilUs), 0 = forever
+    uint32_t stallUntilUs;
+    uint32_t dmaFrames;     // Completed by DMA
+    uint32_t readFrames;    // Consumed by reads
+    uint32_t reads;
+    uint32_t blockingReads; // Reads asking for more than was ready (would wait)
+};
+
+static MockPort _port[SIM_PORTS];
+static AudioCaptureLane _lane[SIM_PORTS];
+static int32_t _fifo[SIM_PORTS][AUDIO_CAPTURE_FIFO_FRAMES * 2];
+static int32_t _buf[AUDIO_BLOCK_FRAMES_MAX * 2];
+
+template <int P>
+static uint32_t mock_available(void) {
+    return _port[P].dmaFrames - _port[P].readFrames;
+}
+
+template <int P>
+static uint32_t mock_read(int32_t *dst, uint32_t frames) {
+    MockPort &m = _port[P];
+    m.reads++;
+    uint32_t ready = m.dmaFrames - m.readFrames;
+    if (frames > ready) {
+        m.blockingReads++;
+        frames = ready;
+    }
+    for (uint32_t i = 0; i < frames; i++) {
+        int32_t n = (int32_t)(m.readFrames + i);
+        dst[i * 2] = n;
+        dst[i * 2 + 1] = -n;
+    }
+    m.readFrames += frames;
+    return frames;
+}
+
+static const AudioCaptureReadFn _readFn[SIM_PORTS] = { mock_read<0>, mock_read<1>, mock_read<2> };
+static const AudioCaptureAvailFn _availFn[SIM_PORTS] = { mock_available<0>, mock_available<1>, mock_available<2> };
+
+static void port_init(int p, uint32_t descFrames, uint32_t phaseUs = 0, uint32_t jitterUs = 0,
+                      uint32_t descUs = 0) {
+    MockPort &m = _port[p];
+    memset(&m, 0, sizeof(m));
+    m.descFrames = descFrames;
+    m.descUs = descUs ? descUs : frames_to_us(descFrames);
+    m.nextUs = phaseUs + m.descUs;
+    m.jitterUs = jitterUs;
+}
+
+static void port_stall(int p, uint32_t fromUs, uint32_t untilUs) {
+    _port[p].stallFromUs = fromUs;
+    _port[p].stallUntilUs = untilUs;
+}
+
+// Run every port's DMA up to `until`
+static void ports_advance(uint32_t until) {
+    for (int p = 0; p < SIM_PORTS; p++) {
+        MockPort &m = _port[p];
+        if (m.descFrames == 0) continue;
+        for (;;) {
+            uint32_t jitter = m.jitterUs ? ((m.completions * 2654435761u) >> 16) % (m.jitterUs + 1) : 0;
+            uint32_t at = m.nextUs + jitter - m.jitterUs / 2;
+            if ((int32_t)(until - at) < 0) break;
+            bool stalled = m.stallFromUs && (int32_t)(at - m.stallFromUs) >= 0 &&
+                           (!m.stallUntilUs || (int32_t)(at - m.stallUntilUs) < 0);
+            if (!stalled) m.dmaFrames += m.descFrames;
+            m.nextUs += m.descUs;
+            m.completions++;
+        }
+    }
+}
+
+// Per-lane results of a run
+struct LaneRun {
+    uint32_t fullBlocks;
+    uint32_t shortBlocks;
+    uint32_t frames;
+    uint32_t discontinuities;
+    uint32_t nonZeroPad;        // Padding that was not silence
+    uint32_t maxLevelAfterTake;
+    int32_t next;               // Expected L of the next captured frame
+    uint32_t overflowsSeen;
+};
+
+static LaneRun _run[SIM_PORTS];
+
+static void sim_reset(void) {
+    memset(_run, 0, sizeof(_run));
+    for (int p = 0; p < SIM_PORTS; p++) {
+        _lane[p].fifo = _fifo[p];
+        audio_capture_reset(_lane[p]);
+        _port[p] = MockPort();
+    }
+}
+
+// One pipeline block at nowUs: fill every lane under one timestamp, then take
+static void sim_block(uint32_t nowUs, uint32_t frames = SIM_BLOCK, int ports = SIM_PORTS) {
+    ports_advance(nowUs);
+    for (int p = 0; p < ports; p++) {
+        audio_capture_fill(_lane[p], _availFn[p], _readFn[p], nowUs);
+    }
+    for (int p = 0; p < ports; p++) {
+        LaneRun &r = _run[p];
+        // Frames dropped by the previous take are skipped in the stream
+        r.next += (int32_t)(_lane[p].overflows - r.overflowsSeen);
+        r.overflowsSeen = _lane[p].overflows;
+        memset(_buf, 0x5A, sizeof(_buf));
+        uint32_t n = audio_capture_take(_lane[p], _buf, frames);
+        for (uint32_t i = 0; i < n; i++) {
+            if (_buf[i * 2] != r.next || _buf[i * 2 + 1] != -r.next) r.discontinuities++;
+            r.next = _buf[i * 2] + 1;
+        }
+        for (uint32_t i = n * 2; i < frames * 2; i++) {
+            if (_buf[i] != 0) r.nonZeroPad++;
+        }
+        if (n == frames) r.fullBlocks++; else r.shortBlocks++;
+        r.frames += n;
+        uint32_t level = audio_capture_level(_lane[p]);
+        if (level > r.maxLevelAfterTake) r.maxLevelAfterTake = level;
+    }
+}
+
+void setUp(void) {
+    sim_reset();
+}
+
+void tearDown(void) {}
+
+// ===== Isolation =====
+
+void test_stalled_port_does_not_hold_up_other_lanes(void) {
+    const uint32_t blocks = 200;
+    port_init(0, SIM_BLOCK);                 // Clocking port
+    port_init(1, 96, 1700, 300);             // Other phase, odd descriptors, jitter
+    port_init(2, SIM_BLOCK, 900);
+    port_stall(2, 20 * SIM_PERIOD_US, 0);   // Unclocked from block 20 on
+
+    for (uint32_t b = 1; b <= blocks; b++) sim_block(b * SIM_PERIOD_US + 100);
+
+    // Nothing ever waited on a port
+    for (int p = 0; p < SIM_PORTS; p++) TEST_ASSERT_EQUAL(0, _port[p].blockingReads);
+
+    // Healthy lanes keep full throughput: every block full after priming
+    TEST_ASSERT_EQUAL(blocks, _run[0].fullBlocks);
+    TEST_ASSERT_TRUE(_run[1].fullBlocks >= blocks - 2);
+    TEST_ASSERT_TRUE(_run[1].shortBlocks <= 2);          // Priming only
+    TEST_ASSERT_EQUAL(0, _lane[0].underruns);
+    TEST_ASSERT_EQUAL(0, _lane[1].underruns);
+    TEST_ASSERT_EQUAL(0, _run[0].discontinuities);
+    TEST_ASSERT_EQUAL(0, _run[1].discontinuities);
+    TEST_ASSERT_FALSE(_lane[0].stalled);
+    TEST_ASSERT_FALSE(_lane[1].stalled);
+
+    // The dead port is flagged once and delivers silence
+    TEST_ASSERT_TRUE(_lane[2].stalled);
+    TEST_ASSERT_EQUAL(1, _lane[2].stalls);
+    TEST_ASSERT_EQUAL(0, _run[2].nonZeroPad);
+    TEST_ASSERT_EQUAL(0, _run[2].discontinuities);
+    TEST_ASSERT_EQUAL(0, _port[2].readFrames - _port[2].dmaFrames);
+}
+
+void test_stall_flagged_after_stall_blocks(void) {
+    port_init(0, SIM_BLOCK);
+    port_stall(0, 10 * SIM_PERIOD_US, 0);
+    for (uint32_t b = 1; b < 10; b++) sim_block(b * SIM_PERIOD_US + 100, SIM_BLOCK, 1);
+    TEST_ASSERT_FALSE(_lane[0].stalled);
+
+    uint32_t b = 10;
+    for (uint32_t k = 1; k < AUDIO_CAPTURE_STALL_BLOCKS; k++, b++) {
+        sim_block(b * SIM_PERIOD_US + 100, SIM_BLOCK, 1);
+        TEST_ASSERT_FALSE(_lane[0].stalled);
+    }
+    sim_block(b * SIM_PERIOD_US + 100, SIM_BLOCK, 1);
+    TEST_ASSERT_TRUE(_lane[0].stalled);
+    TEST_ASSERT_EQUAL(AUDIO_CAPTURE_STALL_BLOCKS, _lane[0].emptyBlocks);
+    TEST_ASSERT_EQUAL(1, _lane[0].underruns);     // The first empty block
+    TEST_ASSERT_EQUAL(0, _port[0].blockingReads);
+}
+
+void test_stalled_port_recovers(void) {
+    port_init(0, SIM_BLOCK);
+    port_init(1, SIM_BLOCK, 2500);
+    port_stall(1, 10 * SIM_PERIOD_US, 40 * SIM_PERIOD_US);
+    for (uint32_t b = 1; b <= 39; b++) sim_block(b * SIM_PERIOD_US + 100, SIM_BLOCK, 2);
+    TEST_ASSERT_TRUE(_lane[1].stalled);
+    uint32_t fullBefore = _run[1].fullBlocks;
+
+    for (uint32_t b = 40; b <= 80; b++) sim_block(b * SIM_PERIOD_US + 100, SIM_BLOCK, 2);
+    TEST_ASSERT_FALSE(_lane[1].stalled);
+    TEST_ASSERT_EQUAL(1, _lane[1].stalls);
+    TEST_ASSERT_TRUE(_run[1].fullBlocks - fullBefore >= 39);   // Re-primes within a block or two
+    TEST_ASSERT_EQUAL(0, _run[1].discontinuities);
+    TEST_ASSERT_EQUAL(0, _run[1].nonZeroPad);
+    TEST_ASSERT_EQUAL(80, _run[0].fullBlocks);
+}
+
+// ===== Jitter FIFO =====
+
+void test_jitter_around_snapshot_settles(void) {
+    // Descriptors of the second port complete right around the snapshot:
+    // the lane learns a margin after an underrun or two, then runs clean
+    port_init(0, SIM_BLOCK);
+    port_init(1, 64, 100 - 1250, 160);
+    for (uint32_t b = 1; b <= 100; b++) sim_block(b * SIM_PERIOD_US + 100, SIM_BLOCK, 2);
+    uint32_t settled = _lane[1].underruns;
+    TEST_ASSERT_TRUE(settled <= 2);
+    TEST_ASSERT_TRUE(_lane[1].margin > 0 || settled == 0);
+    TEST_ASSERT_TRUE(_lane[1].margin <= SIM_BLOCK / 2);
+
+    for (uint32_t b = 101; b <= 300; b++) sim_block(b * SIM_PERIOD_US + 100, SIM_BLOCK, 2);
+    TEST_ASSERT_EQUAL(settled, _lane[1].underruns);
+    TEST_ASSERT_EQUAL(0, _run[1].discontinuities);
+    TEST_ASSERT_EQUAL(0, _lane[0].margin);       // The clocking lane adds no latency
+    TEST_ASSERT_EQUAL(300, _run[0].fullBlocks);
+}
+
+void test_lane_running_ahead_drops_oldest(void) {
+    // 1% fast clock: the lane gains frames and must not build up latency
+    port_init(0, SIM_BLOCK);
+    port_init(1, SIM_BLOCK, 300, 0, SIM_PERIOD_US * 99 / 100);
+    for (uint32_t b = 1; b <= 500; b++) sim_block(b * SIM_PERIOD_US + 100, SIM_BLOCK, 2);
+    TEST_ASSERT_TRUE(_lane[1].overflows > 0);
+    TEST_ASSERT_EQUAL(0, _lane[1].underruns);
+    TEST_ASSERT_TRUE(_run[1].maxLevelAfterTake <= SIM_BLOCK);
+    TEST_ASSERT_EQUAL(0, _run[1].discontinuities);   // Drops are accounted
+    TEST_ASSERT_EQUAL(0, _port[1].blockingReads);
+}
+
+void test_fifo_wraps_with_odd_descriptors(void) {
+    port_init(0, 96, 0, 0);                  // 96 never divides the FIFO
+    for (uint32_t b = 1; b <= 64; b++) sim_block(b * SIM_PERIOD_US + 100, SIM_BLOCK, 1);
+    TEST_ASSERT_TRUE(_lane[0].wr > 8 * AUDIO_CAPTURE_FIFO_FRAMES);
+    TEST_ASSERT_EQUAL(0, _run[0].discontinuities);
+    TEST_ASSERT_EQUAL(0, _port[0].blockingReads);
+}
+
+void test_fill_bounded_by_room(void) {
+    port_init(0, SIM_BLOCK);
+    ports_advance(6 * SIM_PERIOD_US);        // Six blocks backed up in the port
+    uint32_t got = audio_capture_fill(_lane[0], _availFn[0], _readFn[0], 1234);
+    TEST_ASSERT_EQUAL(AUDIO_CAPTURE_FIFO_FRAMES, got);
+    TEST_ASSERT_EQUAL(AUDIO_CAPTURE_FIFO_FRAMES, audio_capture_level(_lane[0]));
+    TEST_ASSERT_EQUAL(6 * SIM_BLOCK - AUDIO_CAPTURE_FIFO_FRAMES, mock_available<0>());
+    TEST_ASSERT_EQUAL(1234, _lane[0].stampUs);
+    TEST_ASSERT_EQUAL(0, _port[0].blockingReads);
+
+    // Still more ready than fits: the oldest buffered frames make way
+    TEST_ASSERT_EQUAL(AUDIO_CAPTURE_FIFO_FRAMES, audio_capture_fill(_lane[0], _availFn[0], _readFn[0], 1300));
+    TEST_ASSERT_EQUAL(AUDIO_CAPTURE_FIFO_FRAMES, _lane[0].overflows);
+    TEST_ASSERT_EQUAL(SIM_BLOCK, audio_capture_take(_lane[0], _buf, SIM_BLOCK));
+    TEST_ASSERT_EQUAL(AUDIO_CAPTURE_FIFO_FRAMES, _buf[0]);
+    TEST_ASSERT_EQUAL(0, _port[0].blockingReads);
+}
+
+void test_priming_waits_for_full_block(void) {
+    port_init(0, SIM_BLOCK / 4);
+    ports_advance(frames_to_us(SIM_BLOCK / 4));
+    audio_capture_fill(_lane[0], _availFn[0], _readFn[0], 0);
+    TEST_ASSERT_EQUAL(0, audio_capture_take(_lane[0], _buf, SIM_BLOCK));
+    TEST_ASSERT_EQUAL(0, _lane[0].underruns);     // Not primed yet: no underrun
+    TEST_ASSERT_EQUAL(SIM_BLOCK / 4, audio_capture_level(_lane[0]));
+
+    ports_advance(frames_to_us(SIM_BLOCK));
+    audio_capture_fill(_lane[0], _availFn[0], _readFn[0], 0);
+    TEST_ASSERT_EQUAL(SIM_BLOCK, audio_capture_take(_lane[0], _buf, SIM_BLOCK));
+    TEST_ASSERT_TRUE(_lane[0].primed);
+    TEST_ASSERT_EQUAL(0, _buf[0]);               // Oldest frame first
+    TEST_ASSERT_EQUAL(SIM_BLOCK - 1, _buf[(SIM_BLOCK - 1) * 2]);
+}
+
+void test_small_blocks(void) {
+    const uint32_t block = AUDIO_BLOCK_FRAMES_MIN;
+    const uint32_t period = frames_to_us(block);   // 625 us
+    port_init(0, block);
+    port_init(1, block / 2, 300, 80);
+    port_init(2, block, 200);
+    port_stall(2, 50 * period, 0);
+    for (uint32_t b = 1; b <= 2000; b++) sim_block(b * period + 20, block);
+    TEST_ASSERT_EQUAL(2000, _run[0].fullBlocks);
+    TEST_ASSERT_TRUE(_run[1].fullBlocks >= 1995);
+    TEST_ASSERT_EQUAL(0, _run[1].discontinuities);
+    TEST_ASSERT_TRUE(_lane[2].stalled);
+    TEST_ASSERT_EQUAL(1, _lane[2].stalls);
+    for (int p = 0; p < SIM_PORTS; p++) TEST_ASSERT_EQUAL(0, _port[p].blockingReads);
+}
+
+void test_reset_keeps_fifo(void) {
+    _lane[0].wr = 100;
+    _lane[0].stalled = true;
+    _lane[0].margin = 64;
+    audio_capture_reset(_lane[0]);
+    TEST_ASSERT_EQUAL_PTR(_fifo[0], _lane[0].fifo);
+    TEST_ASSERT_EQUAL(0, audio_capture_level(_lane[0]));
+    TEST_ASSERT_FALSE(_lane[0].stalled);
+    TEST_ASSERT_EQUAL(0, _lane[0].margin);
+
+    // No FIFO or no readiness query: the lane reads nothing
+    AudioCaptureLane bare = AudioCaptureLane();
+    TEST_ASSERT_EQUAL(0, audio_capture_fill(bare, _availFn[0], _readFn[0], 0));
+    TEST_ASSERT_EQUAL(0, audio_capture_fill(_lane[0], nullptr, _readFn[0], 0));
+    TEST_ASSERT_EQUAL(0, _port[0].reads);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_stalled_port_does_not_hold_up_other_lanes);
+    RUN_TEST(test_stall_flagged_after_stall_blocks);
+    RUN_TEST(test_stalled_port_recovers);
+    RUN_TEST(test_jitter_around_snapshot_settles);
+    RUN_TEST(test_lane_running_ahead_drops_oldest);
+    RUN_TEST(test_fifo_wraps_with_odd_descriptors);
+    RUN_TEST(test_fill_bounded_by_room);
+    RUN_TEST(test_priming_waits_for_full_block);
+    RUN_TEST(test_small_blocks);
+    RUN_TEST(test_reset_keeps_fifo);
+    return UNITY_END();
+}
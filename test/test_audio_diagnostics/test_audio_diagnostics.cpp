@@ -40,6 +40,10 @@ struct AdcDiagnostics {
     unsigned long lastNonZeroMs = 0;
     unsigned long lastReadMs = 0;
     uint32_t totalBuffersRead = 0;
+    bool stalled = false;
+    uint32_t captureStalls = 0;
+    uint32_t captureUnderruns = 0;
+    uint32_t captureOverflows = 0;
 };
 
 #ifndef AUDIO_PIPELINE_MAX_INPUTS
@@ -55,6 +59,7 @@ struct AudioDiagnostics {
 // Per-ADC health status derivation (matches production i2s_audio.cpp)
 AudioHealthStatus audio_derive_health_status(const AdcDiagnostics &diag) {
     if (diag.i2sReadErrors > 10) return AUDIO_I2S_ERROR;
+    if (diag.stalled) return AUDIO_NO_DATA;
     if (diag.consecutiveZeros > 100) return AUDIO_NO_DATA;
     if (diag.clipRate > CLIP_RATE_HW_FAULT) return AUDIO_HW_FAULT;
     if (diag.clipRate > CLIP_RATE_CLIPPING) return AUDIO_CLIPPING;
@@ -289,6 +294,19 @@ void test_health_status_no_data_over_hw_fault(void) {
     TEST_ASSERT_EQUAL(AUDIO_NO_DATA, audio_derive_health_status(diag));
 }
 
+// Test 22: A port flagged stalled by input capture reports NO_DATA, below I2S errors
+void test_health_status_capture_stalled(void) {
+    AdcDiagnostics diag;
+    diag.stalled = true;
+    diag.noiseFloorDbfs = -40.0f;  // Last levels still look like signal
+    TEST_ASSERT_EQUAL(AUDIO_NO_DATA, audio_derive_health_status(diag));
+    diag.i2sReadErrors = 20;
+    TEST_ASSERT_EQUAL(AUDIO_I2S_ERROR, audio_derive_health_status(diag));
+    diag.i2sReadErrors = 0;
+    diag.stalled = false;          // Port recovered
+    TEST_ASSERT_EQUAL(AUDIO_OK, audio_derive_health_status(diag));
+}
+
 int main(int argc, char **argv) {
     UNITY_BEGIN();
     RUN_TEST(test_health_status_ok_normal);
@@ -312,5 +330,6 @@ int main(int argc, char **argv) {
     RUN_TEST(test_health_status_ok_below_clip_threshold);
     RUN_TEST(test_health_status_i2s_error_over_hw_fault);
     RUN_TEST(test_health_status_no_data_over_hw_fault);
+    RUN_TEST(test_health_status_capture_stalled);
     return UNITY_END();
 }
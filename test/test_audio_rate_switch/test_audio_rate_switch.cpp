@@ -0,0 +1,268 @@
+// test_audio_rate_switch.cpp
+// Sample-rate switch sequencing against fake ops on a simulated clock:
+// phase order while audio runs, a caller that already paused, bounded fade
+// wait, fallback to rebuilding the channels, a failed publish retried while
+// paused and refused if it fails again, timing fields; and the output
+// fade ramp the audio task applies across blocks.
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../../src/audio_rate_switch.h"
+
+// ===== Fake ops =====
+
+struct Fake {
+    char log[256];          // One letter per op call
+    uint32_t now;
+    uint32_t step;          // Clock advance per op call
+    int fadeBlocks;         // faded() calls before the output reports silence
+    bool reclockOk;
+    int commitFails;        // commit() calls that fail before one succeeds
+    uint32_t rate;          // Last rate handed to prepare/reclock/rebuild/retarget
+    uint8_t phaseAt[16];    // Stats phase seen by each op, in call order
+    int calls;
+};
+
+static Fake _f;
+static AudioRateSwitchStats _st;
+
+static void _op(char c) {
+    size_t n = strlen(_f.log);
+    if (n + 1 < sizeof(_f.log)) { _f.log[n] = c; _f.log[n + 1] = 0; }
+    if (_f.calls < 16) _f.phaseAt[_f.calls] = _st.phase;
+    _f.calls++;
+    _f.now += _f.step;
+}
+
+static void f_prepare(uint32_t r) { _f.rate = r; _op('P'); }
+static void f_fade(bool mute) { _op(mute ? 'F' : 'f'); }
+static bool f_faded() { return _f.fadeBlocks-- <= 0; }
+static bool f_commit() { _op('C'); return _f.commitFails-- <= 0; }
+static void f_pause() { _op('S'); }
+static void f_resume() { _op('R'); }
+static bool f_reclock(uint32_t r) { _f.rate = r; _op('K'); return _f.reclockOk; }
+static void f_rebuild(uint32_t r) { _f.rate = r; _op('B'); }
+static void f_retarget(uint32_t r) { _f.rate = r; _op('T'); }
+static uint32_t f_now() { return _f.now; }
+static void f_wait() { _f.now += 1000; }
+
+static const AudioRateSwitchOps _ops = {
+    f_prepare, f_fade, f_faded, f_commit, f_pause, f_resume,
+    f_reclock, f_rebuild, f_retarget, f_now, f_wait,
+};
+
+void setUp(void) {
+    memset(&_f, 0, sizeof(_f));
+    memset(&_st, 0, sizeof(_st));
+    _f.now = 1000;
+    _f.step = 100;
+    _f.fadeBlocks = 2;
+    _f.reclockOk = true;
+}
+
+void tearDown(void) {}
+
+// ===== Sequencing =====
+
+void test_running_switch_fades_around_the_reclock(void) {
+    TEST_ASSERT_EQUAL_UINT8(AUDIO_RATE_SWITCH_IN_PLACE, audio_rate_switch_run(_st, _ops, 48000, 96000, true));
+    // Stage, fade out, publish while silent, pause, reclock, retarget, fade in, resume
+    TEST_ASSERT_EQUAL_STRING("PFCSKTfR", _f.log);
+    TEST_ASSERT_EQUAL_UINT32(96000, _f.rate);
+    TEST_ASSERT_EQUAL_UINT32(48000, _st.fromRate);
+    TEST_ASSERT_EQUAL_UINT32(96000, _st.toRate);
+    TEST_ASSERT_EQUAL_UINT32(1, _st.switches);
+    TEST_ASSERT_EQUAL_UINT32(0, _st.rebuilds);
+    TEST_ASSERT_EQUAL_UINT32(0, _st.fadeTimeouts);
+}
+
+void test_phase_is_visible_to_each_op(void) {
+    audio_rate_switch_run(_st, _ops, 48000, 44100, true);
+    const uint8_t expect[] = {
+        AUDIO_RATE_SWITCH_PREPARE,  AUDIO_RATE_SWITCH_FADE_OUT, AUDIO_RATE_SWITCH_COMMIT,
+        AUDIO_RATE_SWITCH_RECLOCK,  AUDIO_RATE_SWITCH_RECLOCK,  AUDIO_RATE_SWITCH_RECLOCK,
+        AUDIO_RATE_SWITCH_FADE_IN,  AUDIO_RATE_SWITCH_FADE_IN,
+    };
+    for (size_t i = 0; i < sizeof(expect); i++) TEST_ASSERT_EQUAL_UINT8(expect[i], _f.phaseAt[i]);
+    TEST_ASSERT_EQUAL_UINT8(AUDIO_RATE_SWITCH_IDLE, _st.phase);
+}
+
+void test_paused_caller_gets_no_fade_or_pause(void) {
+    TEST_ASSERT_EQUAL_UINT8(AUDIO_RATE_SWITCH_IN_PLACE, audio_rate_switch_run(_st, _ops, 48000, 96000, false));
+    TEST_ASSERT_EQUAL_STRING("PCKT", _f.log);
+    TEST_ASSERT_EQUAL_UINT32(0, _st.fadeUs);
+}
+
+void test_fade_wait_is_bounded(void) {
+    _f.fadeBlocks = 1000000;  // Audio task never reaches silence
+    audio_rate_switch_run(_st, _ops, 48000, 96000, true);
+    TEST_ASSERT_EQUAL_UINT32(1, _st.fadeTimeouts);
+    TEST_ASSERT_TRUE(_st.fadeUs >= AUDIO_RATE_SWITCH_FADE_TIMEOUT_US);
+    TEST_ASSERT_TRUE(_st.fadeUs < AUDIO_RATE_SWITCH_FADE_TIMEOUT_US + 2000);
+    // The switch still completes
+    TEST_ASSERT_EQUAL_STRING("PFCSKTfR", _f.log);
+}
+
+void test_refused_clock_falls_back_to_rebuild(void) {
+    _f.reclockOk = false;
+    TEST_ASSERT_EQUAL_UINT8(AUDIO_RATE_SWITCH_REBUILT, audio_rate_switch_run(_st, _ops, 48000, 192000, true));
+    TEST_ASSERT_EQUAL_STRING("PFCSKBTfR", _f.log);
+    TEST_ASSERT_EQUAL_UINT32(192000, _f.rate);
+    TEST_ASSERT_EQUAL_UINT32(1, _st.rebuilds);
+    TEST_ASSERT_EQUAL_UINT32(1, _st.switches);
+}
+
+void test_failed_commit_is_retried_while_paused(void) {
+    _f.commitFails = 1;
+    TEST_ASSERT_EQUAL_UINT8(AUDIO_RATE_SWITCH_IN_PLACE, audio_rate_switch_run(_st, _ops, 48000, 96000, true));
+    // Staged and published again once the audio task is quiescent
+    TEST_ASSERT_EQUAL_STRING("PFCSPCKTfR", _f.log);
+    TEST_ASSERT_EQUAL_UINT32(1, _st.commitRetries);
+    TEST_ASSERT_EQUAL_UINT32(0, _st.commitFailures);
+    TEST_ASSERT_EQUAL_UINT32(1, _st.switches);
+}
+
+void test_switch_refused_when_retry_fails(void) {
+    _f.commitFails = 2;
+    TEST_ASSERT_EQUAL_UINT8(AUDIO_RATE_SWITCH_REFUSED, audio_rate_switch_run(_st, _ops, 48000, 96000, true));
+    // No reclock, rebuild or retarget; the output fades back in
+    TEST_ASSERT_EQUAL_STRING("PFCSPCfR", _f.log);
+    TEST_ASSERT_EQUAL_UINT32(1, _st.commitFailures);
+    TEST_ASSERT_EQUAL_UINT32(0, _st.switches);
+    TEST_ASSERT_EQUAL_UINT32(0, _st.rebuilds);
+    TEST_ASSERT_EQUAL_UINT8(AUDIO_RATE_SWITCH_IDLE, _st.phase);
+}
+
+void test_paused_caller_refused_without_fade(void) {
+    _f.commitFails = 2;
+    TEST_ASSERT_EQUAL_UINT8(AUDIO_RATE_SWITCH_REFUSED, audio_rate_switch_run(_st, _ops, 48000, 96000, false));
+    TEST_ASSERT_EQUAL_STRING("PCPC", _f.log);
+}
+
+void test_timings_split_the_switch(void) {
+    // Each op costs 100 us; two fade waits cost 1000 us each
+    audio_rate_switch_run(_st, _ops, 48000, 96000, true);
+    TEST_ASSERT_EQUAL_UINT32(100, _st.prepareUs);
+    TEST_ASSERT_EQUAL_UINT32(100 + 2000, _st.fadeUs);
+    TEST_ASSERT_EQUAL_UINT32(100, _st.commitUs);
+    TEST_ASSERT_EQUAL_UINT32(500, _st.gapUs);     // pause, reclock, retarget, fade, resume
+    TEST_ASSERT_EQUAL_UINT32(_st.prepareUs + _st.fadeUs + _st.commitUs + _st.gapUs, _st.totalUs);
+    TEST_ASSERT_EQUAL_UINT32(_st.totalUs, _st.maxTotalUs);
+
+    // A faster second switch keeps the worst case
+    uint32_t worst = _st.maxTotalUs;
+    _f.fadeBlocks = 0;
+    audio_rate_switch_run(_st, _ops, 96000, 48000, true);
+    TEST_ASSERT_TRUE(_st.totalUs < worst);
+    TEST_ASSERT_EQUAL_UINT32(worst, _st.maxTotalUs);
+    TEST_ASSERT_EQUAL_UINT32(2, _st.switches);
+}
+
+void test_timings_survive_clock_wrap(void) {
+    _f.now = 0xFFFFFF00u;
+    audio_rate_switch_run(_st, _ops, 48000, 96000, true);
+    TEST_ASSERT_EQUAL_UINT32(100 + 2100 + 100 + 500, _st.totalUs);
+}
+
+// ===== Output fade =====
+
+#define BLOCK 64
+
+static float _l[BLOCK], _r[BLOCK];
+
+static void fill(float v) {
+    for (int i = 0; i < BLOCK; i++) { _l[i] = v; _r[i] = v; }
+}
+
+void test_fade_reaches_silence_after_fade_frames(void) {
+    float *ch[2] = {_l, _r};
+    float g = 1.0f;
+    int blocks = 0;
+    while (g > 0.0f && blocks < 100) {
+        fill(1.0f);
+        g = audio_output_fade(ch, 2, BLOCK, g, true);
+        blocks++;
+    }
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, g);
+    TEST_ASSERT_EQUAL_INT(AUDIO_RATE_SWITCH_FADE_FRAMES / BLOCK, blocks);
+    // Last frame of the last block is silent, both channels
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, _l[BLOCK - 1]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, _r[BLOCK - 1]);
+}
+
+void test_fade_ramp_is_continuous_across_blocks(void) {
+    float *ch[1] = {_l};
+    float g = 1.0f;
+    float prev = 1.0f;
+    const float step = 1.0f / AUDIO_RATE_SWITCH_FADE_FRAMES;
+    for (int b = 0; b < AUDIO_RATE_SWITCH_FADE_FRAMES / BLOCK; b++) {
+        fill(1.0f);
+        g = audio_output_fade(ch, 1, BLOCK, g, true);
+        for (int i = 0; i < BLOCK; i++) {
+            TEST_ASSERT_FLOAT_WITHIN(1e-5f, step, prev - _l[i]);
+            prev = _l[i];
+        }
+    }
+}
+
+void test_muted_output_stays_silent(void) {
+    float *ch[2] = {_l, _r};
+    fill(0.5f);
+    float g = audio_output_fade(ch, 2, BLOCK, 0.0f, true);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, g);
+    for (int i = 0; i < BLOCK; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(0.0f, _l[i]);
+        TEST_ASSERT_EQUAL_FLOAT(0.0f, _r[i]);
+    }
+}
+
+void test_fade_in_returns_to_unity(void) {
+    float *ch[2] = {_l, _r};
+    float g = 0.0f;
+    for (int b = 0; b < AUDIO_RATE_SWITCH_FADE_FRAMES / BLOCK; b++) {
+        fill(1.0f);
+        g = audio_output_fade(ch, 2, BLOCK, g, false);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, g);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, _l[BLOCK - 1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f / AUDIO_RATE_SWITCH_FADE_FRAMES, 1.0f - _l[BLOCK - 2]);
+}
+
+void test_unity_gain_leaves_buffers_untouched(void) {
+    float *ch[2] = {_l, _r};
+    fill(0.25f);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, audio_output_fade(ch, 2, BLOCK, 1.0f, false));
+    for (int i = 0; i < BLOCK; i++) TEST_ASSERT_EQUAL_FLOAT(0.25f, _l[i]);
+}
+
+void test_fade_skips_missing_channels(void) {
+    float *ch[3] = {_l, nullptr, _r};
+    fill(1.0f);
+    float g = audio_output_fade(ch, 3, BLOCK, 1.0f, true);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f - (float)BLOCK / AUDIO_RATE_SWITCH_FADE_FRAMES, g);
+    TEST_ASSERT_EQUAL_FLOAT(_l[BLOCK - 1], _r[BLOCK - 1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, g, _r[BLOCK - 1]);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_running_switch_fades_around_the_reclock);
+    RUN_TEST(test_phase_is_visible_to_each_op);
+    RUN_TEST(test_paused_caller_gets_no_fade_or_pause);
+    RUN_TEST(test_fade_wait_is_bounded);
+    RUN_TEST(test_refused_clock_falls_back_to_rebuild);
+    RUN_TEST(test_failed_commit_is_retried_while_paused);
+    RUN_TEST(test_switch_refused_when_retry_fails);
+    RUN_TEST(test_paused_caller_refused_without_fade);
+    RUN_TEST(test_timings_split_the_switch);
+    RUN_TEST(test_timings_survive_clock_wrap);
+    RUN_TEST(test_fade_reaches_silence_after_fade_frames);
+    RUN_TEST(test_fade_ramp_is_continuous_across_blocks);
+    RUN_TEST(test_muted_output_stays_silent);
+    RUN_TEST(test_fade_in_returns_to_unity);
+    RUN_TEST(test_unity_gain_leaves_buffers_untouched);
+    RUN_TEST(test_fade_skips_missing_channels);
+    return UNITY_END();
+}
@@ -0,0 +1,278 @@
+// test_audio_scheduler.cpp
+// DMA-completion-driven block scheduler: latency profile geometry, block
+// notifications from sub-block descriptors, deadline / slack accounting,
+// latency reporting, a simulated clock that drives the ISR and the task
+// through late blocks, long stalls and DMA overruns, runtime block sizes and
+// the per-block cost fit.
+
+#include <unity.h>
+#include <stdint.h>
+
+#include "../../src/audio_scheduler.h"
+
+// Simulated clock: 51.2 kHz keeps the periods integral (256 frames = 5000 us)
+#define SIM_RATE      51200
+#define SIM_BLOCK     256
+#define SIM_PERIOD_US 5000
+#define SIM_TX_FRAMES 512
+
+struct Sim {
+    AudioScheduler s;
+    uint32_t now;
+    uint32_t nextDma;       // Next descriptor completion
+    uint32_t descUs;
+    uint32_t descFrames;
+    int notifies;
+};
+
+static Sim _m;
+
+static void sim_init(Sim &m, uint8_t profile, uint32_t startUs = 0, uint32_t block = SIM_BLOCK) {
+    AudioDmaGeometry g = audio_latency_dma(profile, block);
+    audio_sched_init(m.s, block, g, SIM_RATE);
+    m.now = startUs;
+    m.descFrames = g.descFrames;
+    m.descUs = (uint32_t)((uint64_t)g.descFrames * 1000000ULL / SIM_RATE);
+    m.nextDma = startUs + m.descUs;
+    m.notifies = 0;
+}
+
+// Run the DMA (ISR side) up to `until`
+static void sim_advance(Sim &m, uint32_t until) {
+    while ((int32_t)(until - m.nextDma) >= 0) {
+        if (audio_sched_on_dma(m.s, m.descFrames, m.nextDma)) m.notifies++;
+        m.nextDma += m.descUs;
+    }
+    m.now = until;
+}
+
+// One audio task iteration: block on the notification, process for procUs,
+// write out. Returns the blocks discarded by recovery.
+static uint32_t sim_block(Sim &m, uint32_t procUs, uint32_t txFrames = SIM_TX_FRAMES) {
+    while (audio_sched_pending(m.s) == 0) sim_advance(m, m.nextDma);
+    uint32_t discard = audio_sched_begin(m.s);
+    sim_advance(m, m.now + procUs);
+    audio_sched_end(m.s, m.now, txFrames);
+    return discard;
+}
+
+void setUp(void) {
+    sim_init(_m, AUDIO_LATENCY_BALANCED);
+}
+
+void tearDown(void) {}
+
+// ===== Geometry =====
+
+void test_profiles_hold_at_least_two_blocks(void) {
+    for (uint8_t p = 0; p < AUDIO_LATENCY_PROFILE_COUNT; p++) {
+        AudioDmaGeometry g = audio_latency_dma(p);
+        TEST_ASSERT_TRUE(g.descFrames <= I2S_DMA_BUF_LEN);
+        TEST_ASSERT_EQUAL(0, I2S_DMA_BUF_LEN % g.descFrames);
+        TEST_ASSERT_TRUE((uint32_t)g.descCount * g.descFrames >= 2u * I2S_DMA_BUF_LEN);
+    }
+    // Runway shrinks from safe to low; safe is the legacy geometry
+    AudioDmaGeometry lo = audio_latency_dma(AUDIO_LATENCY_LOW);
+    AudioDmaGeometry bal = audio_latency_dma(AUDIO_LATENCY_BALANCED);
+    AudioDmaGeometry safe = audio_latency_dma(AUDIO_LATENCY_SAFE);
+    TEST_ASSERT_TRUE(lo.descCount * lo.descFrames < bal.descCount * bal.descFrames);
+    TEST_ASSERT_TRUE(bal.descCount * bal.descFrames < safe.descCount * safe.descFrames);
+    TEST_ASSERT_EQUAL(I2S_DMA_BUF_COUNT, safe.descCount);
+    TEST_ASSERT_EQUAL_STRING("low", audio_latency_profile_name(AUDIO_LATENCY_LOW));
+    TEST_ASSERT_EQUAL_STRING("safe", audio_latency_profile_name(200));
+}
+
+void test_short_descriptors_notify_once_per_block(void) {
+    sim_init(_m, AUDIO_LATENCY_LOW);   // 128-frame descriptors
+    sim_advance(_m, 10 * SIM_PERIOD_US);
+    TEST_ASSERT_EQUAL(20, _m.s.dmaFrames / 128);
+    TEST_ASSERT_EQUAL(10, _m.notifies);
+    TEST_ASSERT_EQUAL(10, audio_sched_pending(_m.s));
+}
+
+// ===== Deadlines =====
+
+void test_steady_state_meets_every_deadline(void) {
+    for (int i = 0; i < 200; i++) TEST_ASSERT_EQUAL(0, sim_block(_m, 1200));
+    TEST_ASSERT_EQUAL(200, _m.s.blocks);
+    TEST_ASSERT_EQUAL(0, _m.s.missed);
+    TEST_ASSERT_EQUAL(0, _m.s.dropped);
+    TEST_ASSERT_EQUAL(1200, _m.s.e2eUs);
+    TEST_ASSERT_EQUAL(SIM_PERIOD_US - 1200, _m.s.slackUs);
+    TEST_ASSERT_EQUAL(SIM_PERIOD_US - 1200, _m.s.minSlackUs);
+    // One period of capture + processing + what the output DMA holds
+    TEST_ASSERT_EQUAL(SIM_PERIOD_US + 1200 + SIM_TX_FRAMES * 1000000u / SIM_RATE, _m.s.latencyUs);
+    // The task sleeps on the notification between blocks
+    TEST_ASSERT_EQUAL(200, _m.notifies);
+}
+
+void test_late_block_is_worked_off_without_dropping(void) {
+    for (int i = 0; i < 10; i++) sim_block(_m, 1000);
+    // One block takes 1.5 periods: its deadline is missed, the next block is
+    // already pending and is caught up back to back
+    TEST_ASSERT_EQUAL(0, sim_block(_m, 7500));
+    TEST_ASSERT_EQUAL(1, _m.s.missed);
+    TEST_ASSERT_TRUE(_m.s.slackUs < 0);
+    TEST_ASSERT_EQUAL(1, audio_sched_pending(_m.s));
+    for (int i = 0; i < 10; i++) TEST_ASSERT_EQUAL(0, sim_block(_m, 1000));
+    TEST_ASSERT_EQUAL(0, _m.s.dropped);
+    TEST_ASSERT_EQUAL(0, _m.s.recoveries);
+    // Back on time
+    TEST_ASSERT_EQUAL(1000, _m.s.e2eUs);
+    TEST_ASSERT_EQUAL(SIM_PERIOD_US - 7500, _m.s.minSlackUs);
+}
+
+void test_long_stall_recovers_to_baseline_latency(void) {
+    for (int i = 0; i < 10; i++) sim_block(_m, 1000);
+    uint32_t baseline = _m.s.latencyUs;
+    // 4.2-period stall: four blocks pile up behind it
+    sim_block(_m, 21000);
+    TEST_ASSERT_EQUAL(4, audio_sched_pending(_m.s));
+    // Recovery discards all but the newest block instead of replaying them
+    uint32_t discard = sim_block(_m, 1000);
+    TEST_ASSERT_EQUAL(3, discard);
+    TEST_ASSERT_EQUAL(1, _m.s.recoveries);
+    TEST_ASSERT_EQUAL(3, _m.s.dropped);
+    // The newest block completed 1 ms before the stall ended
+    TEST_ASSERT_EQUAL(2000, _m.s.e2eUs);
+    for (int i = 0; i < 10; i++) TEST_ASSERT_EQUAL(0, sim_block(_m, 1000));
+    TEST_ASSERT_EQUAL(baseline, _m.s.latencyUs);
+    TEST_ASSERT_EQUAL(1, _m.s.recoveries);
+}
+
+void test_backlog_up_to_limit_is_not_discarded(void) {
+    for (int i = 0; i < 5; i++) sim_block(_m, 1000);
+    // Stall leaves exactly AUDIO_SCHED_MAX_BACKLOG blocks pending
+    sim_block(_m, AUDIO_SCHED_MAX_BACKLOG * SIM_PERIOD_US + 500);
+    TEST_ASSERT_EQUAL(AUDIO_SCHED_MAX_BACKLOG, audio_sched_pending(_m.s));
+    TEST_ASSERT_EQUAL(0, sim_block(_m, 1000));
+    TEST_ASSERT_EQUAL(0, _m.s.dropped);
+}
+
+void test_dma_overrun_skips_overwritten_blocks(void) {
+    sim_init(_m, AUDIO_LATENCY_LOW);   // Ring of 2 blocks
+    for (int i = 0; i < 5; i++) sim_block(_m, 1000);
+    // Ten blocks arrive while the task is stalled; the ring kept two
+    sim_block(_m, 10 * SIM_PERIOD_US + 100);
+    TEST_ASSERT_EQUAL(10, audio_sched_pending(_m.s));
+    uint32_t discard = sim_block(_m, 1000);
+    TEST_ASSERT_EQUAL(1, discard);           // Only what the ring still holds is read
+    TEST_ASSERT_EQUAL(9, _m.s.dropped);      // 8 overwritten + 1 stale
+    TEST_ASSERT_EQUAL(0, audio_sched_pending(_m.s));
+    TEST_ASSERT_EQUAL(0, sim_block(_m, 1000));
+    TEST_ASSERT_EQUAL(1000, _m.s.e2eUs);
+}
+
+void test_counters_survive_wraparound(void) {
+    sim_init(_m, AUDIO_LATENCY_BALANCED, 0xFFFF0000u);
+    _m.s.dmaFrames = 0xFFFFFF00u - 10 * SIM_BLOCK;
+    _m.s.readFrames = _m.s.dmaFrames;
+    for (int i = 0; i < 40; i++) TEST_ASSERT_EQUAL(0, sim_block(_m, 1500));
+    TEST_ASSERT_TRUE(_m.s.dmaFrames < 0x10000u);   // Frame counter wrapped
+    TEST_ASSERT_TRUE(_m.now < 0x10000000u);        // Clock wrapped
+    TEST_ASSERT_EQUAL(0, _m.s.missed);
+    TEST_ASSERT_EQUAL(1500, _m.s.e2eUs);
+}
+
+// ===== Block Sizes =====
+
+void test_block_sizes(void) {
+    TEST_ASSERT_EQUAL(0, audio_block_size_index(32));
+    TEST_ASSERT_EQUAL(3, audio_block_size_index(256));
+    TEST_ASSERT_TRUE(audio_block_frames_valid(64));
+    TEST_ASSERT_TRUE(audio_block_frames_valid(128));
+    TEST_ASSERT_FALSE(audio_block_frames_valid(48));
+    TEST_ASSERT_FALSE(audio_block_frames_valid(16));
+    TEST_ASSERT_FALSE(audio_block_frames_valid(512));
+    TEST_ASSERT_FALSE(audio_block_frames_valid(0));
+}
+
+void test_descriptors_follow_the_block(void) {
+    for (uint32_t b = AUDIO_BLOCK_FRAMES_MIN; b <= AUDIO_BLOCK_FRAMES_MAX; b <<= 1) {
+        for (uint8_t p = 0; p < AUDIO_LATENCY_PROFILE_COUNT; p++) {
+            AudioDmaGeometry g = audio_latency_dma(p, b);
+            TEST_ASSERT_TRUE(g.descFrames <= b);
+            TEST_ASSERT_EQUAL(0, b % g.descFrames);
+            TEST_ASSERT_TRUE((uint32_t)g.descCount * g.descFrames >= 2u * b);
+        }
+    }
+    // The default block keeps the profile geometry; an unsupported one falls back to it
+    AudioDmaGeometry lo = audio_latency_dma(AUDIO_LATENCY_LOW, 256);
+    TEST_ASSERT_EQUAL(4, lo.descCount);
+    TEST_ASSERT_EQUAL(128, lo.descFrames);
+    AudioDmaGeometry bad = audio_latency_dma(AUDIO_LATENCY_BALANCED, 100);
+    TEST_ASSERT_EQUAL(AUDIO_BLOCK_FRAMES_MAX, bad.descFrames);
+    // Low latency at 32 frames: the RX ring holds two blocks
+    AudioDmaGeometry lo32 = audio_latency_dma(AUDIO_LATENCY_LOW, 32);
+    TEST_ASSERT_EQUAL(64, lo32.descCount * lo32.descFrames);
+}
+
+void test_small_block_meets_latency_target(void) {
+    sim_init(_m, AUDIO_LATENCY_LOW, 0, 32);     // 625 us period, 16-frame descriptors
+    TEST_ASSERT_EQUAL(625, _m.s.periodUs);
+    for (int i = 0; i < 400; i++) TEST_ASSERT_EQUAL(0, sim_block(_m, 300, 64));
+    TEST_ASSERT_EQUAL(400, _m.notifies);        // One notification per block
+    TEST_ASSERT_EQUAL(0, _m.s.missed);
+    TEST_ASSERT_EQUAL(300, _m.s.e2eUs);
+    // Capture period + processing + a full two-block TX ring stays under 3 ms
+    TEST_ASSERT_EQUAL(625 + 300 + 1250, _m.s.latencyUs);
+    TEST_ASSERT_TRUE(_m.s.latencyUs < 3000);
+}
+
+void test_small_block_stall_recovers(void) {
+    sim_init(_m, AUDIO_LATENCY_BALANCED, 0, 64);
+    for (int i = 0; i < 20; i++) sim_block(_m, 400);
+    sim_block(_m, 6 * _m.s.periodUs);           // Six blocks pile up in a six-block ring
+    uint32_t discard = sim_block(_m, 400);
+    TEST_ASSERT_TRUE(discard > 0);
+    TEST_ASSERT_EQUAL(1, _m.s.recoveries);
+    for (int i = 0; i < 10; i++) TEST_ASSERT_EQUAL(0, sim_block(_m, 400));
+    TEST_ASSERT_EQUAL(400, _m.s.e2eUs);
+}
+
+// ===== Per-Block Cost =====
+
+void test_cost_fit_needs_two_sizes(void) {
+    AudioBlockCost c = {};
+    float ov = -1.0f, pf = -1.0f;
+    TEST_ASSERT_FALSE(audio_block_cost_fit(c, ov, pf));
+    for (int i = 0; i < 50; i++) audio_block_cost_add(c, 256, 900.0f);
+    TEST_ASSERT_FALSE(audio_block_cost_fit(c, ov, pf));
+    audio_block_cost_add(c, 100, 50.0f);        // Unsupported size is ignored
+    TEST_ASSERT_FALSE(audio_block_cost_fit(c, ov, pf));
+}
+
+void test_cost_fit_splits_overhead(void) {
+    // 40 us per invocation + 2 us per frame
+    AudioBlockCost c = {};
+    for (uint32_t b = 32; b <= 256; b <<= 1) {
+        for (int i = 0; i < 10; i++) audio_block_cost_add(c, b, 40.0f + 2.0f * (float)b);
+    }
+    float ov, pf;
+    TEST_ASSERT_TRUE(audio_block_cost_fit(c, ov, pf));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 40.0f, ov);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.0f, pf);
+
+    // Smoothing: a single outlier moves the estimate by ALPHA only
+    audio_block_cost_add(c, 32, 1000.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 104.0f + AUDIO_BLOCK_COST_ALPHA * (1000.0f - 104.0f), c.us[0]);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_profiles_hold_at_least_two_blocks);
+    RUN_TEST(test_short_descriptors_notify_once_per_block);
+    RUN_TEST(test_steady_state_meets_every_deadline);
+    RUN_TEST(test_late_block_is_worked_off_without_dropping);
+    RUN_TEST(test_long_stall_recovers_to_baseline_latency);
+    RUN_TEST(test_backlog_up_to_limit_is_not_discarded);
+    RUN_TEST(test_dma_overrun_skips_overwritten_blocks);
+    RUN_TEST(test_counters_survive_wraparound);
+    RUN_TEST(test_block_sizes);
+    RUN_TEST(test_descriptors_follow_the_block);
+    RUN_TEST(test_small_block_meets_latency_target);
+    RUN_TEST(test_small_block_stall_recovers);
+    RUN_TEST(test_cost_fit_needs_two_sizes);
+    RUN_TEST(test_cost_fit_splits_overhead);
+    return UNITY_END();
+}
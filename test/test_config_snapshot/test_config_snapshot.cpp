@@ -0,0 +1,350 @@
+// test_config_snapshot.cpp
+// Tests for the A/B binary settings snapshot store.
+//
+// Verifies slot alternation and generation counting, that the live slot is
+// never touched by a save, fallback to the previous generation when the
+// newest slot is corrupt or truncated (power loss mid-write), schema and
+// append-only payload handling, and generation wrap-around. The final test
+// benchmarks save/load latency against the JSON path it replaces; the JSON
+// side includes the ArduinoJson parse when the build has it (the PlatformIO
+// native env does).
+
+#include <unity.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+#include <string>
+
+#if defined(__has_include)
+#if __has_include(<ArduinoJson.h>)
+#include <ArduinoJson.h>
+#define TEST_HAVE_ARDUINOJSON 1
+#endif
+#endif
+
+#include "../test_mocks/Arduino.h"
+#include "../test_mocks/LittleFS.h"
+
+#include "../../src/config_snapshot.h"
+#include "../../src/config_snapshot.cpp"
+
+// Representative payload — same order of size as the settings image
+struct TestPayload {
+    int32_t  timezone;
+    uint32_t screenTimeout;
+    uint8_t  flags[24];
+    uint8_t  adcEnabled[8];
+    char     hostname[64];
+    char     ip[5][40];
+};
+
+// Older layout of the same schema (prefix of TestPayload)
+struct TestPayloadV0 {
+    int32_t  timezone;
+    uint32_t screenTimeout;
+};
+
+static TestPayload makePayload(int32_t tz) {
+    TestPayload p;
+    memset(&p, 0, sizeof(p));
+    p.timezone = tz;
+    p.screenTimeout = 60000;
+    for (int i = 0; i < 24; i++) p.flags[i] = (uint8_t)(i & 1);
+    snprintf(p.hostname, sizeof(p.hostname), "alx-nova-%d", (int)tz);
+    snprintf(p.ip[0], sizeof(p.ip[0]), "192.168.1.%d", (int)(tz & 0xFF));
+    return p;
+}
+
+static void simulateReboot() {
+    config_snapshot_test_reset();
+}
+
+void setUp(void) {
+    MockFS::reset();
+    LittleFS.begin();
+    config_snapshot_test_reset();
+}
+
+void tearDown(void) {}
+
+// ---------------------------------------------------------------------------
+
+void test_load_without_snapshot(void) {
+    TestPayload p;
+    size_t len = 99;
+    TEST_ASSERT_EQUAL(CFG_SNAP_NONE, config_snapshot_load(1, &p, sizeof(p), &len));
+    TEST_ASSERT_EQUAL(0, (int)len);
+    TEST_ASSERT_EQUAL(-1, config_snapshot_get_stats().activeSlot);
+}
+
+void test_save_load_roundtrip(void) {
+    TestPayload in = makePayload(3600);
+    TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_save(1, &in, sizeof(in)));
+    TEST_ASSERT_TRUE(LittleFS.exists(CONFIG_SNAPSHOT_PATH_A));
+    TEST_ASSERT_FALSE(LittleFS.exists(CONFIG_SNAPSHOT_PATH_B));
+
+    simulateReboot();
+    TestPayload out;
+    size_t len = 0;
+    TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_load(1, &out, sizeof(out), &len));
+    TEST_ASSERT_EQUAL(sizeof(in), len);
+    TEST_ASSERT_EQUAL_MEMORY(&in, &out, sizeof(in));
+    TEST_ASSERT_EQUAL_UINT32(1, config_snapshot_get_stats().generation);
+    TEST_ASSERT_EQUAL(0, config_snapshot_get_stats().activeSlot);
+}
+
+void test_slots_alternate_and_generation_increments(void) {
+    for (int i = 1; i <= 5; i++) {
+        TestPayload p = makePayload(i);
+        TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_save(1, &p, sizeof(p)));
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)i, config_snapshot_get_stats().generation);
+        TEST_ASSERT_EQUAL((i - 1) % 2, config_snapshot_get_stats().activeSlot);
+    }
+    simulateReboot();
+    TestPayload out;
+    TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_load(1, &out, sizeof(out), nullptr));
+    TEST_ASSERT_EQUAL_INT32(5, out.timezone);
+    TEST_ASSERT_EQUAL_UINT32(5, config_snapshot_get_stats().generation);
+}
+
+void test_save_never_touches_live_slot(void) {
+    TestPayload a = makePayload(1);
+    config_snapshot_save(1, &a, sizeof(a));
+    std::string live = MockFS::getFile(CONFIG_SNAPSHOT_PATH_A);
+
+    TestPayload b = makePayload(2);
+    config_snapshot_save(1, &b, sizeof(b));
+    // Gen 1 is still intact in A while gen 2 went to B
+    TEST_ASSERT_TRUE(live == MockFS::getFile(CONFIG_SNAPSHOT_PATH_A));
+    TEST_ASSERT_TRUE(LittleFS.exists(CONFIG_SNAPSHOT_PATH_B));
+}
+
+void test_save_after_reboot_targets_inactive_slot(void) {
+    TestPayload a = makePayload(1), b = makePayload(2), c = makePayload(3);
+    config_snapshot_save(1, &a, sizeof(a));   // A gen1
+    config_snapshot_save(1, &b, sizeof(b));   // B gen2
+    simulateReboot();
+    // Save without a prior load must still find B as live and write A
+    std::string liveB = MockFS::getFile(CONFIG_SNAPSHOT_PATH_B);
+    config_snapshot_save(1, &c, sizeof(c));
+    TEST_ASSERT_EQUAL(0, config_snapshot_get_stats().activeSlot);
+    TEST_ASSERT_EQUAL_UINT32(3, config_snapshot_get_stats().generation);
+    TEST_ASSERT_TRUE(liveB == MockFS::getFile(CONFIG_SNAPSHOT_PATH_B));
+}
+
+void test_corrupt_newest_falls_back_to_previous(void) {
+    TestPayload a = makePayload(10), b = makePayload(20);
+    config_snapshot_save(1, &a, sizeof(a));
+    config_snapshot_save(1, &b, sizeof(b));   // Newest in B
+
+    std::string bad = MockFS::getFile(CONFIG_SNAPSHOT_PATH_B);
+    bad[sizeof(ConfigSnapshotHeader) + 5] ^= 0x40;   // Flip one payload bit
+    MockFS::injectFile(CONFIG_SNAPSHOT_PATH_B, bad);
+
+    simulateReboot();
+    TestPayload out;
+    TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_load(1, &out, sizeof(out), nullptr));
+    TEST_ASSERT_EQUAL_INT32(10, out.timezone);
+    TEST_ASSERT_EQUAL_UINT32(1, config_snapshot_get_stats().generation);
+    TEST_ASSERT_EQUAL(1, config_snapshot_get_stats().fallbacks);
+
+    // Next save overwrites the corrupt slot, not the good one
+    TestPayload c = makePayload(30);
+    config_snapshot_save(1, &c, sizeof(c));
+    TEST_ASSERT_EQUAL(1, config_snapshot_get_stats().activeSlot);
+    TEST_ASSERT_EQUAL_UINT32(2, config_snapshot_get_stats().generation);
+}
+
+void test_truncated_write_falls_back(void) {
+    TestPayload a = makePayload(10), b = makePayload(20);
+    config_snapshot_save(1, &a, sizeof(a));
+    config_snapshot_save(1, &b, sizeof(b));
+
+    // Power cut mid-write: only part of slot B reached flash
+    std::string partial = MockFS::getFile(CONFIG_SNAPSHOT_PATH_B).substr(0, 40);
+    MockFS::injectFile(CONFIG_SNAPSHOT_PATH_B, partial);
+
+    simulateReboot();
+    TestPayload out;
+    TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_load(1, &out, sizeof(out), nullptr));
+    TEST_ASSERT_EQUAL_INT32(10, out.timezone);
+}
+
+void test_both_slots_corrupt(void) {
+    MockFS::injectFile(CONFIG_SNAPSHOT_PATH_A, "garbage-garbage-garbage-garbage");
+    MockFS::injectFile(CONFIG_SNAPSHOT_PATH_B, "");
+    TestPayload out;
+    TEST_ASSERT_EQUAL(CFG_SNAP_CORRUPT, config_snapshot_load(1, &out, sizeof(out), nullptr));
+}
+
+void test_schema_mismatch_reported(void) {
+    TestPayload a = makePayload(1);
+    config_snapshot_save(1, &a, sizeof(a));
+    simulateReboot();
+    TestPayload out;
+    TEST_ASSERT_EQUAL(CFG_SNAP_SCHEMA, config_snapshot_load(2, &out, sizeof(out), nullptr));
+}
+
+void test_append_only_prefix_decode(void) {
+    TestPayloadV0 old;
+    old.timezone = -7200;
+    old.screenTimeout = 30000;
+    config_snapshot_save(1, &old, sizeof(old));
+    simulateReboot();
+
+    TestPayload out = makePayload(0);   // Defaults for fields added later
+    size_t len = 0;
+    TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_load(1, &out, sizeof(out), &len));
+    TEST_ASSERT_EQUAL(sizeof(old), len);
+    TEST_ASSERT_EQUAL_INT32(-7200, out.timezone);
+    TEST_ASSERT_EQUAL_UINT32(30000, out.screenTimeout);
+    TEST_ASSERT_EQUAL_STRING("alx-nova-0", out.hostname);
+}
+
+void test_oversized_payload_rejected(void) {
+    static uint8_t big[CONFIG_SNAPSHOT_MAX_BYTES + 1];
+    TEST_ASSERT_EQUAL(CFG_SNAP_TOO_LARGE, config_snapshot_save(1, big, sizeof(big)));
+    TEST_ASSERT_FALSE(LittleFS.exists(CONFIG_SNAPSHOT_PATH_A));
+}
+
+void test_generation_wraparound(void) {
+    // Hand-craft a slot at the top of the generation range
+    TestPayload p = makePayload(1);
+    ConfigSnapshotHeader hdr;
+    hdr.magic = CONFIG_SNAPSHOT_MAGIC;
+    hdr.format = CONFIG_SNAPSHOT_FORMAT;
+    hdr.schema = 1;
+    hdr.generation = 0xFFFFFFFFUL;
+    hdr.length = sizeof(p);
+    hdr.crc = config_snapshot_crc32(0, (const uint8_t *)&hdr, offsetof(ConfigSnapshotHeader, crc));
+    hdr.crc = config_snapshot_crc32(hdr.crc, (const uint8_t *)&p, sizeof(p));
+    std::string img((const char *)&hdr, sizeof(hdr));
+    img.append((const char *)&p, sizeof(p));
+    MockFS::injectFile(CONFIG_SNAPSHOT_PATH_A, img);
+
+    TestPayload q = makePayload(2);
+    TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_save(1, &q, sizeof(q)));
+    TEST_ASSERT_EQUAL_UINT32(0, config_snapshot_get_stats().generation);
+
+    simulateReboot();
+    TestPayload out;
+    TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_load(1, &out, sizeof(out), nullptr));
+    TEST_ASSERT_EQUAL_INT32(2, out.timezone);   // Gen 0 is newer than 0xFFFFFFFF
+}
+
+void test_crc32_known_vector(void) {
+    const char *s = "123456789";
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926UL, config_snapshot_crc32(0, (const uint8_t *)s, 9));
+    // Running CRC equals one-shot CRC
+    uint32_t c = config_snapshot_crc32(0, (const uint8_t *)s, 4);
+    c = config_snapshot_crc32(c, (const uint8_t *)s + 4, 5);
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926UL, c);
+}
+
+// Boot/save latency on the LittleFS mock against reading and parsing the
+// equivalent /config.json. Without ArduinoJson only the file read is timed,
+// which isolates the snapshot's own overhead (header reads, payload, CRC).
+void test_benchmark_snapshot_vs_json_read(void) {
+    const int ITER = 2000;
+    TestPayload p = makePayload(3600);
+    config_snapshot_save(1, &p, sizeof(p));
+
+    std::string json = "{\"version\":1,\"autoUpdate\":false,\"timezone\":3600,\"dst\":0,"
+                       "\"darkMode\":true,\"certValidation\":true,\"hwStatsInterval\":2000,"
+                       "\"autoAP\":true,\"bootAnim\":true,\"bootAnimStyle\":0,"
+                       "\"screenTimeout\":60000,\"buzzer\":true,\"buzzerVol\":1,"
+                       "\"backlight\":255,\"dimTimeout\":10000,\"dimBright\":64,"
+                       "\"dimEnabled\":false,\"audioRate\":50,\"vuMeter\":true,"
+                       "\"waveform\":true,\"spectrum\":true,\"debugMode\":false,"
+                       "\"debugSerial\":2,\"debugHwStats\":false,\"debugI2s\":false,"
+                       "\"debugTasks\":false,\"fftWindow\":0,"
+                       "\"adcEnabled\":[true,true,true,true,true,true,true,true],"
+                       "\"usbAudio\":false,\"ethUseStaticIP\":false,\"ethStaticIP\":\"\","
+                       "\"ethSubnet\":\"255.255.255.0\",\"ethGateway\":\"\",\"ethDns1\":\"\","
+                       "\"ethDns2\":\"\",\"hostname\":\"alx-nova\"}";
+    MockFS::injectFile("/config.json", json);
+
+    using clk = std::chrono::steady_clock;
+    TestPayload out;
+
+    clk::time_point t0 = clk::now();
+    for (int i = 0; i < ITER; i++) {
+        simulateReboot();
+        config_snapshot_load(1, &out, sizeof(out), nullptr);
+    }
+    double loadUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / ITER;
+
+    t0 = clk::now();
+    for (int i = 0; i < ITER; i++) {
+        p.timezone = i;
+        config_snapshot_save(1, &p, sizeof(p));
+    }
+    double saveUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / ITER;
+
+    static char jsonBuf[2048];
+    t0 = clk::now();
+    for (int i = 0; i < ITER; i++) {
+        File f = LittleFS.open("/config.json", "r");
+        f.read((uint8_t *)jsonBuf, sizeof(jsonBuf));
+        f.close();
+    }
+    double jsonReadUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / ITER;
+
+    char msg[200];
+#ifdef TEST_HAVE_ARDUINOJSON
+    t0 = clk::now();
+    for (int i = 0; i < ITER; i++) {
+        File f = LittleFS.open("/config.json", "r");
+        size_t n = f.read((uint8_t *)jsonBuf, sizeof(jsonBuf) - 1);
+        f.close();
+        jsonBuf[n] = '\0';
+        JsonDocument doc;
+        deserializeJson(doc, (const char *)jsonBuf);
+        out.timezone = doc["timezone"] | 0;
+    }
+    double jsonParseUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / ITER;
+    snprintf(msg, sizeof(msg),
+             "snapshot load %.2f us, save %.2f us (%u B) | config.json read %.2f us, read+parse %.2f us (%u B)",
+             loadUs, saveUs, (unsigned)(sizeof(ConfigSnapshotHeader) + sizeof(TestPayload)),
+             jsonReadUs, jsonParseUs, (unsigned)json.size());
+#else
+    snprintf(msg, sizeof(msg),
+             "snapshot load %.2f us, save %.2f us (%u B) | config.json read-only %.2f us (%u B)",
+             loadUs, saveUs, (unsigned)(sizeof(ConfigSnapshotHeader) + sizeof(TestPayload)),
+             jsonReadUs, (unsigned)json.size());
+#endif
+    TEST_MESSAGE(msg);
+
+    simulateReboot();
+    TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_load(1, &out, sizeof(out), nullptr));
+    TEST_ASSERT_EQUAL_INT32(ITER - 1, out.timezone);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)ITER + 1, config_snapshot_get_stats().generation);
+    TEST_ASSERT_TRUE(loadUs < 1000.0);
+    TEST_ASSERT_TRUE(saveUs < 1000.0);
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_load_without_snapshot);
+    RUN_TEST(test_save_load_roundtrip);
+    RUN_TEST(test_slots_alternate_and_generation_increments);
+    RUN_TEST(test_save_never_touches_live_slot);
+    RUN_TEST(test_save_after_reboot_targets_inactive_slot);
+    RUN_TEST(test_corrupt_newest_falls_back_to_previous);
+    RUN_TEST(test_truncated_write_falls_back);
+    RUN_TEST(test_both_slots_corrupt);
+    RUN_TEST(test_schema_mismatch_reported);
+    RUN_TEST(test_append_only_prefix_decode);
+    RUN_TEST(test_oversized_payload_rejected);
+    RUN_TEST(test_generation_wraparound);
+    RUN_TEST(test_crc32_known_vector);
+    RUN_TEST(test_benchmark_snapshot_vs_json_read);
+
+    return UNITY_END();
+}
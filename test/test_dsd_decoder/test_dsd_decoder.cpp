@@ -0,0 +1,272 @@
+// test_dsd_decoder.cpp
+// DoP unpacking and DSD -> PCM decimation (dsd_decoder.h). Synthetic DSD64
+// streams come from a second-order sigma-delta modulator packed as DoP v1.1
+// at 176.4 kHz. Covers the byte-LUT stage against a direct bitwise FIR, DC
+// gain and idle-pattern silence, block-size independence, bit-exact DoP
+// handling for passthrough, sine level and THD of the decoded stream, and a
+// native CPU-per-lane benchmark.
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "../../src/audio_input_kernel.h"
+#include "../../src/dsd_decoder.h"
+
+#define DOP_RATE     176400.0
+#define BLOCK        256
+
+static DsdDecimTable g_table;
+static DsdLaneDecoder g_dec;
+
+// ===== Synthetic DSD64 source =====
+
+// Second-order sigma-delta modulator, one bit per call (1 = +1)
+struct Sdm {
+    double i1, i2;
+    int y;
+};
+
+static int sdm_step(Sdm &m, double x) {
+    double fb = m.y ? 1.0 : -1.0;
+    m.i1 += x - fb;
+    m.i2 += m.i1 - fb;
+    m.y = m.i2 >= 0.0 ? 1 : 0;
+    return m.y;
+}
+
+// Pack 16 modulator bits per channel into each DoP frame, oldest bit at the
+// MSB of bits 23..8, markers alternating per frame
+static void make_dop_sine(int32_t *raw, int frames, double freq, double amp, long startFrame,
+                          Sdm *mod) {
+    for (int f = 0; f < frames; f++) {
+        long frame = startFrame + f;
+        uint32_t marker = (frame & 1) ? DOP_MARKER_B : DOP_MARKER_A;
+        for (int c = 0; c < 2; c++) {
+            uint32_t bits = 0;
+            for (int b = 0; b < 16; b++) {
+                double t = (double)(frame * 16 + b) / (DOP_RATE * 16.0);
+                double x = amp * sin(2.0 * M_PI * freq * t);
+                bits = (bits << 1) | (uint32_t)sdm_step(mod[c], x);
+            }
+            raw[f * 2 + c] = (int32_t)((marker << 24) | (bits << 8));
+        }
+    }
+}
+
+// Decode `blocks` blocks of a fresh sine stream into out (one channel)
+static void decode_sine(float *outL, float *outR, int blocks, int blockFrames, double freq,
+                        double amp) {
+    static int32_t raw[BLOCK * 2];
+    Sdm mod[2] = {};
+    dsd_dec_reset(g_dec);
+    for (int k = 0; k < blocks; k++) {
+        make_dop_sine(raw, blockFrames, freq, amp, (long)k * blockFrames, mod);
+        dsd_decode_dop(g_dec, raw, outL + k * blockFrames, outR + k * blockFrames, blockFrames);
+    }
+}
+
+// Amplitude of bin k (coherent sampling, rectangular window)
+static double bin_amp(const float *x, int n, int k) {
+    double re = 0.0, im = 0.0;
+    for (int i = 0; i < n; i++) {
+        double ph = 2.0 * M_PI * (double)k * i / n;
+        re += x[i] * cos(ph);
+        im -= x[i] * sin(ph);
+    }
+    return 2.0 * sqrt(re * re + im * im) / n;
+}
+
+void setUp(void) {
+    dsd_dec_init(g_dec, &g_table);
+}
+
+void tearDown(void) {}
+
+// ===== Stage 1: byte LUT =====
+
+void test_lut_matches_bitwise_fir(void) {
+    float h[DSD_DEC_TAPS];
+    dsd_dec_design(h);
+    const int n = 200;
+    uint8_t bytes[DSD_DEC_HIST + n];
+    srand(7);
+    for (int i = 0; i < DSD_DEC_HIST + n; i++) bytes[i] = (uint8_t)(rand() & 0xFF);
+    float out[n];
+    dsd_dec_fir8(g_table, bytes + DSD_DEC_HIST, n, out);
+
+    for (int i = 0; i < n; i++) {
+        // Newest bit is the LSB of byte i; tap k looks k bits further back
+        long newest = (long)(DSD_DEC_HIST + i) * 8 + 7;
+        double ref = 0.0;
+        for (int k = 0; k < DSD_DEC_TAPS; k++) {
+            long t = newest - k;
+            int bit = (bytes[t / 8] >> (7 - (t % 8))) & 1;
+            ref += bit ? h[k] : -h[k];
+        }
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f, (float)ref, out[i]);
+    }
+}
+
+void test_design_unity_dc_and_symmetric(void) {
+    float h[DSD_DEC_TAPS];
+    dsd_dec_design(h);
+    double sum = 0.0;
+    for (int k = 0; k < DSD_DEC_TAPS; k++) {
+        sum += h[k];
+        TEST_ASSERT_FLOAT_WITHIN(1e-7f, h[k], h[DSD_DEC_TAPS - 1 - k]);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, (float)sum);
+}
+
+// ===== Full decoder =====
+
+void test_all_ones_decodes_to_full_scale(void) {
+    static int32_t raw[BLOCK * 2];
+    static float L[BLOCK], R[BLOCK];
+    for (int f = 0; f < BLOCK; f++) {
+        uint32_t marker = (f & 1) ? DOP_MARKER_B : DOP_MARKER_A;
+        raw[f * 2]     = (int32_t)((marker << 24) | 0xFFFF00u);   // All +1
+        raw[f * 2 + 1] = (int32_t)((marker << 24) | 0x000000u);   // All -1
+    }
+    dsd_decode_dop(g_dec, raw, L, R, BLOCK);
+    dsd_decode_dop(g_dec, raw, L, R, BLOCK);
+    for (int f = 0; f < BLOCK; f++) {
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, L[f]);
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, -1.0f, R[f]);
+    }
+}
+
+void test_idle_pattern_is_silent(void) {
+    static int32_t raw[BLOCK * 2];
+    static float L[BLOCK], R[BLOCK];
+    const uint32_t idle = ((uint32_t)DSD_SILENCE_BYTE << 16) | ((uint32_t)DSD_SILENCE_BYTE << 8);
+    for (int f = 0; f < BLOCK; f++) {
+        uint32_t marker = (f & 1) ? DOP_MARKER_B : DOP_MARKER_A;
+        raw[f * 2] = raw[f * 2 + 1] = (int32_t)((marker << 24) | idle);
+    }
+    // From reset the history already holds the idle pattern: no start-up thump
+    for (int k = 0; k < 3; k++) {
+        dsd_decode_dop(g_dec, raw, L, R, BLOCK);
+        for (int f = 0; f < BLOCK; f++) {
+            TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, L[f]);
+            TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, R[f]);
+        }
+    }
+}
+
+void test_block_size_independent(void) {
+    const int blocks = 4;
+    static float refL[BLOCK * 4], refR[BLOCK * 4], L[BLOCK * 4], R[BLOCK * 4];
+    decode_sine(refL, refR, blocks, BLOCK, 3000.0, 0.4);
+    decode_sine(L, R, blocks * 8, BLOCK / 8, 3000.0, 0.4);
+    for (int i = 0; i < BLOCK * blocks; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(refL[i], L[i]);
+        TEST_ASSERT_EQUAL_FLOAT(refR[i], R[i]);
+    }
+}
+
+void test_dop_words_bit_exact_for_passthrough(void) {
+    static int32_t raw[BLOCK * 2], before[BLOCK * 2];
+    static float L[BLOCK], R[BLOCK];
+    Sdm mod[2] = {};
+    make_dop_sine(raw, BLOCK, 1000.0, 0.5, 0, mod);
+    memcpy(before, raw, sizeof(raw));
+    dsd_decode_dop(g_dec, raw, L, R, BLOCK);
+    TEST_ASSERT_EQUAL_MEMORY(before, raw, sizeof(raw));   // Decoding leaves the words alone
+
+    // Unpacked bytes reassemble into the original DSD payload of every word
+    uint8_t l[BLOCK * 2], r[BLOCK * 2];
+    dsd_dop_unpack(raw, BLOCK, 0, l);
+    dsd_dop_unpack(raw, BLOCK, 1, r);
+    for (int f = 0; f < BLOCK; f++) {
+        uint32_t wl = ((uint32_t)l[f * 2] << 16) | ((uint32_t)l[f * 2 + 1] << 8);
+        uint32_t wr = ((uint32_t)r[f * 2] << 16) | ((uint32_t)r[f * 2 + 1] << 8);
+        TEST_ASSERT_EQUAL_HEX32((uint32_t)raw[f * 2] & 0xFFFF00u, wl);
+        TEST_ASSERT_EQUAL_HEX32((uint32_t)raw[f * 2 + 1] & 0xFFFF00u, wr);
+    }
+
+    // The marker scan still sees DoP, so the lane stays in DSD mode
+    AudioInputStats st;
+    static float kL[BLOCK], kR[BLOCK];
+    audio_input_condition(raw, kL, kR, BLOCK, 1.0f, true, st);
+    TEST_ASSERT_TRUE(st.dop);
+}
+
+// 0 dB SACD (50 % modulation) 1 kHz sine: level -6 dBFS, harmonics < -60 dB
+void test_sine_thd(void) {
+    const int blocks = 36;
+    const int settle = 4 * BLOCK;
+    const int n = 8192;
+    const int k0 = 47;                                   // Coherent: 47 cycles in n
+    const double f0 = k0 * DOP_RATE / n;                 // ~1012 Hz
+    static float L[BLOCK * 36], R[BLOCK * 36];
+    decode_sine(L, R, blocks, BLOCK, f0, 0.5);
+
+    double fund = bin_amp(L + settle, n, k0);
+    double harm = 0.0;
+    for (int h = 2; h <= 5; h++) {
+        double a = bin_amp(L + settle, n, k0 * h);
+        harm += a * a;
+    }
+    double thdDb = 10.0 * log10(harm / (fund * fund));
+    printf("[dsd] 1 kHz: level %.3f dBFS, THD %.1f dB\n", 20.0 * log10(fund), thdDb);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.5f, (float)fund);
+    TEST_ASSERT_TRUE(thdDb < -60.0);
+
+    // Right channel carries the same stream
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, (float)fund, (float)bin_amp(R + settle, n, k0));
+}
+
+// Passband: a 10 kHz tone keeps its level within 0.1 dB
+void test_passband_flat_at_10k(void) {
+    const int blocks = 36;
+    const int settle = 4 * BLOCK;
+    const int n = 8192;
+    const int k0 = 464;                                  // ~9991 Hz
+    static float L[BLOCK * 36], R[BLOCK * 36];
+    decode_sine(L, R, blocks, BLOCK, k0 * DOP_RATE / n, 0.5);
+    double fund = bin_amp(L + settle, n, k0);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 0.0f, (float)(20.0 * log10(fund / 0.5)));
+}
+
+// ===== CPU per lane =====
+
+void test_benchmark_cpu_per_lane(void) {
+    static int32_t raw[BLOCK * 2];
+    static float L[BLOCK], R[BLOCK];
+    Sdm mod[2] = {};
+    make_dop_sine(raw, BLOCK, 1000.0, 0.5, 0, mod);
+    const int iters = 2000;
+    double best = 1e30;
+    for (int rep = 0; rep < 3; rep++) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iters; i++) dsd_decode_dop(g_dec, raw, L, R, BLOCK);
+        auto t1 = std::chrono::steady_clock::now();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / iters;
+        if (ns < best) best = ns;
+    }
+    const double budgetNs = BLOCK / DOP_RATE * 1e9;      // One block of DSD64 in real time
+    printf("[bench] DSD64 stereo lane, %d frames: %.0f ns (%.2f%% of %.0f us real time)\n",
+           BLOCK, best, 100.0 * best / budgetNs, budgetNs / 1000.0);
+    TEST_ASSERT_TRUE(best < budgetNs * 0.1);
+}
+
+int main(int argc, char **argv) {
+    dsd_dec_table_init(g_table);
+    UNITY_BEGIN();
+    RUN_TEST(test_lut_matches_bitwise_fir);
+    RUN_TEST(test_design_unity_dc_and_symmetric);
+    RUN_TEST(test_all_ones_decodes_to_full_scale);
+    RUN_TEST(test_idle_pattern_is_silent);
+    RUN_TEST(test_block_size_independent);
+    RUN_TEST(test_dop_words_bit_exact_for_passthrough);
+    RUN_TEST(test_sine_thd);
+    RUN_TEST(test_passband_flat_at_10k);
+    RUN_TEST(test_benchmark_cpu_per_lane);
+    return UNITY_END();
+}
@@ -951,7 +951,7 @@ void test_stereo_link_mirror_resets_envelope(void) {
 
 // ===== Decimation FIR Tests =====
 
-void test_decimator_halves_output_length(void) {
+void test_decimator_section_restores_length(void) {
     dsp_init();
     dsp_copy_active_to_inactive();
     int pos = dsp_add_stage(0, DSP_DECIMATOR);
@@ -959,9 +959,9 @@ void test_decimator_halves_output_length(void) {
 
     DspState *cfg = dsp_get_inactive_config();
     TEST_ASSERT_EQUAL_UINT8(2, cfg->channels[0].stages[pos].decimator.factor);
-    TEST_ASSERT_TRUE(cfg->channels[0].stages[pos].decimator.firSlot >= 0);
-    TEST_ASSERT_TRUE(cfg->channels[0].stages[pos].decimator.numTaps > 0);
+    TEST_ASSERT_TRUE(cfg->channels[0].stages[pos].decimator.mrSlot >= 0);
     dsp_swap_config();
+    TEST_ASSERT_EQUAL_INT(dsp_mr_latency_samples(2), dsp_get_channel_latency_samples(0));
 
     // Create stereo buffer with 128 frames (256 stereo samples)
     int32_t buf[128 * 2];
@@ -971,14 +971,11 @@ void test_decimator_halves_output_length(void) {
     }
 
     dsp_process_buffer(buf, 128, 0);
-    // After decimation, output should have data in first 64 positions
-    // The decimator reduces the effective buffer length
-    // Verify the output is non-zero in first half
-    bool hasData = false;
-    for (int i = 0; i < 64; i++) {
-        if (buf[i * 2] != 0) { hasData = true; break; }
+    // The section interpolates back: the full block carries the (delayed) DC level
+    int lat = dsp_mr_latency_samples(2);
+    for (int i = lat + 24; i < 128; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.5f, (float)buf[i * 2] / 8388607.0f);
     }
-    TEST_ASSERT_TRUE(hasData);
 }
 
 void test_decimation_filter_design(void) {
@@ -1025,17 +1022,17 @@ void test_decimator_slot_freed_on_remove(void) {
     TEST_ASSERT_TRUE(pos >= 0);
 
     DspState *cfg = dsp_get_inactive_config();
-    int8_t slot = cfg->channels[0].stages[pos].decimator.firSlot;
+    int8_t slot = cfg->channels[0].stages[pos].decimator.mrSlot;
     TEST_ASSERT_TRUE(slot >= 0);
 
     // Remove the stage — slot should be freed
     bool ok = dsp_remove_stage(0, pos);
     TEST_ASSERT_TRUE(ok);
 
-    // Should be able to alloc another slot (proves the old one was freed)
-    int newSlot = dsp_fir_alloc_slot();
-    TEST_ASSERT_TRUE(newSlot >= 0);
-    dsp_fir_free_slot(newSlot);
+    // Next allocation reuses the freed slot
+    int newSlot = dsp_mr_alloc_slot();
+    TEST_ASSERT_EQUAL_INT(slot, newSlot);
+    dsp_mr_free_slot(newSlot);
 }
 
 // ===== Cross-Correlation / Delay Alignment Tests =====
@@ -2932,6 +2929,7 @@ void test_fir_auto_bypass_on_cpu_critical(void) {
     s.fir.delayPos = 0;
     float *taps = dsp_fir_get_taps(0, s.fir.firSlot);
     if (taps) taps[0] = 1.0f;  // Identity impulse
+    s.priority = DSP_PRIORITY_NORMAL;  // FIR defaults to protected; opt in to shedding
     dsp_swap_config();
 
     // Set critical load — FIR stage should be skipped
@@ -2978,6 +2976,7 @@ void test_fir_bypass_skips_convolution_too(void) {
     // Add a convolution stage to channel 0 (slot -1 means no IR loaded — still should be counted)
     int idx = dsp_add_chain_stage(0, DSP_CONVOLUTION);
     TEST_ASSERT_TRUE(idx >= 0);
+    dsp_get_inactive_config()->channels[0].stages[idx].priority = DSP_PRIORITY_NORMAL;  // Opt in to shedding
     dsp_swap_config();
 
     // Drive into critical load
@@ -3092,7 +3091,7 @@ int main(int argc, char **argv) {
     RUN_TEST(test_stereo_link_mirror_resets_envelope);
 
     // Decimation FIR
-    RUN_TEST(test_decimator_halves_output_length);
+    RUN_TEST(test_decimator_section_restores_length);
     RUN_TEST(test_decimation_filter_design);
     RUN_TEST(test_decimator_fird_basic);
     RUN_TEST(test_decimator_slot_freed_on_remove);
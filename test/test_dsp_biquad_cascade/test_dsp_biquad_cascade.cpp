@@ -0,0 +1,324 @@
+// test_dsp_biquad_cascade.cpp
+// Fused biquad-cascade kernels: equivalence with the per-section
+// dsps_biquad_f32() path (mono and stereo, every group-size remainder, split
+// blocks), pipeline integration (runs across disabled stages, lockstep pair
+// processing, coefficient morphing inside a fused run) and a native benchmark
+// of ns per section-sample against the per-stage path.
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "../../lib/esp_dsp_lite/src/dsps_biquad_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_init_f32.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fird_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_corr_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_conv_f32_ansi.c"
+#include "../../src/dsp_biquad_gen.c"
+
+#include "../../src/dsp_pipeline.h"
+#include "../../src/dsp_coefficients.h"
+#include "../../src/dsp_biquad_cascade.h"
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/dsp_coefficients.cpp"
+#include "../../src/dsp_pipeline.cpp"
+#include "../../src/dsp_crossover.cpp"
+#include "../../src/dsp_convolution.cpp"
+#include "../../src/thd_measurement.cpp"
+
+#define MAXN 12
+#define TOL 1e-5f
+
+static float _coeffs[MAXN][5];
+static float _coeffsR[MAXN][5];
+
+// Stable PEQ sections spread across the band with alternating boost/cut
+static void make_sections(float (*c)[5], int n, float gainSign) {
+    for (int k = 0; k < n; k++) {
+        float f = (40.0f * powf(1.6f, (float)k)) / 48000.0f;
+        float g = gainSign * ((k & 1) ? -4.0f : 6.0f);
+        dsp_gen_peaking_eq_f32(c[k], f, g, 1.2f);
+    }
+}
+
+static void make_signal(float *x, int len, int seed) {
+    uint32_t s = 12345u + (uint32_t)seed;
+    for (int i = 0; i < len; i++) {
+        s = s * 1664525u + 1013904223u;
+        x[i] = ((float)(s >> 8) / 16777216.0f - 0.5f) * 0.5f;
+    }
+}
+
+static void reference(float *buf, int len, float (*c)[5], float (*d)[2], int n) {
+    for (int k = 0; k < n; k++) dsps_biquad_f32(buf, buf, len, c[k], d[k]);
+}
+
+static float max_diff(const float *a, const float *b, int len) {
+    float m = 0.0f;
+    for (int i = 0; i < len; i++) {
+        float e = fabsf(a[i] - b[i]);
+        if (e > m) m = e;
+    }
+    return m;
+}
+
+void setUp(void) {
+    dsp_init();
+    make_sections(_coeffs, MAXN, 1.0f);
+    make_sections(_coeffsR, MAXN, -1.0f);
+}
+
+void tearDown(void) {}
+
+// ===== Kernel equivalence =====
+
+void test_mono_matches_per_section_all_group_sizes(void) {
+    for (int n = 1; n <= 9; n++) {
+        float x[256], y[256];
+        float d1[MAXN][2] = {}, d2[MAXN][2] = {};
+        make_signal(x, 256, n);
+        memcpy(y, x, sizeof(x));
+        reference(x, 256, _coeffs, d1, n);
+        dsp_biquad_cascade_f32(y, 256, _coeffs, d2, n);
+        TEST_ASSERT_TRUE(max_diff(x, y, 256) < TOL);
+        for (int k = 0; k < n; k++) {
+            TEST_ASSERT_FLOAT_WITHIN(TOL, d1[k][0], d2[k][0]);
+            TEST_ASSERT_FLOAT_WITHIN(TOL, d1[k][1], d2[k][1]);
+        }
+    }
+}
+
+void test_mono_state_carries_across_blocks(void) {
+    float x[256], y[256];
+    float d1[MAXN][2] = {}, d2[MAXN][2] = {};
+    make_signal(x, 256, 7);
+    memcpy(y, x, sizeof(x));
+    reference(x, 256, _coeffs, d1, 7);
+    dsp_biquad_cascade_f32(y, 37, _coeffs, d2, 7);
+    dsp_biquad_cascade_f32(y + 37, 219, _coeffs, d2, 7);
+    TEST_ASSERT_TRUE(max_diff(x, y, 256) < TOL);
+}
+
+void test_stereo_matches_two_mono_chains(void) {
+    for (int n = 1; n <= 5; n++) {
+        float l[128], r[128], l2[128], r2[128];
+        float dl[MAXN][2] = {}, dr[MAXN][2] = {}, dl2[MAXN][2] = {}, dr2[MAXN][2] = {};
+        make_signal(l, 128, 100 + n);
+        make_signal(r, 128, 200 + n);
+        memcpy(l2, l, sizeof(l));
+        memcpy(r2, r, sizeof(r));
+        reference(l, 128, _coeffs, dl, n);
+        reference(r, 128, _coeffsR, dr, n);
+        dsp_biquad_cascade_stereo_f32(l2, r2, 128, _coeffs, _coeffsR, dl2, dr2, n);
+        TEST_ASSERT_TRUE(max_diff(l, l2, 128) < TOL);
+        TEST_ASSERT_TRUE(max_diff(r, r2, 128) < TOL);
+    }
+}
+
+void test_zero_sections_is_passthrough(void) {
+    float x[16], y[16];
+    make_signal(x, 16, 3);
+    memcpy(y, x, sizeof(x));
+    float d[1][2] = {};
+    dsp_biquad_cascade_f32(y, 16, _coeffs, d, 0);
+    TEST_ASSERT_EQUAL_MEMORY(x, y, sizeof(x));
+}
+
+// ===== Pipeline integration =====
+
+// Enable `n` PEQ bands with gain on a channel of the active config
+static void enable_peq(int ch, int n, float gainSign) {
+    DspState *cfg = dsp_get_active_config();
+    for (int b = 0; b < n; b++) {
+        DspStage &s = cfg->channels[ch].stages[b];
+        s.enabled = true;
+        s.biquad.gain = gainSign * ((b & 1) ? -3.0f : 5.0f);
+        dsp_compute_biquad_coeffs(s.biquad, s.type, cfg->sampleRate);
+    }
+}
+
+// Republish the active config after editing it in place (programs are
+// compiled at swap time). Copying first keeps the coefficients equal, so
+// the swap does not start a morph.
+static void publish_active() {
+    dsp_copy_active_to_inactive();
+    dsp_swap_config();
+}
+
+// Per-stage reference over the enabled biquad stages of a channel copy
+static void channel_reference(DspChannelConfig &ch, float *buf, int len) {
+    for (int i = 0; i < ch.stageCount; i++) {
+        DspStage &s = ch.stages[i];
+        if (s.enabled && dsp_is_biquad_type(s.type))
+            dsps_biquad_f32(buf, buf, len, s.biquad.coeffs, s.biquad.delay);
+    }
+}
+
+void test_pipeline_pair_matches_reference(void) {
+    enable_peq(0, DSP_PEQ_BANDS, 1.0f);
+    enable_peq(1, DSP_PEQ_BANDS, -1.0f);
+    publish_active();
+    DspState *cfg = dsp_get_active_config();
+    DspChannelConfig refL = cfg->channels[0], refR = cfg->channels[1];
+
+    float l[256], r[256], el[256], er[256];
+    make_signal(l, 256, 1);
+    make_signal(r, 256, 2);
+    for (int i = 0; i < 256; i++) { l[i] *= 0.2f; r[i] *= 0.2f; }
+    memcpy(el, l, sizeof(l));
+    memcpy(er, r, sizeof(r));
+    channel_reference(refL, el, 256);
+    channel_reference(refR, er, 256);
+
+    dsp_process_buffer_float(l, r, 256, 0);
+    TEST_ASSERT_TRUE(max_diff(el, l, 256) < TOL);
+    TEST_ASSERT_TRUE(max_diff(er, r, 256) < TOL);
+    // State is written back to the stage structs
+    TEST_ASSERT_FLOAT_WITHIN(TOL, refL.stages[9].biquad.delay[0], cfg->channels[0].stages[9].biquad.delay[0]);
+    TEST_ASSERT_FLOAT_WITHIN(TOL, refR.stages[9].biquad.delay[1], cfg->channels[1].stages[9].biquad.delay[1]);
+}
+
+void test_disabled_stage_inside_run_is_transparent(void) {
+    enable_peq(0, DSP_PEQ_BANDS, 1.0f);
+    DspState *cfg = dsp_get_active_config();
+    cfg->channels[0].stages[4].enabled = false;
+    publish_active();
+    cfg = dsp_get_active_config();
+    DspChannelConfig ref = cfg->channels[0];
+
+    float x[128], e[128];
+    make_signal(x, 128, 5);
+    for (int i = 0; i < 128; i++) x[i] *= 0.2f;
+    memcpy(e, x, sizeof(x));
+    channel_reference(ref, e, 128);
+
+    float r[128] = {};
+    dsp_process_buffer_float(x, r, 128, 0);   // Shapes differ -> per-channel path
+    TEST_ASSERT_TRUE(max_diff(e, x, 128) < TOL);
+}
+
+void test_non_biquad_stage_splits_runs(void) {
+    enable_peq(0, DSP_PEQ_BANDS, 1.0f);
+    enable_peq(1, DSP_PEQ_BANDS, 1.0f);
+    // Same layout on both sides: PEQ x10, polarity, then lockstep continues
+    int pl = dsp_add_stage(0, DSP_POLARITY);
+    int pr = dsp_add_stage(1, DSP_POLARITY);
+    TEST_ASSERT_TRUE(pl >= 0 && pr >= 0);
+    DspState *in = dsp_get_inactive_config();
+    in->channels[0].stages[pl].polarity.inverted = true;
+    in->channels[1].stages[pr].polarity.inverted = true;
+    for (int b = 0; b < DSP_PEQ_BANDS; b++) {
+        in->channels[0].stages[b] = dsp_get_active_config()->channels[0].stages[b];
+        in->channels[1].stages[b] = dsp_get_active_config()->channels[1].stages[b];
+    }
+    dsp_swap_config();
+    DspState *cfg = dsp_get_active_config();
+    DspChannelConfig ref = cfg->channels[0];
+
+    float l[64], r[64], e[64];
+    make_signal(l, 64, 9);
+    for (int i = 0; i < 64; i++) l[i] *= 0.2f;
+    memcpy(r, l, sizeof(l));
+    memcpy(e, l, sizeof(l));
+    channel_reference(ref, e, 64);
+    for (int i = 0; i < 64; i++) e[i] = -e[i];
+
+    dsp_process_buffer_float(l, r, 64, 0);
+    TEST_ASSERT_TRUE(max_diff(e, l, 64) < TOL);
+    TEST_ASSERT_TRUE(max_diff(e, r, 64) < TOL);
+}
+
+void test_morph_inside_fused_run(void) {
+    enable_peq(0, DSP_PEQ_BANDS, 1.0f);
+    enable_peq(1, DSP_PEQ_BANDS, 1.0f);
+    float l[256], r[256];
+    for (int i = 0; i < 256; i++) { l[i] = 0.1f; r[i] = 0.1f; }
+    dsp_process_buffer_float(l, r, 256, 0);
+
+    // Change one band on both channels; the swap starts a 64-sample morph
+    dsp_copy_active_to_inactive();
+    DspState *in = dsp_get_inactive_config();
+    for (int c = 0; c < 2; c++) {
+        DspStage &s = in->channels[c].stages[3];
+        s.biquad.gain = -9.0f;
+        dsp_compute_biquad_coeffs(s.biquad, s.type, in->sampleRate);
+    }
+    float target[5];
+    memcpy(target, in->channels[0].stages[3].biquad.coeffs, sizeof(target));
+    dsp_swap_config();
+    DspState *cfg = dsp_get_active_config();
+    TEST_ASSERT_EQUAL_UINT16(64, cfg->channels[0].stages[3].biquad.morphRemaining);
+
+    for (int i = 0; i < 40; i++) { l[i] = 0.1f; r[i] = 0.1f; }
+    dsp_process_buffer_float(l, r, 40, 0);
+    TEST_ASSERT_EQUAL_UINT16(24, cfg->channels[0].stages[3].biquad.morphRemaining);
+    TEST_ASSERT_EQUAL_UINT16(24, cfg->channels[1].stages[3].biquad.morphRemaining);
+
+    for (int i = 0; i < 40; i++) { l[i] = 0.1f; r[i] = 0.1f; }
+    dsp_process_buffer_float(l, r, 40, 0);
+    TEST_ASSERT_EQUAL_UINT16(0, cfg->channels[0].stages[3].biquad.morphRemaining);
+    for (int c = 0; c < 5; c++)
+        TEST_ASSERT_EQUAL_FLOAT(target[c], cfg->channels[0].stages[3].biquad.coeffs[c]);
+    // DC in, DC out: no blow-up through the morph
+    for (int i = 0; i < 40; i++) TEST_ASSERT_TRUE(fabsf(l[i]) < 1.0f);
+}
+
+// ===== Benchmark =====
+
+static volatile float _sink;
+
+template <typename F>
+static double bench_ns(F fn, int sections, int channels) {
+    const int block = 256, iters = 3000;
+    for (int k = 0; k < 20; k++) fn();   // Warm-up
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < iters; k++) fn();
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    return ns / ((double)block * iters * sections * channels);
+}
+
+void test_benchmark_section_sample_cost(void) {
+    const int n = DSP_PEQ_BANDS;
+    static float l[256], r[256];
+    static float dl[MAXN][2], dr[MAXN][2];
+    make_signal(l, 256, 11);
+    make_signal(r, 256, 12);
+
+    double perStage = bench_ns([&]() {
+        for (int k = 0; k < n; k++) dsps_biquad_f32(l, l, 256, _coeffs[k], dl[k]);
+        for (int k = 0; k < n; k++) dsps_biquad_f32(r, r, 256, _coeffsR[k], dr[k]);
+    }, n, 2);
+    double mono = bench_ns([&]() {
+        dsp_biquad_cascade_f32(l, 256, _coeffs, dl, n);
+        dsp_biquad_cascade_f32(r, 256, _coeffsR, dr, n);
+    }, n, 2);
+    double stereo = bench_ns([&]() {
+        dsp_biquad_cascade_stereo_f32(l, r, 256, _coeffs, _coeffsR, dl, dr, n);
+    }, n, 2);
+    _sink = l[3] + r[3];
+
+    printf("[bench] biquad ns/section-sample (%d sections, 256 frames): per-stage=%.3f fused=%.3f fused-stereo=%.3f\n",
+           n, perStage, mono, stereo);
+    TEST_ASSERT_TRUE(mono <= perStage * 1.25 + 0.05);
+    TEST_ASSERT_TRUE(stereo <= perStage * 1.25 + 0.05);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_mono_matches_per_section_all_group_sizes);
+    RUN_TEST(test_mono_state_carries_across_blocks);
+    RUN_TEST(test_stereo_matches_two_mono_chains);
+    RUN_TEST(test_zero_sections_is_passthrough);
+    RUN_TEST(test_pipeline_pair_matches_reference);
+    RUN_TEST(test_disabled_stage_inside_run_is_transparent);
+    RUN_TEST(test_non_biquad_stage_splits_runs);
+    RUN_TEST(test_morph_inside_fused_run);
+    RUN_TEST(test_benchmark_section_sample_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,273 @@
+// test_dsp_delay.cpp
+// Power-of-two ring delay lines: integer delay across chunk and ring wraps,
+// Lagrange / Thiran fractional delay, pool budget and swap continuity, plus a
+// native benchmark of per-stage cost (ns/sample) against the legacy
+// per-sample modulo loop.
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "../../lib/esp_dsp_lite/src/dsps_biquad_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_init_f32.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fird_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_corr_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_conv_f32_ansi.c"
+#include "../../src/dsp_biquad_gen.c"
+
+#include "../../src/dsp_pipeline.h"
+#include "../../src/dsp_coefficients.h"
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/dsp_coefficients.cpp"
+#include "../../src/dsp_pipeline.cpp"
+#include "../../src/dsp_crossover.cpp"
+#include "../../src/dsp_convolution.cpp"
+#include "../../src/thd_measurement.cpp"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static DspDelayParams _dly;
+static int _slot = -1;
+
+void setUp(void) {
+    dsp_init();
+    _slot = dsp_delay_alloc_slot();
+    dsp_init_delay_params(_dly);
+    _dly.delaySlot = (int8_t)_slot;
+}
+
+void tearDown(void) {
+    if (_slot >= 0) dsp_delay_free_slot(_slot);
+}
+
+// Run `total` samples of a ramp through the stage in blocks of `block`
+static void run_ramp(int total, int block, float *out) {
+    float buf[512];
+    for (int done = 0; done < total; done += block) {
+        int n = (total - done < block) ? total - done : block;
+        for (int i = 0; i < n; i++) buf[i] = (float)(done + i + 1);
+        dsp_delay_process(_dly, buf, n);
+        memcpy(out + done, buf, n * sizeof(float));
+    }
+}
+
+// ===== Ring geometry =====
+
+void test_ring_is_power_of_two_with_headroom(void) {
+    TEST_ASSERT_EQUAL_UINT32(0u, DSP_DELAY_RING_SIZE & DSP_DELAY_RING_MASK);
+    TEST_ASSERT_TRUE(DSP_DELAY_RING_SIZE >= DSP_MAX_DELAY_SAMPLES + DSP_DELAY_CHUNK + DSP_DELAY_INTERP_TAPS);
+}
+
+// ===== Integer delay =====
+
+void test_integer_delay_across_ring_wrap(void) {
+    static float out[3 * DSP_DELAY_RING_SIZE];
+    const int total = 3 * DSP_DELAY_RING_SIZE;
+    _dly.delaySamples = 1000;
+    run_ramp(total, 480, out);   // 480 > DSP_DELAY_CHUNK — exercises chunking
+    for (int i = 0; i < total; i++) {
+        float expect = (i < 1000) ? 0.0f : (float)(i - 1000 + 1);
+        if (out[i] != expect) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "mismatch at %d", i);
+            TEST_FAIL_MESSAGE(msg);
+        }
+    }
+}
+
+void test_integer_delay_shorter_than_block(void) {
+    float out[256];
+    _dly.delaySamples = 3;
+    run_ramp(256, 64, out);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, out[2]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, out[3]);
+    TEST_ASSERT_EQUAL_FLOAT(253.0f, out[255]);
+}
+
+void test_max_delay_is_not_zero_delay(void) {
+    // The legacy ring read the current sample at the maximum delay
+    static float out[DSP_MAX_DELAY_SAMPLES + 64];
+    _dly.delaySamples = DSP_MAX_DELAY_SAMPLES;
+    run_ramp(DSP_MAX_DELAY_SAMPLES + 64, 64, out);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, out[DSP_MAX_DELAY_SAMPLES - 1]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, out[DSP_MAX_DELAY_SAMPLES]);
+}
+
+// ===== Fractional delay =====
+
+// Delay a low-frequency sine by d+f and compare with the analytic result
+static float frac_error(uint8_t interp, uint16_t d, float f) {
+    const int n = 2048;
+    static float x[n];
+    const double w = 2.0 * M_PI * 500.0 / 48000.0;
+    for (int i = 0; i < n; i++) x[i] = (float)sin(w * i);
+    _dly.delaySamples = d;
+    dsp_delay_set_fraction(_dly, f, interp);
+    for (int i = 0; i < n; i += 128) dsp_delay_process(_dly, x + i, 128);
+    float maxErr = 0.0f;
+    for (int i = 512; i < n; i++) {
+        float ref = (float)sin(w * (i - d - f));
+        float e = fabsf(x[i] - ref);
+        if (e > maxErr) maxErr = e;
+    }
+    return maxErr;
+}
+
+void test_lagrange_half_sample(void) {
+    TEST_ASSERT_TRUE(frac_error(DSP_DELAY_INTERP_LAGRANGE, 10, 0.5f) < 1e-3f);
+}
+
+void test_lagrange_zero_integer_part(void) {
+    TEST_ASSERT_TRUE(frac_error(DSP_DELAY_INTERP_LAGRANGE, 0, 0.25f) < 1e-3f);
+}
+
+void test_thiran_quarter_sample(void) {
+    TEST_ASSERT_TRUE(frac_error(DSP_DELAY_INTERP_THIRAN, 7, 0.25f) < 2e-3f);
+}
+
+void test_thiran_three_quarter_sample(void) {
+    TEST_ASSERT_TRUE(frac_error(DSP_DELAY_INTERP_THIRAN, 7, 0.75f) < 2e-3f);
+}
+
+void test_fraction_without_interp_is_integer(void) {
+    float out[64];
+    _dly.delaySamples = 2;
+    dsp_delay_set_fraction(_dly, 0.5f, DSP_DELAY_INTERP_NONE);
+    run_ramp(64, 64, out);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, out[2]);
+}
+
+void test_set_fraction_clamps(void) {
+    dsp_delay_set_fraction(_dly, 1.7f, 9);
+    TEST_ASSERT_TRUE(_dly.fraction < 1.0f);
+    TEST_ASSERT_EQUAL_UINT8(DSP_DELAY_INTERP_NONE, _dly.interp);
+    dsp_delay_set_fraction(_dly, NAN, DSP_DELAY_INTERP_THIRAN);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, _dly.fraction);
+}
+
+// ===== Pool =====
+
+void test_slot_capacity_respects_budget(void) {
+    int cap = dsp_delay_slot_capacity();
+    TEST_ASSERT_TRUE(cap >= 1 && cap <= DSP_MAX_DELAY_SLOTS);
+    TEST_ASSERT_TRUE((uint32_t)cap * DSP_DELAY_RING_SIZE * sizeof(float) <= DSP_DELAY_PSRAM_BUDGET);
+}
+
+void test_swap_keeps_delay_history(void) {
+    dsp_delay_free_slot(_slot);
+    _slot = -1;
+    int idx = dsp_add_stage(0, DSP_DELAY);
+    TEST_ASSERT_TRUE(idx >= 0);
+    DspState *cfg = dsp_get_inactive_config();
+    cfg->channels[0].stages[idx].delay.delaySamples = 300;
+    dsp_swap_config();
+
+    float l[256], r[256];
+    for (int i = 0; i < 256; i++) { l[i] = 1.0f; r[i] = 0.0f; }
+    dsp_process_buffer_float(l, r, 256, 0);
+
+    // Edit something unrelated and swap — the pending 300-sample tail survives
+    dsp_copy_active_to_inactive();
+    dsp_swap_config();
+    for (int i = 0; i < 256; i++) { l[i] = 0.0f; r[i] = 0.0f; }
+    dsp_process_buffer_float(l, r, 256, 0);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 1.0f, l[100]);
+}
+
+void test_stage_moved_to_another_slot_keeps_history(void) {
+    dsp_delay_free_slot(_slot);
+    _slot = -1;
+    int idx = dsp_add_stage(0, DSP_DELAY);
+    TEST_ASSERT_TRUE(idx >= 0);
+    dsp_get_inactive_config()->channels[0].stages[idx].delay.delaySamples = 300;
+    dsp_swap_config();
+
+    float l[256], r[256];
+    for (int i = 0; i < 256; i++) { l[i] = 1.0f; r[i] = 0.0f; }
+    dsp_process_buffer_float(l, r, 256, 0);
+
+    // Rings are shared by both configs; a stage given another slot gets the
+    // history it can still read copied across at the swap
+    TEST_ASSERT_TRUE(dsp_copy_active_to_inactive());
+    DspDelayParams &d = dsp_get_inactive_config()->channels[0].stages[idx].delay;
+    int moved = dsp_delay_alloc_slot();
+    TEST_ASSERT_TRUE(moved >= 0 && moved != d.delaySlot);
+    TEST_ASSERT_TRUE(dsp_delay_get_line(moved) != dsp_delay_get_line(d.delaySlot));
+    d.delaySlot = (int8_t)moved;
+    dsp_swap_config();
+    for (int i = 0; i < 256; i++) { l[i] = 0.0f; r[i] = 0.0f; }
+    dsp_process_buffer_float(l, r, 256, 0);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 1.0f, l[100]);
+}
+
+// ===== Benchmark =====
+
+// Legacy per-sample loop (two modulo operations per sample) for comparison
+static void legacy_delay(float *line, uint16_t &wp, uint16_t d, float *buf, int len) {
+    for (int i = 0; i < len; i++) {
+        line[wp] = buf[i];
+        uint16_t rp = (wp + DSP_MAX_DELAY_SAMPLES - d) % DSP_MAX_DELAY_SAMPLES;
+        buf[i] = line[rp];
+        wp = (wp + 1) % DSP_MAX_DELAY_SAMPLES;
+    }
+}
+
+static volatile float _sink;
+
+template <typename F>
+static double bench_ns_per_sample(F fn) {
+    const int block = 256, iters = 4000;
+    static float buf[block];
+    for (int i = 0; i < block; i++) buf[i] = (float)(i & 15) * 0.01f;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < iters; k++) fn(buf, block);
+    auto t1 = std::chrono::steady_clock::now();
+    _sink = buf[7];
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    return ns / ((double)block * iters);
+}
+
+void test_benchmark_delay_stage_cost(void) {
+    static float legacyLine[DSP_MAX_DELAY_SAMPLES];
+    uint16_t legacyWp = 0;
+    double legacy = bench_ns_per_sample([&](float *b, int n) { legacy_delay(legacyLine, legacyWp, 1234, b, n); });
+
+    _dly.delaySamples = 1234;
+    dsp_delay_set_fraction(_dly, 0.0f, DSP_DELAY_INTERP_NONE);
+    double ring = bench_ns_per_sample([&](float *b, int n) { dsp_delay_process(_dly, b, n); });
+    dsp_delay_set_fraction(_dly, 0.37f, DSP_DELAY_INTERP_LAGRANGE);
+    double lagr = bench_ns_per_sample([&](float *b, int n) { dsp_delay_process(_dly, b, n); });
+    dsp_delay_set_fraction(_dly, 0.37f, DSP_DELAY_INTERP_THIRAN);
+    double thir = bench_ns_per_sample([&](float *b, int n) { dsp_delay_process(_dly, b, n); });
+
+    printf("[bench] delay ns/sample: legacy-modulo=%.2f ring-integer=%.2f lagrange=%.2f thiran=%.2f\n",
+           legacy, ring, lagr, thir);
+    // Block copy must not be slower than the per-sample modulo loop
+    TEST_ASSERT_TRUE(ring <= legacy * 1.5 + 0.5);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_is_power_of_two_with_headroom);
+    RUN_TEST(test_integer_delay_across_ring_wrap);
+    RUN_TEST(test_integer_delay_shorter_than_block);
+    RUN_TEST(test_max_delay_is_not_zero_delay);
+    RUN_TEST(test_lagrange_half_sample);
+    RUN_TEST(test_lagrange_zero_integer_part);
+    RUN_TEST(test_thiran_quarter_sample);
+    RUN_TEST(test_thiran_three_quarter_sample);
+    RUN_TEST(test_fraction_without_interp_is_integer);
+    RUN_TEST(test_set_fraction_clamps);
+    RUN_TEST(test_slot_capacity_respects_budget);
+    RUN_TEST(test_swap_keeps_delay_history);
+    RUN_TEST(test_stage_moved_to_another_slot_keeps_history);
+    RUN_TEST(test_benchmark_delay_stage_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,239 @@
+// test_dsp_fir_design.cpp
+// FIR designer: linear-phase Linkwitz-Riley crossovers against the analytic
+// (bilinear) magnitude (and a flat LPF + HPF sum), minimum-phase LR against the
+// analytic LR magnitude and phase, minimum-phase EQ from target points,
+// spec validation, determinism, and the design time of a 2048-tap
+// crossover.
+
+#define DSP_ENABLED
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <complex>
+#include <chrono>
+
+#include "../../src/dsp_fir_design.cpp"
+
+#define FS 48000
+
+static float _taps[DSP_FIR_DESIGN_MAX_TAPS];
+static float _taps2[DSP_FIR_DESIGN_MAX_TAPS];
+static float _work[3 * DSP_FIR_DESIGN_MAX_FFT];
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static DspFirDesignSpec lr_spec(DspFirDesignKind kind, int taps, float fc, int order, int role) {
+    DspFirDesignSpec s;
+    memset(&s, 0, sizeof(s));
+    s.kind = kind;
+    s.numTaps = (uint16_t)taps;
+    s.sampleRate = FS;
+    s.freqHz = fc;
+    s.order = (uint8_t)order;
+    s.role = (uint8_t)role;
+    return s;
+}
+
+// Frequency response of taps at f (double precision DFT)
+static std::complex<double> fir_response(const float *h, int n, double f) {
+    std::complex<double> acc(0.0, 0.0);
+    double w = 2.0 * M_PI * f / FS;
+    for (int i = 0; i < n; i++) acc += (double)h[i] * std::polar(1.0, -w * i);
+    return acc;
+}
+
+// Linkwitz-Riley LR(2M) = Butterworth(M)^2 at f, through the prewarped
+// bilinear transform (the response of the IIR crossover presets)
+static std::complex<double> lr_analytic(double f, double fc, int order, int role) {
+    int m = order / 2;
+    std::complex<double> s(0.0, tan(M_PI * f / FS) / tan(M_PI * fc / FS));
+    std::complex<double> den(1.0, 0.0);
+    for (int k = 1; k <= m; k++) {
+        std::complex<double> pole = std::polar(1.0, M_PI * (2.0 * k + m - 1) / (2.0 * m));
+        den *= (s - pole);
+    }
+    std::complex<double> bw = (role == 0 ? 1.0 : std::pow(s, m)) / den;
+    return bw * bw;
+}
+
+static double db(std::complex<double> z) { return 20.0 * log10(std::abs(z) + 1e-30); }
+
+static double wrap_deg(double a) {
+    while (a > 180.0) a -= 360.0;
+    while (a < -180.0) a += 360.0;
+    return a;
+}
+
+// ===== Linear Phase =====
+
+void test_linear_lr4_lpf_matches_analytic_magnitude(void) {
+    DspFirDesignSpec s = lr_spec(DSP_FIR_DESIGN_LR_LINEAR, 2048, 1000.0f, 4, 0);
+    TEST_ASSERT_EQUAL_INT(2048, dsp_fir_design(s, _taps, _work));
+    const double freqs[] = {100, 300, 600, 1000, 1500, 2000, 3000, 5000};
+    for (double f : freqs) {
+        double target = db(lr_analytic(f, 1000.0, 4, 0));
+        double got = db(fir_response(_taps, 2048, f));
+        TEST_ASSERT_FLOAT_WITHIN(0.05, target, got);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.1, -6.02, db(fir_response(_taps, 2048, 1000.0)));
+    TEST_ASSERT_TRUE(db(fir_response(_taps, 2048, 12000.0)) < -70.0);
+}
+
+void test_linear_lr_has_pure_delay_phase(void) {
+    DspFirDesignSpec s = lr_spec(DSP_FIR_DESIGN_LR_LINEAR, 1025, 2000.0f, 8, 1);
+    dsp_fir_design(s, _taps, _work);
+    // Symmetric around tap 512 → phase is exactly -w * 512 (mod pi where H < 0)
+    for (int i = 0; i < 512; i++) TEST_ASSERT_FLOAT_WITHIN(1e-7f, _taps[i], _taps[1024 - i]);
+    const double freqs[] = {1500, 2000, 4000, 8000};
+    for (double f : freqs) {
+        double ph = std::arg(fir_response(_taps, 1025, f)) * 180.0 / M_PI;
+        double expect = -360.0 * f / FS * 512.0;
+        TEST_ASSERT_FLOAT_WITHIN(0.5, 0.0, wrap_deg(ph - expect));
+    }
+}
+
+void test_linear_lr_pair_sums_flat(void) {
+    const int orders[] = {2, 4, 8};
+    for (int order : orders) {
+        DspFirDesignSpec lp = lr_spec(DSP_FIR_DESIGN_LR_LINEAR, 2048, 500.0f, order, 0);
+        DspFirDesignSpec hp = lr_spec(DSP_FIR_DESIGN_LR_LINEAR, 2048, 500.0f, order, 1);
+        dsp_fir_design(lp, _taps, _work);
+        dsp_fir_design(hp, _taps2, _work);
+        for (int i = 0; i < 2048; i++) _taps[i] += _taps2[i];
+        for (double f = 50.0; f < 20000.0; f *= 1.25) {
+            TEST_ASSERT_FLOAT_WITHIN(0.05, 0.0, db(fir_response(_taps, 2048, f)));
+        }
+    }
+}
+
+// ===== Minimum Phase =====
+
+void test_minimum_lr4_matches_analytic_magnitude_and_phase(void) {
+    for (int role = 0; role < 2; role++) {
+        DspFirDesignSpec s = lr_spec(DSP_FIR_DESIGN_LR_MINIMUM, 2048, 1000.0f, 4, role);
+        TEST_ASSERT_EQUAL_INT(2048, dsp_fir_design(s, _taps, _work));
+        const double freqs[] = {300, 500, 800, 1000, 1250, 2000, 3000};
+        for (double f : freqs) {
+            std::complex<double> want = lr_analytic(f, 1000.0, 4, role);
+            std::complex<double> got = fir_response(_taps, 2048, f);
+            if (db(want) < -40.0) continue;
+            TEST_ASSERT_FLOAT_WITHIN(0.1, db(want), db(got));
+            double dph = wrap_deg((std::arg(got) - std::arg(want)) * 180.0 / M_PI);
+            TEST_ASSERT_FLOAT_WITHIN(2.0, 0.0, dph);
+        }
+    }
+}
+
+void test_minimum_eq_follows_target_points(void) {
+    DspFirDesignSpec s;
+    memset(&s, 0, sizeof(s));
+    s.kind = DSP_FIR_DESIGN_EQ_MINIMUM;
+    s.numTaps = 1024;
+    s.sampleRate = FS;
+    s.numPoints = 4;
+    s.points[0] = {100.0f, 6.0f};
+    s.points[1] = {400.0f, 6.0f};
+    s.points[2] = {1600.0f, -3.0f};
+    s.points[3] = {10000.0f, -3.0f};
+    TEST_ASSERT_EQUAL_INT(1024, dsp_fir_design(s, _taps, _work));
+    const double freqs[] = {150, 400, 800, 1600, 5000};
+    for (double f : freqs) {
+        double target = 20.0 * log10(dsp_fir_design_target(s, (float)f));
+        TEST_ASSERT_FLOAT_WITHIN(0.25, target, db(fir_response(_taps, 1024, f)));
+    }
+    // Minimum phase: the energy is at the front
+    double head = 0.0, total = 0.0;
+    for (int i = 0; i < 1024; i++) {
+        total += (double)_taps[i] * _taps[i];
+        if (i < 64) head += (double)_taps[i] * _taps[i];
+    }
+    TEST_ASSERT_TRUE(head > 0.95 * total);
+}
+
+// ===== Validation and Determinism =====
+
+void test_invalid_specs_are_rejected(void) {
+    DspFirDesignSpec s = lr_spec(DSP_FIR_DESIGN_LR_LINEAR, 2048, 1000.0f, 3, 0);
+    TEST_ASSERT_NOT_NULL(dsp_fir_design_check(s));            // Odd LR order
+    TEST_ASSERT_EQUAL_INT(-1, dsp_fir_design(s, _taps, _work));
+    s.order = 4;
+    s.freqHz = 30000.0f;
+    TEST_ASSERT_NOT_NULL(dsp_fir_design_check(s));            // Above Nyquist
+    s.freqHz = 1000.0f;
+    s.numTaps = DSP_FIR_DESIGN_MAX_TAPS + 1;
+    TEST_ASSERT_NOT_NULL(dsp_fir_design_check(s));
+    s.numTaps = 2048;
+    TEST_ASSERT_NULL(dsp_fir_design_check(s));
+
+    DspFirDesignSpec e;
+    memset(&e, 0, sizeof(e));
+    e.kind = DSP_FIR_DESIGN_EQ_MINIMUM;
+    e.numTaps = 512;
+    e.sampleRate = FS;
+    e.numPoints = 2;
+    e.points[0] = {1000.0f, 0.0f};
+    e.points[1] = {500.0f, 3.0f};
+    TEST_ASSERT_NOT_NULL(dsp_fir_design_check(e));            // Not ascending
+}
+
+static int _lastPercent;
+static int _calls;
+static void on_progress(int percent, void *ctx) {
+    (void)ctx;
+    TEST_ASSERT_TRUE(percent >= _lastPercent);
+    _lastPercent = percent;
+    _calls++;
+}
+
+void test_design_is_deterministic_with_progress(void) {
+    DspFirDesignSpec s = lr_spec(DSP_FIR_DESIGN_LR_MINIMUM, 1500, 250.0f, 8, 1);
+    _lastPercent = 0;
+    _calls = 0;
+    dsp_fir_design(s, _taps, _work, on_progress, nullptr);
+    TEST_ASSERT_EQUAL_INT(100, _lastPercent);
+    TEST_ASSERT_TRUE(_calls >= 4);
+    memset(_work, 0x5A, sizeof(_work));                        // Work contents must not matter
+    dsp_fir_design(s, _taps2, _work);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_taps, _taps2, 1500 * sizeof(float)));
+}
+
+void test_fft_grid_size(void) {
+    TEST_ASSERT_EQUAL_INT(DSP_FIR_DESIGN_MIN_FFT, dsp_fir_design_fft_size(64));
+    TEST_ASSERT_EQUAL_INT(8192, dsp_fir_design_fft_size(2048));
+    TEST_ASSERT_EQUAL_INT(DSP_FIR_DESIGN_MAX_FFT, dsp_fir_design_fft_size(DSP_FIR_DESIGN_MAX_TAPS));
+    TEST_ASSERT_EQUAL_UINT32(3 * 8192, dsp_fir_design_work_floats(2048));
+}
+
+// ===== Benchmark =====
+
+void test_benchmark_2048_tap_crossover(void) {
+    DspFirDesignSpec lin = lr_spec(DSP_FIR_DESIGN_LR_LINEAR, 2048, 80.0f, 4, 0);
+    DspFirDesignSpec mph = lr_spec(DSP_FIR_DESIGN_LR_MINIMUM, 2048, 80.0f, 4, 0);
+    const int iters = 10;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) dsp_fir_design(lin, _taps, _work);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) dsp_fir_design(mph, _taps, _work);
+    auto t2 = std::chrono::steady_clock::now();
+    double linUs = (double)std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / iters;
+    double mphUs = (double)std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / iters;
+    printf("[bench] 2048-tap LR4 design (8192-point grid): linear=%.0f us minimum=%.0f us\n", linUs, mphUs);
+    TEST_ASSERT_TRUE(linUs > 0.0 && mphUs > 0.0);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_linear_lr4_lpf_matches_analytic_magnitude);
+    RUN_TEST(test_linear_lr_has_pure_delay_phase);
+    RUN_TEST(test_linear_lr_pair_sums_flat);
+    RUN_TEST(test_minimum_lr4_matches_analytic_magnitude_and_phase);
+    RUN_TEST(test_minimum_eq_follows_target_points);
+    RUN_TEST(test_invalid_specs_are_rejected);
+    RUN_TEST(test_design_is_deterministic_with_progress);
+    RUN_TEST(test_fft_grid_size);
+    RUN_TEST(test_benchmark_2048_tap_crossover);
+    return UNITY_END();
+}
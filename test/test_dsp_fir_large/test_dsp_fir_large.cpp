@@ -0,0 +1,275 @@
+// test_dsp_fir_large.cpp
+// Long FIR stages: direct block kernel and partitioned overlap-save against a
+// reference convolution, seamless switching between them, the slot pool and
+// FFT crossover plumbing, plus a native benchmark (ns/sample) of the legacy
+// dsps_fir_f32 loop, the block kernel and overlap-save.
+
+// 4096-tap stages regardless of the native build default
+#undef DSP_MAX_FIR_TAPS
+#define DSP_MAX_FIR_TAPS 4096
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "../../lib/esp_dsp_lite/src/dsps_biquad_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_init_f32.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fird_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_corr_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_conv_f32_ansi.c"
+#include "../../src/dsp_biquad_gen.c"
+
+#include "../../src/dsp_pipeline.h"
+#include "../../src/dsp_coefficients.h"
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/dsp_coefficients.cpp"
+#include "../../src/dsp_pipeline.cpp"
+#include "../../src/dsp_crossover.cpp"
+#include "../../src/dsp_convolution.cpp"
+#include "../../src/thd_measurement.cpp"
+
+#define N_SIG 8192
+
+static DspFirRun _run;
+static float _h[DSP_MAX_FIR_TAPS];
+static float _x[N_SIG], _y[N_SIG], _ref[N_SIG];
+
+void setUp(void) {
+    dsp_init();
+    dsp_fir_run_init(_run);
+}
+
+void tearDown(void) {}
+
+static float frand(void) { return (float)rand() / (float)RAND_MAX - 0.5f; }
+
+// Random decaying filter and white-noise input with its exact response.
+// `gain` keeps pipeline outputs inside the final [-1, 1] clamp.
+static void make_filter(int n, unsigned seed, float gain = 1.0f) {
+    srand(seed);
+    for (int i = 0; i < n; i++) _h[i] = gain * frand() * expf(-(float)i / (0.3f * n));
+    for (int i = 0; i < N_SIG; i++) _x[i] = frand();
+    for (int t = 0; t < N_SIG; t++) {
+        double a = 0.0;
+        for (int k = 0; k < n && k <= t; k++) a += (double)_h[k] * _x[t - k];
+        _ref[t] = (float)a;
+    }
+}
+
+// Run the kernel over _x in blocks cycling through `sizes`
+static float run_blocks(int n, const int *sizes, int count, bool allowFft) {
+    memcpy(_y, _x, sizeof(_y));
+    int t = 0, b = 0;
+    while (t < N_SIG) {
+        int len = sizes[b++ % count];
+        if (t + len > N_SIG) len = N_SIG - t;
+        dsp_fir_run_process(_run, _h, (uint16_t)n, _y + t, len, allowFft);
+        t += len;
+    }
+    float err = 0.0f;
+    for (int i = 0; i < N_SIG; i++) {
+        float e = fabsf(_y[i] - _ref[i]);
+        if (e > err) err = e;
+    }
+    return err;
+}
+
+// ===== Direct block kernel =====
+
+void test_direct_short_filters_match_reference(void) {
+    const int lens[] = {1, 3, 7, 64, 65, 300};
+    const int sizes[] = {256, 37, 1, 128, 64};
+    for (int n : lens) {
+        make_filter(n, (unsigned)n);
+        dsp_fir_run_init(_run);
+        char msg[32];
+        snprintf(msg, sizeof(msg), "n=%d", n);
+        TEST_ASSERT_TRUE_MESSAGE(run_blocks(n, sizes, 5, false) < 1e-5f, msg);
+    }
+}
+
+void test_direct_long_filter_across_compaction(void) {
+    const int sizes[] = {256};
+    make_filter(DSP_MAX_FIR_TAPS, 11);
+    TEST_ASSERT_TRUE(run_blocks(DSP_MAX_FIR_TAPS, sizes, 1, false) < 1e-4f);
+}
+
+// ===== Overlap-save =====
+
+void test_fft_matches_reference(void) {
+    const int lens[] = {64, 200, 1000, DSP_MAX_FIR_TAPS};
+    const int sizes[] = {256, 64, 128};
+    for (int n : lens) {
+        make_filter(n, (unsigned)n + 1);
+        dsp_fir_run_init(_run);
+        dsp_fir_prepare(_run, _h, (uint16_t)n);
+        char msg[32];
+        snprintf(msg, sizeof(msg), "n=%d", n);
+        TEST_ASSERT_TRUE_MESSAGE(run_blocks(n, sizes, 3, true) < 1e-4f, msg);
+    }
+}
+
+void test_switching_between_kernels_is_seamless(void) {
+    // 100-sample blocks are not whole hops and run the split form; the
+    // frequency-domain delay line is rebuilt after the direct-only blocks
+    const int sizes[] = {256, 100, 256, 28, 64, 256};
+    make_filter(1500, 5);
+    dsp_fir_prepare(_run, _h, 1500);
+    TEST_ASSERT_TRUE(run_blocks(1500, sizes, 6, true) < 1e-4f);
+
+    const int mixed[] = {64, 40, 88, 128};
+    dsp_fir_run_init(_run);
+    dsp_fir_prepare(_run, _h, 1500);
+    TEST_ASSERT_TRUE(run_blocks(1500, mixed, 4, true) < 1e-4f);
+}
+
+void test_fft_small_blocks_use_split_form(void) {
+    // Sub-hop blocks (e.g. 32 samples inside a /8 multirate section) stay on
+    // the FFT path with zero latency
+    const int sizes[] = {32};
+    make_filter(DSP_MAX_FIR_TAPS, 31);
+    dsp_fir_prepare(_run, _h, DSP_MAX_FIR_TAPS);
+    TEST_ASSERT_TRUE(run_blocks(DSP_MAX_FIR_TAPS, sizes, 1, true) < 1e-4f);
+    float buf[32];
+    memcpy(buf, _x, sizeof(buf));
+    TEST_ASSERT_EQUAL_UINT8(DSP_FIR_MODE_FFT, dsp_fir_run_process(_run, _h, DSP_MAX_FIR_TAPS, buf, 32, true));
+}
+
+void test_prepare_for_other_length_falls_back_to_direct(void) {
+    make_filter(512, 9);
+    dsp_fir_prepare(_run, _h, 256);
+    float buf[256];
+    memcpy(buf, _x, sizeof(buf));
+    TEST_ASSERT_EQUAL_UINT8(DSP_FIR_MODE_DIRECT, dsp_fir_run_process(_run, _h, 512, buf, 256, true));
+    dsp_fir_prepare(_run, _h, 512);
+    TEST_ASSERT_EQUAL_UINT8(DSP_FIR_MODE_FFT, dsp_fir_run_process(_run, _h, 512, buf, 256, true));
+}
+
+// ===== Pipeline stage =====
+
+static int add_fir_stage(int numTaps) {
+    int idx = dsp_add_stage(0, DSP_FIR);
+    TEST_ASSERT_TRUE(idx >= 0);
+    DspState *cfg = dsp_get_inactive_config();
+    DspStage &s = cfg->channels[0].stages[idx];
+    for (int st = 0; st < 2; st++) memcpy(dsp_fir_get_taps(st, s.fir.firSlot), _h, numTaps * sizeof(float));
+    s.fir.numTaps = (uint16_t)numTaps;
+    dsp_fir_commit_taps(s.fir.firSlot, numTaps);
+    cfg->channels[0].bypass = false;
+    dsp_swap_config();
+    return idx;
+}
+
+void test_stage_above_crossover_runs_fft(void) {
+    make_filter(2048, 21, 0.05f);
+    TEST_ASSERT_TRUE(2048 >= dsp_fir_fft_crossover());
+    int idx = add_fir_stage(2048);
+
+    float l[256], r[256];
+    float err = 0.0f;
+    for (int t = 0; t < 4096; t += 256) {
+        memcpy(l, _x + t, sizeof(l));
+        memset(r, 0, sizeof(r));
+        dsp_process_buffer_float(l, r, 256, 0);
+        for (int i = 0; i < 256; i++) {
+            float e = fabsf(l[i] - _ref[t + i]);
+            if (e > err) err = e;
+        }
+    }
+    TEST_ASSERT_TRUE(err < 1e-4f);
+    DspState *act = dsp_get_active_config();
+    TEST_ASSERT_EQUAL_UINT8(DSP_FIR_MODE_FFT, act->channels[0].stages[idx].fir.mode);
+}
+
+void test_stage_below_crossover_runs_direct(void) {
+    make_filter(32, 3, 0.5f);
+    int idx = add_fir_stage(32);
+    float l[256], r[256];
+    memcpy(l, _x, sizeof(l));
+    memset(r, 0, sizeof(r));
+    dsp_process_buffer_float(l, r, 256, 0);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, _ref[200], l[200]);
+    TEST_ASSERT_EQUAL_UINT8(DSP_FIR_MODE_DIRECT, dsp_get_active_config()->channels[0].stages[idx].fir.mode);
+}
+
+void test_swap_keeps_filter_history(void) {
+    make_filter(1024, 17, 0.05f);
+    add_fir_stage(1024);
+    float l[256], r[256];
+    memcpy(l, _x, sizeof(l));
+    memset(r, 0, sizeof(r));
+    dsp_process_buffer_float(l, r, 256, 0);
+
+    // Unrelated edit + swap: the next block still continues the convolution
+    dsp_copy_active_to_inactive();
+    dsp_swap_config();
+    memcpy(l, _x + 256, sizeof(l));
+    memset(r, 0, sizeof(r));
+    dsp_process_buffer_float(l, r, 256, 0);
+    for (int i = 0; i < 256; i += 17) TEST_ASSERT_FLOAT_WITHIN(1e-4f, _ref[256 + i], l[i]);
+}
+
+// ===== Benchmark =====
+
+static volatile float _sink;
+
+template <typename F>
+static double bench_ns_per_sample(F fn) {
+    const int block = 256, iters = 60;
+    static float buf[block];
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < iters; k++) {
+        for (int i = 0; i < block; i++) buf[i] = (float)((k * block + i) % 17) * 0.01f;
+        fn(buf, block);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    _sink = buf[7];
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    return ns / ((double)block * iters);
+}
+
+void test_benchmark_fir_kernels(void) {
+    static float legacyDelay[DSP_MAX_FIR_TAPS + 8];
+    const int lens[] = {64, 128, 256, 512, 1024, 2048, 4096};
+    int measured = 0;
+    for (int n : lens) {
+        for (int i = 0; i < n; i++) _h[i] = (i & 1) ? -1e-3f : 1e-3f;
+        fir_f32_t legacy;
+        memset(&legacy, 0, sizeof(legacy));
+        memset(legacyDelay, 0, sizeof(legacyDelay));
+        legacy.coeffs = _h;
+        legacy.delay = legacyDelay;
+        legacy.N = n;
+        double old = bench_ns_per_sample([&](float *b, int len) { dsps_fir_f32(&legacy, b, b, len); });
+        dsp_fir_run_init(_run);
+        double direct = bench_ns_per_sample([&](float *b, int len) { dsp_fir_run_process(_run, _h, (uint16_t)n, b, len, false); });
+        dsp_fir_prepare(_run, _h, (uint16_t)n);
+        double fft = bench_ns_per_sample([&](float *b, int len) { dsp_fir_run_process(_run, _h, (uint16_t)n, b, len, true); });
+        if (!measured && fft < direct) measured = n;
+        printf("[bench] fir %4d taps ns/sample: dsps_fir=%.1f block=%.1f overlap-save=%.1f\n", n, old, direct, fft);
+    }
+    printf("[bench] fir measured FFT crossover on this host: %d taps (default %d)\n", measured, DSP_FIR_FFT_MIN_TAPS);
+    // Overlap-save must win by a wide margin at the maximum length
+    TEST_ASSERT_TRUE(measured > 0);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_direct_short_filters_match_reference);
+    RUN_TEST(test_direct_long_filter_across_compaction);
+    RUN_TEST(test_fft_matches_reference);
+    RUN_TEST(test_switching_between_kernels_is_seamless);
+    RUN_TEST(test_fft_small_blocks_use_split_form);
+    RUN_TEST(test_prepare_for_other_length_falls_back_to_direct);
+    RUN_TEST(test_stage_above_crossover_runs_fft);
+    RUN_TEST(test_stage_below_crossover_runs_direct);
+    RUN_TEST(test_swap_keeps_filter_history);
+    RUN_TEST(test_benchmark_fir_kernels);
+    return UNITY_END();
+}
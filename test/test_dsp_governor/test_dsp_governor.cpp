@@ -0,0 +1,347 @@
+// test_dsp_governor.cpp
+// CPU load governor: level state machine and hysteresis, per-level spectrum /
+// metering / convolution downgrades, shed order by priority and measured
+// cost, protected stages, cost carry-over across swaps, and a simulation that
+// drives a synthetic load curve through the pipeline.
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../lib/esp_dsp_lite/src/dsps_biquad_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_init_f32.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fird_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_corr_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_conv_f32_ansi.c"
+#include "../../src/dsp_biquad_gen.c"
+
+#include "../../src/dsp_pipeline.h"
+#include "../../src/dsp_coefficients.h"
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/dsp_coefficients.cpp"
+#include "../../src/dsp_pipeline.cpp"
+#include "../../src/dsp_crossover.cpp"
+#include "../../src/dsp_convolution.cpp"
+#include "../../src/thd_measurement.cpp"
+
+static DspGovernor _g;
+
+void setUp(void) {
+    dsp_init();
+    dsp_gov_init(_g);
+}
+
+void tearDown(void) {
+    for (int s = 0; s < CONV_MAX_IR_SLOTS; s++) dsp_conv_free_slot(s);
+}
+
+// Feed `n` periods at a fixed load; returns the final level
+static int feed(float load, int n, int maxLevel = 10) {
+    for (int i = 0; i < n; i++) dsp_gov_step(_g, load, maxLevel);
+    return _g.level;
+}
+
+// ===== State machine =====
+
+void test_initial_level_normal(void) {
+    TEST_ASSERT_EQUAL_UINT8(DSP_GOV_NORMAL, _g.level);
+    TEST_ASSERT_EQUAL_UINT8(DSP_GOV_NORMAL, dsp_get_governor_level());
+    TEST_ASSERT_EQUAL_UINT8(DSP_GOV_NORMAL, dsp_get_metrics().governorLevel);
+}
+
+void test_warning_steps_up_after_hold(void) {
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_NORMAL, feed(85.0f, DSP_GOV_ESCALATE_PERIODS - 1));
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_SPECTRUM, feed(85.0f, 1));
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_METERING, feed(85.0f, DSP_GOV_ESCALATE_PERIODS));
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_SHED, feed(85.0f, DSP_GOV_ESCALATE_PERIODS));
+}
+
+void test_interrupted_warning_does_not_step(void) {
+    for (int i = 0; i < 10; i++) {
+        feed(85.0f, DSP_GOV_ESCALATE_PERIODS - 1);
+        feed(50.0f, 1);
+    }
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_NORMAL, _g.level);
+}
+
+void test_critical_jumps_to_shedding(void) {
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_SHED, feed(99.0f, 1));
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_SHED + 1, feed(99.0f, 1));
+}
+
+void test_level_capped_by_max(void) {
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_SHED - 1, feed(99.0f, 5, DSP_GOV_SHED - 1));
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_SHED + 1, feed(99.0f, 20, DSP_GOV_SHED + 1));
+    // Lower cap (stages removed) clamps at once
+    dsp_gov_step(_g, 75.0f, DSP_GOV_METERING);
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_METERING, _g.level);
+}
+
+void test_dead_band_holds_level(void) {
+    feed(99.0f, 1);
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_SHED, feed(75.0f, DSP_GOV_RELAX_PERIODS * 3));
+}
+
+void test_relax_steps_down_one_level_at_a_time(void) {
+    feed(99.0f, 2);
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_SHED + 1, _g.level);
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_SHED + 1, feed(50.0f, DSP_GOV_RELAX_PERIODS - 1));
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_SHED, feed(50.0f, 1));
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_NORMAL, feed(50.0f, DSP_GOV_RELAX_PERIODS * DSP_GOV_SHED));
+}
+
+void test_level_effects(void) {
+    TEST_ASSERT_EQUAL_INT(1, dsp_gov_spectrum_divider(DSP_GOV_NORMAL));
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_DIVIDER, dsp_gov_spectrum_divider(DSP_GOV_SPECTRUM));
+    TEST_ASSERT_EQUAL_INT(1, dsp_gov_meter_divider(DSP_GOV_SPECTRUM));
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_DIVIDER, dsp_gov_meter_divider(DSP_GOV_METERING));
+    TEST_ASSERT_EQUAL_INT(0, dsp_gov_shed_count(DSP_GOV_METERING));
+    TEST_ASSERT_EQUAL_INT(1, dsp_gov_shed_count(DSP_GOV_SHED));
+    TEST_ASSERT_EQUAL_INT(3, dsp_gov_shed_count(DSP_GOV_SHED + 2));
+    // Every level keeps the downgrades of the levels below it
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_DIVIDER, dsp_gov_spectrum_divider(DSP_GOV_SHED + 2));
+    TEST_ASSERT_EQUAL_INT(DSP_GOV_DIVIDER, dsp_gov_meter_divider(DSP_GOV_SHED + 2));
+}
+
+// ===== Pipeline =====
+
+static int add_fir(int ch, uint8_t priority) {
+    int idx = dsp_add_chain_stage(ch, DSP_FIR);
+    TEST_ASSERT_TRUE(idx >= 0);
+    DspStage &s = dsp_get_inactive_config()->channels[ch].stages[idx];
+    TEST_ASSERT_TRUE(s.fir.firSlot >= 0);
+    s.fir.numTaps = 1;
+    float *taps = dsp_fir_get_taps(_activeIndex ^ 1, s.fir.firSlot);
+    if (taps) taps[0] = 1.0f;
+    s.priority = priority;
+    return idx;
+}
+
+static int add_conv(int ch, uint8_t priority) {
+    int idx = dsp_add_chain_stage(ch, DSP_CONVOLUTION);
+    TEST_ASSERT_TRUE(idx >= 0);
+    dsp_get_inactive_config()->channels[ch].stages[idx].priority = priority;
+    return idx;
+}
+
+static DspOp *op_for(int ch, int idx) {
+    DspStage *st = &dsp_get_active_config()->channels[ch].stages[idx];
+    DspProgram &p = _programs[_activeIndex][ch / 2];
+    for (int i = 0; i < p.count; i++) if (p.ops[i].stage == st) return &p.ops[i];
+    return nullptr;
+}
+
+// One period: inject the load, then run every lane's block
+static void period(float load) {
+    static float l[64], r[64];
+    dsp_test_set_cpu_load(load);
+    for (int lane = 0; lane < DSP_MAX_CHANNELS / 2; lane++) {
+        for (int i = 0; i < 64; i++) { l[i] = 0.25f; r[i] = 0.25f; }
+        dsp_process_buffer_float(l, r, 64, lane);
+    }
+}
+
+void test_shed_order_follows_priority(void) {
+    int prot = add_fir(0, DSP_PRIORITY_PROTECTED);
+    int low = add_fir(1, DSP_PRIORITY_LOW);
+    int norm = add_conv(0, DSP_PRIORITY_NORMAL);
+    dsp_swap_config();
+
+    period(99.0f);
+    TEST_ASSERT_EQUAL_UINT8(DSP_GOV_SHED, dsp_get_governor_level());
+    TEST_ASSERT_EQUAL_UINT8(1, op_for(1, low)->shed);
+    TEST_ASSERT_EQUAL_UINT8(0, op_for(0, norm)->shed);
+
+    period(99.0f);
+    TEST_ASSERT_EQUAL_UINT8(1, op_for(0, norm)->shed);
+    TEST_ASSERT_EQUAL_UINT8(2, dsp_get_metrics().shedStageCount);
+
+    // Protected stage is never shed, however long the overload lasts
+    for (int i = 0; i < 50; i++) period(120.0f);
+    TEST_ASSERT_EQUAL_UINT8(0, op_for(0, prot)->shed);
+    TEST_ASSERT_EQUAL_UINT8(DSP_GOV_SHED + 1, dsp_get_governor_level());
+    TEST_ASSERT_EQUAL_UINT8(DSP_GOV_SHED + 1, dsp_get_metrics().governorLevel);
+}
+
+void test_default_fir_never_shed(void) {
+    // Stage as a user adds it: no priority override
+    int idx = dsp_add_chain_stage(0, DSP_FIR);
+    TEST_ASSERT_TRUE(idx >= 0);
+    DspStage &s = dsp_get_inactive_config()->channels[0].stages[idx];
+    TEST_ASSERT_EQUAL_UINT8(DSP_PRIORITY_PROTECTED, s.priority);
+    s.fir.numTaps = 1;
+    dsp_fir_get_taps(_activeIndex ^ 1, s.fir.firSlot)[0] = 0.5f;   // -6 dB
+    int conv = dsp_add_chain_stage(1, DSP_CONVOLUTION);
+    TEST_ASSERT_EQUAL_UINT8(DSP_PRIORITY_PROTECTED,
+                            dsp_get_inactive_config()->channels[1].stages[conv].priority);
+    dsp_swap_config();
+
+    for (int i = 0; i < 50; i++) period(120.0f);
+    // Nothing is sheddable, so the governor tops out below the shed levels
+    TEST_ASSERT_EQUAL_UINT8(DSP_GOV_SHED - 1, dsp_get_governor_level());
+    TEST_ASSERT_EQUAL_UINT8(0, op_for(0, idx)->shed);
+    TEST_ASSERT_EQUAL_UINT8(0, dsp_get_metrics().shedStageCount);
+
+    // The FIR still filters at the governor's top level
+    float l[64], r[64] = {};
+    for (int i = 0; i < 64; i++) l[i] = 0.5f;
+    dsp_process_buffer_float(l, r, 64, 0);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.25f, l[10]);
+}
+
+void test_shed_stage_is_bypassed(void) {
+    int idx = add_fir(0, DSP_PRIORITY_NORMAL);
+    DspStage &s = dsp_get_inactive_config()->channels[0].stages[idx];
+    float *taps = dsp_fir_get_taps(_activeIndex ^ 1, s.fir.firSlot);
+    taps[0] = 0.5f;   // -6 dB
+    dsp_swap_config();
+
+    float l[64], r[64] = {};
+    for (int i = 0; i < 64; i++) l[i] = 0.5f;
+    dsp_process_buffer_float(l, r, 64, 0);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.25f, l[10]);
+
+    period(99.0f);
+    for (int i = 0; i < 64; i++) l[i] = 0.5f;
+    dsp_process_buffer_float(l, r, 64, 0);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.5f, l[10]);
+    TEST_ASSERT_EQUAL_UINT8(1, dsp_get_metrics().firBypassCount);
+}
+
+void test_costlier_stage_shed_first_within_priority(void) {
+    int a = add_fir(0, DSP_PRIORITY_NORMAL);
+    int b = add_fir(1, DSP_PRIORITY_NORMAL);
+    dsp_swap_config();
+    op_for(0, a)->costUs = 40.0f;
+    op_for(1, b)->costUs = 90.0f;
+
+    period(99.0f);
+    TEST_ASSERT_EQUAL_UINT8(0, op_for(0, a)->shed);
+    TEST_ASSERT_EQUAL_UINT8(1, op_for(1, b)->shed);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 90.0f, dsp_get_metrics().shedCostUs);
+}
+
+void test_swap_keeps_costs_and_shedding(void) {
+    int a = add_fir(0, DSP_PRIORITY_NORMAL);
+    int b = add_fir(1, DSP_PRIORITY_NORMAL);
+    dsp_swap_config();
+    op_for(0, a)->costUs = 90.0f;
+    op_for(1, b)->costUs = 40.0f;
+    period(99.0f);
+    TEST_ASSERT_EQUAL_UINT8(1, op_for(0, a)->shed);
+
+    // Unrelated edit: the rebuilt program carries the costs and the shed set
+    dsp_copy_active_to_inactive();
+    dsp_add_chain_stage(2, DSP_LIMITER);
+    dsp_swap_config();
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 90.0f, op_for(0, a)->costUs);
+    TEST_ASSERT_EQUAL_UINT8(1, op_for(0, a)->shed);
+    TEST_ASSERT_EQUAL_UINT8(0, op_for(1, b)->shed);
+}
+
+void test_governor_never_shortens_convolution(void) {
+    float ir[200];
+    for (int i = 0; i < 200; i++) ir[i] = 0.01f;
+    TEST_ASSERT_EQUAL_INT(0, dsp_conv_init_slot(0, ir, 200));
+
+    // Sustained warning load: every level short of shedding
+    for (int i = 0; i < DSP_GOV_ESCALATE_PERIODS * DSP_GOV_SHED; i++) period(85.0f);
+    TEST_ASSERT_EQUAL_UINT8(DSP_GOV_SHED - 1, dsp_get_governor_level());
+
+    float x[256] = {};
+    x[0] = 1.0f;
+    dsp_conv_process(0, x, 256);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.01f, x[199]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, x[200]);
+
+    // An explicit tap limit still truncates
+    dsp_conv_set_tap_limit(64);
+    dsp_conv_init_slot(0, ir, 200);
+    memset(x, 0, sizeof(x));
+    x[0] = 1.0f;
+    dsp_conv_process(0, x, 256);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.01f, x[63]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, x[64]);
+    dsp_conv_set_tap_limit(0);
+    dsp_conv_free_slot(0);
+}
+
+// ===== Simulation =====
+// Demand follows a synthetic curve (idle, a slow ramp into overload, a plateau,
+// a short spike, recovery). The measured load is the demand minus what the
+// current level saves, as on the target.
+
+static float saved_percent(int level) {
+    float s = 0.0f;
+    if (level >= DSP_GOV_SPECTRUM) s += 3.0f;
+    if (level >= DSP_GOV_METERING) s += 2.0f;
+    return s + 12.0f * dsp_gov_shed_count(level);
+}
+
+static float demand(int t) {
+    if (t < 400) return 60.0f;
+    if (t < 1000) return 60.0f + 40.0f * (t - 400) / 600.0f;   // Ramp to 100 %
+    if (t < 2500) return 100.0f;
+    if (t < 2510) return 125.0f;                               // Spike
+    if (t < 3000) return 100.0f;
+    return 55.0f;                                              // Load removed
+}
+
+void test_simulated_load_curve(void) {
+    int prot = add_fir(0, DSP_PRIORITY_PROTECTED);
+    add_fir(1, DSP_PRIORITY_LOW);
+    add_conv(0, DSP_PRIORITY_NORMAL);
+    add_conv(1, DSP_PRIORITY_NORMAL);
+    dsp_swap_config();
+
+    const int T = 6000;
+    int changes = 0, maxLevel = 0, firstShed = -1, overCritAfterShed = 0;
+    int prev = dsp_get_governor_level();
+    for (int t = 0; t < T; t++) {
+        float load = demand(t) - saved_percent(dsp_get_governor_level());
+        period(load);
+        int lvl = dsp_get_governor_level();
+        if (lvl != prev) changes++;
+        if (lvl > maxLevel) maxLevel = lvl;
+        if (firstShed < 0 && lvl >= DSP_GOV_SHED) firstShed = t;
+        if (firstShed >= 0 && t > firstShed + 20 && t < 2500 && load >= DSP_CPU_CRIT_PERCENT) overCritAfterShed++;
+        TEST_ASSERT_EQUAL_UINT8(0, op_for(0, prot)->shed);
+        prev = lvl;
+    }
+    printf("[sim] level changes=%d max level=%d first shed at period %d\n", changes, maxLevel, firstShed);
+
+    // Degrades in order and settles below critical during the plateau
+    TEST_ASSERT_TRUE(firstShed > 400);
+    TEST_ASSERT_TRUE(maxLevel >= DSP_GOV_SHED);
+    TEST_ASSERT_TRUE(maxLevel <= DSP_GOV_SHED + 2);
+    TEST_ASSERT_EQUAL_INT(0, overCritAfterShed);
+    // Hysteresis: no level chatter
+    TEST_ASSERT_TRUE(changes <= 2 * (maxLevel + 1));
+    // Fully restored once the load is gone
+    TEST_ASSERT_EQUAL_UINT8(DSP_GOV_NORMAL, dsp_get_governor_level());
+    TEST_ASSERT_EQUAL_UINT8(0, dsp_get_metrics().shedStageCount);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_initial_level_normal);
+    RUN_TEST(test_warning_steps_up_after_hold);
+    RUN_TEST(test_interrupted_warning_does_not_step);
+    RUN_TEST(test_critical_jumps_to_shedding);
+    RUN_TEST(test_level_capped_by_max);
+    RUN_TEST(test_dead_band_holds_level);
+    RUN_TEST(test_relax_steps_down_one_level_at_a_time);
+    RUN_TEST(test_level_effects);
+    RUN_TEST(test_shed_order_follows_priority);
+    RUN_TEST(test_default_fir_never_shed);
+    RUN_TEST(test_shed_stage_is_bypassed);
+    RUN_TEST(test_costlier_stage_shed_first_within_priority);
+    RUN_TEST(test_swap_keeps_costs_and_shedding);
+    RUN_TEST(test_governor_never_shortens_convolution);
+    RUN_TEST(test_simulated_load_curve);
+    return UNITY_END();
+}
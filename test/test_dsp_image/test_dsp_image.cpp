@@ -0,0 +1,479 @@
+// test_dsp_image.cpp
+// Tests for the binary DSP config image (dsp_image_pack / dsp_image_unpack)
+// and its A/B snapshot store, which replace the per-channel JSON files on the
+// boot path.
+//
+// Verifies a full round trip (stages, labels, priorities, FIR taps), that
+// pool slots are re-allocated and runtime state cleared on restore, that
+// images from another layout or truncated images are refused without
+// touching the config, and that a snapshot store holds the image across a
+// simulated reboot. The final test benchmarks boot-to-audio (load + decode +
+// swap) and save latency against the JSON path; the JSON side parses with
+// ArduinoJson when the build has it (the PlatformIO native env does).
+
+#include <unity.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+#include <string>
+
+#if defined(__has_include)
+#if __has_include(<ArduinoJson.h>)
+#include <ArduinoJson.h>
+#define TEST_HAVE_ARDUINOJSON 1
+#endif
+#endif
+
+// Include DSP sources directly (test_build_src = no)
+#include "../../lib/esp_dsp_lite/src/dsps_biquad_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_init_f32.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fird_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_corr_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_conv_f32_ansi.c"
+#include "../../src/dsp_biquad_gen.c"
+
+#include "../test_mocks/Arduino.h"
+#include "../test_mocks/LittleFS.h"
+
+#include "../../src/dsp_pipeline.h"
+#include "../../src/app_state.h"
+#include "../../src/config_snapshot.h"
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/dsp_coefficients.cpp"
+#include "../../src/dsp_convolution.cpp"
+#include "../../src/dsp_pipeline.cpp"
+#include "../../src/config_snapshot.cpp"
+
+static uint8_t _img[DSP_IMAGE_MAX_BYTES];
+static ConfigSnapshotStore _store = CONFIG_SNAPSHOT_STORE(CONFIG_SNAPSHOT_BASE_DSP, DSP_IMAGE_MAX_BYTES);
+
+// Stage indices in channel 0 after buildChain()
+static int _firIdx, _gainIdx, _compIdx, _delayIdx, _convIdx;
+
+static void fillTaps(float *taps, int n, float seed) {
+    for (int i = 0; i < n; i++) taps[i] = seed + 0.001f * (float)i;
+}
+
+// Representative chain: PEQ edits on every channel plus FIR, gain,
+// compressor, delay and convolution stages on channel 0
+static void buildChain() {
+    DspState *cfg = dsp_get_inactive_config();
+    cfg->sampleRate = 96000;
+    for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+        for (int b = 0; b < 4; b++) {
+            DspStage &s = cfg->channels[ch].stages[b];
+            s.enabled = true;
+            s.biquad.frequency = 100.0f * (float)(b + 1) + (float)ch;
+            s.biquad.gain = -3.0f + (float)b;
+            s.biquad.Q = 1.2f;
+        }
+    }
+    cfg->channels[1].bypass = true;
+    cfg->channels[2].stereoLink = false;
+
+    _firIdx = dsp_add_stage(0, DSP_FIR, -1);
+    _gainIdx = dsp_add_stage(0, DSP_GAIN, -1);
+    _compIdx = dsp_add_stage(0, DSP_COMPRESSOR, -1);
+    _delayIdx = dsp_add_stage(0, DSP_DELAY, -1);
+    _convIdx = dsp_add_stage(0, DSP_CONVOLUTION, -1);
+
+    DspChannelConfig &c0 = cfg->channels[0];
+    DspStage &fir = c0.stages[_firIdx];
+    fir.fir.numTaps = 200;
+    fir.priority = DSP_PRIORITY_PROTECTED;
+    strcpy(fir.label, "Xover");
+    fillTaps(dsp_fir_get_taps(0, fir.fir.firSlot), 200, 0.5f);
+    fillTaps(dsp_fir_get_taps(1, fir.fir.firSlot), 200, 0.5f);
+    dsp_fir_commit_taps(fir.fir.firSlot, 200);
+
+    c0.stages[_gainIdx].gain.gainDb = -6.0f;
+    dsp_compute_gain_linear(c0.stages[_gainIdx].gain);
+    c0.stages[_compIdx].compressor.thresholdDb = -20.0f;
+    c0.stages[_compIdx].compressor.envelope = 0.7f;          // Runtime state
+    c0.stages[_delayIdx].delay.delaySamples = 480;
+    c0.stages[_delayIdx].delay.writePos = 123;               // Runtime state
+    c0.stages[_convIdx].convolution.irLength = 4096;
+    strcpy(c0.stages[_convIdx].convolution.irFilename, "room.wav");
+
+    for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+        dsp_recompute_channel_coeffs(cfg->channels[ch], cfg->sampleRate);
+    }
+    TEST_ASSERT_TRUE(dsp_swap_config());
+}
+
+static void simulateReboot() {
+    dsp_init();
+    config_snapshot_store_test_reset(_store);
+}
+
+void setUp(void) {
+    MockFS::reset();
+    LittleFS.begin();
+    dsp_init();
+    config_snapshot_store_test_reset(_store);
+}
+
+void tearDown(void) {}
+
+// ---------------------------------------------------------------------------
+
+void test_image_roundtrip(void) {
+    buildChain();
+    DspState before = *dsp_get_active_config();
+    size_t len = dsp_image_pack(_img, sizeof(_img));
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_TRUE(len <= DSP_IMAGE_MAX_BYTES);
+
+    simulateReboot();
+    TEST_ASSERT_TRUE(dsp_image_unpack(_img, len));
+    TEST_ASSERT_TRUE(dsp_swap_config());
+
+    DspState *after = dsp_get_active_config();
+    TEST_ASSERT_EQUAL_UINT32(96000, after->sampleRate);
+    TEST_ASSERT_TRUE(after->channels[1].bypass);
+    TEST_ASSERT_FALSE(after->channels[2].stereoLink);
+    for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+        TEST_ASSERT_EQUAL_INT(before.channels[ch].stageCount, after->channels[ch].stageCount);
+        for (int b = 0; b < 4; b++) {
+            TEST_ASSERT_EQUAL_FLOAT(before.channels[ch].stages[b].biquad.frequency,
+                                    after->channels[ch].stages[b].biquad.frequency);
+            TEST_ASSERT_EQUAL_FLOAT(before.channels[ch].stages[b].biquad.coeffs[0],
+                                    after->channels[ch].stages[b].biquad.coeffs[0]);
+        }
+    }
+
+    DspChannelConfig &c0 = after->channels[0];
+    DspStage &fir = c0.stages[_firIdx];
+    TEST_ASSERT_EQUAL(DSP_FIR, fir.type);
+    TEST_ASSERT_EQUAL_STRING("Xover", fir.label);
+    TEST_ASSERT_EQUAL_UINT8(DSP_PRIORITY_PROTECTED, fir.priority);
+    TEST_ASSERT_EQUAL_UINT16(200, fir.fir.numTaps);
+    TEST_ASSERT_TRUE(fir.fir.firSlot >= 0);
+    float expect[200];
+    fillTaps(expect, 200, 0.5f);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(expect, dsp_fir_get_taps(0, fir.fir.firSlot), 200);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(expect, dsp_fir_get_taps(1, fir.fir.firSlot), 200);
+
+    TEST_ASSERT_EQUAL_FLOAT(-6.0f, c0.stages[_gainIdx].gain.gainDb);
+    TEST_ASSERT_EQUAL_FLOAT(-20.0f, c0.stages[_compIdx].compressor.thresholdDb);
+    TEST_ASSERT_EQUAL_UINT16(480, c0.stages[_delayIdx].delay.delaySamples);
+    TEST_ASSERT_TRUE(c0.stages[_delayIdx].delay.delaySlot >= 0);
+    TEST_ASSERT_EQUAL_UINT16(4096, c0.stages[_convIdx].convolution.irLength);
+    TEST_ASSERT_EQUAL_STRING("room.wav", c0.stages[_convIdx].convolution.irFilename);
+}
+
+void test_restore_clears_runtime_and_reassigns_slots(void) {
+    buildChain();
+    size_t len = dsp_image_pack(_img, sizeof(_img));
+    TEST_ASSERT_TRUE(len > 0);
+
+    simulateReboot();
+    TEST_ASSERT_TRUE(dsp_image_unpack(_img, len));
+    DspChannelConfig &c0 = dsp_get_inactive_config()->channels[0];
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, c0.stages[_compIdx].compressor.envelope);
+    TEST_ASSERT_EQUAL_UINT16(0, c0.stages[_delayIdx].delay.writePos);
+    TEST_ASSERT_EQUAL_FLOAT(c0.stages[_gainIdx].gain.gainLinear, c0.stages[_gainIdx].gain.currentLinear);
+    // IRs are re-uploaded after boot, never restored from a stale index
+    TEST_ASSERT_EQUAL_INT8(-1, c0.stages[_convIdx].convolution.convSlot);
+
+    // Every restored stage has a distinct, non-zero ID
+    for (int i = 0; i < c0.stageCount; i++) {
+        TEST_ASSERT_NOT_EQUAL(0, c0.stages[i].id);
+        for (int j = i + 1; j < c0.stageCount; j++) {
+            TEST_ASSERT_NOT_EQUAL(c0.stages[i].id, c0.stages[j].id);
+        }
+    }
+
+    // Restoring again (e.g. a second load) frees the first restore's slots
+    TEST_ASSERT_TRUE(dsp_image_unpack(_img, len));
+    TEST_ASSERT_TRUE(dsp_get_inactive_config()->channels[0].stages[_firIdx].fir.firSlot >= 0);
+}
+
+void test_layout_mismatch_rejected(void) {
+    buildChain();
+    size_t len = dsp_image_pack(_img, sizeof(_img));
+    TEST_ASSERT_TRUE(len > 0);
+
+    simulateReboot();
+    DspState untouched = *dsp_get_inactive_config();
+
+    DspImageHeader hdr;
+    memcpy(&hdr, _img, sizeof(hdr));
+    hdr.stageBytes = sizeof(DspStage) + 4;     // Image from a build with a larger DspStage
+    memcpy(_img, &hdr, sizeof(hdr));
+    TEST_ASSERT_FALSE(dsp_image_unpack(_img, len));
+
+    hdr.stageBytes = sizeof(DspStage);
+    hdr.version = DSP_IMAGE_VERSION + 1;
+    memcpy(_img, &hdr, sizeof(hdr));
+    TEST_ASSERT_FALSE(dsp_image_unpack(_img, len));
+
+    TEST_ASSERT_EQUAL_MEMORY(&untouched, dsp_get_inactive_config(), sizeof(DspState));
+}
+
+void test_truncated_image_rejected(void) {
+    buildChain();
+    size_t len = dsp_image_pack(_img, sizeof(_img));
+    TEST_ASSERT_TRUE(len > 0);
+
+    simulateReboot();
+    DspState untouched = *dsp_get_inactive_config();
+    TEST_ASSERT_FALSE(dsp_image_unpack(_img, len - 4));         // Missing FIR taps
+    TEST_ASSERT_FALSE(dsp_image_unpack(_img, sizeof(DspImageHeader) + 2));
+    TEST_ASSERT_FALSE(dsp_image_unpack(_img, len + 4));         // Trailing bytes
+    TEST_ASSERT_EQUAL_MEMORY(&untouched, dsp_get_inactive_config(), sizeof(DspState));
+}
+
+void test_pack_refuses_small_buffer(void) {
+    buildChain();
+    size_t len = dsp_image_pack(_img, sizeof(_img));
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_EQUAL(0, (int)dsp_image_pack(_img, len - 1));
+}
+
+void test_snapshot_store_survives_reboot(void) {
+    buildChain();
+    size_t len = dsp_image_pack(_img, sizeof(_img));
+    TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_store_save(_store, 1, _img, len));
+    // A second save lands in the other slot; the first stays as fallback
+    TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_store_save(_store, 1, _img, len));
+    TEST_ASSERT_TRUE(LittleFS.exists("/dsp_a.bin"));
+    TEST_ASSERT_TRUE(LittleFS.exists("/dsp_b.bin"));
+    // The settings store is separate
+    TEST_ASSERT_FALSE(LittleFS.exists(CONFIG_SNAPSHOT_PATH_A));
+
+    simulateReboot();
+    memset(_img, 0, sizeof(_img));
+    size_t got = 0;
+    TEST_ASSERT_EQUAL(CFG_SNAP_OK, config_snapshot_store_load(_store, 1, _img, sizeof(_img), &got));
+    TEST_ASSERT_EQUAL(len, got);
+    TEST_ASSERT_EQUAL_UINT32(2, _store.stats.generation);
+    TEST_ASSERT_TRUE(dsp_image_unpack(_img, got));
+    TEST_ASSERT_TRUE(dsp_swap_config());
+    TEST_ASSERT_EQUAL_UINT16(200, dsp_get_active_config()->channels[0].stages[_firIdx].fir.numTaps);
+
+    // Import promotion drops the store so the promoted JSON is loaded next
+    config_snapshot_remove(CONFIG_SNAPSHOT_BASE_DSP);
+    config_snapshot_store_test_reset(_store);
+    TEST_ASSERT_EQUAL(CFG_SNAP_NONE, config_snapshot_store_load(_store, 1, _img, sizeof(_img), &got));
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark — boot-to-audio and save on the LittleFS mock.
+//
+// Snapshot boot: load + CRC the store, decode the image, recompute
+// coefficients, swap. JSON boot (old path): read /dsp_global.json, the four
+// /dsp_ch%d.json files and /dsp_fir0.bin, parse and apply each stage the way
+// dsp_load_config_from_json() does, recompute, swap. Saves: pack + store
+// write vs serialize + write the same files.
+
+#ifdef TEST_HAVE_ARDUINOJSON
+// The exporter's per-channel document for the active config
+static void channelToJson(const DspChannelConfig &ch, JsonDocument &doc) {
+    doc["bypass"] = ch.bypass;
+    doc["stereoLink"] = ch.stereoLink;
+    JsonArray stages = doc["stages"].to<JsonArray>();
+    for (int i = 0; i < ch.stageCount; i++) {
+        const DspStage &s = ch.stages[i];
+        JsonObject o = stages.add<JsonObject>();
+        o["enabled"] = s.enabled;
+        o["type"] = stage_type_name(s.type);
+        if (s.label[0]) o["label"] = s.label;
+        JsonObject p = o["params"].to<JsonObject>();
+        if (dsp_is_biquad_type(s.type)) {
+            p["frequency"] = s.biquad.frequency;
+            p["gain"] = s.biquad.gain;
+            p["Q"] = s.biquad.Q;
+            p["Q2"] = s.biquad.Q2;
+        } else if (s.type == DSP_FIR) {
+            p["numTaps"] = s.fir.numTaps;
+        } else if (s.type == DSP_GAIN) {
+            p["gainDb"] = s.gain.gainDb;
+        } else if (s.type == DSP_COMPRESSOR) {
+            p["thresholdDb"] = s.compressor.thresholdDb;
+            p["attackMs"] = s.compressor.attackMs;
+            p["releaseMs"] = s.compressor.releaseMs;
+            p["ratio"] = s.compressor.ratio;
+            p["kneeDb"] = s.compressor.kneeDb;
+            p["makeupGainDb"] = s.compressor.makeupGainDb;
+        } else if (s.type == DSP_DELAY) {
+            p["delaySamples"] = s.delay.delaySamples;
+        } else if (s.type == DSP_CONVOLUTION) {
+            p["irLength"] = s.convolution.irLength;
+            p["irFilename"] = s.convolution.irFilename;
+        }
+    }
+}
+
+// The JSON loader's decode of one channel (field-for-field the same work)
+static void channelFromJson(const char *json, DspChannelConfig &ch, uint32_t rate) {
+    JsonDocument doc;
+    if (deserializeJson(doc, json)) return;
+    ch.bypass = doc["bypass"] | false;
+    ch.stereoLink = doc["stereoLink"] | true;
+    ch.stageCount = 0;
+    for (JsonObject o : doc["stages"].as<JsonArray>()) {
+        if (ch.stageCount >= DSP_MAX_STAGES) break;
+        DspStage &s = ch.stages[ch.stageCount];
+        const char *type = o["type"] | "PEQ";
+        DspStageType t = DSP_BIQUAD_PEQ;
+        for (int k = 0; k < DSP_STAGE_TYPE_COUNT; k++) {
+            if (strcmp(stage_type_name((DspStageType)k), type) == 0) { t = (DspStageType)k; break; }
+        }
+        dsp_init_stage(s, t);
+        s.enabled = o["enabled"] | true;
+        strncpy(s.label, o["label"] | "", sizeof(s.label) - 1);
+        JsonObject p = o["params"];
+        if (dsp_is_biquad_type(t)) {
+            s.biquad.frequency = p["frequency"] | 1000.0f;
+            s.biquad.gain = p["gain"] | 0.0f;
+            s.biquad.Q = p["Q"] | 0.707f;
+            s.biquad.Q2 = p["Q2"] | 0.707f;
+            dsp_compute_biquad_coeffs(s.biquad, t, rate);
+        } else if (t == DSP_FIR) {
+            s.fir.numTaps = p["numTaps"] | 0;
+        } else if (t == DSP_GAIN) {
+            s.gain.gainDb = p["gainDb"] | 0.0f;
+            dsp_compute_gain_linear(s.gain);
+        } else if (t == DSP_COMPRESSOR) {
+            s.compressor.thresholdDb = p["thresholdDb"] | -12.0f;
+            s.compressor.attackMs = p["attackMs"] | 10.0f;
+            s.compressor.releaseMs = p["releaseMs"] | 100.0f;
+            s.compressor.ratio = p["ratio"] | 4.0f;
+            s.compressor.kneeDb = p["kneeDb"] | 6.0f;
+            s.compressor.makeupGainDb = p["makeupGainDb"] | 0.0f;
+            dsp_compute_compressor_makeup(s.compressor);
+        } else if (t == DSP_DELAY) {
+            s.delay.delaySamples = p["delaySamples"] | 0;
+        } else if (t == DSP_CONVOLUTION) {
+            s.convolution.irLength = p["irLength"] | 0;
+            strncpy(s.convolution.irFilename, p["irFilename"] | "", sizeof(s.convolution.irFilename) - 1);
+        }
+        ch.stageCount++;
+    }
+}
+#endif
+
+void test_benchmark_boot_and_save_vs_json(void) {
+    using clk = std::chrono::steady_clock;
+    const int ITER = 300;
+    buildChain();
+
+    clk::time_point t0 = clk::now();
+    size_t len = 0;
+    for (int i = 0; i < ITER; i++) {
+        len = dsp_image_pack(_img, sizeof(_img));
+        config_snapshot_store_save(_store, 1, _img, len);
+    }
+    double snapSaveUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / ITER;
+
+    t0 = clk::now();
+    for (int i = 0; i < ITER; i++) {
+        config_snapshot_store_test_reset(_store);
+        size_t got = 0;
+        config_snapshot_store_load(_store, 1, _img, sizeof(_img), &got);
+        dsp_image_unpack(_img, got);
+        DspState *cfg = dsp_get_inactive_config();
+        for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+            dsp_recompute_channel_coeffs(cfg->channels[ch], cfg->sampleRate);
+        }
+        dsp_swap_config();
+    }
+    double snapBootUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / ITER;
+
+    char msg[200];
+#ifdef TEST_HAVE_ARDUINOJSON
+    DspState *active = dsp_get_active_config();
+    const DspStage &fir = active->channels[0].stages[_firIdx];
+    static char text[4096];
+
+    t0 = clk::now();
+    for (int i = 0; i < ITER; i++) {
+        JsonDocument g;
+        g["globalBypass"] = active->globalBypass;
+        g["sampleRate"] = active->sampleRate;
+        size_t n = serializeJson(g, text, sizeof(text));
+        File gf = LittleFS.open("/dsp_global.json", "w");
+        gf.write((const uint8_t *)text, n);
+        gf.close();
+        for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+            JsonDocument doc;
+            channelToJson(active->channels[ch], doc);
+            n = serializeJson(doc, text, sizeof(text));
+            char path[24];
+            snprintf(path, sizeof(path), "/dsp_ch%d.json", ch);
+            File f = LittleFS.open(path, "w");
+            f.write((const uint8_t *)text, n);
+            f.close();
+        }
+        File ff = LittleFS.open("/dsp_fir0.bin", "w");
+        ff.write((const uint8_t *)dsp_fir_get_taps(_activeIndex, fir.fir.firSlot), fir.fir.numTaps * sizeof(float));
+        ff.close();
+    }
+    double jsonSaveUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / ITER;
+
+    t0 = clk::now();
+    for (int i = 0; i < ITER; i++) {
+        DspState *cfg = dsp_get_inactive_config();
+        File f = LittleFS.open("/dsp_global.json", "r");
+        size_t n = f.read((uint8_t *)text, sizeof(text) - 1);
+        f.close();
+        text[n] = '\0';
+        JsonDocument g;
+        deserializeJson(g, (const char *)text);   // Copying parse, like the loader's String
+        cfg->sampleRate = g["sampleRate"] | 48000;
+        for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+            char path[24];
+            snprintf(path, sizeof(path), "/dsp_ch%d.json", ch);
+            File cf = LittleFS.open(path, "r");
+            n = cf.read((uint8_t *)text, sizeof(text) - 1);
+            cf.close();
+            text[n] = '\0';
+            channelFromJson(text, cfg->channels[ch], cfg->sampleRate);
+        }
+        File ff = LittleFS.open("/dsp_fir0.bin", "r");
+        ff.read((uint8_t *)dsp_fir_get_taps(0, fir.fir.firSlot), ff.size());
+        ff.close();
+        for (int ch = 0; ch < DSP_MAX_CHANNELS; ch++) {
+            dsp_recompute_channel_coeffs(cfg->channels[ch], cfg->sampleRate);
+        }
+        dsp_swap_config();
+    }
+    double jsonBootUs = std::chrono::duration<double, std::micro>(clk::now() - t0).count() / ITER;
+
+    snprintf(msg, sizeof(msg),
+             "boot-to-audio: snapshot %.1f us vs JSON parse %.1f us | save: snapshot %.1f us vs JSON %.1f us (%u B image)",
+             snapBootUs, jsonBootUs, snapSaveUs, jsonSaveUs, (unsigned)len);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(snapBootUs < jsonBootUs);
+#else
+    snprintf(msg, sizeof(msg),
+             "boot-to-audio: snapshot %.1f us | save: snapshot %.1f us (%u B image) | JSON side needs ArduinoJson",
+             snapBootUs, snapSaveUs, (unsigned)len);
+    TEST_MESSAGE(msg);
+#endif
+    TEST_ASSERT_TRUE(snapBootUs < 5000.0);
+    TEST_ASSERT_TRUE(snapSaveUs < 5000.0);
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_image_roundtrip);
+    RUN_TEST(test_restore_clears_runtime_and_reassigns_slots);
+    RUN_TEST(test_layout_mismatch_rejected);
+    RUN_TEST(test_truncated_image_rejected);
+    RUN_TEST(test_pack_refuses_small_buffer);
+    RUN_TEST(test_snapshot_store_survives_reboot);
+    RUN_TEST(test_benchmark_boot_and_save_vs_json);
+
+    return UNITY_END();
+}
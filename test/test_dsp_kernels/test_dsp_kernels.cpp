@@ -0,0 +1,377 @@
+// test_dsp_kernels.cpp
+// Shared stage kernels (dsp_kernels.h): the input DSP and the output DSP run
+// the same chain bit-identically (filters and dynamics, then delay, FIR,
+// convolution, multi-band and bass enhance), the output DSP accepts the
+// full mono stage set, direct kernel checks, and a native benchmark of the
+// same chain on both engines.
+
+#define OUTPUT_DSP_MAX_CHANNELS 8
+#define OUTPUT_DSP_MAX_STAGES 12
+#define OUTPUT_DSP_MAX_DELAY_SAMPLES 4800
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "../../lib/esp_dsp_lite/src/dsps_biquad_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_init_f32.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fird_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_corr_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_conv_f32_ansi.c"
+#include "../../src/dsp_biquad_gen.c"
+
+#include "../../src/dsp_pipeline.h"
+#include "../../src/dsp_coefficients.h"
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/dsp_coefficients.cpp"
+#include "../../src/dsp_pipeline.cpp"
+#include "../../src/dsp_crossover.cpp"
+#include "../../src/dsp_convolution.cpp"
+#include "../../src/thd_measurement.cpp"
+#include "../../src/output_dsp.cpp"
+
+#define BLOCK 256
+#define BLOCKS 24
+
+void setUp(void) {
+    dsp_init();
+    output_dsp_init();
+    for (int i = 0; i < CONV_MAX_IR_SLOTS; i++) dsp_conv_free_slot(i);
+
+    // Input channel 1 bypassed so channel 0 runs its own (mono) program
+    dsp_get_inactive_config()->channels[1].bypass = true;
+    output_dsp_get_inactive_config()->channels[0].bypass = false;
+}
+
+void tearDown(void) {}
+
+static void make_signal(float *x, int n, int seed) {
+    uint32_t s = 0x1234567u * (uint32_t)(seed + 1);
+    for (int i = 0; i < n; i++) {
+        s = s * 1664525u + 1013904223u;
+        x[i] = 0.25f * ((float)(s >> 8) / 8388608.0f - 1.0f);
+    }
+}
+
+// Program content with bursts and silences so gates, compressors and
+// limiters move through attack, hold and release
+static void make_program(float *x, int n, int block) {
+    make_signal(x, n, block);
+    float level = (block % 6 == 5) ? 0.002f : (block % 3 == 0 ? 3.2f : 1.0f);
+    for (int i = 0; i < n; i++) {
+        x[i] = x[i] * level + 0.2f * sinf(0.031f * (float)(block * n + i));
+    }
+}
+
+// Same parameters on either engine's stage struct
+template <typename S>
+static void configure(S &s, uint32_t rate) {
+    switch (s.type) {
+        case DSP_BIQUAD_PEQ:
+            s.biquad.frequency = 1200.0f; s.biquad.gain = 4.5f; s.biquad.Q = 1.4f;
+            dsp_compute_biquad_coeffs(s.biquad, s.type, rate);
+            break;
+        case DSP_BIQUAD_HPF:
+            s.biquad.frequency = 45.0f; s.biquad.Q = 0.707f;
+            dsp_compute_biquad_coeffs(s.biquad, s.type, rate);
+            break;
+        case DSP_TONE_CTRL:
+            s.toneCtrl.bassGain = 3.0f; s.toneCtrl.midGain = -2.0f; s.toneCtrl.trebleGain = 1.5f;
+            dsp_compute_tone_ctrl_coeffs(s.toneCtrl, rate);
+            break;
+        case DSP_LOUDNESS:
+            s.loudness.currentLevelDb = 60.0f;
+            dsp_compute_loudness_coeffs(s.loudness, rate);
+            break;
+        case DSP_GAIN:
+            s.gain.gainDb = -4.0f;
+            dsp_compute_gain_linear(s.gain);      // Ramps from unity
+            break;
+        case DSP_POLARITY:
+            s.polarity.inverted = true;
+            break;
+        case DSP_COMPRESSOR:
+            s.compressor.thresholdDb = -18.0f; s.compressor.ratio = 3.0f;
+            s.compressor.kneeDb = 6.0f; s.compressor.makeupGainDb = 2.0f;
+            dsp_compute_compressor_makeup(s.compressor);
+            break;
+        case DSP_NOISE_GATE:
+            s.noiseGate.thresholdDb = -45.0f; s.noiseGate.holdMs = 5.0f; s.noiseGate.rangeDb = -60.0f;
+            break;
+        case DSP_LIMITER:
+            s.limiter.thresholdDb = -3.0f;
+            break;
+        case DSP_TRUE_PEAK_LIMITER:
+            s.truePeak.ceilingDb = -1.5f; s.truePeak.linked = false;
+            break;
+        case DSP_DELAY:
+            s.delay.delaySamples = 37;
+            dsp_delay_set_fraction(s.delay, 0.4f, DSP_DELAY_INTERP_LAGRANGE);
+            break;
+        case DSP_BASS_ENHANCE:
+            s.bassEnhance.frequency = 90.0f; s.bassEnhance.harmonicGainDb = 3.0f; s.bassEnhance.mix = 40.0f;
+            dsp_compute_bass_enhance_coeffs(s.bassEnhance, rate);
+            break;
+        default:
+            break;
+    }
+}
+
+static float _fir[48];
+static float _ir[300];
+
+static void make_filters() {
+    for (int i = 0; i < 48; i++) {
+        float t = (float)i - 23.5f;
+        _fir[i] = 0.12f * sinf(0.35f * t) / (0.35f * t) * (0.54f - 0.46f * cosf(6.2831853f * i / 47.0f));
+    }
+    for (int i = 0; i < 300; i++) _ir[i] = (i == 0 ? 0.7f : 0.0f) + 0.2f * expf(-0.02f * i) * sinf(0.4f * i);
+}
+
+// Build the same chain on input channel 0 and output channel 0
+static void build_chain(const DspStageType *types, int n) {
+    make_filters();
+    DspState *in = dsp_get_inactive_config();
+    OutputDspState *out = output_dsp_get_inactive_config();
+    int mbBoundary[3] = {250, 2500, 9000};
+    for (int i = 0; i < n; i++) {
+        int ii = dsp_add_chain_stage(0, types[i]);
+        int oi = output_dsp_add_stage(0, types[i]);
+        TEST_ASSERT_TRUE(ii >= 0);
+        TEST_ASSERT_TRUE(oi >= 0);
+        DspStage &si = in->channels[0].stages[ii];
+        OutputDspStage &so = out->channels[0].stages[oi];
+        configure(si, in->sampleRate);
+        configure(so, out->sampleRate);
+
+        if (types[i] == DSP_FIR) {
+            for (int st = 0; st < 2; st++) memcpy(dsp_fir_get_taps(st, si.fir.firSlot), _fir, sizeof(_fir));
+            si.fir.numTaps = 48;
+            dsp_fir_commit_taps(si.fir.firSlot, 48);
+            TEST_ASSERT_TRUE(output_dsp_set_fir_taps(0, _fir, 48));
+        } else if (types[i] == DSP_CONVOLUTION) {
+            TEST_ASSERT_EQUAL_INT(0, dsp_conv_init_slot(0, _ir, 300));
+            si.convolution.convSlot = 0;
+            si.convolution.irLength = 300;
+            TEST_ASSERT_EQUAL_INT(1, output_dsp_load_ir(0, _ir, 300));
+        } else if (types[i] == DSP_MULTIBAND_COMP) {
+            for (int b = 0; b < 3; b++) {
+                TEST_ASSERT_TRUE(dsp_mb_set_crossover_freq(si.multibandComp.mbSlot, b, (float)mbBoundary[b], in->sampleRate));
+                TEST_ASSERT_TRUE(output_dsp_mb_set_crossover_freq(0, b, (float)mbBoundary[b]));
+            }
+            TEST_ASSERT_TRUE(dsp_mb_set_band_params(si.multibandComp.mbSlot, 1, -24.0f, 5.0f, 80.0f, 4.0f, 6.0f, 1.0f));
+            TEST_ASSERT_TRUE(output_dsp_mb_set_band_params(0, 1, -24.0f, 5.0f, 80.0f, 4.0f, 6.0f, 1.0f));
+        }
+    }
+    dsp_swap_config();
+    output_dsp_swap_config();
+}
+
+// Run both engines block by block; returns the first differing sample
+// index (or -1) and the largest output level seen
+static int run_both(int blocks, float *peak) {
+    static float x[BLOCK], a[BLOCK], r[BLOCK], b[BLOCK];
+    *peak = 0.0f;
+    for (int k = 0; k < blocks; k++) {
+        make_program(x, BLOCK, k);
+        memcpy(a, x, sizeof(x));
+        memcpy(b, x, sizeof(x));
+        memset(r, 0, sizeof(r));
+        dsp_process_buffer_float(a, r, BLOCK, 0);
+        output_dsp_process(0, b, BLOCK);
+        for (int i = 0; i < BLOCK; i++) {
+            if (fabsf(a[i]) > *peak) *peak = fabsf(a[i]);
+        }
+        if (memcmp(a, b, sizeof(a)) != 0) {
+            for (int i = 0; i < BLOCK; i++) {
+                if (memcmp(&a[i], &b[i], sizeof(float)) != 0) return k * BLOCK + i;
+            }
+        }
+    }
+    return -1;
+}
+
+// ===== Golden Output =====
+
+void test_filters_and_dynamics_bit_identical(void) {
+    const DspStageType chain[] = {
+        DSP_BIQUAD_HPF, DSP_NOISE_GATE, DSP_BIQUAD_PEQ, DSP_TONE_CTRL, DSP_LOUDNESS,
+        DSP_GAIN, DSP_COMPRESSOR, DSP_POLARITY, DSP_LIMITER, DSP_TRUE_PEAK_LIMITER
+    };
+    build_chain(chain, sizeof(chain) / sizeof(chain[0]));
+    float peak;
+    TEST_ASSERT_EQUAL_INT(-1, run_both(BLOCKS, &peak));
+    TEST_ASSERT_TRUE(peak > 0.05f);                // Signal made it through
+    TEST_ASSERT_TRUE(peak < 1.0f);                 // Input clamp never engaged
+}
+
+void test_delay_fir_conv_multiband_bit_identical(void) {
+    const DspStageType chain[] = {
+        DSP_DELAY, DSP_FIR, DSP_CONVOLUTION, DSP_MULTIBAND_COMP, DSP_BASS_ENHANCE, DSP_GAIN
+    };
+    build_chain(chain, sizeof(chain) / sizeof(chain[0]));
+    float peak;
+    TEST_ASSERT_EQUAL_INT(-1, run_both(BLOCKS, &peak));
+    TEST_ASSERT_TRUE(peak > 0.01f);
+    TEST_ASSERT_TRUE(peak < 1.0f);
+}
+
+void test_republished_chain_stays_identical(void) {
+    const DspStageType chain[] = {DSP_BIQUAD_PEQ, DSP_COMPRESSOR, DSP_GAIN};
+    build_chain(chain, 3);
+    float peak;
+    TEST_ASSERT_EQUAL_INT(-1, run_both(4, &peak));
+
+    // Retune the PEQ on both engines; the swap morphs it on both
+    dsp_copy_active_to_inactive();
+    output_dsp_copy_active_to_inactive();
+    DspStage &si = dsp_get_inactive_config()->channels[0].stages[DSP_PEQ_BANDS];
+    OutputDspStage &so = output_dsp_get_inactive_config()->channels[0].stages[0];
+    TEST_ASSERT_EQUAL_INT(DSP_BIQUAD_PEQ, si.type);
+    TEST_ASSERT_EQUAL_INT(DSP_BIQUAD_PEQ, so.type);
+    si.biquad.gain = so.biquad.gain = -6.0f;
+    dsp_compute_biquad_coeffs(si.biquad, si.type, 48000);
+    dsp_compute_biquad_coeffs(so.biquad, so.type, 48000);
+    dsp_swap_config();
+    output_dsp_swap_config();
+    TEST_ASSERT_EQUAL_INT(-1, run_both(8, &peak));
+}
+
+// ===== Output Stage Set =====
+
+void test_output_accepts_full_mono_stage_set(void) {
+    const DspStageType mono[] = {
+        DSP_FIR, DSP_CONVOLUTION, DSP_NOISE_GATE, DSP_TONE_CTRL, DSP_LOUDNESS,
+        DSP_BASS_ENHANCE, DSP_MULTIBAND_COMP, DSP_TRUE_PEAK_LIMITER, DSP_DELAY
+    };
+    for (unsigned i = 0; i < sizeof(mono) / sizeof(mono[0]); i++) {
+        TEST_ASSERT_TRUE(output_dsp_type_supported(mono[i]));
+        TEST_ASSERT_TRUE(output_dsp_add_stage(2, mono[i]) >= 0);
+    }
+    TEST_ASSERT_FALSE(output_dsp_type_supported(DSP_STEREO_WIDTH));
+    TEST_ASSERT_FALSE(output_dsp_type_supported(DSP_DECIMATOR));
+    TEST_ASSERT_EQUAL_INT(-1, output_dsp_add_stage(2, DSP_STEREO_WIDTH));
+}
+
+void test_output_limits_stateful_stages_per_channel(void) {
+    TEST_ASSERT_TRUE(output_dsp_add_stage(3, DSP_FIR) >= 0);
+    TEST_ASSERT_EQUAL_INT(-1, output_dsp_add_stage(3, DSP_FIR));
+    TEST_ASSERT_TRUE(output_dsp_add_stage(3, DSP_MULTIBAND_COMP) >= 0);
+    TEST_ASSERT_EQUAL_INT(-1, output_dsp_add_stage(3, DSP_MULTIBAND_COMP));
+    TEST_ASSERT_TRUE(output_dsp_add_stage(4, DSP_FIR) >= 0);     // Other channel is independent
+    TEST_ASSERT_TRUE(output_dsp_add_stage(3, DSP_DELAY) >= 0);
+    TEST_ASSERT_TRUE(output_dsp_add_stage(3, DSP_DELAY) >= 0);   // Delays share the channel ring
+}
+
+void test_output_type_from_name(void) {
+    TEST_ASSERT_EQUAL_INT(DSP_MULTIBAND_COMP, output_dsp_type_from_name("MULTIBAND_COMP"));
+    TEST_ASSERT_EQUAL_INT(DSP_FIR, output_dsp_type_from_name("FIR"));
+    TEST_ASSERT_EQUAL_INT(DSP_BIQUAD_LOW_SHELF, output_dsp_type_from_name("LOW_SHELF"));
+    TEST_ASSERT_EQUAL_INT(DSP_BIQUAD_PEQ, output_dsp_type_from_name("NOT_A_TYPE"));
+}
+
+void test_output_fir_taps_need_a_stage(void) {
+    make_filters();
+    TEST_ASSERT_FALSE(output_dsp_set_fir_taps(5, _fir, 48));
+    output_dsp_add_stage(5, DSP_FIR);
+    TEST_ASSERT_FALSE(output_dsp_set_fir_taps(5, _fir, DSP_MAX_FIR_TAPS + 1));
+    TEST_ASSERT_TRUE(output_dsp_set_fir_taps(5, _fir, 48));
+    TEST_ASSERT_EQUAL_UINT16(48, output_dsp_get_inactive_config()->channels[5].stages[0].fir.numTaps);
+}
+
+// ===== Kernels =====
+
+void test_kernel_gain_ramp_converges(void) {
+    float buf[256], cur = 1.0f;
+    for (int i = 0; i < 256; i++) buf[i] = 1.0f;
+    float k = dsp_time_coeff(5.0f, 48000.0f);
+    for (int b = 0; b < 20; b++) {
+        for (int i = 0; i < 256; i++) buf[i] = 1.0f;
+        dsp_k_gain_ramp(0.25f, cur, k, buf, 256);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.25f, cur);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.25f, buf[255]);
+}
+
+void test_kernel_limiter_holds_threshold(void) {
+    DspLimiterParams p;
+    dsp_init_limiter_params(p);
+    p.thresholdDb = -6.0f;
+    DspDynCoeffs k;
+    dsp_k_limiter_coeffs(k, p, 48000);
+    static float scratch[256], buf[256];
+    float env = 0.0f, gr = 0.0f;
+    for (int b = 0; b < 40; b++) {
+        for (int i = 0; i < 256; i++) buf[i] = (i & 1) ? 0.9f : -0.9f;
+        dsp_k_limiter(k, env, gr, scratch, buf, 256);
+    }
+    TEST_ASSERT_TRUE(gr < -3.0f);
+    TEST_ASSERT_TRUE(fabsf(buf[255]) < 0.9f * 0.7f);
+}
+
+void test_kernel_integer_delay(void) {
+    DspDelayParams p;
+    dsp_init_delay_params(p);
+    p.delaySamples = 10;
+    DspDelayTaps t;
+    dsp_k_delay_taps(p, t, OUTPUT_DSP_MAX_DELAY_SAMPLES);
+    TEST_ASSERT_TRUE(dsp_k_delay_active(t));
+    static float line[OUTPUT_DSP_DELAY_RING_SIZE];
+    memset(line, 0, sizeof(line));
+    float buf[64] = {};
+    buf[0] = 1.0f;
+    uint16_t wp = 0;
+    float ap = 0.0f;
+    dsp_k_delay(t, wp, ap, line, OUTPUT_DSP_DELAY_RING_MASK, buf, 64);
+    for (int i = 0; i < 64; i++) TEST_ASSERT_EQUAL_FLOAT(i == 10 ? 1.0f : 0.0f, buf[i]);
+}
+
+// ===== Benchmark =====
+
+static volatile float _sink;
+
+void test_benchmark_same_chain_both_engines(void) {
+    const DspStageType chain[] = {
+        DSP_BIQUAD_HPF, DSP_BIQUAD_PEQ, DSP_TONE_CTRL, DSP_GAIN, DSP_COMPRESSOR,
+        DSP_FIR, DSP_MULTIBAND_COMP, DSP_LIMITER
+    };
+    build_chain(chain, sizeof(chain) / sizeof(chain[0]));
+    static float a[BLOCK], r[BLOCK], b[BLOCK];
+    make_signal(a, BLOCK, 1);
+    memcpy(b, a, sizeof(a));
+    const int iters = 2000;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < iters; k++) dsp_process_buffer_float(a, r, BLOCK, 0);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int k = 0; k < iters; k++) output_dsp_process(0, b, BLOCK);
+    auto t2 = std::chrono::steady_clock::now();
+    _sink = a[3] + b[3];
+
+    double inNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / iters;
+    double outNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / iters;
+    printf("[bench] shared kernels ns/block (%d frames, %d stages, mono): input=%.0f output=%.0f\n",
+           BLOCK, (int)(sizeof(chain) / sizeof(chain[0])), inNs, outNs);
+    TEST_ASSERT_TRUE(outNs > 0.0 && inNs > 0.0);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_filters_and_dynamics_bit_identical);
+    RUN_TEST(test_delay_fir_conv_multiband_bit_identical);
+    RUN_TEST(test_republished_chain_stays_identical);
+    RUN_TEST(test_output_accepts_full_mono_stage_set);
+    RUN_TEST(test_output_limits_stateful_stages_per_channel);
+    RUN_TEST(test_output_type_from_name);
+    RUN_TEST(test_output_fir_taps_need_a_stage);
+    RUN_TEST(test_kernel_gain_ramp_converges);
+    RUN_TEST(test_kernel_limiter_holds_threshold);
+    RUN_TEST(test_kernel_integer_delay);
+    RUN_TEST(test_benchmark_same_chain_both_engines);
+    return UNITY_END();
+}
@@ -0,0 +1,358 @@
+// test_dsp_multirate.cpp
+// Multirate sections: half-band round-trip latency, DC gain, passband
+// flatness and alias rejection for factors 2/4/8, section-rate coefficients,
+// interpolator placement, bypass of odd-sized blocks, latency reporting and a
+// native benchmark of a 4096-tap FIR at the full rate vs inside a section.
+
+// 4096-tap stages regardless of the native build default
+#undef DSP_MAX_FIR_TAPS
+#define DSP_MAX_FIR_TAPS 4096
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "../../lib/esp_dsp_lite/src/dsps_biquad_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_init_f32.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fird_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_corr_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_conv_f32_ansi.c"
+#include "../../src/dsp_biquad_gen.c"
+
+#include "../../src/dsp_pipeline.h"
+#include "../../src/dsp_coefficients.h"
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/dsp_coefficients.cpp"
+#include "../../src/dsp_pipeline.cpp"
+#include "../../src/dsp_crossover.cpp"
+#include "../../src/dsp_convolution.cpp"
+#include "../../src/thd_measurement.cpp"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define FS 48000.0
+#define BLOCK 256
+#define N_SIG (BLOCK * 32)
+
+static DspMultirateState _mr;
+static float _x[N_SIG], _y[N_SIG];
+
+void setUp(void) {
+    dsp_init();
+    dsp_mr_init(_mr);
+}
+
+void tearDown(void) {}
+
+// Decimate + interpolate _x into _y in BLOCK-sized pieces
+static void round_trip(int factor) {
+    TEST_ASSERT_TRUE(dsp_mr_configure(_mr, factor));
+    memcpy(_y, _x, sizeof(_y));
+    for (int t = 0; t < N_SIG; t += BLOCK) {
+        int low = dsp_mr_decimate(_mr, _y + t, BLOCK);
+        TEST_ASSERT_EQUAL_INT(BLOCK / factor, low);
+        dsp_mr_interpolate(_mr, _y + t, low);
+    }
+}
+
+static void make_sine(double hz, float amp) {
+    for (int i = 0; i < N_SIG; i++) _x[i] = amp * (float)sin(2.0 * M_PI * hz * i / FS);
+}
+
+static double rms(const float *x, int n) {
+    double s = 0.0;
+    for (int i = 0; i < n; i++) s += (double)x[i] * x[i];
+    return sqrt(s / n);
+}
+
+// ===== Kernel =====
+
+void test_factor_validation(void) {
+    TEST_ASSERT_EQUAL_INT(1, dsp_mr_stages_for(2));
+    TEST_ASSERT_EQUAL_INT(3, dsp_mr_stages_for(8));
+    TEST_ASSERT_EQUAL_INT(0, dsp_mr_stages_for(3));
+    TEST_ASSERT_FALSE(dsp_mr_configure(_mr, 6));
+    TEST_ASSERT_EQUAL_UINT8(2, dsp_clamp_decimator_factor(3));
+    TEST_ASSERT_EQUAL_UINT8(4, dsp_clamp_decimator_factor(7));
+    TEST_ASSERT_EQUAL_UINT8(8, dsp_clamp_decimator_factor(64));
+    TEST_ASSERT_EQUAL_UINT8(2, dsp_clamp_decimator_factor(0));
+}
+
+void test_impulse_latency_and_dc_gain(void) {
+    const int factors[] = {2, 4, 8};
+    for (int f : factors) {
+        dsp_mr_init(_mr);
+        memset(_x, 0, sizeof(_x));
+        _x[0] = 1.0f;
+        round_trip(f);
+        int peak = 0;
+        for (int i = 1; i < N_SIG; i++) if (fabsf(_y[i]) > fabsf(_y[peak])) peak = i;
+        char msg[32];
+        snprintf(msg, sizeof(msg), "factor=%d", f);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(dsp_mr_latency_samples(f), peak, msg);
+
+        dsp_mr_init(_mr);
+        for (int i = 0; i < N_SIG; i++) _x[i] = 0.25f;
+        round_trip(f);
+        for (int i = N_SIG - BLOCK; i < N_SIG; i++) TEST_ASSERT_FLOAT_WITHIN_MESSAGE(1e-4f, 0.25f, _y[i], msg);
+    }
+}
+
+void test_passband_is_flat(void) {
+    // Up to 0.35 of the section rate's bandwidth (fs / factor / 2 * 0.7)
+    const int factors[] = {2, 4, 8};
+    for (int f : factors) {
+        const double edge = 0.35 * FS / f;
+        for (double hz = edge / 8.0; hz <= edge; hz += edge / 8.0) {
+            dsp_mr_init(_mr);
+            make_sine(hz, 0.5f);
+            round_trip(f);
+            int lat = dsp_mr_latency_samples(f);
+            const int n = N_SIG / 2;
+            double db = 20.0 * log10(rms(_y + N_SIG - n, n) / rms(_x + N_SIG - n - lat, n));
+            char msg[48];
+            snprintf(msg, sizeof(msg), "factor=%d hz=%.0f", f, hz);
+            TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.02f, 0.0f, (float)db, msg);
+        }
+    }
+}
+
+void test_alias_rejection(void) {
+    // Tones above the section band must not fold back into it
+    struct { int f; double hz; } cases[] = {
+        {2, 18000.0}, {2, 15500.0}, {4, 8000.0}, {4, 20000.0}, {8, 4500.0}, {8, 13000.0},
+    };
+    for (auto &c : cases) {
+        dsp_mr_init(_mr);
+        TEST_ASSERT_TRUE(dsp_mr_configure(_mr, c.f));
+        make_sine(c.hz, 0.5f);
+        memcpy(_y, _x, sizeof(_y));
+        int lowTotal = 0;
+        for (int t = 0; t < N_SIG; t += BLOCK) lowTotal += dsp_mr_decimate(_mr, _y + t, BLOCK) ? 0 : 1;
+        TEST_ASSERT_EQUAL_INT(0, lowTotal);
+        // Low-rate output of the last half of the signal, packed block by block
+        double s = 0.0;
+        int n = 0;
+        for (int t = N_SIG / 2; t < N_SIG; t += BLOCK)
+            for (int i = 0; i < BLOCK / c.f; i++) { s += (double)_y[t + i] * _y[t + i]; n++; }
+        double db = 20.0 * log10(sqrt(s / n) / rms(_x, N_SIG) + 1e-12);
+        char msg[48];
+        snprintf(msg, sizeof(msg), "factor=%d hz=%.0f db=%.1f", c.f, c.hz, db);
+        TEST_ASSERT_TRUE_MESSAGE(db < -60.0, msg);
+    }
+}
+
+void test_block_not_multiple_of_factor_is_rejected(void) {
+    TEST_ASSERT_TRUE(dsp_mr_configure(_mr, 8));
+    float buf[100];
+    for (int i = 0; i < 100; i++) buf[i] = 0.1f * i;
+    TEST_ASSERT_EQUAL_INT(0, dsp_mr_decimate(_mr, buf, 100));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 9.9f, buf[99]);
+}
+
+// ===== Pipeline =====
+
+static int add_decimator(int factor) {
+    int idx = dsp_add_stage(0, DSP_DECIMATOR);
+    TEST_ASSERT_TRUE(idx >= 0);
+    DspStage &s = dsp_get_inactive_config()->channels[0].stages[idx];
+    s.decimator.factor = (uint8_t)factor;
+    return idx;
+}
+
+static int add_lpf(float hz) {
+    int idx = dsp_add_stage(0, DSP_BIQUAD_LPF);
+    TEST_ASSERT_TRUE(idx >= 0);
+    DspStage &s = dsp_get_inactive_config()->channels[0].stages[idx];
+    s.biquad.frequency = hz;
+    dsp_compute_biquad_coeffs(s.biquad, s.type, dsp_get_inactive_config()->sampleRate);
+    return idx;
+}
+
+void test_stage_coeffs_follow_section_rate(void) {
+    int dec = add_decimator(4);
+    int lpf = add_lpf(1000.0f);
+    dsp_get_inactive_config()->channels[0].bypass = false;
+    TEST_ASSERT_TRUE(dsp_swap_config());
+
+    DspState *act = dsp_get_active_config();
+    DspStage &s = act->channels[0].stages[lpf];
+    TEST_ASSERT_EQUAL_UINT8(4, s.rateDiv);
+    DspBiquadParams ref = s.biquad;
+    dsp_compute_biquad_coeffs(ref, DSP_BIQUAD_LPF, act->sampleRate / 4);
+    for (int k = 0; k < 5; k++) TEST_ASSERT_FLOAT_WITHIN(1e-6f, ref.coeffs[k], s.biquad.coeffs[k]);
+
+    // Removing the decimator restores the pipeline-rate coefficients (the
+    // running stage morphs towards them)
+    dsp_copy_active_to_inactive();
+    TEST_ASSERT_TRUE(dsp_remove_stage(0, dec));
+    TEST_ASSERT_TRUE(dsp_swap_config());
+    act = dsp_get_active_config();
+    DspStage &r = act->channels[0].stages[lpf - 1];
+    TEST_ASSERT_EQUAL_UINT8(1, r.rateDiv);
+    ref = r.biquad;
+    dsp_compute_biquad_coeffs(ref, DSP_BIQUAD_LPF, act->sampleRate);
+    const float *target = r.biquad.morphRemaining ? r.biquad.targetCoeffs : r.biquad.coeffs;
+    for (int k = 0; k < 5; k++) TEST_ASSERT_FLOAT_WITHIN(1e-6f, ref.coeffs[k], target[k]);
+}
+
+void test_interpolator_closes_section(void) {
+    add_decimator(2);
+    int inside = add_lpf(2000.0f);
+    TEST_ASSERT_TRUE(dsp_add_stage(0, DSP_INTERPOLATOR) >= 0);
+    int after = add_lpf(2000.0f);
+    TEST_ASSERT_TRUE(dsp_swap_config());
+    DspChannelConfig &ch = dsp_get_active_config()->channels[0];
+    TEST_ASSERT_EQUAL_UINT8(2, ch.stages[inside].rateDiv);
+    TEST_ASSERT_EQUAL_UINT8(1, ch.stages[after].rateDiv);
+    TEST_ASSERT_FALSE(ch.stages[inside].biquad.coeffs[0] == ch.stages[after].biquad.coeffs[0]);
+}
+
+void test_lowpass_inside_section_matches_full_rate(void) {
+    // A 1 kHz tone through a 4 kHz low-pass at fs/4 comes out like the
+    // full-rate filter, delayed by the section latency
+    add_decimator(4);
+    add_lpf(4000.0f);
+    dsp_get_inactive_config()->channels[0].bypass = false;
+    TEST_ASSERT_TRUE(dsp_swap_config());
+
+    make_sine(1000.0, 0.2f);
+    float l[BLOCK], r[BLOCK];
+    for (int t = 0; t < N_SIG; t += BLOCK) {
+        memcpy(l, _x + t, sizeof(l));
+        memset(r, 0, sizeof(r));
+        dsp_process_buffer_float(l, r, BLOCK, 0);
+        memcpy(_y + t, l, sizeof(l));
+    }
+    DspBiquadParams ref;
+    memset(&ref, 0, sizeof(ref));
+    ref.frequency = 4000.0f;
+    ref.Q = DSP_DEFAULT_Q;
+    dsp_compute_biquad_coeffs(ref, DSP_BIQUAD_LPF, 48000);
+    double w = 2.0 * M_PI * 1000.0 / FS;
+    double nr = ref.coeffs[0] + ref.coeffs[1] * cos(w) + ref.coeffs[2] * cos(2 * w);
+    double ni = -(ref.coeffs[1] * sin(w) + ref.coeffs[2] * sin(2 * w));
+    double dr = 1.0 + ref.coeffs[3] * cos(w) + ref.coeffs[4] * cos(2 * w);
+    double di = -(ref.coeffs[3] * sin(w) + ref.coeffs[4] * sin(2 * w));
+    double mag = sqrt((nr * nr + ni * ni) / (dr * dr + di * di));
+    const int n = N_SIG / 2;
+    double got = rms(_y + N_SIG - n, n) / rms(_x, N_SIG);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)mag, (float)got);
+}
+
+void test_odd_block_bypasses_section(void) {
+    add_decimator(8);
+    int idx = dsp_add_stage(0, DSP_GAIN);
+    TEST_ASSERT_TRUE(idx >= 0);
+    DspStage &g = dsp_get_inactive_config()->channels[0].stages[idx];
+    g.gain.gainDb = -6.0f;
+    dsp_compute_gain_linear(g.gain);
+    dsp_get_inactive_config()->channels[0].bypass = false;
+    TEST_ASSERT_TRUE(dsp_swap_config());
+
+    float l[100], r[100];
+    for (int i = 0; i < 100; i++) l[i] = 0.3f;
+    memset(r, 0, sizeof(r));
+    dsp_process_buffer_float(l, r, 100, 0);
+    for (int i = 0; i < 100; i++) TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.3f, l[i]);
+}
+
+void test_latency_reporting(void) {
+    add_decimator(2);
+    int tp = dsp_add_stage(0, DSP_TRUE_PEAK_LIMITER);
+    TEST_ASSERT_TRUE(tp >= 0);
+    float la = dsp_get_inactive_config()->channels[0].stages[tp].truePeak.lookaheadMs;
+    dsp_get_inactive_config()->channels[0].bypass = false;
+    TEST_ASSERT_TRUE(dsp_swap_config());
+
+    int l = dsp_tp_lookahead_samples(la, 48000 / 2);
+    int expect = dsp_mr_latency_samples(2) + (l - 1 + DSP_TP_OS_DELAY) * 2;
+    TEST_ASSERT_EQUAL_INT(expect, dsp_get_channel_latency_samples(0));
+    TEST_ASSERT_EQUAL_UINT16(expect, dsp_get_metrics().latencySamples[0]);
+    TEST_ASSERT_EQUAL_INT(0, dsp_get_channel_latency_samples(1));
+    TEST_ASSERT_EQUAL_INT(0, dsp_get_channel_latency_samples(-1));
+}
+
+void test_slot_pool_exhaustion_and_reuse(void) {
+    int slots[DSP_MAX_MULTIRATE_SLOTS];
+    for (int i = 0; i < DSP_MAX_MULTIRATE_SLOTS; i++) {
+        slots[i] = dsp_mr_alloc_slot();
+        TEST_ASSERT_TRUE(slots[i] >= 0);
+    }
+    TEST_ASSERT_EQUAL_INT(-1, dsp_mr_alloc_slot());
+    dsp_mr_free_slot(slots[1]);
+    TEST_ASSERT_EQUAL_INT(slots[1], dsp_mr_alloc_slot());
+    for (int i = 0; i < DSP_MAX_MULTIRATE_SLOTS; i++) dsp_mr_free_slot(slots[i]);
+}
+
+// ===== Benchmark =====
+
+static volatile float _sink;
+
+static double bench_chain_ns_per_sample(void) {
+    const int iters = 60;
+    static float l[BLOCK], r[BLOCK];
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < iters; k++) {
+        for (int i = 0; i < BLOCK; i++) l[i] = (float)((k * BLOCK + i) % 17) * 0.01f;
+        memset(r, 0, sizeof(r));
+        dsp_process_buffer_float(l, r, BLOCK, 0);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    _sink = l[7];
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    return ns / ((double)BLOCK * iters);
+}
+
+static double bench_sub_fir(int factor) {
+    dsp_init();
+    if (factor > 1) add_decimator(factor);
+    int idx = dsp_add_stage(0, DSP_FIR);
+    TEST_ASSERT_TRUE(idx >= 0);
+    DspState *cfg = dsp_get_inactive_config();
+    DspStage &s = cfg->channels[0].stages[idx];
+    for (int st = 0; st < 2; st++) {
+        float *t = dsp_fir_get_taps(st, s.fir.firSlot);
+        for (int i = 0; i < DSP_MAX_FIR_TAPS; i++) t[i] = (i & 1) ? -1e-4f : 1e-4f;
+    }
+    s.fir.numTaps = DSP_MAX_FIR_TAPS;
+    dsp_fir_commit_taps(s.fir.firSlot, DSP_MAX_FIR_TAPS);
+    cfg->channels[0].bypass = false;
+    TEST_ASSERT_TRUE(dsp_swap_config());
+    bench_chain_ns_per_sample();   // Warm up (FDL fill)
+    return bench_chain_ns_per_sample();
+}
+
+void test_benchmark_sub_fir_in_section(void) {
+    double full = bench_sub_fir(1);
+    double by4 = bench_sub_fir(4);
+    double by8 = bench_sub_fir(8);
+    printf("[bench] %d-tap FIR ns/sample at fs: full=%.1f /4 section=%.1f /8 section=%.1f\n",
+           DSP_MAX_FIR_TAPS, full, by4, by8);
+    TEST_ASSERT_TRUE(by4 < full);
+    TEST_ASSERT_TRUE(by8 < full);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_factor_validation);
+    RUN_TEST(test_impulse_latency_and_dc_gain);
+    RUN_TEST(test_passband_is_flat);
+    RUN_TEST(test_alias_rejection);
+    RUN_TEST(test_block_not_multiple_of_factor_is_rejected);
+    RUN_TEST(test_stage_coeffs_follow_section_rate);
+    RUN_TEST(test_interpolator_closes_section);
+    RUN_TEST(test_lowpass_inside_section_matches_full_rate);
+    RUN_TEST(test_odd_block_bypasses_section);
+    RUN_TEST(test_latency_reporting);
+    RUN_TEST(test_slot_pool_exhaustion_and_reuse);
+    RUN_TEST(test_benchmark_sub_fir_in_section);
+    return UNITY_END();
+}
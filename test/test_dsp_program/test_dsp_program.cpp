@@ -0,0 +1,280 @@
+// test_dsp_program.cpp
+// Channel programs: no-op stages compile away, settled gains and polarity
+// fold into one scale, biquad runs merge across dropped stages, stateful
+// stages split runs, swaps rebuild the program, pre-derived limiter
+// coefficients, and a native benchmark of a chain of no-op stages vs an
+// empty chain.
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "../../lib/esp_dsp_lite/src/dsps_biquad_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_init_f32.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fird_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_corr_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_conv_f32_ansi.c"
+#include "../../src/dsp_biquad_gen.c"
+
+#include "../../src/dsp_pipeline.h"
+#include "../../src/dsp_coefficients.h"
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/dsp_coefficients.cpp"
+#include "../../src/dsp_pipeline.cpp"
+#include "../../src/dsp_crossover.cpp"
+#include "../../src/dsp_convolution.cpp"
+#include "../../src/thd_measurement.cpp"
+
+#define TOL 1e-5f
+
+void setUp(void) {
+    dsp_init();
+}
+
+void tearDown(void) {}
+
+static void make_signal(float *x, int n, int seed) {
+    uint32_t s = 0x1234567u * (uint32_t)(seed + 1);
+    for (int i = 0; i < n; i++) {
+        s = s * 1664525u + 1013904223u;
+        x[i] = 0.3f * ((float)(s >> 8) / 8388608.0f - 1.0f);
+    }
+}
+
+static float max_diff(const float *a, const float *b, int n) {
+    float m = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float d = fabsf(a[i] - b[i]);
+        if (d > m) m = d;
+    }
+    return m;
+}
+
+// Add a chain stage on the inactive config and return it
+static DspStage &add_stage(int ch, DspStageType type) {
+    int idx = dsp_add_chain_stage(ch, type);
+    TEST_ASSERT_TRUE(idx >= 0);
+    return dsp_get_inactive_config()->channels[ch].stages[idx];
+}
+
+static void set_gain(DspStage &s, float db) {
+    s.gain.gainDb = db;
+    dsp_compute_gain_linear(s.gain);
+}
+
+// ===== Compilation =====
+
+void test_default_config_compiles_to_empty_program(void) {
+    TEST_ASSERT_EQUAL_INT(0, dsp_get_program_length(0));
+    TEST_ASSERT_EQUAL_INT(0, dsp_get_program_length(1));
+}
+
+void test_noop_stages_are_dropped(void) {
+    add_stage(0, DSP_GAIN);                        // 0 dB
+    add_stage(0, DSP_POLARITY).polarity.inverted = false;
+    add_stage(0, DSP_MUTE).mute.muted = false;
+    add_stage(0, DSP_DELAY);                       // 0 samples
+    DspStage &lim = add_stage(0, DSP_LIMITER);
+    lim.enabled = false;
+    dsp_swap_config();
+    TEST_ASSERT_EQUAL_INT(0, dsp_get_program_length(0));
+
+    float x[64], y[64], r[64] = {};
+    make_signal(x, 64, 1);
+    memcpy(y, x, sizeof(x));
+    dsp_process_buffer_float(y, r, 64, 0);
+    TEST_ASSERT_TRUE(max_diff(x, y, 64) < TOL);
+}
+
+void test_gains_and_polarity_fold_into_one_scale(void) {
+    set_gain(add_stage(0, DSP_GAIN), -6.0f);
+    add_stage(0, DSP_POLARITY).polarity.inverted = true;
+    set_gain(add_stage(0, DSP_GAIN), 2.5f);
+    dsp_swap_config();
+    TEST_ASSERT_EQUAL_INT(1, dsp_get_program_length(0));
+
+    const float k = -powf(10.0f, -6.0f / 20.0f) * powf(10.0f, 2.5f / 20.0f);
+    float x[64], y[64], r[64] = {};
+    make_signal(x, 64, 2);
+    memcpy(y, x, sizeof(x));
+    dsp_process_buffer_float(y, r, 64, 0);
+    for (int i = 0; i < 64; i++) TEST_ASSERT_FLOAT_WITHIN(TOL, x[i] * k, y[i]);
+}
+
+void test_ramping_gain_stays_an_op(void) {
+    DspStage &g = add_stage(0, DSP_GAIN);
+    set_gain(g, -12.0f);
+    g.gain.currentLinear = 1.0f;                   // Ramp still in progress
+    dsp_swap_config();
+    TEST_ASSERT_EQUAL_INT(1, dsp_get_program_length(0));
+
+    float x[64], r[64] = {};
+    for (int i = 0; i < 64; i++) x[i] = 0.5f;
+    dsp_process_buffer_float(x, r, 64, 0);
+    TEST_ASSERT_TRUE(x[0] > x[63]);                // Ramping down, not a step
+}
+
+void test_biquads_merge_across_dropped_stages(void) {
+    DspState *in = dsp_get_inactive_config();
+    for (int b = 0; b < 2; b++) {
+        DspStage &s = in->channels[0].stages[b];
+        s.enabled = true;
+        s.biquad.gain = 4.0f;
+        dsp_compute_biquad_coeffs(s.biquad, s.type, in->sampleRate);
+    }
+    add_stage(0, DSP_POLARITY).polarity.inverted = false;   // Dropped
+    add_stage(0, DSP_TONE_CTRL);                             // Three sections
+    add_stage(0, DSP_MUTE).mute.muted = false;               // Dropped
+    add_stage(0, DSP_BIQUAD_LPF);
+    dsp_swap_config();
+    TEST_ASSERT_EQUAL_INT(1, dsp_get_program_length(0));
+
+    // Matches the stages applied one at a time (morphs started by the swap
+    // are snapped so the reference sees fixed coefficients)
+    DspChannelConfig &ch = dsp_get_active_config()->channels[0];
+    for (int i = 0; i < ch.stageCount; i++) {
+        DspStage &s = ch.stages[i];
+        if (!dsp_is_biquad_type(s.type) || s.biquad.morphRemaining == 0) continue;
+        memcpy(s.biquad.coeffs, s.biquad.targetCoeffs, sizeof(s.biquad.coeffs));
+        s.biquad.morphRemaining = 0;
+    }
+    DspChannelConfig ref = ch;
+    float x[128], e[128], r[128] = {};
+    make_signal(x, 128, 3);
+    memcpy(e, x, sizeof(x));
+    for (int i = 0; i < ref.stageCount; i++) {
+        DspStage &s = ref.stages[i];
+        if (!s.enabled) continue;
+        if (dsp_is_biquad_type(s.type)) {
+            dsps_biquad_f32(e, e, 128, s.biquad.coeffs, s.biquad.delay);
+        } else if (s.type == DSP_TONE_CTRL) {
+            dsps_biquad_f32(e, e, 128, s.toneCtrl.bassCoeffs, s.toneCtrl.bassDelay);
+            dsps_biquad_f32(e, e, 128, s.toneCtrl.midCoeffs, s.toneCtrl.midDelay);
+            dsps_biquad_f32(e, e, 128, s.toneCtrl.trebleCoeffs, s.toneCtrl.trebleDelay);
+        }
+    }
+    dsp_process_buffer_float(x, r, 128, 0);
+    TEST_ASSERT_TRUE(max_diff(e, x, 128) < TOL);
+}
+
+void test_stateful_stage_splits_run(void) {
+    add_stage(0, DSP_BIQUAD_LPF);
+    add_stage(0, DSP_LIMITER);
+    add_stage(0, DSP_BIQUAD_HPF);
+    dsp_swap_config();
+    TEST_ASSERT_EQUAL_INT(3, dsp_get_program_length(0));
+    TEST_ASSERT_EQUAL_INT(0, dsp_get_program_length(1));
+}
+
+void test_matching_pair_shares_ops(void) {
+    for (int ch = 0; ch < 2; ch++) {
+        add_stage(ch, DSP_BIQUAD_LPF);
+        add_stage(ch, DSP_COMPRESSOR);
+    }
+    dsp_swap_config();
+    // Stereo biquad run + one compressor op per side
+    TEST_ASSERT_EQUAL_INT(2, dsp_get_program_length(0));
+    TEST_ASSERT_EQUAL_INT(2, dsp_get_program_length(1));
+}
+
+void test_swap_rebuilds_program(void) {
+    int idx = dsp_add_chain_stage(0, DSP_LIMITER);
+    dsp_swap_config();
+    TEST_ASSERT_EQUAL_INT(1, dsp_get_program_length(0));
+
+    dsp_copy_active_to_inactive();
+    dsp_get_inactive_config()->channels[0].stages[idx].enabled = false;
+    dsp_swap_config();
+    TEST_ASSERT_EQUAL_INT(0, dsp_get_program_length(0));
+}
+
+void test_limiter_uses_derived_coefficients(void) {
+    DspStage &s = add_stage(0, DSP_LIMITER);
+    s.limiter.thresholdDb = -12.0f;
+    s.limiter.attackMs = 0.1f;
+    s.limiter.ratio = 20.0f;
+    dsp_swap_config();
+
+    float x[256], r[256] = {};
+    for (int b = 0; b < 8; b++) {
+        for (int i = 0; i < 256; i++) x[i] = (i & 1) ? 0.9f : -0.9f;
+        dsp_process_buffer_float(x, r, 256, 0);
+    }
+    // Settled well below the input and close to the threshold (0.25)
+    TEST_ASSERT_TRUE(fabsf(x[255]) < 0.4f);
+    TEST_ASSERT_TRUE(dsp_get_metrics().limiterGrDb[0] < -6.0f);
+}
+
+void test_in_place_edit_needs_republish(void) {
+    add_stage(0, DSP_POLARITY).polarity.inverted = false;
+    dsp_swap_config();
+    DspState *cfg = dsp_get_active_config();
+    int idx = cfg->channels[0].stageCount - 1;
+    cfg->channels[0].stages[idx].polarity.inverted = true;
+    TEST_ASSERT_EQUAL_INT(0, dsp_get_program_length(0));
+
+    dsp_copy_active_to_inactive();
+    dsp_swap_config();
+    TEST_ASSERT_EQUAL_INT(1, dsp_get_program_length(0));
+}
+
+// ===== Benchmark =====
+
+static volatile float _sink;
+
+static double bench_block_ns(int iters) {
+    static float l[256], r[256];
+    make_signal(l, 256, 7);
+    make_signal(r, 256, 8);
+    for (int k = 0; k < 20; k++) dsp_process_buffer_float(l, r, 256, 0);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < iters; k++) dsp_process_buffer_float(l, r, 256, 0);
+    auto t1 = std::chrono::steady_clock::now();
+    _sink = l[3] + r[3];
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / iters;
+}
+
+void test_benchmark_noop_chain_vs_empty(void) {
+    const int iters = 5000;
+    double empty = bench_block_ns(iters);
+
+    // Fill every free slot of both channels with stages that compile away
+    const DspStageType kinds[] = {DSP_POLARITY, DSP_GAIN, DSP_MUTE};
+    for (int ch = 0; ch < 2; ch++) {
+        for (int i = 0; dsp_get_inactive_config()->channels[ch].stageCount < DSP_MAX_STAGES; i++) {
+            DspStage &s = add_stage(ch, kinds[i % 3]);
+            s.polarity.inverted = false;
+            s.mute.muted = false;
+            if (s.type == DSP_GAIN) dsp_init_gain_params(s.gain);
+        }
+    }
+    dsp_swap_config();
+    TEST_ASSERT_EQUAL_INT(DSP_MAX_STAGES, dsp_get_active_config()->channels[0].stageCount);
+    TEST_ASSERT_EQUAL_INT(0, dsp_get_program_length(0));
+    double noop = bench_block_ns(iters);
+
+    printf("[bench] pipeline ns/block (256 frames, stereo): empty=%.0f %d-stage no-op chain=%.0f\n",
+           empty, DSP_MAX_STAGES, noop);
+    TEST_ASSERT_TRUE(noop <= empty * 1.5 + 200.0);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_default_config_compiles_to_empty_program);
+    RUN_TEST(test_noop_stages_are_dropped);
+    RUN_TEST(test_gains_and_polarity_fold_into_one_scale);
+    RUN_TEST(test_ramping_gain_stays_an_op);
+    RUN_TEST(test_biquads_merge_across_dropped_stages);
+    RUN_TEST(test_stateful_stage_splits_run);
+    RUN_TEST(test_matching_pair_shares_ops);
+    RUN_TEST(test_swap_rebuilds_program);
+    RUN_TEST(test_limiter_uses_derived_coefficients);
+    RUN_TEST(test_in_place_edit_needs_republish);
+    RUN_TEST(test_benchmark_noop_chain_vs_empty);
+    return UNITY_END();
+}
@@ -1,5 +1,9 @@
 #include <unity.h>
 #include <cstring>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <time.h>
 
 // Include DSP sources directly (test_build_src = no)
 #include "../../lib/esp_dsp_lite/src/dsps_biquad_f32_ansi.c"
@@ -21,6 +25,15 @@
 #include "../../src/dsp_convolution.cpp"
 #include "../../src/dsp_pipeline.cpp"
 
+// Writer time on its own thread clock. The host may have a single core, where
+// the time the scheduler hands to the audio thread is not time the writer
+// chose to wait.
+static uint32_t writer_cpu_us() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000ull + ts.tv_nsec / 1000);
+}
+
 void setUp(void) {
     // Reset DSP before each test
     dsp_init();
@@ -50,9 +63,9 @@ void test_swap_returns_true_on_success() {
 
 // Test 2: Swap returns false on timeout (simulated busy state)
 void test_swap_returns_false_on_timeout() {
-    // Hold _processingActive true so the swap wait loop spins to timeout.
-    // In native builds, vTaskDelay is compiled out, so the 100-iteration loop
-    // completes instantly and hits the timeout path.
+    // Hold _processingActive true (audio task stuck inside a block) so the
+    // publish is never acknowledged; the writer gives up after one block period
+    // and withdraws it.
     _processingActive = true;
 
     // Set mock time so lastSwapFailure gets a non-zero timestamp
@@ -104,8 +117,8 @@ void test_delay_state_preserved() {
     inactive->channels[0].stages[stageIdx].delay.delaySamples = 100;
     int delaySlot = inactive->channels[0].stages[stageIdx].delay.delaySlot;
 
-    // Fill inactive delay line (state index 1) with test pattern
-    float *delayLine = dsp_delay_get_line(1, delaySlot);
+    // Fill the slot's ring (shared by both states) with a test pattern
+    float *delayLine = dsp_delay_get_line(delaySlot);
     if (delayLine) {
         for (int i = 0; i < 100; i++) {
             delayLine[i] = (float)i / 100.0f;
@@ -113,15 +126,13 @@ void test_delay_state_preserved() {
         inactive->channels[0].stages[stageIdx].delay.writePos = 50;
     }
 
-    // Swap config — inactive (state 1) becomes active; no copy for stageIdx since it only
-    // exists in new active (not old active), so the delay data written above is preserved
+    // Swap config — inactive (state 1) becomes active; the ring is not copied,
+    // so the delay data written above is what the new active config reads
     TEST_ASSERT_TRUE(dsp_swap_config());
 
-    // After swap, _activeIndex = 1. Active delay pool is _delayLine[1][slot].
-    // The written pattern is still there since no cross-copy occurred for this stage.
     DspState *active = dsp_get_active_config();
     int newDelaySlot = active->channels[0].stages[stageIdx].delay.delaySlot;
-    float *newDelayLine = dsp_delay_get_line(1, newDelaySlot); // state 1 = new active
+    float *newDelayLine = dsp_delay_get_line(newDelaySlot);
 
     if (newDelayLine && delayLine) {
         for (int i = 0; i < 100; i++) {
@@ -290,6 +301,241 @@ void test_swap_coeff_morphing_state() {
     }
 }
 
+// Test 13: Failed publish is withdrawn and leaves the active config untouched
+void test_withdrawn_publish_is_not_adopted() {
+    DspState *active = dsp_get_active_config();
+    _processingActive = true;
+    TEST_ASSERT_FALSE(dsp_swap_config());
+    _processingActive = false;
+    TEST_ASSERT_EQUAL_PTR(active, dsp_get_active_config());
+    TEST_ASSERT_EQUAL_UINT32(0, dsp_get_config_epoch());
+
+    // A later block must not pick up the withdrawn publish
+    float l[32] = {}, r[32] = {};
+    dsp_process_buffer_float(l, r, 32, 0);
+    TEST_ASSERT_EQUAL_PTR(active, dsp_get_active_config());
+}
+
+// Test 14: Epoch counts adopted publishes
+void test_epoch_counts_publishes() {
+    TEST_ASSERT_EQUAL_UINT32(0, dsp_get_config_epoch());
+    dsp_swap_config();
+    dsp_swap_config();
+    TEST_ASSERT_EQUAL_UINT32(2, dsp_get_config_epoch());
+}
+
+// Test 15: State follows the stage ID when a stage is inserted in front of it
+void test_state_follows_stage_id_across_insert() {
+    int idx = dsp_add_stage(0, DSP_LIMITER, -1);
+    TEST_ASSERT_TRUE(idx >= 0);
+    TEST_ASSERT_TRUE(dsp_swap_config());
+    DspState *active = dsp_get_active_config();
+    active->channels[0].stages[idx].limiter.envelope = 0.42f;
+
+    // Insert a gain stage directly in front of the limiter
+    dsp_copy_active_to_inactive();
+    int g = dsp_add_stage(0, DSP_GAIN, idx);
+    TEST_ASSERT_EQUAL_INT(idx, g);
+    TEST_ASSERT_TRUE(dsp_swap_config());
+
+    active = dsp_get_active_config();
+    TEST_ASSERT_EQUAL(DSP_LIMITER, active->channels[0].stages[idx + 1].type);
+    TEST_ASSERT_EQUAL_FLOAT(0.42f, active->channels[0].stages[idx + 1].limiter.envelope);
+}
+
+// Test 16: Removing a stage does not hand its history to the stage that slides into its slot
+void test_removed_stage_state_not_inherited() {
+    int a = dsp_add_stage(0, DSP_BIQUAD_PEQ, -1);
+    int b = dsp_add_stage(0, DSP_BIQUAD_PEQ, -1);
+    TEST_ASSERT_TRUE(a >= 0 && b == a + 1);
+    TEST_ASSERT_TRUE(dsp_swap_config());
+    DspState *active = dsp_get_active_config();
+    active->channels[0].stages[a].biquad.delay[0] = 0.9f;
+    active->channels[0].stages[b].biquad.delay[0] = 0.1f;
+
+    dsp_copy_active_to_inactive();
+    TEST_ASSERT_TRUE(dsp_remove_stage(0, a));
+    TEST_ASSERT_TRUE(dsp_swap_config());
+
+    active = dsp_get_active_config();
+    TEST_ASSERT_EQUAL_FLOAT(0.1f, active->channels[0].stages[a].biquad.delay[0]);
+}
+
+// Test 17: Audio task adopts a publish at the top of its next lane-0 block
+void test_audio_side_adoption() {
+    std::atomic<bool> stop(false);
+    std::atomic<uint32_t> blocks(0);
+    std::thread audio([&]() {
+        float l[64], r[64];
+        while (!stop.load()) {
+            for (int i = 0; i < 64; i++) { l[i] = 0.25f; r[i] = 0.25f; }
+            dsp_process_buffer_float(l, r, 64, 0);
+            blocks++;
+        }
+    });
+    while (blocks.load() < 4) std::this_thread::yield();
+
+    DspState *before = dsp_get_active_config();
+    dsp_get_inactive_config()->channels[0].bypass = true;
+    TEST_ASSERT_TRUE(dsp_swap_config());
+    stop = true;
+    audio.join();
+
+    TEST_ASSERT_TRUE(dsp_get_active_config() != before);
+    TEST_ASSERT_TRUE(dsp_get_active_config()->channels[0].bypass);
+    TEST_ASSERT_EQUAL_UINT32(0, appState.dsp.swapFailures);
+}
+
+// Sample-rate switch: coefficients are staged on the inactive side while the
+// active config keeps playing at the old rate, and go live with the swap
+void test_prepare_sample_rate_stages_coefficients() {
+    int stageIdx = dsp_add_stage(0, DSP_BIQUAD_PEQ, -1);
+    TEST_ASSERT_TRUE(stageIdx >= 0);
+    DspState *inactive = dsp_get_inactive_config();
+    inactive->channels[0].stages[stageIdx].biquad.frequency = 1000.0f;
+    inactive->channels[0].stages[stageIdx].biquad.gain = 6.0f;
+    dsp_compute_biquad_coeffs(inactive->channels[0].stages[stageIdx].biquad, DSP_BIQUAD_PEQ,
+                              inactive->sampleRate);
+    TEST_ASSERT_TRUE(dsp_swap_config());
+    const uint32_t oldRate = dsp_get_active_config()->sampleRate;
+    float oldB0 = dsp_get_active_config()->channels[0].stages[stageIdx].biquad.coeffs[0];
+
+    const uint32_t newRate = oldRate == 96000 ? 48000 : 96000;
+    dsp_prepare_sample_rate(newRate);
+
+    // Active side untouched until published
+    DspState *active = dsp_get_active_config();
+    TEST_ASSERT_EQUAL_UINT32(oldRate, active->sampleRate);
+    TEST_ASSERT_EQUAL_FLOAT(oldB0, active->channels[0].stages[stageIdx].biquad.coeffs[0]);
+
+    DspBiquadParams expect = active->channels[0].stages[stageIdx].biquad;
+    dsp_compute_biquad_coeffs(expect, DSP_BIQUAD_PEQ, newRate);
+    inactive = dsp_get_inactive_config();
+    TEST_ASSERT_EQUAL_UINT32(newRate, inactive->sampleRate);
+    TEST_ASSERT_FALSE(expect.coeffs[0] == oldB0);
+    for (int k = 0; k < 5; k++)
+        TEST_ASSERT_EQUAL_FLOAT(expect.coeffs[k], inactive->channels[0].stages[stageIdx].biquad.coeffs[k]);
+
+    TEST_ASSERT_TRUE(dsp_swap_config());
+    active = dsp_get_active_config();
+    TEST_ASSERT_EQUAL_UINT32(newRate, active->sampleRate);
+    // The swap morphs toward the staged coefficients
+    for (int k = 0; k < 5; k++)
+        TEST_ASSERT_EQUAL_FLOAT(expect.coeffs[k], active->channels[0].stages[stageIdx].biquad.targetCoeffs[k]);
+}
+
+// Test 18: Stress — one thread hammers publishes while another runs the audio
+// path. Gains only ever rise, so every block must come out with L == R (both
+// channels from one publish) and a level no lower than the block before.
+void test_stress_publish_while_processing() {
+    int gl = dsp_add_stage(0, DSP_GAIN, -1);
+    int gr = dsp_add_stage(1, DSP_GAIN, -1);
+    TEST_ASSERT_TRUE(gl >= 0 && gl == gr);
+    DspState *init = dsp_get_inactive_config();
+    for (int c = 0; c < 2; c++) {
+        init->channels[c].stages[gl].gain.gainDb = -60.0f;
+        dsp_compute_gain_linear(init->channels[c].stages[gl].gain);
+        init->channels[c].stages[gl].gain.currentLinear = init->channels[c].stages[gl].gain.gainLinear;
+    }
+    TEST_ASSERT_TRUE(dsp_swap_config());
+
+    const int kSwaps = 2000;
+    const float kIn = 0.01f;
+    const uint32_t kPeriodUs = (uint32_t)(128ull * 1000000u / dsp_get_active_config()->sampleRate);
+    std::atomic<bool> stop(false);
+    std::atomic<uint32_t> torn(0), regress(0), blocks(0);
+
+    std::thread audio([&]() {
+        float l[128], r[128];
+        float last = 0.0f;
+        while (!stop.load()) {
+            for (int i = 0; i < 128; i++) { l[i] = kIn; r[i] = kIn; }
+            dsp_process_buffer_float(l, r, 128, 0);
+            blocks++;
+            std::this_thread::sleep_for(std::chrono::microseconds(kPeriodUs));   // DMA pacing
+            if (memcmp(l, r, sizeof(l)) != 0) torn++;
+            if (l[0] == kIn && l[127] == kIn) continue;   // Block skipped during a writer-side flip
+            if (l[127] < last * 0.9999f) regress++;
+            last = l[127];
+        }
+    });
+    while (blocks.load() < 4) std::this_thread::yield();
+
+    uint32_t maxWaitUs = 0, maxWallUs = 0, refused = 0;
+    for (int k = 0; k < kSwaps; k++) {
+        if (!dsp_copy_active_to_inactive()) { refused++; continue; }   // Previous publish still in flight
+        DspState *in = dsp_get_inactive_config();
+        float db = -60.0f + 60.0f * (float)k / kSwaps;
+        for (int c = 0; c < 2; c++) {
+            in->channels[c].stages[gl].gain.gainDb = db;
+            dsp_compute_gain_linear(in->channels[c].stages[gl].gain);
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        uint32_t c0 = writer_cpu_us();
+        dsp_swap_config();
+        uint32_t us = writer_cpu_us() - c0;
+        uint32_t wall = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        if (us > maxWaitUs) maxWaitUs = us;
+        if (wall > maxWallUs) maxWallUs = wall;
+    }
+    stop = true;
+    audio.join();
+
+    printf("[stress] %d publishes, %u blocks, failures=%u, refused=%u, max writer wait=%u us (wall %u us), period=%u us\n",
+           kSwaps, (unsigned)blocks.load(), (unsigned)appState.dsp.swapFailures, (unsigned)refused,
+           (unsigned)maxWaitUs, (unsigned)maxWallUs, (unsigned)kPeriodUs);
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, regress.load());
+    // A swap that timed out while its publish was still being adopted is
+    // reported as a failure but still goes live
+    TEST_ASSERT_TRUE(dsp_get_config_epoch() >= appState.dsp.swapSuccesses);
+    TEST_ASSERT_TRUE(dsp_get_config_epoch() <= appState.dsp.swapSuccesses + appState.dsp.swapFailures);
+    TEST_ASSERT_EQUAL_UINT32(kSwaps + 1, appState.dsp.swapSuccesses + appState.dsp.swapFailures + refused);
+    // Writers never block for more than one block period
+    TEST_ASSERT_TRUE_MESSAGE(maxWaitUs <= kPeriodUs, "writer waited longer than one block period");
+}
+
+// Test 19: A flip the audio task claimed but has not finished never holds the
+// writer past one block period — the next swap fails instead of waiting
+void test_swap_bounded_while_flip_in_flight() {
+    _pendingIndex.store(DSP_RCU_CLAIMED);   // Audio task preempted mid-flip
+    const uint32_t periodUs = _blockPeriodUs;
+
+    uint32_t c0 = writer_cpu_us();
+    bool result = dsp_swap_config();
+    uint32_t us = writer_cpu_us() - c0;
+    _pendingIndex.store(DSP_RCU_NONE);
+
+    TEST_ASSERT_FALSE(result);
+    TEST_ASSERT_EQUAL_UINT32(1, appState.dsp.swapFailures);
+    TEST_ASSERT_TRUE(us <= periodUs);
+    TEST_ASSERT_TRUE(dsp_swap_config());
+}
+
+// Test 20: While a publish is still being adopted the inactive config is the
+// one going live — a copy must refuse to overwrite it
+void test_copy_refused_while_flip_in_flight() {
+    int idx = dsp_add_stage(0, DSP_GAIN, -1);
+    TEST_ASSERT_TRUE(idx >= 0);
+    DspState *inactive = dsp_get_inactive_config();
+    inactive->channels[0].stages[idx].gain.gainDb = -12.0f;
+
+    _pendingIndex.store(DSP_RCU_CLAIMED);   // Audio task preempted mid-flip
+    TEST_ASSERT_TRUE(dsp_swap_in_flight());
+    TEST_ASSERT_FALSE(dsp_copy_active_to_inactive());
+    TEST_ASSERT_EQUAL_INT(dsp_get_active_config()->channels[0].stageCount + 1,
+                          dsp_get_inactive_config()->channels[0].stageCount);
+    TEST_ASSERT_EQUAL_FLOAT(-12.0f, dsp_get_inactive_config()->channels[0].stages[idx].gain.gainDb);
+    TEST_ASSERT_FALSE(dsp_prepare_sample_rate(96000));
+    _pendingIndex.store(DSP_RCU_NONE);
+
+    TEST_ASSERT_FALSE(dsp_swap_in_flight());
+    TEST_ASSERT_TRUE(dsp_copy_active_to_inactive());
+    TEST_ASSERT_EQUAL_INT(dsp_get_active_config()->channels[0].stageCount,
+                          dsp_get_inactive_config()->channels[0].stageCount);
+}
+
 int main(int argc, char **argv) {
     UNITY_BEGIN();
 
@@ -305,6 +551,15 @@ int main(int argc, char **argv) {
     RUN_TEST(test_swap_success_does_not_increment_failures);
     RUN_TEST(test_log_swap_failure_does_not_increment_counter);
     RUN_TEST(test_swap_coeff_morphing_state);
+    RUN_TEST(test_withdrawn_publish_is_not_adopted);
+    RUN_TEST(test_epoch_counts_publishes);
+    RUN_TEST(test_state_follows_stage_id_across_insert);
+    RUN_TEST(test_removed_stage_state_not_inherited);
+    RUN_TEST(test_audio_side_adoption);
+    RUN_TEST(test_prepare_sample_rate_stages_coefficients);
+    RUN_TEST(test_stress_publish_while_processing);
+    RUN_TEST(test_swap_bounded_while_flip_in_flight);
+    RUN_TEST(test_copy_refused_while_flip_in_flight);
 
     return UNITY_END();
 }
@@ -0,0 +1,312 @@
+// test_dsp_true_peak.cpp
+// Lookahead true-peak limiter: no inter-sample overs on band-limited bursts,
+// exact lookahead latency, linked stereo gain, ceiling changes, slot pool and
+// pipeline plumbing, plus a native benchmark of an 8-output chain.
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "../../lib/esp_dsp_lite/src/dsps_biquad_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_init_f32.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fird_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_corr_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_conv_f32_ansi.c"
+#include "../../src/dsp_biquad_gen.c"
+
+#include "../../src/dsp_pipeline.h"
+#include "../../src/dsp_coefficients.h"
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/dsp_coefficients.cpp"
+#include "../../src/dsp_pipeline.cpp"
+#include "../../src/dsp_crossover.cpp"
+#include "../../src/dsp_convolution.cpp"
+#include "../../src/thd_measurement.cpp"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define N_SIG 6000
+
+static DspTruePeakState _st, _st2;
+static float _x[N_SIG], _y[N_SIG];
+
+void setUp(void) {
+    dsp_init();
+    dsp_tp_init(_st);
+    dsp_tp_init(_st2);
+}
+
+void tearDown(void) {}
+
+// Reference true peak: 16x windowed-sinc interpolation, 129 taps
+static float ref_true_peak_db(const float *x, int n) {
+    const int H = 64;
+    double mx = 0.0;
+    for (int i = H; i + H < n; i++) {
+        for (int k = 0; k < 16; k++) {
+            double s = 0.0;
+            for (int j = -H; j <= H; j++) {
+                double d = (double)k / 16.0 - j;
+                double sc = (d == 0.0) ? 1.0 : sin(M_PI * d) / (M_PI * d);
+                double w = 0.42 + 0.5 * cos(M_PI * d / (H + 1)) + 0.08 * cos(2.0 * M_PI * d / (H + 1));
+                s += x[i + j] * sc * w;
+            }
+            if (fabs(s) > mx) mx = fabs(s);
+        }
+    }
+    return (float)(20.0 * log10(mx));
+}
+
+// 0.5 -> 4.0 amplitude burst with 2 ms raised-cosine edges
+static void make_burst(float *x, int n, double freq, double phase) {
+    int a = n / 3, b = n / 3 + 1500, r = 96;
+    for (int i = 0; i < n; i++) {
+        double e = 0.0;
+        if (i >= a - r && i < a) e = 0.5 - 0.5 * cos(M_PI * (i - a + r) / r);
+        else if (i >= a && i < b) e = 1.0;
+        else if (i >= b && i < b + r) e = 0.5 + 0.5 * cos(M_PI * (i - b) / r);
+        x[i] = (float)((0.5 + 3.5 * e) * sin(2.0 * M_PI * freq * i / 48000.0 + phase));
+    }
+}
+
+static void run_mono(DspTruePeakState &st, float *buf, int n, int block) {
+    for (int i = 0; i < n; i += block)
+        dsp_true_peak_process(st, buf + i, (n - i < block) ? n - i : block);
+}
+
+// ===== Overs =====
+
+void test_lookahead_fits_ring(void) {
+    TEST_ASSERT_EQUAL_UINT32(0u, DSP_TP_RING & DSP_TP_RING_MASK);
+    TEST_ASSERT_EQUAL_UINT16(DSP_TP_MAX_LOOKAHEAD, dsp_tp_lookahead_samples(10.0f, 192000));
+    TEST_ASSERT_EQUAL_UINT16(72, dsp_tp_lookahead_samples(1.5f, 48000));
+    TEST_ASSERT_EQUAL_UINT16(1, dsp_tp_lookahead_samples(NAN, 48000));
+}
+
+void test_midband_bursts_hold_ceiling(void) {
+    const double freqs[] = {997.0, 5000.0, 12000.0};
+    const float las[] = {0.5f, 1.5f, 5.0f};
+    for (double f : freqs) {
+        for (float la : las) {
+            make_burst(_x, N_SIG, f, M_PI / 4);
+            dsp_tp_init(_st);
+            dsp_tp_configure(_st, 48000, -1.0f, la, 50.0f);
+            run_mono(_st, _x, N_SIG, 256);
+            float out = ref_true_peak_db(_x, N_SIG);
+            char msg[64];
+            snprintf(msg, sizeof(msg), "f=%.0f la=%.1f out=%.3f dBTP", f, la, out);
+            TEST_ASSERT_TRUE_MESSAGE(out <= -1.0f + 0.05f, msg);
+        }
+    }
+}
+
+void test_near_nyquist_bursts_stay_below_full_scale(void) {
+    // The 4x detector under-reads by up to ~0.7 dB here; the -1 dB default
+    // ceiling absorbs it
+    const double freqs[] = {16000.0, 20000.0};
+    for (double f : freqs) {
+        make_burst(_x, N_SIG, f, M_PI / 4);
+        dsp_tp_init(_st);
+        dsp_tp_configure(_st, 48000, -1.0f, 1.5f, 50.0f);
+        run_mono(_st, _x, N_SIG, 64);
+        float out = ref_true_peak_db(_x, N_SIG);
+        TEST_ASSERT_TRUE(out <= -0.5f);
+    }
+}
+
+void test_quiet_signal_passes_unchanged_after_latency(void) {
+    const int D = 72 - 1 + DSP_TP_OS_DELAY;
+    for (int i = 0; i < 2048; i++) _x[i] = _y[i] = 0.25f * (float)sin(2.0 * M_PI * 1000.0 * i / 48000.0);
+    dsp_tp_configure(_st, 48000, -1.0f, 1.5f, 50.0f);
+    run_mono(_st, _x, 2048, 100);
+    for (int i = 0; i < D; i++) TEST_ASSERT_EQUAL_FLOAT(0.0f, _x[i]);
+    for (int i = D; i < 2048; i++) TEST_ASSERT_EQUAL_FLOAT(_y[i - D], _x[i]);
+}
+
+void test_impulse_latency_matches_lookahead(void) {
+    dsp_tp_configure(_st, 48000, 0.0f, 2.0f, 50.0f);
+    memset(_x, 0, 512 * sizeof(float));
+    _x[10] = 0.5f;
+    run_mono(_st, _x, 512, 37);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, _x[10 + 96 - 1 + DSP_TP_OS_DELAY]);
+}
+
+// ===== Linked stereo =====
+
+void test_linked_applies_identical_gain(void) {
+    dsp_tp_configure(_st, 48000, -1.0f, 1.5f, 50.0f);
+    dsp_tp_configure(_st2, 48000, -1.0f, 1.5f, 50.0f);
+    static float l[N_SIG], r[N_SIG];
+    make_burst(l, N_SIG, 1000.0, 0.0);
+    for (int i = 0; i < N_SIG; i++) r[i] = 0.25f * (float)sin(2.0 * M_PI * 300.0 * i / 48000.0);
+    memcpy(_y, r, sizeof(r));
+    for (int i = 0; i < N_SIG; i += 128)
+        dsp_true_peak_process_linked(_st, _st2, l + i, r + i, 128);
+    // R alone never needs limiting, so any reduction on R came from L
+    const int D = 72 - 1 + DSP_TP_OS_DELAY;
+    float minRatio = 1.0f;
+    for (int i = D; i < N_SIG; i++) {
+        if (fabsf(_y[i - D]) > 0.05f) {
+            float g = r[i] / _y[i - D];
+            if (g < minRatio) minRatio = g;
+        }
+    }
+    TEST_ASSERT_TRUE(minRatio < 0.5f);
+    TEST_ASSERT_TRUE(ref_true_peak_db(l, N_SIG) <= -0.95f);
+}
+
+// ===== Parameter changes =====
+
+void test_lower_ceiling_applies_immediately(void) {
+    for (int i = 0; i < 4096; i++) _x[i] = 0.8f * (float)sin(2.0 * M_PI * 1000.0 * i / 48000.0);
+    dsp_tp_configure(_st, 48000, 0.0f, 1.5f, 50.0f);
+    run_mono(_st, _x, 2048, 128);
+    dsp_tp_configure(_st, 48000, -6.0f, 1.5f, 50.0f);
+    run_mono(_st, _x + 2048, 2048, 128);
+    float mx = 0.0f;
+    for (int i = 2048; i < 4096; i++) if (fabsf(_x[i]) > mx) mx = fabsf(_x[i]);
+    TEST_ASSERT_TRUE(mx <= powf(10.0f, -6.0f / 20.0f) * 1.001f);
+}
+
+void test_lookahead_change_resets_state(void) {
+    dsp_tp_configure(_st, 48000, -1.0f, 1.5f, 50.0f);
+    for (int i = 0; i < 256; i++) _x[i] = 2.0f;
+    run_mono(_st, _x, 256, 256);
+    dsp_tp_configure(_st, 48000, -1.0f, 3.0f, 50.0f);
+    TEST_ASSERT_EQUAL_UINT16(144 - 1 + DSP_TP_OS_DELAY, _st.delay);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, _st.gain);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, _st.ring[0]);
+}
+
+void test_clamp_params(void) {
+    DspTruePeakParams p;
+    dsp_init_true_peak_params(p);
+    p.ceilingDb = 3.0f;
+    p.lookaheadMs = NAN;
+    p.releaseMs = 0.0f;
+    dsp_tp_clamp_params(p);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, p.ceilingDb);
+    TEST_ASSERT_TRUE(p.lookaheadMs >= 0.5f && p.lookaheadMs <= 5.0f);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, p.releaseMs);
+}
+
+// ===== Pool and pipeline =====
+
+void test_slot_pool_exhaustion_and_reuse(void) {
+    int slots[DSP_MAX_TRUE_PEAK_SLOTS];
+    for (int i = 0; i < DSP_MAX_TRUE_PEAK_SLOTS; i++) {
+        slots[i] = dsp_tp_alloc_slot();
+        TEST_ASSERT_TRUE(slots[i] >= 0);
+    }
+    TEST_ASSERT_EQUAL_INT(-1, dsp_tp_alloc_slot());
+    dsp_tp_free_slot(slots[1]);
+    TEST_ASSERT_EQUAL_INT(slots[1], dsp_tp_alloc_slot());
+    for (int i = 0; i < DSP_MAX_TRUE_PEAK_SLOTS; i++) dsp_tp_free_slot(slots[i]);
+}
+
+void test_stage_add_remove_manages_slot(void) {
+    int idx = dsp_add_stage(0, DSP_TRUE_PEAK_LIMITER);
+    TEST_ASSERT_TRUE(idx >= 0);
+    DspState *cfg = dsp_get_inactive_config();
+    int slot = cfg->channels[0].stages[idx].truePeak.tpSlot;
+    TEST_ASSERT_TRUE(slot >= 0);
+    TEST_ASSERT_TRUE(dsp_remove_stage(0, idx));
+    TEST_ASSERT_EQUAL_INT(slot, dsp_tp_alloc_slot());
+    dsp_tp_free_slot(slot);
+}
+
+void test_pipeline_linked_pair_limits_both_channels(void) {
+    int li = dsp_add_stage(0, DSP_TRUE_PEAK_LIMITER);
+    int ri = dsp_add_stage(1, DSP_TRUE_PEAK_LIMITER);
+    TEST_ASSERT_TRUE(li >= 0 && ri >= 0);
+    DspState *cfg = dsp_get_inactive_config();
+    cfg->channels[0].bypass = false;
+    cfg->channels[1].bypass = false;
+    dsp_swap_config();
+
+    static float l[4096], r[4096];
+    for (int i = 0; i < 4096; i++) {
+        l[i] = 2.0f * (float)sin(2.0 * M_PI * 1000.0 * i / 48000.0);
+        r[i] = 0.2f * (float)sin(2.0 * M_PI * 1000.0 * i / 48000.0);
+    }
+    for (int i = 0; i < 4096; i += 256) dsp_process_buffer_float(l + i, r + i, 256, 0);
+
+    DspState *act = dsp_get_active_config();
+    float grL = act->channels[0].stages[li].truePeak.gainReduction;
+    float grR = act->channels[1].stages[ri].truePeak.gainReduction;
+    TEST_ASSERT_TRUE(grL < -6.0f);
+    TEST_ASSERT_EQUAL_FLOAT(grL, grR);
+    // R follows L's gain (~ -13 dB), so its 0.2 peak drops below 0.1
+    float mxL = 0.0f, mxR = 0.0f;
+    for (int i = 3000; i < 4096; i++) {
+        if (fabsf(l[i]) > mxL) mxL = fabsf(l[i]);
+        if (fabsf(r[i]) > mxR) mxR = fabsf(r[i]);
+    }
+    TEST_ASSERT_TRUE(mxL <= 0.892f);
+    TEST_ASSERT_TRUE(mxR < 0.1f);
+}
+
+void test_copy_chain_gives_each_stage_its_own_slot(void) {
+    int idx = dsp_add_stage(0, DSP_TRUE_PEAK_LIMITER);
+    TEST_ASSERT_TRUE(idx >= 0);
+    dsp_copy_chain_stages(0, 1);
+    DspState *cfg = dsp_get_inactive_config();
+    int8_t a = cfg->channels[0].stages[idx].truePeak.tpSlot;
+    int8_t b = cfg->channels[1].stages[idx].truePeak.tpSlot;
+    TEST_ASSERT_TRUE(a >= 0 && b >= 0);
+    TEST_ASSERT_NOT_EQUAL(a, b);
+    TEST_ASSERT_EQUAL_STRING("TRUE_PEAK_LIMITER", stage_type_name(DSP_TRUE_PEAK_LIMITER));
+    TEST_ASSERT_EQUAL(DSP_TRUE_PEAK_LIMITER, stage_type_from_name("TRUE_PEAK_LIMITER"));
+}
+
+// ===== Benchmark =====
+
+static volatile float _sink;
+
+void test_benchmark_eight_outputs(void) {
+    static DspTruePeakState outs[8];
+    const int block = 256, iters = 500;
+    static float buf[8][block];
+    for (int c = 0; c < 8; c++) {
+        dsp_tp_init(outs[c]);
+        dsp_tp_configure(outs[c], 48000, -1.0f, 1.5f, 50.0f);
+        for (int i = 0; i < block; i++) buf[c][i] = 1.5f * (float)sin(0.1 * i + c);
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < iters; k++)
+        for (int c = 0; c < 8; c++) dsp_true_peak_process(outs[c], buf[c], block);
+    auto t1 = std::chrono::steady_clock::now();
+    _sink = buf[3][7];
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    double perSample = ns / ((double)block * iters * 8);
+    // Share of one core for 8 outputs at 48 kHz on this host
+    double load = perSample * 8 * 48000.0 / 1e9 * 100.0;
+    printf("[bench] true-peak ns/sample: %.2f (8 outputs @ 48 kHz = %.2f%% of one host core)\n", perSample, load);
+    TEST_ASSERT_TRUE(perSample > 0.0);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_lookahead_fits_ring);
+    RUN_TEST(test_midband_bursts_hold_ceiling);
+    RUN_TEST(test_near_nyquist_bursts_stay_below_full_scale);
+    RUN_TEST(test_quiet_signal_passes_unchanged_after_latency);
+    RUN_TEST(test_impulse_latency_matches_lookahead);
+    RUN_TEST(test_linked_applies_identical_gain);
+    RUN_TEST(test_lower_ceiling_applies_immediately);
+    RUN_TEST(test_lookahead_change_resets_state);
+    RUN_TEST(test_clamp_params);
+    RUN_TEST(test_slot_pool_exhaustion_and_reuse);
+    RUN_TEST(test_stage_add_remove_manages_slot);
+    RUN_TEST(test_pipeline_linked_pair_limits_both_channels);
+    RUN_TEST(test_copy_chain_gives_each_stage_its_own_slot);
+    RUN_TEST(test_benchmark_eight_outputs);
+    return UNITY_END();
+}
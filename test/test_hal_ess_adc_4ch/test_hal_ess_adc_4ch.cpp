@@ -59,12 +59,12 @@ static bool hal_wifi_sdio_active() { return false; }
 #include "../test_mocks/LittleFS.h"
 
 // Dependency chain (order matters)
-// Define TDM_TEST_PROVIDES_STUBS so hal_tdm_deinterleaver.cpp skips its inline
-// i2s_audio_get_sample_rate stub — we provide them here instead.
+// Define TDM_TEST_PROVIDES_STUBS so hal_tdm_engine.cpp and hal_ess_adc_4ch.cpp
+// skip their inline port stubs — we provide them here instead.
 #define TDM_TEST_PROVIDES_STUBS
 
 // Port-generic TDM stubs (satisfy deinterleaver and adc4ch requirements)
-inline uint32_t i2s_port_tdm_read(uint8_t, int32_t*, uint32_t, uint8_t) { return 0; }
+inline uint32_t i2s_port_tdm_read(uint8_t, void*, uint32_t, uint16_t) { return 0; }
 inline bool     i2s_port_is_rx_active(uint8_t) { return false; }
 inline uint32_t i2s_audio_get_sample_rate(void) { return 48000; }
 inline bool     i2s_port_enable_rx(uint8_t, void*) { return true; }
@@ -74,6 +74,7 @@ inline void     i2s_port_disable_rx(uint8_t) {}
 #include "../../src/psram_alloc.cpp"
 #include "../../src/diag_journal.cpp"
 #include "../../src/hal/hal_i2c_bus.cpp"
+#include "../../src/hal/hal_tdm_engine.cpp"
 #include "../../src/hal/hal_tdm_deinterleaver.cpp"
 #include "../../src/hal/hal_ess_sabre_adc_base.cpp"
 #include "../../src/hal/hal_device_manager.cpp"
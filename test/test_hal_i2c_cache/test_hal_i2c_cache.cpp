@@ -0,0 +1,438 @@
+// test_hal_i2c_cache.cpp
+// HalI2cBus register shadow cache: write elision, shadowed reads, staged
+// write-combining updates and auto-increment bursts.
+//
+// Uses the real hal_i2c_bus.cpp against the WireMock, plus the real
+// HalEssDac2ch driver to count bus transactions for a full DAC init and a
+// 0..100% volume sweep with the cache off vs on.
+//
+// Section layout:
+//   1.  Write elision / shadowed reads
+//   2.  Volatile registers and invalidation
+//   3.  Staged updates and bursts
+//   4.  writeReg16 / paged writes
+//   5.  Driver transaction counts (ES9038Q2M init + volume sweep)
+
+#include <unity.h>
+#include <cstring>
+#include <cstdint>
+
+#ifndef DAC_ENABLED
+#define DAC_ENABLED
+#endif
+
+#ifdef NATIVE_TEST
+#include "../test_mocks/Arduino.h"
+#include "../test_mocks/Wire.h"
+#endif
+
+#include "../../src/hal/hal_types.h"
+
+// hal_i2c_bus.cpp requires hal_wifi_sdio_active() — stub for native tests.
+static bool hal_wifi_sdio_active() { return false; }
+
+#include "../test_mocks/Preferences.h"
+#include "../test_mocks/LittleFS.h"
+
+#include "../../src/diag_journal.cpp"
+#include "../../src/hal/hal_i2c_bus.cpp"
+#include "../../src/sink_write_utils.cpp"
+#include "../../src/hal/hal_device_manager.cpp"
+#include "../../src/hal/hal_ess_sabre_dac_base.cpp"
+#include "../../src/hal/hal_ess_dac_2ch.cpp"
+
+#define DEV   0x48
+#define BUSIX HAL_I2C_BUS_EXP
+
+static HalI2cBus& bus() { return HalI2cBus::get(BUSIX); }
+
+static int txns() { return WireMock::txCount + WireMock::rxCount; }
+
+void setUp() {
+    WireMock::reset();
+    ArduinoMock::reset();
+    HalDeviceManager::instance().reset();
+    WireMock::registerDevice(DEV, BUSIX);
+    bus().disableCache(DEV);
+    bus().setCacheEnabled(true);
+    bus().resetStats();
+}
+
+void tearDown() {
+    bus().disableCache(DEV);
+    HalDeviceManager::instance().reset();
+}
+
+// ===========================================================================
+// Section 1 — Write elision / shadowed reads
+// ===========================================================================
+
+void test_uncached_device_writes_through() {
+    TEST_ASSERT_TRUE(bus().writeReg(DEV, 0x0F, 0x10));
+    TEST_ASSERT_TRUE(bus().writeReg(DEV, 0x0F, 0x10));
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+    TEST_ASSERT_EQUAL_HEX8(0x10, bus().readReg(DEV, 0x0F));
+    TEST_ASSERT_EQUAL(1, WireMock::rxCount);
+}
+
+void test_repeated_write_is_elided() {
+    bus().enableCache(DEV, true);
+    TEST_ASSERT_TRUE(bus().writeReg(DEV, 0x0F, 0x10));
+    TEST_ASSERT_TRUE(bus().writeReg(DEV, 0x0F, 0x10));
+    TEST_ASSERT_EQUAL(1, WireMock::txCount);
+    TEST_ASSERT_EQUAL(1, (int)bus().getStats().elided);
+    TEST_ASSERT_TRUE(bus().writeReg(DEV, 0x0F, 0x11));
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+    TEST_ASSERT_EQUAL_HEX8(0x11, WireMock::registerMap[DEV][0x0F]);
+}
+
+void test_read_after_write_served_from_shadow() {
+    bus().enableCache(DEV, true);
+    bus().writeReg(DEV, 0x07, 0x04);
+    TEST_ASSERT_EQUAL_HEX8(0x04, bus().readReg(DEV, 0x07));
+    TEST_ASSERT_EQUAL(0, WireMock::rxCount);
+    TEST_ASSERT_EQUAL(1, (int)bus().getStats().cacheHits);
+}
+
+void test_first_read_fills_shadow() {
+    WireMock::registerMap[DEV][0x07] = 0x5A;
+    bus().enableCache(DEV, true);
+    TEST_ASSERT_EQUAL_HEX8(0x5A, bus().readReg(DEV, 0x07));
+    TEST_ASSERT_EQUAL_HEX8(0x5A, bus().readReg(DEV, 0x07));
+    TEST_ASSERT_EQUAL(1, WireMock::rxCount);
+    // Writing back the value just read costs nothing
+    int before = WireMock::txCount;   // Register-pointer write of the read
+    TEST_ASSERT_TRUE(bus().writeReg(DEV, 0x07, 0x5A));
+    TEST_ASSERT_EQUAL(before, WireMock::txCount);
+}
+
+void test_failed_write_is_not_shadowed() {
+    bus().enableCache(0x30, true);   // Not registered on the mock → NACK
+    TEST_ASSERT_FALSE(bus().writeReg(0x30, 0x01, 0x22));
+    TEST_ASSERT_FALSE(bus().writeReg(0x30, 0x01, 0x22));
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+    bus().disableCache(0x30);
+}
+
+void test_cache_switch_off_writes_through() {
+    bus().enableCache(DEV, true);
+    bus().writeReg(DEV, 0x0F, 0x10);
+    bus().setCacheEnabled(false);
+    bus().writeReg(DEV, 0x0F, 0x10);
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+    // Turning it back on must not trust values written while it was off
+    WireMock::registerMap[DEV][0x0F] = 0x33;
+    bus().setCacheEnabled(true);
+    TEST_ASSERT_EQUAL_HEX8(0x33, bus().readReg(DEV, 0x0F));
+}
+
+// ===========================================================================
+// Section 2 — Volatile registers and invalidation
+// ===========================================================================
+
+void test_volatile_register_always_hits_bus() {
+    bus().enableCache(DEV, true);
+    bus().markVolatile(DEV, 0xE0, 0xFF);
+    WireMock::registerMap[DEV][0xE2] = 0x01;
+    TEST_ASSERT_EQUAL_HEX8(0x01, bus().readReg(DEV, 0xE2));
+    WireMock::registerMap[DEV][0xE2] = 0x00;
+    TEST_ASSERT_EQUAL_HEX8(0x00, bus().readReg(DEV, 0xE2));
+    TEST_ASSERT_EQUAL(2, WireMock::rxCount);
+    bus().markVolatile(DEV, 0x00, 0x00);
+    int before = WireMock::txCount;
+    bus().writeReg(DEV, 0x00, 0x01);
+    bus().writeReg(DEV, 0x00, 0x01);   // Self-clearing reset — never elided
+    TEST_ASSERT_EQUAL(before + 2, WireMock::txCount);
+}
+
+void test_invalidate_forces_rewrite() {
+    bus().enableCache(DEV, true);
+    bus().writeReg(DEV, 0x0F, 0x10);
+    bus().invalidateCache(DEV);
+    bus().writeReg(DEV, 0x0F, 0x10);
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+}
+
+void test_enable_cache_is_idempotent() {
+    TEST_ASSERT_TRUE(bus().enableCache(DEV, true));
+    bus().writeReg(DEV, 0x0F, 0x10);
+    TEST_ASSERT_TRUE(bus().enableCache(DEV, true));
+    bus().writeReg(DEV, 0x0F, 0x10);
+    TEST_ASSERT_EQUAL(1, WireMock::txCount);
+}
+
+void test_cache_slots_are_bounded() {
+    for (int i = 0; i < HAL_I2C_CACHE_DEVICES; i++) {
+        TEST_ASSERT_TRUE(bus().enableCache((uint8_t)(0x50 + i), false));
+    }
+    TEST_ASSERT_FALSE(bus().enableCache(0x60, false));
+    for (int i = 0; i < HAL_I2C_CACHE_DEVICES; i++) bus().disableCache((uint8_t)(0x50 + i));
+}
+
+// ===========================================================================
+// Section 3 — Staged updates and bursts
+// ===========================================================================
+
+void test_update_combines_contiguous_writes_into_burst() {
+    bus().enableCache(DEV, true);
+    {
+        HalI2cUpdate upd(bus());
+        TEST_ASSERT_TRUE(upd.held());
+        bus().writeReg(DEV, 0x10, 0xBB);   // Staged out of order on purpose
+        bus().writeReg(DEV, 0x0F, 0xAA);
+        TEST_ASSERT_EQUAL(0, WireMock::txCount);
+        TEST_ASSERT_TRUE(upd.end());
+    }
+    TEST_ASSERT_EQUAL(1, WireMock::txCount);
+    TEST_ASSERT_EQUAL(1, (int)bus().getStats().bursts);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, WireMock::registerMap[DEV][0x0F]);
+    TEST_ASSERT_EQUAL_HEX8(0xBB, WireMock::registerMap[DEV][0x10]);
+}
+
+void test_update_without_autoincrement_writes_singly() {
+    bus().enableCache(DEV, false);
+    {
+        HalI2cUpdate upd(bus());
+        bus().writeReg(DEV, 0x0F, 0xAA);
+        bus().writeReg(DEV, 0x10, 0xBB);
+    }
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+    TEST_ASSERT_EQUAL(0, (int)bus().getStats().bursts);
+}
+
+void test_update_gap_splits_bursts() {
+    bus().enableCache(DEV, true);
+    {
+        HalI2cUpdate upd(bus());
+        bus().writeReg(DEV, 0x01, 0x11);
+        bus().writeReg(DEV, 0x02, 0x22);
+        bus().writeReg(DEV, 0x07, 0x77);
+    }
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+    TEST_ASSERT_EQUAL_HEX8(0x22, WireMock::registerMap[DEV][0x02]);
+    TEST_ASSERT_EQUAL_HEX8(0x77, WireMock::registerMap[DEV][0x07]);
+}
+
+void test_long_run_is_chunked() {
+    bus().enableCache(DEV, true);
+    {
+        HalI2cUpdate upd(bus());
+        for (int r = 0; r < HAL_I2C_BURST_MAX + 8; r++) bus().writeReg(DEV, (uint8_t)r, (uint8_t)(r + 1));
+    }
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+    TEST_ASSERT_EQUAL_HEX8(HAL_I2C_BURST_MAX + 8, WireMock::registerMap[DEV][HAL_I2C_BURST_MAX + 7]);
+}
+
+void test_nested_updates_flush_at_outermost() {
+    bus().enableCache(DEV, true);
+    TEST_ASSERT_TRUE(bus().beginUpdate());
+    bus().writeReg(DEV, 0x0F, 0x01);
+    TEST_ASSERT_TRUE(bus().beginUpdate());
+    bus().writeReg(DEV, 0x10, 0x02);
+    TEST_ASSERT_TRUE(bus().endUpdate());
+    TEST_ASSERT_EQUAL(0, WireMock::txCount);
+    TEST_ASSERT_TRUE(bus().endUpdate());
+    TEST_ASSERT_EQUAL(1, WireMock::txCount);
+    TEST_ASSERT_FALSE(bus().endUpdate());   // Unbalanced
+}
+
+void test_volatile_write_in_update_flushes_first() {
+    bus().enableCache(DEV, true);
+    bus().markVolatile(DEV, 0x00, 0x00);
+    {
+        HalI2cUpdate upd(bus());
+        bus().writeReg(DEV, 0x0F, 0x42);
+        bus().writeReg(DEV, 0x00, 0x01);   // Order-sensitive — must follow 0x0F
+        TEST_ASSERT_EQUAL(2, WireMock::txCount);
+    }
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+}
+
+void test_uncached_device_in_update_writes_directly() {
+    {
+        HalI2cUpdate upd(bus());
+        TEST_ASSERT_TRUE(bus().writeReg(DEV, 0x0F, 0x42));
+        TEST_ASSERT_EQUAL(1, WireMock::txCount);
+    }
+    TEST_ASSERT_EQUAL(1, WireMock::txCount);
+}
+
+void test_update_reports_flush_failure() {
+    bus().enableCache(0x30, true);   // NACKs
+    bool ok;
+    {
+        HalI2cUpdate upd(bus());
+        bus().writeReg(0x30, 0x01, 0x01);
+        ok = upd.end();
+    }
+    TEST_ASSERT_FALSE(ok);
+    // Failed flush leaves the register unknown — the retry goes out
+    bus().writeReg(0x30, 0x01, 0x01);
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+    bus().disableCache(0x30);
+}
+
+// ===========================================================================
+// Section 4 — writeReg16 / paged writes
+// ===========================================================================
+
+void test_writereg16_single_burst_when_cached() {
+    bus().enableCache(DEV, true);
+    TEST_ASSERT_TRUE(bus().writeReg16(DEV, 0x10, 0x1234));
+    TEST_ASSERT_EQUAL(1, WireMock::txCount);
+    TEST_ASSERT_EQUAL_HEX8(0x34, WireMock::registerMap[DEV][0x10]);
+    TEST_ASSERT_EQUAL_HEX8(0x12, WireMock::registerMap[DEV][0x11]);
+    // Unchanged pair is elided entirely
+    TEST_ASSERT_TRUE(bus().writeReg16(DEV, 0x10, 0x1234));
+    TEST_ASSERT_EQUAL(1, WireMock::txCount);
+}
+
+void test_writereg16_rewrites_msb_latch() {
+    bus().enableCache(DEV, true);
+    bus().writeReg16(DEV, 0x10, 0x1234);
+    // Only the LSB changes, but the MSB write latches the pair
+    bus().writeReg16(DEV, 0x10, 0x1235);
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+    TEST_ASSERT_EQUAL(2, (int)bus().getStats().bursts);
+}
+
+void test_writereg16_uncached_two_writes() {
+    TEST_ASSERT_TRUE(bus().writeReg16(DEV, 0x10, 0xBEEF));
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+    TEST_ASSERT_EQUAL_HEX8(0xEF, WireMock::registerMap[DEV][0x10]);
+    TEST_ASSERT_EQUAL_HEX8(0xBE, WireMock::registerMap[DEV][0x11]);
+}
+
+void test_paged_write_elided() {
+    bus().enableCache(DEV, false);
+    TEST_ASSERT_TRUE(bus().writeRegPaged(DEV, 0x0901, 0x80));
+    TEST_ASSERT_TRUE(bus().writeRegPaged(DEV, 0x0901, 0x80));
+    TEST_ASSERT_EQUAL(1, WireMock::txCount);
+    TEST_ASSERT_TRUE(bus().writeRegPaged(DEV, 0x0901, 0x81));
+    TEST_ASSERT_EQUAL(2, WireMock::txCount);
+    bus().invalidateCache(DEV);
+    TEST_ASSERT_TRUE(bus().writeRegPaged(DEV, 0x0901, 0x81));
+    TEST_ASSERT_EQUAL(3, WireMock::txCount);
+}
+
+void test_paged_shadow_replacement() {
+    bus().enableCache(DEV, false);
+    for (int i = 0; i <= HAL_I2C_PAGED_SHADOW; i++) bus().writeRegPaged(DEV, (uint16_t)(0x0100 + i), 0x01);
+    // The first entry was evicted; the last is still shadowed
+    bus().writeRegPaged(DEV, (uint16_t)(0x0100 + HAL_I2C_PAGED_SHADOW), 0x01);
+    TEST_ASSERT_EQUAL(HAL_I2C_PAGED_SHADOW + 1, WireMock::txCount);
+    bus().writeRegPaged(DEV, 0x0100, 0x01);
+    TEST_ASSERT_EQUAL(HAL_I2C_PAGED_SHADOW + 2, WireMock::txCount);
+}
+
+// ===========================================================================
+// Section 5 — Driver transaction counts
+// ===========================================================================
+
+// Full init followed by a 0..100% volume sweep; returns bus transactions.
+static int run_dac_session(bool cache, int* initTxns) {
+    WireMock::reset();
+    WireMock::registerDevice(DEV, BUSIX);
+    WireMock::registerMap[DEV][ESS_SABRE_REG_CHIP_ID] = 0x90;
+    bus().setCacheEnabled(cache);
+    HalEssDac2ch dac(kDescES9038Q2M);
+    TEST_ASSERT_TRUE(dac.init().success);
+    *initTxns = txns();
+    for (int v = 0; v <= 100; v++) TEST_ASSERT_TRUE(dac.setVolume((uint8_t)v));
+    dac.setMute(true);
+    dac.setMute(false);
+    TEST_ASSERT_EQUAL_HEX8(0x00, WireMock::registerMap[DEV][0x0F]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, WireMock::registerMap[DEV][0x10]);
+    int total = txns();
+    dac.deinit();
+    return total;
+}
+
+void test_dac_init_and_sweep_fewer_transactions() {
+    int initOff, initOn;
+    int off = run_dac_session(false, &initOff);
+    int on  = run_dac_session(true,  &initOn);
+    bus().setCacheEnabled(true);
+    // Volume pair goes out as one burst per step instead of two writes
+    TEST_ASSERT_LESS_THAN(initOff, initOn);
+    TEST_ASSERT_LESS_THAN(off - 100, on);
+}
+
+void test_dac_repeated_volume_is_free() {
+    WireMock::registerMap[DEV][ESS_SABRE_REG_CHIP_ID] = 0x90;
+    HalEssDac2ch dac(kDescES9038Q2M);
+    TEST_ASSERT_TRUE(dac.init().success);
+    dac.setVolume(40);
+    int before = txns();
+    for (int i = 0; i < 10; i++) dac.setVolume(40);
+    TEST_ASSERT_EQUAL(before, txns());
+    dac.deinit();
+}
+
+void test_dac_reinit_after_reset_rewrites_registers() {
+    WireMock::registerMap[DEV][ESS_SABRE_REG_CHIP_ID] = 0x90;
+    HalEssDac2ch dac(kDescES9038Q2M);
+    TEST_ASSERT_TRUE(dac.init().success);
+    dac.deinit();
+    // Chip lost power between sessions — init must not trust old values
+    WireMock::registerMap[DEV].clear();
+    WireMock::registerMap[DEV][ESS_SABRE_REG_CHIP_ID] = 0x90;
+    TEST_ASSERT_TRUE(dac.init().success);
+    TEST_ASSERT_TRUE(WireMock::registerMap[DEV].count(0x0F) == 1);
+    TEST_ASSERT_TRUE(WireMock::registerMap[DEV].count(0x07) == 1);
+    dac.deinit();
+}
+
+void test_dac_mute_rmw_reads_from_shadow() {
+    WireMock::registerMap[DEV][ESS_SABRE_REG_CHIP_ID] = 0x90;
+    HalEssDac2ch dac(kDescES9038Q2M);
+    TEST_ASSERT_TRUE(dac.init().success);
+    int rxBefore = WireMock::rxCount;
+    TEST_ASSERT_TRUE(dac.setMute(true));
+    TEST_ASSERT_EQUAL(rxBefore, WireMock::rxCount);
+    TEST_ASSERT_EQUAL_HEX8(0x01, WireMock::registerMap[DEV][0x07] & 0x01);
+    dac.deinit();
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    // Section 1
+    RUN_TEST(test_uncached_device_writes_through);
+    RUN_TEST(test_repeated_write_is_elided);
+    RUN_TEST(test_read_after_write_served_from_shadow);
+    RUN_TEST(test_first_read_fills_shadow);
+    RUN_TEST(test_failed_write_is_not_shadowed);
+    RUN_TEST(test_cache_switch_off_writes_through);
+
+    // Section 2
+    RUN_TEST(test_volatile_register_always_hits_bus);
+    RUN_TEST(test_invalidate_forces_rewrite);
+    RUN_TEST(test_enable_cache_is_idempotent);
+    RUN_TEST(test_cache_slots_are_bounded);
+
+    // Section 3
+    RUN_TEST(test_update_combines_contiguous_writes_into_burst);
+    RUN_TEST(test_update_without_autoincrement_writes_singly);
+    RUN_TEST(test_update_gap_splits_bursts);
+    RUN_TEST(test_long_run_is_chunked);
+    RUN_TEST(test_nested_updates_flush_at_outermost);
+    RUN_TEST(test_volatile_write_in_update_flushes_first);
+    RUN_TEST(test_uncached_device_in_update_writes_directly);
+    RUN_TEST(test_update_reports_flush_failure);
+
+    // Section 4
+    RUN_TEST(test_writereg16_single_burst_when_cached);
+    RUN_TEST(test_writereg16_rewrites_msb_latch);
+    RUN_TEST(test_writereg16_uncached_two_writes);
+    RUN_TEST(test_paged_write_elided);
+    RUN_TEST(test_paged_shadow_replacement);
+
+    // Section 5
+    RUN_TEST(test_dac_init_and_sweep_fewer_transactions);
+    RUN_TEST(test_dac_repeated_volume_is_free);
+    RUN_TEST(test_dac_reinit_after_reset_rewrites_registers);
+    RUN_TEST(test_dac_mute_rmw_reads_from_shadow);
+
+    return UNITY_END();
+}
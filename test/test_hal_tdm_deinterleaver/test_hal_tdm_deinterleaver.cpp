@@ -7,19 +7,19 @@
 //   3. deinit() releases buffers, isReady() returns false afterwards
 //   4. buildSources() populates both AudioInputSource structs with non-null callbacks
 //   5. Pair A read fills CH1/CH2 correctly from a synthetic TDM buffer
-//   6. Pair B read returns CH3/CH4 from the buffer pair A just deinterleaved
+//   6. Pair B read returns CH3/CH4 from the block pair A just read
 //   7. Pair A produces the correct frame count for varying input sizes
 //   8. Pair B returns 0 before pair A has produced any data
 //   9. Pair B is limited to the last frame count produced by pair A
 //  10. Deinterleave preserves L/R ordering (CH1→L, CH2→R, CH3→L, CH4→R)
-//  11. Ping-pong: calling pair A twice and pair B once returns the SECOND fill
+//  11. Calling pair A twice and pair B once returns the SECOND fill
 //  12. buildSources() names are assigned correctly
 //  13. isActive() callbacks reflect _initialized state in native tests
 //  14. getSampleRate() returns 48000 in native test context
 //  15. Source halSlot and lane are initialised to defaults by buildSources()
 //
-// Thread-safety note: tests are single-threaded; the ping-pong ordering is
-// exercised by calling pair A then pair B within the same synthetic "tick".
+// Thread-safety note: tests are single-threaded; the pair A / pair B ordering
+// is exercised by calling pair A then pair B within the same synthetic "tick".
 
 #include <unity.h>
 #include <cstring>
@@ -41,13 +41,13 @@
 static int32_t g_tdmFeedBuf[128 * 4] = {};   // Up to 128 TDM frames × 4 slots
 static uint32_t g_tdmFeedFrames = 0;          // Frames of data loaded into buf
 
-// These are called by the _pairARead / _pairAActive static thunks inside the
-// deinterleaver via the port-generic API.  We define them before including the
-// .cpp so they satisfy the forward declarations inside the NATIVE_TEST block.
-inline uint32_t i2s_port_tdm_read(uint8_t /*port*/, int32_t* dst, uint32_t frames, uint8_t /*slots*/) {
+// These are called by the pair A lane view inside the TDM engine via the
+// port-generic API.  We define them before including the .cpp so they satisfy
+// the forward declarations inside the NATIVE_TEST block.
+inline uint32_t i2s_port_tdm_read(uint8_t /*port*/, void* dst, uint32_t frames, uint16_t frameBytes) {
     uint32_t avail = (g_tdmFeedFrames < frames) ? g_tdmFeedFrames : frames;
     if (avail > 0) {
-        memcpy(dst, g_tdmFeedBuf, avail * 4 * sizeof(int32_t));
+        memcpy(dst, g_tdmFeedBuf, avail * frameBytes);
     }
     return avail;
 }
@@ -58,7 +58,8 @@ inline uint32_t i2s_audio_get_sample_rate(void) { return 48000; }
 #include "../../src/heap_budget.cpp"
 #include "../../src/psram_alloc.cpp"
 
-// Bring in the deinterleaver implementation directly (native test pattern)
+// Bring in the deinterleaver and engine implementations directly (native test pattern)
+#include "../../src/hal/hal_tdm_engine.cpp"
 #include "../../src/hal/hal_tdm_deinterleaver.cpp"
 
 // ---------------------------------------------------------------------------
@@ -189,7 +190,7 @@ void test_pair_b_extracts_ch3_ch4(void) {
     g_deint->buildSources("A", "B", &srcA, &srcB);
 
     loadTdmFrames(4);
-    srcA.read(pairAOut, 4);        // Triggers deinterleave + ping-pong swap
+    srcA.read(pairAOut, 4);        // Triggers the TDM read
     uint32_t got = srcB.read(pairBOut, 4);
     TEST_ASSERT_EQUAL_UINT32(4, got);
 
@@ -288,7 +289,7 @@ void test_pingpong_reads_latest_pair_a_fill(void) {
         g_tdmFeedBuf[f * 4 + 3] = (int32_t)(0x14000000 | f);  // CH4 new
     }
     g_tdmFeedFrames = 4;
-    srcA.read(pairAOut, 4);   // Second pair A fill — moves to next ping-pong side
+    srcA.read(pairAOut, 4);   // Second pair A fill replaces the block
 
     // Pair B should read CH3/CH4 from the SECOND fill
     uint32_t got = srcB.read(pairBOut, 4);
@@ -427,7 +428,7 @@ void test_tdm_deinterleaver_first_instance_gets_slot_0(void) {
 }
 
 // ---------------------------------------------------------------------------
-// Test 20: two concurrent instances get different thunk pointers
+// Test 20: two concurrent instances get different lane-view callbacks
 // ---------------------------------------------------------------------------
 void test_tdm_deinterleaver_second_instance_gets_different_thunks(void) {
     HalTdmDeinterleaver tdm1;
@@ -445,40 +446,50 @@ void test_tdm_deinterleaver_second_instance_gets_different_thunks(void) {
     // Both instances must have non-null callbacks
     TEST_ASSERT_NOT_NULL(srcA0.read);
     TEST_ASSERT_NOT_NULL(srcA1.read);
-    // The two instances must receive DIFFERENT read function pointers (slot 0 vs slot 1)
+    // The two instances must receive DIFFERENT read function pointers (distinct pool views)
     TEST_ASSERT_NOT_EQUAL((void*)srcA0.read, (void*)srcA1.read);
     TEST_ASSERT_NOT_EQUAL((void*)srcB0.read, (void*)srcB1.read);
 
+    // And each routes to its own instance
+    loadTdmFrames(2);
+    TEST_ASSERT_EQUAL_UINT32(2, srcA1.read(pairAOut, 2));
+    TEST_ASSERT_TRUE(tdm1.isReady());
+    TEST_ASSERT_FALSE(g_deint->isReady());
+
     tdm1.deinit();
 }
 
 // ---------------------------------------------------------------------------
-// Test 21: buildSources() with all slots full returns gracefully (null callbacks)
+// Test 21: buildSources() with the view pool full returns gracefully (null callbacks)
 // ---------------------------------------------------------------------------
 void test_tdm_deinterleaver_slot_full_buildSources_returns_gracefully(void) {
-    HalTdmDeinterleaver tdm1, tdm2;
-    AudioInputSource srcA0 = AUDIO_INPUT_SOURCE_INIT;
-    AudioInputSource srcB0 = AUDIO_INPUT_SOURCE_INIT;
-    AudioInputSource srcA1 = AUDIO_INPUT_SOURCE_INIT;
-    AudioInputSource srcB1 = AUDIO_INPUT_SOURCE_INIT;
+    const int kFit = TDM_ENGINE_MAX_VIEWS / TDM_PAIR_COUNT;
+    HalTdmDeinterleaver tdm[TDM_ENGINE_MAX_VIEWS / TDM_PAIR_COUNT];
+    AudioInputSource srcA[TDM_ENGINE_MAX_VIEWS / TDM_PAIR_COUNT];
+    AudioInputSource srcB[TDM_ENGINE_MAX_VIEWS / TDM_PAIR_COUNT];
+
+    // Fill the pool
+    for (int i = 0; i < kFit; i++) {
+        tdm[i].init(2);
+        tdm[i].buildSources("D-A", "D-B", &srcA[i], &srcB[i]);
+        TEST_ASSERT_NOT_NULL(srcA[i].read);
+        TEST_ASSERT_NOT_NULL(srcB[i].read);
+    }
+
+    // One more instance: no view available — buildSources must not crash and
+    // must leave callbacks null (indicating failure to the caller)
     AudioInputSource srcA2 = AUDIO_INPUT_SOURCE_INIT;
     AudioInputSource srcB2 = AUDIO_INPUT_SOURCE_INIT;
-
-    // Fill both slots
     g_deint->init(2);
-    g_deint->buildSources("D0-A", "D0-B", &srcA0, &srcB0);
-    tdm1.init(2);
-    tdm1.buildSources("D1-A", "D1-B", &srcA1, &srcB1);
-
-    // Third instance: all slots full — buildSources must not crash and must leave
-    // callbacks null (indicating failure to the caller)
-    tdm2.init(2);
-    tdm2.buildSources("D2-A", "D2-B", &srcA2, &srcB2);
+    g_deint->buildSources("D2-A", "D2-B", &srcA2, &srcB2);
     TEST_ASSERT_NULL(srcA2.read);
     TEST_ASSERT_NULL(srcB2.read);
 
-    tdm1.deinit();
-    // tdm2 and g_deint cleaned up by tearDown / their destructors
+    // Releasing one instance frees its views for the next
+    tdm[0].deinit();
+    g_deint->buildSources("D2-A", "D2-B", &srcA2, &srcB2);
+    TEST_ASSERT_NOT_NULL(srcA2.read);
+    TEST_ASSERT_NOT_NULL(srcB2.read);
 }
 
 // ---------------------------------------------------------------------------
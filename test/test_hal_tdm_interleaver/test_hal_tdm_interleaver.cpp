@@ -18,12 +18,12 @@
 //  14.  Frame count is respected — only 'n' TDM frames are written
 //  15.  Interleave preserves L/R order within each pair
 //  16.  Full 8-channel ordering across all frames
-//  17.  Ping-pong: after flush, _writeIdx toggles; next tick writes to the other side
+//  17.  After a flush the next tick's data replaces the previous block
 //  18.  Two ticks in sequence produce correct TDM output on each tick
 //  19.  Multiple init/deinit cycles succeed
-//  20.  First instance gets slot 0 — rebuilding after deinit reuses the slot
+//  20.  Rebuilding after deinit reacquires lane views
 //  21.  Two concurrent instances get different write function pointers
-//  22.  buildSinks() with all slots full leaves callbacks null (graceful failure)
+//  22.  buildSinks() with the view pool full leaves callbacks null (graceful failure)
 //  23.  _writePair with null buf is a no-op (does not crash)
 //  24.  _writePair with frames=0 does not flush
 //  25.  Large frame count is capped to TDM_INTERLEAVER_FRAMES
@@ -85,7 +85,8 @@ inline void i2s_port_write(uint8_t /*port*/, const void* src, size_t size,
 #include "../../src/heap_budget.cpp"
 #include "../../src/psram_alloc.cpp"
 
-// Bring in the interleaver implementation directly (native test pattern)
+// Bring in the interleaver and engine implementations directly (native test pattern)
+#include "../../src/hal/hal_tdm_engine.cpp"
 #include "../../src/hal/hal_tdm_interleaver.cpp"
 
 // ---------------------------------------------------------------------------
@@ -440,8 +441,8 @@ void test_full_8ch_ordering_all_frames(void) {
 }
 
 // ---------------------------------------------------------------------------
-// Test 17: Ping-pong — _writeIdx toggles after flush
-// Two ticks: second tick data must overwrite first tick in the other ping-pong side.
+// Test 17: After a flush the next tick's data replaces the previous block
+// Two ticks: second tick data must reach the second flush.
 // ---------------------------------------------------------------------------
 void test_pingpong_toggles_after_flush(void) {
     g_il->init(0);
@@ -459,7 +460,7 @@ void test_pingpong_toggles_after_flush(void) {
     sD.write(pairIn[3], 1);
     TEST_ASSERT_EQUAL_UINT32(1, g_txCallCount);
 
-    // Second tick: fill pair 0 with a different signature to verify buffer swap
+    // Second tick: fill pair 0 with a different signature to verify it replaces tick 1
     // Use manually crafted distinct values
     pairIn[0][0] = (int32_t)0xAA000000;  // L distinct
     pairIn[0][1] = (int32_t)0xBB000000;  // R distinct
@@ -560,32 +561,30 @@ void test_two_instances_get_different_thunks(void) {
 }
 
 // ---------------------------------------------------------------------------
-// Test 22: buildSinks() with all slots full leaves callbacks null (graceful failure)
+// Test 22: buildSinks() with the view pool full leaves callbacks null (graceful failure)
 // ---------------------------------------------------------------------------
 void test_build_sinks_slot_full_leaves_callbacks_null(void) {
-    HalTdmInterleaver il2, il3;
+    const int kFit = TDM_ENGINE_MAX_VIEWS / TDM_INTERLEAVER_PAIR_COUNT;
+    HalTdmInterleaver il[TDM_ENGINE_MAX_VIEWS / TDM_INTERLEAVER_PAIR_COUNT];
+    AudioOutputSink s[TDM_ENGINE_MAX_VIEWS / TDM_INTERLEAVER_PAIR_COUNT][4];
+
+    // Fill the pool
+    for (int i = 0; i < kFit; i++) {
+        il[i].init(0);
+        il[i].buildSinks("A", "B", "C", "D", &s[i][0], &s[i][1], &s[i][2], &s[i][3], (uint8_t)i);
+        TEST_ASSERT_NOT_NULL(s[i][0].write);
+        TEST_ASSERT_NOT_NULL(s[i][3].write);
+    }
 
-    AudioOutputSink sA0 = AUDIO_OUTPUT_SINK_INIT, sB0 = AUDIO_OUTPUT_SINK_INIT;
-    AudioOutputSink sC0 = AUDIO_OUTPUT_SINK_INIT, sD0 = AUDIO_OUTPUT_SINK_INIT;
-    AudioOutputSink sA1 = AUDIO_OUTPUT_SINK_INIT, sB1 = AUDIO_OUTPUT_SINK_INIT;
-    AudioOutputSink sC1 = AUDIO_OUTPUT_SINK_INIT, sD1 = AUDIO_OUTPUT_SINK_INIT;
+    // One more instance: no view available — callbacks must remain null
     AudioOutputSink sA2 = AUDIO_OUTPUT_SINK_INIT, sB2 = AUDIO_OUTPUT_SINK_INIT;
     AudioOutputSink sC2 = AUDIO_OUTPUT_SINK_INIT, sD2 = AUDIO_OUTPUT_SINK_INIT;
-
-    // Fill both slots
     g_il->init(0);
-    g_il->buildSinks("A0", "B0", "C0", "D0", &sA0, &sB0, &sC0, &sD0, 0);
-    il2.init(0);
-    il2.buildSinks("A1", "B1", "C1", "D1", &sA1, &sB1, &sC1, &sD1, 1);
-
-    // Third instance: no slot available — callbacks must remain null
-    il3.init(0);
-    il3.buildSinks("A2", "B2", "C2", "D2", &sA2, &sB2, &sC2, &sD2, 2);
+    g_il->buildSinks("A2", "B2", "C2", "D2", &sA2, &sB2, &sC2, &sD2, 2);
     TEST_ASSERT_NULL(sA2.write);
     TEST_ASSERT_NULL(sD2.write);
-
-    il2.deinit();
-    // il3 and g_il cleaned up by tearDown / destructors
+    TEST_ASSERT_NULL(sA2.isReady);
+    // il[] cleaned up by destructors, g_il by tearDown
 }
 
 // ---------------------------------------------------------------------------
@@ -0,0 +1,99 @@
+// test_http_cache.cpp — If-None-Match / 304 decision for embedded web assets.
+
+#include <unity.h>
+#include <string.h>
+
+#include "../../src/http_cache.h"
+#include "../../src/http_cache.cpp"
+
+static const char *ETAG = "\"f3777063084d4ce3\"";
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ===== http_etag_matches =====
+
+void test_exact_match(void) {
+    TEST_ASSERT_TRUE(http_etag_matches("\"f3777063084d4ce3\"", ETAG));
+}
+
+void test_different_tag_no_match(void) {
+    TEST_ASSERT_FALSE(http_etag_matches("\"f3777063084d4ce4\"", ETAG));
+}
+
+void test_unquoted_or_prefix_no_match(void) {
+    TEST_ASSERT_FALSE(http_etag_matches("f3777063084d4ce3", ETAG));
+    TEST_ASSERT_FALSE(http_etag_matches("\"f3777063\"", ETAG));
+    TEST_ASSERT_FALSE(http_etag_matches("\"f3777063084d4ce3\"x", ETAG));
+}
+
+void test_list_with_whitespace(void) {
+    TEST_ASSERT_TRUE(http_etag_matches("\"aaaa\", \"bbbb\" ,  \"f3777063084d4ce3\"  ", ETAG));
+    TEST_ASSERT_TRUE(http_etag_matches("\"f3777063084d4ce3\",\"aaaa\"", ETAG));
+    TEST_ASSERT_FALSE(http_etag_matches("\"aaaa\", \"bbbb\"", ETAG));
+}
+
+void test_weak_comparison(void) {
+    // Proxies may weaken a strong tag; If-None-Match uses weak comparison
+    TEST_ASSERT_TRUE(http_etag_matches("W/\"f3777063084d4ce3\"", ETAG));
+    TEST_ASSERT_TRUE(http_etag_matches("\"f3777063084d4ce3\"", "W/\"f3777063084d4ce3\""));
+}
+
+void test_wildcard(void) {
+    TEST_ASSERT_TRUE(http_etag_matches("*", ETAG));
+    TEST_ASSERT_TRUE(http_etag_matches(" * ", ETAG));
+}
+
+void test_empty_and_null(void) {
+    TEST_ASSERT_FALSE(http_etag_matches(nullptr, ETAG));
+    TEST_ASSERT_FALSE(http_etag_matches("", ETAG));
+    TEST_ASSERT_FALSE(http_etag_matches(" , ,", ETAG));
+    TEST_ASSERT_FALSE(http_etag_matches("\"f3777063084d4ce3\"", nullptr));
+    TEST_ASSERT_FALSE(http_etag_matches("*", ""));
+}
+
+// ===== http_cache_status =====
+
+void test_first_load_sends_body(void) {
+    TEST_ASSERT_EQUAL_INT(200, http_cache_status("gzip, deflate, br", "", ETAG));
+    TEST_ASSERT_EQUAL_INT(200, http_cache_status("gzip", nullptr, ETAG));
+}
+
+void test_repeat_load_not_modified(void) {
+    TEST_ASSERT_EQUAL_INT(304, http_cache_status("gzip, deflate, br", ETAG, ETAG));
+}
+
+void test_firmware_update_changes_etag(void) {
+    // Old cached tag vs new build → full body
+    TEST_ASSERT_EQUAL_INT(200, http_cache_status("gzip", "\"0123456789abcdef\"", ETAG));
+}
+
+void test_no_gzip_falls_back_without_304(void) {
+    // The ETag names the gzipped representation — never 304 a plain request
+    TEST_ASSERT_EQUAL_INT(0, http_cache_status("identity", ETAG, ETAG));
+    TEST_ASSERT_EQUAL_INT(0, http_cache_status(nullptr, ETAG, ETAG));
+}
+
+void test_no_etag_always_sends(void) {
+    TEST_ASSERT_EQUAL_INT(200, http_cache_status("gzip", "*", nullptr));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_exact_match);
+    RUN_TEST(test_different_tag_no_match);
+    RUN_TEST(test_unquoted_or_prefix_no_match);
+    RUN_TEST(test_list_with_whitespace);
+    RUN_TEST(test_weak_comparison);
+    RUN_TEST(test_wildcard);
+    RUN_TEST(test_empty_and_null);
+
+    RUN_TEST(test_first_load_sends_body);
+    RUN_TEST(test_repeat_load_not_modified);
+    RUN_TEST(test_firmware_update_changes_etag);
+    RUN_TEST(test_no_gzip_falls_back_without_304);
+    RUN_TEST(test_no_etag_always_sends);
+
+    return UNITY_END();
+}
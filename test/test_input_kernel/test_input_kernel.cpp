@@ -0,0 +1,263 @@
+// test_input_kernel.cpp
+// Fused input conditioning (audio_input_kernel.h) against the multi-pass
+// input path it replaces: trim on int32 words, DoP check on frames 0 and 1,
+// int32 -> float conversion, gate sum, then separate metering sums. Covers
+// conversion and trim, block sums and gate decisions, peaks, clip counts,
+// the all-frame DoP scan, and a native benchmark of both paths.
+//
+// The multi-pass path is replicated inline as it stood in audio_pipeline.cpp.
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+
+#include "../../src/audio_input_kernel.h"
+
+#define FRAMES 256
+#define LSB24  (1.0f / 8388607.0f)
+
+// ===== Multi-pass reference =====
+
+struct RefResult {
+    float L[FRAMES], R[FRAMES];
+    float gateSum;              // Interleaved L^2 + R^2 (noise gate)
+    float meterSumL, meterSumR; // Metering passes
+    bool dop;                   // Frames 0 and 1 only
+};
+
+static void ref_process(const int32_t *rawIn, int frames, float gain, RefResult &r) {
+    static int32_t raw[FRAMES * 2];
+    memcpy(raw, rawIn, (size_t)frames * 2 * sizeof(int32_t));
+    if (gain != 1.0f) {
+        for (int s = 0; s < frames * 2; s++) raw[s] = (int32_t)((float)raw[s] * gain);
+    }
+    uint8_t b0 = (uint8_t)((uint32_t)raw[0] >> 24);
+    uint8_t b1 = (uint8_t)((uint32_t)raw[2] >> 24);
+    r.dop = frames >= 2 && ((b0 == DOP_MARKER_A && b1 == DOP_MARKER_B) ||
+                            (b0 == DOP_MARKER_B && b1 == DOP_MARKER_A));
+    for (int f = 0; f < frames; f++) {
+        r.L[f] = (float)(raw[f * 2] >> 8) / 8388607.0f;
+        r.R[f] = (float)(raw[f * 2 + 1] >> 8) / 8388607.0f;
+    }
+    r.gateSum = 0.0f;
+    for (int f = 0; f < frames; f++) r.gateSum += r.L[f] * r.L[f] + r.R[f] * r.R[f];
+    r.meterSumL = r.meterSumR = 0.0f;
+    for (int f = 0; f < frames; f++) {
+        r.meterSumL += r.L[f] * r.L[f];
+        r.meterSumR += r.R[f] * r.R[f];
+    }
+}
+
+// ===== Signals =====
+
+static int32_t _raw[FRAMES * 2];
+static float _L[FRAMES], _R[FRAMES];
+static RefResult _ref;
+static AudioInputStats _st;
+
+static int32_t lj(float x) {
+    return (int32_t)(x * 8388607.0f) << 8;
+}
+
+static void make_sine(float ampL, float ampR, float cycles = 5.0f) {
+    for (int f = 0; f < FRAMES; f++) {
+        float ph = 2.0f * (float)M_PI * cycles * (float)f / (float)FRAMES;
+        _raw[f * 2] = lj(ampL * sinf(ph));
+        _raw[f * 2 + 1] = lj(ampR * cosf(ph));
+    }
+}
+
+// DoP v1.1 frames: marker in the top byte, 16 DSD bits below, low byte zero
+static void make_dop(uint32_t firstMarker) {
+    uint32_t m = firstMarker;
+    for (int f = 0; f < FRAMES; f++) {
+        uint32_t bits = (uint32_t)(f * 2654435761u) >> 16;
+        _raw[f * 2] = (int32_t)((m << 24) | (bits << 8));
+        _raw[f * 2 + 1] = (int32_t)((m << 24) | ((bits ^ 0xA5A5u) << 8));
+        m ^= DOP_MARKER_A ^ DOP_MARKER_B;
+    }
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ===== Golden: conversion and sums =====
+
+void test_unity_gain_matches_multipass(void) {
+    make_sine(0.5f, 0.25f);
+    ref_process(_raw, FRAMES, 1.0f, _ref);
+    audio_input_condition(_raw, _L, _R, FRAMES, 1.0f, true, _st);
+    for (int f = 0; f < FRAMES; f++) {
+        TEST_ASSERT_FLOAT_WITHIN(2e-7f, _ref.L[f], _L[f]);    // Reciprocal vs divide: 1 ulp
+        TEST_ASSERT_FLOAT_WITHIN(2e-7f, _ref.R[f], _R[f]);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(_ref.meterSumL * 1e-5f, _ref.meterSumL, _st.sumSqL);
+    TEST_ASSERT_FLOAT_WITHIN(_ref.meterSumR * 1e-5f, _ref.meterSumR, _st.sumSqR);
+    TEST_ASSERT_FLOAT_WITHIN(_ref.gateSum * 1e-5f, _ref.gateSum, _st.sumSqL + _st.sumSqR);
+    TEST_ASSERT_FALSE(_st.dop);
+    TEST_ASSERT_EQUAL(0, _st.clipped);
+}
+
+void test_trim_matches_multipass(void) {
+    const float gains[] = { 0.5f, 0.1f, 1.9953f, 0.0f };
+    make_sine(0.4f, 0.3f, 3.0f);
+    for (float g : gains) {
+        ref_process(_raw, FRAMES, g, _ref);
+        audio_input_condition(_raw, _L, _R, FRAMES, g, false, _st);
+        for (int f = 0; f < FRAMES; f++) {
+            // The reference truncates the trimmed word to 24 bits again
+            TEST_ASSERT_FLOAT_WITHIN(2.0f * LSB24, _ref.L[f], _L[f]);
+            TEST_ASSERT_FLOAT_WITHIN(2.0f * LSB24, _ref.R[f], _R[f]);
+        }
+        TEST_ASSERT_FLOAT_WITHIN(_ref.meterSumL * 1e-4f + 1e-9f, _ref.meterSumL, _st.sumSqL);
+        TEST_ASSERT_FLOAT_WITHIN(_ref.meterSumR * 1e-4f + 1e-9f, _ref.meterSumR, _st.sumSqR);
+    }
+}
+
+void test_gate_decisions_match_multipass(void) {
+    // Levels straddling the -65 / -70 dBFS gate thresholds (256-frame sums)
+    const float openThr = 1.62e-4f, closeThr = 5.12e-5f;
+    for (float db = -80.0f; db <= -55.0f; db += 0.5f) {
+        float a = powf(10.0f, db / 20.0f) * sqrtf(2.0f);
+        make_sine(a, a, 7.0f);
+        ref_process(_raw, FRAMES, 1.0f, _ref);
+        audio_input_condition(_raw, _L, _R, FRAMES, 1.0f, true, _st);
+        float sum = _st.sumSqL + _st.sumSqR;
+        TEST_ASSERT_EQUAL(_ref.gateSum >= openThr, sum >= openThr);
+        TEST_ASSERT_EQUAL(_ref.gateSum >= closeThr, sum >= closeThr);
+    }
+}
+
+void test_peaks(void) {
+    make_sine(0.5f, 0.25f);
+    _raw[17 * 2] = lj(-0.75f);
+    audio_input_condition(_raw, _L, _R, FRAMES, 1.0f, false, _st);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.75f, _st.peakL);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.25f, _st.peakR);
+    audio_input_condition(_raw, _L, _R, FRAMES, 0.5f, false, _st);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.375f, _st.peakL);   // Peaks are after trim
+}
+
+void test_clip_count_before_trim(void) {
+    make_sine(0.1f, 0.1f);
+    _raw[0] = (int32_t)0x7FFFFF00;      // +full scale L
+    _raw[11] = (int32_t)0x80000000;     // -full scale R
+    _raw[20] = (int32_t)0x7FFFF000;     // At the clip level
+    _raw[22] = (int32_t)0x7FFFE000;     // Just below
+    audio_input_condition(_raw, _L, _R, FRAMES, 0.25f, false, _st);
+    TEST_ASSERT_EQUAL(3, _st.clipped);
+    TEST_ASSERT_TRUE(_st.peakL < 0.26f);
+}
+
+void test_silence(void) {
+    memset(_raw, 0, sizeof(_raw));
+    audio_input_condition(_raw, _L, _R, FRAMES, 1.0f, true, _st);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, _st.sumSqL);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, _st.peakR);
+    TEST_ASSERT_FALSE(_st.dop);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, _L[FRAMES - 1]);
+}
+
+// ===== DoP scan =====
+
+void test_dop_detected_either_phase(void) {
+    make_dop(DOP_MARKER_A);
+    ref_process(_raw, FRAMES, 1.0f, _ref);
+    audio_input_condition(_raw, _L, _R, FRAMES, 1.0f, true, _st);
+    TEST_ASSERT_TRUE(_ref.dop);
+    TEST_ASSERT_TRUE(_st.dop);
+
+    make_dop(DOP_MARKER_B);
+    audio_input_condition(_raw, _L, _R, FRAMES, 1.0f, true, _st);
+    TEST_ASSERT_TRUE(_st.dop);
+
+    // Scan disabled (software sources)
+    audio_input_condition(_raw, _L, _R, FRAMES, 1.0f, false, _st);
+    TEST_ASSERT_FALSE(_st.dop);
+}
+
+void test_dop_broken_anywhere_rejected(void) {
+    // A single off marker late in the block, on either channel, fails the
+    // block; the frame 0/1 check cannot see it
+    const int spots[] = { 2, 3, 100, FRAMES - 1 };
+    for (int ch = 0; ch < 2; ch++) {
+        for (int f : spots) {
+            make_dop(DOP_MARKER_A);
+            _raw[f * 2 + ch] = (int32_t)(((uint32_t)_raw[f * 2 + ch] & 0x00FFFFFFu) | 0x12000000u);
+            ref_process(_raw, FRAMES, 1.0f, _ref);
+            audio_input_condition(_raw, _L, _R, FRAMES, 1.0f, true, _st);
+            TEST_ASSERT_TRUE(_ref.dop);
+            TEST_ASSERT_FALSE(_st.dop);
+        }
+    }
+}
+
+void test_pcm_with_marker_like_start_rejected(void) {
+    // Loud PCM whose first two left words happen to carry 0x05 / 0xFA
+    make_sine(0.6f, 0.6f);
+    _raw[0] = (int32_t)0x05123400;
+    _raw[2] = (int32_t)0xFA876500;
+    ref_process(_raw, FRAMES, 1.0f, _ref);
+    audio_input_condition(_raw, _L, _R, FRAMES, 1.0f, true, _st);
+    TEST_ASSERT_TRUE(_ref.dop);             // Multi-pass false positive
+    TEST_ASSERT_FALSE(_st.dop);
+}
+
+void test_short_blocks(void) {
+    make_dop(DOP_MARKER_A);
+    audio_input_condition(_raw, _L, _R, 1, 1.0f, true, _st);
+    TEST_ASSERT_FALSE(_st.dop);             // One frame cannot show alternation
+    audio_input_condition(_raw, _L, _R, 32, 1.0f, true, _st);
+    TEST_ASSERT_TRUE(_st.dop);
+    audio_input_condition(_raw, _L, _R, 0, 1.0f, true, _st);
+    TEST_ASSERT_FALSE(_st.dop);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, _st.sumSqL);
+}
+
+// ===== Benchmark =====
+
+void test_benchmark_fused_vs_multipass(void) {
+    make_sine(0.5f, 0.25f);
+    const int iters = 4000;
+    double best[2] = { 1e30, 1e30 };
+    volatile float sink = 0.0f;
+    for (int rep = 0; rep < 5; rep++) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iters; i++) {
+            ref_process(_raw, FRAMES, 0.7f, _ref);
+            sink += _ref.meterSumL;
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iters; i++) {
+            audio_input_condition(_raw, _L, _R, FRAMES, 0.7f, true, _st);
+            sink += _st.sumSqL;
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        double a = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / iters;
+        double b = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / iters;
+        if (a < best[0]) best[0] = a;
+        if (b < best[1]) best[1] = b;
+    }
+    printf("[bench] %d-frame lane: multi-pass %.0f ns, fused %.0f ns (%.2fx)\n",
+           FRAMES, best[0], best[1], best[0] / best[1]);
+    TEST_ASSERT_TRUE(best[1] < best[0]);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_unity_gain_matches_multipass);
+    RUN_TEST(test_trim_matches_multipass);
+    RUN_TEST(test_gate_decisions_match_multipass);
+    RUN_TEST(test_peaks);
+    RUN_TEST(test_clip_count_before_trim);
+    RUN_TEST(test_silence);
+    RUN_TEST(test_dop_detected_either_phase);
+    RUN_TEST(test_dop_broken_anywhere_rejected);
+    RUN_TEST(test_pcm_with_marker_like_start_rejected);
+    RUN_TEST(test_short_blocks);
+    RUN_TEST(test_benchmark_fused_vs_multipass);
+    return UNITY_END();
+}
@@ -0,0 +1,314 @@
+// test_lane_borrow.cpp
+// Zero-copy lane reads (AudioInputSource::borrow / release): the pipeline's
+// read and conditioning stages converting straight from a source's buffer
+// produce the same lane floats and statistics as the copy through _rawBuf,
+// lanes that need their raw words keep the copy, a USB ring lane is handed
+// back only after conditioning, and the bytes moved and time per block for
+// an 8-lane configuration (one 16-slot TDM port) with and without borrowing.
+//
+// The read and conditioning stages are replicated inline as in
+// audio_pipeline.cpp (pipeline_read_inputs / pipeline_condition_inputs); the
+// TDM engine, USB ring buffer and input kernel are the real ones.
+
+#include <unity.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <chrono>
+
+#ifndef NATIVE_TEST
+#define NATIVE_TEST
+#endif
+#ifndef DAC_ENABLED
+#define DAC_ENABLED
+#endif
+
+#define TDM_TEST_PROVIDES_STUBS
+
+#include "../test_mocks/Arduino.h"
+#include "../../src/tdm_kernels.h"
+#include "../../src/audio_input_kernel.h"
+
+// ===== Synthetic port =====
+
+#define LANES   8
+#define FRAMES  256
+#define SLOTS   16
+
+static uint8_t  g_rxFeed[FRAMES * SLOTS * 4];
+static uint32_t g_rxFrames = 0;
+
+inline uint32_t i2s_port_tdm_read(uint8_t, void* dst, uint32_t frames, uint16_t frameBytes) {
+    uint32_t n = g_rxFrames < frames ? g_rxFrames : frames;
+    memcpy(dst, g_rxFeed, (size_t)n * frameBytes);
+    return n;
+}
+inline bool i2s_port_is_rx_active(uint8_t) { return g_rxFrames > 0; }
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/hal/hal_tdm_engine.cpp"
+#include "../../src/usb_audio.cpp"
+
+// Slot s of frame f: a different tone per slot, 24-bit left-justified
+static void feed_port(uint32_t frames, uint32_t seed) {
+    int32_t* w = (int32_t*)g_rxFeed;
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint32_t s = 0; s < SLOTS; s++) {
+            float x = 0.5f * sinf(0.01f * (float)((f + seed) * (s + 1)));
+            w[f * SLOTS + s] = (int32_t)(x * 8388607.0f) << 8;
+        }
+    }
+    g_rxFrames = frames;
+}
+
+// ===== Pipeline replica =====
+
+struct PipeLane {
+    AudioInputSource src;
+    AudioLaneView view;
+    bool lent;
+    AudioInputStats st;
+};
+
+static PipeLane _lane[LANES];
+static int32_t _raw[LANES][FRAMES * 2];
+static float   _L[LANES][FRAMES], _R[LANES][FRAMES];
+static uint64_t _bytes;       // int32 words read or written plus float lane writes
+
+// pipeline_borrow_lane(): lane 0 (waveform tap) and DoP lanes keep the copy
+static bool borrow_lane(int lane, int frames) {
+    PipeLane& p = _lane[lane];
+    if (!p.src.borrow || lane == 0 || p.src.isDsd) return false;
+    p.lent = p.src.borrow(&p.view, (uint32_t)frames) == (uint32_t)frames;
+    return p.lent;
+}
+
+static void read_inputs(int frames, bool borrow) {
+    for (int lane = 0; lane < LANES; lane++) {
+        PipeLane& p = _lane[lane];
+        p.lent = false;
+        if (!p.src.read) continue;
+        if (borrow && borrow_lane(lane, frames)) continue;
+        uint32_t got = p.src.read(_raw[lane], (uint32_t)frames);
+        if (got < (uint32_t)frames) memset(&_raw[lane][got * 2], 0, (frames - got) * 2 * sizeof(int32_t));
+        _bytes += (uint64_t)got * 2 * sizeof(int32_t);        // Source buffer read
+        _bytes += (uint64_t)frames * 2 * sizeof(int32_t);     // _rawBuf written
+    }
+}
+
+static void condition_inputs(int frames) {
+    for (int lane = 0; lane < LANES; lane++) {
+        PipeLane& p = _lane[lane];
+        if (!p.src.read) continue;
+        if (p.lent) {
+            audio_input_condition_strided(p.view.left, p.view.right, p.view.stride, _L[lane], _R[lane],
+                                          frames, p.src.gainLinear * p.view.gain, true, p.st);
+            if (p.src.release) p.src.release((uint32_t)frames);
+            p.lent = false;
+        } else {
+            audio_input_condition(_raw[lane], _L[lane], _R[lane], frames, p.src.gainLinear, true, p.st);
+        }
+        _bytes += (uint64_t)frames * 2 * sizeof(int32_t);     // Words read by the kernel
+        _bytes += (uint64_t)frames * 2 * sizeof(float);       // Lane floats written
+    }
+}
+
+static HalTdmEngine* _eng = nullptr;
+
+// Eight stereo views of one 16-slot, 32-bit TDM port on lanes 0..7
+static void bind_tdm_lanes() {
+    static HalTdmEngine eng;
+    eng.deinit();
+    TEST_ASSERT_TRUE(eng.init(2, TDM_DIR_RX, { SLOTS, 32 }, FRAMES));
+    for (int v = 0; v < LANES; v++) {
+        TEST_ASSERT_TRUE(eng.bindSource("tdm", (uint8_t)(v * 2), (uint8_t)(v * 2 + 1), &_lane[v].src));
+    }
+    _eng = &eng;
+}
+
+void setUp(void) {
+    memset(_lane, 0, sizeof(_lane));
+    memset(_raw, 0, sizeof(_raw));
+    _bytes = 0;
+    bind_tdm_lanes();
+}
+
+void tearDown(void) {
+    if (_eng) _eng->deinit();
+}
+
+// ===== Equivalence =====
+
+static float _refL[LANES][FRAMES], _refR[LANES][FRAMES];
+static AudioInputStats _refSt[LANES];
+
+void test_lent_lanes_match_copied_lanes(void) {
+    const int sizes[] = {32, 64, 128, 256};
+    for (int s = 0; s < 4; s++) {
+        feed_port((uint32_t)sizes[s], (uint32_t)s);
+        read_inputs(sizes[s], false);
+        condition_inputs(sizes[s]);
+        memcpy(_refL, _L, sizeof(_L));
+        memcpy(_refR, _R, sizeof(_R));
+        for (int l = 0; l < LANES; l++) _refSt[l] = _lane[l].st;
+
+        memset(_L, 0, sizeof(_L));
+        memset(_R, 0, sizeof(_R));
+        read_inputs(sizes[s], true);
+        for (int l = 1; l < LANES; l++) TEST_ASSERT_TRUE(_lane[l].lent);
+        condition_inputs(sizes[s]);
+        for (int l = 0; l < LANES; l++) {
+            TEST_ASSERT_EQUAL_MEMORY(_refL[l], _L[l], sizes[s] * sizeof(float));
+            TEST_ASSERT_EQUAL_MEMORY(_refR[l], _R[l], sizes[s] * sizeof(float));
+            TEST_ASSERT_EQUAL_FLOAT(_refSt[l].sumSqL, _lane[l].st.sumSqL);
+            TEST_ASSERT_EQUAL_FLOAT(_refSt[l].peakR, _lane[l].st.peakR);
+            TEST_ASSERT_EQUAL_UINT32(_refSt[l].clipped, _lane[l].st.clipped);
+            TEST_ASSERT_EQUAL(_refSt[l].dop, _lane[l].st.dop);
+        }
+    }
+}
+
+void test_lanes_needing_raw_words_keep_the_copy(void) {
+    feed_port(FRAMES, 0);
+    _lane[3].src.isDsd = true;
+    read_inputs(FRAMES, true);
+    TEST_ASSERT_FALSE(_lane[0].lent);        // Waveform / diagnostics tap
+    TEST_ASSERT_FALSE(_lane[3].lent);        // DoP decoder and passthrough read _rawBuf
+    TEST_ASSERT_TRUE(_lane[4].lent);
+    // The copy still happened for them
+    int32_t* w = (int32_t*)g_rxFeed;
+    TEST_ASSERT_EQUAL_INT32(w[10 * SLOTS + 6], _raw[3][20]);
+    condition_inputs(FRAMES);
+}
+
+void test_short_port_block_falls_back_to_copy(void) {
+    feed_port(100, 0);
+    read_inputs(128, true);
+    for (int l = 0; l < LANES; l++) TEST_ASSERT_FALSE(_lane[l].lent);
+    // Zero-padded copy of the 100 frames the port had, one port read only
+    TEST_ASSERT_EQUAL_INT32(((int32_t*)g_rxFeed)[99 * SLOTS + 15], _raw[7][199]);
+    TEST_ASSERT_EQUAL_INT32(0, _raw[7][201]);
+    condition_inputs(128);
+}
+
+void test_dop_onset_block_is_gathered_for_the_decoder(void) {
+    feed_port(64, 0);
+    AudioLaneView v = {};
+    TEST_ASSERT_EQUAL_UINT32(64, _lane[0].src.borrow(&v, 64));
+    TEST_ASSERT_EQUAL_UINT32(64, _lane[5].src.borrow(&v, 64));
+    static int32_t gathered[FRAMES * 2], copied[FRAMES * 2];
+    audio_input_gather(v.left, v.right, v.stride, gathered, 64);
+    TEST_ASSERT_EQUAL_UINT32(64, _lane[5].src.read(copied, 64));
+    TEST_ASSERT_EQUAL_MEMORY(copied, gathered, 64 * 2 * sizeof(int32_t));
+}
+
+// ===== USB ring lane =====
+
+static UsbAudioRingBuffer _rb;
+static int32_t _rbStore[512 * 2];
+static float _usbVol = 1.0f;
+
+static uint32_t usb_read(int32_t* dst, uint32_t frames) {
+    uint32_t got = usb_rb_read(&_rb, dst, frames);
+    if (_usbVol != 1.0f) for (uint32_t i = 0; i < got * 2; i++) dst[i] = (int32_t)((float)dst[i] * _usbVol);
+    return got;
+}
+static uint32_t usb_borrow(AudioLaneView* view, uint32_t frames) {
+    const int32_t* data = nullptr;
+    if (usb_rb_peek(&_rb, &data, frames) != frames) return 0;
+    view->left = data;
+    view->right = data + 1;
+    view->stride = 2;
+    view->gain = _usbVol;
+    return frames;
+}
+static void usb_release(uint32_t frames) { usb_rb_consume(&_rb, frames); }
+
+static void fill_ring(uint32_t frames) {
+    int32_t w[2];
+    for (uint32_t f = 0; f < frames; f++) {
+        w[0] = (int32_t)(0.3f * sinf(0.02f * f) * 8388607.0f) << 8;
+        w[1] = -w[0];
+        usb_rb_write(&_rb, w, 1);
+    }
+}
+
+void test_usb_lane_is_handed_back_after_conditioning(void) {
+    usb_rb_init(&_rb, _rbStore, 512);
+    fill_ring(300);
+    _usbVol = 0.5f;
+    PipeLane& p = _lane[2];
+    memset(&p, 0, sizeof(p));
+    p.src.read = usb_read;
+    p.src.borrow = usb_borrow;
+    p.src.release = usb_release;
+    p.src.gainLinear = 1.0f;
+
+    // Reference: the copy path on the same words
+    static int32_t copy[FRAMES * 2];
+    static float refL[FRAMES], refR[FRAMES];
+    AudioInputStats st;
+    for (int i = 0; i < FRAMES * 2; i++) copy[i] = (int32_t)((float)_rbStore[i] * _usbVol);
+    audio_input_condition(copy, refL, refR, FRAMES, 1.0f, false, st);
+
+    TEST_ASSERT_TRUE(borrow_lane(2, FRAMES));
+    TEST_ASSERT_EQUAL_UINT32(300, usb_rb_available(&_rb));   // Held until conditioned
+    feed_port(FRAMES, 0);
+    condition_inputs(FRAMES);
+    TEST_ASSERT_EQUAL_UINT32(300 - FRAMES, usb_rb_available(&_rb));
+    TEST_ASSERT_EQUAL_UINT32(0, _rb.underruns);
+    for (int f = 0; f < FRAMES; f++) {
+        TEST_ASSERT_FLOAT_WITHIN(2.0f / 8388607.0f, refL[f], _L[2][f]);   // Volume folded into the scale
+        TEST_ASSERT_FLOAT_WITHIN(2.0f / 8388607.0f, refR[f], _R[2][f]);
+    }
+
+    // Read position 356 of 512: the next block wraps and is copied instead
+    static int32_t drain[100 * 2];
+    usb_rb_read(&_rb, drain, 44);
+    fill_ring(400);
+    usb_rb_read(&_rb, drain, 100);
+    TEST_ASSERT_TRUE(usb_rb_available(&_rb) >= FRAMES);
+    TEST_ASSERT_FALSE(borrow_lane(2, FRAMES));
+    _usbVol = 1.0f;
+}
+
+// ===== Benchmark =====
+
+void test_benchmark_8_lanes_bytes_and_time(void) {
+    const int iters = 2000;
+    for (int mode = 0; mode < 2; mode++) {
+        const bool borrow = mode == 1;
+        feed_port(FRAMES, 0);
+        read_inputs(FRAMES, borrow);
+        condition_inputs(FRAMES);
+        _bytes = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iters; i++) {
+            read_inputs(FRAMES, borrow);
+            condition_inputs(FRAMES);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / iters;
+        uint64_t perBlock = _bytes / iters;
+        printf("[bench] %d lanes x %d frames, %s: %llu bytes moved per block, %.0f ns per block\n",
+               LANES, FRAMES, borrow ? "lent in place (lane 0 copied)" : "copied via _rawBuf",
+               (unsigned long long)perBlock, ns);
+        // Copy: source read + _rawBuf write + _rawBuf read + floats = 4 x 2 KB per lane;
+        // lent: source read + floats = 2 x 2 KB per lane
+        const uint64_t laneBlock = (uint64_t)FRAMES * 2 * 4;
+        TEST_ASSERT_EQUAL_UINT64(borrow ? laneBlock * 2 * LANES + laneBlock * 2 : laneBlock * 4 * LANES, perBlock);
+    }
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_lent_lanes_match_copied_lanes);
+    RUN_TEST(test_lanes_needing_raw_words_keep_the_copy);
+    RUN_TEST(test_short_port_block_falls_back_to_copy);
+    RUN_TEST(test_dop_onset_block_is_gathered_for_the_decoder);
+    RUN_TEST(test_usb_lane_is_handed_back_after_conditioning);
+    RUN_TEST(test_benchmark_8_lanes_bytes_and_time);
+    return UNITY_END();
+}
@@ -21,6 +21,9 @@ namespace WireMock {
     // EEPROM-style register address tracking (repeated start pattern)
     static uint8_t lastRegAddr;
     static bool hasRegAddr;
+    // Bus traffic counters (write transactions / read requests)
+    static int txCount = 0;
+    static int rxCount = 0;
 
     inline void reset() {
         registerMap.clear();
@@ -31,6 +34,8 @@ namespace WireMock {
         rxIndex = 0;
         lastRegAddr = 0;
         hasRegAddr = false;
+        txCount = 0;
+        rxCount = 0;
         memset(busInitialized, 0, sizeof(busInitialized));
         for (int i = 0; i < 3; i++) { pinSDA[i] = -1; pinSCL[i] = -1; }
         addressToBusIndex.clear();
@@ -94,6 +99,7 @@ public:
 
     uint8_t endTransmission(bool sendStop = true) {
         if (!WireMock::txInProgress) return 5;
+        WireMock::txCount++;
         // Address not registered -> NACK
         if (WireMock::addressToBusIndex.find(WireMock::currentAddr) ==
             WireMock::addressToBusIndex.end()) {
@@ -119,6 +125,7 @@ public:
 
     uint8_t requestFrom(uint8_t addr, uint8_t len, bool stop = true) {
         (void)stop;
+        WireMock::rxCount++;
         if (WireMock::addressToBusIndex.find(addr) == WireMock::addressToBusIndex.end()) return 0;
         WireMock::rxBuffer.clear();
         // Use stored register address from repeated start, or 0 as default
@@ -65,6 +65,7 @@ const char* stage_type_name(DspStageType t) {
 // Module under test — psram_alloc/heap_budget needed since output_dsp uses psram_alloc()
 #include "../../src/heap_budget.cpp"
 #include "../../src/psram_alloc.cpp"
+#include "../../src/dsp_convolution.cpp"
 #include "../../src/output_dsp.cpp"
 
 // ===== Helpers =====
@@ -653,6 +654,71 @@ void test_crossover_swap_to_active() {
     TEST_ASSERT_EQUAL(DSP_BIQUAD_HPF, mainCh.stages[0].type);
 }
 
+// ===== Test 21: Binary image round trip =====
+
+static uint8_t _imageBuf[OUTPUT_DSP_IMAGE_MAX_BYTES];
+
+void test_image_roundtrip_restores_stages_and_taps() {
+    OutputDspState *inactive = output_dsp_get_inactive_config();
+    int g = output_dsp_add_stage(0, DSP_GAIN);
+    inactive->channels[0].stages[g].gain.gainDb = 6.0f;
+    int d = output_dsp_add_stage(1, DSP_DELAY);
+    inactive->channels[1].stages[d].delay.delaySamples = 42;
+    inactive->channels[1].stages[d].delay.writePos = 17;
+    inactive->channels[3].bypass = false;
+    TEST_ASSERT_GREATER_OR_EQUAL(0, output_dsp_add_stage(3, DSP_FIR));
+    float taps[32];
+    for (int i = 0; i < 32; i++) taps[i] = 0.01f * (float)(i + 1);
+    TEST_ASSERT_TRUE(output_dsp_set_fir_taps(3, taps, 32));
+    output_dsp_swap_config();
+
+    size_t len = output_dsp_image_pack(_imageBuf, sizeof(_imageBuf));
+    TEST_ASSERT_GREATER_THAN(0, (int)len);
+
+    output_dsp_init();  // Reboot: defaults everywhere
+    TEST_ASSERT_TRUE(output_dsp_image_unpack(_imageBuf, len));
+
+    OutputDspState *active = output_dsp_get_active_config();
+    TEST_ASSERT_EQUAL_UINT8(1, active->channels[0].stageCount);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 6.0f, active->channels[0].stages[0].gain.gainDb);
+    TEST_ASSERT_EQUAL_UINT16(42, active->channels[1].stages[0].delay.delaySamples);
+    TEST_ASSERT_EQUAL_UINT16(0, active->channels[1].stages[0].delay.writePos);
+    TEST_ASSERT_FALSE(active->channels[3].bypass);
+    TEST_ASSERT_EQUAL(DSP_FIR, active->channels[3].stages[0].type);
+    TEST_ASSERT_EQUAL_UINT16(32, active->channels[3].stages[0].fir.numTaps);
+
+    // FIR taps are back in both states, so the next swap keeps them
+    for (int st = 0; st < 2; st++)
+        TEST_ASSERT_EQUAL_FLOAT_ARRAY(taps, _out_fir_taps(st, 3), 32);
+
+    // And the restored FIR runs: an impulse returns the taps
+    float buf[64];
+    memset(buf, 0, sizeof(buf));
+    buf[0] = 1.0f;
+    output_dsp_process(3, buf, 64);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, taps[0], buf[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, taps[31], buf[31]);
+}
+
+// ===== Test 22: Image with a foreign layout is refused =====
+
+void test_image_rejects_mismatched_layout() {
+    output_dsp_add_stage(0, DSP_GAIN);
+    output_dsp_swap_config();
+    size_t len = output_dsp_image_pack(_imageBuf, sizeof(_imageBuf));
+    TEST_ASSERT_GREATER_THAN(0, (int)len);
+
+    OutputDspImageHeader hdr;
+    memcpy(&hdr, _imageBuf, sizeof(hdr));
+    hdr.stageBytes++;
+    memcpy(_imageBuf, &hdr, sizeof(hdr));
+    output_dsp_init();
+    TEST_ASSERT_FALSE(output_dsp_image_unpack(_imageBuf, len));
+    TEST_ASSERT_FALSE(output_dsp_image_unpack(_imageBuf, len - 1));
+    // Config untouched: still the defaults
+    TEST_ASSERT_EQUAL_UINT8(0, output_dsp_get_active_config()->channels[0].stageCount);
+}
+
 // ===== Main =====
 
 int main() {
@@ -677,5 +743,7 @@ int main() {
     RUN_TEST(test_delay_ms_to_samples_conversion);
     RUN_TEST(test_delay_find_or_create_updates_existing);
     RUN_TEST(test_crossover_swap_to_active);
+    RUN_TEST(test_image_roundtrip_restores_stages_and_taps);
+    RUN_TEST(test_image_rejects_mismatched_layout);
     return UNITY_END();
 }
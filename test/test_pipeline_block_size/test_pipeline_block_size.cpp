@@ -0,0 +1,295 @@
+// test_pipeline_block_size.cpp
+// Runtime-selectable pipeline block size: the full processing chain (ADC
+// int32 → float, input DSP with filters, dynamics, FIR, convolution, delay
+// and a decimated section, routing matrix, output DSP, float → int32 DAC)
+// run at 32, 64 and 128 frames per block produces exactly the same DAC
+// words as the 256-frame reference, and a native benchmark of the per-block overhead
+// at each size (fitted with AudioBlockCost).
+//
+// The pipeline edges and the matrix are replicated inline as in
+// test_audio_pipeline; the DSP engines are the real ones.
+
+#define OUTPUT_DSP_MAX_CHANNELS 8
+#define OUTPUT_DSP_MAX_STAGES 12
+#define OUTPUT_DSP_MAX_DELAY_SAMPLES 4800
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "../../lib/esp_dsp_lite/src/dsps_biquad_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_init_f32.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fird_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_corr_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_conv_f32_ansi.c"
+#include "../../src/dsp_biquad_gen.c"
+
+#include "../../src/dsp_pipeline.h"
+#include "../../src/dsp_coefficients.h"
+#include "../../src/audio_scheduler.h"
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/dsp_coefficients.cpp"
+#include "../../src/dsp_pipeline.cpp"
+#include "../../src/dsp_crossover.cpp"
+#include "../../src/dsp_convolution.cpp"
+#include "../../src/thd_measurement.cpp"
+#include "../../src/output_dsp.cpp"
+
+#define FRAMES_MAX  AUDIO_BLOCK_FRAMES_MAX
+#define TOTAL       (FRAMES_MAX * 24)
+#define IR_LEN      300                 // Longer than every block size
+
+static int32_t _adc[TOTAL * 2];         // Interleaved L/R, 24-bit left-justified
+static int32_t _ref[TOTAL * 2];
+static int32_t _out[TOTAL * 2];
+static float _fir[48];
+static float _ir[IR_LEN];
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ===== Signal =====
+
+// Noise bursts, silences and a tone so gates, compressors and limiters move
+// through attack, hold and release; segment lengths are not multiples of
+// any block size
+static void make_adc() {
+    uint32_t s = 0x2468aceu;
+    for (int f = 0; f < TOTAL; f++) {
+        int seg = f / 700;
+        float level = (seg % 5 == 4) ? 0.002f : (seg % 3 == 0 ? 2.5f : 0.8f);
+        for (int c = 0; c < 2; c++) {
+            s = s * 1664525u + 1013904223u;
+            float n = 0.25f * ((float)(s >> 8) / 8388608.0f - 1.0f);
+            float v = n * level + 0.2f * sinf((c ? 0.017f : 0.031f) * (float)f);
+            if (v > 0.99f) v = 0.99f;
+            if (v < -0.99f) v = -0.99f;
+            _adc[f * 2 + c] = (int32_t)(v * 8388607.0f) << 8;
+        }
+    }
+}
+
+static void make_filters() {
+    for (int i = 0; i < 48; i++) {
+        float t = (float)i - 23.5f;
+        _fir[i] = 0.12f * sinf(0.35f * t) / (0.35f * t) * (0.54f - 0.46f * cosf(6.2831853f * i / 47.0f));
+    }
+    for (int i = 0; i < IR_LEN; i++) _ir[i] = (i == 0 ? 0.7f : 0.0f) + 0.2f * expf(-0.02f * i) * sinf(0.4f * i);
+}
+
+// ===== Pipeline Edges (mirror audio_pipeline.cpp) =====
+
+static inline float clampf(float v) { return v > 1.0f ? 1.0f : (v < -1.0f ? -1.0f : v); }
+
+static void to_float(const int32_t *raw, float *L, float *R, int frames) {
+    for (int f = 0; f < frames; f++) {
+        L[f] = (float)(raw[f * 2]     >> 8) / 8388607.0f;
+        R[f] = (float)(raw[f * 2 + 1] >> 8) / 8388607.0f;
+    }
+}
+
+static void to_int32_lj(const float *L, const float *R, int32_t *raw, int frames) {
+    for (int f = 0; f < frames; f++) {
+        raw[f * 2]     = (int32_t)(clampf(L[f]) * 8388607.0f) << 8;
+        raw[f * 2 + 1] = (int32_t)(clampf(R[f]) * 8388607.0f) << 8;
+    }
+}
+
+// ===== Chain =====
+
+static DspStage &add_input(int ch, DspStageType type) {
+    int idx = dsp_add_stage(ch, type);
+    TEST_ASSERT_TRUE(idx >= 0);
+    DspStage &s = dsp_get_inactive_config()->channels[ch].stages[idx];
+    return s;
+}
+
+static void set_biquad(DspBiquadParams &b, DspStageType type, float hz, float gain, float q, uint32_t rate) {
+    b.frequency = hz; b.gain = gain; b.Q = q;
+    dsp_compute_biquad_coeffs(b, type, rate);
+}
+
+// Input L: HPF, PEQ, compressor, FIR, convolution, fractional delay,
+// limiter. Input R: PEQ, a /4 section with a low-pass, gain.
+// Output 0: PEQ, noise gate, delay, true-peak limiter. Output 1: gain.
+static void build_chain() {
+    dsp_init();
+    output_dsp_init();
+    for (int i = 0; i < CONV_MAX_IR_SLOTS; i++) dsp_conv_free_slot(i);
+    make_filters();
+
+    DspState *in = dsp_get_inactive_config();
+    const uint32_t rate = in->sampleRate;
+    in->channels[0].bypass = false;
+    in->channels[1].bypass = false;
+
+    set_biquad(add_input(0, DSP_BIQUAD_HPF).biquad, DSP_BIQUAD_HPF, 45.0f, 0.0f, 0.707f, rate);
+    set_biquad(add_input(0, DSP_BIQUAD_PEQ).biquad, DSP_BIQUAD_PEQ, 1200.0f, 4.5f, 1.4f, rate);
+    DspStage &comp = add_input(0, DSP_COMPRESSOR);
+    comp.compressor.thresholdDb = -18.0f; comp.compressor.ratio = 3.0f;
+    comp.compressor.kneeDb = 6.0f; comp.compressor.makeupGainDb = 2.0f;
+    dsp_compute_compressor_makeup(comp.compressor);
+    DspStage &fir = add_input(0, DSP_FIR);
+    for (int st = 0; st < 2; st++) memcpy(dsp_fir_get_taps(st, fir.fir.firSlot), _fir, sizeof(_fir));
+    fir.fir.numTaps = 48;
+    dsp_fir_commit_taps(fir.fir.firSlot, 48);
+    DspStage &conv = add_input(0, DSP_CONVOLUTION);
+    TEST_ASSERT_EQUAL_INT(0, dsp_conv_init_slot(0, _ir, IR_LEN));
+    conv.convolution.convSlot = 0;
+    conv.convolution.irLength = IR_LEN;
+    DspStage &dl = add_input(0, DSP_DELAY);
+    dl.delay.delaySamples = 37;
+    dsp_delay_set_fraction(dl.delay, 0.4f, DSP_DELAY_INTERP_LAGRANGE);
+    add_input(0, DSP_LIMITER).limiter.thresholdDb = -3.0f;
+
+    set_biquad(add_input(1, DSP_BIQUAD_PEQ).biquad, DSP_BIQUAD_PEQ, 300.0f, -3.0f, 0.9f, rate);
+    add_input(1, DSP_DECIMATOR).decimator.factor = 4;
+    set_biquad(add_input(1, DSP_BIQUAD_LPF).biquad, DSP_BIQUAD_LPF, 2500.0f, 0.0f, 0.707f, rate);
+    add_input(1, DSP_INTERPOLATOR);
+    DspStage &g = add_input(1, DSP_GAIN);
+    g.gain.gainDb = -4.0f;
+    dsp_compute_gain_linear(g.gain);             // Ramps from unity
+
+    OutputDspState *out = output_dsp_get_inactive_config();
+    out->channels[0].bypass = false;
+    out->channels[1].bypass = false;
+    OutputDspStage &peq = out->channels[0].stages[output_dsp_add_stage(0, DSP_BIQUAD_PEQ)];
+    set_biquad(peq.biquad, DSP_BIQUAD_PEQ, 80.0f, 3.0f, 0.8f, out->sampleRate);
+    OutputDspStage &gate = out->channels[0].stages[output_dsp_add_stage(0, DSP_NOISE_GATE)];
+    gate.noiseGate.thresholdDb = -45.0f; gate.noiseGate.holdMs = 5.0f; gate.noiseGate.rangeDb = -60.0f;
+    OutputDspStage &od = out->channels[0].stages[output_dsp_add_stage(0, DSP_DELAY)];
+    od.delay.delaySamples = 91;
+    OutputDspStage &tp = out->channels[0].stages[output_dsp_add_stage(0, DSP_TRUE_PEAK_LIMITER)];
+    tp.truePeak.ceilingDb = -1.5f; tp.truePeak.linked = false;
+    OutputDspStage &og = out->channels[1].stages[output_dsp_add_stage(1, DSP_GAIN)];
+    og.gain.gainDb = 2.0f;
+    dsp_compute_gain_linear(og.gain);
+
+    TEST_ASSERT_TRUE(dsp_swap_config());
+    TEST_ASSERT_TRUE(output_dsp_swap_config());
+}
+
+// Run TOTAL frames through the chain `block` frames at a time
+static void run_pipeline(int block, int32_t *dac) {
+    build_chain();
+    static float L[FRAMES_MAX], R[FRAMES_MAX], o0[FRAMES_MAX], o1[FRAMES_MAX];
+    for (int pos = 0; pos < TOTAL; pos += block) {
+        to_float(&_adc[pos * 2], L, R, block);
+        dsp_process_buffer_float(L, R, block, 0);
+        for (int f = 0; f < block; f++) {      // Matrix: out0 = L + 0.3 R, out1 = R
+            o0[f] = L[f] + 0.3f * R[f];
+            o1[f] = R[f];
+        }
+        output_dsp_process(0, o0, block);
+        output_dsp_process(1, o1, block);
+        to_int32_lj(o0, o1, &dac[pos * 2], block);
+    }
+}
+
+// Peak DAC level in 24-bit LSBs
+static int peak_lsb(const int32_t *a, int samples) {
+    int peak = 0;
+    for (int i = 0; i < samples; i++) {
+        if (abs(a[i] >> 8) > peak) peak = abs(a[i] >> 8);
+    }
+    return peak;
+}
+
+// Index of the first differing DAC word, -1 if identical
+static int first_diff(const int32_t *a, const int32_t *b, int samples) {
+    for (int i = 0; i < samples; i++) {
+        if (a[i] != b[i]) return i;
+    }
+    return -1;
+}
+
+// ===== Block Size Equivalence =====
+
+static void check_block_matches_reference(int block) {
+    make_adc();
+    run_pipeline(FRAMES_MAX, _ref);
+    run_pipeline(block, _out);
+    TEST_ASSERT_TRUE(peak_lsb(_ref, TOTAL * 2) > 8388607 / 20);   // Signal made it through
+    TEST_ASSERT_EQUAL_INT(-1, first_diff(_ref, _out, TOTAL * 2));
+}
+
+void test_block_32_matches_reference(void)  { check_block_matches_reference(32); }
+void test_block_64_matches_reference(void)  { check_block_matches_reference(64); }
+void test_block_128_matches_reference(void) { check_block_matches_reference(128); }
+
+void test_reference_is_deterministic(void) {
+    make_adc();
+    run_pipeline(FRAMES_MAX, _ref);
+    run_pipeline(FRAMES_MAX, _out);
+    TEST_ASSERT_EQUAL_INT(-1, first_diff(_ref, _out, TOTAL * 2));
+}
+
+void test_convolution_tail_spans_small_blocks(void) {
+    // An impulse at 32-frame blocks: the response to the first partition
+    // (CONV_PARTITION_SIZE taps) crosses eight blocks and comes out intact
+    for (int i = 0; i < CONV_MAX_IR_SLOTS; i++) dsp_conv_free_slot(i);
+    make_filters();
+    TEST_ASSERT_EQUAL_INT(0, dsp_conv_init_slot(0, _ir, IR_LEN));
+    static float buf[IR_LEN + 64];
+    memset(buf, 0, sizeof(buf));
+    buf[5] = 1.0f;
+    for (int pos = 0; pos + 32 <= (int)(sizeof(buf) / sizeof(buf[0])); pos += 32) {
+        dsp_conv_process(0, &buf[pos], 32);
+    }
+    for (int i = 0; i < CONV_PARTITION_SIZE; i++) TEST_ASSERT_EQUAL_FLOAT(_ir[i], buf[5 + i]);
+    dsp_conv_free_slot(0);
+}
+
+void test_convolution_rejects_oversized_block(void) {
+    for (int i = 0; i < CONV_MAX_IR_SLOTS; i++) dsp_conv_free_slot(i);
+    make_filters();
+    TEST_ASSERT_EQUAL_INT(0, dsp_conv_init_slot(0, _ir, IR_LEN));
+    static float buf[CONV_PARTITION_SIZE * 2];
+    for (int i = 0; i < CONV_PARTITION_SIZE * 2; i++) buf[i] = 0.5f;
+    dsp_conv_process(0, buf, CONV_PARTITION_SIZE * 2);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, buf[0]);                   // Untouched
+    dsp_conv_free_slot(0);
+}
+
+// ===== Benchmark =====
+
+void test_benchmark_per_block_overhead(void) {
+    make_adc();
+    AudioBlockCost cost = {};
+    for (int i = 0; i < AUDIO_BLOCK_SIZES; i++) {
+        const int block = AUDIO_BLOCK_FRAMES_MIN << i;
+        run_pipeline(block, _out);                           // Warm-up, fresh state
+        auto t0 = std::chrono::steady_clock::now();
+        run_pipeline(block, _out);
+        auto t1 = std::chrono::steady_clock::now();
+        double us = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / 1000.0;
+        float perBlock = (float)(us / (TOTAL / block));
+        audio_block_cost_add(cost, block, perBlock);
+        printf("[bench] block=%3d: %.2f us/block, %.1f ns/frame\n",
+               block, perBlock, 1000.0 * us / TOTAL);
+    }
+    float overheadUs = 0.0f, perFrameUs = 0.0f;
+    TEST_ASSERT_TRUE(audio_block_cost_fit(cost, overheadUs, perFrameUs));
+    printf("[bench] fitted per-block overhead %.2f us, %.1f ns/frame\n",
+           overheadUs, 1000.0f * perFrameUs);
+    TEST_ASSERT_TRUE(perFrameUs > 0.0f);
+    TEST_ASSERT_TRUE(overheadUs >= 0.0f);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_reference_is_deterministic);
+    RUN_TEST(test_block_32_matches_reference);
+    RUN_TEST(test_block_64_matches_reference);
+    RUN_TEST(test_block_128_matches_reference);
+    RUN_TEST(test_convolution_tail_spans_small_blocks);
+    RUN_TEST(test_convolution_rejects_oversized_block);
+    RUN_TEST(test_benchmark_per_block_overhead);
+    return UNITY_END();
+}
@@ -669,11 +669,21 @@ struct PipelineTimingMetrics {
     uint32_t perInputDspUs;
     uint32_t sinkWriteUs;
     uint32_t totalE2eUs;
+    // DMA-driven scheduling
+    uint32_t inOutLatencyUs;
+    int32_t  deadlineSlackUs;
+    int32_t  minSlackUs;
+    uint32_t missedDeadlines;
+    uint32_t droppedBlocks;
+    uint32_t dmaRecoveries;
+    uint8_t  latencyProfile;
+    uint16_t blockFrames;
+    float    blockOverheadUs;
 };
 // Guard: if fields are added/removed/reordered in audio_pipeline.h, this will
 // fail to compile and alert the developer to update the replica above.
-// 8 fields: 7 x uint32_t (28) + 1 x float (4) = 32 bytes (no padding on common ABIs).
-static_assert(sizeof(PipelineTimingMetrics) == 32, "PipelineTimingMetrics layout changed — update replica from audio_pipeline.h");
+// 17 fields: 13 x uint32_t/int32_t (52) + 2 x float (8) + uint8_t (1) + 1 padding + uint16_t (2) = 64 bytes.
+static_assert(sizeof(PipelineTimingMetrics) == 64, "PipelineTimingMetrics layout changed — update replica from audio_pipeline.h");
 
 // Native stub for audio_pipeline_get_timing() — returns zero-initialized struct.
 static PipelineTimingMetrics stub_audio_pipeline_get_timing() {
@@ -696,6 +706,11 @@ void test_timing_metrics_fields_exist(void) {
     m.perInputDspUs = 20;
     m.sinkWriteUs = 30;
     m.totalE2eUs = 400;
+    m.inOutLatencyUs = 9000;
+    m.deadlineSlackUs = -150;
+    m.latencyProfile = 2;
+    m.blockFrames = 32;
+    m.blockOverheadUs = 41.5f;
 
     TEST_ASSERT_EQUAL_UINT32(123, m.totalFrameUs);
     TEST_ASSERT_EQUAL_UINT32(45, m.matrixMixUs);
@@ -705,6 +720,11 @@ void test_timing_metrics_fields_exist(void) {
     TEST_ASSERT_EQUAL_UINT32(20, m.perInputDspUs);
     TEST_ASSERT_EQUAL_UINT32(30, m.sinkWriteUs);
     TEST_ASSERT_EQUAL_UINT32(400, m.totalE2eUs);
+    TEST_ASSERT_EQUAL_UINT32(9000, m.inOutLatencyUs);
+    TEST_ASSERT_EQUAL_INT32(-150, m.deadlineSlackUs);
+    TEST_ASSERT_EQUAL_UINT8(2, m.latencyProfile);
+    TEST_ASSERT_EQUAL_UINT16(32, m.blockFrames);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 41.5f, m.blockOverheadUs);
 }
 
 // 7b. PipelineTimingMetrics zero-initialized by default
@@ -722,9 +742,9 @@ void test_timing_metrics_initial_zero(void) {
     TEST_ASSERT_EQUAL_UINT32(0, m.totalE2eUs);
 }
 
-// 7c. Struct size is exact (8 fields: 7 x uint32_t + 1 x float = 32 bytes)
+// 7c. Struct size is exact (17 fields, 64 bytes)
 void test_timing_metrics_struct_size(void) {
-    TEST_ASSERT_EQUAL(32, sizeof(PipelineTimingMetrics));
+    TEST_ASSERT_EQUAL(64, sizeof(PipelineTimingMetrics));
 }
 
 // 7d. Getter API returns a zeroed struct (simulates native no-op)
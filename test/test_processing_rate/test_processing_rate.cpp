@@ -0,0 +1,488 @@
+// test_processing_rate.cpp
+// Selectable internal processing rate (audio_rate_convert.h): rate
+// resolution and the block split between the I/O and processing rates, the
+// 2x half-band converters (DC gain, passband flatness, image and alias
+// rejection, block independence, round-trip latency), the end-to-end
+// frequency response of the processing chain run at 96 kHz between 48 kHz
+// I/O against the response its filters were designed for, and a native
+// benchmark of the CPU cost per second of audio at each processing rate.
+//
+// The pipeline edges (lane and sink conversion, matrix) are replicated inline
+// as in test_pipeline_block_size; the converters and DSP engines are the
+// real ones.
+
+#define OUTPUT_DSP_MAX_CHANNELS 8
+#define OUTPUT_DSP_MAX_STAGES 12
+#define OUTPUT_DSP_MAX_DELAY_SAMPLES 4800
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "../../lib/esp_dsp_lite/src/dsps_biquad_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fir_init_f32.c"
+#include "../../lib/esp_dsp_lite/src/dsps_fird_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_corr_f32_ansi.c"
+#include "../../lib/esp_dsp_lite/src/dsps_conv_f32_ansi.c"
+#include "../../src/dsp_biquad_gen.c"
+
+#include "../../src/dsp_pipeline.h"
+#include "../../src/dsp_coefficients.h"
+#include "../../src/audio_scheduler.h"
+#include "../../src/audio_rate_convert.h"
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/dsp_coefficients.cpp"
+#include "../../src/dsp_pipeline.cpp"
+#include "../../src/dsp_crossover.cpp"
+#include "../../src/dsp_convolution.cpp"
+#include "../../src/thd_measurement.cpp"
+#include "../../src/output_dsp.cpp"
+
+#define FRAMES_MAX  AUDIO_BLOCK_FRAMES_MAX
+#define IO_RATE     48000
+#define WARMUP      24576               // 0.5 s: filters and coefficient morphs settle
+#define MEASURE     8192                // Tone frequencies sit on bins of this length
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ===== Measurement =====
+
+static const double kPi = 3.14159265358979323846;
+
+// Frequency of DFT bin k over MEASURE samples at IO_RATE
+static double bin_hz(int k) { return (double)k * IO_RATE / MEASURE; }
+
+// Amplitude of the bin-k component of x (exact for a steady tone on the bin)
+static double tone_amplitude(const float *x, int k) {
+    double c = 0.0, s = 0.0;
+    for (int n = 0; n < MEASURE; n++) {
+        double w = 2.0 * kPi * k * n / MEASURE;
+        c += x[n] * cos(w);
+        s += x[n] * sin(w);
+    }
+    return 2.0 * sqrt(c * c + s * s) / MEASURE;
+}
+
+static double db(double x) { return 20.0 * log10(x); }
+
+// |H(f)| of one biquad designed for rate
+static double biquad_mag(DspStageType type, float hz, float gain, float q, double f, uint32_t rate) {
+    DspBiquadParams b = {};
+    b.frequency = hz; b.gain = gain; b.Q = q;
+    dsp_compute_biquad_coeffs(b, type, rate);
+    const double w = 2.0 * kPi * f / rate;
+    const double cr = cos(w), ci = -sin(w), c2r = cos(2 * w), c2i = -sin(2 * w);
+    const double nr = b.coeffs[0] + b.coeffs[1] * cr + b.coeffs[2] * c2r;
+    const double ni = b.coeffs[1] * ci + b.coeffs[2] * c2i;
+    const double dr = 1.0 + b.coeffs[3] * cr + b.coeffs[4] * c2r;
+    const double di = b.coeffs[3] * ci + b.coeffs[4] * c2i;
+    return sqrt((nr * nr + ni * ni) / (dr * dr + di * di));
+}
+
+// ===== Chain =====
+
+// Input L: HPF 40 Hz, PEQ 1 kHz +6 dB, LPF 16 kHz. Output 0: PEQ 8 kHz
+// +3 dB. Built at 48 kHz and, for another processing rate, restaged there
+// and published as the audio task does at start (dsp_prepare_sample_rate).
+static void build_chain(uint32_t procRate) {
+    dsp_init();
+    output_dsp_init();
+
+    DspState *in = dsp_get_inactive_config();
+    in->channels[0].bypass = false;
+    in->channels[1].bypass = false;
+    DspStage *s;
+    s = &in->channels[0].stages[dsp_add_stage(0, DSP_BIQUAD_HPF)];
+    s->biquad.frequency = 40.0f;   s->biquad.Q = 0.707f;
+    dsp_compute_biquad_coeffs(s->biquad, DSP_BIQUAD_HPF, in->sampleRate);
+    s = &in->channels[0].stages[dsp_add_stage(0, DSP_BIQUAD_PEQ)];
+    s->biquad.frequency = 1000.0f; s->biquad.gain = 6.0f; s->biquad.Q = 1.0f;
+    dsp_compute_biquad_coeffs(s->biquad, DSP_BIQUAD_PEQ, in->sampleRate);
+    s = &in->channels[0].stages[dsp_add_stage(0, DSP_BIQUAD_LPF)];
+    s->biquad.frequency = 16000.0f; s->biquad.Q = 0.707f;
+    dsp_compute_biquad_coeffs(s->biquad, DSP_BIQUAD_LPF, in->sampleRate);
+
+    OutputDspState *out = output_dsp_get_inactive_config();
+    out->channels[0].bypass = false;
+    out->channels[1].bypass = false;
+    OutputDspStage &peq = out->channels[0].stages[output_dsp_add_stage(0, DSP_BIQUAD_PEQ)];
+    peq.biquad.frequency = 8000.0f; peq.biquad.gain = 3.0f; peq.biquad.Q = 1.5f;
+    dsp_compute_biquad_coeffs(peq.biquad, DSP_BIQUAD_PEQ, out->sampleRate);
+
+    TEST_ASSERT_TRUE(dsp_swap_config());
+    TEST_ASSERT_TRUE(output_dsp_swap_config());
+
+    if (procRate != dsp_get_active_config()->sampleRate) {
+        dsp_prepare_sample_rate(procRate);
+        output_dsp_prepare_sample_rate(procRate);
+        TEST_ASSERT_TRUE(dsp_swap_config());
+        TEST_ASSERT_TRUE(output_dsp_swap_config());
+    }
+}
+
+// Designed response of the chain's left path at the processing rate
+static double chain_mag(double f, uint32_t rate) {
+    return biquad_mag(DSP_BIQUAD_HPF, 40.0f, 0.0f, 0.707f, f, rate) *
+           biquad_mag(DSP_BIQUAD_PEQ, 1000.0f, 6.0f, 1.0f, f, rate) *
+           biquad_mag(DSP_BIQUAD_LPF, 16000.0f, 0.0f, 0.707f, f, rate) *
+           biquad_mag(DSP_BIQUAD_PEQ, 8000.0f, 3.0f, 1.5f, f, rate);
+}
+
+// Pipeline edges for one lane and one I/O-rate sink (mirror audio_pipeline.cpp)
+struct Chain {
+    uint32_t procRate;
+    AudioBlockPlan plan;
+    AudioRateStep laneStep, sinkStep;
+    AudioHalfbandState laneHb[2], sinkHb[2];
+};
+
+static void chain_init(Chain &c, uint32_t procRequest, int block = FRAMES_MAX) {
+    c.procRate = audio_proc_rate_resolve(IO_RATE, procRequest);
+    c.plan = audio_block_plan((uint32_t)block, IO_RATE, c.procRate, FRAMES_MAX);
+    c.laneStep = audio_rate_step(IO_RATE, c.procRate);
+    c.sinkStep = audio_sink_step(c.plan.procFrames, c.procRate, IO_RATE, FRAMES_MAX);
+    for (int i = 0; i < 2; i++) {
+        audio_hb_reset(c.laneHb[i]);
+        audio_hb_reset(c.sinkHb[i]);
+    }
+    build_chain(c.procRate);
+}
+
+// One block: plan.ioFrames in, the sink's frames out
+static int chain_block(Chain &c, const float *inL, const float *inR, float *outL, float *outR) {
+    static float L[FRAMES_MAX], R[FRAMES_MAX], o0[FRAMES_MAX], o1[FRAMES_MAX];
+    const int io = c.plan.ioFrames;
+    memcpy(L, inL, io * sizeof(float));
+    memcpy(R, inR, io * sizeof(float));
+    audio_rate_convert(c.laneHb[0], c.laneStep, L, L, io);
+    audio_rate_convert(c.laneHb[1], c.laneStep, R, R, io);
+    const int n = c.plan.procFrames;
+    dsp_process_buffer_float(L, R, n, 0);
+    memcpy(o0, L, n * sizeof(float));             // Matrix: identity
+    memcpy(o1, R, n * sizeof(float));
+    output_dsp_process(0, o0, n);
+    output_dsp_process(1, o1, n);
+    int m = audio_rate_convert(c.sinkHb[0], c.sinkStep, o0, outL, n);
+    audio_rate_convert(c.sinkHb[1], c.sinkStep, o1, outR, n);
+    return m;
+}
+
+static float _inL[WARMUP + MEASURE], _inR[WARMUP + MEASURE];
+static float _outL[WARMUP + MEASURE], _outR[WARMUP + MEASURE];
+
+// Run _inL/_inR (frames at the I/O rate) through the chain
+static void chain_run(Chain &c, int frames) {
+    int got = 0;
+    for (int pos = 0; pos < frames; pos += c.plan.ioFrames) {
+        got += chain_block(c, &_inL[pos], &_inR[pos], &_outL[got], &_outR[got]);
+    }
+    TEST_ASSERT_EQUAL_INT(frames, got);
+}
+
+// ===== Rate Resolution and Block Plan =====
+
+void test_processing_rate_resolves_against_io_rate(void) {
+    TEST_ASSERT_EQUAL_UINT32(48000, audio_proc_rate_resolve(48000, AUDIO_PROC_RATE_FOLLOW));
+    TEST_ASSERT_EQUAL_UINT32(96000, audio_proc_rate_resolve(48000, 96000));
+    TEST_ASSERT_EQUAL_UINT32(48000, audio_proc_rate_resolve(96000, 48000));
+    TEST_ASSERT_EQUAL_UINT32(96000, audio_proc_rate_resolve(192000, 96000));
+    // Not a factor of two away, or not a processing rate: follow the I/O rate
+    TEST_ASSERT_EQUAL_UINT32(44100, audio_proc_rate_resolve(44100, 96000));
+    TEST_ASSERT_EQUAL_UINT32(192000, audio_proc_rate_resolve(192000, 48000));
+    TEST_ASSERT_EQUAL_UINT32(48000, audio_proc_rate_resolve(48000, 44100));
+    TEST_ASSERT_FALSE(audio_proc_rate_valid(192000));
+    TEST_ASSERT_TRUE(audio_proc_rate_valid(AUDIO_PROC_RATE_FOLLOW));
+}
+
+void test_block_plan_fits_the_buffers(void) {
+    AudioBlockPlan p = audio_block_plan(256, 48000, 96000, FRAMES_MAX);
+    TEST_ASSERT_EQUAL_UINT16(128, p.ioFrames);    // 256 processed frames fill the buffers
+    TEST_ASSERT_EQUAL_UINT16(256, p.procFrames);
+    p = audio_block_plan(64, 48000, 96000, FRAMES_MAX);
+    TEST_ASSERT_EQUAL_UINT16(64, p.ioFrames);
+    TEST_ASSERT_EQUAL_UINT16(128, p.procFrames);
+    p = audio_block_plan(256, 96000, 48000, FRAMES_MAX);
+    TEST_ASSERT_EQUAL_UINT16(256, p.ioFrames);
+    TEST_ASSERT_EQUAL_UINT16(128, p.procFrames);
+    p = audio_block_plan(128, 48000, 48000, FRAMES_MAX);
+    TEST_ASSERT_EQUAL_UINT16(128, p.ioFrames);
+    TEST_ASSERT_EQUAL_UINT16(128, p.procFrames);
+}
+
+void test_block_period_is_the_same_on_both_sides(void) {
+    // The DSP load is processed frames over the processing rate: the same
+    // budget as the I/O block the scheduler clocks, at every size and rate
+    const uint32_t io[] = {48000, 96000, 192000, 44100};
+    const uint32_t proc[] = {AUDIO_PROC_RATE_FOLLOW, 48000, 96000};
+    for (int i = 0; i < 4; i++) {
+        for (int r = 0; r < 3; r++) {
+            const uint32_t pr = audio_proc_rate_resolve(io[i], proc[r]);
+            for (int b = 0; b < AUDIO_BLOCK_SIZES; b++) {
+                AudioBlockPlan p = audio_block_plan(AUDIO_BLOCK_FRAMES_MIN << b, io[i], pr, FRAMES_MAX);
+                TEST_ASSERT_TRUE(audio_block_frames_valid(p.ioFrames));
+                TEST_ASSERT_TRUE(p.procFrames <= FRAMES_MAX);
+                TEST_ASSERT_EQUAL_UINT64((uint64_t)p.ioFrames * pr, (uint64_t)p.procFrames * io[i]);
+            }
+        }
+    }
+}
+
+void test_sink_step_follows_sink_rate(void) {
+    TEST_ASSERT_EQUAL_INT(AUDIO_RATE_DOWN2, audio_sink_step(256, 96000, 48000, FRAMES_MAX));
+    TEST_ASSERT_EQUAL_INT(AUDIO_RATE_UP2,   audio_sink_step(128, 48000, 96000, FRAMES_MAX));
+    TEST_ASSERT_EQUAL_INT(AUDIO_RATE_SAME,  audio_sink_step(256, 48000, 48000, FRAMES_MAX));
+    // Not a factor of two: unconverted, as before
+    TEST_ASSERT_EQUAL_INT(AUDIO_RATE_SAME,  audio_sink_step(256, 48000, 44100, FRAMES_MAX));
+    // Doubled block would overflow the sink buffer
+    TEST_ASSERT_EQUAL_INT(AUDIO_RATE_SAME,  audio_sink_step(256, 96000, 192000, FRAMES_MAX));
+    TEST_ASSERT_EQUAL_UINT32(128, audio_rate_step_frames(AUDIO_RATE_DOWN2, 256));
+    TEST_ASSERT_EQUAL_UINT32(256, audio_rate_step_frames(AUDIO_RATE_UP2, 128));
+}
+
+// ===== Half-Band Converters =====
+
+#define HB_N (MEASURE * 2)             // Room to settle, then MEASURE low-rate frames
+static float _hbIn[HB_N * 2], _hbUp[HB_N * 2], _hbDn[HB_N * 2];
+
+static void tone(float *x, int n, double hz, double rate, float amp) {
+    for (int i = 0; i < n; i++) x[i] = amp * (float)sin(2.0 * kPi * hz * i / rate);
+}
+
+// Peak |x| over [from, n)
+static float peak(const float *x, int from, int n) {
+    float p = 0.0f;
+    for (int i = from; i < n; i++) p = fabsf(x[i]) > p ? fabsf(x[i]) : p;
+    return p;
+}
+
+// Amplitude of the hz component of x[0..n) sampled at rate
+static double tone_at(const float *x, int n, double hz, double rate) {
+    double c = 0.0, s = 0.0;
+    for (int i = 0; i < n; i++) {
+        double w = 2.0 * kPi * hz * i / rate;
+        c += x[i] * cos(w);
+        s += x[i] * sin(w);
+    }
+    return 2.0 * sqrt(c * c + s * s) / n;
+}
+
+// Run n frames through converter blocks of `block` frames
+static int convert_blocks(AudioRateStep step, const float *in, float *out, int n, int block) {
+    AudioHalfbandState st;
+    audio_hb_reset(st);
+    int got = 0;
+    for (int pos = 0; pos < n; pos += block) got += audio_rate_convert(st, step, &in[pos], &out[got], block);
+    return got;
+}
+
+void test_halfband_taps_sum_to_unity_dc_gain(void) {
+    double sum = 0.0;
+    for (int i = 0; i < AUDIO_HB_HALF; i++) sum += kAudioHalfband[i];
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.25f, (float)sum);
+
+    for (int i = 0; i < 512; i++) _hbIn[i] = 0.5f;
+    TEST_ASSERT_EQUAL_INT(1024, convert_blocks(AUDIO_RATE_UP2, _hbIn, _hbUp, 512, 128));
+    for (int i = 2 * AUDIO_HB_SPAN; i < 1024; i++) TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.5f, _hbUp[i]);
+    TEST_ASSERT_EQUAL_INT(256, convert_blocks(AUDIO_RATE_DOWN2, _hbIn, _hbDn, 512, 256));
+    for (int i = AUDIO_HB_SPAN; i < 256; i++) TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.5f, _hbDn[i]);
+}
+
+void test_upsampler_passband_is_flat_to_20k(void) {
+    // Tones on MEASURE bins at 48 kHz, measured at 96 kHz over the settled
+    // output (the same whole number of cycles): ±0.005 dB
+    const int bins[] = {17, 171, 853, 1707, 2560, 3243, 3413};
+    for (unsigned t = 0; t < sizeof(bins) / sizeof(bins[0]); t++) {
+        tone(_hbIn, HB_N, bin_hz(bins[t]), IO_RATE, 0.5f);
+        convert_blocks(AUDIO_RATE_UP2, _hbIn, _hbUp, HB_N, 128);
+        double amp = tone_at(&_hbUp[HB_N * 2 - MEASURE * 2], MEASURE * 2, bin_hz(bins[t]), 2.0 * IO_RATE);
+        TEST_ASSERT_FLOAT_WITHIN(0.005, 0.0, db(amp / 0.5));
+    }
+}
+
+void test_upsampler_rejects_images(void) {
+    // A tone at f leaves an image at 48 kHz - f; from 20 kHz (image at
+    // 28 kHz) down it must sit 70 dB under the tone. Tone and image both
+    // fall on bins of the measured span.
+    const int bins[] = {171, 1707, 3413};                // 1, 10, 20 kHz
+    for (unsigned t = 0; t < sizeof(bins) / sizeof(bins[0]); t++) {
+        tone(_hbIn, HB_N, bin_hz(bins[t]), IO_RATE, 0.5f);
+        convert_blocks(AUDIO_RATE_UP2, _hbIn, _hbUp, HB_N, 64);
+        double amp = tone_at(&_hbUp[HB_N * 2 - MEASURE * 2], MEASURE * 2,
+                             IO_RATE - bin_hz(bins[t]), 2.0 * IO_RATE);
+        TEST_ASSERT_TRUE(db(amp / 0.5) < -70.0);
+    }
+}
+
+void test_downsampler_rejects_aliases(void) {
+    // 96 kHz tones from 28 kHz up would alias into the 48 kHz band
+    const double freqs[] = {28000.0, 36000.0, 47000.0};
+    for (unsigned t = 0; t < sizeof(freqs) / sizeof(freqs[0]); t++) {
+        tone(_hbIn, HB_N * 2, freqs[t], 2.0 * IO_RATE, 0.5f);
+        convert_blocks(AUDIO_RATE_DOWN2, _hbIn, _hbDn, HB_N * 2, 256);
+        TEST_ASSERT_TRUE(db(peak(_hbDn, AUDIO_HB_SPAN, HB_N) / 0.5f) < -70.0);
+    }
+}
+
+void test_conversion_is_independent_of_block_split(void) {
+    for (int i = 0; i < HB_N; i++) _hbIn[i] = 0.3f * sinf(0.05f * i) + 0.2f * sinf(1.3f * i);
+    static float ref[HB_N * 2];
+    convert_blocks(AUDIO_RATE_UP2, _hbIn, ref, HB_N, 128);
+    convert_blocks(AUDIO_RATE_UP2, _hbIn, _hbUp, HB_N, 16);
+    for (int i = 0; i < HB_N * 2; i++) TEST_ASSERT_EQUAL_FLOAT(ref[i], _hbUp[i]);
+    convert_blocks(AUDIO_RATE_DOWN2, ref, _hbDn, HB_N * 2, 256);
+    convert_blocks(AUDIO_RATE_DOWN2, ref, _hbUp, HB_N * 2, 32);
+    for (int i = 0; i < HB_N; i++) TEST_ASSERT_EQUAL_FLOAT(_hbDn[i], _hbUp[i]);
+}
+
+void test_conversion_in_place_matches_separate_buffers(void) {
+    for (int i = 0; i < 128; i++) _hbIn[i] = 0.4f * sinf(0.21f * i);
+    AudioHalfbandState s1, s2;
+    audio_hb_reset(s1);
+    audio_hb_reset(s2);
+    static float buf[256];
+    memcpy(buf, _hbIn, 128 * sizeof(float));
+    audio_hb_up2(s1, _hbIn, _hbUp, 128);
+    audio_hb_up2(s2, buf, buf, 128);
+    for (int i = 0; i < 256; i++) TEST_ASSERT_EQUAL_FLOAT(_hbUp[i], buf[i]);
+    audio_hb_down2(s1, _hbUp, _hbDn, 256);
+    audio_hb_down2(s2, buf, buf, 256);
+    for (int i = 0; i < 128; i++) TEST_ASSERT_EQUAL_FLOAT(_hbDn[i], buf[i]);
+}
+
+void test_round_trip_is_a_pure_delay(void) {
+    // Up and back down: an impulse comes out AUDIO_HB_ROUND_TRIP frames
+    // later, and a band-limited signal comes back unchanged
+    memset(_hbIn, 0, 512 * sizeof(float));
+    _hbIn[10] = 1.0f;
+    convert_blocks(AUDIO_RATE_UP2, _hbIn, _hbUp, 512, 128);
+    convert_blocks(AUDIO_RATE_DOWN2, _hbUp, _hbDn, 1024, 256);
+    int at = 0;
+    for (int i = 0; i < 512; i++) at = fabsf(_hbDn[i]) > fabsf(_hbDn[at]) ? i : at;
+    TEST_ASSERT_EQUAL_INT(10 + AUDIO_HB_ROUND_TRIP, at);
+
+    tone(_hbIn, HB_N, 9000.0, IO_RATE, 0.5f);
+    convert_blocks(AUDIO_RATE_UP2, _hbIn, _hbUp, HB_N, 128);
+    convert_blocks(AUDIO_RATE_DOWN2, _hbUp, _hbDn, HB_N * 2, 256);
+    for (int i = 256; i < HB_N; i++) TEST_ASSERT_FLOAT_WITHIN(2e-4f, _hbIn[i - AUDIO_HB_ROUND_TRIP], _hbDn[i]);
+}
+
+// ===== End to End =====
+
+// Gain of the chain at MEASURE bin k, 48 kHz in and out
+static double chain_gain_db(Chain &c, int k) {
+    const float amp = 0.25f;
+    for (int i = 0; i < WARMUP + MEASURE; i++) {
+        _inL[i] = amp * (float)sin(2.0 * kPi * k * i / MEASURE);
+        _inR[i] = 0.0f;
+    }
+    chain_run(c, WARMUP + MEASURE);
+    return db(tone_amplitude(&_outL[WARMUP], k) / amp);
+}
+
+static void check_response(uint32_t procRequest) {
+    const int bins[] = {17, 171, 853, 1707, 2560, 3243, 3413};  // 100 Hz .. 20 kHz
+    Chain c;
+    for (unsigned t = 0; t < sizeof(bins) / sizeof(bins[0]); t++) {
+        chain_init(c, procRequest);
+        double measured = chain_gain_db(c, bins[t]);
+        double designed = db(chain_mag(bin_hz(bins[t]), c.procRate));
+        TEST_ASSERT_FLOAT_WITHIN(0.02, designed, measured);
+    }
+}
+
+void test_end_to_end_response_at_48k_processing(void) { check_response(AUDIO_PROC_RATE_FOLLOW); }
+void test_end_to_end_response_at_96k_processing(void) { check_response(96000); }
+
+void test_96k_processing_keeps_the_eq_intent(void) {
+    // The 1 kHz PEQ peak is the same at either processing rate; the 16 kHz
+    // low-pass corner is not cramped against Nyquist at 96 kHz (-3 dB there,
+    // plus the output PEQ skirt), so the two rates differ only at the top
+    Chain a, b;
+    chain_init(a, AUDIO_PROC_RATE_FOLLOW);
+    double g48 = chain_gain_db(a, 171);
+    chain_init(b, 96000);
+    double g96 = chain_gain_db(b, 171);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, g48, g96);
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 6.0, g96);
+
+    chain_init(a, AUDIO_PROC_RATE_FOLLOW);
+    double hi48 = chain_gain_db(a, 3413);
+    chain_init(b, 96000);
+    double hi96 = chain_gain_db(b, 3413);
+    TEST_ASSERT_TRUE(hi96 > hi48);
+}
+
+// ===== Benchmark =====
+
+void test_benchmark_cpu_per_processing_rate(void) {
+    const uint32_t requests[] = {AUDIO_PROC_RATE_FOLLOW, 96000};
+    double usPerSecond[2] = {};
+    const int frames = WARMUP + MEASURE;
+    uint32_t s = 0x13579bdu;
+    for (int i = 0; i < frames; i++) {
+        s = s * 1664525u + 1013904223u;
+        _inL[i] = 0.2f * ((float)(s >> 8) / 8388608.0f - 1.0f);
+        _inR[i] = _inL[i] * 0.5f;
+    }
+    for (int r = 0; r < 2; r++) {
+        Chain c;
+        chain_init(c, requests[r]);
+        chain_run(c, frames);                                   // Warm-up
+        auto t0 = std::chrono::steady_clock::now();
+        chain_run(c, frames);
+        auto t1 = std::chrono::steady_clock::now();
+        double us = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / 1000.0;
+        usPerSecond[r] = us * IO_RATE / frames;
+        const int blocks = frames / c.plan.ioFrames;
+        const double periodUs = 1e6 * c.plan.ioFrames / IO_RATE;
+        printf("[bench] I/O %u Hz, processing %6lu Hz: %3u -> %3u frames/block, %.2f us/block "
+               "(period %.0f us), %.0f us per second of audio\n",
+               IO_RATE, (unsigned long)c.procRate, c.plan.ioFrames, c.plan.procFrames,
+               us / blocks, periodUs, usPerSecond[r]);
+    }
+
+    // Converters alone: one stereo lane up and one stereo sink down
+    AudioHalfbandState st[4];
+    for (int i = 0; i < 4; i++) audio_hb_reset(st[i]);
+    static float up[FRAMES_MAX], dn[FRAMES_MAX / 2];
+    auto t0 = std::chrono::steady_clock::now();
+    for (int pos = 0; pos < frames; pos += 128) {
+        audio_hb_up2(st[0], &_inL[pos], up, 128);
+        audio_hb_down2(st[2], up, dn, 256);
+        audio_hb_up2(st[1], &_inR[pos], up, 128);
+        audio_hb_down2(st[3], up, dn, 256);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double convUs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / 1000.0;
+    printf("[bench] 2x converters (stereo lane up + sink down): %.0f us per second of audio, "
+           "96 kHz processing costs %.2fx the 48 kHz chain\n",
+           convUs * IO_RATE / frames, usPerSecond[1] / usPerSecond[0]);
+    TEST_ASSERT_TRUE(usPerSecond[0] > 0.0);
+    TEST_ASSERT_TRUE(usPerSecond[1] > usPerSecond[0]);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_processing_rate_resolves_against_io_rate);
+    RUN_TEST(test_block_plan_fits_the_buffers);
+    RUN_TEST(test_block_period_is_the_same_on_both_sides);
+    RUN_TEST(test_sink_step_follows_sink_rate);
+    RUN_TEST(test_halfband_taps_sum_to_unity_dc_gain);
+    RUN_TEST(test_upsampler_passband_is_flat_to_20k);
+    RUN_TEST(test_upsampler_rejects_images);
+    RUN_TEST(test_downsampler_rejects_aliases);
+    RUN_TEST(test_conversion_is_independent_of_block_split);
+    RUN_TEST(test_conversion_in_place_matches_separate_buffers);
+    RUN_TEST(test_round_trip_is_a_pure_delay);
+    RUN_TEST(test_end_to_end_response_at_48k_processing);
+    RUN_TEST(test_end_to_end_response_at_96k_processing);
+    RUN_TEST(test_96k_processing_keeps_the_eq_intent);
+    RUN_TEST(test_benchmark_cpu_per_processing_rate);
+    return UNITY_END();
+}
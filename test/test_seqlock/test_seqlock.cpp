@@ -0,0 +1,252 @@
+// test_seqlock.cpp
+// Seqlock publication of the audio analysis / diagnostics snapshots
+// (seqlock.h). Covers the sequence protocol, torn-read detection with a
+// writer hammering AudioAnalysis / AudioDiagnostics from another thread
+// (whole-struct and one-lane readers), and a measurement of the writer-side
+// window against the whole-struct copy the old getters ran with interrupts
+// masked.
+//
+// The getters are replicated inline as they stand in i2s_audio.cpp.
+
+#include <unity.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "../../src/seqlock.h"
+#include "../../src/i2s_audio.h"
+
+static AudioAnalysis g_analysis;
+static Seqlock g_analysisLock;
+static AudioDiagnostics g_diag;
+static Seqlock g_diagLock;
+
+// ===== Getters as in i2s_audio.cpp =====
+
+static AudioAnalysis get_analysis() {
+    AudioAnalysis result;
+    uint32_t s;
+    do {
+        s = seqlock_read_begin(g_analysisLock);
+        result = g_analysis;
+    } while (seqlock_read_retry(g_analysisLock, s));
+    return result;
+}
+
+static AdcAnalysis get_lane_analysis(int lane) {
+    AdcAnalysis result;
+    uint32_t s;
+    do {
+        s = seqlock_read_begin(g_analysisLock);
+        result = g_analysis.adc[lane];
+    } while (seqlock_read_retry(g_analysisLock, s));
+    return result;
+}
+
+static float get_lane_dbfs(float *laneDbfs, int count) {
+    float overall;
+    uint32_t s;
+    do {
+        s = seqlock_read_begin(g_analysisLock);
+        overall = g_analysis.dBFS;
+        for (int a = 0; a < count; a++) laneDbfs[a] = g_analysis.adc[a].dBFS;
+    } while (seqlock_read_retry(g_analysisLock, s));
+    return overall;
+}
+
+static AudioDiagnostics get_diagnostics() {
+    AudioDiagnostics result;
+    uint32_t s;
+    do {
+        s = seqlock_read_begin(g_diagLock);
+        result = g_diag;
+    } while (seqlock_read_retry(g_diagLock, s));
+    return result;
+}
+
+// Writer: every field of the analysis carries the same value v. With pause
+// the writer gives up the CPU halfway through, so readers run into a write
+// in progress even on a single-core host.
+static void publish_analysis(float v, bool pause = false) {
+    seqlock_write_begin(g_analysisLock);
+    for (int a = 0; a < AUDIO_PIPELINE_MAX_INPUTS; a++) {
+        if (pause && a == AUDIO_PIPELINE_MAX_INPUTS / 2) std::this_thread::yield();
+        AdcAnalysis &x = g_analysis.adc[a];
+        x.rms1 = x.rms2 = x.rmsCombined = v;
+        x.vu1 = x.vu2 = x.vuCombined = v;
+        x.peak1 = x.peak2 = x.peakCombined = v;
+        x.dBFS = v;
+    }
+    g_analysis.dBFS = v;
+    seqlock_write_end(g_analysisLock);
+}
+
+static bool analysis_consistent(const AdcAnalysis &x, float v) {
+    return x.rms1 == v && x.rms2 == v && x.rmsCombined == v && x.vu1 == v && x.vu2 == v &&
+           x.vuCombined == v && x.peak1 == v && x.peak2 == v && x.peakCombined == v && x.dBFS == v;
+}
+
+// Writer: one lane update as i2s_audio_update_capture_diag() does it, all
+// counters of the lane set to n
+static void publish_lane_diag(int lane, uint32_t n, bool pause = false) {
+    seqlock_write_begin(g_diagLock);
+    AdcDiagnostics &d = g_diag.adc[lane];
+    d.captureStalls = n;
+    if (pause) std::this_thread::yield();
+    d.captureUnderruns = n;
+    d.captureOverflows = n;
+    d.clippedSamples = n;
+    d.totalBuffersRead = n;
+    seqlock_write_end(g_diagLock);
+}
+
+void setUp(void) {
+    g_analysis = AudioAnalysis{};
+    g_analysisLock = Seqlock{};
+    g_diag = AudioDiagnostics{};
+    g_diagLock = Seqlock{};
+}
+
+void tearDown(void) {}
+
+// ===== Protocol =====
+
+void test_sequence_odd_during_write(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, g_analysisLock.seq);
+    seqlock_write_begin(g_analysisLock);
+    TEST_ASSERT_EQUAL_UINT32(1, g_analysisLock.seq & 1u);
+    seqlock_write_end(g_analysisLock);
+    TEST_ASSERT_EQUAL_UINT32(2, g_analysisLock.seq);
+}
+
+void test_read_without_write_succeeds(void) {
+    publish_analysis(-20.0f);
+    uint32_t s = seqlock_read_begin(g_analysisLock);
+    float v = g_analysis.adc[3].dBFS;
+    TEST_ASSERT_FALSE(seqlock_read_retry(g_analysisLock, s));
+    TEST_ASSERT_EQUAL_FLOAT(-20.0f, v);
+}
+
+void test_overlapping_write_forces_retry(void) {
+    uint32_t s = seqlock_read_begin(g_analysisLock);
+    publish_analysis(-10.0f);                       // Lands between begin and retry
+    TEST_ASSERT_TRUE(seqlock_read_retry(g_analysisLock, s));
+}
+
+void test_read_started_mid_write_retries(void) {
+    seqlock_write_begin(g_analysisLock);
+    uint32_t s = seqlock_read_begin(g_analysisLock);
+    TEST_ASSERT_TRUE(seqlock_read_retry(g_analysisLock, s));
+    seqlock_write_end(g_analysisLock);
+    s = seqlock_read_begin(g_analysisLock);
+    TEST_ASSERT_FALSE(seqlock_read_retry(g_analysisLock, s));
+}
+
+void test_subset_views(void) {
+    publish_analysis(-42.0f);
+    g_analysis.adc[2].dBFS = -12.0f;                // Direct poke, no write in flight
+    float lanes[AUDIO_PIPELINE_MAX_INPUTS];
+    float overall = get_lane_dbfs(lanes, AUDIO_PIPELINE_MAX_INPUTS);
+    TEST_ASSERT_EQUAL_FLOAT(-42.0f, overall);
+    TEST_ASSERT_EQUAL_FLOAT(-12.0f, lanes[2]);
+    TEST_ASSERT_EQUAL_FLOAT(-42.0f, lanes[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-42.0f, get_lane_analysis(1).rmsCombined);
+}
+
+// ===== Torn reads under a concurrent writer =====
+
+void test_no_torn_reads_concurrent(void) {
+    const uint32_t kWrites = 20000;
+    std::atomic<bool> stop(false);
+    std::atomic<uint32_t> torn(0), reads(0);
+
+    auto fullReader = [&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+            AudioAnalysis a = get_analysis();
+            float v = a.dBFS;
+            for (int l = 0; l < AUDIO_PIPELINE_MAX_INPUTS; l++) {
+                if (!analysis_consistent(a.adc[l], v)) { torn++; break; }
+            }
+            AudioDiagnostics d = get_diagnostics();
+            const AdcDiagnostics &x = d.adc[1];
+            if (x.captureStalls != x.captureUnderruns || x.captureStalls != x.captureOverflows ||
+                x.captureStalls != x.clippedSamples || x.captureStalls != x.totalBuffersRead) torn++;
+            reads++;
+        }
+    };
+    auto laneReader = [&]() {
+        float lanes[AUDIO_PIPELINE_MAX_INPUTS];
+        while (!stop.load(std::memory_order_relaxed)) {
+            AdcAnalysis x = get_lane_analysis(5);
+            if (!analysis_consistent(x, x.dBFS)) torn++;
+            float overall = get_lane_dbfs(lanes, AUDIO_PIPELINE_MAX_INPUTS);
+            for (int l = 0; l < AUDIO_PIPELINE_MAX_INPUTS; l++) {
+                if (lanes[l] != overall) { torn++; break; }
+            }
+            reads++;
+        }
+    };
+
+    std::thread r1(fullReader), r2(laneReader);
+    while (reads.load() < 10) std::this_thread::yield();
+    for (uint32_t k = 1; k <= kWrites; k++) {
+        bool pause = (k % 64) == 0;
+        publish_analysis((float)k, pause);
+        publish_lane_diag(1, k, pause);
+    }
+    stop = true;
+    r1.join();
+    r2.join();
+
+    printf("[seqlock] %u writes, %u reads, %u torn\n", (unsigned)kWrites,
+           (unsigned)reads.load(), (unsigned)torn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_TRUE(reads.load() > 10);
+    TEST_ASSERT_EQUAL_FLOAT((float)kWrites, get_analysis().dBFS);
+}
+
+// ===== Critical-section duration =====
+
+// The old getters copied the whole struct with interrupts masked; the writer
+// window is now the only exclusive section, and readers mask nothing.
+void test_critical_section_duration(void) {
+    const int iters = 200000;
+    volatile uint32_t sink = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) {
+        AudioDiagnostics d = g_diag;                // Old masked window: whole copy
+        sink += d.adc[i & 7].totalBuffersRead;
+        g_diag.adc[0].totalBuffersRead = (uint32_t)i;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) publish_lane_diag(i & 7, (uint32_t)i);   // New writer window
+    auto t2 = std::chrono::steady_clock::now();
+    float lanes[AUDIO_PIPELINE_MAX_INPUTS];
+    for (int i = 0; i < iters; i++) sink += (uint32_t)get_lane_dbfs(lanes, AUDIO_PIPELINE_MAX_INPUTS);
+    auto t3 = std::chrono::steady_clock::now();
+
+    double oldNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / iters;
+    double wrNs  = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / iters;
+    double subNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count() / iters;
+    printf("[bench] masked whole-struct copy %.1f ns (%u B); seqlock writer window %.1f ns; "
+           "lane-dBFS view %.1f ns, unmasked\n",
+           oldNs, (unsigned)sizeof(AudioDiagnostics), wrNs, subNs);
+    TEST_ASSERT_TRUE(wrNs < 1000.0);
+    (void)sink;
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sequence_odd_during_write);
+    RUN_TEST(test_read_without_write_succeeds);
+    RUN_TEST(test_overlapping_write_forces_retry);
+    RUN_TEST(test_read_started_mid_write_retries);
+    RUN_TEST(test_subset_views);
+    RUN_TEST(test_no_torn_reads_concurrent);
+    RUN_TEST(test_critical_section_duration);
+    return UNITY_END();
+}
@@ -0,0 +1,447 @@
+// test_settings_stream.cpp
+// Tests for the bounded-memory settings export/import streamer.
+//
+// Verifies the incremental splitter produces identical units regardless of
+// how the upload is chunked, that memory is bounded by the section buffer,
+// that malformed/truncated uploads never touch live config files, and that
+// the commit marker lets an interrupted commit finish on the next boot.
+
+#include <unity.h>
+#include <string.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "../test_mocks/Arduino.h"
+#include "../test_mocks/LittleFS.h"
+
+#include "../../src/heap_budget.h"
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.h"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/config_snapshot.h"
+#include "../../src/config_snapshot.cpp"
+#include "../../src/settings_stream.h"
+#include "../../src/settings_stream.cpp"
+
+// ---------------------------------------------------------------------------
+// Fixtures
+// ---------------------------------------------------------------------------
+
+static const char *EXPORT_DOC =
+    "{\n"
+    "  \"deviceInfo\": {\"model\": \"ALX\", \"serialNumber\": \"A1\"},\n"
+    "  \"settings\": {\"darkMode\": true, \"adcEnabled\": [true, false]},\n"
+    "  \"inputNames\": [\"L1\", \"R1\", \"L2\", \"R2\"],\n"
+    "  \"exportInfo\": {\"timestamp\": \"unknown\", \"version\": \"2.0\"},\n"
+    "  \"dspGlobal\": {\"bypass\": false, \"note\": \"brace } in \\\"string\\\"\"},\n"
+    "  \"dspChannels\": [{\"stages\": [{\"type\": 1}]}, {}, {\"stages\": []}, {}],\n"
+    "  \"outputDsp\": [],\n"
+    "  \"pipelineMatrix\": {\"m\": [[1, 0], [0, 1]]},\n"
+    "  \"futureSection\": {\"ignored\": [1, 2, 3]},\n"
+    "  \"halDevices\": [{\"slot\": 0}, {\"slot\": 3, \"userLabel\": \"[x]\"}]\n"
+    "}\n";
+
+struct Unit {
+    std::string key;
+    int index;
+    std::string data;
+};
+
+static std::vector<Unit> _units;
+
+static bool collectUnit(void *ctx, const char *key, int index, const char *data, size_t len) {
+    (void)ctx;
+    Unit u;
+    u.key = key;
+    u.index = index;
+    u.data.assign(data, len);
+    _units.push_back(u);
+    return true;
+}
+
+static const char *const SPLIT_KEYS[] = { "dspChannels", "outputDsp", "halDevices" };
+
+static SettingsSplitStatus splitInChunks(const char *doc, size_t chunk, char *buf, size_t bufSize,
+                                         SettingsKeyFilterCb filter = nullptr) {
+    SettingsJsonSplitter sp;
+    settings_splitter_init(&sp, buf, bufSize, SPLIT_KEYS, 3, collectUnit, filter, nullptr);
+    size_t total = strlen(doc);
+    SettingsSplitStatus st = SETTINGS_SPLIT_OK;
+    for (size_t pos = 0; pos < total; pos += chunk) {
+        size_t n = (total - pos < chunk) ? total - pos : chunk;
+        st = settings_splitter_feed(&sp, (const uint8_t *)doc + pos, n);
+        if (st != SETTINGS_SPLIT_OK && st != SETTINGS_SPLIT_DONE) break;
+    }
+    return st;
+}
+
+static std::string _sinkOut;
+static int _sinkCalls = 0;
+static int _sinkFailAfter = -1;
+
+static bool stringSink(void *ctx, const char *data, size_t len) {
+    (void)ctx;
+    if (_sinkFailAfter >= 0 && _sinkCalls >= _sinkFailAfter) return false;
+    _sinkCalls++;
+    _sinkOut.append(data, len);
+    return true;
+}
+
+static void feedDoc(const char *doc, size_t chunk) {
+    size_t total = strlen(doc);
+    for (size_t pos = 0; pos < total; pos += chunk) {
+        size_t n = (total - pos < chunk) ? total - pos : chunk;
+        if (!settings_import_feed((const uint8_t *)doc + pos, n)) break;
+    }
+}
+
+void setUp(void) {
+    _units.clear();
+    _sinkOut.clear();
+    _sinkCalls = 0;
+    _sinkFailAfter = -1;
+    MockFS::reset();
+    LittleFS.begin();
+    heap_budget_reset();
+    psram_stats_reset();
+}
+
+void tearDown(void) {
+    settings_import_abort();
+}
+
+// ---------------------------------------------------------------------------
+// Splitter
+// ---------------------------------------------------------------------------
+
+void test_split_units_whole_document(void) {
+    static char buf[512];
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_DONE, splitInChunks(EXPORT_DOC, 4096, buf, sizeof(buf)));
+
+    // 7 plain members + 4 dspChannels + 0 outputDsp + 2 halDevices
+    TEST_ASSERT_EQUAL(13, (int)_units.size());
+    TEST_ASSERT_EQUAL_STRING("deviceInfo", _units[0].key.c_str());
+    TEST_ASSERT_EQUAL(-1, _units[0].index);
+    TEST_ASSERT_EQUAL_STRING("[\"L1\", \"R1\", \"L2\", \"R2\"]", _units[2].data.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"bypass\": false, \"note\": \"brace } in \\\"string\\\"\"}",
+                             _units[4].data.c_str());
+    TEST_ASSERT_EQUAL_STRING("dspChannels", _units[5].key.c_str());
+    TEST_ASSERT_EQUAL(0, _units[5].index);
+    TEST_ASSERT_EQUAL_STRING("{\"stages\": [{\"type\": 1}]}", _units[5].data.c_str());
+    TEST_ASSERT_EQUAL(3, _units[8].index);
+    TEST_ASSERT_EQUAL_STRING("{}", _units[8].data.c_str());
+    TEST_ASSERT_EQUAL_STRING("halDevices", _units[12].key.c_str());
+    TEST_ASSERT_EQUAL(1, _units[12].index);
+    TEST_ASSERT_EQUAL_STRING("{\"slot\": 3, \"userLabel\": \"[x]\"}", _units[12].data.c_str());
+}
+
+void test_split_identical_for_every_chunk_size(void) {
+    static char buf[512];
+    splitInChunks(EXPORT_DOC, 4096, buf, sizeof(buf));
+    std::vector<Unit> reference = _units;
+
+    size_t total = strlen(EXPORT_DOC);
+    for (size_t chunk = 1; chunk <= total; chunk++) {
+        _units.clear();
+        TEST_ASSERT_EQUAL(SETTINGS_SPLIT_DONE, splitInChunks(EXPORT_DOC, chunk, buf, sizeof(buf)));
+        TEST_ASSERT_EQUAL(reference.size(), _units.size());
+        for (size_t i = 0; i < reference.size(); i++) {
+            TEST_ASSERT_EQUAL_STRING(reference[i].key.c_str(), _units[i].key.c_str());
+            TEST_ASSERT_EQUAL(reference[i].index, _units[i].index);
+            TEST_ASSERT_EQUAL_STRING(reference[i].data.c_str(), _units[i].data.c_str());
+        }
+    }
+}
+
+void test_split_scalars_and_strings(void) {
+    static char buf[64];
+    const char *doc = "{\"a\":12,\"b\" : \"x,}\" ,\"c\":true,\"d\":null}";
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_DONE, splitInChunks(doc, 3, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(4, (int)_units.size());
+    TEST_ASSERT_EQUAL_STRING("12", _units[0].data.c_str());
+    TEST_ASSERT_EQUAL_STRING("\"x,}\"", _units[1].data.c_str());
+    TEST_ASSERT_EQUAL_STRING("true", _units[2].data.c_str());
+    TEST_ASSERT_EQUAL_STRING("null", _units[3].data.c_str());
+}
+
+void test_split_overflow_is_bounded(void) {
+    // Largest unit in EXPORT_DOC is ~60 bytes — a 32-byte buffer must fail
+    static char buf[32];
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_ERR_OVERFLOW, splitInChunks(EXPORT_DOC, 7, buf, sizeof(buf)));
+}
+
+static bool onlyDsp(void *ctx, const char *key) {
+    (void)ctx;
+    return strncmp(key, "dsp", 3) == 0;
+}
+
+void test_split_filtered_keys_not_buffered(void) {
+    // Buffer only fits the DSP units; every other member is scanned, not stored
+    static char buf[40];
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_ERR_OVERFLOW, splitInChunks(EXPORT_DOC, 5, buf, sizeof(buf)));
+    _units.clear();
+    static char big[80];
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_DONE, splitInChunks(EXPORT_DOC, 5, big, sizeof(big), onlyDsp));
+    TEST_ASSERT_EQUAL(5, (int)_units.size());
+    for (size_t i = 0; i < _units.size(); i++) {
+        TEST_ASSERT_EQUAL(0, strncmp(_units[i].key.c_str(), "dsp", 3));
+    }
+}
+
+void test_split_rejects_malformed(void) {
+    static char buf[128];
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_ERR_SYNTAX, splitInChunks("[1,2]", 2, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_ERR_SYNTAX, splitInChunks("{\"a\" 1}", 2, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_ERR_SYNTAX, splitInChunks("{\"a\":{}}}", 2, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_ERR_SYNTAX, splitInChunks("{\"a\":,}", 2, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_ERR_SYNTAX, splitInChunks("{} x", 2, buf, sizeof(buf)));
+    // Truncated stream stays OK (not DONE) — caller treats that as failure
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_OK, splitInChunks("{\"a\":{\"b\":1", 2, buf, sizeof(buf)));
+}
+
+void test_split_empty_object(void) {
+    static char buf[16];
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_DONE, splitInChunks("  {  }  ", 1, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(0, (int)_units.size());
+}
+
+// ---------------------------------------------------------------------------
+// Export writer
+// ---------------------------------------------------------------------------
+
+static std::string exportWithChunk(size_t cap) {
+    static char chunk[2048];
+    _sinkOut.clear();
+    SettingsExportWriter w;
+    settings_writer_init(&w, chunk, cap, stringSink, nullptr);
+    settings_writer_begin_section(&w, "exportInfo");
+    settings_writer_print(&w, "{\"version\":\"2.0\"}");
+    settings_writer_begin_section(&w, "dspGlobal");
+    settings_writer_copy_file(&w, "/dsp_global.json");
+    settings_writer_begin_section(&w, "dspChannels");
+    settings_writer_print(&w, "[");
+    settings_writer_copy_file(&w, "/dsp_ch0.json");
+    settings_writer_print(&w, ",");
+    settings_writer_copy_file(&w, "/dsp_ch1.json");
+    settings_writer_print(&w, "]");
+    settings_writer_end(&w);
+    return _sinkOut;
+}
+
+void test_writer_output_independent_of_chunk_size(void) {
+    MockFS::injectFile("/dsp_global.json", "{\"bypass\":true,\"s\":\"}{\"}\n");
+    MockFS::injectFile("/dsp_ch0.json", "{\"stages\":[1,2,3]}");
+    std::string ref = exportWithChunk(2048);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\n\"exportInfo\": {\"version\":\"2.0\"},\n"
+        "\"dspGlobal\": {\"bypass\":true,\"s\":\"}{\"}\n,\n"
+        "\"dspChannels\": [{\"stages\":[1,2,3]},{}]\n}\n",
+        ref.c_str());
+    for (size_t cap = 1; cap < 64; cap++) {
+        TEST_ASSERT_EQUAL_STRING(ref.c_str(), exportWithChunk(cap).c_str());
+    }
+}
+
+void test_writer_chunks_never_exceed_capacity(void) {
+    std::string big(5000, ' ');
+    big[0] = '{';
+    big[4999] = '}';
+    MockFS::injectFile("/dsp_global.json", big);
+    static char chunk[SETTINGS_STREAM_CHUNK_BYTES];
+    SettingsExportWriter w;
+    settings_writer_init(&w, chunk, sizeof(chunk), stringSink, nullptr);
+    settings_writer_begin_section(&w, "dspGlobal");
+    TEST_ASSERT_TRUE(settings_writer_copy_file(&w, "/dsp_global.json"));
+    TEST_ASSERT_TRUE(settings_writer_end(&w));
+    TEST_ASSERT_EQUAL(4, _sinkCalls);  // 5000+ bytes / 1436
+    TEST_ASSERT_EQUAL((uint32_t)_sinkOut.size(), w.totalBytes);
+}
+
+void test_writer_corrupt_file_becomes_placeholder(void) {
+    MockFS::injectFile("/dsp_global.json", "{\"bypass\":tr");
+    static char chunk[32];
+    SettingsExportWriter w;
+    settings_writer_init(&w, chunk, sizeof(chunk), stringSink, nullptr);
+    settings_writer_begin_section(&w, "dspGlobal");
+    TEST_ASSERT_FALSE(settings_writer_copy_file(&w, "/dsp_global.json"));
+    settings_writer_end(&w);
+    TEST_ASSERT_EQUAL_STRING("{\n\"dspGlobal\": {}\n}\n", _sinkOut.c_str());
+}
+
+void test_writer_stops_when_client_gone(void) {
+    _sinkFailAfter = 1;
+    static char chunk[8];
+    SettingsExportWriter w;
+    settings_writer_init(&w, chunk, sizeof(chunk), stringSink, nullptr);
+    settings_writer_begin_section(&w, "exportInfo");
+    TEST_ASSERT_FALSE(settings_writer_print(&w, "{\"version\":\"2.0\"}"));
+    TEST_ASSERT_TRUE(w.failed);
+    TEST_ASSERT_FALSE(settings_writer_end(&w));
+    TEST_ASSERT_EQUAL(1, _sinkCalls);
+}
+
+void test_file_structure_check(void) {
+    MockFS::injectFile("/a.json", "  {\"x\":[1,{\"y\":\"]\"}]}  \n");
+    MockFS::injectFile("/b.json", "{\"x\":1}}");
+    MockFS::injectFile("/c.json", "[]");
+    MockFS::injectFile("/d.json", "");
+    TEST_ASSERT_TRUE(settings_stream_file_is_json_object("/a.json"));
+    TEST_ASSERT_FALSE(settings_stream_file_is_json_object("/b.json"));
+    TEST_ASSERT_FALSE(settings_stream_file_is_json_object("/c.json"));
+    TEST_ASSERT_FALSE(settings_stream_file_is_json_object("/d.json"));
+    TEST_ASSERT_FALSE(settings_stream_file_is_json_object("/missing.json"));
+}
+
+// ---------------------------------------------------------------------------
+// Import staging / commit
+// ---------------------------------------------------------------------------
+
+void test_import_stages_known_sections_only(void) {
+    TEST_ASSERT_TRUE(settings_import_begin(nullptr));
+    feedDoc(EXPORT_DOC, 100);
+    TEST_ASSERT_TRUE(settings_import_finish());
+
+    TEST_ASSERT_TRUE(settings_import_has_unit("exportInfo", -1));
+    TEST_ASSERT_TRUE(settings_import_has_unit("dspChannels", 0));
+    TEST_ASSERT_TRUE(settings_import_has_unit("halDevices", 1));
+    TEST_ASSERT_FALSE(settings_import_has_unit("deviceInfo", -1));
+    TEST_ASSERT_FALSE(settings_import_has_unit("futureSection", -1));
+    // 5 plain known members + 4 dspChannels + 2 halDevices
+    TEST_ASSERT_EQUAL(11, settings_import_get_stats().unitsStaged);
+
+    char buf[128];
+    TEST_ASSERT_GREATER_THAN(0, settings_import_read_unit("exportInfo", -1, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("{\"timestamp\": \"unknown\", \"version\": \"2.0\"}", buf);
+    TEST_ASSERT_EQUAL(-1, settings_import_read_unit("exportInfo", -1, buf, 8));
+}
+
+void test_import_commit_promotes_and_skips_placeholders(void) {
+    MockFS::injectFile("/dsp_ch1.json", "{\"keep\":1}");
+    TEST_ASSERT_TRUE(settings_import_begin(nullptr));
+    feedDoc(EXPORT_DOC, 17);
+    TEST_ASSERT_TRUE(settings_import_finish());
+
+    settings_import_mark_commit();
+    TEST_ASSERT_EQUAL(4, settings_import_promote_files());  // global, ch0, ch2, matrix
+    settings_import_clear();
+
+    TEST_ASSERT_EQUAL_STRING("{\"stages\": [{\"type\": 1}]}", MockFS::getFile("/dsp_ch0.json").c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"keep\":1}", MockFS::getFile("/dsp_ch1.json").c_str());
+    TEST_ASSERT_TRUE(LittleFS.exists("/dsp_global.json"));
+    TEST_ASSERT_TRUE(LittleFS.exists("/pipeline_matrix.json"));
+    TEST_ASSERT_FALSE(LittleFS.exists("/dsp_ch3.json"));
+    TEST_ASSERT_FALSE(LittleFS.exists(SETTINGS_IMPORT_COMMIT_MARKER));
+    TEST_ASSERT_FALSE(settings_import_has_unit("settings", -1));
+}
+
+void test_import_promotion_drops_shadowing_snapshots(void) {
+    MockFS::injectFile("/dsp_a.bin", "x");
+    MockFS::injectFile("/dsp_b.bin", "x");
+    MockFS::injectFile("/mtx_a.bin", "x");
+    MockFS::injectFile("/odsp_a.bin", "x");
+    MockFS::injectFile("/cfg_a.bin", "x");
+    TEST_ASSERT_TRUE(settings_import_begin(nullptr));
+    feedDoc(EXPORT_DOC, 29);
+    TEST_ASSERT_TRUE(settings_import_finish());
+
+    settings_import_mark_commit();
+    TEST_ASSERT_EQUAL(4, settings_import_promote_files());
+    settings_import_clear();
+
+    // Promoted DSP and matrix JSON must win over their snapshots at next boot
+    TEST_ASSERT_FALSE(LittleFS.exists("/dsp_a.bin"));
+    TEST_ASSERT_FALSE(LittleFS.exists("/dsp_b.bin"));
+    TEST_ASSERT_FALSE(LittleFS.exists("/mtx_a.bin"));
+    // No outputDsp units in the file: its snapshot stays, as do settings
+    TEST_ASSERT_TRUE(LittleFS.exists("/odsp_a.bin"));
+    TEST_ASSERT_TRUE(LittleFS.exists("/cfg_a.bin"));
+}
+
+void test_import_truncated_upload_touches_nothing(void) {
+    MockFS::injectFile("/dsp_ch0.json", "{\"old\":1}");
+    TEST_ASSERT_TRUE(settings_import_begin(nullptr));
+    std::string doc(EXPORT_DOC);
+    feedDoc(doc.substr(0, doc.size() / 2).c_str(), 9);
+    TEST_ASSERT_FALSE(settings_import_finish());
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_ERR_SYNTAX, settings_import_get_stats().status);
+    settings_import_abort();
+
+    TEST_ASSERT_EQUAL_STRING("{\"old\":1}", MockFS::getFile("/dsp_ch0.json").c_str());
+    TEST_ASSERT_FALSE(settings_import_has_unit("exportInfo", -1));
+    TEST_ASSERT_FALSE(settings_import_resume());
+}
+
+static bool rejectHal(const char *data, size_t len) {
+    (void)len;
+    return strstr(data, "slot") == nullptr;
+}
+
+void test_import_validator_rejection_aborts(void) {
+    TEST_ASSERT_TRUE(settings_import_begin(rejectHal));
+    feedDoc(EXPORT_DOC, 64);
+    TEST_ASSERT_FALSE(settings_import_finish());
+    TEST_ASSERT_EQUAL(SETTINGS_SPLIT_ERR_REJECTED, settings_import_get_stats().status);
+}
+
+void test_import_resume_after_interrupted_commit(void) {
+    TEST_ASSERT_TRUE(settings_import_begin(nullptr));
+    feedDoc(EXPORT_DOC, 33);
+    TEST_ASSERT_TRUE(settings_import_finish());
+    settings_import_mark_commit();
+    // Simulated power loss before promotion — next boot resumes
+    TEST_ASSERT_TRUE(settings_import_resume());
+    TEST_ASSERT_TRUE(LittleFS.exists("/dsp_ch0.json"));
+    TEST_ASSERT_TRUE(LittleFS.exists("/dsp_ch2.json"));
+    TEST_ASSERT_FALSE(settings_import_has_unit("dspChannels", 0));
+    // appState sections stay staged until the caller has re-applied them
+    TEST_ASSERT_TRUE(LittleFS.exists(SETTINGS_IMPORT_COMMIT_MARKER));
+    TEST_ASSERT_TRUE(settings_import_has_unit("settings", -1));
+    TEST_ASSERT_TRUE(settings_import_has_unit("exportInfo", -1));
+    settings_import_clear();
+    TEST_ASSERT_FALSE(LittleFS.exists(SETTINGS_IMPORT_COMMIT_MARKER));
+    TEST_ASSERT_FALSE(settings_import_has_unit("settings", -1));
+}
+
+void test_import_section_buffer_released(void) {
+    TEST_ASSERT_TRUE(settings_import_begin(nullptr));
+    PsramAllocStats during = psram_get_stats();
+    TEST_ASSERT_EQUAL_UINT32(SETTINGS_STREAM_SECTION_MAX,
+                             during.activePsramBytes + during.activeSramBytes);
+    feedDoc(EXPORT_DOC, 256);
+    settings_import_finish();
+    PsramAllocStats after = psram_get_stats();
+    TEST_ASSERT_EQUAL_UINT32(0, after.activePsramBytes + after.activeSramBytes);
+    TEST_ASSERT_LESS_THAN(100, settings_import_get_stats().maxUnitBytes);
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_split_units_whole_document);
+    RUN_TEST(test_split_identical_for_every_chunk_size);
+    RUN_TEST(test_split_scalars_and_strings);
+    RUN_TEST(test_split_overflow_is_bounded);
+    RUN_TEST(test_split_filtered_keys_not_buffered);
+    RUN_TEST(test_split_rejects_malformed);
+    RUN_TEST(test_split_empty_object);
+    RUN_TEST(test_writer_output_independent_of_chunk_size);
+    RUN_TEST(test_writer_chunks_never_exceed_capacity);
+    RUN_TEST(test_writer_corrupt_file_becomes_placeholder);
+    RUN_TEST(test_writer_stops_when_client_gone);
+    RUN_TEST(test_file_structure_check);
+    RUN_TEST(test_import_stages_known_sections_only);
+    RUN_TEST(test_import_commit_promotes_and_skips_placeholders);
+    RUN_TEST(test_import_promotion_drops_shadowing_snapshots);
+    RUN_TEST(test_import_truncated_upload_touches_nothing);
+    RUN_TEST(test_import_validator_rejection_aborts);
+    RUN_TEST(test_import_resume_after_interrupted_commit);
+    RUN_TEST(test_import_section_buffer_released);
+
+    return UNITY_END();
+}
@@ -0,0 +1,455 @@
+// test_tdm_engine.cpp
+// N-slot TDM engine (hal_tdm_engine.h) and its frame kernels (tdm_kernels.h).
+// Covers format limits, slot maps (any pair, either order, mono), 16/24/32-bit
+// slot containers in both directions, the engine's lane views on 8- and
+// 16-slot ports, views lending 32-bit slots in place, TX silence for skipped
+// views and the skipped-last-view flush, the shared view pool, and ns/frame for 8- and 16-slot frames
+// against the pair-buffer path the 4/8-slot (de)interleavers used before.
+//
+// The old pair-buffer path is replicated inline as it stood in
+// hal_tdm_deinterleaver.cpp / hal_tdm_interleaver.cpp.
+
+#include <unity.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+
+#ifndef NATIVE_TEST
+#define NATIVE_TEST
+#endif
+#ifndef DAC_ENABLED
+#define DAC_ENABLED
+#endif
+
+#define TDM_TEST_PROVIDES_STUBS
+#define TDM_INTERLEAVER_TEST_PROVIDES_STUBS
+
+#include "../../src/tdm_kernels.h"
+#include "../../src/audio_input_kernel.h"
+
+// ===== Synthetic port =====
+
+#define MAX_FRAMES 256
+static uint8_t  g_rxFeed[MAX_FRAMES * TDM_MAX_SLOTS * 4];
+static uint32_t g_rxFrames = 0;
+static uint8_t  g_tx[MAX_FRAMES * TDM_MAX_SLOTS * 4];
+static size_t   g_txBytes = 0;
+static uint32_t g_txCalls = 0;
+
+inline uint32_t i2s_port_tdm_read(uint8_t, void* dst, uint32_t frames, uint16_t frameBytes) {
+    uint32_t n = g_rxFrames < frames ? g_rxFrames : frames;
+    memcpy(dst, g_rxFeed, (size_t)n * frameBytes);
+    return n;
+}
+inline bool i2s_port_is_rx_active(uint8_t) { return g_rxFrames > 0; }
+inline void i2s_port_write(uint8_t, const void* src, size_t size, size_t* bw, uint32_t) {
+    memcpy(g_tx, src, size < sizeof(g_tx) ? size : sizeof(g_tx));
+    g_txBytes = size;
+    if (bw) *bw = size;
+    g_txCalls++;
+}
+
+#include "../../src/heap_budget.cpp"
+#include "../../src/psram_alloc.cpp"
+#include "../../src/hal/hal_tdm_engine.cpp"
+
+// Sample for slot s of frame f: slot in the top byte, signed frame ramp below
+static int32_t pattern(uint32_t f, uint32_t s) {
+    return (int32_t)(((s + 1) << 24) | ((f * 2654435761u) & 0x00FFFF00u)) * ((f & 1) ? -1 : 1);
+}
+
+// Pack n frames of pattern() into a frame buffer of the given format
+static void pack_frames(uint8_t* buf, TdmFormat fmt, uint32_t n) {
+    const uint32_t sb = tdm_slot_bytes(fmt);
+    for (uint32_t f = 0; f < n; f++) {
+        for (uint32_t s = 0; s < fmt.slots; s++) {
+            uint32_t w = (uint32_t)pattern(f, s);
+            uint8_t* p = buf + (f * fmt.slots + s) * sb;
+            for (uint32_t b = 0; b < sb; b++) p[b] = (uint8_t)(w >> (8 * (4 - sb + b)));
+        }
+    }
+}
+
+// pattern() as it reads back through a slot of the given width
+static int32_t narrowed(int32_t w, uint8_t bits) {
+    return (int32_t)((uint32_t)w & (0xFFFFFFFFu << (32 - bits)));
+}
+
+void setUp(void) {
+    memset(g_rxFeed, 0, sizeof(g_rxFeed));
+    memset(g_tx, 0, sizeof(g_tx));
+    g_rxFrames = 0;
+    g_txBytes = 0;
+    g_txCalls = 0;
+}
+
+void tearDown(void) {}
+
+// ===== Kernels =====
+
+void test_format_limits(void) {
+    TEST_ASSERT_FALSE(tdm_format_valid({1, 32}));
+    TEST_ASSERT_TRUE(tdm_format_valid({2, 32}));
+    TEST_ASSERT_TRUE(tdm_format_valid({16, 16}));
+    TEST_ASSERT_FALSE(tdm_format_valid({17, 32}));
+    TEST_ASSERT_FALSE(tdm_format_valid({8, 20}));
+    TEST_ASSERT_EQUAL_UINT32(48, tdm_frame_bytes({16, 24}));
+    TEST_ASSERT_EQUAL_UINT32(16, tdm_frame_bytes({8, 16}));
+    TEST_ASSERT_FALSE(tdm_pair_valid({8, 32}, 7, 8));
+    TEST_ASSERT_TRUE(tdm_pair_valid({8, 32}, 7, 0));
+}
+
+// Any slot pair, either order, every width; odd frame count covers the tail
+void test_gather_slot_maps_all_widths(void) {
+    static uint8_t buf[MAX_FRAMES * TDM_MAX_SLOTS * 4];
+    static int32_t out[MAX_FRAMES * 2];
+    const uint8_t widths[3] = { 16, 24, 32 };
+    const uint8_t maps[4][2] = { {0, 1}, {5, 2}, {15, 0}, {9, 9} };
+    const uint32_t n = 13;
+    for (int w = 0; w < 3; w++) {
+        TdmFormat fmt = { 16, widths[w] };
+        pack_frames(buf, fmt, n);
+        for (int m = 0; m < 4; m++) {
+            memset(out, 0x5A, sizeof(out));
+            tdm_gather_pair(buf, fmt, maps[m][0], maps[m][1], out, n);
+            for (uint32_t f = 0; f < n; f++) {
+                TEST_ASSERT_EQUAL_INT32(narrowed(pattern(f, maps[m][0]), fmt.slotBits), out[f * 2]);
+                TEST_ASSERT_EQUAL_INT32(narrowed(pattern(f, maps[m][1]), fmt.slotBits), out[f * 2 + 1]);
+            }
+            TEST_ASSERT_EQUAL_INT32(0x5A5A5A5A, out[n * 2]);   // Nothing past n frames
+        }
+    }
+}
+
+// Planar gather equals the pipeline's fused conversion of the gathered pair
+void test_gather_planar_matches_input_kernel(void) {
+    static uint8_t buf[MAX_FRAMES * 8 * 4];
+    static int32_t pair[MAX_FRAMES * 2];
+    static float L[MAX_FRAMES], R[MAX_FRAMES], refL[MAX_FRAMES], refR[MAX_FRAMES];
+    const uint8_t widths[3] = { 16, 24, 32 };
+    const float gain = 0.5f;
+    for (int w = 0; w < 3; w++) {
+        TdmFormat fmt = { 8, widths[w] };
+        pack_frames(buf, fmt, 101);
+        tdm_gather_planar(buf, fmt, 6, 3, L, R, 101, gain / AUDIO_INPUT_FULL_SCALE);
+        tdm_gather_pair(buf, fmt, 6, 3, pair, 101);
+        AudioInputStats st;
+        audio_input_condition(pair, refL, refR, 101, gain, false, st);
+        TEST_ASSERT_EQUAL_MEMORY(refL, L, sizeof(float) * 101);
+        TEST_ASSERT_EQUAL_MEMORY(refR, R, sizeof(float) * 101);
+    }
+}
+
+// Scatter then gather returns the (narrowed) lane; other slots untouched
+void test_scatter_round_trip_all_widths(void) {
+    static uint8_t buf[MAX_FRAMES * TDM_MAX_SLOTS * 4];
+    static int32_t in[MAX_FRAMES * 2], out[MAX_FRAMES * 2];
+    const uint8_t widths[3] = { 16, 24, 32 };
+    const uint32_t n = 37;
+    for (uint32_t f = 0; f < n; f++) {
+        in[f * 2]     = pattern(f, 20);
+        in[f * 2 + 1] = pattern(f, 21);
+    }
+    for (int w = 0; w < 3; w++) {
+        TdmFormat fmt = { 12, widths[w] };
+        pack_frames(buf, fmt, n);
+        tdm_scatter_pair(buf, fmt, 11, 4, in, n);
+        tdm_gather_pair(buf, fmt, 11, 4, out, n);
+        for (uint32_t f = 0; f < n; f++) {
+            TEST_ASSERT_EQUAL_INT32(narrowed(in[f * 2], fmt.slotBits), out[f * 2]);
+            TEST_ASSERT_EQUAL_INT32(narrowed(in[f * 2 + 1], fmt.slotBits), out[f * 2 + 1]);
+        }
+        tdm_gather_pair(buf, fmt, 3, 5, out, n);     // Neighbours of the written slots
+        for (uint32_t f = 0; f < n; f++) {
+            TEST_ASSERT_EQUAL_INT32(narrowed(pattern(f, 3), fmt.slotBits), out[f * 2]);
+            TEST_ASSERT_EQUAL_INT32(narrowed(pattern(f, 5), fmt.slotBits), out[f * 2 + 1]);
+        }
+    }
+}
+
+void test_clear_pair_silences_only_its_slots(void) {
+    static uint8_t buf[16 * 6 * 3];
+    TdmFormat fmt = { 6, 24 };
+    static int32_t out[32];
+    pack_frames(buf, fmt, 16);
+    tdm_clear_pair(buf, fmt, 1, 4, 16);
+    tdm_gather_pair(buf, fmt, 1, 4, out, 16);
+    for (int i = 0; i < 32; i++) TEST_ASSERT_EQUAL_INT32(0, out[i]);
+    tdm_gather_pair(buf, fmt, 0, 5, out, 16);
+    TEST_ASSERT_EQUAL_INT32(narrowed(pattern(15, 5), 24), out[31]);
+}
+
+// ===== Engine lane views =====
+
+// 16-slot RX port, eight views with a scrambled slot map
+void test_engine_rx_16_slot_views(void) {
+    HalTdmEngine eng;
+    TdmFormat fmt = { 16, 32 };
+    TEST_ASSERT_TRUE(eng.init(1, TDM_DIR_RX, fmt, 128));
+    const uint8_t map[8][2] = { {14, 15}, {0, 1}, {3, 2}, {4, 5}, {7, 6}, {8, 9}, {10, 11}, {13, 12} };
+    AudioInputSource src[8];
+    for (int v = 0; v < 8; v++) TEST_ASSERT_TRUE(eng.bindSource("v", map[v][0], map[v][1], &src[v]));
+    TEST_ASSERT_EQUAL_UINT8(8, eng.viewCount());
+
+    pack_frames(g_rxFeed, fmt, 64);
+    g_rxFrames = 64;
+    static int32_t out[MAX_FRAMES * 2];
+    for (int v = 0; v < 8; v++) {
+        memset(out, 0, sizeof(out));
+        TEST_ASSERT_EQUAL_UINT32(v == 0 ? 64 : 48, src[v].read(out, v == 0 ? 64 : 48));
+        for (uint32_t f = 0; f < (v == 0 ? 64u : 48u); f++) {
+            TEST_ASSERT_EQUAL_INT32(pattern(f, map[v][0]), out[f * 2]);
+            TEST_ASSERT_EQUAL_INT32(pattern(f, map[v][1]), out[f * 2 + 1]);
+        }
+        TEST_ASSERT_TRUE(src[v].isActive());
+    }
+}
+
+// 16-bit, 2-slot port: one view, packed int16 frames
+void test_engine_rx_2_slot_16_bit(void) {
+    HalTdmEngine eng;
+    TdmFormat fmt = { 2, 16 };
+    TEST_ASSERT_TRUE(eng.init(0, TDM_DIR_RX, fmt, 64));
+    AudioInputSource src;
+    TEST_ASSERT_TRUE(eng.bindSource("st", 1, 0, &src));
+    pack_frames(g_rxFeed, fmt, 10);
+    g_rxFrames = 10;
+    int32_t out[20];
+    TEST_ASSERT_EQUAL_UINT32(10, src.read(out, 10));
+    TEST_ASSERT_EQUAL_INT32(narrowed(pattern(9, 1), 16), out[18]);
+    TEST_ASSERT_EQUAL_INT32(narrowed(pattern(9, 0), 16), out[19]);
+}
+
+// 32-bit slots are lent in place: each view points into the frame buffer
+// with the frame as stride; packed containers only read
+void test_engine_rx_views_lend_32_bit_slots(void) {
+    HalTdmEngine eng;
+    TdmFormat fmt = { 16, 32 };
+    TEST_ASSERT_TRUE(eng.init(1, TDM_DIR_RX, fmt, 128));
+    const uint8_t map[8][2] = { {0, 1}, {3, 2}, {4, 5}, {7, 6}, {8, 9}, {10, 11}, {13, 12}, {14, 15} };
+    AudioInputSource src[8];
+    for (int v = 0; v < 8; v++) TEST_ASSERT_TRUE(eng.bindSource("v", map[v][0], map[v][1], &src[v]));
+
+    pack_frames(g_rxFeed, fmt, 64);
+    g_rxFrames = 64;
+    for (int v = 0; v < 8; v++) {
+        AudioLaneView view = {};
+        TEST_ASSERT_NOT_NULL(src[v].borrow);
+        TEST_ASSERT_NULL(src[v].release);         // Valid until the next pull
+        TEST_ASSERT_EQUAL_UINT32(64, src[v].borrow(&view, 64));
+        TEST_ASSERT_EQUAL_UINT16(16, view.stride);
+        TEST_ASSERT_EQUAL_FLOAT(1.0f, view.gain);
+        for (uint32_t f = 0; f < 64; f++) {
+            TEST_ASSERT_EQUAL_INT32(pattern(f, map[v][0]), view.left[f * view.stride]);
+            TEST_ASSERT_EQUAL_INT32(pattern(f, map[v][1]), view.right[f * view.stride]);
+        }
+    }
+
+    HalTdmEngine packed;
+    AudioInputSource p;
+    TEST_ASSERT_TRUE(packed.init(0, TDM_DIR_RX, { 8, 24 }, 64));
+    TEST_ASSERT_TRUE(packed.bindSource("p", 0, 1, &p));
+    TEST_ASSERT_NULL(p.borrow);
+}
+
+// A short port block is not lent, and the first view's fallback read takes
+// the block the borrow already pulled instead of pulling another
+void test_engine_short_block_falls_back_to_read(void) {
+    HalTdmEngine eng;
+    TdmFormat fmt = { 4, 32 };
+    TEST_ASSERT_TRUE(eng.init(0, TDM_DIR_RX, fmt, 128));
+    AudioInputSource a, b;
+    TEST_ASSERT_TRUE(eng.bindSource("a", 0, 1, &a));
+    TEST_ASSERT_TRUE(eng.bindSource("b", 2, 3, &b));
+    pack_frames(g_rxFeed, fmt, 40);
+    g_rxFrames = 40;
+
+    AudioLaneView view = {};
+    TEST_ASSERT_EQUAL_UINT32(0, a.borrow(&view, 64));
+    g_rxFrames = 0;                                  // A second pull would get nothing
+    static int32_t out[MAX_FRAMES * 2];
+    TEST_ASSERT_EQUAL_UINT32(40, a.read(out, 64));
+    TEST_ASSERT_EQUAL_INT32(pattern(39, 1), out[79]);
+    TEST_ASSERT_EQUAL_UINT32(0, b.borrow(&view, 64));
+    TEST_ASSERT_EQUAL_UINT32(40, b.read(out, 64));
+    TEST_ASSERT_EQUAL_INT32(pattern(39, 2), out[78]);
+}
+
+void test_engine_bind_rejects_bad_maps(void) {
+    HalTdmEngine eng;
+    AudioInputSource src;
+    AudioOutputSink sink;
+    TEST_ASSERT_FALSE(eng.bindSource("x", 0, 1, &src));             // Not initialized
+    TEST_ASSERT_NULL(src.read);
+    TEST_ASSERT_FALSE(eng.init(0, TDM_DIR_RX, {18, 32}, 64));       // Too many slots
+    TEST_ASSERT_TRUE(eng.init(0, TDM_DIR_RX, {4, 32}, 64));
+    TEST_ASSERT_FALSE(eng.bindSource("x", 0, 4, &src));             // Slot out of range
+    TEST_ASSERT_NULL(src.read);
+    TEST_ASSERT_FALSE(eng.bindSink("x", 0, 1, 0, 0, &sink));        // Wrong direction
+    TEST_ASSERT_NULL(sink.write);
+    TEST_ASSERT_EQUAL_UINT8(0, eng.viewCount());
+}
+
+// Eight 2-view engines fill the pool; a ninth bind fails until one deinits
+void test_engine_view_pool_shared(void) {
+    HalTdmEngine eng[TDM_ENGINE_MAX_VIEWS / 2 + 1];
+    AudioInputSource src;
+    for (int i = 0; i < TDM_ENGINE_MAX_VIEWS / 2; i++) {
+        TEST_ASSERT_TRUE(eng[i].init(0, TDM_DIR_RX, {4, 32}, 16));
+        TEST_ASSERT_TRUE(eng[i].bindSource("a", 0, 1, &src));
+        TEST_ASSERT_TRUE(eng[i].bindSource("b", 2, 3, &src));
+    }
+    HalTdmEngine& last = eng[TDM_ENGINE_MAX_VIEWS / 2];
+    TEST_ASSERT_TRUE(last.init(0, TDM_DIR_TX, {4, 32}, 16));
+    AudioOutputSink sink;
+    TEST_ASSERT_FALSE(last.bindSink("c", 0, 1, 0, 0, &sink));
+    eng[3].deinit();
+    TEST_ASSERT_TRUE(last.bindSink("c", 0, 1, 0, 0, &sink));
+    TEST_ASSERT_TRUE(sink.isReady());
+}
+
+// TX: a view the pipeline skipped goes out as silence, not its old samples
+void test_engine_tx_skipped_view_is_silent(void) {
+    HalTdmEngine eng;
+    TdmFormat fmt = { 6, 24 };
+    TEST_ASSERT_TRUE(eng.init(0, TDM_DIR_TX, fmt, 64));
+    AudioOutputSink s[3];
+    for (int v = 0; v < 3; v++) TEST_ASSERT_TRUE(eng.bindSink("s", (uint8_t)(2 * v), (uint8_t)(2 * v + 1), 0, 0, &s[v]));
+
+    static int32_t in[3][16 * 2];
+    for (int v = 0; v < 3; v++)
+        for (int i = 0; i < 32; i++) in[v][i] = pattern((uint32_t)i, (uint32_t)v);
+    for (int v = 0; v < 3; v++) s[v].write(in[v], 16);
+    TEST_ASSERT_EQUAL_UINT32(1, g_txCalls);
+    TEST_ASSERT_EQUAL_UINT32(16 * 18, g_txBytes);
+
+    s[0].write(in[0], 16);                       // View 1 skipped (muted)
+    s[2].write(in[2], 16);
+    TEST_ASSERT_EQUAL_UINT32(2, g_txCalls);
+    int32_t out[32];
+    tdm_gather_pair(g_tx, fmt, 2, 3, out, 16);
+    for (int i = 0; i < 32; i++) TEST_ASSERT_EQUAL_INT32(0, out[i]);
+    tdm_gather_pair(g_tx, fmt, 4, 5, out, 16);
+    TEST_ASSERT_EQUAL_INT32(narrowed(in[2][31], 24), out[31]);
+}
+
+// TX: with the last view skipped the block goes out on the next tick's first write
+void test_engine_tx_skipped_last_view_flushes_next_tick(void) {
+    HalTdmEngine eng;
+    TdmFormat fmt = { 4, 32 };
+    TEST_ASSERT_TRUE(eng.init(0, TDM_DIR_TX, fmt, 64));
+    AudioOutputSink a, b;
+    eng.bindSink("a", 0, 1, 0, 0, &a);
+    eng.bindSink("b", 2, 3, 2, 0, &b);
+    int32_t t1[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    int32_t t2[8] = { 9, 9, 9, 9, 9, 9, 9, 9 };
+
+    a.write(t1, 4);                              // Tick 1: b muted
+    TEST_ASSERT_EQUAL_UINT32(0, g_txCalls);
+    a.write(t2, 4);                              // Tick 2 starts: tick 1 goes out
+    TEST_ASSERT_EQUAL_UINT32(1, g_txCalls);
+    const int32_t* tx = (const int32_t*)g_tx;
+    TEST_ASSERT_EQUAL_INT32(1, tx[0]);
+    TEST_ASSERT_EQUAL_INT32(0, tx[2]);           // b silent in tick 1
+    TEST_ASSERT_EQUAL_INT32(7, tx[12]);
+    b.write(t1, 4);                              // b back: tick 2 flushes normally
+    TEST_ASSERT_EQUAL_UINT32(2, g_txCalls);
+    TEST_ASSERT_EQUAL_INT32(9, tx[0]);
+    TEST_ASSERT_EQUAL_INT32(1, tx[2]);
+}
+
+// ===== ns/frame =====
+
+// Old RX path: 32-bit frames -> per-pair int32 buffers -> memcpy into each lane
+static void old_rx(const int32_t* raw, int slots, int32_t* const* pairBuf, int32_t* const* lanes, int n) {
+    for (int f = 0; f < n; f++) {
+        const int32_t* slot = raw + f * slots;
+        for (int p = 0; p < slots / 2; p++) {
+            pairBuf[p][f * 2]     = slot[p * 2];
+            pairBuf[p][f * 2 + 1] = slot[p * 2 + 1];
+        }
+    }
+    for (int p = 0; p < slots / 2; p++) memcpy(lanes[p], pairBuf[p], (size_t)n * 2 * sizeof(int32_t));
+}
+
+// Old TX path: memcpy each sink into its pair buffer, then interleave
+static void old_tx(int32_t* const* lanes, int slots, int32_t* const* pairBuf, int32_t* raw, int n) {
+    for (int p = 0; p < slots / 2; p++) memcpy(pairBuf[p], lanes[p], (size_t)n * 2 * sizeof(int32_t));
+    for (int f = 0; f < n; f++) {
+        int32_t* slot = raw + f * slots;
+        for (int p = 0; p < slots / 2; p++) {
+            slot[p * 2]     = pairBuf[p][f * 2];
+            slot[p * 2 + 1] = pairBuf[p][f * 2 + 1];
+        }
+    }
+}
+
+static void bench(int slots) {
+    const int n = 128, iters = 4000;
+    static int32_t raw[MAX_FRAMES * TDM_MAX_SLOTS];
+    static int32_t laneMem[TDM_MAX_SLOTS / 2][MAX_FRAMES * 2], pairMem[TDM_MAX_SLOTS / 2][MAX_FRAMES * 2];
+    static float L[MAX_FRAMES], R[MAX_FRAMES];
+    int32_t* lanes[TDM_MAX_SLOTS / 2];
+    int32_t* pairs[TDM_MAX_SLOTS / 2];
+    for (int p = 0; p < slots / 2; p++) { lanes[p] = laneMem[p]; pairs[p] = pairMem[p]; }
+    TdmFormat fmt = { (uint8_t)slots, 32 };
+    pack_frames((uint8_t*)raw, fmt, n);
+    volatile int32_t sink = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) { old_rx(raw, slots, pairs, lanes, n); sink += lanes[i % (slots / 2)][i & 63]; }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) {
+        for (int p = 0; p < slots / 2; p++) tdm_gather_pair(raw, fmt, (uint8_t)(2 * p), (uint8_t)(2 * p + 1), lanes[p], n);
+        sink += lanes[i % (slots / 2)][i & 63];
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) {
+        for (int p = 0; p < slots / 2; p++) tdm_gather_planar(raw, fmt, (uint8_t)(2 * p), (uint8_t)(2 * p + 1), L, R, n, 1.0f / AUDIO_INPUT_FULL_SCALE);
+        sink += (int32_t)L[i & 63];
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) { old_tx(lanes, slots, pairs, raw, n); sink += raw[i & 63]; }
+    auto t4 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) {
+        for (int p = 0; p < slots / 2; p++) tdm_scatter_pair(raw, fmt, (uint8_t)(2 * p), (uint8_t)(2 * p + 1), lanes[p], n);
+        sink += raw[i & 63];
+    }
+    auto t5 = std::chrono::steady_clock::now();
+
+    auto nsPerFrame = [&](std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count() / ((double)iters * n);
+    };
+    double oldRx = nsPerFrame(t0, t1), newRx = nsPerFrame(t1, t2), planar = nsPerFrame(t2, t3);
+    double oldTx = nsPerFrame(t3, t4), newTx = nsPerFrame(t4, t5);
+    printf("[bench] %2d slots: RX pair-buffer %.2f ns/frame, direct gather %.2f, planar float %.2f; "
+           "TX pair-buffer %.2f, direct scatter %.2f\n", slots, oldRx, newRx, planar, oldTx, newTx);
+    // Loose: the direct path does strictly less work than the two-pass one
+    TEST_ASSERT_TRUE(newRx < oldRx * 1.5);
+    TEST_ASSERT_TRUE(newTx < oldTx * 1.5);
+    (void)sink;
+}
+
+void test_bench_8_slot(void)  { bench(8); }
+void test_bench_16_slot(void) { bench(16); }
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_format_limits);
+    RUN_TEST(test_gather_slot_maps_all_widths);
+    RUN_TEST(test_gather_planar_matches_input_kernel);
+    RUN_TEST(test_scatter_round_trip_all_widths);
+    RUN_TEST(test_clear_pair_silences_only_its_slots);
+    RUN_TEST(test_engine_rx_16_slot_views);
+    RUN_TEST(test_engine_rx_2_slot_16_bit);
+    RUN_TEST(test_engine_rx_views_lend_32_bit_slots);
+    RUN_TEST(test_engine_short_block_falls_back_to_read);
+    RUN_TEST(test_engine_bind_rejects_bad_maps);
+    RUN_TEST(test_engine_view_pool_shared);
+    RUN_TEST(test_engine_tx_skipped_view_is_silent);
+    RUN_TEST(test_engine_tx_skipped_last_view_flushes_next_tick);
+    RUN_TEST(test_bench_8_slot);
+    RUN_TEST(test_bench_16_slot);
+    return UNITY_END();
+}
@@ -161,6 +161,46 @@ void test_rb_partial_read(void) {
     TEST_ASSERT_EQUAL(20, rdata[1]);
 }
 
+// ===== Ring Buffer: Zero-Copy Peek =====
+
+void test_rb_peek_lends_frames_in_place(void) {
+    int32_t wdata[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    usb_rb_write(&rb, wdata, 4);
+
+    const int32_t *view = nullptr;
+    TEST_ASSERT_EQUAL(3, usb_rb_peek(&rb, &view, 3));
+    TEST_ASSERT_EQUAL_PTR(ringBufStorage, view);
+    TEST_ASSERT_EQUAL(5, view[4]);
+    // Not consumed yet: the producer cannot reuse the frames
+    TEST_ASSERT_EQUAL(4, usb_rb_available(&rb));
+    TEST_ASSERT_EQUAL(123, usb_rb_free(&rb));
+
+    usb_rb_consume(&rb, 3);
+    TEST_ASSERT_EQUAL(1, usb_rb_available(&rb));
+    int32_t rdata[2];
+    usb_rb_read(&rb, rdata, 1);
+    TEST_ASSERT_EQUAL(7, rdata[0]);
+    TEST_ASSERT_EQUAL(0, rb.underruns);
+}
+
+void test_rb_peek_refuses_short_or_wrapped_blocks(void) {
+    int32_t wdata[2] = {0, 0};
+    const int32_t *view = nullptr;
+    for (int i = 0; i < 10; i++) usb_rb_write(&rb, wdata, 1);
+    TEST_ASSERT_EQUAL(0, usb_rb_peek(&rb, &view, 16));   // Short
+    TEST_ASSERT_EQUAL(0, rb.underruns);                 // Left to the copying read
+
+    // Move the read position to 120, then 16 frames split by the wrap
+    usb_rb_consume(&rb, 10);
+    for (int i = 0; i < 110; i++) usb_rb_write(&rb, wdata, 1);
+    usb_rb_consume(&rb, 110);
+    for (int i = 0; i < 16; i++) usb_rb_write(&rb, wdata, 1);
+    TEST_ASSERT_EQUAL(16, usb_rb_available(&rb));
+    TEST_ASSERT_EQUAL(0, usb_rb_peek(&rb, &view, 16));
+    TEST_ASSERT_EQUAL(8, usb_rb_peek(&rb, &view, 8));    // Up to the wrap is fine
+    TEST_ASSERT_EQUAL_PTR(&ringBufStorage[120 * 2], view);
+}
+
 // ===== Ring Buffer: Fill Level =====
 
 void test_rb_fill_level_half(void) {
@@ -499,6 +539,8 @@ int main(int argc, char **argv) {
     RUN_TEST(test_rb_partial_read);
     RUN_TEST(test_rb_fill_level_half);
     RUN_TEST(test_rb_reset);
+    RUN_TEST(test_rb_peek_lends_frames_in_place);
+    RUN_TEST(test_rb_peek_refuses_short_or_wrapped_blocks);
 
     // Format Conversion: PCM16
     RUN_TEST(test_pcm16_to_int32_silence);
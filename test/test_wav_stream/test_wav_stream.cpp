@@ -0,0 +1,427 @@
+// test_wav_stream.cpp — Incremental WAV IR parser + IR resampler.
+// Every well-formed file is fed whole, byte-by-byte and in pseudo-random
+// chunk sizes; all splits must yield bit-identical taps.
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../../src/dsp_wav_stream.h"
+#include "../../src/dsp_wav_stream.cpp"
+
+#define FLOAT_TOL 0.0001f
+#define MAX_TAPS  4096
+
+static uint8_t wavBuf[64 * 1024];
+static float   tapsA[MAX_TAPS];
+static float   tapsB[MAX_TAPS];
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ===== WAV builder =====
+
+struct WavBuilder {
+    uint8_t *buf;
+    int len;
+};
+
+static void put_u16(WavBuilder &b, uint16_t v) {
+    b.buf[b.len++] = (uint8_t)v;
+    b.buf[b.len++] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(WavBuilder &b, uint32_t v) {
+    for (int i = 0; i < 4; i++) b.buf[b.len++] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_tag(WavBuilder &b, const char *tag) {
+    memcpy(b.buf + b.len, tag, 4);
+    b.len += 4;
+}
+
+static void begin_wav(WavBuilder &b) {
+    b.buf = wavBuf;
+    b.len = 0;
+    put_tag(b, "RIFF");
+    put_u32(b, 0);            // Patched in end_wav
+    put_tag(b, "WAVE");
+}
+
+static void end_wav(WavBuilder &b) {
+    uint32_t riffSize = (uint32_t)(b.len - 8);
+    memcpy(b.buf + 4, &riffSize, 4);
+}
+
+// Odd-sized chunk to exercise the pad byte
+static void put_list_chunk(WavBuilder &b) {
+    put_tag(b, "LIST");
+    put_u32(b, 5);
+    put_tag(b, "INFO");
+    b.buf[b.len++] = 'x';
+    b.buf[b.len++] = 0;       // Pad
+}
+
+static void put_fmt(WavBuilder &b, uint16_t fmt, uint16_t ch, uint32_t rate, uint16_t bits) {
+    put_tag(b, "fmt ");
+    put_u32(b, 16);
+    put_u16(b, fmt);
+    put_u16(b, ch);
+    put_u32(b, rate);
+    put_u32(b, rate * ch * (bits / 8));
+    put_u16(b, (uint16_t)(ch * (bits / 8)));
+    put_u16(b, bits);
+}
+
+static void put_fmt_extensible(WavBuilder &b, uint16_t subFmt, uint16_t ch, uint32_t rate, uint16_t bits) {
+    put_tag(b, "fmt ");
+    put_u32(b, 40);
+    put_u16(b, 0xFFFE);
+    put_u16(b, ch);
+    put_u32(b, rate);
+    put_u32(b, rate * ch * (bits / 8));
+    put_u16(b, (uint16_t)(ch * (bits / 8)));
+    put_u16(b, bits);
+    put_u16(b, 22);           // cbSize
+    put_u16(b, bits);         // wValidBitsPerSample
+    put_u32(b, 0);            // dwChannelMask
+    put_u16(b, subFmt);       // SubFormat GUID, first two bytes
+    static const uint8_t guidTail[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00,
+                                          0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 };
+    memcpy(b.buf + b.len, guidTail, sizeof(guidTail));
+    b.len += sizeof(guidTail);
+}
+
+static void put_data_hdr(WavBuilder &b, uint32_t bytes) {
+    put_tag(b, "data");
+    put_u32(b, bytes);
+}
+
+static void put_s24(WavBuilder &b, int32_t v) {
+    b.buf[b.len++] = (uint8_t)v;
+    b.buf[b.len++] = (uint8_t)(v >> 8);
+    b.buf[b.len++] = (uint8_t)(v >> 16);
+}
+
+static void put_f32(WavBuilder &b, float v) {
+    memcpy(b.buf + b.len, &v, 4);
+    b.len += 4;
+}
+
+// ===== Feed helpers =====
+
+static int parse_whole(const uint8_t *data, int len, float *taps, int maxTaps, uint8_t chSel,
+                       WavIrStream *out = nullptr) {
+    WavIrStream ws;
+    wav_stream_init(&ws, taps, maxTaps, chSel);
+    wav_stream_feed(&ws, data, (size_t)len);
+    int n = wav_stream_finish(&ws);
+    if (out) *out = ws;
+    return n;
+}
+
+static int parse_chunked(const uint8_t *data, int len, float *taps, int maxTaps, uint8_t chSel,
+                         int fixedChunk, unsigned seed) {
+    WavIrStream ws;
+    wav_stream_init(&ws, taps, maxTaps, chSel);
+    srand(seed);
+    int pos = 0;
+    while (pos < len) {
+        int n = fixedChunk > 0 ? fixedChunk : 1 + rand() % 97;
+        if (n > len - pos) n = len - pos;
+        wav_stream_feed(&ws, data + pos, (size_t)n);
+        pos += n;
+    }
+    return wav_stream_finish(&ws);
+}
+
+// Whole parse vs 1/2/3/7-byte and random splits — all must match exactly
+static void assert_split_invariant(const uint8_t *data, int len, uint8_t chSel, int expectTaps) {
+    int whole = parse_whole(data, len, tapsA, MAX_TAPS, chSel);
+    TEST_ASSERT_EQUAL_INT(expectTaps, whole);
+    const int fixed[] = { 1, 2, 3, 7, 0, 0, 0 };
+    for (unsigned k = 0; k < sizeof(fixed) / sizeof(fixed[0]); k++) {
+        memset(tapsB, 0, sizeof(tapsB));
+        int n = parse_chunked(data, len, tapsB, MAX_TAPS, chSel, fixed[k], 1234 + k);
+        TEST_ASSERT_EQUAL_INT(whole, n);
+        TEST_ASSERT_EQUAL_MEMORY(tapsA, tapsB, (size_t)n * sizeof(float));
+    }
+}
+
+// ===== Format coverage =====
+
+void test_pcm16_mono_values(void) {
+    WavBuilder b;
+    begin_wav(b);
+    put_fmt(b, 1, 1, 48000, 16);
+    put_data_hdr(b, 8);
+    put_u16(b, 16384);
+    put_u16(b, (uint16_t)-16384);
+    put_u16(b, 32767);
+    put_u16(b, (uint16_t)-32768);
+    end_wav(b);
+
+    TEST_ASSERT_EQUAL_INT(4, parse_whole(wavBuf, b.len, tapsA, MAX_TAPS, 0));
+    TEST_ASSERT_FLOAT_WITHIN(FLOAT_TOL, 0.5f, tapsA[0]);
+    TEST_ASSERT_FLOAT_WITHIN(FLOAT_TOL, -0.5f, tapsA[1]);
+    TEST_ASSERT_FLOAT_WITHIN(FLOAT_TOL, 32767.0f / 32768.0f, tapsA[2]);
+    TEST_ASSERT_FLOAT_WITHIN(FLOAT_TOL, -1.0f, tapsA[3]);
+}
+
+void test_pcm24_sign_extension(void) {
+    WavBuilder b;
+    begin_wav(b);
+    put_fmt(b, 1, 1, 48000, 24);
+    put_data_hdr(b, 9);
+    put_s24(b, 0x400000);     //  0.5
+    put_s24(b, -0x400000);    // -0.5
+    put_s24(b, -1);           // -1 LSB
+    b.buf[b.len++] = 0;       // Pad (odd data chunk)
+    end_wav(b);
+
+    TEST_ASSERT_EQUAL_INT(3, parse_whole(wavBuf, b.len, tapsA, MAX_TAPS, 0));
+    TEST_ASSERT_FLOAT_WITHIN(FLOAT_TOL, 0.5f, tapsA[0]);
+    TEST_ASSERT_FLOAT_WITHIN(FLOAT_TOL, -0.5f, tapsA[1]);
+    TEST_ASSERT_TRUE(tapsA[2] < 0.0f && tapsA[2] > -0.0001f);
+}
+
+void test_pcm32_and_float32(void) {
+    WavBuilder b;
+    begin_wav(b);
+    put_fmt(b, 1, 1, 48000, 32);
+    put_data_hdr(b, 8);
+    put_u32(b, 0x40000000u);
+    put_u32(b, 0xC0000000u);
+    end_wav(b);
+    TEST_ASSERT_EQUAL_INT(2, parse_whole(wavBuf, b.len, tapsA, MAX_TAPS, 0));
+    TEST_ASSERT_FLOAT_WITHIN(FLOAT_TOL, 0.5f, tapsA[0]);
+    TEST_ASSERT_FLOAT_WITHIN(FLOAT_TOL, -0.5f, tapsA[1]);
+
+    begin_wav(b);
+    put_fmt(b, 3, 1, 48000, 32);
+    put_data_hdr(b, 8);
+    put_f32(b, 0.75f);
+    put_f32(b, -1.25f);       // Float IRs may exceed full scale
+    end_wav(b);
+    TEST_ASSERT_EQUAL_INT(2, parse_whole(wavBuf, b.len, tapsA, MAX_TAPS, 0));
+    TEST_ASSERT_EQUAL_FLOAT(0.75f, tapsA[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-1.25f, tapsA[1]);
+}
+
+void test_extensible_float_stereo_channel_select(void) {
+    WavBuilder b;
+    begin_wav(b);
+    put_fmt_extensible(b, 3, 2, 48000, 32);
+    put_data_hdr(b, 3 * 8);
+    for (int i = 0; i < 3; i++) {
+        put_f32(b, 0.1f * (i + 1));     // L
+        put_f32(b, -0.1f * (i + 1));    // R
+    }
+    end_wav(b);
+
+    WavIrStream ws;
+    TEST_ASSERT_EQUAL_INT(3, parse_whole(wavBuf, b.len, tapsA, MAX_TAPS, 1, &ws));
+    TEST_ASSERT_EQUAL_UINT16(3, ws.format);
+    TEST_ASSERT_EQUAL_UINT16(2, ws.channels);
+    TEST_ASSERT_FLOAT_WITHIN(FLOAT_TOL, -0.3f, tapsA[2]);
+
+    // Selector past the last channel clamps to it
+    TEST_ASSERT_EQUAL_INT(3, parse_whole(wavBuf, b.len, tapsA, MAX_TAPS, 5));
+    TEST_ASSERT_FLOAT_WITHIN(FLOAT_TOL, -0.1f, tapsA[0]);
+}
+
+// ===== Chunk-split invariance =====
+
+void test_split_pcm24_stereo_with_extra_chunks(void) {
+    WavBuilder b;
+    begin_wav(b);
+    put_list_chunk(b);        // Odd-sized chunk before fmt
+    put_fmt(b, 1, 2, 44100, 24);
+    put_list_chunk(b);        // And between fmt and data
+    const int frames = 1001;  // Odd byte count: 1001 * 6
+    put_data_hdr(b, frames * 6);
+    for (int i = 0; i < frames; i++) {
+        put_s24(b, (int32_t)(sinf(i * 0.01f) * 8000000.0f));
+        put_s24(b, (int32_t)(cosf(i * 0.02f) * -4000000.0f));
+    }
+    put_list_chunk(b);        // Trailing chunk is ignored
+    end_wav(b);
+
+    assert_split_invariant(wavBuf, b.len, 0, frames);
+    assert_split_invariant(wavBuf, b.len, 1, frames);
+}
+
+void test_split_float_extensible(void) {
+    WavBuilder b;
+    begin_wav(b);
+    put_fmt_extensible(b, 3, 1, 96000, 32);
+    const int frames = 2048;
+    put_data_hdr(b, frames * 4);
+    for (int i = 0; i < frames; i++) put_f32(b, expf(-i * 0.003f) * ((i & 1) ? -1.0f : 1.0f));
+    end_wav(b);
+
+    assert_split_invariant(wavBuf, b.len, 0, frames);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, tapsA[0]);
+}
+
+// ===== Errors and limits =====
+
+void test_not_riff_rejected(void) {
+    WavBuilder b;
+    begin_wav(b);
+    memcpy(wavBuf, "RIFX", 4);
+    put_fmt(b, 1, 1, 48000, 16);
+    end_wav(b);
+    WavIrStream ws;
+    TEST_ASSERT_EQUAL_INT(-1, parse_whole(wavBuf, b.len, tapsA, MAX_TAPS, 0, &ws));
+    TEST_ASSERT_EQUAL_UINT8(WAV_STREAM_ERR_HEADER, ws.error);
+}
+
+void test_unsupported_format_rejected(void) {
+    WavBuilder b;
+    begin_wav(b);
+    put_fmt(b, 1, 1, 48000, 8);           // 8-bit PCM
+    put_data_hdr(b, 2);
+    put_u16(b, 0x8080);
+    end_wav(b);
+    WavIrStream ws;
+    TEST_ASSERT_EQUAL_INT(-1, parse_whole(wavBuf, b.len, tapsA, MAX_TAPS, 0, &ws));
+    TEST_ASSERT_EQUAL_UINT8(WAV_STREAM_ERR_FORMAT, ws.error);
+
+    begin_wav(b);
+    put_fmt(b, 3, 1, 48000, 16);          // 16-bit "float"
+    end_wav(b);
+    TEST_ASSERT_EQUAL_INT(-1, parse_whole(wavBuf, b.len, tapsA, MAX_TAPS, 0, &ws));
+    TEST_ASSERT_EQUAL_UINT8(WAV_STREAM_ERR_FORMAT, ws.error);
+}
+
+void test_data_before_fmt_rejected(void) {
+    WavBuilder b;
+    begin_wav(b);
+    put_data_hdr(b, 2);
+    put_u16(b, 1);
+    put_fmt(b, 1, 1, 48000, 16);
+    end_wav(b);
+    WavIrStream ws;
+    TEST_ASSERT_EQUAL_INT(-1, parse_whole(wavBuf, b.len, tapsA, MAX_TAPS, 0, &ws));
+    TEST_ASSERT_EQUAL_UINT8(WAV_STREAM_ERR_NO_FMT, ws.error);
+}
+
+void test_truncated_header_rejected(void) {
+    WavBuilder b;
+    begin_wav(b);
+    put_fmt(b, 1, 1, 48000, 16);
+    end_wav(b);
+    WavIrStream ws;
+    // Cut inside the fmt body
+    TEST_ASSERT_EQUAL_INT(-1, parse_whole(wavBuf, 12 + 8 + 6, tapsA, MAX_TAPS, 0, &ws));
+    TEST_ASSERT_EQUAL_UINT8(WAV_STREAM_ERR_TRUNCATED, ws.error);
+    // No data chunk at all
+    TEST_ASSERT_EQUAL_INT(-1, parse_whole(wavBuf, b.len, tapsA, MAX_TAPS, 0, &ws));
+    TEST_ASSERT_EQUAL_UINT8(WAV_STREAM_ERR_TRUNCATED, ws.error);
+}
+
+void test_truncated_data_keeps_whole_frames(void) {
+    WavBuilder b;
+    begin_wav(b);
+    put_fmt(b, 1, 1, 48000, 16);
+    put_data_hdr(b, 100 * 2);             // Promises 100 samples
+    for (int i = 0; i < 10; i++) put_u16(b, (uint16_t)(i * 100));
+    b.buf[b.len++] = 0x12;                // Half a sample
+    end_wav(b);
+    TEST_ASSERT_EQUAL_INT(10, parse_whole(wavBuf, b.len, tapsA, MAX_TAPS, 0));
+}
+
+void test_clipped_to_max_taps(void) {
+    WavBuilder b;
+    begin_wav(b);
+    put_fmt(b, 1, 1, 48000, 16);
+    put_data_hdr(b, 64 * 2);
+    for (int i = 0; i < 64; i++) put_u16(b, 1000);
+    end_wav(b);
+    WavIrStream ws;
+    TEST_ASSERT_EQUAL_INT(16, parse_whole(wavBuf, b.len, tapsA, 16, 0, &ws));
+    TEST_ASSERT_TRUE(ws.clipped);
+}
+
+void test_invalid_args(void) {
+    WavIrStream ws;
+    wav_stream_init(&ws, nullptr, 16, 0);
+    TEST_ASSERT_FALSE(wav_stream_feed(&ws, wavBuf, 4));
+    TEST_ASSERT_EQUAL_INT(-1, wav_stream_finish(&ws));
+    TEST_ASSERT_EQUAL_UINT8(WAV_STREAM_ERR_ARGS, ws.error);
+}
+
+// ===== Resampler =====
+
+static float sum_taps(const float *t, int n) {
+    double s = 0;
+    for (int i = 0; i < n; i++) s += t[i];
+    return (float)s;
+}
+
+void test_resample_same_rate_copies(void) {
+    for (int i = 0; i < 100; i++) tapsA[i] = (float)i;
+    TEST_ASSERT_EQUAL_INT(100, dsp_wav_resample_ir(tapsA, 100, 48000, tapsB, MAX_TAPS, 48000));
+    TEST_ASSERT_EQUAL_MEMORY(tapsA, tapsB, 100 * sizeof(float));
+    TEST_ASSERT_EQUAL_INT(-1, dsp_wav_resample_ir(tapsA, 100, 48000, tapsA, MAX_TAPS, 48000));
+}
+
+// Smooth lowpass IR: DC gain (sum of taps) must survive resampling
+static void make_lowpass_ir(float *ir, int n) {
+    for (int i = 0; i < n; i++) {
+        float x = (i - n / 2) * 0.05f;
+        ir[i] = expf(-x * x) * 0.05f;
+    }
+}
+
+void test_resample_up_preserves_dc_gain(void) {
+    make_lowpass_ir(tapsA, 441);
+    int n = dsp_wav_resample_ir(tapsA, 441, 44100, tapsB, MAX_TAPS, 48000);
+    TEST_ASSERT_EQUAL_INT(480, n);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, sum_taps(tapsA, 441), sum_taps(tapsB, n));
+}
+
+void test_resample_down_preserves_dc_gain_and_peak(void) {
+    make_lowpass_ir(tapsA, 1000);
+    int n = dsp_wav_resample_ir(tapsA, 1000, 96000, tapsB, MAX_TAPS, 48000);
+    TEST_ASSERT_EQUAL_INT(500, n);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, sum_taps(tapsA, 1000), sum_taps(tapsB, n));
+    int peak = 0;
+    for (int i = 1; i < n; i++) if (tapsB[i] > tapsB[peak]) peak = i;
+    TEST_ASSERT_INT_WITHIN(1, 250, peak);
+}
+
+void test_resample_clamps_to_capacity(void) {
+    make_lowpass_ir(tapsA, 1000);
+    TEST_ASSERT_EQUAL_INT(64, dsp_wav_resample_ir(tapsA, 1000, 44100, tapsB, 64, 48000));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_pcm16_mono_values);
+    RUN_TEST(test_pcm24_sign_extension);
+    RUN_TEST(test_pcm32_and_float32);
+    RUN_TEST(test_extensible_float_stereo_channel_select);
+
+    RUN_TEST(test_split_pcm24_stereo_with_extra_chunks);
+    RUN_TEST(test_split_float_extensible);
+
+    RUN_TEST(test_not_riff_rejected);
+    RUN_TEST(test_unsupported_format_rejected);
+    RUN_TEST(test_data_before_fmt_rejected);
+    RUN_TEST(test_truncated_header_rejected);
+    RUN_TEST(test_truncated_data_keeps_whole_frames);
+    RUN_TEST(test_clipped_to_max_taps);
+    RUN_TEST(test_invalid_args);
+
+    RUN_TEST(test_resample_same_rate_copies);
+    RUN_TEST(test_resample_up_preserves_dc_gain);
+    RUN_TEST(test_resample_down_preserves_dc_gain_and_peak);
+    RUN_TEST(test_resample_clamps_to_capacity);
+
+    return UNITY_END();
+}
@@ -7,14 +7,22 @@
  * writes the assembled page to src/web_pages.cpp as C++ raw string literals,
  * then gzips the result to src/web_pages_gz.cpp.
  *
- * Usage: node tools/build_web_assets.js [--minify]
+ * Every gzipped asset gets a strong ETag (truncated SHA-256 of the gzipped
+ * bytes) so the firmware can answer If-None-Match with 304 Not Modified.
+ * With --split the CSS and JS are emitted as separate content-hashed assets
+ * (/assets/app.<hash>.css|js) that the firmware serves as immutable; the
+ * HTML shell then only carries the two references.
+ *
+ * Usage: node tools/build_web_assets.js [--minify] [--split]
  */
 
 const zlib = require('zlib');
 const fs = require('fs');
 const path = require('path');
+const crypto = require('crypto');
 
 const MINIFY = process.argv.includes('--minify');
+const SPLIT  = process.argv.includes('--split');
 
 // Source directories and files
 const WEB_SRC_DIR   = 'web_src';
@@ -29,6 +37,7 @@ const OUTPUT_FILE    = 'src/web_pages_gz.cpp';
 
 console.log('=== Web Assets Build Script ===');
 console.log(`Minification: ${MINIFY ? 'ENABLED' : 'DISABLED'}`);
+console.log(`Asset split:  ${SPLIT ? 'ENABLED' : 'DISABLED'}`);
 
 // ---------------------------------------------------------------------------
 // 1. Read the HTML shell template
@@ -141,9 +150,35 @@ if (MINIFY && css.length > 0) {
 // 5. Inject CSS and JS into the template
 //    Placeholders in index.html: /* CSS_INJECT */ and /* JS_INJECT */
 // ---------------------------------------------------------------------------
-let assembledHTML = htmlTemplate
-    .replace('/* CSS_INJECT */', css)
-    .replace('/* JS_INJECT */', js);
+//    With --split the <style>/<script> blocks become references to hashed
+//    assets instead (see contentHash / splitAssets below).
+// ---------------------------------------------------------------------------
+
+/**
+ * Content hash used for ETags and asset file names (16 hex chars of SHA-256)
+ */
+function contentHash(buffer) {
+    return crypto.createHash('sha256').update(buffer).digest('hex').substring(0, 16);
+}
+
+const splitAssets = [];
+let assembledHTML;
+if (SPLIT) {
+    const cssGz = zlib.gzipSync(Buffer.from(css), { level: 9 });
+    const jsGz  = zlib.gzipSync(Buffer.from(js), { level: 9 });
+    const cssPath = '/assets/app.' + contentHash(cssGz).substring(0, 8) + '.css';
+    const jsPath  = '/assets/app.' + contentHash(jsGz).substring(0, 8) + '.js';
+    splitAssets.push({ name: 'appCss', path: cssPath, contentType: 'text/css', data: cssGz });
+    splitAssets.push({ name: 'appJs',  path: jsPath,  contentType: 'application/javascript', data: jsGz });
+    assembledHTML = htmlTemplate
+        .replace('<style>/* CSS_INJECT */</style>', '<link rel="stylesheet" href="' + cssPath + '">')
+        .replace('<script>/* JS_INJECT */</script>', '<script src="' + jsPath + '"></script>');
+    console.log('  [OK] Split assets: ' + cssPath + ', ' + jsPath);
+} else {
+    assembledHTML = htmlTemplate
+        .replace('/* CSS_INJECT */', css)
+        .replace('/* JS_INJECT */', js);
+}
 
 // ---------------------------------------------------------------------------
 // 6. Extract apHtmlPage from the current web_pages.cpp.
@@ -271,7 +306,8 @@ function processAsset(name, html) {
         name,
         data: gzipped,
         hexArray: toHexArray(gzipped),
-        length: gzipped.length
+        length: gzipped.length,
+        etag: contentHash(gzipped)
     };
 }
 
@@ -305,13 +341,39 @@ let output = '// Auto-generated gzipped web assets\n' +
     '#include "web_pages.h"\n' +
     '\n';
 
+for (const a of splitAssets) {
+    assets.push({
+        name: a.name,
+        data: a.data,
+        hexArray: toHexArray(a.data),
+        length: a.data.length,
+        etag: contentHash(a.data)
+    });
+    console.log('  [OK] ' + a.name + ': ' + (a.data.length / 1024).toFixed(1) + ' KB gzipped');
+}
+
 for (const asset of assets) {
     output += '// Gzipped ' + asset.name + ' (' + asset.length + ' bytes)\n';
     output += 'const uint8_t ' + asset.name + '_gz[] PROGMEM = {\n';
     output += asset.hexArray;
     output += '\n};\n';
-    output += 'const size_t ' + asset.name + '_gz_len = ' + asset.length + ';\n\n';
+    output += 'const size_t ' + asset.name + '_gz_len = ' + asset.length + ';\n';
+    output += 'const char ' + asset.name + '_etag[] = "\\"' + asset.etag + '\\"";\n\n';
+}
+
+// Content-hashed assets served with Cache-Control: immutable (--split only).
+// A zero-length table still needs one element; webAssetCount bounds it.
+output += '// Immutable hashed assets (' + splitAssets.length + ')\n';
+output += 'const WebAsset webAssets[] = {\n';
+for (const a of splitAssets) {
+    output += '    { "' + a.path + '", ' + a.name + '_gz, ' + a.name + '_gz_len, ' +
+        a.name + '_etag, "' + a.contentType + '" },\n';
+}
+if (splitAssets.length === 0) {
+    output += '    { nullptr, nullptr, 0, nullptr, nullptr },\n';
 }
+output += '};\n';
+output += 'const size_t webAssetCount = ' + splitAssets.length + ';\n';
 
 fs.writeFileSync(OUTPUT_FILE, output);
 console.log('\nOutput written to: ' + OUTPUT_FILE);
@@ -321,5 +383,6 @@ const totalGzipped = assets.reduce((sum, a) => sum + a.length, 0);
 console.log('\nTotal gzipped size: ' + (totalGzipped / 1024).toFixed(1) + ' KB');
 console.log('\nTo use gzipped assets:');
 console.log('  1. Include "web_pages_gz.cpp" in your build');
-console.log('  2. Use sendGzipped() helper from web_pages.h');
+console.log('  2. Use sendGzipped() helper from web_pages.h (pass <name>_etag for 304 support)');
 console.log('  3. Set Content-Encoding: gzip header');
+if (SPLIT) console.log('  4. Hashed assets are registered from webAssets[] in routes.cpp');